@@ -41,6 +41,7 @@ else
 endif
 
 FILTERED_MODULE_FILE=/tmp/module_file
+VMM_IMAGE_DIR=%BUILD_ABS%/vmm_image
 
 ################################################################################
 # Sudo
@@ -115,6 +116,8 @@ include %HYPER_ABS%/common/common_subdir.mk
 .PHONY: driver_unload
 .PHONY: load
 .PHONY: unload
+.PHONY: vmm_image
+.PHONY: load_image
 .PHONY: start
 .PHONY: stop
 .PHONY: dump
@@ -122,6 +125,7 @@ include %HYPER_ABS%/common/common_subdir.mk
 .PHONY: quick
 .PHONY: loop
 .PHONY: unittest
+.PHONY: benchmark
 .PHONY: astyle
 .PHONY: astyle_clean
 .PHONY: doxygen
@@ -168,6 +172,15 @@ load: force
 unload: force
 	@$(SUDO) LD_LIBRARY_PATH=%BUILD_ABS%/makefiles/bfm/bin/native/ %BUILD_ABS%/makefiles/bfm/bin/native/bfm unload
 
+vmm_image: force
+	@rm -Rf $(FILTERED_MODULE_FILE)
+	@%BUILD_ABS%/build_scripts/filter_module_file.sh $(MODULE_FILE) $(FILTERED_MODULE_FILE)
+	@%BUILD_ABS%/build_scripts/build_vmm_image.sh $(FILTERED_MODULE_FILE) $(VMM_IMAGE_DIR)
+	@rm -Rf $(FILTERED_MODULE_FILE)
+
+load_image: force
+	@$(SUDO) LD_LIBRARY_PATH=%BUILD_ABS%/makefiles/bfm/bin/native/ %BUILD_ABS%/makefiles/bfm/bin/native/bfm load $(VMM_IMAGE_DIR)/vmm.modules
+
 start: force
 	@sync
 	@$(SUDO) LD_LIBRARY_PATH=%BUILD_ABS%/makefiles/bfm/bin/native/ %BUILD_ABS%/makefiles/bfm/bin/native/bfm start
@@ -200,6 +213,7 @@ loop: force
 
 unittest: run_tests
 test: run_tests
+benchmark: run_benchmarks
 
 astyle:
 	@cd %HYPER_ABS%; \
@@ -29,3 +29,10 @@ add_md(struct memory_descriptor *md)
     (void) md;
     return return_success();
 }
+
+extern "C" int64_t
+add_mem_chunk(struct memory_chunk *chunk)
+{
+    (void) chunk;
+    return return_success();
+}
@@ -49,12 +49,63 @@ extern "C" {
  *     the size of the execution buffer
  * @var module_t::file
  *     the ELF file that has all of the information about the module
+ * @var module_t::compact
+ *     the compacted copy of the ELF file that module_t::file refers to once
+ *     the module has been added (see bfelf_file_compact)
+ * @var module_t::compact_size
+ *     the size of the compacted copy of the ELF file
+ * @var module_t::fsize
+ *     the size of the ELF file that was added
+ * @var module_t::hash
+ *     the hash of the ELF file's contents
+ * @var module_t::cached
+ *     1 if the execution buffer is owned by the module cache, 0 otherwise
  */
 struct module_t
 {
     char *exec;
     uint64_t size;
     struct bfelf_file_t file;
+
+    char *compact;
+    uint64_t compact_size;
+
+    uint64_t fsize;
+    uint64_t hash;
+    int64_t cached;
+};
+
+/**
+ * This structure defines an entry in the module cache. Once the VMM has
+ * been loaded, the relocated execution buffer of each module is kept by the
+ * cache, along with a copy of each of the module's writable segments as
+ * they were right after relocation (i.e. before any constructors were
+ * run). If the same module is added again, the writable segments are
+ * restored from this snapshot instead of loading the module again.
+ *
+ * @var module_cache_entry_t::hash
+ *     the hash of the ELF file's contents
+ * @var module_cache_entry_t::fsize
+ *     the size of the ELF file in bytes
+ * @var module_cache_entry_t::exec
+ *     the relocated execution buffer
+ * @var module_cache_entry_t::size
+ *     the size of the execution buffer
+ * @var module_cache_entry_t::snapshot
+ *     a copy of the writable segments after relocation
+ * @var module_cache_entry_t::snapshot_size
+ *     the size of the snapshot
+ */
+struct module_cache_entry_t
+{
+    uint64_t hash;
+    uint64_t fsize;
+
+    char *exec;
+    uint64_t size;
+
+    char *snapshot;
+    uint64_t snapshot_size;
 };
 
 /* -------------------------------------------------------------------------- */
@@ -109,12 +160,11 @@ common_fini(void);
  *
  * Add's a module into memory to be executed once start_vmm is run. This
  * function uses the platform functions to allocate memory for the executable.
- * The file that is provided should not be removed until after stop_vmm is
- * run. Removing the file from memory could cause a crash, as the start_vmm
- * function uses the file that is being added to search for symbols that are
- * needed, as well as the stop_vmm function. Once stop_vmm is run, it's safe
- * to remove the files. Also, this function cannot be run if the vmm has
- * already been started.
+ * The module's segments are copied into the executable, and the ELF headers
+ * and the tables needed to relocate the module and search for its symbols
+ * are copied into memory owned by the module, so the file that is provided
+ * can be removed as soon as this function returns. Also, this function
+ * cannot be run if the vmm has already been started.
  *
  * @param file the file to add to memory
  * @param fsize the size of the file in bytes
@@ -123,6 +173,19 @@ common_fini(void);
 int64_t
 common_add_module(const char *file, uint64_t fsize);
 
+/**
+ * Remove Modules
+ *
+ * Removes the last num modules that were added, so that a set of modules
+ * that could not be added completely can be backed out. This function
+ * cannot be run once the vmm has been loaded.
+ *
+ * @param num the number of modules to remove
+ * @return BF_SUCCESS on success, negative error code on failure
+ */
+int64_t
+common_remove_modules(int64_t num);
+
 /**
  * Load VMM
  *
@@ -197,6 +260,34 @@ common_dump_vmm(struct debug_ring_resources_t **drr, uint64_t vcpuid);
 int64_t
 common_vmcall(struct vmcall_registers_t *regs, uint64_t cpuid);
 
+/**
+ * Invalidate Module Cache
+ *
+ * Releases the relocated module images that the driver entry keeps after
+ * the VMM is unloaded. The next load will copy and relocate each module
+ * again. If the VMM is currently loaded, the modules that are in use keep
+ * their images until the VMM is unloaded. This function can be called in
+ * any state.
+ *
+ * @return will always return BF_SUCCESS
+ */
+int64_t
+common_invalidate_cache(void);
+
+/**
+ * Lazy Resolve
+ *
+ * Called by platform_lazy_trampoline the first time a VMM module calls a
+ * function through a PLT entry that has not been bound yet. This binds the
+ * entry, so that the next call goes straight to the function.
+ *
+ * @param ef the ELF file of the module that made the call
+ * @param index the index of the PLT entry's relocation
+ * @return the address of the function on success, 0 on failure
+ */
+uint64_t
+common_lazy_resolve(struct bfelf_file_t *ef, uint64_t index);
+
 #ifdef __cplusplus
 }
 #endif
@@ -50,6 +50,20 @@ void *platform_alloc_rw(uint64_t len);
  */
 void *platform_alloc_rwe(uint64_t len);
 
+/**
+ * Allocate Node Local Memory
+ *
+ * Used by the common code to allocate virtual memory that is backed by
+ * physical memory from the provided NUMA node. If the node does not have
+ * enough free memory, the memory may come from any node. The memory is
+ * freed using platform_free_rw.
+ *
+ * @param len the size of virtual memory to be allocated in bytes.
+ * @param node the NUMA node to allocate from (see platform_cpu_to_node)
+ * @return a virtual address pointing to the newly allocated memory
+ */
+void *platform_alloc_rw_node(uint64_t len, int64_t node);
+
 /**
  * Free Memory
  *
@@ -125,6 +139,17 @@ void platform_stop(void);
 int64_t
 platform_num_cpus(void);
 
+/**
+ * Get CPU NUMA Node
+ *
+ * Platforms without NUMA support should return 0 for every CPU.
+ *
+ * @param cpuid the cpu number to get the NUMA node of
+ * @return returns the NUMA node of the provided CPU
+ */
+int64_t
+platform_cpu_to_node(int64_t cpuid);
+
 /**
  * Set CPU affinity
  *
@@ -165,6 +190,18 @@ platform_vmcall(struct vmcall_registers_t *regs);
 void
 platform_vmcall_event(struct vmcall_registers_t *regs);
 
+/**
+ * Lazy Binding Trampoline
+ *
+ * This function is never called from C. When lazy binding is enabled, its
+ * address is written into GOT[2] of each VMM module, and it is jumped to by
+ * PLT0 with the module's ELF file and the relocation index on the stack. It
+ * saves the argument registers, calls common_lazy_resolve, restores the
+ * argument registers, and then jumps to the resolved function.
+ */
+void
+platform_lazy_trampoline(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -25,6 +25,7 @@
 #include <linux/uaccess.h>
 #include <linux/miscdevice.h>
 #include <linux/vmalloc.h>
+#include <linux/mm.h>
 #include <linux/kallsyms.h>
 #include <linux/notifier.h>
 #include <linux/reboot.h>
@@ -42,8 +43,6 @@
 uint64_t g_module_length = 0;
 
 int64_t g_num_files = 0;
-char *files[MAX_NUM_MODULES] = {0};
-uint64_t files_size[MAX_NUM_MODULES] = { 0 };
 
 uint64_t g_cpuid = 0;
 uint64_t g_vcpuid = 0;
@@ -73,65 +72,182 @@ dev_release(struct inode *inode, struct file *file)
 }
 
 static long
-ioctl_add_module(char *file)
+add_module(const char *file, uint64_t len, const char *name)
 {
-    char *buf;
+    int64_t i;
     int64_t ret;
+    int64_t num_pages;
+    int64_t num_pinned;
+    uint64_t offset;
+    char *buf = 0;
+    struct page **pages = 0;
 
     if (g_num_files >= MAX_NUM_MODULES)
     {
-        ALERT("IOCTL_ADD_MODULE: too many modules have been loaded\n");
+        ALERT("%s: too many modules have been loaded\n", name);
         return BF_IOCTL_FAILURE;
     }
 
+    if (len == 0)
+    {
+        ALERT("%s: failed with len == 0\n", name);
+        return BF_IOCTL_FAILURE;
+    }
+
+    /*
+     * Linux does not copy userspace memory for us. Instead of copying the
+     * whole module into kernel memory, only to copy its segments again,
+     * userspace's pages are pinned and mapped, and the module is added
+     * straight from them. common_add_module copies the segments into the
+     * module's executable, and keeps its own copy of the tables that the
+     * ELF loader needs, so the pages are released once it returns.
+     */
+
+    offset = (uint64_t)file & ~PAGE_MASK;
+    num_pages = (int64_t)((offset + len + PAGE_SIZE - 1) >> PAGE_SHIFT);
+
+    pages = vmalloc(num_pages * sizeof(struct page *));
+    if (pages == NULL)
+    {
+        ALERT("%s: failed to allocate memory for the module's pages\n", name);
+        return BF_IOCTL_FAILURE;
+    }
+
+    num_pinned = get_user_pages_fast((unsigned long)file & PAGE_MASK, (int)num_pages, 0, pages);
+    if (num_pinned != num_pages)
+    {
+        ALERT("%s: failed to pin the module's pages\n", name);
+        goto failed;
+    }
+
+    buf = vmap(pages, (unsigned int)num_pages, VM_MAP, PAGE_KERNEL_RO);
+    if (buf == NULL)
+    {
+        ALERT("%s: failed to map the module's pages\n", name);
+        goto failed;
+    }
+
+    ret = common_add_module(buf + offset, len);
+    if (ret != BF_SUCCESS)
+    {
+        ALERT("%s: common_add_module failed: %p - %s\n", name, \
+              (void *)ret, ec_to_str(ret));
+        goto failed;
+    }
+
+    vunmap(buf);
+
+    for (i = 0; i < num_pinned; i++)
+        put_page(pages[i]);
+
+    vfree(pages);
+
+    g_num_files++;
+    return BF_IOCTL_SUCCESS;
+
+failed:
+
+    if (buf != NULL)
+        vunmap(buf);
+
+    for (i = 0; i < num_pinned; i++)
+        put_page(pages[i]);
+
+    vfree(pages);
+    return BF_IOCTL_FAILURE;
+}
+
+static long
+ioctl_add_module(char *file)
+{
     /*
      * On Linux, we are not given a size for the IOCTL. Appearently
      * it is common practice to seperate this information into two
      * different IOCTLs, which is what we do here. This however means
      * that we have to store state, so userspace has to be careful
      * to send these IOCTLs in the correct order.
-     *
-     * Linux also does not copy userspace memory for us, so we need
-     * to do this ourselves. As a result, we alloc memory for the
-     * buffer that userspace is providing us so that we can copy this
-     * memory from userspace as needed.
      */
 
-    buf = vmalloc(g_module_length);
-    if (buf == NULL)
+    if (add_module(file, g_module_length, "IOCTL_ADD_MODULE") != BF_IOCTL_SUCCESS)
     {
-        ALERT("IOCTL_ADD_MODULE: failed to allocate memory for the module\n");
+        DEBUG("IOCTL_ADD_MODULE: failed\n");
         return BF_IOCTL_FAILURE;
     }
 
-    ret = copy_from_user(buf, file, g_module_length);
+    DEBUG("IOCTL_ADD_MODULE: succeeded\n");
+    return BF_IOCTL_SUCCESS;
+}
+
+static long
+ioctl_add_modules(struct module_list_t *list)
+{
+    uint64_t i;
+    int64_t ret;
+    struct module_list_t *kern_list;
+
+    if (list == 0)
+    {
+        ALERT("IOCTL_ADD_MODULES: failed with list == NULL\n");
+        return BF_IOCTL_FAILURE;
+    }
+
+    kern_list = vmalloc(sizeof(struct module_list_t));
+    if (kern_list == NULL)
+    {
+        ALERT("IOCTL_ADD_MODULES: failed to allocate memory for the list\n");
+        return BF_IOCTL_FAILURE;
+    }
+
+    ret = copy_from_user(kern_list, list, sizeof(struct module_list_t));
     if (ret != 0)
     {
-        ALERT("IOCTL_ADD_MODULE: failed to copy memory from userspace\n");
+        ALERT("IOCTL_ADD_MODULES: failed to copy memory from userspace\n");
         goto failed;
     }
 
-    ret = common_add_module(buf, g_module_length);
-    if (ret != BF_SUCCESS)
+    if (kern_list->num_modules > (uint64_t)(MAX_NUM_MODULES - g_num_files))
     {
-        ALERT("IOCTL_ADD_MODULE: common_add_module failed: %p - %s\n", \
-              (void *)ret, ec_to_str(ret));
+        ALERT("IOCTL_ADD_MODULES: too many modules: %d\n", (int)kern_list->num_modules);
         goto failed;
     }
 
-    files[g_num_files] = buf;
-    files_size[g_num_files] = g_module_length;
+    for (i = 0; i < kern_list->num_modules; i++)
+    {
+        ret = add_module((const char *)kern_list->modules[i].addr,
+                         kern_list->modules[i].size, "IOCTL_ADD_MODULES");
 
-    g_num_files++;
+        if (ret != BF_IOCTL_SUCCESS)
+            goto remove;
+    }
 
-    DEBUG("IOCTL_ADD_MODULE: succeeded\n");
+    vfree(kern_list);
+
+    DEBUG("IOCTL_ADD_MODULES: succeeded\n");
     return BF_IOCTL_SUCCESS;
 
+remove:
+
+    /*
+     * The list is added as a whole, so the modules from this list that
+     * were added before the one that failed are removed again.
+     */
+
+    ret = common_remove_modules((int64_t)i);
+    if (ret != BF_SUCCESS)
+    {
+        ALERT("IOCTL_ADD_MODULES: common_remove_modules failed: %p - %s\n", \
+              (void *)ret, ec_to_str(ret));
+    }
+    else
+    {
+        g_num_files -= (int64_t)i;
+    }
+
 failed:
 
-    vfree(buf);
+    vfree(kern_list);
 
-    DEBUG("IOCTL_ADD_MODULE: failed\n");
+    DEBUG("IOCTL_ADD_MODULES: failed\n");
     return BF_IOCTL_FAILURE;
 }
 
@@ -160,7 +276,6 @@ ioctl_add_module_length(uint64_t *len)
 static long
 ioctl_unload_vmm(void)
 {
-    int i;
     int64_t ret;
     long status = BF_IOCTL_SUCCESS;
 
@@ -172,14 +287,6 @@ ioctl_unload_vmm(void)
         status = BF_IOCTL_FAILURE;
     }
 
-    for (i = 0; i < g_num_files; i++)
-    {
-        vfree(files[i]);
-
-        files[i] = 0;
-        files_size[i] = 0;
-    }
-
     g_num_files = 0;
 
     if (status == BF_IOCTL_SUCCESS)
@@ -379,6 +486,23 @@ ioctl_vmcall(struct vmcall_registers_t *regs)
     return BF_IOCTL_SUCCESS;
 }
 
+static long
+ioctl_invalidate_cache(void)
+{
+    int64_t ret;
+
+    ret = common_invalidate_cache();
+    if (ret != BF_SUCCESS)
+    {
+        ALERT("IOCTL_INVALIDATE_CACHE: common_invalidate_cache failed: %p - %s\n", \
+              (void *)ret, ec_to_str(ret));
+        return BF_IOCTL_FAILURE;
+    }
+
+    DEBUG("IOCTL_INVALIDATE_CACHE: succeeded\n");
+    return BF_IOCTL_SUCCESS;
+}
+
 static long
 dev_unlocked_ioctl(struct file *file,
                    unsigned int cmd,
@@ -421,6 +545,12 @@ dev_unlocked_ioctl(struct file *file,
         case IOCTL_VMCALL:
             return ioctl_vmcall((struct vmcall_registers_t *)arg);
 
+        case IOCTL_INVALIDATE_CACHE:
+            return ioctl_invalidate_cache();
+
+        case IOCTL_ADD_MODULES:
+            return ioctl_add_modules((struct module_list_t *)arg);
+
         default:
             return -EINVAL;
     }
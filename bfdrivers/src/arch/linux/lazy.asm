@@ -0,0 +1,65 @@
+;
+; Bareflank Hypervisor
+;
+; Copyright (C) 2015 Assured Information Security, Inc.
+; Author: Rian Quinn        <quinnr@ainfosec.com>
+; Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+;
+; This library is free software; you can redistribute it and/or
+; modify it under the terms of the GNU Lesser General Public
+; License as published by the Free Software Foundation; either
+; version 2.1 of the License, or (at your option) any later version.
+;
+; This library is distributed in the hope that it will be useful,
+; but WITHOUT ANY WARRANTY; without even the implied warranty of
+; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+; Lesser General Public License for more details.
+;
+
+bits 64
+default rel
+
+section .text
+
+extern common_lazy_resolve
+
+; PLT0 jumps here with the module's ELF file (GOT[1]) at [rsp], and the
+; index of the jump slot's relocation at [rsp + 8]. The argument registers
+; belong to the function being called, so they are saved around the call to
+; the resolver, and the resolved function is jumped to (not called), so that
+; it returns directly to the original caller. The kernel is compiled
+; without SSE, so the vector registers are not touched by the resolver.
+
+global platform_lazy_trampoline:function
+platform_lazy_trampoline:
+
+    push rax
+    push rcx
+    push rdx
+    push rsi
+    push rdi
+    push r8
+    push r9
+    push r10
+
+    sub rsp, 8
+
+    mov rdi, [rsp + 0x48]
+    mov rsi, [rsp + 0x50]
+    call common_lazy_resolve
+
+    mov r11, rax
+
+    add rsp, 8
+
+    pop r10
+    pop r9
+    pop r8
+    pop rdi
+    pop rsi
+    pop rdx
+    pop rcx
+    pop rax
+
+    add rsp, 16
+    jmp r11
@@ -21,6 +21,7 @@
  */
 
 #include <platform.h>
+#include <constants.h>
 
 #include <debug.h>
 #include <linux/mm.h>
@@ -30,6 +31,8 @@
 #include <linux/vmalloc.h>
 #include <linux/version.h>
 #include <linux/cpumask.h>
+#include <linux/nodemask.h>
+#include <linux/topology.h>
 #include <linux/sched.h>
 #include <linux/kallsyms.h>
 
@@ -38,6 +41,37 @@
 typedef long (*set_affinity_fn)(pid_t, const struct cpumask *);
 set_affinity_fn set_cpu_affinity = 0;
 
+/*
+ * Allocations that are a power of two number of large pages are first
+ * allocated from the page allocator, which returns physically contiguous
+ * memory that is naturally aligned, so that the VMM can map it with large
+ * pages. If the page allocator cannot satisfy the request (e.g. because
+ * memory is fragmented), vmalloc is used instead.
+ */
+static int
+platform_is_contiguous_len(uint64_t len)
+{
+    if (len < LARGE_PAGE_SIZE)
+        return 0;
+
+    return len == (PAGE_SIZE << get_order(len));
+}
+
+static void *
+platform_alloc_contiguous(uint64_t len, int node)
+{
+    struct page *page = NULL;
+
+    if (platform_is_contiguous_len(len) == 0)
+        return NULL;
+
+    page = alloc_pages_node(node, GFP_KERNEL | __GFP_NOWARN | __GFP_NORETRY, get_order(len));
+    if (page == NULL)
+        return NULL;
+
+    return page_address(page);
+}
+
 void *
 platform_alloc_rw(uint64_t len)
 {
@@ -49,6 +83,10 @@ platform_alloc_rw(uint64_t len)
         return addr;
     }
 
+    addr = platform_alloc_contiguous(len, NUMA_NO_NODE);
+    if (addr != NULL)
+        return addr;
+
     addr = vmalloc(len);
 
     if (addr == NULL)
@@ -57,6 +95,32 @@ platform_alloc_rw(uint64_t len)
     return addr;
 }
 
+void *
+platform_alloc_rw_node(uint64_t len, int64_t node)
+{
+    void *addr = NULL;
+
+    if (len == 0)
+    {
+        ALERT("platform_alloc_rw_node: invalid length\n");
+        return addr;
+    }
+
+    if (node < 0 || node >= nr_node_ids || !node_online(node))
+        return platform_alloc_rw(len);
+
+    addr = platform_alloc_contiguous(len, (int)node);
+    if (addr != NULL)
+        return addr;
+
+    addr = vmalloc_node(len, (int)node);
+
+    if (addr == NULL)
+        ALERT("platform_alloc_rw_node: failed to vmalloc mem: %lld on node %lld\n", len, node);
+
+    return addr;
+}
+
 void *
 platform_alloc_rwe(uint64_t len)
 {
@@ -79,15 +143,16 @@ platform_alloc_rwe(uint64_t len)
 void
 platform_free_rw(void *addr, uint64_t len)
 {
-    (void) len;
-
     if (addr == NULL)
     {
         ALERT("platform_free_rw: invalid address %p\n", addr);
         return;
     }
 
-    vfree(addr);
+    if (is_vmalloc_addr(addr))
+        vfree(addr);
+    else
+        free_pages((unsigned long)addr, get_order(len));
 }
 
 void
@@ -158,6 +223,17 @@ platform_num_cpus(void)
     return num_cpus;
 }
 
+int64_t
+platform_cpu_to_node(int64_t cpuid)
+{
+    int node = cpu_to_node((int)cpuid);
+
+    if (node < 0)
+        return 0;
+
+    return node;
+}
+
 int64_t
 platform_set_affinity(int64_t affinity)
 {
@@ -291,6 +291,22 @@ ioctl_vmm_status(int64_t *status)
     return BF_IOCTL_SUCCESS;
 }
 
+static long
+ioctl_invalidate_cache(void)
+{
+    int64_t ret;
+
+    ret = common_invalidate_cache();
+    if (ret != BF_SUCCESS)
+    {
+        ALERT("IOCTL_INVALIDATE_CACHE: failed to invalidate cache: %lld\n", ret);
+        return BF_IOCTL_FAILURE;
+    }
+
+    DEBUG("IOCTL_INVALIDATE_CACHE: succeeded\n");
+    return BF_IOCTL_SUCCESS;
+}
+
 
 IOReturn org_bareflank_osx::methodCommand(bf_ioctl_t *in_ioctl, bf_ioctl_t *out_ioctl, uint32_t inStructSize, uint32_t *outStructSize)
 {
@@ -329,6 +345,9 @@ IOReturn org_bareflank_osx::methodCommand(bf_ioctl_t *in_ioctl, bf_ioctl_t *out_
         case IOCTL_VMM_STATUS:
             rc = ioctl_vmm_status((int64_t *)in_ioctl->addr);
             break;
+        case IOCTL_INVALIDATE_CACHE:
+            rc = ioctl_invalidate_cache();
+            break;
         default:
             return (IOReturn) - EINVAL;
     }
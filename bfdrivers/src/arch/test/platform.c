@@ -49,13 +49,31 @@ verify_no_mem_leaks(void)
 void *
 platform_alloc_rw(uint64_t len)
 {
+    void *addr = 0;
+
     if (g_malloc_fails == len)
         return 0;
 
+    if (len != 0 && (len & (LARGE_PAGE_SIZE - 1)) == 0)
+    {
+        if (posix_memalign(&addr, LARGE_PAGE_SIZE, len) != 0)
+            return 0;
+
+        alloc_count_rw++;
+        return addr;
+    }
+
     alloc_count_rw++;
     return malloc(len);
 }
 
+void *
+platform_alloc_rw_node(uint64_t len, int64_t node)
+{
+    (void) node;
+    return platform_alloc_rw(len);
+}
+
 #include <errno.h>
 
 void *
@@ -140,6 +158,13 @@ platform_num_cpus(void)
     return 1;
 }
 
+int64_t
+platform_cpu_to_node(int64_t cpuid)
+{
+    (void) cpuid;
+    return 0;
+}
+
 int64_t
 platform_set_affinity(int64_t affinity)
 {
@@ -168,3 +193,8 @@ platform_vmcall_event(struct vmcall_registers_t *regs)
 {
     (void) regs;
 }
+
+void
+platform_lazy_trampoline(void)
+{
+}
@@ -0,0 +1,76 @@
+;
+; Bareflank Hypervisor
+;
+; Copyright (C) 2015 Assured Information Security, Inc.
+; Author: Rian Quinn        <quinnr@ainfosec.com>
+; Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+;
+; This library is free software; you can redistribute it and/or
+; modify it under the terms of the GNU Lesser General Public
+; License as published by the Free Software Foundation; either
+; version 2.1 of the License, or (at your option) any later version.
+;
+; This library is distributed in the hope that it will be useful,
+; but WITHOUT ANY WARRANTY; without even the implied warranty of
+; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+; Lesser General Public License for more details.
+;
+
+extern common_lazy_resolve:proc
+
+.code
+
+; PLT0 jumps here with the module's ELF file (GOT[1]) at [rsp], and the
+; index of the jump slot's relocation at [rsp + 8]. The VMM uses the System V
+; calling convention, so its argument registers (rdi, rsi, rdx, rcx, r8, r9,
+; rax and xmm0-7) are saved around the call to the resolver. rdi, rsi and
+; xmm6-7 are preserved by the Windows calling convention, and 20h bytes of
+; shadow space are reserved for the resolver. The resolved function is
+; jumped to (not called), so that it returns directly to the original caller.
+
+platform_lazy_trampoline PROC
+
+    push rax
+    push rcx
+    push rdx
+    push r8
+    push r9
+    push r10
+
+    sub rsp, 88h
+
+    movdqu [rsp + 20h], xmm0
+    movdqu [rsp + 30h], xmm1
+    movdqu [rsp + 40h], xmm2
+    movdqu [rsp + 50h], xmm3
+    movdqu [rsp + 60h], xmm4
+    movdqu [rsp + 70h], xmm5
+
+    mov rcx, [rsp + 0B8h]
+    mov rdx, [rsp + 0C0h]
+    call common_lazy_resolve
+
+    mov r11, rax
+
+    movdqu xmm5, [rsp + 70h]
+    movdqu xmm4, [rsp + 60h]
+    movdqu xmm3, [rsp + 50h]
+    movdqu xmm2, [rsp + 40h]
+    movdqu xmm1, [rsp + 30h]
+    movdqu xmm0, [rsp + 20h]
+
+    add rsp, 88h
+
+    pop r10
+    pop r9
+    pop r8
+    pop rdx
+    pop rcx
+    pop rax
+
+    add rsp, 10h
+    jmp r11
+
+platform_lazy_trampoline ENDP
+
+end
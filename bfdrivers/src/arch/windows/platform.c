@@ -47,6 +47,13 @@ platform_alloc_rw(uint64_t len)
     return addr;
 }
 
+void *
+platform_alloc_rw_node(uint64_t len, int64_t node)
+{
+    (void) node;
+    return platform_alloc_rw(len);
+}
+
 void *
 platform_alloc_rwe(uint64_t len)
 {
@@ -139,6 +146,13 @@ platform_num_cpus()
     return (int64_t)KeQueryActiveProcessorCount(&k_affin);
 }
 
+int64_t
+platform_cpu_to_node(int64_t cpuid)
+{
+    (void) cpuid;
+    return 0;
+}
+
 int64_t
 platform_set_affinity(int64_t affinity)
 {
@@ -263,6 +263,23 @@ ioctl_vmcall(struct vmcall_registers_t *inregs, struct vmcall_registers_t *outre
     return BF_IOCTL_SUCCESS;
 }
 
+static int64_t
+ioctl_invalidate_cache(void)
+{
+    int64_t ret;
+
+    ret = common_invalidate_cache();
+    if (ret != BF_SUCCESS)
+    {
+        ALERT("IOCTL_INVALIDATE_CACHE: common_invalidate_cache failed: %p - %s\n", \
+              (void *)ret, ec_to_str(ret));
+        return BF_IOCTL_FAILURE;
+    }
+
+    DEBUG("IOCTL_INVALIDATE_CACHE: succeeded\n");
+    return BF_IOCTL_SUCCESS;
+}
+
 NTSTATUS
 bareflankQueueInitialize(
     _In_ WDFDEVICE Device
@@ -371,6 +388,10 @@ bareflankEvtIoDeviceControl(
             ret = ioctl_vmcall((struct vmcall_registers_t *)in, (struct vmcall_registers_t *)out);
             break;
 
+        case IOCTL_INVALIDATE_CACHE:
+            ret = ioctl_invalidate_cache();
+            break;
+
         default:
             goto FAILURE;
     }
@@ -50,11 +50,33 @@ uint64_t g_tls_size = 0;
 uint64_t g_stack_size = 0;
 uint64_t g_stack_top = 0;
 
+int64_t g_num_mem_chunks = 0;
+void *g_mem_chunks[VMM_HEAP_CHUNKS + VMM_PAGE_CHUNKS + VMM_RESERVE_CHUNKS];
+
+/* -------------------------------------------------------------------------- */
+/* Module Cache                                                               */
+/* -------------------------------------------------------------------------- */
+
+int64_t g_num_cached_modules = 0;
+struct module_cache_entry_t g_module_cache[MAX_NUM_MODULES];
+
+struct bfelf_loader_t *g_module_cache_loader = 0;
+
+uint64_t g_module_cache_hits = 0;
+uint64_t g_module_cache_misses = 0;
+
+/* -------------------------------------------------------------------------- */
+/* Lazy Binding                                                               */
+/* -------------------------------------------------------------------------- */
+
+const char *g_lazy_preload[] = {LAZY_BINDING_PRELOAD, 0};
+
 /* -------------------------------------------------------------------------- */
 /* Entry Points                                                               */
 /* -------------------------------------------------------------------------- */
 
 execute_entry_t execute_entry = 0;
+struct vmm_entry_vector_t g_entry_vector;
 
 /* -------------------------------------------------------------------------- */
 /* Helpers                                                                    */
@@ -109,26 +131,77 @@ resolve_symbol(const char *name, void **sym)
 }
 
 int64_t
-execute_symbol(const char *sym, uint64_t arg1, uint64_t arg2, uint64_t cpuid)
+lookup_entry(const char *name, void **entry)
+{
+    struct e_string_t str = {0, 0};
+
+    if (*entry != 0)
+        return BF_SUCCESS;
+
+    str.buf = name;
+    str.len = symbol_length(name);
+
+    return bfelf_loader_resolve_symbol(&g_loader, &str, entry);
+}
+
+int64_t
+resolve_entry_vector(void)
 {
     int64_t ret = 0;
-    void *entry_point = 0;
-    struct thread_context_t *tc = (struct thread_context_t *)(g_stack_top - sizeof(struct thread_context_t));
+    int64_t ignore_ret = 0;
+    struct vmm_entry_vector_t *vector = 0;
 
-    if (sym == 0)
-        return BF_ERROR_INVALID_ARG;
+    platform_memset(&g_entry_vector, 0, sizeof(struct vmm_entry_vector_t));
 
-    ret = resolve_symbol(sym, &entry_point);
+    ret = resolve_symbol("execute_entry", (void **)&execute_entry);
     if (ret != BF_SUCCESS)
         return ret;
 
+    /*
+     * The rest of the entry points are optional at this point, as not every
+     * VMM provides all of them. A missing entry point is only an error
+     * once it is needed, which is reported by execute_entry_point.
+     */
+
+    ignore_ret = lookup_entry("vmm_entry_vector", (void **)&vector);
+    if (ignore_ret == BFELF_SUCCESS)
+        platform_memcpy(&g_entry_vector, vector, sizeof(struct vmm_entry_vector_t));
+
+    ignore_ret = lookup_entry("local_init", &g_entry_vector.local_init);
+    ignore_ret = lookup_entry("local_fini", &g_entry_vector.local_fini);
+    ignore_ret = lookup_entry("add_md", &g_entry_vector.add_md);
+    ignore_ret = lookup_entry("add_mem_chunk", &g_entry_vector.add_mem_chunk);
+    ignore_ret = lookup_entry("start_vmm", &g_entry_vector.start_vmm);
+    ignore_ret = lookup_entry("stop_vmm", &g_entry_vector.stop_vmm);
+    ignore_ret = lookup_entry("get_drr", &g_entry_vector.get_drr);
+    (void) ignore_ret;
+
+    return BF_SUCCESS;
+}
+
+int64_t
+execute_entry_point(void *entry_point, const char *name, uint64_t arg1, uint64_t arg2, uint64_t cpuid)
+{
+    int64_t ret = 0;
+    struct thread_context_t *tc = (struct thread_context_t *)(g_stack_top - sizeof(struct thread_context_t));
+
+    if (name == 0)
+        return BF_ERROR_INVALID_ARG;
+
+    if (entry_point == 0)
+    {
+        ALERT("Failed to find: %s\n", name);
+        return BFELF_ERROR_NO_SUCH_SYMBOL;
+    }
+
     tc->cpuid = cpuid;
     tc->tlsptr = (uint64_t)g_tls + (THREAD_LOCAL_STORAGE_SIZE * cpuid);
+    tc->node = (uint64_t)platform_cpu_to_node((int64_t)cpuid);
 
     ret = execute_entry(g_stack_top - sizeof(struct thread_context_t) - 1, entry_point, arg1, arg2);
     if (ret != ENTRY_SUCCESS)
     {
-        ALERT("%s failed\n", sym);
+        ALERT("%s failed\n", name);
         return ret;
     }
 
@@ -136,22 +209,103 @@ execute_symbol(const char *sym, uint64_t arg1, uint64_t arg2, uint64_t cpuid)
 }
 
 int64_t
-add_raw_md_to_memory_manager(uint64_t virt, uint64_t type)
+execute_symbol(const char *sym, uint64_t arg1, uint64_t arg2, uint64_t cpuid)
 {
     int64_t ret = 0;
-    struct memory_descriptor md = {0, 0, 0};
+    void *entry_point = 0;
+
+    if (sym == 0)
+        return BF_ERROR_INVALID_ARG;
+
+    ret = resolve_symbol(sym, &entry_point);
+    if (ret != BF_SUCCESS)
+        return ret;
+
+    return execute_entry_point(entry_point, sym, arg1, arg2, cpuid);
+}
+
+int64_t
+is_large_page(uint64_t virt, uint64_t end)
+{
+    uint64_t i = 0;
+    uint64_t phys = 0;
+
+    if ((virt & (LARGE_PAGE_SIZE - 1)) != 0)
+        return 0;
+
+    if (end < virt || end - virt < LARGE_PAGE_SIZE)
+        return 0;
+
+    phys = (uint64_t)platform_virt_to_phys((void *)virt);
+    if ((phys & (LARGE_PAGE_SIZE - 1)) != 0)
+        return 0;
+
+    for (i = MAX_PAGE_SIZE; i < LARGE_PAGE_SIZE; i += MAX_PAGE_SIZE)
+    {
+        if ((uint64_t)platform_virt_to_phys((void *)(virt + i)) != phys + i)
+            return 0;
+    }
+
+    return 1;
+}
+
+int64_t
+add_sized_md_to_memory_manager(uint64_t virt, uint64_t size, uint64_t type)
+{
+    int64_t ret = 0;
+    struct memory_descriptor md = {0, 0, 0, 0};
 
     md.virt = virt;
     md.phys = (uint64_t)platform_virt_to_phys((void *)md.virt);
     md.type = type;
+    md.size = size;
 
-    ret = execute_symbol("add_md", (uint64_t)&md, 0, 0);
+    ret = execute_entry_point(g_entry_vector.add_md, "add_md", (uint64_t)&md, 0, 0);
     if (ret != MEMORY_MANAGER_SUCCESS)
         return ret;
 
     return BF_SUCCESS;
 }
 
+int64_t
+add_raw_md_to_memory_manager(uint64_t virt, uint64_t type)
+{
+    return add_sized_md_to_memory_manager(virt, MAX_PAGE_SIZE, type);
+}
+
+/*
+ * Adds the memory descriptors for the page aligned range [virt, virt + size).
+ * Each part of the range that is physically contiguous, and aligned to a
+ * large page is given to the VMM with a single memory descriptor, so that
+ * the VMM can map it with a large page. The rest of the range is given to
+ * the VMM one page at a time.
+ */
+int64_t
+add_raw_mds_to_memory_manager(uint64_t virt, uint64_t size, uint64_t type)
+{
+    int64_t ret = 0;
+    uint64_t end = virt + size;
+
+    while (virt < end)
+    {
+        if (is_large_page(virt, end) != 0)
+        {
+            ret = add_sized_md_to_memory_manager(virt, LARGE_PAGE_SIZE, type);
+            virt += LARGE_PAGE_SIZE;
+        }
+        else
+        {
+            ret = add_raw_md_to_memory_manager(virt, type);
+            virt += MAX_PAGE_SIZE;
+        }
+
+        if (ret != BF_SUCCESS)
+            return ret;
+    }
+
+    return BF_SUCCESS;
+}
+
 int64_t
 add_md_to_memory_manager(struct module_t *module)
 {
@@ -175,17 +329,109 @@ add_md_to_memory_manager(struct module_t *module)
         exec_e = (uint64_t)module->exec + phdr->p_vaddr + phdr->p_memsz;
         exec_s &= ~(MAX_PAGE_SIZE - 1);
         exec_e &= ~(MAX_PAGE_SIZE - 1);
+        exec_e += MAX_PAGE_SIZE;
 
-        for (; exec_s <= exec_e; exec_s += MAX_PAGE_SIZE)
-        {
-            if ((phdr->p_flags & bfpf_x) != 0)
-                ret = add_raw_md_to_memory_manager(exec_s, MEMORY_TYPE_R | MEMORY_TYPE_E);
-            else
-                ret = add_raw_md_to_memory_manager(exec_s, MEMORY_TYPE_R | MEMORY_TYPE_W);
+        if ((phdr->p_flags & bfpf_x) != 0)
+            ret = add_raw_mds_to_memory_manager(exec_s, exec_e - exec_s, MEMORY_TYPE_R | MEMORY_TYPE_E);
+        else
+            ret = add_raw_mds_to_memory_manager(exec_s, exec_e - exec_s, MEMORY_TYPE_R | MEMORY_TYPE_W);
 
-            if (ret != MEMORY_MANAGER_SUCCESS)
-                return ret;
-        }
+        if (ret != MEMORY_MANAGER_SUCCESS)
+            return ret;
+    }
+
+    return BF_SUCCESS;
+}
+
+int64_t
+add_mem_chunk_to_memory_manager(uint64_t type, uint64_t node)
+{
+    int64_t ret = 0;
+    void *chunk = 0;
+    struct memory_chunk mc = {0, 0, 0, 0};
+
+    if (g_num_mem_chunks >= (int64_t)(VMM_HEAP_CHUNKS + VMM_PAGE_CHUNKS + VMM_RESERVE_CHUNKS))
+        return BF_ERROR_OUT_OF_MEMORY;
+
+    if (node == MEMORY_CHUNK_ANY_NODE)
+        chunk = platform_alloc_rw(MEM_CHUNK_SIZE);
+    else
+        chunk = platform_alloc_rw_node(MEM_CHUNK_SIZE, (int64_t)node);
+
+    if (chunk == 0)
+        return BF_ERROR_OUT_OF_MEMORY;
+
+    g_mem_chunks[g_num_mem_chunks++] = chunk;
+
+    /*
+     * The memory manager expects chunks to be page aligned. The platform
+     * allocates page aligned memory for allocations of this size, but in
+     * case it does not, only the pages that are fully inside of the
+     * allocation are given to the VMM.
+     */
+
+    mc.virt = ((uint64_t)chunk + MAX_PAGE_SIZE - 1) & ~(MAX_PAGE_SIZE - 1);
+    mc.size = (MEM_CHUNK_SIZE - (mc.virt - (uint64_t)chunk)) & ~(MAX_PAGE_SIZE - 1);
+    mc.type = type;
+    mc.node = node;
+
+    ret = add_raw_mds_to_memory_manager(mc.virt, mc.size, MEMORY_TYPE_R | MEMORY_TYPE_W);
+    if (ret != BF_SUCCESS)
+        return ret;
+
+    ret = execute_entry_point(g_entry_vector.add_mem_chunk, "add_mem_chunk", (uint64_t)&mc, 0, 0);
+    if (ret != MEMORY_MANAGER_SUCCESS)
+        return ret;
+
+    return BF_SUCCESS;
+}
+
+uint64_t
+num_numa_nodes(void)
+{
+    int64_t cpuid = 0;
+    uint64_t num_nodes = 1;
+
+    for (cpuid = 0; cpuid < platform_num_cpus(); cpuid++)
+    {
+        int64_t node = platform_cpu_to_node(cpuid);
+
+        if (node >= 0 && (uint64_t)node >= num_nodes)
+            num_nodes = (uint64_t)node + 1;
+    }
+
+    return num_nodes;
+}
+
+int64_t
+add_mem_chunks_to_memory_manager(void)
+{
+    int64_t ret = 0;
+    uint64_t i = 0;
+    uint64_t num_nodes = num_numa_nodes();
+
+    for (i = 0; i < VMM_HEAP_CHUNKS + VMM_PAGE_CHUNKS + VMM_RESERVE_CHUNKS; i++)
+    {
+        uint64_t type = MEMORY_CHUNK_RESERVE;
+        uint64_t node = MEMORY_CHUNK_ANY_NODE;
+
+        if (i < VMM_HEAP_CHUNKS)
+            type = MEMORY_CHUNK_HEAP;
+        else if (i < VMM_HEAP_CHUNKS + VMM_PAGE_CHUNKS)
+            type = MEMORY_CHUNK_PAGE;
+
+        /*
+         * On NUMA systems, the page chunks are spread across the nodes, so
+         * that the VMCS regions, stacks, etc... of each CPU can come from
+         * memory that is local to that CPU.
+         */
+
+        if (type == MEMORY_CHUNK_PAGE && num_nodes > 1)
+            node = (i - VMM_HEAP_CHUNKS) % num_nodes;
+
+        ret = add_mem_chunk_to_memory_manager(type, node);
+        if (ret != BF_SUCCESS)
+            return ret;
     }
 
     return BF_SUCCESS;
@@ -252,6 +498,301 @@ load_elf_file(struct module_t *module)
     return BF_SUCCESS;
 }
 
+int64_t
+compact_elf_file(struct module_t *module)
+{
+    int64_t ret = 0;
+    int64_t size = 0;
+
+    if (module == 0)
+        return BF_ERROR_INVALID_ARG;
+
+    /*
+     * Once the segments are loaded, only the ELF headers and the tables used
+     * for relocation and symbol lookups are needed, so those are copied, and
+     * the caller does not have to keep the ELF file that was added.
+     */
+
+    size = bfelf_file_compact_size(&module->file);
+    if (size <= 0)
+        return size;
+
+    module->compact = platform_alloc_rw((uint64_t)size);
+    if (module->compact == 0)
+        return BF_ERROR_OUT_OF_MEMORY;
+
+    module->compact_size = (uint64_t)size;
+
+    ret = bfelf_file_compact(&module->file, module->compact, module->compact_size);
+    if (ret != BFELF_SUCCESS)
+    {
+        platform_free_rw(module->compact, module->compact_size);
+
+        module->compact = 0;
+        module->compact_size = 0;
+
+        return ret;
+    }
+
+    return BF_SUCCESS;
+}
+
+void
+free_module(struct module_t *module)
+{
+    if (module->exec != 0 && module->cached == 0)
+        platform_free_rwe(module->exec, module->size);
+
+    if (module->compact != 0)
+        platform_free_rw(module->compact, module->compact_size);
+
+    platform_memset(module, 0, sizeof(struct module_t));
+}
+
+uint64_t
+module_hash(const char *file, uint64_t fsize)
+{
+    uint64_t i = 0;
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    /*
+     * FNV-1a, 8 bytes at a time once the buffer is aligned. This is only
+     * used to detect that a module has changed since it was cached, so it
+     * is not meant to be collision resistant. Loading a VMM already
+     * requires the same privileges that would be needed to defeat it.
+     */
+
+    for (; i < fsize && ((uint64_t)(file + i) & 7) != 0; i++)
+        hash = (hash ^ (uint8_t)file[i]) * 0x100000001B3ULL;
+
+    for (; i + 8 <= fsize; i += 8)
+        hash = (hash ^ *(const uint64_t *)(file + i)) * 0x100000001B3ULL;
+
+    for (; i < fsize; i++)
+        hash = (hash ^ (uint8_t)file[i]) * 0x100000001B3ULL;
+
+    return hash;
+}
+
+uint64_t
+module_snapshot_size(struct module_t *module)
+{
+    bfelf64_word s = 0;
+    uint64_t total = 0;
+
+    if (module == 0)
+        return 0;
+
+    for (s = 0; s < bfelf_file_num_segments(&module->file); s++)
+    {
+        int64_t ret = 0;
+        struct bfelf_phdr *phdr = 0;
+
+        ret = bfelf_file_get_segment(&module->file, s, &phdr);
+        if (ret != BFELF_SUCCESS)
+            return 0;
+
+        if ((phdr->p_flags & bfpf_w) != 0)
+            total += phdr->p_memsz;
+    }
+
+    return total;
+}
+
+int64_t
+module_snapshot(struct module_t *module, char *snapshot, int64_t restore)
+{
+    bfelf64_word s = 0;
+
+    if (module == 0 || snapshot == 0)
+        return BF_ERROR_INVALID_ARG;
+
+    for (s = 0; s < bfelf_file_num_segments(&module->file); s++)
+    {
+        int64_t ret = 0;
+        char *segment = 0;
+        struct bfelf_phdr *phdr = 0;
+
+        ret = bfelf_file_get_segment(&module->file, s, &phdr);
+        if (ret != BFELF_SUCCESS)
+            return ret;
+
+        if ((phdr->p_flags & bfpf_w) == 0)
+            continue;
+
+        segment = module->exec + phdr->p_vaddr;
+
+        if (restore != 0)
+            platform_memcpy(segment, snapshot, phdr->p_memsz);
+        else
+            platform_memcpy(snapshot, segment, phdr->p_memsz);
+
+        snapshot += phdr->p_memsz;
+    }
+
+    return BF_SUCCESS;
+}
+
+uint64_t
+symbol_index_size(struct bfelf_loader_t *loader)
+{
+    return (uint64_t)loader->max_symbols * sizeof(struct bfelf_symbol_index_t);
+}
+
+void
+symbol_index_alloc(struct bfelf_loader_t *loader)
+{
+    int64_t size = 0;
+    struct bfelf_symbol_index_t *symbols = 0;
+
+    /*
+     * The symbol index is sized from the modules that were added. It only
+     * speeds up relocation, so if it cannot be allocated, the loader
+     * searches each module instead.
+     */
+
+    size = bfelf_loader_symbol_index_size(loader);
+    if (size <= 0)
+        return;
+
+    symbols = platform_alloc_rw((uint64_t)size);
+    if (symbols == 0)
+        return;
+
+    if (bfelf_loader_set_symbol_index(loader, symbols, (bfelf64_xword)size) != BFELF_SUCCESS)
+        platform_free_rw(symbols, (uint64_t)size);
+}
+
+struct bfelf_symbol_index_t *
+symbol_index_copy(struct bfelf_loader_t *loader)
+{
+    struct bfelf_symbol_index_t *symbols = 0;
+
+    if (loader->symbols == 0)
+        return 0;
+
+    symbols = platform_alloc_rw(symbol_index_size(loader));
+    if (symbols == 0)
+        return 0;
+
+    platform_memcpy(symbols, loader->symbols, symbol_index_size(loader));
+    return symbols;
+}
+
+void
+symbol_index_free(struct bfelf_loader_t *loader)
+{
+    if (loader->symbols != 0)
+        platform_free_rw(loader->symbols, symbol_index_size(loader));
+
+    loader->indexed = 0;
+    loader->symbols = 0;
+    loader->max_symbols = 0;
+}
+
+struct module_cache_entry_t *
+module_cache_lookup(int64_t index, struct module_t *module, uint64_t fsize)
+{
+    struct module_cache_entry_t *entry = 0;
+
+    if (index < 0 || index >= g_num_cached_modules)
+        return 0;
+
+    entry = &(g_module_cache[index]);
+
+    if (entry->hash != module->hash || entry->fsize != fsize)
+        return 0;
+
+    if (entry->size != module->size)
+        return 0;
+
+    return entry;
+}
+
+int64_t
+module_cache_hit(void)
+{
+    int64_t i = 0;
+
+    if (g_module_cache_loader == 0 || g_num_cached_modules != g_num_modules)
+        return 0;
+
+    for (i = 0; i < g_num_modules; i++)
+    {
+        if (g_modules[i].cached == 0)
+            return 0;
+    }
+
+    return 1;
+}
+
+void
+module_cache_commit(void)
+{
+    int64_t i = 0;
+    uint64_t total = sizeof(struct bfelf_loader_t);
+    struct module_t *module = 0;
+
+    common_invalidate_cache();
+
+    total += symbol_index_size(&g_loader);
+
+    for (i = 0; (module = get_module(i)) != 0; i++)
+        total += module->size + module_snapshot_size(module);
+
+    if (total > MAX_MODULE_CACHE_SIZE)
+        return;
+
+    g_module_cache_loader = platform_alloc_rw(sizeof(struct bfelf_loader_t));
+    if (g_module_cache_loader == 0)
+        return;
+
+    /*
+     * The cache keeps its own copy of the symbol index, as g_loader's copy
+     * is freed when the VMM is unloaded.
+     */
+
+    platform_memcpy(g_module_cache_loader, &g_loader, sizeof(struct bfelf_loader_t));
+    g_module_cache_loader->symbols = symbol_index_copy(&g_loader);
+
+    if (g_module_cache_loader->symbols == 0)
+        symbol_index_free(g_module_cache_loader);
+
+    for (i = 0; (module = get_module(i)) != 0; i++)
+    {
+        struct module_cache_entry_t *entry = &(g_module_cache[i]);
+
+        entry->snapshot_size = module_snapshot_size(module);
+        if (entry->snapshot_size != 0)
+        {
+            entry->snapshot = platform_alloc_rw(entry->snapshot_size);
+            if (entry->snapshot == 0)
+                goto failure;
+
+            if (module_snapshot(module, entry->snapshot, 0) != BF_SUCCESS)
+            {
+                platform_free_rw(entry->snapshot, entry->snapshot_size);
+                goto failure;
+            }
+        }
+
+        entry->hash = module->hash;
+        entry->fsize = module->fsize;
+        entry->exec = module->exec;
+        entry->size = module->size;
+
+        module->cached = 1;
+        g_num_cached_modules++;
+    }
+
+    return;
+
+failure:
+
+    platform_memset(&(g_module_cache[i]), 0, sizeof(struct module_cache_entry_t));
+    common_invalidate_cache();
+}
+
 /* -------------------------------------------------------------------------- */
 /* Implementation                                                             */
 /* -------------------------------------------------------------------------- */
@@ -268,19 +809,19 @@ common_reset(void)
     int64_t i;
 
     for (i = 0; i < g_num_modules; i++)
-    {
-        if (g_modules[i].exec != 0)
-            platform_free_rwe(g_modules[i].exec, g_modules[i].size);
-    }
+        free_module(&(g_modules[i]));
 
     platform_memset(&g_modules, 0, sizeof(g_modules));
 
     g_num_modules = 0;
     g_vmm_status = VMM_UNLOADED;
 
+    symbol_index_free(&g_loader);
     platform_memset(&g_loader, 0, sizeof(struct bfelf_loader_t));
 
     execute_entry = 0;
+    platform_memset(&g_entry_vector, 0, sizeof(struct vmm_entry_vector_t));
+
     g_num_cpus_started = 0;
 
     if (g_tls != 0)
@@ -293,6 +834,11 @@ common_reset(void)
     g_stack = 0;
     g_stack_top = 0;
 
+    for (i = 0; i < g_num_mem_chunks; i++)
+        platform_free_rw(g_mem_chunks[i], MEM_CHUNK_SIZE);
+
+    g_num_mem_chunks = 0;
+
     return BF_SUCCESS;
 }
 
@@ -331,6 +877,10 @@ common_fini(void)
             ALERT("common_fini: failed to reset\n");
     }
 
+    ret = common_invalidate_cache();
+    if (ret != BF_SUCCESS)
+        ALERT("common_fini: failed to invalidate the module cache\n");
+
     return BF_SUCCESS;
 }
 
@@ -339,6 +889,7 @@ common_add_module(const char *file, uint64_t fsize)
 {
     int64_t ret = 0;
     struct module_t *module = 0;
+    struct module_cache_entry_t *entry = 0;
 
     /*
      * TODO: Might not be a bad idea to add the ability to detect when a
@@ -364,10 +915,62 @@ common_add_module(const char *file, uint64_t fsize)
     if (ret != BFELF_SUCCESS)
         return ret;
 
+    /*
+     * A static PIE is a VMM that was linked into a single image, and
+     * already contains everything that the other modules would provide,
+     * so it cannot be combined with other modules.
+     */
+
+    if (g_num_modules > 0)
+    {
+        if (bfelf_file_is_static_pie(&module->file) == 1 ||
+            bfelf_file_is_static_pie(&g_modules[0].file) == 1)
+            return BF_ERROR_STATIC_PIE_NOT_ALONE;
+    }
+
     module->size = get_elf_file_size(module);
     if (module->size == 0)
         return BF_ERROR_FAILED_TO_ADD_FILE;
 
+    /*
+     * If this module was loaded at the same position the last time the VMM
+     * was loaded, the relocated image that was kept by the module cache is
+     * reused, and only its writable segments need to be restored. Otherwise
+     * the cache no longer matches the modules being added and is released.
+     */
+
+    module->fsize = fsize;
+    module->hash = module_hash(file, fsize);
+    module->cached = 0;
+
+    entry = module_cache_lookup(g_num_modules, module, fsize);
+    if (entry != 0)
+    {
+        module->exec = entry->exec;
+
+        ret = module_snapshot(module, entry->snapshot, 1);
+        if (ret == BF_SUCCESS)
+        {
+            ret = compact_elf_file(module);
+            if (ret != BF_SUCCESS)
+            {
+                module->exec = 0;
+                return ret;
+            }
+
+            DEBUG("common_add_module [%d]: cached\n", (int)g_num_modules);
+
+            module->cached = 1;
+            g_num_modules++;
+            return BF_SUCCESS;
+        }
+
+        module->exec = 0;
+    }
+
+    if (g_num_cached_modules > 0)
+        common_invalidate_cache();
+
     module->exec = platform_alloc_rwe(module->size);
     if (module->exec == 0)
         return BF_ERROR_OUT_OF_MEMORY;
@@ -376,10 +979,17 @@ common_add_module(const char *file, uint64_t fsize)
     if (ret != BF_SUCCESS)
         goto failure;
 
+    ret = compact_elf_file(module);
+    if (ret != BF_SUCCESS)
+        goto failure;
+
     DEBUG("common_add_module [%d]:\n", (int)g_num_modules);
     DEBUG("    addr = %p\n", (void *)module->exec);
     DEBUG("    size = %p\n", (void *)module->size);
 
+    if (bfelf_file_is_static_pie(&module->file) == 1)
+        DEBUG("    static pie\n");
+
     g_num_modules++;
     return BF_SUCCESS;
 
@@ -389,6 +999,27 @@ failure:
     return ret;
 }
 
+int64_t
+common_remove_modules(int64_t num)
+{
+    if (common_vmm_status() == VMM_CORRUPT)
+        return BF_ERROR_VMM_CORRUPTED;
+
+    if (common_vmm_status() != VMM_UNLOADED)
+        return BF_ERROR_VMM_INVALID_STATE;
+
+    if (num < 0 || num > g_num_modules)
+        return BF_ERROR_INVALID_ARG;
+
+    for (; num > 0; num--)
+    {
+        g_num_modules--;
+        free_module(&(g_modules[g_num_modules]));
+    }
+
+    return BF_SUCCESS;
+}
+
 int64_t
 common_load_vmm(void)
 {
@@ -426,18 +1057,58 @@ common_load_vmm(void)
     platform_memset(g_tls, 0, g_tls_size);
     platform_memset(&g_loader, 0, sizeof(struct bfelf_loader_t));
 
-    for (i = 0; (module = get_module(i)) != 0; i++)
+    if (module_cache_hit() != 0)
+    {
+        /*
+         * Every module is still relocated from the last time the VMM was
+         * loaded, so the loader (including its symbol index) that was used
+         * to relocate them is restored instead of relocating them again.
+         * The loader refers to each module's ELF file by its position in
+         * g_modules, which is the same as the last time.
+         */
+
+        platform_memcpy(&g_loader, g_module_cache_loader, sizeof(struct bfelf_loader_t));
+        g_loader.symbols = symbol_index_copy(g_module_cache_loader);
+
+        if (g_loader.symbols == 0)
+            symbol_index_free(&g_loader);
+
+        for (i = 0; (module = get_module(i)) != 0; i++)
+        {
+            module->file.exec = module->exec;
+            module->file.loader = &g_loader;
+            module->file.relocated = 1;
+        }
+
+        g_module_cache_hits++;
+    }
+    else
     {
-        ret = bfelf_loader_add(&g_loader, &module->file, module->exec);
+        for (i = 0; (module = get_module(i)) != 0; i++)
+        {
+            ret = bfelf_loader_add(&g_loader, &module->file, module->exec);
+            if (ret != BFELF_SUCCESS)
+                goto failure;
+        }
+
+        if (LAZY_BINDING != 0)
+        {
+            ret = bfelf_loader_set_lazy(&g_loader, (bfelf64_addr)platform_lazy_trampoline);
+            if (ret != BFELF_SUCCESS)
+                goto failure;
+        }
+
+        symbol_index_alloc(&g_loader);
+
+        ret = bfelf_loader_relocate(&g_loader);
         if (ret != BFELF_SUCCESS)
             goto failure;
-    }
 
-    ret = bfelf_loader_relocate(&g_loader);
-    if (ret != BFELF_SUCCESS)
-        goto failure;
+        module_cache_commit();
+        g_module_cache_misses++;
+    }
 
-    ret = resolve_symbol("execute_entry", (void **)&execute_entry);
+    ret = resolve_entry_vector();
     if (ret != BF_SUCCESS)
         goto failure;
 
@@ -449,7 +1120,7 @@ common_load_vmm(void)
         if (ret != BF_SUCCESS)
             goto failure;
 
-        ret = execute_symbol("local_init", (uint64_t)&info, 0, 0);
+        ret = execute_entry_point(g_entry_vector.local_init, "local_init", (uint64_t)&info, 0, 0);
         if (ret != BF_SUCCESS)
             goto failure;
     }
@@ -473,6 +1144,10 @@ common_load_vmm(void)
         }
     }
 
+    ret = add_mem_chunks_to_memory_manager();
+    if (ret != BF_SUCCESS)
+        goto failure;
+
     g_vmm_status = VMM_LOADED;
     return BF_SUCCESS;
 
@@ -507,7 +1182,7 @@ common_unload_vmm(void)
             if (ret != BF_SUCCESS)
                 goto corrupted;
 
-            ret = execute_symbol("local_fini", (uint64_t)&info, 0, 0);
+            ret = execute_entry_point(g_entry_vector.local_fini, "local_fini", (uint64_t)&info, 0, 0);
             if (ret != BF_SUCCESS)
                 goto corrupted;
         }
@@ -524,6 +1199,59 @@ corrupted:
     return ret;
 }
 
+int64_t
+lazy_preload(void)
+{
+    int64_t i = 0;
+    int64_t ret = 0;
+    uint64_t binds = g_loader.num_lazy_binds;
+
+    if (g_loader.lazy_trampoline == 0)
+        return BF_SUCCESS;
+
+    for (i = 0; g_lazy_preload[i] != 0; i++)
+    {
+        struct e_string_t str = {0, 0};
+
+        str.buf = g_lazy_preload[i];
+        str.len = symbol_length(g_lazy_preload[i]);
+
+        if (str.len == 1 && str.buf[0] == '*')
+            ret = bfelf_loader_bind_all(&g_loader);
+        else
+            ret = bfelf_loader_bind(&g_loader, &str);
+
+        if (ret != BFELF_SUCCESS)
+        {
+            ALERT("Failed to preload: %s\n", g_lazy_preload[i]);
+            return ret;
+        }
+    }
+
+    DEBUG("lazy binding:\n");
+    DEBUG("    deferred at load = %d\n", (int)g_loader.num_lazy_slots);
+    DEBUG("    bound before start = %d\n", (int)binds);
+    DEBUG("    bound by preload = %d\n", (int)(g_loader.num_lazy_binds - binds));
+
+    return BF_SUCCESS;
+}
+
+uint64_t
+common_lazy_resolve(struct bfelf_file_t *ef, uint64_t index)
+{
+    int64_t ret = 0;
+    void *addr = 0;
+
+    ret = bfelf_file_bind_jump_slot(ef, index, &addr);
+    if (ret != BFELF_SUCCESS)
+    {
+        ALERT("common_lazy_resolve: failed to bind jump slot %d\n", (int)index);
+        return 0;
+    }
+
+    return (uint64_t)addr;
+}
+
 int64_t
 common_start_vmm(void)
 {
@@ -541,13 +1269,23 @@ common_start_vmm(void)
     if (common_vmm_status() == VMM_UNLOADED)
         return BF_ERROR_VMM_INVALID_STATE;
 
+    /*
+     * The lazy binding resolver lives in the driver entry, which the VMM
+     * cannot reach from VMX root mode, so anything that the VMM might call
+     * from there has to be bound before any CPU is started.
+     */
+
+    ret = lazy_preload();
+    if (ret != BF_SUCCESS)
+        return ret;
+
     for (cpuid = 0, g_num_cpus_started = 0; cpuid < platform_num_cpus(); cpuid++, g_num_cpus_started++)
     {
         ret = caller_affinity = platform_set_affinity(cpuid);
         if (caller_affinity < 0)
             goto failure;
 
-        ret = execute_symbol("start_vmm", (uint64_t)cpuid, 0, (uint64_t)cpuid);
+        ret = execute_entry_point(g_entry_vector.start_vmm, "start_vmm", (uint64_t)cpuid, 0, (uint64_t)cpuid);
         if (ret != BF_SUCCESS)
             goto failure;
 
@@ -589,7 +1327,7 @@ common_stop_vmm(void)
         if (caller_affinity < 0)
             goto corrupted;
 
-        ret = execute_symbol("stop_vmm", (uint64_t)cpuid, 0, (uint64_t)cpuid);
+        ret = execute_entry_point(g_entry_vector.stop_vmm, "stop_vmm", (uint64_t)cpuid, 0, (uint64_t)cpuid);
         if (ret != BFELF_SUCCESS)
             goto corrupted;
 
@@ -617,7 +1355,7 @@ common_dump_vmm(struct debug_ring_resources_t **drr, uint64_t vcpuid)
     if (common_vmm_status() == VMM_UNLOADED)
         return BF_ERROR_VMM_INVALID_STATE;
 
-    ret = execute_symbol("get_drr", (uint64_t)vcpuid, (uint64_t)drr, 0);
+    ret = execute_entry_point(g_entry_vector.get_drr, "get_drr", (uint64_t)vcpuid, (uint64_t)drr, 0);
     if (ret != BFELF_SUCCESS)
         return ret;
 
@@ -663,3 +1401,41 @@ common_vmcall(struct vmcall_registers_t *regs, uint64_t cpuid)
 
     return BF_SUCCESS;
 }
+
+int64_t
+common_invalidate_cache(void)
+{
+    int64_t i = 0;
+
+    for (i = 0; i < g_num_cached_modules; i++)
+    {
+        struct module_cache_entry_t *entry = &(g_module_cache[i]);
+
+        /*
+         * If a module is still using the cached execution buffer, the
+         * module takes ownership of it, and it is freed when the module is
+         * removed. Otherwise the buffer is no longer needed.
+         */
+
+        if (i < g_num_modules && g_modules[i].cached != 0)
+            g_modules[i].cached = 0;
+        else
+            platform_free_rwe(entry->exec, entry->size);
+
+        if (entry->snapshot != 0)
+            platform_free_rw(entry->snapshot, entry->snapshot_size);
+    }
+
+    if (g_module_cache_loader != 0)
+    {
+        symbol_index_free(g_module_cache_loader);
+        platform_free_rw(g_module_cache_loader, sizeof(struct bfelf_loader_t));
+    }
+
+    platform_memset(&g_module_cache, 0, sizeof(g_module_cache));
+
+    g_num_cached_modules = 0;
+    g_module_cache_loader = 0;
+
+    return BF_SUCCESS;
+}
@@ -56,6 +56,7 @@ SOURCES+=test_common_dump.cpp
 SOURCES+=test_common_fini.cpp
 SOURCES+=test_common_init.cpp
 SOURCES+=test_common_load.cpp
+SOURCES+=test_common_remove_modules.cpp
 SOURCES+=test_common_start.cpp
 SOURCES+=test_common_stop.cpp
 SOURCES+=test_common_unload.cpp
@@ -146,6 +146,13 @@ driver_entry_ut::list()
     this->test_common_add_module_get_elf_file_size_fails();
     this->test_common_add_module_platform_alloc_fails();
     this->test_common_add_module_load_elf_fails();
+    this->test_common_add_module_compact_alloc_fails();
+    this->test_common_add_module_compact_elf_fails();
+    this->test_common_add_module_file_released();
+
+    this->test_common_remove_modules_invalid_num();
+    this->test_common_remove_modules_when_loaded();
+    this->test_common_remove_modules_success();
 
     this->test_common_load_successful_load();
     this->test_common_load_load_when_already_loaded();
@@ -157,16 +164,25 @@ driver_entry_ut::list()
     this->test_common_load_add_md_tls_failed();
     this->test_common_load_tls_platform_alloc_failed();
     this->test_common_load_stack_platform_alloc_failed();
+    this->test_common_load_mem_chunks_added();
+    this->test_common_load_mem_chunk_platform_alloc_failed();
+    this->test_common_load_add_mem_chunk_failed();
+    this->test_common_load_mem_chunks_numa();
+    this->test_common_load_mem_chunk_node();
+    this->test_common_load_large_mds();
     this->test_common_load_loader_add_failed();
     this->test_common_load_resolve_symbol_failed();
     this->test_common_load_loader_get_info_failed();
-    this->test_common_load_execute_symbol_failed();
+    this->test_common_load_execute_entry_point_failed();
+    this->test_common_load_cached_reload();
+    this->test_common_load_cached_reload_different_modules();
+    this->test_common_load_invalidate_cache();
 
     this->test_common_unload_unload_when_already_unloaded();
     this->test_common_unload_unload_when_running();
     this->test_common_unload_unload_when_corrupt();
     this->test_common_unload_loader_get_info_failed();
-    this->test_common_unload_execute_symbol_failed();
+    this->test_common_unload_execute_entry_point_failed();
 
     this->test_common_start_start_when_unloaded();
     this->test_common_start_start_when_already_running();
@@ -174,6 +190,8 @@ driver_entry_ut::list()
     this->test_common_start_start_when_start_vmm_missing();
     this->test_common_start_start_vmm_failure();
     this->test_common_start_set_affinity_failed();
+    this->test_common_start_lazy_preload_failed();
+    this->test_common_start_lazy_preload_success();
 
     this->test_common_stop_stop_when_unloaded();
     this->test_common_stop_stop_when_not_running();
@@ -212,11 +230,26 @@ driver_entry_ut::list()
     this->test_helper_execute_symbol_missing_symbol();
     this->test_helper_execute_symbol_sym_failed();
     this->test_helper_execute_symbol_sym_success();
+    this->test_helper_execute_entry_point_invalid_arg();
+    this->test_helper_execute_entry_point_missing_entry();
+    this->test_helper_entry_vector_resolved_once();
+    this->test_helper_entry_vector_exported();
+    this->test_helper_execute_entry_point_resolved();
     this->test_helper_add_md_to_memory_manager_null_module();
     this->test_helper_get_elf_file_size_null_module();
     this->test_helper_get_elf_file_size_get_segment_fails();
     this->test_helper_load_elf_file_null_module();
     this->test_helper_load_elf_file_get_segment_fails();
+    this->test_helper_lazy_resolve_invalid_ef();
+    this->test_helper_lazy_resolve_not_lazy();
+
+    return verify_no_mem_leaks() != 0;
+}
+
+bool
+driver_entry_ut::benchmark()
+{
+    this->benchmark_helper_execute_entry_point();
 
     return verify_no_mem_leaks() != 0;
 }
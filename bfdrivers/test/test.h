@@ -36,6 +36,7 @@ protected:
     bool init() override;
     bool fini() override;
     bool list() override;
+    bool benchmark() override;
 
 private:
 
@@ -62,6 +63,13 @@ private:
     void test_common_add_module_get_elf_file_size_fails();
     void test_common_add_module_platform_alloc_fails();
     void test_common_add_module_load_elf_fails();
+    void test_common_add_module_compact_alloc_fails();
+    void test_common_add_module_compact_elf_fails();
+    void test_common_add_module_file_released();
+
+    void test_common_remove_modules_invalid_num();
+    void test_common_remove_modules_when_loaded();
+    void test_common_remove_modules_success();
 
     void test_common_load_successful_load();
     void test_common_load_load_when_already_loaded();
@@ -73,16 +81,25 @@ private:
     void test_common_load_add_md_tls_failed();
     void test_common_load_tls_platform_alloc_failed();
     void test_common_load_stack_platform_alloc_failed();
+    void test_common_load_mem_chunks_added();
+    void test_common_load_mem_chunk_platform_alloc_failed();
+    void test_common_load_add_mem_chunk_failed();
+    void test_common_load_mem_chunks_numa();
+    void test_common_load_mem_chunk_node();
+    void test_common_load_large_mds();
     void test_common_load_loader_add_failed();
     void test_common_load_resolve_symbol_failed();
     void test_common_load_loader_get_info_failed();
-    void test_common_load_execute_symbol_failed();
+    void test_common_load_execute_entry_point_failed();
+    void test_common_load_cached_reload();
+    void test_common_load_cached_reload_different_modules();
+    void test_common_load_invalidate_cache();
 
     void test_common_unload_unload_when_already_unloaded();
     void test_common_unload_unload_when_running();
     void test_common_unload_unload_when_corrupt();
     void test_common_unload_loader_get_info_failed();
-    void test_common_unload_execute_symbol_failed();
+    void test_common_unload_execute_entry_point_failed();
 
     void test_common_start_start_when_unloaded();
     void test_common_start_start_when_already_running();
@@ -90,6 +107,8 @@ private:
     void test_common_start_start_when_start_vmm_missing();
     void test_common_start_start_vmm_failure();
     void test_common_start_set_affinity_failed();
+    void test_common_start_lazy_preload_failed();
+    void test_common_start_lazy_preload_success();
 
     void test_common_stop_stop_when_unloaded();
     void test_common_stop_stop_when_not_running();
@@ -128,11 +147,20 @@ private:
     void test_helper_execute_symbol_missing_symbol();
     void test_helper_execute_symbol_sym_failed();
     void test_helper_execute_symbol_sym_success();
+    void test_helper_execute_entry_point_invalid_arg();
+    void test_helper_execute_entry_point_missing_entry();
+    void test_helper_entry_vector_resolved_once();
+    void test_helper_entry_vector_exported();
+    void test_helper_execute_entry_point_resolved();
     void test_helper_add_md_to_memory_manager_null_module();
     void test_helper_get_elf_file_size_null_module();
     void test_helper_get_elf_file_size_get_segment_fails();
     void test_helper_load_elf_file_null_module();
     void test_helper_load_elf_file_get_segment_fails();
+    void test_helper_lazy_resolve_invalid_ef();
+    void test_helper_lazy_resolve_not_lazy();
+
+    void benchmark_helper_execute_entry_point();
 
 private:
 
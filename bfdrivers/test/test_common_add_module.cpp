@@ -34,6 +34,7 @@ extern "C"
 {
     uint64_t get_elf_file_size(struct module_t *module);
     int64_t load_elf_file(struct module_t *module);
+    int64_t compact_elf_file(struct module_t *module);
 }
 
 // -----------------------------------------------------------------------------
@@ -146,3 +147,51 @@ driver_entry_ut::test_common_add_module_load_elf_fails()
         this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == -1);
     });
 }
+
+void
+driver_entry_ut::test_common_add_module_compact_alloc_fails()
+{
+    MockRepository mocks;
+    mocks.ExpectCallFunc(platform_alloc_rw).Return(nullptr);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_ERROR_OUT_OF_MEMORY);
+    });
+}
+
+void
+driver_entry_ut::test_common_add_module_compact_elf_fails()
+{
+    MockRepository mocks;
+    mocks.ExpectCallFunc(compact_elf_file).Return(-1);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == -1);
+    });
+}
+
+void
+driver_entry_ut::test_common_add_module_file_released()
+{
+    auto add_copy = [&](const char *file, uint64_t fsize)
+    {
+        auto copy = std::make_unique<char[]>(fsize);
+        memcpy(copy.get(), file, fsize);
+
+        auto ret = common_add_module(copy.get(), fsize);
+        memset(copy.get(), 0xCC, fsize);
+
+        return ret;
+    };
+
+    this->expect_true(add_copy(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(add_copy(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(add_copy(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(add_copy(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_SUCCESS);
+    this->expect_true(common_start_vmm() == BF_SUCCESS);
+    this->expect_true(common_stop_vmm() == BF_SUCCESS);
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
@@ -21,6 +21,8 @@
 
 #include <gsl/gsl>
 
+#include <cstring>
+
 #include <test.h>
 
 #include <memory.h>
@@ -35,13 +37,19 @@
 extern "C"
 {
     int64_t resolve_symbol(const char *name, void **sym);
-    int64_t execute_symbol(const char *sym, uint64_t arg1, uint64_t arg2, uint64_t cpuid);
+    int64_t execute_entry_point(void *entry_point, const char *name, uint64_t arg1, uint64_t arg2, uint64_t cpuid);
     int64_t add_raw_md_to_memory_manager(uint64_t virt, uint64_t type);
     int64_t add_md_to_memory_manager(struct module_t *module);
+    int64_t add_mem_chunk_to_memory_manager(uint64_t type, uint64_t node);
 }
 
 extern uint64_t g_malloc_fails;
 
+extern int64_t g_num_mem_chunks;
+extern int64_t g_num_cached_modules;
+extern uint64_t g_module_cache_hits;
+extern uint64_t g_module_cache_misses;
+
 // -----------------------------------------------------------------------------
 // Tests
 // -----------------------------------------------------------------------------
@@ -189,6 +197,190 @@ driver_entry_ut::test_common_load_stack_platform_alloc_failed()
     this->expect_true(common_fini() == BF_SUCCESS);
 }
 
+void
+driver_entry_ut::test_common_load_mem_chunks_added()
+{
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+
+    {
+        MockRepository mocks;
+        mocks.ExpectCallFunc(add_mem_chunk_to_memory_manager).With(MEMORY_CHUNK_HEAP, MEMORY_CHUNK_ANY_NODE).Return(BF_SUCCESS);
+        mocks.ExpectCallFunc(add_mem_chunk_to_memory_manager).With(MEMORY_CHUNK_HEAP, MEMORY_CHUNK_ANY_NODE).Return(BF_SUCCESS);
+
+        for (auto i = 0ULL; i < VMM_PAGE_CHUNKS; i++)
+            mocks.ExpectCallFunc(add_mem_chunk_to_memory_manager).With(MEMORY_CHUNK_PAGE, MEMORY_CHUNK_ANY_NODE).Return(BF_SUCCESS);
+
+        for (auto i = 0ULL; i < VMM_RESERVE_CHUNKS; i++)
+            mocks.ExpectCallFunc(add_mem_chunk_to_memory_manager).With(MEMORY_CHUNK_RESERVE, MEMORY_CHUNK_ANY_NODE).Return(BF_SUCCESS);
+
+        RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+        {
+            this->expect_true(common_load_vmm() == BF_SUCCESS);
+        });
+    }
+
+    this->expect_true(common_fini() == BF_SUCCESS);
+
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_SUCCESS);
+    this->expect_true(g_num_mem_chunks == VMM_HEAP_CHUNKS + VMM_PAGE_CHUNKS + VMM_RESERVE_CHUNKS);
+    this->expect_true(common_fini() == BF_SUCCESS);
+    this->expect_true(g_num_mem_chunks == 0);
+}
+
+void
+driver_entry_ut::test_common_load_mem_chunk_platform_alloc_failed()
+{
+    g_malloc_fails = MEM_CHUNK_SIZE;
+
+    auto ___ = gsl::finally([&]
+    { g_malloc_fails = 0; });
+
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_ERROR_OUT_OF_MEMORY);
+    this->expect_true(common_vmm_status() == VMM_UNLOADED);
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
+
+void
+driver_entry_ut::test_common_load_add_mem_chunk_failed()
+{
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+
+    {
+        MockRepository mocks;
+        mocks.OnCallFunc(execute_entry_point).Do([&](void *, const char *name, uint64_t, uint64_t, uint64_t) -> int64_t
+        {
+            if (strcmp(name, "add_mem_chunk") == 0)
+                return MEMORY_MANAGER_FAILURE;
+
+            return BF_SUCCESS;
+        });
+
+        RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+        {
+            this->expect_true(common_load_vmm() == MEMORY_MANAGER_FAILURE);
+            this->expect_true(common_vmm_status() == VMM_UNLOADED);
+        });
+    }
+
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
+
+void
+driver_entry_ut::test_common_load_mem_chunks_numa()
+{
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+
+    {
+        MockRepository mocks;
+
+        // Simulate 4 CPUs that are spread across 2 nodes
+
+        mocks.OnCallFunc(platform_num_cpus).Return(4);
+        mocks.OnCallFunc(platform_cpu_to_node).Do([](int64_t cpuid) -> int64_t { return cpuid / 2; });
+
+        mocks.ExpectCallFunc(add_mem_chunk_to_memory_manager).With(MEMORY_CHUNK_HEAP, MEMORY_CHUNK_ANY_NODE).Return(BF_SUCCESS);
+        mocks.ExpectCallFunc(add_mem_chunk_to_memory_manager).With(MEMORY_CHUNK_HEAP, MEMORY_CHUNK_ANY_NODE).Return(BF_SUCCESS);
+
+        for (auto i = 0ULL; i < VMM_PAGE_CHUNKS; i++)
+            mocks.ExpectCallFunc(add_mem_chunk_to_memory_manager).With(MEMORY_CHUNK_PAGE, i % 2).Return(BF_SUCCESS);
+
+        for (auto i = 0ULL; i < VMM_RESERVE_CHUNKS; i++)
+            mocks.ExpectCallFunc(add_mem_chunk_to_memory_manager).With(MEMORY_CHUNK_RESERVE, MEMORY_CHUNK_ANY_NODE).Return(BF_SUCCESS);
+
+        RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+        {
+            this->expect_true(common_load_vmm() == BF_SUCCESS);
+        });
+    }
+
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
+
+void
+driver_entry_ut::test_common_load_mem_chunk_node()
+{
+    uint64_t node = MEMORY_CHUNK_ANY_NODE;
+
+    {
+        MockRepository mocks;
+        mocks.ExpectCallFunc(platform_alloc_rw_node).With(MEM_CHUNK_SIZE, 1).Do([](uint64_t len, int64_t) -> void * { return platform_alloc_rw(len); });
+        mocks.OnCallFunc(execute_entry_point).Do([&](void *, const char *name, uint64_t arg1, uint64_t, uint64_t) -> int64_t
+        {
+            if (strcmp(name, "add_mem_chunk") == 0)
+                node = reinterpret_cast<struct memory_chunk *>(arg1)->node;
+
+            return BF_SUCCESS;
+        });
+
+        RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+        {
+            this->expect_true(add_mem_chunk_to_memory_manager(MEMORY_CHUNK_PAGE, 1) == BF_SUCCESS);
+            this->expect_true(node == 1);
+        });
+    }
+
+    this->expect_true(common_reset() == BF_SUCCESS);
+}
+
+void
+driver_entry_ut::test_common_load_large_mds()
+{
+    uint64_t num_large_mds = 0;
+    uint64_t num_unaligned_mds = 0;
+
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+
+    {
+        MockRepository mocks;
+        mocks.OnCallFunc(execute_entry_point).Do([&](void *, const char *name, uint64_t arg1, uint64_t, uint64_t) -> int64_t
+        {
+            if (strcmp(name, "add_md") != 0)
+                return BF_SUCCESS;
+
+            auto md = reinterpret_cast<struct memory_descriptor *>(arg1);
+            if (md->size == LARGE_PAGE_SIZE)
+            {
+                num_large_mds++;
+
+                if ((md->virt & (LARGE_PAGE_SIZE - 1)) != 0 || (md->phys & (LARGE_PAGE_SIZE - 1)) != 0)
+                    num_unaligned_mds++;
+            }
+
+            return BF_SUCCESS;
+        });
+
+        RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+        {
+            this->expect_true(common_load_vmm() == BF_SUCCESS);
+            this->expect_true(num_large_mds == VMM_HEAP_CHUNKS + VMM_PAGE_CHUNKS + VMM_RESERVE_CHUNKS);
+            this->expect_true(num_unaligned_mds == 0);
+            this->expect_true(common_unload_vmm() == BF_SUCCESS);
+        });
+    }
+
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
+
 void
 driver_entry_ut::test_common_load_loader_add_failed()
 {
@@ -253,7 +445,7 @@ driver_entry_ut::test_common_load_loader_get_info_failed()
 }
 
 void
-driver_entry_ut::test_common_load_execute_symbol_failed()
+driver_entry_ut::test_common_load_execute_entry_point_failed()
 {
     this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
     this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
@@ -262,7 +454,7 @@ driver_entry_ut::test_common_load_execute_symbol_failed()
 
     {
         MockRepository mocks;
-        mocks.ExpectCallFunc(execute_symbol).Return(-1);
+        mocks.ExpectCallFunc(execute_entry_point).Return(-1);
 
         RUN_UNITTEST_WITH_MOCKS(mocks, [&]
         {
@@ -272,3 +464,91 @@ driver_entry_ut::test_common_load_execute_symbol_failed()
 
     this->expect_true(common_fini() == BF_SUCCESS);
 }
+
+void
+driver_entry_ut::test_common_load_cached_reload()
+{
+    auto hits = g_module_cache_hits;
+    auto misses = g_module_cache_misses;
+
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_SUCCESS);
+    this->expect_true(common_unload_vmm() == BF_SUCCESS);
+    this->expect_true(g_num_cached_modules == 4);
+
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+
+    {
+        MockRepository mocks;
+        mocks.NeverCallFunc(bfelf_loader_relocate);
+
+        RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+        {
+            this->expect_true(common_load_vmm() == BF_SUCCESS);
+            this->expect_true(common_start_vmm() == BF_SUCCESS);
+            this->expect_true(common_stop_vmm() == BF_SUCCESS);
+        });
+    }
+
+    this->expect_true(g_module_cache_hits == hits + 1);
+    this->expect_true(g_module_cache_misses == misses + 1);
+    this->expect_true(common_fini() == BF_SUCCESS);
+    this->expect_true(g_num_cached_modules == 0);
+}
+
+void
+driver_entry_ut::test_common_load_cached_reload_different_modules()
+{
+    auto hits = g_module_cache_hits;
+    auto misses = g_module_cache_misses;
+
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_SUCCESS);
+    this->expect_true(common_unload_vmm() == BF_SUCCESS);
+
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_failure.get(), m_dummy_stop_vmm_failure_length) == BF_SUCCESS);
+    this->expect_true(g_num_cached_modules == 0);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_SUCCESS);
+    this->expect_true(common_vmm_status() == VMM_LOADED);
+
+    this->expect_true(g_module_cache_hits == hits);
+    this->expect_true(g_module_cache_misses == misses + 2);
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
+
+void
+driver_entry_ut::test_common_load_invalidate_cache()
+{
+    auto hits = g_module_cache_hits;
+
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_SUCCESS);
+    this->expect_true(common_invalidate_cache() == BF_SUCCESS);
+    this->expect_true(g_num_cached_modules == 0);
+    this->expect_true(common_vmm_status() == VMM_LOADED);
+    this->expect_true(common_unload_vmm() == BF_SUCCESS);
+
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_SUCCESS);
+
+    this->expect_true(g_module_cache_hits == hits);
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
@@ -26,6 +26,8 @@
 #include <platform.h>
 #include <driver_entry_interface.h>
 
+extern "C" struct bfelf_loader_t g_loader;
+
 void
 driver_entry_ut::test_common_start_start_when_unloaded()
 {
@@ -110,3 +112,50 @@ driver_entry_ut::test_common_start_set_affinity_failed()
 
     this->expect_true(common_fini() == BF_SUCCESS);
 }
+
+void
+driver_entry_ut::test_common_start_lazy_preload_failed()
+{
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_SUCCESS);
+
+    {
+        MockRepository mocks;
+        mocks.ExpectCallFunc(bfelf_loader_bind_all).Return(-1);
+        mocks.NeverCallFunc(platform_set_affinity);
+
+        RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+        {
+            g_loader.lazy_trampoline = reinterpret_cast<bfelf64_addr>(platform_lazy_trampoline);
+
+            this->expect_true(common_start_vmm() == -1);
+            this->expect_true(common_vmm_status() == VMM_LOADED);
+
+            g_loader.lazy_trampoline = 0;
+        });
+    }
+
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
+
+void
+driver_entry_ut::test_common_start_lazy_preload_success()
+{
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_SUCCESS);
+
+    g_loader.lazy_trampoline = reinterpret_cast<bfelf64_addr>(platform_lazy_trampoline);
+
+    this->expect_true(common_start_vmm() == BF_SUCCESS);
+    this->expect_true(common_vmm_status() == VMM_RUNNING);
+
+    g_loader.lazy_trampoline = 0;
+
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
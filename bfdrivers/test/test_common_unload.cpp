@@ -31,7 +31,7 @@
 
 extern "C"
 {
-    int64_t execute_symbol(const char *sym, uint64_t arg1, uint64_t arg2, uint64_t cpuid);
+    int64_t execute_entry_point(void *entry_point, const char *name, uint64_t arg1, uint64_t arg2, uint64_t cpuid);
 }
 
 // -----------------------------------------------------------------------------
@@ -96,7 +96,7 @@ driver_entry_ut::test_common_unload_loader_get_info_failed()
 }
 
 void
-driver_entry_ut::test_common_unload_execute_symbol_failed()
+driver_entry_ut::test_common_unload_execute_entry_point_failed()
 {
     this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
     this->expect_true(common_add_module(m_dummy_stop_vmm_failure.get(), m_dummy_stop_vmm_failure_length) == BF_SUCCESS);
@@ -106,7 +106,7 @@ driver_entry_ut::test_common_unload_execute_symbol_failed()
 
     {
         MockRepository mocks;
-        mocks.ExpectCallFunc(execute_symbol).Return(-1);
+        mocks.ExpectCallFunc(execute_entry_point).Return(-1);
 
         RUN_UNITTEST_WITH_MOCKS(mocks, [&]
         {
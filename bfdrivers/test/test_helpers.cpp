@@ -21,6 +21,10 @@
 
 #include <test.h>
 
+#include <chrono>
+#include <cstring>
+
+#include <entry.h>
 #include <common.h>
 #include <platform.h>
 #include <constants.h>
@@ -36,9 +40,26 @@ extern "C"
     int64_t symbol_length(const char *sym);
     int64_t resolve_symbol(const char *name, void **sym);
     int64_t execute_symbol(const char *sym, uint64_t arg1, uint64_t arg2, uint64_t cpuid);
+    int64_t lookup_entry(const char *name, void **entry);
+    int64_t execute_entry_point(void *entry_point, const char *name, uint64_t arg1, uint64_t arg2, uint64_t cpuid);
     int64_t add_md_to_memory_manager(struct module_t *module);
     uint64_t get_elf_file_size(struct module_t *module);
     int64_t load_elf_file(struct module_t *module);
+
+    extern struct bfelf_loader_t g_loader;
+    extern struct vmm_entry_vector_t g_entry_vector;
+}
+
+static int64_t g_vector_calls = 0;
+
+extern "C" int64_t
+vector_entry(uint64_t arg1, uint64_t arg2)
+{
+    (void) arg1;
+    (void) arg2;
+
+    g_vector_calls++;
+    return 0;
 }
 
 // -----------------------------------------------------------------------------
@@ -167,6 +188,122 @@ driver_entry_ut::test_helper_execute_symbol_sym_success()
     this->expect_true(common_fini() == BF_SUCCESS);
 }
 
+void
+driver_entry_ut::test_helper_execute_entry_point_invalid_arg()
+{
+    this->expect_true(execute_entry_point(nullptr, nullptr, 0, 0, 0) == BF_ERROR_INVALID_ARG);
+}
+
+void
+driver_entry_ut::test_helper_execute_entry_point_missing_entry()
+{
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_SUCCESS);
+
+    auto drr = static_cast<debug_ring_resources_t *>(nullptr);
+
+    this->expect_true(g_entry_vector.get_drr == nullptr);
+    this->expect_true(common_dump_vmm(&drr, 0) == BFELF_ERROR_NO_SUCH_SYMBOL);
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
+
+void
+driver_entry_ut::test_helper_entry_vector_resolved_once()
+{
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_SUCCESS);
+
+    this->expect_true(g_entry_vector.local_init != nullptr);
+    this->expect_true(g_entry_vector.local_fini != nullptr);
+    this->expect_true(g_entry_vector.add_md != nullptr);
+    this->expect_true(g_entry_vector.start_vmm != nullptr);
+    this->expect_true(g_entry_vector.stop_vmm != nullptr);
+
+    auto lookups = g_loader.num_global_lookups;
+
+    this->expect_true(common_start_vmm() == BF_SUCCESS);
+    this->expect_true(common_stop_vmm() == BF_SUCCESS);
+    this->expect_true(g_loader.num_global_lookups == lookups);
+
+    this->expect_true(common_unload_vmm() == BF_SUCCESS);
+    this->expect_true(g_entry_vector.start_vmm == nullptr);
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
+
+void
+driver_entry_ut::test_helper_entry_vector_exported()
+{
+    auto vector = vmm_entry_vector_t{};
+
+    vector.local_init = reinterpret_cast<void *>(vector_entry);
+    vector.local_fini = reinterpret_cast<void *>(vector_entry);
+    vector.add_md = reinterpret_cast<void *>(vector_entry);
+    vector.add_mem_chunk = reinterpret_cast<void *>(vector_entry);
+    vector.start_vmm = reinterpret_cast<void *>(vector_entry);
+    vector.stop_vmm = reinterpret_cast<void *>(vector_entry);
+    vector.get_drr = reinterpret_cast<void *>(vector_entry);
+
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+
+    {
+        MockRepository mocks;
+
+        mocks.OnCallFunc(lookup_entry).Do([&](const char *name, void **entry) -> int64_t
+        {
+            if (*entry != nullptr)
+                return BF_SUCCESS;
+
+            if (strcmp(name, "vmm_entry_vector") != 0)
+                return BFELF_ERROR_NO_SUCH_SYMBOL;
+
+            *entry = &vector;
+            return BF_SUCCESS;
+        });
+
+        RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+        {
+            g_vector_calls = 0;
+
+            this->expect_true(common_load_vmm() == BF_SUCCESS);
+            this->expect_true(g_vector_calls > 0);
+
+            auto calls = g_vector_calls;
+            auto drr = static_cast<debug_ring_resources_t *>(nullptr);
+
+            this->expect_true(common_start_vmm() == BF_SUCCESS);
+            this->expect_true(common_dump_vmm(&drr, 0) == BF_SUCCESS);
+            this->expect_true(common_stop_vmm() == BF_SUCCESS);
+            this->expect_true(g_vector_calls == calls + (platform_num_cpus() * 2) + 1);
+        });
+    }
+
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
+
+void
+driver_entry_ut::test_helper_execute_entry_point_resolved()
+{
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_SUCCESS);
+
+    auto entry = static_cast<void *>(nullptr);
+    this->expect_true(resolve_symbol("sym_that_returns_success", &entry) == BF_SUCCESS);
+
+    this->expect_true(execute_symbol("sym_that_returns_success", 0, 0, 0) == BF_SUCCESS);
+    this->expect_true(execute_entry_point(entry, "sym_that_returns_success", 0, 0, 0) == BF_SUCCESS);
+
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
+
 void
 driver_entry_ut::test_helper_add_md_to_memory_manager_null_module()
 {
@@ -222,3 +359,58 @@ driver_entry_ut::test_helper_load_elf_file_get_segment_fails()
 
     this->expect_true(common_fini() == BF_SUCCESS);
 }
+
+void
+driver_entry_ut::test_helper_lazy_resolve_invalid_ef()
+{
+    this->expect_true(common_lazy_resolve(nullptr, 0) == 0);
+}
+
+void
+driver_entry_ut::test_helper_lazy_resolve_not_lazy()
+{
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_SUCCESS);
+    this->expect_true(common_lazy_resolve(&get_module(0)->file, 0) == 0);
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
+
+void
+driver_entry_ut::benchmark_helper_execute_entry_point()
+{
+    constexpr const auto iterations = 10000;
+
+    this->expect_true(common_add_module(m_dummy_start_vmm_success.get(), m_dummy_start_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_stop_vmm_success.get(), m_dummy_stop_vmm_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_add_md_success.get(), m_dummy_add_md_success_length) == BF_SUCCESS);
+    this->expect_true(common_add_module(m_dummy_misc.get(), m_dummy_misc_length) == BF_SUCCESS);
+    this->expect_true(common_load_vmm() == BF_SUCCESS);
+
+    auto entry = static_cast<void *>(nullptr);
+    this->expect_true(resolve_symbol("sym_that_returns_success", &entry) == BF_SUCCESS);
+
+    auto ret = 0LL;
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < iterations; i++)
+        ret |= execute_symbol("sym_that_returns_success", 0, 0, 0);
+    auto by_name = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < iterations; i++)
+        ret |= execute_entry_point(entry, "sym_that_returns_success", 0, 0, 0);
+    auto by_pointer = std::chrono::steady_clock::now() - start;
+
+    this->expect_true(ret == BF_SUCCESS);
+
+    std::cout << "execute_symbol: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(by_name).count() / iterations
+              << " ns per call (by name), "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(by_pointer).count() / iterations
+              << " ns per call (resolved)" << std::endl;
+
+    this->expect_true(common_fini() == BF_SUCCESS);
+}
@@ -93,6 +93,7 @@ struct bfelf_sym;
 struct bfelf_rel;
 struct bfelf_shdr;
 struct bfelf64_ehdr;
+struct bfelf_loader_t;
 
 /*
  * String
@@ -148,13 +149,34 @@ struct bfelf_file_t
     bfelf64_word *bucket;
     bfelf64_word *chain;
 
+    struct bfelf_shdr *gnu_hashtab;
+
+    bfelf64_word gnu_nbucket;
+    bfelf64_word gnu_symoffset;
+    bfelf64_word gnu_bloom_size;
+    bfelf64_word gnu_bloom_shift;
+    bfelf64_xword *gnu_bloom;
+    bfelf64_word *gnu_bucket;
+    bfelf64_word *gnu_chain;
+
     bfelf64_xword symnum;
     struct bfelf_sym *symtab;
 
     bfelf64_word num_rela;
     struct relatab_t relatab[BFELF_MAX_RELATAB];
 
+    bfelf64_word static_pie;
     bfelf64_word relocated;
+    bfelf64_word compacted;
+
+    struct bfelf_loader_t *loader;
+
+    bfelf64_word lazy;
+    bfelf64_addr plt_start;
+    bfelf64_addr plt_end;
+    bfelf64_addr got_plt;
+    bfelf64_xword num_jmprel;
+    struct bfelf_rela *jmprel;
 };
 
 /**
@@ -229,6 +251,77 @@ int64_t bfelf_file_resolve_symbol(struct bfelf_file_t *ef,
                                   struct e_string_t *name,
                                   void **addr);
 
+/**
+ * Is Static PIE
+ *
+ * A static PIE is a position independent executable (i.e. it has an entry
+ * point) that was linked with everything it needs, so that the only
+ * relocations left are R_X86_64_RELATIVE relocations. Such a file does not
+ * need any other ELF file to be relocated, and is relocated without any
+ * symbol lookups. A VMM can be linked into a single static PIE instead of
+ * being loaded as a set of shared libraries.
+ *
+ * @param ef the ELF file
+ * @return 1 if the ELF file is a static PIE, 0 if it is not, negative on
+ *     error
+ */
+int64_t bfelf_file_is_static_pie(struct bfelf_file_t *ef);
+
+/**
+ * Bind Jump Slot
+ *
+ * When lazy binding is enabled (see bfelf_loader_set_lazy), the first call
+ * through a PLT entry that has not been bound yet ends up in the loader's
+ * trampoline with this ELF file (GOT[1]) and the index of the PLT entry's
+ * relocation in .rela.plt. This function resolves the symbol through the
+ * loader's tables and patches the GOT slot with a single aligned 64bit
+ * store, so that another CPU calling through the same slot either sees the
+ * trampoline or the final address, never a partial one.
+ *
+ * @param ef the ELF file that made the call
+ * @param index the index of the R_X86_64_JUMP_SLOT relocation in .rela.plt
+ * @param addr the address of the function the slot was bound to
+ * @return BFELF_SUCCESS on success, negative on error
+ */
+int64_t bfelf_file_bind_jump_slot(struct bfelf_file_t *ef,
+                                  bfelf64_xword index,
+                                  void **addr);
+
+/**
+ * Compact Size
+ *
+ * Returns the size of the buffer that bfelf_file_compact needs to compact
+ * this ELF file.
+ *
+ * @param ef the ELF file
+ * @return the size of the compacted ELF file on success, negative on error
+ */
+int64_t bfelf_file_compact_size(struct bfelf_file_t *ef);
+
+/**
+ * Compact
+ *
+ * Once the segments of an ELF file have been loaded, the loader only needs
+ * the ELF headers and the tables used for relocation and symbol lookups
+ * (the dynamic symbol and string tables, the hash tables, the relocation
+ * tables and .got.plt). This function copies only those into buf, and
+ * re-initializes the ELF file from the copy, so that the original file can
+ * be released. The segments of the compacted ELF file have no contents, so
+ * it cannot be loaded again.
+ *
+ * This function must be called before the ELF file is added to a loader.
+ * If it fails after the copy was made, the ELF file is left uninitialized.
+ *
+ * @param ef the ELF file to compact
+ * @param buf the buffer to copy the compacted ELF file into, which must
+ *     remain valid for as long as the ELF file is used
+ * @param size the size of buf, as returned by bfelf_file_compact_size
+ * @return BFELF_SUCCESS on success, negative on error
+ */
+int64_t bfelf_file_compact(struct bfelf_file_t *ef,
+                           char *buf,
+                           bfelf64_xword size);
+
 /******************************************************************************/
 /* ELF File Header                                                            */
 /******************************************************************************/
@@ -401,6 +494,7 @@ struct bfelf64_ehdr
 #define bfsht_init_array ((bfelf64_word)14)
 #define bfsht_fini_array ((bfelf64_word)15)
 #define bfsht_loos ((bfelf64_word)0x60000000)
+#define bfsht_gnu_hash ((bfelf64_word)0x6FFFFFF6)
 #define bfsht_hios ((bfelf64_word)0x6FFFFFFF)
 #define bfsht_loproc ((bfelf64_word)0x70000000)
 #define bfsht_x86_64_unwind ((bfelf64_word)0x70000001)
@@ -623,18 +717,58 @@ struct bfelf_phdr
 /* ELF Loader                                                                 */
 /******************************************************************************/
 
+/*
+ * Symbol Index Entry
+ *
+ * The following is used by this API to store a symbol in the ELF loader's
+ * global symbol index. An entry with sym == STN_UNDEF is empty.
+ */
+struct bfelf_symbol_index_t
+{
+    bfelf64_word hash;
+    bfelf64_word module;
+    bfelf64_word sym;
+};
+
 /**
  * ELF Loader
  *
  * The following structure is used to create an ELF loader, which groups up
  * all of the ELF files used by a single program, mainly needed for global
  * symbol searching.
+ *
+ * When the ELF files are relocated, the loader builds a single open
+ * addressing hash table of every symbol defined by the ELF files that have
+ * been added (honoring weak / global precedence), so that each global symbol
+ * lookup is a single probe sequence instead of a search of every module.
+ * The loader does not allocate memory, so the table is only built if the
+ * caller provided one (see bfelf_loader_set_symbol_index), otherwise global
+ * symbols are resolved by searching each module. The statistics at the end
+ * of this structure can be used to measure the cost of a full relocation.
+ *
+ * If lazy binding is enabled, R_X86_64_JUMP_SLOT relocations are not
+ * resolved when the ELF files are relocated. Instead, each GOT slot is left
+ * pointing at its PLT entry, and GOT[2] is pointed at the trampoline, which
+ * binds the slot the first time it is called.
  */
 struct bfelf_loader_t
 {
     bfelf64_word num;
     bfelf64_word relocated;
     struct bfelf_file_t *efs[BFELF_MAX_MODULES];
+
+    bfelf64_word indexed;
+    bfelf64_word num_symbols;
+    bfelf64_word max_symbols;
+    struct bfelf_symbol_index_t *symbols;
+
+    bfelf64_xword num_relocations;
+    bfelf64_xword num_global_lookups;
+    bfelf64_xword num_index_misses;
+
+    bfelf64_addr lazy_trampoline;
+    bfelf64_xword num_lazy_slots;
+    bfelf64_xword num_lazy_binds;
 };
 
 /**
@@ -669,6 +803,86 @@ int64_t bfelf_loader_add(struct bfelf_loader_t *loader,
  */
 int64_t bfelf_loader_relocate(struct bfelf_loader_t *loader);
 
+/**
+ * Symbol Index Size
+ *
+ * Returns the size (in bytes) of the global symbol index that is needed to
+ * index every symbol of the ELF files that have been added to the ELF
+ * loader. The caller should allocate this much memory, and give it to the
+ * loader using bfelf_loader_set_symbol_index before relocating.
+ *
+ * @param loader the ELF loader
+ * @return the size of the symbol index on success, negative on error
+ */
+int64_t bfelf_loader_symbol_index_size(struct bfelf_loader_t *loader);
+
+/**
+ * Set Symbol Index
+ *
+ * Provides the memory that the ELF loader uses for its global symbol index.
+ * The memory is owned by the caller, and must remain valid for as long as
+ * symbols are resolved using this loader (including lazy binding). If the
+ * index is too small for the symbols that are added, global symbols are
+ * resolved by searching each module instead.
+ *
+ * @param loader the ELF loader
+ * @param symbols the memory to use for the symbol index
+ * @param size the size of symbols in bytes, as returned by
+ *     bfelf_loader_symbol_index_size
+ * @return BFELF_SUCCESS on success, negative on error
+ */
+int64_t bfelf_loader_set_symbol_index(struct bfelf_loader_t *loader,
+                                      struct bfelf_symbol_index_t *symbols,
+                                      bfelf64_xword size);
+
+/**
+ * Set Lazy Binding
+ *
+ * Enables lazy binding of R_X86_64_JUMP_SLOT relocations for the ELF files
+ * relocated by this loader. The trampoline is written into GOT[2] of each
+ * ELF file that has a lazy PLT, and is jumped to by PLT0 with the ELF file
+ * (GOT[1]) and the relocation index on the stack. The trampoline is expected
+ * to call bfelf_file_bind_jump_slot, and then jump to the resulting address.
+ * ELF files without a .plt, .got.plt and .rela.plt are bound eagerly.
+ *
+ * Note that the trampoline must be reachable from wherever the ELF files
+ * will execute. If that is not true for all of the code (e.g. once a VMM
+ * enters VMX root mode), use bfelf_loader_bind to bind the functions that
+ * are needed beforehand.
+ *
+ * @param loader the ELF loader
+ * @param trampoline the address of the trampoline, or 0 to disable lazy
+ *     binding
+ * @return BFELF_SUCCESS on success, negative on error
+ */
+int64_t bfelf_loader_set_lazy(struct bfelf_loader_t *loader,
+                              bfelf64_addr trampoline);
+
+/**
+ * Bind
+ *
+ * Binds every R_X86_64_JUMP_SLOT relocation that was deferred by lazy
+ * binding, and that refers to the provided symbol, in every ELF file that
+ * was added to the loader. Slots that are already bound are left alone.
+ *
+ * @param loader the ELF loader
+ * @param name the name of the symbol to bind
+ * @return BFELF_SUCCESS on success, negative on error
+ */
+int64_t bfelf_loader_bind(struct bfelf_loader_t *loader,
+                          struct e_string_t *name);
+
+/**
+ * Bind All
+ *
+ * Binds every R_X86_64_JUMP_SLOT relocation that was deferred by lazy
+ * binding, and has not been bound yet.
+ *
+ * @param loader the ELF loader
+ * @return BFELF_SUCCESS on success, negative on error
+ */
+int64_t bfelf_loader_bind_all(struct bfelf_loader_t *loader);
+
 /**
  * Resolve Symbol
  *
@@ -126,6 +126,38 @@ private_error(const char *header,
 /* ELF Helpers                                                                */
 /* -------------------------------------------------------------------------- */
 
+struct bfelf_phdr *
+private_get_segment(struct bfelf_file_t *ef,
+                    bfelf64_xword index)
+{
+    return &(ef->phdrtab[index]);
+}
+
+struct bfelf_shdr *
+private_get_section(struct bfelf_file_t *ef,
+                    bfelf64_xword index)
+{
+    return &(ef->shdrtab[index]);
+}
+
+int64_t
+private_section_has_contents(struct bfelf_file_t *ef,
+                             struct bfelf_shdr *shdr)
+{
+    if (shdr->sh_type == bfsht_nobits)
+        return 0;
+
+    /*
+     * The sections whose contents were not kept when the ELF file was
+     * compacted have no file offset (see bfelf_file_compact).
+     */
+
+    if (ef->compacted == 1 && shdr->sh_offset == 0)
+        return 0;
+
+    return 1;
+}
+
 int64_t
 private_elf_string_equals(struct e_string_t *str1, struct e_string_t *str2)
 {
@@ -274,6 +306,55 @@ private_symbol_by_hash(struct bfelf_file_t *ef,
     return BFELF_ERROR_NO_SUCH_SYMBOL;
 }
 
+bfelf64_word
+private_gnu_hash(struct e_string_t *name)
+{
+    bfelf64_xword i = 0;
+    bfelf64_word h = 5381;
+
+    for (i = 0; i < name->len && name->buf[i] != 0; i++)
+        h = (h << 5) + h + (unsigned char)name->buf[i];
+
+    return h;
+}
+
+int64_t
+private_symbol_by_gnu_hash(struct bfelf_file_t *ef,
+                           struct e_string_t *name,
+                           struct bfelf_sym **sym)
+{
+    int64_t ret = 0;
+    bfelf64_word i = 0;
+    bfelf64_word h2 = 0;
+    bfelf64_xword mask = 0;
+    bfelf64_xword word = 0;
+    bfelf64_word h1 = private_gnu_hash(name);
+
+    word = ef->gnu_bloom[(h1 / 64) % ef->gnu_bloom_size];
+    mask = (1ULL << (h1 % 64)) | (1ULL << ((h1 >> ef->gnu_bloom_shift) % 64));
+
+    if ((word & mask) != mask)
+        return BFELF_ERROR_NO_SUCH_SYMBOL;
+
+    i = ef->gnu_bucket[h1 % ef->gnu_nbucket];
+    for (; i >= ef->gnu_symoffset && i < ef->symnum; i++)
+    {
+        h2 = ef->gnu_chain[i - ef->gnu_symoffset];
+
+        if ((h1 | 1) == (h2 | 1))
+        {
+            ret = private_check_symbol(ef, i, name, sym);
+            if (ret == BFELF_SUCCESS)
+                return BFELF_SUCCESS;
+        }
+
+        if ((h2 & 1) != 0)
+            break;
+    }
+
+    return BFELF_ERROR_NO_SUCH_SYMBOL;
+}
+
 int64_t
 private_symbol_by_name(struct bfelf_file_t *ef,
                        struct e_string_t *name,
@@ -282,6 +363,9 @@ private_symbol_by_name(struct bfelf_file_t *ef,
     int64_t ret = 0;
     bfelf64_word i = 0;
 
+    if (ef->gnu_hashtab != 0)
+        return private_symbol_by_gnu_hash(ef, name, sym);
+
     if (ef->hashtab != 0)
         return private_symbol_by_hash(ef, name, sym);
 
@@ -297,6 +381,150 @@ private_symbol_by_name(struct bfelf_file_t *ef,
     return BFELF_ERROR_NO_SUCH_SYMBOL;
 }
 
+/* -------------------------------------------------------------------------- */
+/* ELF Global Symbol Index                                                    */
+/* -------------------------------------------------------------------------- */
+
+int64_t
+private_symbol_index_add(struct bfelf_loader_t *loader,
+                         bfelf64_word module,
+                         bfelf64_word index)
+{
+    int64_t ret = 0;
+    bfelf64_word i = 0;
+    bfelf64_word hash = 0;
+    struct bfelf_sym *sym = 0;
+    struct bfelf_sym *found_sym = 0;
+    struct e_string_t name = {0, 0};
+    struct bfelf_symbol_index_t *entry = 0;
+    struct bfelf_file_t *ef = loader->efs[module];
+
+    ret = private_symbol_by_index(ef, index, &sym);
+    if (ret != BFELF_SUCCESS)
+        return ret;
+
+    if (sym->st_value == 0)
+        return BFELF_SUCCESS;
+
+    ret = private_get_string(ef, ef->strtab, sym->st_name, &name);
+    if (ret != BFELF_SUCCESS)
+        return ret;
+
+    if (name.len == 0)
+        return BFELF_SUCCESS;
+
+    hash = private_gnu_hash(&name);
+
+    for (i = hash & (loader->max_symbols - 1); ; i = (i + 1) & (loader->max_symbols - 1))
+    {
+        entry = &(loader->symbols[i]);
+
+        if (entry->sym == STN_UNDEF)
+            break;
+
+        if (entry->hash != hash)
+            continue;
+
+        ret = private_check_symbol(loader->efs[entry->module], entry->sym, &name, &found_sym);
+        if (ret != BFELF_SUCCESS)
+            continue;
+
+        /*
+         * The first global definition wins. A weak definition is replaced
+         * by any definition found in a later module, which means that if
+         * only weak definitions exist, the last one wins. This mirrors the
+         * module by module search.
+         */
+
+        if (entry->module != module && BFELF_SYM_BIND(found_sym->st_info) == bfstb_weak)
+        {
+            entry->module = module;
+            entry->sym = index;
+        }
+
+        return BFELF_SUCCESS;
+    }
+
+    if (loader->num_symbols >= (loader->max_symbols >> 2) * 3)
+        return loader_full("symbol index is too small");
+
+    entry->hash = hash;
+    entry->module = module;
+    entry->sym = index;
+
+    loader->num_symbols++;
+
+    return BFELF_SUCCESS;
+}
+
+int64_t
+private_symbol_index_build(struct bfelf_loader_t *loader)
+{
+    int64_t ret = 0;
+    bfelf64_word i = 0;
+    bfelf64_word m = 0;
+
+    if (loader->symbols == 0)
+        return BFELF_ERROR_LOADER_FULL;
+
+    for (i = 0; i < loader->max_symbols; i++)
+        loader->symbols[i].sym = STN_UNDEF;
+
+    for (m = 0; m < loader->num; m++)
+    {
+        for (i = 0; i < loader->efs[m]->symnum; i++)
+        {
+            ret = private_symbol_index_add(loader, m, i);
+            if (ret != BFELF_SUCCESS)
+                goto failure;
+        }
+    }
+
+    loader->indexed = 1;
+
+    return BFELF_SUCCESS;
+
+failure:
+
+    for (i = 0; i < loader->max_symbols; i++)
+        loader->symbols[i].sym = STN_UNDEF;
+
+    loader->indexed = 0;
+    loader->num_symbols = 0;
+
+    return ret;
+}
+
+int64_t
+private_symbol_index_find(struct bfelf_loader_t *loader,
+                          struct e_string_t *name,
+                          struct bfelf_file_t **ef_found,
+                          struct bfelf_sym **sym)
+{
+    int64_t ret = 0;
+    bfelf64_word i = 0;
+    struct bfelf_symbol_index_t *entry = 0;
+    bfelf64_word hash = private_gnu_hash(name);
+
+    for (i = hash & (loader->max_symbols - 1); ; i = (i + 1) & (loader->max_symbols - 1))
+    {
+        entry = &(loader->symbols[i]);
+
+        if (entry->sym == STN_UNDEF)
+            return BFELF_ERROR_NO_SUCH_SYMBOL;
+
+        if (entry->hash != hash)
+            continue;
+
+        ret = private_check_symbol(loader->efs[entry->module], entry->sym, name, sym);
+        if (ret != BFELF_SUCCESS)
+            continue;
+
+        *ef_found = loader->efs[entry->module];
+        return BFELF_SUCCESS;
+    }
+}
+
 int64_t
 private_symbol_global(struct bfelf_loader_t *loader,
                       struct e_string_t *name,
@@ -306,11 +534,37 @@ private_symbol_global(struct bfelf_loader_t *loader,
     int64_t ret = 0;
     bfelf64_word i = 0;
     struct bfelf_sym *found_sym = 0;
+    struct bfelf_file_t *found_ef = 0;
     struct bfelf_file_t *ef_ignore = *ef_found;
 
     *sym = 0;
     *ef_found = 0;
 
+    loader->num_global_lookups++;
+
+    if (loader->indexed == 1)
+    {
+        ret = private_symbol_index_find(loader, name, &found_ef, &found_sym);
+        if (ret != BFELF_SUCCESS)
+            return no_such_symbol(name->buf);
+
+        if (found_ef != ef_ignore)
+        {
+            *sym = found_sym;
+            *ef_found = found_ef;
+
+            return BFELF_SUCCESS;
+        }
+
+        /*
+         * The index only stores the winning definition for each symbol. If
+         * that definition lives in the module being ignored, the next best
+         * definition has to be found by searching the remaining modules.
+         */
+
+        loader->num_index_misses++;
+    }
+
     for (i = 0; i < loader->num; i++)
     {
         if (loader->efs[i] == ef_ignore)
@@ -346,21 +600,15 @@ private_symbol_global(struct bfelf_loader_t *loader,
 /* -------------------------------------------------------------------------- */
 
 int64_t
-private_relocate_symbol(struct bfelf_loader_t *loader,
-                        struct bfelf_file_t *ef,
-                        struct bfelf_rela *rela)
+private_symbol_address(struct bfelf_loader_t *loader,
+                       struct bfelf_file_t *ef,
+                       struct bfelf_rela *rela,
+                       struct e_string_t *name,
+                       bfelf64_addr *addr)
 {
     int64_t ret = 0;
-    struct e_string_t name = {0, 0};
     struct bfelf_sym *found_sym = 0;
     struct bfelf_file_t *found_ef = ef;
-    bfelf64_addr *ptr = (bfelf64_addr *)(ef->exec + rela->r_offset);
-
-    if (BFELF_REL_TYPE(rela->r_info) == BFR_X86_64_RELATIVE)
-    {
-        *ptr = (bfelf64_addr)(ef->exec + rela->r_addend);
-        return BFELF_SUCCESS;
-    }
 
     ret = private_symbol_by_index(ef, BFELF_REL_SYM(rela->r_info), &found_sym);
     if (ret != BFELF_SUCCESS)
@@ -371,16 +619,39 @@ private_relocate_symbol(struct bfelf_loader_t *loader,
 
     if (found_sym->st_value == 0 || found_ef == 0)
     {
-        ret = private_get_string(ef, ef->strtab, found_sym->st_name, &name);
+        ret = private_get_string(ef, ef->strtab, found_sym->st_name, name);
         if (ret != BFELF_SUCCESS)
             return ret;
 
-        ret = private_symbol_global(loader, &name, &found_ef, &found_sym);
+        ret = private_symbol_global(loader, name, &found_ef, &found_sym);
         if (ret != BFELF_SUCCESS)
             return ret;
     }
 
-    *ptr = (bfelf64_addr)(found_ef->exec + found_sym->st_value);
+    *addr = (bfelf64_addr)(found_ef->exec + found_sym->st_value);
+    return BFELF_SUCCESS;
+}
+
+int64_t
+private_relocate_symbol(struct bfelf_loader_t *loader,
+                        struct bfelf_file_t *ef,
+                        struct bfelf_rela *rela)
+{
+    int64_t ret = 0;
+    struct e_string_t name = {0, 0};
+    bfelf64_addr *ptr = (bfelf64_addr *)(ef->exec + rela->r_offset);
+
+    loader->num_relocations++;
+
+    if (BFELF_REL_TYPE(rela->r_info) == BFR_X86_64_RELATIVE)
+    {
+        *ptr = (bfelf64_addr)(ef->exec + rela->r_addend);
+        return BFELF_SUCCESS;
+    }
+
+    ret = private_symbol_address(loader, ef, rela, &name, ptr);
+    if (ret != BFELF_SUCCESS)
+        return ret;
 
     switch (BFELF_REL_TYPE(rela->r_info))
     {
@@ -399,72 +670,267 @@ private_relocate_symbol(struct bfelf_loader_t *loader,
     return BFELF_SUCCESS;
 }
 
+/* -------------------------------------------------------------------------- */
+/* ELF Lazy Binding                                                           */
+/* -------------------------------------------------------------------------- */
+
+void
+private_lazy_init(struct bfelf_loader_t *loader,
+                  struct bfelf_file_t *ef)
+{
+    bfelf64_addr *got = (bfelf64_addr *)(ef->exec + ef->got_plt);
+
+    got[1] = (bfelf64_addr)ef;
+    got[2] = loader->lazy_trampoline;
+}
+
 int64_t
-private_relocate_symbols(struct bfelf_loader_t *loader,
-                         struct bfelf_file_t *ef)
+private_file_value(struct bfelf_file_t *ef,
+                   bfelf64_addr vaddr,
+                   bfelf64_addr *value)
 {
-    int64_t ret = 0;
-    bfelf64_word r = 0;
-    bfelf64_word t = 0;
+    bfelf64_xword i = 0;
 
-    for (t = 0; t < ef->num_rela; t++)
+    /*
+     * The value is read through the section that contains it, and not the
+     * segment, as a compacted ELF file (see bfelf_file_compact) only keeps
+     * the contents of the sections that the loader needs.
+     */
+
+    for (i = 0; i < ef->ehdr->e_shnum; i++)
     {
-        for (r = 0; r < ef->relatab[t].num; r++)
-        {
-            ret = private_relocate_symbol(loader, ef, &(ef->relatab[t].tab[r]));
-            if (ret != BFELF_SUCCESS)
-                return ret;
-        }
+        struct bfelf_shdr *shdr = private_get_section(ef, i);
+
+        if (private_section_has_contents(ef, shdr) == 0 || shdr->sh_addr == 0)
+            continue;
+
+        if (vaddr < shdr->sh_addr)
+            continue;
+
+        if (vaddr + sizeof(bfelf64_addr) > shdr->sh_addr + shdr->sh_size)
+            continue;
+
+        *value = *(const bfelf64_addr *)(ef->file + shdr->sh_offset + (vaddr - shdr->sh_addr));
+        return BFELF_SUCCESS;
     }
 
-    return BFELF_SUCCESS;
+    return invalid_segment("relocation offset is not in a section with contents");
 }
 
 int64_t
-private_resolve_symbol(struct bfelf_file_t *ef,
-                       struct bfelf_sym *sym,
-                       void **addr)
+private_defer_jump_slot(struct bfelf_loader_t *loader,
+                        struct bfelf_file_t *ef,
+                        struct bfelf_rela *rela)
 {
-    *addr = ef->exec + sym->st_value;
+    int64_t ret = 0;
+    bfelf64_addr value = 0;
+
+    /*
+     * The linker initializes each jump slot with the address of the push
+     * instruction in its PLT entry, which is read from the file (not the
+     * execution buffer) so that relocating a module twice has the same
+     * result. A slot that does not point into the PLT cannot be bound
+     * lazily.
+     */
+
+    ret = private_file_value(ef, rela->r_offset, &value);
+    if (ret != BFELF_SUCCESS)
+        return ret;
+
+    if (value < ef->plt_start || value >= ef->plt_end)
+        return private_relocate_symbol(loader, ef, rela);
+
+    *(bfelf64_addr *)(ef->exec + rela->r_offset) = (bfelf64_addr)(ef->exec + value);
+
+    loader->num_lazy_slots++;
     return BFELF_SUCCESS;
 }
 
-/* -------------------------------------------------------------------------- */
-/* ELF File                                                                   */
-/* -------------------------------------------------------------------------- */
-
 int64_t
-private_check_signature(struct bfelf_file_t *ef)
+private_bind_jump_slot(struct bfelf_loader_t *loader,
+                       struct bfelf_file_t *ef,
+                       struct bfelf_rela *rela,
+                       bfelf64_addr *addr)
 {
-    if (ef->ehdr->e_ident[bfei_mag0] != 0x7F)
-        return invalid_signature("magic #0 has unexpected value");
-
-    if (ef->ehdr->e_ident[bfei_mag1] != 'E')
-        return invalid_signature("magic #1 has unexpected value");
+    int64_t ret = 0;
+    struct e_string_t name = {0, 0};
 
-    if (ef->ehdr->e_ident[bfei_mag2] != 'L')
-        return invalid_signature("magic #2 has unexpected value");
+    ret = private_symbol_address(loader, ef, rela, &name, addr);
+    if (ret != BFELF_SUCCESS)
+        return ret;
 
-    if (ef->ehdr->e_ident[bfei_mag3] != 'F')
-        return invalid_signature("magic #3 has unexpected value");
+    *(volatile bfelf64_addr *)(ef->exec + rela->r_offset) = *addr;
 
+    loader->num_lazy_binds++;
     return BFELF_SUCCESS;
 }
 
 int64_t
-private_check_support(struct bfelf_file_t *ef)
+private_jump_slot_pending(struct bfelf_file_t *ef,
+                          struct bfelf_rela *rela)
 {
-    if (ef->ehdr->e_ident[bfei_class] != bfelfclass64)
-        return unsupported_file("file is not 64bit");
+    bfelf64_addr value = *(volatile bfelf64_addr *)(ef->exec + rela->r_offset);
 
-    if (ef->ehdr->e_ident[bfei_data] != bfelfdata2lsb)
-        return unsupported_file("file is not little endian");
+    if (BFELF_REL_TYPE(rela->r_info) != BFR_X86_64_JUMP_SLOT)
+        return 0;
 
-    if (ef->ehdr->e_ident[bfei_version] != bfev_current)
-        return unsupported_file("unsupported version");
+    return value >= (bfelf64_addr)(ef->exec + ef->plt_start) &&
+           value < (bfelf64_addr)(ef->exec + ef->plt_end);
+}
 
-    /*
-     * if (ef->ehdr->e_ident[bfei_osabi] != bfelfosabi_sysv)
+int64_t
+private_bind_pending(struct bfelf_loader_t *loader,
+                     struct e_string_t *name)
+{
+    int64_t ret = 0;
+    bfelf64_word i = 0;
+    bfelf64_xword r = 0;
+    bfelf64_addr addr = 0;
+
+    if (loader->lazy_trampoline == 0)
+        return BFELF_SUCCESS;
+
+    for (i = 0; i < loader->num; i++)
+    {
+        struct bfelf_file_t *ef = loader->efs[i];
+
+        if (ef->lazy == 0)
+            continue;
+
+        for (r = 0; r < ef->num_jmprel; r++)
+        {
+            struct bfelf_rela *rela = &(ef->jmprel[r]);
+
+            if (private_jump_slot_pending(ef, rela) == 0)
+                continue;
+
+            if (name != 0)
+            {
+                struct bfelf_sym *sym = 0;
+                struct e_string_t str = {0, 0};
+
+                ret = private_symbol_by_index(ef, BFELF_REL_SYM(rela->r_info), &sym);
+                if (ret != BFELF_SUCCESS)
+                    return ret;
+
+                ret = private_get_string(ef, ef->strtab, sym->st_name, &str);
+                if (ret != BFELF_SUCCESS)
+                    return ret;
+
+                if (private_elf_string_equals(name, &str) != BFELF_SUCCESS)
+                    continue;
+            }
+
+            ret = private_bind_jump_slot(loader, ef, rela, &addr);
+            if (ret != BFELF_SUCCESS)
+                return ret;
+        }
+    }
+
+    return BFELF_SUCCESS;
+}
+
+int64_t
+private_relocate_symbols(struct bfelf_loader_t *loader,
+                         struct bfelf_file_t *ef)
+{
+    int64_t ret = 0;
+    bfelf64_word r = 0;
+    bfelf64_word t = 0;
+    bfelf64_word lazy = ef->lazy != 0 && loader->lazy_trampoline != 0;
+
+    for (t = 0; t < ef->num_rela; t++)
+    {
+        for (r = 0; r < ef->relatab[t].num; r++)
+        {
+            struct bfelf_rela *rela = &(ef->relatab[t].tab[r]);
+
+            if (lazy != 0 && BFELF_REL_TYPE(rela->r_info) == BFR_X86_64_JUMP_SLOT)
+                ret = private_defer_jump_slot(loader, ef, rela);
+            else
+                ret = private_relocate_symbol(loader, ef, rela);
+
+            if (ret != BFELF_SUCCESS)
+                return ret;
+        }
+    }
+
+    return BFELF_SUCCESS;
+}
+
+int64_t
+private_relocate_relative(struct bfelf_loader_t *loader,
+                          struct bfelf_file_t *ef)
+{
+    bfelf64_word t = 0;
+    bfelf64_addr base = (bfelf64_addr)ef->exec;
+
+    /*
+     * A static PIE only has R_X86_64_RELATIVE relocations (this was checked
+     * when the file was initialized), so each relocation is a single add
+     * with no symbol lookup.
+     */
+
+    for (t = 0; t < ef->num_rela; t++)
+    {
+        bfelf64_xword r = 0;
+        bfelf64_xword num = ef->relatab[t].num;
+        struct bfelf_rela *tab = ef->relatab[t].tab;
+
+        for (r = 0; r < num; r++)
+            *(bfelf64_addr *)(ef->exec + tab[r].r_offset) = base + (bfelf64_addr)tab[r].r_addend;
+
+        loader->num_relocations += num;
+    }
+
+    return BFELF_SUCCESS;
+}
+
+int64_t
+private_resolve_symbol(struct bfelf_file_t *ef,
+                       struct bfelf_sym *sym,
+                       void **addr)
+{
+    *addr = ef->exec + sym->st_value;
+    return BFELF_SUCCESS;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ELF File                                                                   */
+/* -------------------------------------------------------------------------- */
+
+int64_t
+private_check_signature(struct bfelf_file_t *ef)
+{
+    if (ef->ehdr->e_ident[bfei_mag0] != 0x7F)
+        return invalid_signature("magic #0 has unexpected value");
+
+    if (ef->ehdr->e_ident[bfei_mag1] != 'E')
+        return invalid_signature("magic #1 has unexpected value");
+
+    if (ef->ehdr->e_ident[bfei_mag2] != 'L')
+        return invalid_signature("magic #2 has unexpected value");
+
+    if (ef->ehdr->e_ident[bfei_mag3] != 'F')
+        return invalid_signature("magic #3 has unexpected value");
+
+    return BFELF_SUCCESS;
+}
+
+int64_t
+private_check_support(struct bfelf_file_t *ef)
+{
+    if (ef->ehdr->e_ident[bfei_class] != bfelfclass64)
+        return unsupported_file("file is not 64bit");
+
+    if (ef->ehdr->e_ident[bfei_data] != bfelfdata2lsb)
+        return unsupported_file("file is not little endian");
+
+    if (ef->ehdr->e_ident[bfei_version] != bfev_current)
+        return unsupported_file("unsupported version");
+
+    /*
+     * if (ef->ehdr->e_ident[bfei_osabi] != bfelfosabi_sysv)
      *     return unsupported_file("file does not use the system v abi");
      */
 
@@ -516,20 +982,6 @@ private_validate_bounds(struct bfelf_file_t *ef)
     return BFELF_SUCCESS;
 }
 
-struct bfelf_phdr *
-private_get_segment(struct bfelf_file_t *ef,
-                    bfelf64_xword index)
-{
-    return &(ef->phdrtab[index]);
-}
-
-struct bfelf_shdr *
-private_get_section(struct bfelf_file_t *ef,
-                    bfelf64_xword index)
-{
-    return &(ef->shdrtab[index]);
-}
-
 int64_t
 private_get_section_by_name(struct bfelf_file_t *ef,
                             struct e_string_t *name,
@@ -604,7 +1056,7 @@ private_check_sections(struct bfelf_file_t *ef)
         bfelf64_sword valid_addr = 0;
         struct bfelf_shdr *shdr = private_get_section(ef, i);
 
-        if (shdr->sh_type != bfsht_nobits)
+        if (private_section_has_contents(ef, shdr) == 1)
         {
             if (shdr->sh_offset + shdr->sh_size > ef->fsize)
                 return invalid_section("section offset / size is corrupt");
@@ -719,6 +1171,21 @@ private_symbol_table_sections(struct bfelf_file_t *ef)
             ef->hashtab = shdr;
             continue;
         }
+
+        /*
+         * SHT_GNU_HASH is an OS specific type, so like SHT_X86_64_UNWIND,
+         * only the lower 8 bits are compared by private_check_section.
+         */
+
+        if (shdr->sh_type == bfsht_gnu_hash)
+        {
+            ret = private_check_section(shdr, bfsht_gnu_hash & 0xFF, bfshf_a, 8, 0);
+            if (ret != BFELF_SUCCESS)
+                return ret;
+
+            ef->gnu_hashtab = shdr;
+            continue;
+        }
     }
 
     if (!ef->dynsym)
@@ -810,29 +1277,125 @@ private_get_hash_table(struct bfelf_file_t *ef)
         ef->chain = &(p[2 + ef->nbucket]);
     }
 
+    if (ef->gnu_hashtab)
+    {
+        bfelf64_xword total = 0;
+        bfelf64_word *p = (bfelf64_word *)(ef->gnu_hashtab->sh_offset + ef->file);
+
+        if (sizeof(bfelf64_word) * 4 > ef->gnu_hashtab->sh_size)
+            return invalid_section("gnu hash table contents corrupt");
+
+        ef->gnu_nbucket = p[0];
+        ef->gnu_symoffset = p[1];
+        ef->gnu_bloom_size = p[2];
+        ef->gnu_bloom_shift = p[3];
+
+        if (ef->gnu_nbucket == 0 || ef->gnu_bloom_size == 0)
+            return invalid_section("gnu hash table contents corrupt");
+
+        if (ef->gnu_symoffset > ef->symnum)
+            return invalid_section("gnu hash table contents corrupt");
+
+        total = (4 + ef->gnu_nbucket + ef->symnum - ef->gnu_symoffset) * sizeof(bfelf64_word) +
+                ef->gnu_bloom_size * sizeof(bfelf64_xword);
+        if (total > ef->gnu_hashtab->sh_size)
+            return invalid_section("gnu hash table contents corrupt");
+
+        ef->gnu_bloom = (bfelf64_xword *)(&(p[4]));
+        ef->gnu_bucket = (bfelf64_word *)(&(ef->gnu_bloom[ef->gnu_bloom_size]));
+        ef->gnu_chain = &(ef->gnu_bucket[ef->gnu_nbucket]);
+    }
+
     return BFELF_SUCCESS;
 }
 
 int64_t
-bfelf_file_init(const char *file, uint64_t fsize, struct bfelf_file_t *ef)
+private_get_plt(struct bfelf_file_t *ef)
 {
     int64_t ret = 0;
-    bfelf64_word i = 0;
+    struct bfelf_shdr *plt = 0;
+    struct bfelf_shdr *got_plt = 0;
+    struct bfelf_shdr *rela_plt = 0;
+    struct e_string_t name_plt = {".plt", 4};
+    struct e_string_t name_got_plt = {".got.plt", 8};
+    struct e_string_t name_rela_plt = {".rela.plt", 9};
+
+    ret = private_get_section_by_name(ef, &name_plt, &plt);
+    if (ret != BFELF_SUCCESS)
+        return ret;
 
-    if (!file)
-        return invalid_argument("file == NULL");
+    ret = private_get_section_by_name(ef, &name_got_plt, &got_plt);
+    if (ret != BFELF_SUCCESS)
+        return ret;
 
-    if (!ef)
-        return invalid_argument("ef == NULL");
+    ret = private_get_section_by_name(ef, &name_rela_plt, &rela_plt);
+    if (ret != BFELF_SUCCESS)
+        return ret;
 
-    if (fsize == 0 || fsize < sizeof(struct bfelf64_ehdr))
-        return invalid_argument("fsize invalid");
+    /*
+     * Lazy binding needs PLT0, and the reserved GOT entries that it uses.
+     * Without them there is nothing to point the jump slots at, and the
+     * ELF file is bound eagerly, even if lazy binding is enabled.
+     */
+
+    if (plt == 0 || got_plt == 0 || rela_plt == 0)
+        return BFELF_SUCCESS;
+
+    if (got_plt->sh_size < 3 * sizeof(bfelf64_addr))
+        return BFELF_SUCCESS;
+
+    if (rela_plt->sh_type != bfsht_rela)
+        return BFELF_SUCCESS;
+
+    ef->plt_start = plt->sh_addr;
+    ef->plt_end = plt->sh_addr + plt->sh_size;
+    ef->got_plt = got_plt->sh_addr;
+    ef->num_jmprel = rela_plt->sh_size / sizeof(struct bfelf_rela);
+    ef->jmprel = (struct bfelf_rela *)(ef->file + rela_plt->sh_offset);
+
+    ef->lazy = 1;
+    return BFELF_SUCCESS;
+}
+
+void
+private_check_static_pie(struct bfelf_file_t *ef)
+{
+    bfelf64_word t = 0;
+    bfelf64_xword r = 0;
+
+    if (ef->ehdr->e_type != bfet_dyn || ef->ehdr->e_entry == 0)
+        return;
+
+    if (ef->num_rela == 0)
+        return;
+
+    for (t = 0; t < ef->num_rela; t++)
+    {
+        for (r = 0; r < ef->relatab[t].num; r++)
+        {
+            if (BFELF_REL_TYPE(ef->relatab[t].tab[r].r_info) != BFR_X86_64_RELATIVE)
+                return;
+        }
+    }
+
+    ef->static_pie = 1;
+}
+
+int64_t
+private_file_init(const char *file,
+                  uint64_t fsize,
+                  struct bfelf_file_t *ef,
+                  bfelf64_word compacted)
+{
+    int64_t ret = 0;
+    bfelf64_word i = 0;
 
     for (i = 0; i < sizeof(struct bfelf_file_t); i++)
         ((char *)ef)[i] = 0;
 
     ef->file = file;
     ef->fsize = fsize;
+    ef->compacted = compacted;
 
     ef->ehdr = (struct bfelf64_ehdr *)file;
     ef->shdrtab = (struct bfelf_shdr *)(file + ef->ehdr->e_shoff);
@@ -880,6 +1443,12 @@ bfelf_file_init(const char *file, uint64_t fsize, struct bfelf_file_t *ef)
     if (ret != BFELF_SUCCESS)
         goto failure;
 
+    ret = private_get_plt(ef);
+    if (ret != BFELF_SUCCESS)
+        goto failure;
+
+    private_check_static_pie(ef);
+
     return BFELF_SUCCESS;
 
 failure:
@@ -890,6 +1459,21 @@ failure:
     return ret;
 }
 
+int64_t
+bfelf_file_init(const char *file, uint64_t fsize, struct bfelf_file_t *ef)
+{
+    if (!file)
+        return invalid_argument("file == NULL");
+
+    if (!ef)
+        return invalid_argument("ef == NULL");
+
+    if (fsize == 0 || fsize < sizeof(struct bfelf64_ehdr))
+        return invalid_argument("fsize invalid");
+
+    return private_file_init(file, fsize, ef, 0);
+}
+
 int64_t
 bfelf_file_num_segments(struct bfelf_file_t *ef)
 {
@@ -949,6 +1533,205 @@ bfelf_file_resolve_symbol(struct bfelf_file_t *ef,
     return BFELF_SUCCESS;
 }
 
+int64_t
+bfelf_file_is_static_pie(struct bfelf_file_t *ef)
+{
+    if (!ef)
+        return invalid_argument("ef == NULL");
+
+    return ef->static_pie != 0 ? 1 : 0;
+}
+
+bfelf64_xword
+private_compact_align(bfelf64_xword size)
+{
+    return (size + 7) & ~((bfelf64_xword)7);
+}
+
+void
+private_compact_copy(char *dst, const char *src, bfelf64_xword size)
+{
+    bfelf64_xword i = 0;
+
+    for (i = 0; i < size; i++)
+        dst[i] = src[i];
+}
+
+int64_t
+private_compact_keep(struct bfelf_file_t *ef,
+                     struct bfelf_shdr *shdr)
+{
+    if (private_section_has_contents(ef, shdr) == 0)
+        return 0;
+
+    if (shdr->sh_type == bfsht_rela)
+        return 1;
+
+    if (shdr == ef->shstrtab || shdr == ef->strtab || shdr == ef->dynsym)
+        return 1;
+
+    if (shdr == ef->hashtab || shdr == ef->gnu_hashtab)
+        return 1;
+
+    /*
+     * With lazy binding, the initial values of the jump slots are read from
+     * .got.plt when the ELF file is relocated (see private_file_value).
+     */
+
+    if (ef->lazy == 1 && shdr->sh_addr == ef->got_plt && shdr->sh_size != 0)
+        return 1;
+
+    return 0;
+}
+
+int64_t
+bfelf_file_compact_size(struct bfelf_file_t *ef)
+{
+    bfelf64_xword i = 0;
+    bfelf64_xword total = 0;
+
+    if (!ef)
+        return invalid_argument("ef == NULL");
+
+    if (!ef->file)
+        return out_of_order("you need to call bfelf_file_init first");
+
+    total += sizeof(struct bfelf64_ehdr);
+    total += ef->ehdr->e_phnum * sizeof(struct bfelf_phdr);
+    total += ef->ehdr->e_shnum * sizeof(struct bfelf_shdr);
+
+    for (i = 0; i < ef->ehdr->e_shnum; i++)
+    {
+        struct bfelf_shdr *shdr = private_get_section(ef, i);
+
+        if (private_compact_keep(ef, shdr) == 1)
+            total += private_compact_align(shdr->sh_size);
+    }
+
+    return (int64_t)total;
+}
+
+int64_t
+bfelf_file_compact(struct bfelf_file_t *ef,
+                   char *buf,
+                   bfelf64_xword size)
+{
+    int64_t ret = 0;
+    bfelf64_xword i = 0;
+    bfelf64_xword offset = 0;
+    struct bfelf64_ehdr *ehdr = 0;
+    struct bfelf_phdr *phdrtab = 0;
+    struct bfelf_shdr *shdrtab = 0;
+
+    if (!ef)
+        return invalid_argument("ef == NULL");
+
+    if (!buf)
+        return invalid_argument("buf == NULL");
+
+    if (!ef->file)
+        return out_of_order("you need to call bfelf_file_init first");
+
+    if (ef->loader != 0)
+        return out_of_order("the ELF file must be compacted before bfelf_loader_add");
+
+    ret = bfelf_file_compact_size(ef);
+    if (ret < 0)
+        return ret;
+
+    if (size < (bfelf64_xword)ret)
+        return invalid_argument("buf is too small");
+
+    size = (bfelf64_xword)ret;
+
+    ehdr = (struct bfelf64_ehdr *)buf;
+    phdrtab = (struct bfelf_phdr *)(buf + sizeof(struct bfelf64_ehdr));
+    shdrtab = (struct bfelf_shdr *)(phdrtab + ef->ehdr->e_phnum);
+
+    private_compact_copy(buf, ef->file, sizeof(struct bfelf64_ehdr));
+
+    ehdr->e_phoff = (bfelf64_off)((char *)phdrtab - buf);
+    ehdr->e_shoff = (bfelf64_off)((char *)shdrtab - buf);
+
+    /*
+     * The segments have already been loaded by the time an ELF file is
+     * compacted, so none of their contents are kept.
+     */
+
+    for (i = 0; i < ef->ehdr->e_phnum; i++)
+    {
+        private_compact_copy((char *)&(phdrtab[i]), (const char *)private_get_segment(ef, i),
+                             sizeof(struct bfelf_phdr));
+
+        phdrtab[i].p_offset = 0;
+        phdrtab[i].p_filesz = 0;
+    }
+
+    offset = (bfelf64_xword)((char *)(shdrtab + ef->ehdr->e_shnum) - buf);
+
+    for (i = 0; i < ef->ehdr->e_shnum; i++)
+    {
+        bfelf64_xword j = 0;
+        struct bfelf_shdr *shdr = private_get_section(ef, i);
+
+        private_compact_copy((char *)&(shdrtab[i]), (const char *)shdr,
+                             sizeof(struct bfelf_shdr));
+
+        if (private_compact_keep(ef, shdr) == 0)
+        {
+            shdrtab[i].sh_offset = 0;
+            continue;
+        }
+
+        private_compact_copy(buf + offset, ef->file + shdr->sh_offset, shdr->sh_size);
+
+        for (j = shdr->sh_size; j < private_compact_align(shdr->sh_size); j++)
+            buf[offset + j] = 0;
+
+        shdrtab[i].sh_offset = offset;
+        offset += private_compact_align(shdr->sh_size);
+    }
+
+    return private_file_init(buf, size, ef, 1);
+}
+
+int64_t
+bfelf_file_bind_jump_slot(struct bfelf_file_t *ef,
+                          bfelf64_xword index,
+                          void **addr)
+{
+    int64_t ret = 0;
+    bfelf64_addr target = 0;
+    struct bfelf_rela *rela = 0;
+
+    if (!ef)
+        return invalid_argument("ef == NULL");
+
+    if (!addr)
+        return invalid_argument("addr == NULL");
+
+    if (ef->lazy == 0 || ef->loader == 0 || ef->loader->lazy_trampoline == 0)
+        return out_of_order("the ELF file was not relocated with lazy binding");
+
+    if (ef->relocated == 0)
+        return out_of_order("you need to call bfelf_loader_relocate first");
+
+    if (index >= ef->num_jmprel)
+        return invalid_index("jump slot index out of bounds");
+
+    rela = &(ef->jmprel[index]);
+
+    if (BFELF_REL_TYPE(rela->r_info) != BFR_X86_64_JUMP_SLOT)
+        return unsupported_rel("only R_X86_64_JUMP_SLOT relocations can be bound lazily");
+
+    ret = private_bind_jump_slot(ef->loader, ef, rela, &target);
+    if (ret != BFELF_SUCCESS)
+        return ret;
+
+    *addr = (void *)target;
+    return BFELF_SUCCESS;
+}
+
 /* -------------------------------------------------------------------------- */
 /* ELF Loader                                                                 */
 /* -------------------------------------------------------------------------- */
@@ -968,6 +1751,7 @@ bfelf_loader_add(struct bfelf_loader_t *loader,
         return loader_full("increase BFELF_MAX_MODULES");
 
     ef->exec = exec;
+    ef->loader = loader;
     loader->efs[loader->num++] = ef;
 
     return BFELF_SUCCESS;
@@ -985,9 +1769,26 @@ bfelf_loader_relocate(struct bfelf_loader_t *loader)
     if (loader->relocated == 1)
         return BFELF_SUCCESS;
 
+    /*
+     * If the global symbol index cannot be built (e.g. the caller did not
+     * provide one, or it is too small), global symbols are
+     * resolved by searching each module instead. A single static PIE never
+     * needs a global lookup to be relocated, so the index is not built.
+     */
+
+    if (loader->num != 1 || loader->efs[0]->static_pie == 0)
+        private_symbol_index_build(loader);
+
     for (i = 0; i < loader->num; i++)
     {
-        ret = private_relocate_symbols(loader, loader->efs[i]);
+        if (loader->efs[i]->lazy != 0 && loader->lazy_trampoline != 0)
+            private_lazy_init(loader, loader->efs[i]);
+
+        if (loader->efs[i]->static_pie != 0)
+            ret = private_relocate_relative(loader, loader->efs[i]);
+        else
+            ret = private_relocate_symbols(loader, loader->efs[i]);
+
         if (ret != BFELF_SUCCESS)
             return ret;
 
@@ -996,9 +1797,112 @@ bfelf_loader_relocate(struct bfelf_loader_t *loader)
 
     loader->relocated = 1;
 
+    DEBUG("relocated %d modules:\n", (int)loader->num);
+    DEBUG("    indexed symbols = %d\n", (int)loader->num_symbols);
+    DEBUG("    relocations = %d\n", (int)loader->num_relocations);
+    DEBUG("    global lookups = %d\n", (int)loader->num_global_lookups);
+    DEBUG("    index misses = %d\n", (int)loader->num_index_misses);
+    DEBUG("    deferred jump slots = %d\n", (int)loader->num_lazy_slots);
+
+    return BFELF_SUCCESS;
+}
+
+int64_t
+bfelf_loader_symbol_index_size(struct bfelf_loader_t *loader)
+{
+    bfelf64_word i = 0;
+    bfelf64_xword total = 0;
+    bfelf64_xword slots = 4;
+
+    if (!loader)
+        return invalid_argument("loader == NULL");
+
+    for (i = 0; i < loader->num; i++)
+        total += loader->efs[i]->symnum;
+
+    /*
+     * The index is only used while at most 3/4 of the slots are filled, and
+     * the number of slots must be a power of 2.
+     */
+
+    while ((slots >> 2) * 3 <= total)
+    {
+        if (slots >= 0x80000000)
+            return loader_full("too many symbols to index");
+
+        slots <<= 1;
+    }
+
+    return (int64_t)(slots * sizeof(struct bfelf_symbol_index_t));
+}
+
+int64_t
+bfelf_loader_set_symbol_index(struct bfelf_loader_t *loader,
+                              struct bfelf_symbol_index_t *symbols,
+                              bfelf64_xword size)
+{
+    bfelf64_xword slots = size / sizeof(struct bfelf_symbol_index_t);
+
+    if (!loader)
+        return invalid_argument("loader == NULL");
+
+    if (!symbols)
+        return invalid_argument("symbols == NULL");
+
+    if (slots == 0 || slots > 0x80000000 || (slots & (slots - 1)) != 0)
+        return invalid_argument("size is not a power of 2 number of entries");
+
+    if (loader->relocated == 1)
+        return out_of_order("the symbol index must be set before bfelf_loader_relocate");
+
+    loader->symbols = symbols;
+    loader->max_symbols = (bfelf64_word)slots;
+
     return BFELF_SUCCESS;
 }
 
+int64_t
+bfelf_loader_set_lazy(struct bfelf_loader_t *loader,
+                      bfelf64_addr trampoline)
+{
+    if (!loader)
+        return invalid_argument("loader == NULL");
+
+    if (loader->relocated == 1)
+        return out_of_order("lazy binding must be set before bfelf_loader_relocate");
+
+    loader->lazy_trampoline = trampoline;
+    return BFELF_SUCCESS;
+}
+
+int64_t
+bfelf_loader_bind(struct bfelf_loader_t *loader,
+                  struct e_string_t *name)
+{
+    if (!loader)
+        return invalid_argument("loader == NULL");
+
+    if (!name)
+        return invalid_argument("name == NULL");
+
+    if (loader->relocated == 0)
+        return out_of_order("you need to call bfelf_loader_relocate first");
+
+    return private_bind_pending(loader, name);
+}
+
+int64_t
+bfelf_loader_bind_all(struct bfelf_loader_t *loader)
+{
+    if (!loader)
+        return invalid_argument("loader == NULL");
+
+    if (loader->relocated == 0)
+        return out_of_order("you need to call bfelf_loader_relocate first");
+
+    return private_bind_pending(loader, 0);
+}
+
 int64_t
 bfelf_loader_resolve_symbol(struct bfelf_loader_t *loader,
                             struct e_string_t *name,
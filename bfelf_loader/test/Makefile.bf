@@ -53,11 +53,15 @@ NATIVE_OUTDIR+=%BUILD_REL%/../bin
 ################################################################################
 
 SOURCES+=test.cpp
+SOURCES+=test_file_bind_jump_slot.cpp
+SOURCES+=test_file_compact.cpp
 SOURCES+=test_file_get_segment.cpp
 SOURCES+=test_file_init.cpp
+SOURCES+=test_file_is_static_pie.cpp
 SOURCES+=test_file_num_segments.cpp
 SOURCES+=test_file_resolve_symbol.cpp
 SOURCES+=test_loader_add.cpp
+SOURCES+=test_loader_bind.cpp
 SOURCES+=test_loader_get_info.cpp
 SOURCES+=test_loader_relocate.cpp
 SOURCES+=test_loader_resolve_symbol.cpp
@@ -110,6 +110,26 @@ bool bfelf_loader_ut::list()
     this->test_bfelf_file_num_segments_uninitalized();
     this->test_bfelf_file_num_segments_success();
 
+    this->test_bfelf_file_is_static_pie_invalid_ef();
+    this->test_bfelf_file_is_static_pie_shared_library();
+    this->test_bfelf_file_is_static_pie_no_entry();
+    this->test_bfelf_file_is_static_pie_symbol_relocation();
+    this->test_bfelf_file_is_static_pie_success();
+
+    this->test_bfelf_file_bind_jump_slot_invalid_ef();
+    this->test_bfelf_file_bind_jump_slot_invalid_addr();
+    this->test_bfelf_file_bind_jump_slot_not_lazy();
+    this->test_bfelf_file_bind_jump_slot_invalid_index();
+    this->test_bfelf_file_bind_jump_slot_success();
+
+    this->test_bfelf_file_compact_size_invalid_ef();
+    this->test_bfelf_file_compact_size_uninitialized();
+    this->test_bfelf_file_compact_invalid_args();
+    this->test_bfelf_file_compact_buf_too_small();
+    this->test_bfelf_file_compact_after_add();
+    this->test_bfelf_file_compact_success();
+    this->test_bfelf_file_compact_lazy();
+
     this->test_bfelf_file_get_segment_invalid_ef();
     this->test_bfelf_file_get_segment_invalid_index();
     this->test_bfelf_file_get_segment_invalid_phdr();
@@ -158,6 +178,21 @@ bool bfelf_loader_ut::list()
     this->test_bfelf_loader_relocate_no_files_added();
     this->test_bfelf_loader_relocate_uninitialized_files();
     this->test_bfelf_loader_relocate_twice();
+    this->test_bfelf_loader_relocate_symbol_index();
+    this->test_bfelf_loader_relocate_symbol_index_too_small();
+    this->test_bfelf_loader_symbol_index_size_invalid_loader();
+    this->test_bfelf_loader_set_symbol_index_invalid_args();
+    this->test_bfelf_loader_relocate_static_pie();
+
+    this->test_bfelf_loader_set_lazy_invalid_loader();
+    this->test_bfelf_loader_set_lazy_after_relocate();
+    this->test_bfelf_loader_bind_invalid_loader();
+    this->test_bfelf_loader_bind_invalid_name();
+    this->test_bfelf_loader_bind_not_relocated();
+    this->test_bfelf_loader_bind_all_invalid_loader();
+    this->test_bfelf_loader_bind_all_not_relocated();
+    this->test_bfelf_loader_relocate_lazy();
+    this->test_bfelf_loader_relocate_lazy_matches_eager();
 
     this->test_bfelf_loader_get_info_invalid_loader();
     this->test_bfelf_loader_get_info_invalid_elf_file();
@@ -190,6 +225,16 @@ bool bfelf_loader_ut::list()
     this->test_private_get_relocation_tables_invalid_type();
     this->test_private_get_relocation_tables_invalid_section();
     this->test_private_hash();
+    this->test_private_symbol_by_gnu_hash();
+    this->test_private_symbol_index_weak_precedence();
+
+    return true;
+}
+
+bool bfelf_loader_ut::benchmark()
+{
+    this->benchmark_bfelf_loader_relocate();
+    this->benchmark_bfelf_loader_relocate_lazy();
 
     return true;
 }
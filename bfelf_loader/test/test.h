@@ -39,6 +39,7 @@ protected:
     bool init() override;
     bool fini() override;
     bool list() override;
+    bool benchmark() override;
 
 private:
 
@@ -96,6 +97,26 @@ private:
     void test_bfelf_file_num_segments_uninitalized();
     void test_bfelf_file_num_segments_success();
 
+    void test_bfelf_file_is_static_pie_invalid_ef();
+    void test_bfelf_file_is_static_pie_shared_library();
+    void test_bfelf_file_is_static_pie_no_entry();
+    void test_bfelf_file_is_static_pie_symbol_relocation();
+    void test_bfelf_file_is_static_pie_success();
+
+    void test_bfelf_file_bind_jump_slot_invalid_ef();
+    void test_bfelf_file_bind_jump_slot_invalid_addr();
+    void test_bfelf_file_bind_jump_slot_not_lazy();
+    void test_bfelf_file_bind_jump_slot_invalid_index();
+    void test_bfelf_file_bind_jump_slot_success();
+
+    void test_bfelf_file_compact_size_invalid_ef();
+    void test_bfelf_file_compact_size_uninitialized();
+    void test_bfelf_file_compact_invalid_args();
+    void test_bfelf_file_compact_buf_too_small();
+    void test_bfelf_file_compact_after_add();
+    void test_bfelf_file_compact_success();
+    void test_bfelf_file_compact_lazy();
+
     void test_bfelf_file_get_segment_invalid_ef();
     void test_bfelf_file_get_segment_invalid_index();
     void test_bfelf_file_get_segment_invalid_phdr();
@@ -144,6 +165,21 @@ private:
     void test_bfelf_loader_relocate_no_files_added();
     void test_bfelf_loader_relocate_uninitialized_files();
     void test_bfelf_loader_relocate_twice();
+    void test_bfelf_loader_relocate_symbol_index();
+    void test_bfelf_loader_relocate_symbol_index_too_small();
+    void test_bfelf_loader_symbol_index_size_invalid_loader();
+    void test_bfelf_loader_set_symbol_index_invalid_args();
+    void test_bfelf_loader_relocate_static_pie();
+
+    void test_bfelf_loader_set_lazy_invalid_loader();
+    void test_bfelf_loader_set_lazy_after_relocate();
+    void test_bfelf_loader_bind_invalid_loader();
+    void test_bfelf_loader_bind_invalid_name();
+    void test_bfelf_loader_bind_not_relocated();
+    void test_bfelf_loader_bind_all_invalid_loader();
+    void test_bfelf_loader_bind_all_not_relocated();
+    void test_bfelf_loader_relocate_lazy();
+    void test_bfelf_loader_relocate_lazy_matches_eager();
 
     void test_bfelf_loader_get_info_invalid_loader();
     void test_bfelf_loader_get_info_invalid_elf_file();
@@ -176,6 +212,11 @@ private:
     void test_private_get_relocation_tables_invalid_type();
     void test_private_get_relocation_tables_invalid_section();
     void test_private_hash();
+    void test_private_symbol_by_gnu_hash();
+    void test_private_symbol_index_weak_precedence();
+
+    void benchmark_bfelf_loader_relocate();
+    void benchmark_bfelf_loader_relocate_lazy();
 
 private:
 
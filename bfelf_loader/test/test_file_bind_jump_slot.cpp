@@ -0,0 +1,161 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <test.h>
+
+void
+bfelf_loader_ut::test_bfelf_file_bind_jump_slot_invalid_ef()
+{
+    void *addr = nullptr;
+
+    auto ret = bfelf_file_bind_jump_slot(nullptr, 0, &addr);
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+}
+
+void
+bfelf_loader_ut::test_bfelf_file_bind_jump_slot_invalid_addr()
+{
+    bfelf_file_t ef;
+    memset(&ef, 0, sizeof(ef));
+
+    auto ret = bfelf_file_bind_jump_slot(&ef, 0, nullptr);
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+}
+
+void
+bfelf_loader_ut::test_bfelf_file_bind_jump_slot_not_lazy()
+{
+    auto ret = 0LL;
+    void *addr = nullptr;
+    bfelf_file_t dummy_misc_ef;
+    bfelf_file_t dummy_code_ef;
+
+    ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &dummy_misc_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_file_init(m_dummy_code.get(), m_dummy_code_length, &dummy_code_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
+    m_dummy_code_exec = load_elf_file(&dummy_code_ef);
+
+    auto loader = std::make_unique<bfelf_loader_t>();
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    ret = bfelf_loader_add(loader.get(), &dummy_misc_ef, m_dummy_misc_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_loader_add(loader.get(), &dummy_code_ef, m_dummy_code_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_relocate(loader.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_file_bind_jump_slot(&dummy_misc_ef, 0, &addr);
+    this->expect_true(ret == BFELF_ERROR_OUT_OF_ORDER);
+}
+
+void
+bfelf_loader_ut::test_bfelf_file_bind_jump_slot_invalid_index()
+{
+    auto ret = 0LL;
+    void *addr = nullptr;
+    bfelf_file_t dummy_misc_ef;
+    bfelf_file_t dummy_code_ef;
+
+    ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &dummy_misc_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_file_init(m_dummy_code.get(), m_dummy_code_length, &dummy_code_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
+    m_dummy_code_exec = load_elf_file(&dummy_code_ef);
+
+    auto loader = std::make_unique<bfelf_loader_t>();
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    ret = bfelf_loader_add(loader.get(), &dummy_misc_ef, m_dummy_misc_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_loader_add(loader.get(), &dummy_code_ef, m_dummy_code_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_set_lazy(loader.get(), 0x1000);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_relocate(loader.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_file_bind_jump_slot(&dummy_misc_ef, dummy_misc_ef.num_jmprel, &addr);
+    this->expect_true(ret == BFELF_ERROR_INVALID_INDEX);
+}
+
+void
+bfelf_loader_ut::test_bfelf_file_bind_jump_slot_success()
+{
+    auto ret = 0LL;
+    void *addr = nullptr;
+    void *expected = nullptr;
+    bfelf_file_t dummy_misc_ef;
+    bfelf_file_t dummy_code_ef;
+
+    ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &dummy_misc_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_file_init(m_dummy_code.get(), m_dummy_code_length, &dummy_code_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
+    m_dummy_code_exec = load_elf_file(&dummy_code_ef);
+
+    auto loader = std::make_unique<bfelf_loader_t>();
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    ret = bfelf_loader_add(loader.get(), &dummy_misc_ef, m_dummy_misc_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_loader_add(loader.get(), &dummy_code_ef, m_dummy_code_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_set_lazy(loader.get(), 0x1000);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_relocate(loader.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    for (auto i = 0U; i < dummy_misc_ef.num_jmprel; i++)
+    {
+        auto rela = &dummy_misc_ef.jmprel[i];
+        auto sym = &dummy_misc_ef.symtab[BFELF_REL_SYM(rela->r_info)];
+        auto str = dummy_misc_ef.file + dummy_misc_ef.strtab->sh_offset + sym->st_name;
+
+        if (strcmp(str, "_ZN7derived3fooEi") != 0)
+            continue;
+
+        e_string_t name = {str, strlen(str)};
+
+        ret = bfelf_loader_resolve_symbol(loader.get(), &name, &expected);
+        this->expect_true(ret == BFELF_SUCCESS);
+
+        ret = bfelf_file_bind_jump_slot(&dummy_misc_ef, i, &addr);
+        this->expect_true(ret == BFELF_SUCCESS);
+
+        this->expect_true(addr == expected);
+        this->expect_true(*reinterpret_cast<void **>(dummy_misc_ef.exec + rela->r_offset) == expected);
+    }
+
+    this->expect_true(loader->num_lazy_binds == 1);
+}
@@ -0,0 +1,231 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <test.h>
+
+typedef int (*func_t)(int);
+
+// The trampoline is defined with the lazy binding tests.
+
+extern "C" void test_lazy_trampoline();
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+// Compacts a copy of file, and releases the copy, so that any use of the
+// original ELF file after it was compacted reads garbage.
+
+static auto
+compact(bfelf_file_t &ef, const char *file, uint64_t length)
+{
+    auto copy = std::make_unique<char[]>(length);
+    memcpy(copy.get(), file, length);
+
+    if (bfelf_file_init(copy.get(), length, &ef) != BFELF_SUCCESS)
+        return std::unique_ptr<char[]>();
+
+    auto size = bfelf_file_compact_size(&ef);
+    if (size <= 0)
+        return std::unique_ptr<char[]>();
+
+    auto buf = std::make_unique<char[]>(static_cast<size_t>(size));
+
+    if (bfelf_file_compact(&ef, buf.get(), static_cast<bfelf64_xword>(size)) != BFELF_SUCCESS)
+        return std::unique_ptr<char[]>();
+
+    memset(copy.get(), 0xCC, length);
+    return buf;
+}
+
+// -----------------------------------------------------------------------------
+// Tests
+// -----------------------------------------------------------------------------
+
+void
+bfelf_loader_ut::test_bfelf_file_compact_size_invalid_ef()
+{
+    auto ret = bfelf_file_compact_size(nullptr);
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+}
+
+void
+bfelf_loader_ut::test_bfelf_file_compact_size_uninitialized()
+{
+    bfelf_file_t ef;
+    memset(&ef, 0, sizeof(ef));
+
+    auto ret = bfelf_file_compact_size(&ef);
+    this->expect_true(ret == BFELF_ERROR_OUT_OF_ORDER);
+}
+
+void
+bfelf_loader_ut::test_bfelf_file_compact_invalid_args()
+{
+    char buf[0x10];
+    bfelf_file_t ef;
+
+    auto ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_file_compact(nullptr, buf, sizeof(buf));
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+
+    ret = bfelf_file_compact(&ef, nullptr, sizeof(buf));
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+}
+
+void
+bfelf_loader_ut::test_bfelf_file_compact_buf_too_small()
+{
+    bfelf_file_t ef;
+
+    auto ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    auto size = bfelf_file_compact_size(&ef);
+    this->expect_true(size > 0);
+    this->expect_true(static_cast<uint64_t>(size) < m_dummy_misc_length);
+
+    auto buf = std::make_unique<char[]>(static_cast<size_t>(size));
+
+    ret = bfelf_file_compact(&ef, buf.get(), static_cast<bfelf64_xword>(size - 1));
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+    this->expect_true(ef.file == m_dummy_misc.get());
+}
+
+void
+bfelf_loader_ut::test_bfelf_file_compact_after_add()
+{
+    bfelf_file_t ef;
+    char buf[0x10];
+
+    auto ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    auto loader = std::make_unique<bfelf_loader_t>();
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    ret = bfelf_loader_add(loader.get(), &ef, nullptr);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_file_compact(&ef, buf, sizeof(buf));
+    this->expect_true(ret == BFELF_ERROR_OUT_OF_ORDER);
+}
+
+void
+bfelf_loader_ut::test_bfelf_file_compact_success()
+{
+    auto ret = 0LL;
+    bfelf_file_t dummy_misc_ef;
+    bfelf_file_t dummy_code_ef;
+
+    ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &dummy_misc_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_file_init(m_dummy_code.get(), m_dummy_code_length, &dummy_code_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
+    m_dummy_code_exec = load_elf_file(&dummy_code_ef);
+
+    auto misc = compact(dummy_misc_ef, m_dummy_misc.get(), m_dummy_misc_length);
+    auto code = compact(dummy_code_ef, m_dummy_code.get(), m_dummy_code_length);
+
+    this->expect_true(misc != nullptr);
+    this->expect_true(code != nullptr);
+    this->expect_true(dummy_misc_ef.file == misc.get());
+    this->expect_true(dummy_code_ef.file == code.get());
+    this->expect_true(dummy_misc_ef.fsize < m_dummy_misc_length);
+    this->expect_true(dummy_code_ef.fsize < m_dummy_code_length);
+
+    auto loader = std::make_unique<bfelf_loader_t>();
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    ret = bfelf_loader_add(loader.get(), &dummy_misc_ef, m_dummy_misc_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_loader_add(loader.get(), &dummy_code_ef, m_dummy_code_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_relocate(loader.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    section_info_t info;
+
+    ret = bfelf_loader_get_info(loader.get(), &dummy_misc_ef, &info);
+    this->expect_true(ret == BFELF_SUCCESS);
+    this->expect_true(info.eh_frame_addr != nullptr);
+
+    func_t func;
+    e_string_t name = {"foo", 3};
+
+    ret = bfelf_loader_resolve_symbol(loader.get(), &name, reinterpret_cast<void **>(&func));
+    this->expect_true(ret == BFELF_SUCCESS);
+    this->expect_true(func(5) == 1005);
+}
+
+void
+bfelf_loader_ut::test_bfelf_file_compact_lazy()
+{
+    auto ret = 0LL;
+    bfelf_file_t dummy_misc_ef;
+    bfelf_file_t dummy_code_ef;
+
+    ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &dummy_misc_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_file_init(m_dummy_code.get(), m_dummy_code_length, &dummy_code_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
+    m_dummy_code_exec = load_elf_file(&dummy_code_ef);
+
+    auto misc = compact(dummy_misc_ef, m_dummy_misc.get(), m_dummy_misc_length);
+    auto code = compact(dummy_code_ef, m_dummy_code.get(), m_dummy_code_length);
+
+    this->expect_true(misc != nullptr);
+    this->expect_true(code != nullptr);
+    this->expect_true(dummy_misc_ef.lazy == 1);
+
+    auto loader = std::make_unique<bfelf_loader_t>();
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    ret = bfelf_loader_add(loader.get(), &dummy_misc_ef, m_dummy_misc_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_loader_add(loader.get(), &dummy_code_ef, m_dummy_code_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_set_lazy(loader.get(), reinterpret_cast<bfelf64_addr>(test_lazy_trampoline));
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_relocate(loader.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+    this->expect_true(loader->num_lazy_slots != 0);
+
+    func_t func;
+    e_string_t name = {"foo", 3};
+
+    ret = bfelf_loader_resolve_symbol(loader.get(), &name, reinterpret_cast<void **>(&func));
+    this->expect_true(ret == BFELF_SUCCESS);
+    this->expect_true(func(5) == 1005);
+
+    ret = bfelf_loader_bind_all(loader.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+    this->expect_true(func(5) == 1005);
+}
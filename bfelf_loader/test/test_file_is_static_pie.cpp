@@ -0,0 +1,94 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <test.h>
+
+void
+bfelf_loader_ut::test_bfelf_file_is_static_pie_invalid_ef()
+{
+    auto ret = bfelf_file_is_static_pie(nullptr);
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+}
+
+void
+bfelf_loader_ut::test_bfelf_file_is_static_pie_shared_library()
+{
+    auto ret = 0LL;
+    bfelf_file_t ef;
+
+    ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_file_is_static_pie(&ef);
+    this->expect_true(ret == 0);
+}
+
+void
+bfelf_loader_ut::test_bfelf_file_is_static_pie_no_entry()
+{
+    auto ret = 0LL;
+    bfelf_file_t ef;
+    auto test = get_test();
+
+    test.header.e_entry = 0;
+    test.relatab.relas[0].r_info = BFR_X86_64_RELATIVE;
+    test.relatab.relas[1].r_info = BFR_X86_64_RELATIVE;
+
+    ret = bfelf_file_init(reinterpret_cast<char *>(&test), sizeof(test), &ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_file_is_static_pie(&ef);
+    this->expect_true(ret == 0);
+}
+
+void
+bfelf_loader_ut::test_bfelf_file_is_static_pie_symbol_relocation()
+{
+    auto ret = 0LL;
+    bfelf_file_t ef;
+    auto test = get_test();
+
+    test.relatab.relas[0].r_info = BFR_X86_64_RELATIVE;
+    test.relatab.relas[1].r_info = BFR_X86_64_GLOB_DAT;
+
+    ret = bfelf_file_init(reinterpret_cast<char *>(&test), sizeof(test), &ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_file_is_static_pie(&ef);
+    this->expect_true(ret == 0);
+}
+
+void
+bfelf_loader_ut::test_bfelf_file_is_static_pie_success()
+{
+    auto ret = 0LL;
+    bfelf_file_t ef;
+    auto test = get_test();
+
+    test.relatab.relas[0].r_info = BFR_X86_64_RELATIVE;
+    test.relatab.relas[1].r_info = BFR_X86_64_RELATIVE;
+
+    ret = bfelf_file_init(reinterpret_cast<char *>(&test), sizeof(test), &ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_file_is_static_pie(&ef);
+    this->expect_true(ret == 1);
+}
@@ -250,7 +250,9 @@ bfelf_loader_ut::test_bfelf_file_resolve_no_such_symbol_no_hash()
     this->expect_true(ret == BFELF_SUCCESS);
 
     dummy_misc_ef.hashtab = nullptr;
+    dummy_misc_ef.gnu_hashtab = nullptr;
     dummy_code_ef.hashtab = nullptr;
+    dummy_code_ef.gnu_hashtab = nullptr;
 
     m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
     m_dummy_code_exec = load_elf_file(&dummy_code_ef);
@@ -286,7 +288,9 @@ bfelf_loader_ut::test_bfelf_file_resolve_zero_length_symbol_no_hash()
     this->expect_true(ret == BFELF_SUCCESS);
 
     dummy_misc_ef.hashtab = nullptr;
+    dummy_misc_ef.gnu_hashtab = nullptr;
     dummy_code_ef.hashtab = nullptr;
+    dummy_code_ef.gnu_hashtab = nullptr;
 
     m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
     m_dummy_code_exec = load_elf_file(&dummy_code_ef);
@@ -322,7 +326,9 @@ bfelf_loader_ut::test_bfelf_file_resolve_invalid_symbol_length_no_hash()
     this->expect_true(ret == BFELF_SUCCESS);
 
     dummy_misc_ef.hashtab = nullptr;
+    dummy_misc_ef.gnu_hashtab = nullptr;
     dummy_code_ef.hashtab = nullptr;
+    dummy_code_ef.gnu_hashtab = nullptr;
 
     m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
     m_dummy_code_exec = load_elf_file(&dummy_code_ef);
@@ -358,7 +364,9 @@ bfelf_loader_ut::test_bfelf_file_resolve_symbol_length_too_large_no_hash()
     this->expect_true(ret == BFELF_SUCCESS);
 
     dummy_misc_ef.hashtab = nullptr;
+    dummy_misc_ef.gnu_hashtab = nullptr;
     dummy_code_ef.hashtab = nullptr;
+    dummy_code_ef.gnu_hashtab = nullptr;
 
     m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
     m_dummy_code_exec = load_elf_file(&dummy_code_ef);
@@ -394,7 +402,9 @@ bfelf_loader_ut::test_bfelf_file_resolve_symbol_success_no_hash()
     this->expect_true(ret == BFELF_SUCCESS);
 
     dummy_misc_ef.hashtab = nullptr;
+    dummy_misc_ef.gnu_hashtab = nullptr;
     dummy_code_ef.hashtab = nullptr;
+    dummy_code_ef.gnu_hashtab = nullptr;
 
     m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
     m_dummy_code_exec = load_elf_file(&dummy_code_ef);
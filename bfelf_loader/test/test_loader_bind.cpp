@@ -0,0 +1,401 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <test.h>
+
+#include <chrono>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+
+typedef int (*func_t)(int);
+
+// -----------------------------------------------------------------------------
+// Trampoline
+// -----------------------------------------------------------------------------
+
+// This is the same trampoline that the driver entry uses, so that calls
+// through a lazily bound PLT entry can be tested natively.
+
+extern "C" void test_lazy_trampoline();
+
+extern "C" uint64_t
+test_lazy_resolve(bfelf_file_t *ef, uint64_t index)
+{
+    void *addr = nullptr;
+
+    if (bfelf_file_bind_jump_slot(ef, index, &addr) != BFELF_SUCCESS)
+        return 0;
+
+    return reinterpret_cast<uint64_t>(addr);
+}
+
+asm(R"(
+    .text
+    .globl test_lazy_trampoline
+test_lazy_trampoline:
+    push %rax
+    push %rcx
+    push %rdx
+    push %rsi
+    push %rdi
+    push %r8
+    push %r9
+    push %r10
+    sub $8, %rsp
+    mov 0x48(%rsp), %rdi
+    mov 0x50(%rsp), %rsi
+    call test_lazy_resolve
+    mov %rax, %r11
+    add $8, %rsp
+    pop %r10
+    pop %r9
+    pop %r8
+    pop %rdi
+    pop %rsi
+    pop %rdx
+    pop %rcx
+    pop %rax
+    add $16, %rsp
+    jmp *%r11
+)");
+
+static auto
+trampoline()
+{ return reinterpret_cast<bfelf64_addr>(test_lazy_trampoline); }
+
+static auto
+jump_slot(const bfelf_file_t &ef, bfelf64_xword index)
+{ return *reinterpret_cast<bfelf64_addr *>(ef.exec + ef.jmprel[index].r_offset); }
+
+static auto
+exec_size(bfelf_file_t &ef)
+{
+    bfelf64_addr size = 0;
+
+    for (auto i = 0; i < bfelf_file_num_segments(&ef); i++)
+    {
+        bfelf_phdr *phdr = nullptr;
+
+        if (bfelf_file_get_segment(&ef, i, &phdr) == BFELF_SUCCESS)
+            size = std::max(size, phdr->p_vaddr + phdr->p_memsz);
+    }
+
+    return size;
+}
+
+static auto
+jump_slot_offset(bfelf_file_t &ef, bfelf64_xword index, const char *misc_exec, const char *code_exec)
+{
+    auto value = jump_slot(ef, index);
+    auto misc_base = reinterpret_cast<bfelf64_addr>(misc_exec);
+
+    if (value >= misc_base && value < misc_base + exec_size(ef))
+        return std::make_pair(0, value - misc_base);
+
+    return std::make_pair(1, value - reinterpret_cast<bfelf64_addr>(code_exec));
+}
+
+static auto
+jump_slot_pending(const bfelf_file_t &ef, bfelf64_xword index)
+{
+    auto value = jump_slot(ef, index);
+    auto exec = reinterpret_cast<bfelf64_addr>(ef.exec);
+
+    return value >= exec + ef.plt_start && value < exec + ef.plt_end;
+}
+
+// -----------------------------------------------------------------------------
+// Tests
+// -----------------------------------------------------------------------------
+
+void
+bfelf_loader_ut::test_bfelf_loader_set_lazy_invalid_loader()
+{
+    auto ret = bfelf_loader_set_lazy(nullptr, trampoline());
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+}
+
+void
+bfelf_loader_ut::test_bfelf_loader_set_lazy_after_relocate()
+{
+    auto ret = 0LL;
+    auto loader = std::make_unique<bfelf_loader_t>();
+
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    ret = bfelf_loader_relocate(loader.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_set_lazy(loader.get(), trampoline());
+    this->expect_true(ret == BFELF_ERROR_OUT_OF_ORDER);
+}
+
+void
+bfelf_loader_ut::test_bfelf_loader_bind_invalid_loader()
+{
+    e_string_t name = {"foo", 3};
+
+    auto ret = bfelf_loader_bind(nullptr, &name);
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+}
+
+void
+bfelf_loader_ut::test_bfelf_loader_bind_invalid_name()
+{
+    auto loader = std::make_unique<bfelf_loader_t>();
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    auto ret = bfelf_loader_bind(loader.get(), nullptr);
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+}
+
+void
+bfelf_loader_ut::test_bfelf_loader_bind_not_relocated()
+{
+    e_string_t name = {"foo", 3};
+    auto loader = std::make_unique<bfelf_loader_t>();
+
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    auto ret = bfelf_loader_bind(loader.get(), &name);
+    this->expect_true(ret == BFELF_ERROR_OUT_OF_ORDER);
+}
+
+void
+bfelf_loader_ut::test_bfelf_loader_bind_all_invalid_loader()
+{
+    auto ret = bfelf_loader_bind_all(nullptr);
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+}
+
+void
+bfelf_loader_ut::test_bfelf_loader_bind_all_not_relocated()
+{
+    auto loader = std::make_unique<bfelf_loader_t>();
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    auto ret = bfelf_loader_bind_all(loader.get());
+    this->expect_true(ret == BFELF_ERROR_OUT_OF_ORDER);
+}
+
+void
+bfelf_loader_ut::test_bfelf_loader_relocate_lazy()
+{
+    auto ret = 0LL;
+    bfelf_file_t dummy_misc_ef;
+    bfelf_file_t dummy_code_ef;
+
+    ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &dummy_misc_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_file_init(m_dummy_code.get(), m_dummy_code_length, &dummy_code_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    this->expect_true(dummy_misc_ef.lazy == 1);
+    this->expect_true(dummy_misc_ef.num_jmprel != 0);
+
+    m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
+    m_dummy_code_exec = load_elf_file(&dummy_code_ef);
+
+    auto loader = std::make_unique<bfelf_loader_t>();
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    ret = bfelf_loader_add(loader.get(), &dummy_misc_ef, m_dummy_misc_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_loader_add(loader.get(), &dummy_code_ef, m_dummy_code_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_set_lazy(loader.get(), trampoline());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_relocate(loader.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    auto got = reinterpret_cast<bfelf64_addr *>(dummy_misc_ef.exec + dummy_misc_ef.got_plt);
+    this->expect_true(got[1] == reinterpret_cast<bfelf64_addr>(&dummy_misc_ef));
+    this->expect_true(got[2] == trampoline());
+
+    this->expect_true(loader->num_lazy_slots != 0);
+    this->expect_true(loader->num_lazy_binds == 0);
+
+    for (auto i = 0U; i < dummy_misc_ef.num_jmprel; i++)
+        this->expect_true(jump_slot_pending(dummy_misc_ef, i));
+
+    // Calling foo calls the constructor, foo and the destructor of derived
+    // (which live in dummy_code) through dummy_misc's PLT, which binds
+    // their jump slots through the trampoline.
+
+    func_t func;
+    e_string_t name = {"foo", 3};
+
+    ret = bfelf_loader_resolve_symbol(loader.get(), &name, reinterpret_cast<void **>(&func));
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    this->expect_true(func(5) == 1005);
+    this->expect_true(func(5) == 1005);
+
+    auto binds = loader->num_lazy_binds;
+    this->expect_true(binds != 0);
+    this->expect_true(binds < loader->num_lazy_slots);
+
+    ret = bfelf_loader_bind_all(loader.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+    this->expect_true(loader->num_lazy_binds == loader->num_lazy_slots);
+
+    for (auto i = 0U; i < dummy_misc_ef.num_jmprel; i++)
+        this->expect_false(jump_slot_pending(dummy_misc_ef, i));
+
+    this->expect_true(func(5) == 1005);
+}
+
+void
+bfelf_loader_ut::test_bfelf_loader_relocate_lazy_matches_eager()
+{
+    auto ret = 0LL;
+    bfelf_file_t dummy_misc_ef;
+    bfelf_file_t dummy_code_ef;
+
+    ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &dummy_misc_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_file_init(m_dummy_code.get(), m_dummy_code_length, &dummy_code_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    auto eager_misc_exec = load_elf_file(&dummy_misc_ef);
+    auto eager_code_exec = load_elf_file(&dummy_code_ef);
+
+    auto eager = std::make_unique<bfelf_loader_t>();
+    memset(eager.get(), 0, sizeof(bfelf_loader_t));
+
+    ret = bfelf_loader_add(eager.get(), &dummy_misc_ef, eager_misc_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_loader_add(eager.get(), &dummy_code_ef, eager_code_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_relocate(eager.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    auto num_jmprel = dummy_misc_ef.num_jmprel;
+    auto expected = std::make_unique<std::pair<int, bfelf64_addr>[]>(num_jmprel);
+
+    for (auto i = 0U; i < num_jmprel; i++)
+        expected[i] = jump_slot_offset(dummy_misc_ef, i, eager_misc_exec.get(), eager_code_exec.get());
+
+    ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &dummy_misc_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_file_init(m_dummy_code.get(), m_dummy_code_length, &dummy_code_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
+    m_dummy_code_exec = load_elf_file(&dummy_code_ef);
+
+    auto lazy = std::make_unique<bfelf_loader_t>();
+    memset(lazy.get(), 0, sizeof(bfelf_loader_t));
+
+    ret = bfelf_loader_add(lazy.get(), &dummy_misc_ef, m_dummy_misc_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_loader_add(lazy.get(), &dummy_code_ef, m_dummy_code_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_set_lazy(lazy.get(), trampoline());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_relocate(lazy.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    // Relocating twice (e.g. a module cache partial hit) must not move the
+    // deferred jump slots.
+
+    lazy->relocated = 0;
+
+    ret = bfelf_loader_relocate(lazy.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    for (auto i = 0U; i < num_jmprel; i++)
+        this->expect_true(jump_slot_pending(dummy_misc_ef, i));
+
+    e_string_t name = {"_ZN7derived3fooEi", 17};
+
+    ret = bfelf_loader_bind(lazy.get(), &name);
+    this->expect_true(ret == BFELF_SUCCESS);
+    this->expect_true(lazy->num_lazy_binds == 1);
+
+    ret = bfelf_loader_bind_all(lazy.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    for (auto i = 0U; i < num_jmprel; i++)
+    {
+        auto offset = jump_slot_offset(dummy_misc_ef, i, m_dummy_misc_exec.get(), m_dummy_code_exec.get());
+        this->expect_true(offset == expected[i]);
+    }
+}
+
+void
+bfelf_loader_ut::benchmark_bfelf_loader_relocate_lazy()
+{
+    constexpr const auto iterations = 100;
+
+    auto ret = 0LL;
+    bfelf_file_t dummy_misc_ef;
+    bfelf_file_t dummy_code_ef;
+
+    ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &dummy_misc_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_file_init(m_dummy_code.get(), m_dummy_code_length, &dummy_code_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
+    m_dummy_code_exec = load_elf_file(&dummy_code_ef);
+
+    auto loader = std::make_unique<bfelf_loader_t>();
+
+    for (auto lazy : {false, true})
+    {
+        auto ns = 0LL;
+
+        for (auto i = 0; i < iterations; i++)
+        {
+            memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+            ret = bfelf_loader_add(loader.get(), &dummy_misc_ef, m_dummy_misc_exec.get());
+            this->expect_true(ret == BFELF_SUCCESS);
+            ret = bfelf_loader_add(loader.get(), &dummy_code_ef, m_dummy_code_exec.get());
+            this->expect_true(ret == BFELF_SUCCESS);
+
+            if (lazy)
+            {
+                ret = bfelf_loader_set_lazy(loader.get(), trampoline());
+                this->expect_true(ret == BFELF_SUCCESS);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            ret = bfelf_loader_relocate(loader.get());
+            auto end = std::chrono::steady_clock::now();
+
+            this->expect_true(ret == BFELF_SUCCESS);
+            ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        }
+
+        std::cout << "relocate (" << (lazy ? "lazy" : "eager") << ") "
+                  << loader->num_relocations << " relocations, "
+                  << loader->num_lazy_slots << " deferred: "
+                  << ns / iterations << " ns" << std::endl;
+    }
+}
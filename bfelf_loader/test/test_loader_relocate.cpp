@@ -21,6 +21,9 @@
 
 #include <test.h>
 
+#include <chrono>
+#include <iostream>
+
 void
 bfelf_loader_ut::test_bfelf_loader_relocate_invalid_loader()
 {
@@ -84,3 +87,202 @@ bfelf_loader_ut::test_bfelf_loader_relocate_twice()
     ret = bfelf_loader_relocate(&loader);
     this->expect_true(ret == BFELF_SUCCESS);
 }
+
+void
+bfelf_loader_ut::test_bfelf_loader_relocate_symbol_index()
+{
+    auto ret = 0LL;
+    bfelf_file_t dummy_misc_ef;
+    bfelf_file_t dummy_code_ef;
+
+    ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &dummy_misc_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_file_init(m_dummy_code.get(), m_dummy_code_length, &dummy_code_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
+    m_dummy_code_exec = load_elf_file(&dummy_code_ef);
+
+    auto loader = std::make_unique<bfelf_loader_t>();
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    ret = bfelf_loader_add(loader.get(), &dummy_misc_ef, m_dummy_misc_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_loader_add(loader.get(), &dummy_code_ef, m_dummy_code_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    auto size = bfelf_loader_symbol_index_size(loader.get());
+    this->expect_true(size > 0);
+
+    auto num = static_cast<std::size_t>(size) / sizeof(bfelf_symbol_index_t);
+    auto symbols = std::make_unique<bfelf_symbol_index_t[]>(num);
+
+    this->expect_true(num * 3 / 4 >= dummy_misc_ef.symnum + dummy_code_ef.symnum);
+
+    ret = bfelf_loader_set_symbol_index(loader.get(), symbols.get(), static_cast<bfelf64_xword>(size));
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_relocate(loader.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    this->expect_true(loader->indexed == 1);
+    this->expect_true(loader->num_symbols != 0);
+    this->expect_true(loader->num_global_lookups != 0);
+    this->expect_true(loader->num_index_misses == 0);
+}
+
+void
+bfelf_loader_ut::test_bfelf_loader_relocate_symbol_index_too_small()
+{
+    auto ret = 0LL;
+    bfelf_file_t dummy_misc_ef;
+    bfelf_file_t dummy_code_ef;
+    bfelf_symbol_index_t symbols[4];
+
+    ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &dummy_misc_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_file_init(m_dummy_code.get(), m_dummy_code_length, &dummy_code_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
+    m_dummy_code_exec = load_elf_file(&dummy_code_ef);
+
+    auto loader = std::make_unique<bfelf_loader_t>();
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    ret = bfelf_loader_add(loader.get(), &dummy_misc_ef, m_dummy_misc_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_loader_add(loader.get(), &dummy_code_ef, m_dummy_code_exec.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_set_symbol_index(loader.get(), static_cast<bfelf_symbol_index_t *>(symbols), sizeof(symbols));
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_relocate(loader.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    this->expect_true(loader->indexed == 0);
+    this->expect_true(loader->num_global_lookups != 0);
+}
+
+void
+bfelf_loader_ut::test_bfelf_loader_symbol_index_size_invalid_loader()
+{
+    auto ret = bfelf_loader_symbol_index_size(nullptr);
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+}
+
+void
+bfelf_loader_ut::test_bfelf_loader_set_symbol_index_invalid_args()
+{
+    bfelf_symbol_index_t symbols[4];
+
+    auto loader = std::make_unique<bfelf_loader_t>();
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    auto ret = bfelf_loader_set_symbol_index(nullptr, static_cast<bfelf_symbol_index_t *>(symbols), sizeof(symbols));
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+    ret = bfelf_loader_set_symbol_index(loader.get(), nullptr, sizeof(symbols));
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+    ret = bfelf_loader_set_symbol_index(loader.get(), static_cast<bfelf_symbol_index_t *>(symbols), sizeof(symbols) - 1);
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+    ret = bfelf_loader_set_symbol_index(loader.get(), static_cast<bfelf_symbol_index_t *>(symbols), 0);
+    this->expect_true(ret == BFELF_ERROR_INVALID_ARG);
+
+    ret = bfelf_loader_relocate(loader.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_set_symbol_index(loader.get(), static_cast<bfelf_symbol_index_t *>(symbols), sizeof(symbols));
+    this->expect_true(ret == BFELF_ERROR_OUT_OF_ORDER);
+}
+
+void
+bfelf_loader_ut::test_bfelf_loader_relocate_static_pie()
+{
+    auto ret = 0LL;
+    bfelf_file_t ef;
+    auto test = get_test();
+    auto exec = std::make_unique<bfelf64_addr[]>(4);
+    auto base = reinterpret_cast<bfelf64_addr>(exec.get());
+
+    test.relatab.relas[0].r_info = BFR_X86_64_RELATIVE;
+    test.relatab.relas[0].r_offset = 0x8;
+    test.relatab.relas[0].r_addend = 0x100;
+    test.relatab.relas[1].r_info = BFR_X86_64_RELATIVE;
+    test.relatab.relas[1].r_offset = 0x18;
+    test.relatab.relas[1].r_addend = 0x200;
+
+    ret = bfelf_file_init(reinterpret_cast<char *>(&test), sizeof(test), &ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    auto loader = std::make_unique<bfelf_loader_t>();
+    memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+    ret = bfelf_loader_add(loader.get(), &ef, reinterpret_cast<char *>(exec.get()));
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    ret = bfelf_loader_relocate(loader.get());
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    this->expect_true(exec[0] == 0);
+    this->expect_true(exec[1] == base + 0x100);
+    this->expect_true(exec[2] == 0);
+    this->expect_true(exec[3] == base + 0x200);
+
+    this->expect_true(loader->indexed == 0);
+    this->expect_true(loader->num_relocations == 2 * ef.num_rela);
+    this->expect_true(loader->num_global_lookups == 0);
+}
+
+void
+bfelf_loader_ut::benchmark_bfelf_loader_relocate()
+{
+    constexpr const auto iterations = 100;
+
+    auto ret = 0LL;
+    bfelf_file_t dummy_misc_ef;
+    bfelf_file_t dummy_code_ef;
+
+    ret = bfelf_file_init(m_dummy_misc.get(), m_dummy_misc_length, &dummy_misc_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+    ret = bfelf_file_init(m_dummy_code.get(), m_dummy_code_length, &dummy_code_ef);
+    this->expect_true(ret == BFELF_SUCCESS);
+
+    m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
+    m_dummy_code_exec = load_elf_file(&dummy_code_ef);
+
+    auto loader = std::make_unique<bfelf_loader_t>();
+    auto symbols = std::unique_ptr<bfelf_symbol_index_t[]>();
+
+    auto ns = 0LL;
+
+    for (auto i = 0; i < iterations; i++)
+    {
+        memset(loader.get(), 0, sizeof(bfelf_loader_t));
+
+        ret = bfelf_loader_add(loader.get(), &dummy_misc_ef, m_dummy_misc_exec.get());
+        this->expect_true(ret == BFELF_SUCCESS);
+        ret = bfelf_loader_add(loader.get(), &dummy_code_ef, m_dummy_code_exec.get());
+        this->expect_true(ret == BFELF_SUCCESS);
+
+        auto size = bfelf_loader_symbol_index_size(loader.get());
+        this->expect_true(size > 0);
+
+        if (!symbols)
+            symbols = std::make_unique<bfelf_symbol_index_t[]>(static_cast<std::size_t>(size) / sizeof(bfelf_symbol_index_t));
+
+        ret = bfelf_loader_set_symbol_index(loader.get(), symbols.get(), static_cast<bfelf64_xword>(size));
+        this->expect_true(ret == BFELF_SUCCESS);
+
+        auto start = std::chrono::steady_clock::now();
+        ret = bfelf_loader_relocate(loader.get());
+        auto end = std::chrono::steady_clock::now();
+
+        this->expect_true(ret == BFELF_SUCCESS);
+        ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    }
+
+    std::cout << "relocate " << loader->num_relocations << " relocations, "
+              << loader->num_global_lookups << " global lookups: "
+              << ns / iterations << " ns" << std::endl;
+}
@@ -311,7 +311,9 @@ bfelf_loader_ut::test_bfelf_loader_resolve_no_such_symbol_no_hash()
     this->expect_true(ret == BFELF_SUCCESS);
 
     dummy_misc_ef.hashtab = nullptr;
+    dummy_misc_ef.gnu_hashtab = nullptr;
     dummy_code_ef.hashtab = nullptr;
+    dummy_code_ef.gnu_hashtab = nullptr;
 
     m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
     m_dummy_code_exec = load_elf_file(&dummy_code_ef);
@@ -347,7 +349,9 @@ bfelf_loader_ut::test_bfelf_loader_resolve_zero_length_symbol_no_hash()
     this->expect_true(ret == BFELF_SUCCESS);
 
     dummy_misc_ef.hashtab = nullptr;
+    dummy_misc_ef.gnu_hashtab = nullptr;
     dummy_code_ef.hashtab = nullptr;
+    dummy_code_ef.gnu_hashtab = nullptr;
 
     m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
     m_dummy_code_exec = load_elf_file(&dummy_code_ef);
@@ -383,7 +387,9 @@ bfelf_loader_ut::test_bfelf_loader_resolve_invalid_symbol_length_no_hash()
     this->expect_true(ret == BFELF_SUCCESS);
 
     dummy_misc_ef.hashtab = nullptr;
+    dummy_misc_ef.gnu_hashtab = nullptr;
     dummy_code_ef.hashtab = nullptr;
+    dummy_code_ef.gnu_hashtab = nullptr;
 
     m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
     m_dummy_code_exec = load_elf_file(&dummy_code_ef);
@@ -419,7 +425,9 @@ bfelf_loader_ut::test_bfelf_loader_resolve_symbol_length_too_large_no_hash()
     this->expect_true(ret == BFELF_SUCCESS);
 
     dummy_misc_ef.hashtab = nullptr;
+    dummy_misc_ef.gnu_hashtab = nullptr;
     dummy_code_ef.hashtab = nullptr;
+    dummy_code_ef.gnu_hashtab = nullptr;
 
     m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
     m_dummy_code_exec = load_elf_file(&dummy_code_ef);
@@ -455,7 +463,9 @@ bfelf_loader_ut::test_bfelf_loader_resolve_symbol_success_no_hash()
     this->expect_true(ret == BFELF_SUCCESS);
 
     dummy_misc_ef.hashtab = nullptr;
+    dummy_misc_ef.gnu_hashtab = nullptr;
     dummy_code_ef.hashtab = nullptr;
+    dummy_code_ef.gnu_hashtab = nullptr;
 
     m_dummy_misc_exec = load_elf_file(&dummy_misc_ef);
     m_dummy_code_exec = load_elf_file(&dummy_code_ef);
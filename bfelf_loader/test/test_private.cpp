@@ -63,6 +63,23 @@ extern "C"
 
     unsigned long
     private_hash(const char *name);
+
+    bfelf64_word
+    private_gnu_hash(struct e_string_t *name);
+
+    int64_t
+    private_symbol_by_name(struct bfelf_file_t *ef,
+                           struct e_string_t *name,
+                           struct bfelf_sym **sym);
+
+    int64_t
+    private_symbol_global(struct bfelf_loader_t *loader,
+                          struct e_string_t *name,
+                          struct bfelf_file_t **ef_found,
+                          struct bfelf_sym **sym);
+
+    int64_t
+    private_symbol_index_build(struct bfelf_loader_t *loader);
 }
 
 // -----------------------------------------------------------------------------
@@ -336,3 +353,115 @@ bfelf_loader_ut::test_private_hash()
 
     this->expect_true(private_hash(static_cast<const char *>(name)) != 0);
 }
+
+void
+bfelf_loader_ut::test_private_symbol_by_gnu_hash()
+{
+    const char file[] = "\0foo\0bar";
+
+    bfelf_file_t ef = {};
+    bfelf_shdr strtab = {};
+    bfelf_shdr gnu_hashtab = {};
+    bfelf_sym *sym = nullptr;
+    bfelf_sym symtab[3] = {};
+    bfelf64_xword bloom[1] = {};
+    bfelf64_word bucket[1] = {1};
+    bfelf64_word chain[2] = {};
+
+    e_string_t foo = {"foo", 3};
+    e_string_t bar = {"bar", 3};
+    e_string_t baz = {"baz", 3};
+
+    for (auto hash : {private_gnu_hash(&foo), private_gnu_hash(&bar)})
+        gsl::at(bloom, 0) |= (1ULL << (hash % 64)) | (1ULL << ((hash >> 6) % 64));
+
+    gsl::at(chain, 0) = private_gnu_hash(&foo) & ~1U;
+    gsl::at(chain, 1) = private_gnu_hash(&bar) | 1U;
+
+    gsl::at(symtab, 1).st_name = 1;
+    gsl::at(symtab, 2).st_name = 5;
+
+    ef.file = static_cast<const char *>(file);
+    ef.strtab = &strtab;
+    ef.symtab = static_cast<bfelf_sym *>(symtab);
+    ef.symnum = 3;
+
+    strtab.sh_size = sizeof(file);
+    strtab.sh_offset = 0;
+
+    ef.gnu_hashtab = &gnu_hashtab;
+    ef.gnu_nbucket = 1;
+    ef.gnu_symoffset = 1;
+    ef.gnu_bloom_size = 1;
+    ef.gnu_bloom_shift = 6;
+    ef.gnu_bloom = static_cast<bfelf64_xword *>(bloom);
+    ef.gnu_bucket = static_cast<bfelf64_word *>(bucket);
+    ef.gnu_chain = static_cast<bfelf64_word *>(chain);
+
+    this->expect_true(private_symbol_by_name(&ef, &foo, &sym) == BFELF_SUCCESS);
+    this->expect_true(sym == &gsl::at(symtab, 1));
+    this->expect_true(private_symbol_by_name(&ef, &bar, &sym) == BFELF_SUCCESS);
+    this->expect_true(sym == &gsl::at(symtab, 2));
+    this->expect_true(private_symbol_by_name(&ef, &baz, &sym) == BFELF_ERROR_NO_SUCH_SYMBOL);
+}
+
+void
+bfelf_loader_ut::test_private_symbol_index_weak_precedence()
+{
+    const char file[] = "\0foo";
+
+    bfelf_file_t ef1 = {};
+    bfelf_file_t ef2 = {};
+    bfelf_shdr strtab = {};
+    bfelf_sym symtab1[2] = {};
+    bfelf_sym symtab2[2] = {};
+    bfelf_sym *sym = nullptr;
+    bfelf_file_t *ef_found = nullptr;
+    e_string_t foo = {"foo", 3};
+
+    strtab.sh_size = sizeof(file);
+    strtab.sh_offset = 0;
+
+    gsl::at(symtab1, 1).st_name = 1;
+    gsl::at(symtab1, 1).st_value = 0x10;
+    gsl::at(symtab1, 1).st_info = bfstb_weak << 4;
+
+    gsl::at(symtab2, 1).st_name = 1;
+    gsl::at(symtab2, 1).st_value = 0x20;
+    gsl::at(symtab2, 1).st_info = bfstb_global << 4;
+
+    for (auto ef : {&ef1, &ef2})
+    {
+        ef->file = static_cast<const char *>(file);
+        ef->strtab = &strtab;
+        ef->symnum = 2;
+    }
+
+    ef1.symtab = static_cast<bfelf_sym *>(symtab1);
+    ef2.symtab = static_cast<bfelf_sym *>(symtab2);
+
+    auto loader = std::make_unique<bfelf_loader_t>();
+
+    this->expect_true(bfelf_loader_add(loader.get(), &ef1, nullptr) == BFELF_SUCCESS);
+    this->expect_true(bfelf_loader_add(loader.get(), &ef2, nullptr) == BFELF_SUCCESS);
+
+    auto size = bfelf_loader_symbol_index_size(loader.get());
+    auto symbols = std::make_unique<bfelf_symbol_index_t[]>(static_cast<std::size_t>(size) / sizeof(bfelf_symbol_index_t));
+
+    this->expect_true(bfelf_loader_set_symbol_index(loader.get(), symbols.get(), static_cast<bfelf64_xword>(size)) == BFELF_SUCCESS);
+    this->expect_true(private_symbol_index_build(loader.get()) == BFELF_SUCCESS);
+    this->expect_true(loader->indexed == 1);
+    this->expect_true(loader->num_symbols == 1);
+
+    this->expect_true(private_symbol_global(loader.get(), &foo, &ef_found, &sym) == BFELF_SUCCESS);
+    this->expect_true(ef_found == &ef2);
+    this->expect_true(sym == &gsl::at(symtab2, 1));
+    this->expect_true(loader->num_index_misses == 0);
+
+    ef_found = &ef2;
+
+    this->expect_true(private_symbol_global(loader.get(), &foo, &ef_found, &sym) == BFELF_SUCCESS);
+    this->expect_true(ef_found == &ef1);
+    this->expect_true(sym == &gsl::at(symtab1, 1));
+    this->expect_true(loader->num_index_misses == 1);
+}
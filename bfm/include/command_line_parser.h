@@ -39,7 +39,8 @@ enum type
     stop = 5,
     dump = 6,
     status = 7,
-    vmcall = 8
+    vmcall = 8,
+    invalidate = 9
 };
 }
 
@@ -150,7 +151,7 @@ public:
     /// @expects none
     /// @ensures none
     ///
-    /// @return input filename for "data" vmcall
+    /// @return input filename for "data" and "batch" vmcalls
     ///
     virtual const filename_type &ifile() const noexcept;
 
@@ -163,6 +164,26 @@ public:
     ///
     virtual const filename_type &ofile() const noexcept;
 
+    /// Iterations
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return number of times a "bench" vmcall should be repeated, or the
+    ///     number of passes of a "dirty stream" vmcall, 0 otherwise
+    ///
+    virtual uint64_t iterations() const noexcept;
+
+    /// Interval
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return number of milliseconds to wait between the passes of a
+    ///     "dirty stream" vmcall
+    ///
+    virtual uint64_t interval() const noexcept;
+
 private:
 
     void reset() noexcept;
@@ -174,16 +195,24 @@ private:
     void parse_dump(arg_list_type &args);
     void parse_status(arg_list_type &args);
     void parse_vmcall(arg_list_type &args);
+    void parse_invalidate(arg_list_type &args);
 
     void parse_vmcall_version(arg_list_type &args);
     void parse_vmcall_registers(arg_list_type &args);
     void parse_vmcall_string(arg_list_type &args);
     void parse_vmcall_data(arg_list_type &args);
     void parse_vmcall_event(arg_list_type &args);
+    void parse_vmcall_profile(arg_list_type &args);
+    void parse_vmcall_heap(arg_list_type &args);
+    void parse_vmcall_locks(arg_list_type &args);
+    void parse_vmcall_dirty(arg_list_type &args);
+    void parse_vmcall_batch(arg_list_type &args);
+    void parse_vmcall_bench(arg_list_type &args);
     void parse_vmcall_unittest(arg_list_type &args);
 
     void parse_vmcall_string_unformatted(arg_list_type &args);
     void parse_vmcall_string_json(arg_list_type &args);
+    void parse_vmcall_string_msgpack(arg_list_type &args);
 
     void parse_vmcall_data_unformatted(arg_list_type &args);
 
@@ -197,6 +226,8 @@ private:
     filename_type m_ifile;
     filename_type m_ofile;
     arg_type m_string_data;
+    uint64_t m_iterations;
+    uint64_t m_interval;
 };
 
 #endif
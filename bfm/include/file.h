@@ -22,6 +22,7 @@
 #ifndef FILE_H
 #define FILE_H
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -40,6 +41,67 @@ public:
     using binary_data = std::vector<char>;
     using filename_type = std::string;
 
+    /// Mapped Data
+    ///
+    /// A read-only view of the contents of a file that was mapped into
+    /// memory using map_binary. The file stays mapped until the last copy
+    /// of the view is destroyed.
+    ///
+    class mapped_data
+    {
+    public:
+
+        using mapping_type = std::shared_ptr<const void>;
+
+        /// Default Constructor
+        ///
+        /// @expects none
+        /// @ensures none
+        ///
+        mapped_data() noexcept = default;
+
+        /// Constructor
+        ///
+        /// @expects none
+        /// @ensures none
+        ///
+        /// @param data the start of the view
+        /// @param size the size of the view in bytes
+        /// @param mapping keeps the memory that backs the view alive
+        ///
+        mapped_data(const char *data, std::size_t size, mapping_type mapping = nullptr) noexcept :
+            m_data(data),
+            m_size(size),
+            m_mapping(std::move(mapping))
+        { }
+
+        /// Data
+        ///
+        /// @expects none
+        /// @ensures none
+        ///
+        /// @return the start of the view
+        ///
+        const char *data() const noexcept
+        { return m_data; }
+
+        /// Size
+        ///
+        /// @expects none
+        /// @ensures none
+        ///
+        /// @return the size of the view in bytes
+        ///
+        std::size_t size() const noexcept
+        { return m_size; }
+
+    private:
+
+        const char *m_data{nullptr};
+        std::size_t m_size{0};
+        mapping_type m_mapping;
+    };
+
     /// File Constructor
     ///
     /// @expects none
@@ -80,6 +142,21 @@ public:
     ///
     virtual binary_data read_binary(const filename_type &filename) const;
 
+    /// Map
+    ///
+    /// Maps the entire contents of a file into memory, read-only. Unlike
+    /// read_binary, the contents are not copied, and are only paged in from
+    /// the page cache when they are accessed. The returned view is empty
+    /// if the file is empty.
+    ///
+    /// @expects filename.empty() == false
+    /// @ensures none
+    ///
+    /// @param filename name of the file to map.
+    /// @return a view of the contents of filename
+    ///
+    virtual mapped_data map_binary(const filename_type &filename) const;
+
     /// Write
     ///
     /// Writes text data to the file provided
@@ -105,6 +182,20 @@ public:
     /// @param data data to write
     ///
     virtual void write_binary(const filename_type &filename, const binary_data &data) const;
+
+    /// Append
+    ///
+    /// Appends binary data to the file provided, creating the file if it
+    /// does not exist
+    ///
+    /// @expects filename.empty() == false
+    /// @expects data.empty() == false
+    /// @ensures none
+    ///
+    /// @param filename name of the file to append to.
+    /// @param data data to append
+    ///
+    virtual void append_binary(const filename_type &filename, const binary_data &data) const;
 };
 
 #endif
@@ -50,6 +50,8 @@ class ioctl
 public:
 
     using binary_data = file::binary_data;
+    using mapped_data = file::mapped_data;
+    using module_list = std::vector<mapped_data>;
     using drr_type = debug_ring_resources_t;
     using drr_pointer = drr_type *;
     using cpuid_type = uint64_t;
@@ -93,6 +95,21 @@ public:
     ///
     virtual void call_ioctl_add_module(const binary_data &module_data);
 
+    /// Add Modules
+    ///
+    /// Adds each of the provided modules to the driver entry, in order.
+    /// Where the driver entry supports it, all of the modules are handed to
+    /// the driver entry with a single IOCTL, and read directly from the
+    /// memory they are mapped to.
+    ///
+    /// @param modules ELF files to be added to the driver entry
+    ///
+    /// @expects modules.size() <= MAX_NUM_MODULES
+    /// @expects each module's size > 0
+    /// @ensures none
+    ///
+    virtual void call_ioctl_add_modules(const module_list &modules);
+
     /// Load VMM
     ///
     /// Loads the VMM
@@ -164,6 +181,16 @@ public:
     ///
     virtual void call_ioctl_vmcall(gsl::not_null<registers_pointer> regs, cpuid_type cpuid);
 
+    /// Invalidate Cache
+    ///
+    /// Releases the relocated modules that the driver entry keeps after the
+    /// VMM is unloaded, forcing the next load to relocate them again.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    virtual void call_ioctl_invalidate_cache();
+
 private:
 
     std::unique_ptr<ioctl_private_base> m_d;
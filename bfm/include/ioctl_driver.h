@@ -84,6 +84,7 @@ private:
     void stop_vmm();
     void dump_vmm();
     void vmm_status();
+    void invalidate_cache();
     void vmcall();
 
     void vmcall_send_regs(registers_type &regs);
@@ -91,8 +92,19 @@ private:
     void vmcall_registers(registers_type &regs);
     void vmcall_data(registers_type &regs);
     void vmcall_data_string(registers_type &regs);
+    void vmcall_data_bench(registers_type &regs);
     void vmcall_data_binary(registers_type &regs);
     void vmcall_event(registers_type &regs);
+    void vmcall_profile(registers_type &regs);
+    void vmcall_profile_collect(registers_type &regs);
+    void vmcall_heap(registers_type &regs);
+    void vmcall_heap_collect(registers_type &regs);
+    void vmcall_heap_pools(registers_type &regs);
+    void vmcall_locks(registers_type &regs);
+    void vmcall_locks_collect(registers_type &regs);
+    void vmcall_dirty(registers_type &regs);
+    void vmcall_dirty_stream(registers_type &regs);
+    void vmcall_batch(registers_type &regs);
     void vmcall_unittest(registers_type &regs);
 
     status_type get_status() const;
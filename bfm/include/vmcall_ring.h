@@ -0,0 +1,155 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#ifndef VMCALL_RING_H
+#define VMCALL_RING_H
+
+#include <memory>
+#include <functional>
+
+#include <ioctl.h>
+#include <vmcall_interface.h>
+
+/// VMCall Ring
+///
+/// Provides a client for the ring vmcall. Instead of sending one vmcall per
+/// request, requests are placed in a submission queue that is shared with
+/// the VMM, and are executed all at once when the doorbell is rung. The
+/// results are placed in a completion queue, which can be reaped at any
+/// time.
+///
+/// The ring is registered with the VMM on construction, and unregistered on
+/// destruction. Since the ring is per-vCPU, all of the vmcalls made by this
+/// class are sent to the CPU provided on construction. Also note that the
+/// VMM maps the ring's memory until the ring is unregistered, so the ring
+/// is allocated in its own page aligned, locked pages, and a vmcall_ring
+/// should not be kept around longer than is needed.
+///
+class vmcall_ring
+{
+public:
+
+    using id_type = uint64_t;
+    using ret_type = int64_t;
+    using size_type = std::size_t;
+    using flags_type = uint64_t;
+    using cpuid_type = ioctl::cpuid_type;
+    using registers_type = ioctl::registers_type;
+    using completion_handler = std::function<void(id_type id, ret_type ret, const registers_type &regs)>;
+    using ring_pointer = std::unique_ptr<vmcall_ring_t, void(*)(vmcall_ring_t *)>;
+
+    /// Constructor
+    ///
+    /// Registers the ring with the VMM.
+    ///
+    /// @expects ctl != nullptr
+    /// @ensures none
+    ///
+    /// @param ctl ioctl class used to communicate with the driver entry
+    /// @param cpuid the CPU that the ring is registered with
+    /// @param flags vmcall_ring_flags provided to the VMM
+    ///
+    vmcall_ring(gsl::not_null<ioctl *> ctl, cpuid_type cpuid, flags_type flags = VMCALL_RING_FLAG_NONE);
+
+    /// Destructor
+    ///
+    /// Unregisters the ring with the VMM. Any requests that have not been
+    /// completed are lost.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~vmcall_ring();
+
+    /// Submit
+    ///
+    /// Places a request in the submission queue. The request is not
+    /// executed until the doorbell is rung (or the VMM polls the ring).
+    /// Note that r01 is ignored by the VMM.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param id user defined id that is returned with the completion
+    /// @param regs the registers for the request
+    /// @return true if the request was queued, false if the submission
+    ///     queue, or the completion queue is full (i.e. the doorbell
+    ///     should be rung, and / or completions should be reaped)
+    ///
+    bool submit(id_type id, const registers_type &regs) noexcept;
+
+    /// Doorbell
+    ///
+    /// Tells the VMM to execute all of the queued requests. If the
+    /// completion queue fills up, the remaining requests stay queued.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of requests that were executed
+    ///
+    size_type doorbell();
+
+    /// Reap
+    ///
+    /// Removes all of the completions from the completion queue, and calls
+    /// the provided handler for each one.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param handler called for each completion
+    /// @return the number of completions that were removed
+    ///
+    size_type reap(const completion_handler &handler);
+
+    /// Pending
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of requests that have been submitted, but that
+    ///     have not been reaped yet
+    ///
+    size_type pending() const noexcept;
+
+private:
+
+    void send(registers_type &regs);
+
+private:
+
+    gsl::not_null<ioctl *> m_ioctl;
+    cpuid_type m_cpuid;
+
+    ring_pointer m_ring;
+
+public:
+
+    vmcall_ring(vmcall_ring &&) = delete;
+    vmcall_ring &operator=(vmcall_ring &&) = delete;
+
+    vmcall_ring(const vmcall_ring &) = delete;
+    vmcall_ring &operator=(const vmcall_ring &) = delete;
+};
+
+#endif
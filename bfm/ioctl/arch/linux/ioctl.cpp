@@ -20,7 +20,9 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
 
 #include <ioctl.h>
+#include <exception.h>
 #include <ioctl_private.h>
+#include <driver_entry_interface.h>
 
 ioctl::ioctl() :
     m_d {std::make_unique<ioctl_private>()}
@@ -43,6 +45,26 @@ ioctl::call_ioctl_add_module(const binary_data &module_data)
     }
 }
 
+void
+ioctl::call_ioctl_add_modules(const module_list &modules)
+{
+    expects(modules.size() <= MAX_NUM_MODULES);
+
+    auto &&list = module_list_t{};
+
+    for (const auto &module : modules)
+    {
+        expects(module.size() > 0);
+
+        list.modules[list.num_modules].addr = reinterpret_cast<uint64_t>(module.data());
+        list.modules[list.num_modules].size = module.size();
+        list.num_modules++;
+    }
+
+    if (auto d = dynamic_cast<ioctl_private *>(m_d.get()))
+        d->call_ioctl_add_modules(&list);
+}
+
 void
 ioctl::call_ioctl_load_vmm()
 {
@@ -91,3 +113,10 @@ ioctl::call_ioctl_vmcall(gsl::not_null<registers_pointer> regs, cpuid_type cpuid
     if (auto d = dynamic_cast<ioctl_private *>(m_d.get()))
         d->call_ioctl_vmcall(regs, cpuid);
 }
+
+void
+ioctl::call_ioctl_invalidate_cache()
+{
+    if (auto d = dynamic_cast<ioctl_private *>(m_d.get()))
+        d->call_ioctl_invalidate_cache();
+}
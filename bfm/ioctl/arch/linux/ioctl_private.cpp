@@ -93,6 +93,13 @@ ioctl_private::call_ioctl_add_module(gsl::not_null<module_data_type> data)
         throw ioctl_failed(IOCTL_ADD_MODULE);
 }
 
+void
+ioctl_private::call_ioctl_add_modules(gsl::not_null<module_list_pointer> list)
+{
+    if (bf_write_ioctl(fd, IOCTL_ADD_MODULES, list) < 0)
+        throw ioctl_failed(IOCTL_ADD_MODULES);
+}
+
 void
 ioctl_private::call_ioctl_load_vmm()
 {
@@ -147,3 +154,10 @@ ioctl_private::call_ioctl_vmcall(gsl::not_null<registers_pointer> regs, cpuid_ty
     if (bf_write_ioctl(fd, IOCTL_VMCALL, regs) < 0)
         throw ioctl_failed(IOCTL_VMCALL);
 }
+
+void
+ioctl_private::call_ioctl_invalidate_cache()
+{
+    if (bf_send_ioctl(fd, IOCTL_INVALIDATE_CACHE) < 0)
+        throw ioctl_failed(IOCTL_INVALIDATE_CACHE);
+}
@@ -23,6 +23,7 @@
 #define IOCTL_PRIVATE_H
 
 #include <ioctl.h>
+#include <driver_entry_interface.h>
 
 class ioctl_private : public ioctl_private_base
 {
@@ -30,6 +31,7 @@ public:
 
     using module_len_type = size_t;
     using module_data_type = const char *;
+    using module_list_pointer = const module_list_t *;
     using drr_pointer = ioctl::drr_pointer;
     using cpuid_type = ioctl::cpuid_type;
     using vcpuid_type = ioctl::vcpuid_type;
@@ -43,6 +45,7 @@ public:
     virtual void open();
     virtual void call_ioctl_add_module_length(module_len_type len);
     virtual void call_ioctl_add_module(gsl::not_null<module_data_type> data);
+    virtual void call_ioctl_add_modules(gsl::not_null<module_list_pointer> list);
     virtual void call_ioctl_load_vmm();
     virtual void call_ioctl_unload_vmm();
     virtual void call_ioctl_start_vmm();
@@ -50,6 +53,7 @@ public:
     virtual void call_ioctl_dump_vmm(gsl::not_null<drr_pointer> drr, vcpuid_type vcpuid);
     virtual void call_ioctl_vmm_status(gsl::not_null<status_pointer> status);
     virtual void call_ioctl_vmcall(gsl::not_null<registers_pointer> regs, cpuid_type cpuid);
+    virtual void call_ioctl_invalidate_cache();
 
 private:
 
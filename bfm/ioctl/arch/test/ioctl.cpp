@@ -73,6 +73,10 @@ void
 ioctl::call_ioctl_add_module(const binary_data &module_data)
 { (void) module_data; }
 
+void
+ioctl::call_ioctl_add_modules(const module_list &modules)
+{ (void) modules; }
+
 void
 ioctl::call_ioctl_load_vmm()
 { }
@@ -100,3 +104,7 @@ ioctl::call_ioctl_vmm_status(gsl::not_null<status_pointer> status)
 void
 ioctl::call_ioctl_vmcall(gsl::not_null<registers_pointer> regs, cpuid_type cpuid)
 { (void) regs; (void) cpuid; }
+
+void
+ioctl::call_ioctl_invalidate_cache()
+{ }
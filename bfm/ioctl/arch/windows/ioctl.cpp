@@ -20,6 +20,8 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
 
 #include <ioctl.h>
+#include <constants.h>
+#include <exception.h>
 #include <ioctl_private.h>
 
 ioctl::ioctl() :
@@ -40,6 +42,21 @@ ioctl::call_ioctl_add_module(const binary_data &module_data)
         d->call_ioctl_add_module(module_data.data(), module_data.size());
 }
 
+void
+ioctl::call_ioctl_add_modules(const module_list &modules)
+{
+    expects(modules.size() <= MAX_NUM_MODULES);
+
+    if (auto d = dynamic_cast<ioctl_private *>(m_d.get()))
+    {
+        for (const auto &module : modules)
+        {
+            expects(module.size() > 0);
+            d->call_ioctl_add_module(module.data(), module.size());
+        }
+    }
+}
+
 void
 ioctl::call_ioctl_load_vmm()
 {
@@ -88,3 +105,10 @@ ioctl::call_ioctl_vmcall(gsl::not_null<registers_pointer> regs, cpuid_type cpuid
     if (auto d = dynamic_cast<ioctl_private *>(m_d.get()))
         d->call_ioctl_vmcall(regs, cpuid);
 }
+
+void
+ioctl::call_ioctl_invalidate_cache()
+{
+    if (auto d = dynamic_cast<ioctl_private *>(m_d.get()))
+        d->call_ioctl_invalidate_cache();
+}
@@ -209,4 +209,11 @@ ioctl_private::call_ioctl_vmcall(gsl::not_null<registers_pointer> regs, cpuid_ty
         throw ioctl_failed(IOCTL_VMCALL);
 }
 
+void
+ioctl_private::call_ioctl_invalidate_cache()
+{
+    if (bf_send_ioctl(fd, IOCTL_INVALIDATE_CACHE) == BF_IOCTL_FAILURE)
+        throw ioctl_failed(IOCTL_INVALIDATE_CACHE);
+}
+
 #pragma GCC diagnostic pop
@@ -50,6 +50,7 @@ public:
     virtual void call_ioctl_dump_vmm(gsl::not_null<drr_pointer> drr, vcpuid_type vcpuid);
     virtual void call_ioctl_vmm_status(gsl::not_null<status_pointer> status);
     virtual void call_ioctl_vmcall(gsl::not_null<registers_pointer> regs, cpuid_type cpuid);
+    virtual void call_ioctl_invalidate_cache();
 
 private:
     HANDLE fd;
@@ -75,12 +75,19 @@ help()
     std::cout << "  or:  bfm [OPTION]... stop..." << std::endl;
     std::cout << "  or:  bfm [OPTION]... dump..." << std::endl;
     std::cout << "  or:  bfm [OPTION]... status..." << std::endl;
+    std::cout << "  or:  bfm [OPTION]... invalidate..." << std::endl;
     std::cout << "  or:  bfm [OPTION]... vmcall versions index..." << std::endl;
     std::cout << "  or:  bfm [OPTION]... vmcall registers r2 r3...r15" << std::endl;
     std::cout << "  or:  bfm [OPTION]... vmcall string type \"\"..." << std::endl;
     std::cout << "  or:  bfm [OPTION]... vmcall data type ifile ofile..." << std::endl;
     std::cout << "  or:  bfm [OPTION]... vmcall unittest index..." << std::endl;
     std::cout << "  or:  bfm [OPTION]... vmcall event index..." << std::endl;
+    std::cout << "  or:  bfm [OPTION]... vmcall profile command [period]..." << std::endl;
+    std::cout << "  or:  bfm [OPTION]... vmcall heap command..." << std::endl;
+    std::cout << "  or:  bfm [OPTION]... vmcall locks command..." << std::endl;
+    std::cout << "  or:  bfm [OPTION]... vmcall dirty command [args]..." << std::endl;
+    std::cout << "  or:  bfm [OPTION]... vmcall batch ifile..." << std::endl;
+    std::cout << "  or:  bfm [OPTION]... vmcall bench iterations type \"\"..." << std::endl;
     std::cout << "Controls or queries the bareflank hypervisor" << std::endl;
     std::cout << std::endl;
     std::cout << "       -h, --help      show this help menu" << std::endl;
@@ -90,13 +97,39 @@ help()
     std::cout << " vmcall string types:" << std::endl;
     std::cout << "       unformatted     unformatted string" << std::endl;
     std::cout << "       json            json formatted string" << std::endl;
+    std::cout << "       msgpack         json formatted string, sent as msgpack" << std::endl;
     std::cout << std::endl;
     std::cout << " vmcall binary types:" << std::endl;
     std::cout << "       unformatted     unformatted binary data" << std::endl;
     std::cout << std::endl;
+    std::cout << " vmcall profile commands:" << std::endl;
+    std::cout << "       start period    start sampling the guest (period in hex)" << std::endl;
+    std::cout << "       stop            stop sampling the guest" << std::endl;
+    std::cout << "       collect         drain and print the sample histogram" << std::endl;
+    std::cout << std::endl;
+    std::cout << " vmcall heap commands:" << std::endl;
+    std::cout << "       start           start tracking VMM heap allocations" << std::endl;
+    std::cout << "       stop            stop tracking VMM heap allocations" << std::endl;
+    std::cout << "       collect         print the call sites holding the most memory" << std::endl;
+    std::cout << "       pools           print the usage and occupancy of each pool" << std::endl;
+    std::cout << std::endl;
+    std::cout << " vmcall locks commands:" << std::endl;
+    std::cout << "       collect         print the contention statistics of each lock" << std::endl;
+    std::cout << "       reset           clear the contention statistics of each lock" << std::endl;
+    std::cout << std::endl;
+    std::cout << " vmcall dirty commands:" << std::endl;
+    std::cout << "       start gpa size  track writes to [gpa, gpa + size) on --cpuid" << std::endl;
+    std::cout << "       stop            stop tracking writes" << std::endl;
+    std::cout << "       stream ofile [passes] [interval]" << std::endl;
+    std::cout << "                       harvest the dirty bitmap passes times (default 1)," << std::endl;
+    std::cout << "                       interval ms apart, appending each bitmap to ofile" << std::endl;
+    std::cout << std::endl;
     std::cout << " vmcall notes:" << std::endl;
     std::cout << "       - registers are represented in hex" << std::endl;
     std::cout << "       - data / string uuids equal 0" << std::endl;
+    std::cout << "       - batch files contain one request per line: r0 r2 r3...r15" << std::endl;
+    std::cout << "       - bench iterations are in decimal, and type is a string type" << std::endl;
+    std::cout << "       - dirty gpa / size are in hex and 4k aligned, passes / interval in decimal" << std::endl;
 }
 
 int
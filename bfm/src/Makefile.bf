@@ -61,6 +61,7 @@ NATIVE_OUTDIR+=%BUILD_REL%/../bin
 SOURCES+=command_line_parser.cpp
 SOURCES+=file.cpp
 SOURCES+=ioctl_driver.cpp
+SOURCES+=vmcall_ring.cpp
 SOURCES+=%HYPER_ABS%/src/debug_ring_interface.c
 
 INCLUDE_PATHS+=./
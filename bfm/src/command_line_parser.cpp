@@ -22,6 +22,7 @@
 #include <gsl/gsl>
 
 #include <json.h>
+#include <msgpack.h>
 #include <exception.h>
 #include <vmcall_interface.h>
 #include <command_line_parser.h>
@@ -90,6 +91,7 @@ command_line_parser::parse(const arg_list_type &args)
     if (cmd == "dump") return parse_dump(filtered_args);
     if (cmd == "status") return parse_status(filtered_args);
     if (cmd == "vmcall") return parse_vmcall(filtered_args);
+    if (cmd == "invalidate") return parse_invalidate(filtered_args);
 
     throw unknown_command(cmd);
 }
@@ -122,6 +124,14 @@ const command_line_parser::filename_type &
 command_line_parser::ofile() const noexcept
 { return m_ofile;}
 
+uint64_t
+command_line_parser::iterations() const noexcept
+{ return m_iterations; }
+
+uint64_t
+command_line_parser::interval() const noexcept
+{ return m_interval; }
+
 void
 command_line_parser::reset() noexcept
 {
@@ -133,6 +143,8 @@ command_line_parser::reset() noexcept
     m_ifile.clear();
     m_ofile.clear();
     m_string_data.clear();
+    m_iterations = 0;
+    m_interval = 0;
 }
 
 void
@@ -180,6 +192,13 @@ command_line_parser::parse_status(arg_list_type &args)
     m_cmd = command_type::status;
 }
 
+void
+command_line_parser::parse_invalidate(arg_list_type &args)
+{
+    (void) args;
+    m_cmd = command_type::invalidate;
+}
+
 void
 command_line_parser::parse_vmcall(arg_list_type &args)
 {
@@ -193,6 +212,12 @@ command_line_parser::parse_vmcall(arg_list_type &args)
     if (opcode == "string") return parse_vmcall_string(args);
     if (opcode == "data") return parse_vmcall_data(args);
     if (opcode == "event") return parse_vmcall_event(args);
+    if (opcode == "profile") return parse_vmcall_profile(args);
+    if (opcode == "heap") return parse_vmcall_heap(args);
+    if (opcode == "locks") return parse_vmcall_locks(args);
+    if (opcode == "dirty") return parse_vmcall_dirty(args);
+    if (opcode == "batch") return parse_vmcall_batch(args);
+    if (opcode == "bench") return parse_vmcall_bench(args);
     if (opcode == "unittest") return parse_vmcall_unittest(args);
 
     throw unknown_vmcall_type(opcode);
@@ -268,6 +293,7 @@ command_line_parser::parse_vmcall_string(arg_list_type &args)
 
     if (type == "unformatted") return parse_vmcall_string_unformatted(args);
     if (type == "json") return parse_vmcall_string_json(args);
+    if (type == "msgpack") return parse_vmcall_string_msgpack(args);
 
     throw unknown_vmcall_string_type(type);
 }
@@ -297,6 +323,162 @@ command_line_parser::parse_vmcall_event(arg_list_type &args)
     m_cmd = command_type::vmcall;
 }
 
+void
+command_line_parser::parse_vmcall_profile(arg_list_type &args)
+{
+    if (args.empty())
+        throw missing_argument();
+
+    auto command = bfn::take(args, 0);
+
+    m_registers.r00 = VMCALL_PROFILE;
+    m_registers.r01 = VMCALL_MAGIC_NUMBER;
+
+    if (command == "start")
+    {
+        if (args.empty())
+            throw missing_argument();
+
+        m_registers.r02 = VMCALL_PROFILE_START;
+        m_registers.r03 = std::stoull(args[0], nullptr, 16);
+    }
+    else if (command == "stop")
+    {
+        m_registers.r02 = VMCALL_PROFILE_STOP;
+    }
+    else if (command == "collect")
+    {
+        m_registers.r02 = VMCALL_PROFILE_COLLECT;
+    }
+    else
+    {
+        throw unknown_vmcall_profile_command(command);
+    }
+
+    m_cmd = command_type::vmcall;
+}
+
+void
+command_line_parser::parse_vmcall_heap(arg_list_type &args)
+{
+    if (args.empty())
+        throw missing_argument();
+
+    auto command = bfn::take(args, 0);
+
+    m_registers.r00 = VMCALL_HEAP;
+    m_registers.r01 = VMCALL_MAGIC_NUMBER;
+
+    if (command == "start")
+        m_registers.r02 = VMCALL_HEAP_START;
+    else if (command == "stop")
+        m_registers.r02 = VMCALL_HEAP_STOP;
+    else if (command == "collect")
+        m_registers.r02 = VMCALL_HEAP_COLLECT;
+    else if (command == "pools")
+        m_registers.r02 = VMCALL_HEAP_POOLS;
+    else
+        throw unknown_vmcall_heap_command(command);
+
+    m_cmd = command_type::vmcall;
+}
+
+void
+command_line_parser::parse_vmcall_locks(arg_list_type &args)
+{
+    if (args.empty())
+        throw missing_argument();
+
+    auto command = bfn::take(args, 0);
+
+    m_registers.r00 = VMCALL_LOCKS;
+    m_registers.r01 = VMCALL_MAGIC_NUMBER;
+
+    if (command == "collect")
+        m_registers.r02 = VMCALL_LOCKS_COLLECT;
+    else if (command == "reset")
+        m_registers.r02 = VMCALL_LOCKS_RESET;
+    else
+        throw unknown_vmcall_locks_command(command);
+
+    m_cmd = command_type::vmcall;
+}
+
+void
+command_line_parser::parse_vmcall_dirty(arg_list_type &args)
+{
+    if (args.empty())
+        throw missing_argument();
+
+    auto command = bfn::take(args, 0);
+
+    m_registers.r00 = VMCALL_DIRTY_LOG;
+    m_registers.r01 = VMCALL_MAGIC_NUMBER;
+
+    if (command == "start")
+    {
+        if (args.size() < 2)
+            throw missing_argument();
+
+        m_registers.r02 = VMCALL_DIRTY_LOG_START;
+        m_registers.r03 = std::stoull(args[0], nullptr, 16);
+        m_registers.r04 = std::stoull(args[1], nullptr, 16);
+    }
+    else if (command == "stop")
+    {
+        m_registers.r02 = VMCALL_DIRTY_LOG_STOP;
+    }
+    else if (command == "stream")
+    {
+        if (args.empty())
+            throw missing_argument();
+
+        auto &&passes = args.size() > 1 ? std::stoull(args[1], nullptr, 10) : 1;
+        if (passes == 0)
+            throw std::out_of_range("dirty stream passes must be non-zero");
+
+        m_registers.r02 = VMCALL_DIRTY_LOG_HARVEST;
+
+        m_ofile = args[0];
+        m_iterations = passes;
+        m_interval = args.size() > 2 ? std::stoull(args[2], nullptr, 10) : 0;
+    }
+    else
+    {
+        throw unknown_vmcall_dirty_command(command);
+    }
+
+    m_cmd = command_type::vmcall;
+}
+
+void
+command_line_parser::parse_vmcall_batch(arg_list_type &args)
+{
+    if (args.empty())
+        throw missing_argument();
+
+    m_registers.r00 = VMCALL_RING;
+    m_registers.r01 = VMCALL_MAGIC_NUMBER;
+
+    m_ifile = args[0];
+
+    m_cmd = command_type::vmcall;
+}
+
+void
+command_line_parser::parse_vmcall_bench(arg_list_type &args)
+{
+    if (args.empty())
+        throw missing_argument();
+
+    auto &&iterations = std::stoull(bfn::take(args, 0), nullptr, 10);
+    if (iterations == 0)
+        throw std::out_of_range("bench iterations must be non-zero");
+
+    parse_vmcall_string(args);
+    m_iterations = iterations;
+}
+
 void
 command_line_parser::parse_vmcall_unittest(arg_list_type &args)
 {
@@ -348,6 +530,25 @@ command_line_parser::parse_vmcall_string_json(arg_list_type &args)
     m_cmd = command_type::vmcall;
 }
 
+void
+command_line_parser::parse_vmcall_string_msgpack(arg_list_type &args)
+{
+    if (args.empty())
+        throw missing_argument();
+
+    m_string_data = bfn::msgpack::dump(json::parse(args[0]));
+
+    m_registers.r00 = VMCALL_DATA;
+    m_registers.r01 = VMCALL_MAGIC_NUMBER;
+    m_registers.r02 = 0;
+    m_registers.r03 = 0;
+    m_registers.r04 = VMCALL_DATA_BINARY_MSGPACK;
+    m_registers.r05 = reinterpret_cast<decltype(m_registers.r05)>(m_string_data.data());
+    m_registers.r06 = m_string_data.length();
+
+    m_cmd = command_type::vmcall;
+}
+
 void
 command_line_parser::parse_vmcall_data_unformatted(arg_list_type &args)
 {
@@ -26,6 +26,11 @@
 #include <file.h>
 #include <exception.h>
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 file::text_data
 file::read_text(const filename_type &filename) const
 {
@@ -43,13 +48,53 @@ file::read_binary(const filename_type &filename) const
 {
     expects(!filename.empty());
 
-    if (auto && handle = std::fstream(filename, std::ios_base::in | std::ios_base::binary))
-        return binary_data(std::istreambuf_iterator<char>(handle),
-                           std::istreambuf_iterator<char>());
+    if (auto && handle = std::fstream(filename, std::ios_base::in | std::ios_base::binary | std::ios_base::ate))
+    {
+        auto &&size = handle.tellg();
+
+        if (size < 0)
+            throw invalid_file(filename);
+
+        auto &&data = binary_data(static_cast<binary_data::size_type>(size));
+
+        handle.seekg(0);
+        if (handle.read(data.data(), size))
+            return data;
+    }
 
     throw invalid_file(filename);
 }
 
+file::mapped_data
+file::map_binary(const filename_type &filename) const
+{
+    expects(!filename.empty());
+
+    auto &&fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw invalid_file(filename);
+
+    auto ___ = gsl::finally([&]
+    { ::close(fd); });
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        throw invalid_file(filename);
+
+    auto &&size = static_cast<std::size_t>(st.st_size);
+    if (size == 0)
+        return {};
+
+    auto &&addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
+        throw invalid_file(filename);
+
+    auto &&mapping = mapped_data::mapping_type(addr, [size](const void * p)
+    { ::munmap(const_cast<void *>(p), size); });
+
+    return mapped_data(static_cast<const char *>(addr), size, mapping);
+}
+
 void
 file::write_text(const filename_type &filename, const text_data &data) const
 {
@@ -79,3 +124,18 @@ file::write_binary(const filename_type &filename, const binary_data &data) const
 
     throw invalid_file(filename);
 }
+
+void
+file::append_binary(const filename_type &filename, const binary_data &data) const
+{
+    expects(!filename.empty());
+    expects(!data.empty());
+
+    if (auto && handle = std::fstream(filename, std::ios_base::out | std::ios_base::app | std::ios_base::binary))
+    {
+        std::copy(data.begin(), data.end(), std::ostreambuf_iterator<char>(handle));
+        return;
+    }
+
+    throw invalid_file(filename);
+}
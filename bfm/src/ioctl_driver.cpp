@@ -21,10 +21,24 @@
 
 #include <gsl/gsl>
 
+#include <map>
+#include <array>
+#include <tuple>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <iomanip>
+#include <algorithm>
+
 #include <json.h>
+#include <msgpack.h>
 #include <debug.h>
+#include <memory.h>
 #include <exception.h>
 #include <ioctl_driver.h>
+#include <vmcall_ring.h>
 #include <vmcall_interface.h>
 #include <driver_entry_interface.h>
 
@@ -64,6 +78,9 @@ ioctl_driver::process()
 
         case command_line_parser::command_type::vmcall:
             return this->vmcall();
+
+        case command_line_parser::command_type::invalidate:
+            return this->invalidate_cache();
     }
 }
 
@@ -84,9 +101,12 @@ ioctl_driver::load_vmm()
     auto ___ = gsl::on_failure([&]
     { unload_vmm(); });
 
+    auto &&module_list = ioctl::module_list{};
+
     for (const auto &module : modules["modules"])
-        m_ioctl->call_ioctl_add_module(m_file->read_binary(module));
+        module_list.push_back(m_file->map_binary(module));
 
+    m_ioctl->call_ioctl_add_modules(module_list);
     m_ioctl->call_ioctl_load_vmm();
 }
 
@@ -169,6 +189,21 @@ ioctl_driver::vmm_status()
     }
 }
 
+void
+ioctl_driver::invalidate_cache()
+{
+    switch (get_status())
+    {
+        case VMM_RUNNING: break;
+        case VMM_LOADED: break;
+        case VMM_UNLOADED: break;
+        case VMM_CORRUPT: throw corrupt_vmm();
+        default: throw unknown_status();
+    }
+
+    m_ioctl->call_ioctl_invalidate_cache();
+}
+
 void
 ioctl_driver::vmcall()
 {
@@ -201,6 +236,26 @@ ioctl_driver::vmcall()
             this->vmcall_event(regs);
             break;
 
+        case VMCALL_PROFILE:
+            this->vmcall_profile(regs);
+            break;
+
+        case VMCALL_HEAP:
+            this->vmcall_heap(regs);
+            break;
+
+        case VMCALL_LOCKS:
+            this->vmcall_locks(regs);
+            break;
+
+        case VMCALL_DIRTY_LOG:
+            this->vmcall_dirty(regs);
+            break;
+
+        case VMCALL_RING:
+            this->vmcall_batch(regs);
+            break;
+
         case VMCALL_UNITTEST:
             this->vmcall_unittest(regs);
             break;
@@ -271,10 +326,14 @@ ioctl_driver::vmcall_registers(registers_type &regs)
 void
 ioctl_driver::vmcall_data(registers_type &regs)
 {
+    if (m_clp->iterations() != 0)
+        return this->vmcall_data_bench(regs);
+
     switch (regs.r04)
     {
         case VMCALL_DATA_STRING_UNFORMATTED:
         case VMCALL_DATA_STRING_JSON:
+        case VMCALL_DATA_BINARY_MSGPACK:
             this->vmcall_data_string(regs);
             break;
 
@@ -315,11 +374,46 @@ ioctl_driver::vmcall_data_string(registers_type &regs)
             std::cout << "received from vmm: " << std::string(obuffer.get(), regs.r09) << '\n';
             break;
 
+        case VMCALL_DATA_BINARY_MSGPACK:
+
+            if (regs.r09 >= VMCALL_OUT_BUFFER_SIZE)
+                throw std::out_of_range("return output buffer size out of range");
+
+            std::cout << "received from vmm: \n" << bfn::msgpack::parse(gsl::make_span(obuffer.get(), static_cast<std::ptrdiff_t>(regs.r09))).dump(4) << '\n';
+            break;
+
         default:
             break;
     }
 }
 
+void
+ioctl_driver::vmcall_data_bench(registers_type &regs)
+{
+    auto &&obuffer = std::make_unique<char[]>(VMCALL_OUT_BUFFER_SIZE);
+    auto &&iterations = m_clp->iterations();
+
+    auto &&start = std::chrono::steady_clock::now();
+
+    for (auto i = 0ULL; i < iterations; i++)
+    {
+        auto cregs = regs;
+
+        cregs.r08 = reinterpret_cast<decltype(cregs.r08)>(obuffer.get());
+        cregs.r09 = VMCALL_OUT_BUFFER_SIZE;
+
+        vmcall_send_regs(cregs);
+    }
+
+    auto &&elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    auto &&total = static_cast<uint64_t>(elapsed.count());
+
+    std::cout << "iterations: " << iterations << '\n';
+    std::cout << "request size: " << regs.r06 << " bytes\n";
+    std::cout << "total time: " << total << " ns\n";
+    std::cout << "time per vmcall: " << total / iterations << " ns\n";
+}
+
 void
 ioctl_driver::vmcall_data_binary(registers_type &regs)
 {
@@ -355,6 +449,361 @@ ioctl_driver::vmcall_event(registers_type &regs)
     std::cout << "success" << std::endl;
 }
 
+void
+ioctl_driver::vmcall_profile(registers_type &regs)
+{
+    if (regs.r02 == VMCALL_PROFILE_COLLECT)
+        return this->vmcall_profile_collect(regs);
+
+    vmcall_send_regs(regs);
+    std::cout << "success" << std::endl;
+}
+
+void
+ioctl_driver::vmcall_profile_collect(registers_type &regs)
+{
+    using key_type = std::tuple<uint64_t, uint64_t, uint64_t>;
+
+    constexpr const auto max_samples = VMCALL_OUT_BUFFER_SIZE / sizeof(vmcall_profile_sample_t);
+
+    auto &&obuffer = std::make_unique<vmcall_profile_sample_t[]>(max_samples);
+    auto &&histogram = std::map<key_type, uint64_t>();
+
+    auto total = 0ULL;
+    auto dropped = 0ULL;
+
+    // Samples are removed from the VMM's buffer as they are collected, so
+    // keep draining until the VMM reports that nothing is left. Samples
+    // that are taken while we drain are picked up by the next vmcall.
+
+    while (true)
+    {
+        auto cregs = regs;
+        cregs.r08 = reinterpret_cast<decltype(cregs.r08)>(obuffer.get());
+        cregs.r09 = max_samples * sizeof(vmcall_profile_sample_t);
+
+        vmcall_send_regs(cregs);
+
+        if (cregs.r03 > max_samples)
+            throw std::out_of_range("returned number of samples out of range");
+
+        for (auto i = 0ULL; i < cregs.r03; i++)
+        {
+            const auto &sample = obuffer[i];
+            histogram[key_type(sample.cr3, sample.cpl, sample.rip)]++;
+        }
+
+        total += cregs.r03;
+        dropped = cregs.r05;
+
+        if (cregs.r03 == 0 || cregs.r04 == 0)
+            break;
+    }
+
+    auto &&sorted = std::vector<std::pair<key_type, uint64_t>>(histogram.begin(), histogram.end());
+    std::stable_sort(sorted.begin(), sorted.end(), [](const auto & a, const auto & b)
+    { return a.second > b.second; });
+
+    std::cout << "samples: " << total << ", dropped: " << dropped << '\n';
+
+    if (total == 0)
+        return;
+
+    std::cout << std::setw(12) << "count" << std::setw(9) << "%" << "  cpl  "
+              << std::setw(18) << std::left << "cr3" << "  rip" << std::right << '\n';
+
+    for (const auto &entry : sorted)
+    {
+        auto percent = (static_cast<double>(entry.second) * 100.0) / static_cast<double>(total);
+
+        std::cout << std::setw(12) << entry.second << std::setw(9) << std::fixed
+                  << std::setprecision(2) << percent << "  " << std::setw(3)
+                  << std::get<1>(entry.first) << "  " << view_as_pointer(std::get<0>(entry.first))
+                  << "  " << view_as_pointer(std::get<2>(entry.first)) << '\n';
+    }
+}
+
+void
+ioctl_driver::vmcall_heap(registers_type &regs)
+{
+    if (regs.r02 == VMCALL_HEAP_COLLECT)
+        return this->vmcall_heap_collect(regs);
+
+    if (regs.r02 == VMCALL_HEAP_POOLS)
+        return this->vmcall_heap_pools(regs);
+
+    vmcall_send_regs(regs);
+    std::cout << "success" << std::endl;
+}
+
+void
+ioctl_driver::vmcall_heap_collect(registers_type &regs)
+{
+    constexpr const auto max_sites = VMCALL_OUT_BUFFER_SIZE / sizeof(vmcall_heap_site_t);
+
+    auto &&obuffer = std::make_unique<vmcall_heap_site_t[]>(max_sites);
+
+    regs.r08 = reinterpret_cast<decltype(regs.r08)>(obuffer.get());
+    regs.r09 = max_sites * sizeof(vmcall_heap_site_t);
+
+    vmcall_send_regs(regs);
+
+    if (regs.r03 > max_sites)
+        throw std::out_of_range("returned number of call sites out of range");
+
+    std::cout << "allocations: " << regs.r04 << ", dropped: " << regs.r05 << '\n';
+
+    if (regs.r03 == 0)
+        return;
+
+    std::cout << std::setw(12) << "bytes" << std::setw(10) << "count" << "  "
+              << std::setw(18) << std::left << "cpus" << "  caller" << std::right << '\n';
+
+    for (auto i = 0ULL; i < regs.r03; i++)
+    {
+        const auto &site = obuffer[i];
+
+        std::cout << std::setw(12) << site.bytes << std::setw(10) << site.count << "  "
+                  << view_as_pointer(site.cpus) << "  " << view_as_pointer(site.caller) << '\n';
+    }
+}
+
+void
+ioctl_driver::vmcall_heap_pools(registers_type &regs)
+{
+    constexpr const auto max_pools = VMCALL_OUT_BUFFER_SIZE / sizeof(vmcall_heap_pool_t);
+    constexpr const auto occupancy = " .:-=+*#%@";
+
+    auto &&obuffer = std::make_unique<vmcall_heap_pool_t[]>(max_pools);
+
+    regs.r08 = reinterpret_cast<decltype(regs.r08)>(obuffer.get());
+    regs.r09 = max_pools * sizeof(vmcall_heap_pool_t);
+
+    vmcall_send_regs(regs);
+
+    if (regs.r03 > max_pools)
+        throw std::out_of_range("returned number of pools out of range");
+
+    std::cout << std::left << std::setw(9) << "type" << std::setw(20) << "addr" << std::right
+              << std::setw(12) << "size" << std::setw(12) << "used" << std::setw(12) << "peak"
+              << std::setw(14) << "largest free" << std::setw(8) << "ranges" << '\n';
+
+    for (auto i = 0ULL; i < regs.r03; i++)
+    {
+        const auto &pool = obuffer[i];
+        auto type = "unknown";
+
+        switch (pool.type)
+        {
+            case MEMORY_CHUNK_HEAP: type = "heap"; break;
+            case MEMORY_CHUNK_PAGE: type = "page"; break;
+            case MEMORY_CHUNK_RESERVE: type = "reserve"; break;
+            case MEMORY_CHUNK_MAP: type = "map"; break;
+            default: break;
+        }
+
+        std::cout << std::left << std::setw(9) << type << std::setw(20) << view_as_pointer(pool.addr) << std::right
+                  << std::setw(12) << pool.size << std::setw(12) << pool.used << std::setw(12) << pool.peak
+                  << std::setw(14) << pool.largest_free << std::setw(8) << pool.free_ranges << '\n';
+
+        if (pool.type == MEMORY_CHUNK_RESERVE)
+            continue;
+
+        std::cout << "         [";
+        for (auto percent : pool.map)
+            std::cout << occupancy[percent == 0 ? 0 : 1 + (std::min<uint64_t>(percent, 100) * 8) / 100];
+        std::cout << "]\n";
+    }
+
+    if (regs.r04 > regs.r03)
+        std::cout << regs.r04 - regs.r03 << " more pools not shown" << '\n';
+}
+
+void
+ioctl_driver::vmcall_locks(registers_type &regs)
+{
+    if (regs.r02 == VMCALL_LOCKS_COLLECT)
+        return this->vmcall_locks_collect(regs);
+
+    vmcall_send_regs(regs);
+    std::cout << "success" << std::endl;
+}
+
+void
+ioctl_driver::vmcall_locks_collect(registers_type &regs)
+{
+    constexpr const auto max_locks = VMCALL_OUT_BUFFER_SIZE / sizeof(vmcall_lock_stats_t);
+
+    auto &&obuffer = std::make_unique<vmcall_lock_stats_t[]>(max_locks);
+
+    regs.r08 = reinterpret_cast<decltype(regs.r08)>(obuffer.get());
+    regs.r09 = max_locks * sizeof(vmcall_lock_stats_t);
+
+    vmcall_send_regs(regs);
+
+    if (regs.r03 > max_locks)
+        throw std::out_of_range("returned number of locks out of range");
+
+    std::cout << std::left << std::setw(24) << "name" << std::setw(10) << "type" << std::right
+              << std::setw(14) << "acquisitions" << std::setw(12) << "contended"
+              << std::setw(14) << "spins" << std::setw(14) << "max hold" << '\n';
+
+    for (auto i = 0ULL; i < regs.r03; i++)
+    {
+        const auto &lock = obuffer[i];
+        auto type = "unknown";
+
+        switch (lock.type)
+        {
+            case VMCALL_LOCK_SPINLOCK: type = "spinlock"; break;
+            case VMCALL_LOCK_TICKET: type = "ticket"; break;
+            case VMCALL_LOCK_MCS: type = "mcs"; break;
+            case VMCALL_LOCK_RW: type = "rw"; break;
+            default: break;
+        }
+
+        auto &&name = std::string(lock.name, strnlen(lock.name, VMCALL_LOCK_NAME_SIZE));
+
+        std::cout << std::left << std::setw(24) << name << std::setw(10) << type << std::right
+                  << std::setw(14) << lock.acquisitions << std::setw(12) << lock.contended
+                  << std::setw(14) << lock.spins << std::setw(14) << lock.max_hold << '\n';
+    }
+
+    if (regs.r04 > regs.r03)
+        std::cout << regs.r04 - regs.r03 << " more locks not shown" << '\n';
+}
+
+void
+ioctl_driver::vmcall_dirty(registers_type &regs)
+{
+    if (regs.r02 == VMCALL_DIRTY_LOG_HARVEST)
+        return this->vmcall_dirty_stream(regs);
+
+    vmcall_send_regs(regs);
+    std::cout << "success" << std::endl;
+}
+
+void
+ioctl_driver::vmcall_dirty_stream(registers_type &regs)
+{
+    constexpr const auto max_words = VMCALL_OUT_BUFFER_SIZE / sizeof(uint64_t);
+    constexpr const auto pages_per_word = 64ULL;
+
+    auto &&obuffer = std::make_unique<uint64_t[]>(max_words);
+    auto &&passes = m_clp->iterations();
+
+    for (auto pass = 0ULL; pass < passes; pass++)
+    {
+        if (pass != 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_clp->interval()));
+
+        auto &&bitmap = file::binary_data();
+
+        auto gpa = 0ULL;
+        auto pages = 0ULL;
+        auto dirty = 0ULL;
+        auto first = 0ULL;
+
+        // Each vmcall harvests one window of the bitmap, so keep harvesting
+        // until the window that holds the last page of the range. Each pass
+        // is appended to the output file as one complete bitmap.
+
+        do
+        {
+            auto cregs = regs;
+            cregs.r03 = first;
+            cregs.r08 = reinterpret_cast<decltype(cregs.r08)>(obuffer.get());
+            cregs.r09 = max_words * sizeof(uint64_t);
+
+            vmcall_send_regs(cregs);
+
+            if (cregs.r09 == 0 || cregs.r09 > max_words * sizeof(uint64_t) || (cregs.r09 % sizeof(uint64_t)) != 0)
+                throw std::out_of_range("returned bitmap size out of range");
+
+            auto &&data = reinterpret_cast<const char *>(obuffer.get());
+            bitmap.insert(bitmap.end(), data, data + cregs.r09);
+
+            gpa = cregs.r04;
+            pages = cregs.r05;
+            dirty += cregs.r03;
+            first += (cregs.r09 / sizeof(uint64_t)) * pages_per_word;
+        }
+        while (first < pages);
+
+        if (pass == 0)
+            m_file->write_binary(m_clp->ofile(), bitmap);
+        else
+            m_file->append_binary(m_clp->ofile(), bitmap);
+
+        std::cout << "pass " << pass << ": " << dirty << " of " << pages << " pages dirty"
+                  << " (gpa: " << view_as_pointer(gpa) << ")" << std::endl;
+    }
+}
+
+void
+ioctl_driver::vmcall_batch(registers_type &regs)
+{
+    (void) regs;
+
+    // Each line of the batch file is a single request, with the registers
+    // represented in hex, in the following order: r00 r02 r03 ... r15. Empty
+    // lines, and lines starting with '#' are ignored.
+
+    static const std::array<uintptr_t registers_type::*, 15> fields =
+    {{
+        &registers_type::r00, &registers_type::r02, &registers_type::r03,
+        &registers_type::r04, &registers_type::r05, &registers_type::r06,
+        &registers_type::r07, &registers_type::r08, &registers_type::r09,
+        &registers_type::r10, &registers_type::r11, &registers_type::r12,
+        &registers_type::r13, &registers_type::r14, &registers_type::r15
+    }};
+
+    auto &&requests = std::vector<registers_type>();
+    auto &&text = std::istringstream(m_file->read_text(m_clp->ifile()));
+
+    for (std::string line; std::getline(text, line);)
+    {
+        auto &&tokens = std::istringstream(line);
+        auto &&request = registers_type{};
+
+        auto index = 0UL;
+        for (std::string token; tokens >> token; index++)
+        {
+            if (index == 0 && token[0] == '#')
+                break;
+
+            if (index >= fields.size())
+                throw std::out_of_range("too many registers in batch request");
+
+            request.*fields[index] = std::stoull(token, nullptr, 16);
+        }
+
+        if (index != 0)
+            requests.push_back(request);
+    }
+
+    auto &&ring = vmcall_ring(m_ioctl, m_clp->cpuid());
+    auto &&handler = [](auto id, auto ret, const auto & cregs)
+    {
+        std::cout << "[" << id << "] " << (ret == 0 ? "success" : "failed")
+                  << ": r02: " << view_as_pointer(cregs.r02)
+                  << ", r03: " << view_as_pointer(cregs.r03) << '\n';
+    };
+
+    auto next = 0UL;
+    while (next < requests.size() || ring.pending() != 0)
+    {
+        while (next < requests.size() && ring.submit(next, requests.at(next)))
+            next++;
+
+        auto &&executed = ring.doorbell();
+        auto &&reaped = ring.reap(handler);
+
+        if (executed == 0 && reaped == 0)
+            throw std::runtime_error("vmcall ring stalled");
+    }
+}
+
 void
 ioctl_driver::vmcall_unittest(registers_type &regs)
 {
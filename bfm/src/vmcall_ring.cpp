@@ -0,0 +1,175 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#include <gsl/gsl>
+
+#include <new>
+#include <stdexcept>
+
+#include <exception.h>
+#include <vmcall_ring.h>
+#include <driver_entry_interface.h>
+
+#include <unistd.h>
+#include <sys/mman.h>
+
+// The VMM maps the ring once, when it is registered, and keeps using that
+// mapping until the ring is unregistered. The ring therefore gets its own
+// page aligned pages, which are locked so that the OS cannot page them out
+// (or move them) while the VMM is using them.
+
+static std::size_t
+ring_size() noexcept
+{
+    auto &&page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return (sizeof(vmcall_ring_t) + page_size - 1) & ~(page_size - 1);
+}
+
+static void
+free_ring(vmcall_ring_t *ring) noexcept
+{
+    ::munlock(ring, ring_size());
+    ::munmap(ring, ring_size());
+}
+
+static vmcall_ring::ring_pointer
+alloc_ring()
+{
+    auto &&addr = ::mmap(nullptr, ring_size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED)
+        throw std::bad_alloc();
+
+    auto ring = vmcall_ring::ring_pointer(static_cast<vmcall_ring_t *>(addr), free_ring);
+
+    if (::mlock(addr, ring_size()) != 0)
+        throw std::runtime_error("unable to lock the vmcall ring in memory");
+
+    return ring;
+}
+
+vmcall_ring::vmcall_ring(gsl::not_null<ioctl *> ctl, cpuid_type cpuid, flags_type flags) :
+    m_ioctl(ctl),
+    m_cpuid(cpuid),
+    m_ring(alloc_ring())
+{
+    auto &&regs = registers_type{};
+
+    regs.r00 = VMCALL_RING;
+    regs.r01 = VMCALL_MAGIC_NUMBER;
+    regs.r02 = VMCALL_RING_REGISTER;
+    regs.r03 = reinterpret_cast<decltype(regs.r03)>(m_ring.get());
+    regs.r04 = sizeof(vmcall_ring_t);
+    regs.r05 = flags;
+
+    this->send(regs);
+}
+
+vmcall_ring::~vmcall_ring()
+{
+    auto &&regs = registers_type{};
+
+    regs.r00 = VMCALL_RING;
+    regs.r01 = VMCALL_MAGIC_NUMBER;
+    regs.r02 = VMCALL_RING_UNREGISTER;
+
+    // If this fails, there is nothing else that can be done as the ring is
+    // being destroyed either way.
+
+    try
+    {
+        m_ioctl->call_ioctl_vmcall(&regs, m_cpuid);
+    }
+    catch (...)
+    { }
+}
+
+bool
+vmcall_ring::submit(id_type id, const registers_type &regs) noexcept
+{
+    auto &&sq = gsl::make_span(m_ring->sq);
+
+    auto sq_tail = m_ring->sq_tail;
+    auto cq_head = m_ring->cq_head;
+
+    // A request that is submitted will eventually need a completion, so
+    // the total number of outstanding requests is bounded by the size of
+    // the completion queue as well.
+
+    if (sq_tail - cq_head >= VMCALL_RING_NUM_ENTRIES)
+        return false;
+
+    auto &&sqe = sq[static_cast<std::ptrdiff_t>(sq_tail % VMCALL_RING_NUM_ENTRIES)];
+
+    sqe.id = id;
+    sqe.ret = 0;
+    sqe.regs = regs;
+
+    __atomic_store_n(&m_ring->sq_tail, sq_tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+vmcall_ring::size_type
+vmcall_ring::doorbell()
+{
+    auto &&regs = registers_type{};
+
+    regs.r00 = VMCALL_RING;
+    regs.r01 = VMCALL_MAGIC_NUMBER;
+    regs.r02 = VMCALL_RING_DOORBELL;
+
+    this->send(regs);
+    return regs.r03;
+}
+
+vmcall_ring::size_type
+vmcall_ring::reap(const completion_handler &handler)
+{
+    auto &&cq = gsl::make_span(m_ring->cq);
+
+    auto num = 0UL;
+    auto cq_head = m_ring->cq_head;
+    auto cq_tail = __atomic_load_n(&m_ring->cq_tail, __ATOMIC_ACQUIRE);
+
+    while (cq_head != cq_tail)
+    {
+        const auto &cqe = cq[static_cast<std::ptrdiff_t>(cq_head % VMCALL_RING_NUM_ENTRIES)];
+        handler(cqe.id, static_cast<ret_type>(cqe.ret), cqe.regs);
+
+        __atomic_store_n(&m_ring->cq_head, ++cq_head, __ATOMIC_RELEASE);
+        num++;
+    }
+
+    return num;
+}
+
+vmcall_ring::size_type
+vmcall_ring::pending() const noexcept
+{ return m_ring->sq_tail - m_ring->cq_head; }
+
+void
+vmcall_ring::send(registers_type &regs)
+{
+    m_ioctl->call_ioctl_vmcall(&regs, m_cpuid);
+
+    if (regs.r01 != 0)
+        throw ioctl_failed(IOCTL_VMCALL);
+}
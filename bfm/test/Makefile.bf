@@ -54,6 +54,7 @@ SOURCES+=test_command_line_parser.cpp
 SOURCES+=test_file.cpp
 SOURCES+=test_ioctl.cpp
 SOURCES+=test_ioctl_driver.cpp
+SOURCES+=test_vmcall_ring.cpp
 
 INCLUDE_PATHS+=./
 INCLUDE_PATHS+=../include/
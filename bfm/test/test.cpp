@@ -62,6 +62,7 @@ bfm_ut::list()
     this->test_command_line_parser_with_valid_stop();
     this->test_command_line_parser_with_valid_dump();
     this->test_command_line_parser_with_valid_status();
+    this->test_command_line_parser_with_valid_invalidate();
     this->test_command_line_parser_no_vcpuid();
     this->test_command_line_parser_invalid_vcpuid();
     this->test_command_line_parser_valid_vcpuid();
@@ -95,14 +96,48 @@ bfm_ut::list()
     this->test_command_line_parser_vmcall_event_missing_index();
     this->test_command_line_parser_vmcall_event_invalid_index();
     this->test_command_line_parser_vmcall_event_success();
+    this->test_command_line_parser_vmcall_profile_missing_command();
+    this->test_command_line_parser_vmcall_profile_unknown_command();
+    this->test_command_line_parser_vmcall_profile_start_missing_period();
+    this->test_command_line_parser_vmcall_profile_start_invalid_period();
+    this->test_command_line_parser_vmcall_profile_start_success();
+    this->test_command_line_parser_vmcall_profile_stop_success();
+    this->test_command_line_parser_vmcall_profile_collect_success();
+    this->test_command_line_parser_vmcall_heap_missing_command();
+    this->test_command_line_parser_vmcall_heap_unknown_command();
+    this->test_command_line_parser_vmcall_heap_success();
+    this->test_command_line_parser_vmcall_locks_missing_command();
+    this->test_command_line_parser_vmcall_locks_unknown_command();
+    this->test_command_line_parser_vmcall_locks_success();
+    this->test_command_line_parser_vmcall_dirty_missing_command();
+    this->test_command_line_parser_vmcall_dirty_unknown_command();
+    this->test_command_line_parser_vmcall_dirty_start_missing_size();
+    this->test_command_line_parser_vmcall_dirty_start_success();
+    this->test_command_line_parser_vmcall_dirty_stop_success();
+    this->test_command_line_parser_vmcall_dirty_stream_missing_ofile();
+    this->test_command_line_parser_vmcall_dirty_stream_zero_passes();
+    this->test_command_line_parser_vmcall_dirty_stream_success();
+    this->test_command_line_parser_vmcall_batch_missing_file();
+    this->test_command_line_parser_vmcall_batch_success();
+    this->test_command_line_parser_vmcall_string_msgpack_invalid_json();
+    this->test_command_line_parser_vmcall_string_msgpack();
+    this->test_command_line_parser_vmcall_bench_missing_iterations();
+    this->test_command_line_parser_vmcall_bench_zero_iterations();
+    this->test_command_line_parser_vmcall_bench_success();
 
     this->test_file_read_with_bad_filename();
     this->test_file_write_with_bad_filename();
     this->test_file_read_write_success();
+    this->test_file_map_with_bad_filename();
+    this->test_file_map_success();
 
     this->test_ioctl_driver_inaccessible();
     this->test_ioctl_add_module_with_invalid_length();
     this->test_ioctl_add_module_failed();
+    this->test_ioctl_add_modules_with_invalid_length();
+    this->test_ioctl_add_modules_too_many();
+    this->test_ioctl_add_modules_failed();
+    this->test_ioctl_add_modules_success();
     this->test_ioctl_load_vmm_failed();
     this->test_ioctl_unload_vmm_failed();
     this->test_ioctl_start_vmm_failed();
@@ -111,6 +146,7 @@ bfm_ut::list()
     this->test_ioctl_dump_vmm_failed();
     this->test_ioctl_vmm_status_with_invalid_status();
     this->test_ioctl_vmm_status_failed();
+    this->test_ioctl_invalidate_cache_failed();
     this->test_ioctl_vmm_vmcall_with_invalid_registers();
     this->test_ioctl_vmm_vmcall_failed();
 
@@ -158,6 +194,8 @@ bfm_ut::list()
     this->test_ioctl_driver_process_vmm_status_unloaded();
     this->test_ioctl_driver_process_vmm_status_corrupt();
     this->test_ioctl_driver_process_vmm_status_unknown_status();
+    this->test_ioctl_driver_process_invalidate_cache_success();
+    this->test_ioctl_driver_process_invalidate_cache_corrupt();
     this->test_ioctl_driver_process_vmcall_vmm_unloaded();
     this->test_ioctl_driver_process_vmcall_vmm_loaded();
     this->test_ioctl_driver_process_vmcall_vmm_corrupt();
@@ -178,6 +216,29 @@ bfm_ut::list()
     this->test_ioctl_driver_process_vmcall_event_ioctl_failed();
     this->test_ioctl_driver_process_vmcall_event_ioctl_return_failed();
     this->test_ioctl_driver_process_vmcall_event_success();
+    this->test_ioctl_driver_process_vmcall_profile_start_success();
+    this->test_ioctl_driver_process_vmcall_profile_collect_ioctl_return_failed();
+    this->test_ioctl_driver_process_vmcall_profile_collect_out_of_range();
+    this->test_ioctl_driver_process_vmcall_profile_collect_success();
+    this->test_ioctl_driver_process_vmcall_heap_start_success();
+    this->test_ioctl_driver_process_vmcall_heap_collect_out_of_range();
+    this->test_ioctl_driver_process_vmcall_heap_collect_success();
+    this->test_ioctl_driver_process_vmcall_heap_pools_out_of_range();
+    this->test_ioctl_driver_process_vmcall_heap_pools_success();
+    this->test_ioctl_driver_process_vmcall_locks_reset_success();
+    this->test_ioctl_driver_process_vmcall_locks_collect_out_of_range();
+    this->test_ioctl_driver_process_vmcall_locks_collect_success();
+    this->test_ioctl_driver_process_vmcall_dirty_start_success();
+    this->test_ioctl_driver_process_vmcall_dirty_stream_out_of_range();
+    this->test_ioctl_driver_process_vmcall_dirty_stream_success();
+    this->test_ioctl_driver_process_vmcall_batch_invalid_request();
+    this->test_ioctl_driver_process_vmcall_batch_too_many_registers();
+    this->test_ioctl_driver_process_vmcall_batch_stalled();
+    this->test_ioctl_driver_process_vmcall_batch_success();
+    this->test_ioctl_driver_process_vmcall_data_binary_msgpack_invalid_reply();
+    this->test_ioctl_driver_process_vmcall_data_binary_msgpack_success();
+    this->test_ioctl_driver_process_vmcall_data_bench_failure();
+    this->test_ioctl_driver_process_vmcall_data_bench_success();
     this->test_ioctl_driver_process_vmcall_data_string_unformatted_unknown_data_type();
     this->test_ioctl_driver_process_vmcall_data_string_unformatted_ioctl_failed();
     this->test_ioctl_driver_process_vmcall_data_string_unformatted_ioctl_return_failed();
@@ -197,6 +258,20 @@ bfm_ut::list()
     this->test_ioctl_driver_process_vmcall_data_binary_unformatted_success_no_return();
     this->test_ioctl_driver_process_vmcall_data_binary_unformatted_success_unformatted();
 
+    this->test_vmcall_ring_register_failed();
+    this->test_vmcall_ring_register_unregister();
+    this->test_vmcall_ring_submit_full();
+    this->test_vmcall_ring_doorbell_failed();
+    this->test_vmcall_ring_doorbell_success();
+
+    return true;
+}
+
+bool
+bfm_ut::benchmark()
+{
+    this->benchmark_file_read_vs_map();
+
     return true;
 }
 
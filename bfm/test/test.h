@@ -36,6 +36,7 @@ protected:
     bool init() override;
     bool fini() override;
     bool list() override;
+    bool benchmark() override;
 
 private:
 
@@ -61,6 +62,7 @@ private:
     void test_command_line_parser_with_valid_stop();
     void test_command_line_parser_with_valid_dump();
     void test_command_line_parser_with_valid_status();
+    void test_command_line_parser_with_valid_invalidate();
     void test_command_line_parser_no_vcpuid();
     void test_command_line_parser_invalid_vcpuid();
     void test_command_line_parser_valid_vcpuid();
@@ -94,14 +96,48 @@ private:
     void test_command_line_parser_vmcall_event_missing_index();
     void test_command_line_parser_vmcall_event_invalid_index();
     void test_command_line_parser_vmcall_event_success();
+    void test_command_line_parser_vmcall_profile_missing_command();
+    void test_command_line_parser_vmcall_profile_unknown_command();
+    void test_command_line_parser_vmcall_profile_start_missing_period();
+    void test_command_line_parser_vmcall_profile_start_invalid_period();
+    void test_command_line_parser_vmcall_profile_start_success();
+    void test_command_line_parser_vmcall_profile_stop_success();
+    void test_command_line_parser_vmcall_profile_collect_success();
+    void test_command_line_parser_vmcall_heap_missing_command();
+    void test_command_line_parser_vmcall_heap_unknown_command();
+    void test_command_line_parser_vmcall_heap_success();
+    void test_command_line_parser_vmcall_locks_missing_command();
+    void test_command_line_parser_vmcall_locks_unknown_command();
+    void test_command_line_parser_vmcall_locks_success();
+    void test_command_line_parser_vmcall_dirty_missing_command();
+    void test_command_line_parser_vmcall_dirty_unknown_command();
+    void test_command_line_parser_vmcall_dirty_start_missing_size();
+    void test_command_line_parser_vmcall_dirty_start_success();
+    void test_command_line_parser_vmcall_dirty_stop_success();
+    void test_command_line_parser_vmcall_dirty_stream_missing_ofile();
+    void test_command_line_parser_vmcall_dirty_stream_zero_passes();
+    void test_command_line_parser_vmcall_dirty_stream_success();
+    void test_command_line_parser_vmcall_batch_missing_file();
+    void test_command_line_parser_vmcall_batch_success();
+    void test_command_line_parser_vmcall_string_msgpack_invalid_json();
+    void test_command_line_parser_vmcall_string_msgpack();
+    void test_command_line_parser_vmcall_bench_missing_iterations();
+    void test_command_line_parser_vmcall_bench_zero_iterations();
+    void test_command_line_parser_vmcall_bench_success();
 
     void test_file_read_with_bad_filename();
     void test_file_write_with_bad_filename();
     void test_file_read_write_success();
+    void test_file_map_with_bad_filename();
+    void test_file_map_success();
 
     void test_ioctl_driver_inaccessible();
     void test_ioctl_add_module_with_invalid_length();
     void test_ioctl_add_module_failed();
+    void test_ioctl_add_modules_with_invalid_length();
+    void test_ioctl_add_modules_too_many();
+    void test_ioctl_add_modules_failed();
+    void test_ioctl_add_modules_success();
     void test_ioctl_load_vmm_failed();
     void test_ioctl_unload_vmm_failed();
     void test_ioctl_start_vmm_failed();
@@ -110,6 +146,7 @@ private:
     void test_ioctl_dump_vmm_failed();
     void test_ioctl_vmm_status_with_invalid_status();
     void test_ioctl_vmm_status_failed();
+    void test_ioctl_invalidate_cache_failed();
     void test_ioctl_vmm_vmcall_with_invalid_registers();
     void test_ioctl_vmm_vmcall_failed();
 
@@ -157,6 +194,8 @@ private:
     void test_ioctl_driver_process_vmm_status_unloaded();
     void test_ioctl_driver_process_vmm_status_corrupt();
     void test_ioctl_driver_process_vmm_status_unknown_status();
+    void test_ioctl_driver_process_invalidate_cache_success();
+    void test_ioctl_driver_process_invalidate_cache_corrupt();
     void test_ioctl_driver_process_vmcall_vmm_unloaded();
     void test_ioctl_driver_process_vmcall_vmm_loaded();
     void test_ioctl_driver_process_vmcall_vmm_corrupt();
@@ -177,6 +216,29 @@ private:
     void test_ioctl_driver_process_vmcall_event_ioctl_failed();
     void test_ioctl_driver_process_vmcall_event_ioctl_return_failed();
     void test_ioctl_driver_process_vmcall_event_success();
+    void test_ioctl_driver_process_vmcall_profile_start_success();
+    void test_ioctl_driver_process_vmcall_profile_collect_ioctl_return_failed();
+    void test_ioctl_driver_process_vmcall_profile_collect_out_of_range();
+    void test_ioctl_driver_process_vmcall_profile_collect_success();
+    void test_ioctl_driver_process_vmcall_heap_start_success();
+    void test_ioctl_driver_process_vmcall_heap_collect_out_of_range();
+    void test_ioctl_driver_process_vmcall_heap_collect_success();
+    void test_ioctl_driver_process_vmcall_heap_pools_out_of_range();
+    void test_ioctl_driver_process_vmcall_heap_pools_success();
+    void test_ioctl_driver_process_vmcall_locks_reset_success();
+    void test_ioctl_driver_process_vmcall_locks_collect_out_of_range();
+    void test_ioctl_driver_process_vmcall_locks_collect_success();
+    void test_ioctl_driver_process_vmcall_dirty_start_success();
+    void test_ioctl_driver_process_vmcall_dirty_stream_out_of_range();
+    void test_ioctl_driver_process_vmcall_dirty_stream_success();
+    void test_ioctl_driver_process_vmcall_batch_invalid_request();
+    void test_ioctl_driver_process_vmcall_batch_too_many_registers();
+    void test_ioctl_driver_process_vmcall_batch_stalled();
+    void test_ioctl_driver_process_vmcall_batch_success();
+    void test_ioctl_driver_process_vmcall_data_binary_msgpack_invalid_reply();
+    void test_ioctl_driver_process_vmcall_data_binary_msgpack_success();
+    void test_ioctl_driver_process_vmcall_data_bench_failure();
+    void test_ioctl_driver_process_vmcall_data_bench_success();
     void test_ioctl_driver_process_vmcall_data_string_unformatted_unknown_data_type();
     void test_ioctl_driver_process_vmcall_data_string_unformatted_ioctl_failed();
     void test_ioctl_driver_process_vmcall_data_string_unformatted_ioctl_return_failed();
@@ -195,6 +257,14 @@ private:
     void test_ioctl_driver_process_vmcall_data_binary_unformatted_out_of_range();
     void test_ioctl_driver_process_vmcall_data_binary_unformatted_success_no_return();
     void test_ioctl_driver_process_vmcall_data_binary_unformatted_success_unformatted();
+
+    void test_vmcall_ring_register_failed();
+    void test_vmcall_ring_register_unregister();
+    void test_vmcall_ring_submit_full();
+    void test_vmcall_ring_doorbell_failed();
+    void test_vmcall_ring_doorbell_success();
+
+    void benchmark_file_read_vs_map();
 };
 
 #endif
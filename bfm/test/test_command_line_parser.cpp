@@ -40,6 +40,18 @@ static auto operator"" _uvste(const char *str, std::size_t len)
 static auto operator"" _uvdte(const char *str, std::size_t len)
 { (void)str; (void)len; return std::make_shared<bfn::unknown_vmcall_data_type_error>(""); }
 
+static auto operator"" _uvpce(const char *str, std::size_t len)
+{ (void)str; (void)len; return std::make_shared<bfn::unknown_vmcall_profile_command_error>(""); }
+
+static auto operator"" _uvhce(const char *str, std::size_t len)
+{ (void)str; (void)len; return std::make_shared<bfn::unknown_vmcall_heap_command_error>(""); }
+
+static auto operator"" _uvlce(const char *str, std::size_t len)
+{ (void)str; (void)len; return std::make_shared<bfn::unknown_vmcall_locks_command_error>(""); }
+
+static auto operator"" _uvdce(const char *str, std::size_t len)
+{ (void)str; (void)len; return std::make_shared<bfn::unknown_vmcall_dirty_command_error>(""); }
+
 void
 bfm_ut::test_command_line_parser_with_no_args()
 {
@@ -268,6 +280,16 @@ bfm_ut::test_command_line_parser_with_valid_status()
     this->expect_true(clp.cmd() == command_line_parser::command_type::status);
 }
 
+void
+bfm_ut::test_command_line_parser_with_valid_invalidate()
+{
+    auto &&args = {"invalidate"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_no_exception([&] { clp.parse(args); });
+    this->expect_true(clp.cmd() == command_line_parser::command_type::invalidate);
+}
+
 void
 bfm_ut::test_command_line_parser_no_vcpuid()
 {
@@ -672,3 +694,363 @@ bfm_ut::test_command_line_parser_vmcall_event_success()
     this->expect_true(clp.registers().r01 == VMCALL_MAGIC_NUMBER);
     this->expect_true(clp.registers().r02 == 1);
 }
+
+void
+bfm_ut::test_command_line_parser_vmcall_profile_missing_command()
+{
+    auto &&args = {"vmcall"_s, "profile"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_mae);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_profile_unknown_command()
+{
+    auto &&args = {"vmcall"_s, "profile"_s, "unknown"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_uvpce);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_profile_start_missing_period()
+{
+    auto &&args = {"vmcall"_s, "profile"_s, "start"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_mae);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_profile_start_invalid_period()
+{
+    auto &&args = {"vmcall"_s, "profile"_s, "start"_s, "not_a_number"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_ut_iae);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_profile_start_success()
+{
+    auto &&args = {"vmcall"_s, "profile"_s, "start"_s, "1000"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_no_exception([&] { clp.parse(args); });
+    this->expect_true(clp.cmd() == command_line_parser::command_type::vmcall);
+
+    this->expect_true(clp.registers().r00 == VMCALL_PROFILE);
+    this->expect_true(clp.registers().r01 == VMCALL_MAGIC_NUMBER);
+    this->expect_true(clp.registers().r02 == VMCALL_PROFILE_START);
+    this->expect_true(clp.registers().r03 == 0x1000);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_profile_stop_success()
+{
+    auto &&args = {"vmcall"_s, "profile"_s, "stop"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_no_exception([&] { clp.parse(args); });
+    this->expect_true(clp.cmd() == command_line_parser::command_type::vmcall);
+
+    this->expect_true(clp.registers().r00 == VMCALL_PROFILE);
+    this->expect_true(clp.registers().r01 == VMCALL_MAGIC_NUMBER);
+    this->expect_true(clp.registers().r02 == VMCALL_PROFILE_STOP);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_profile_collect_success()
+{
+    auto &&args = {"vmcall"_s, "profile"_s, "collect"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_no_exception([&] { clp.parse(args); });
+    this->expect_true(clp.cmd() == command_line_parser::command_type::vmcall);
+
+    this->expect_true(clp.registers().r00 == VMCALL_PROFILE);
+    this->expect_true(clp.registers().r01 == VMCALL_MAGIC_NUMBER);
+    this->expect_true(clp.registers().r02 == VMCALL_PROFILE_COLLECT);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_heap_missing_command()
+{
+    auto &&args = {"vmcall"_s, "heap"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_mae);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_heap_unknown_command()
+{
+    auto &&args = {"vmcall"_s, "heap"_s, "unknown"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_uvhce);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_heap_success()
+{
+    auto &&commands = {
+        std::make_pair("start"_s, VMCALL_HEAP_START),
+        std::make_pair("stop"_s, VMCALL_HEAP_STOP),
+        std::make_pair("collect"_s, VMCALL_HEAP_COLLECT),
+        std::make_pair("pools"_s, VMCALL_HEAP_POOLS)
+    };
+
+    for (const auto &command : commands)
+    {
+        auto &&args = {"vmcall"_s, "heap"_s, command.first};
+        auto &&clp = command_line_parser{};
+
+        this->expect_no_exception([&] { clp.parse(args); });
+        this->expect_true(clp.cmd() == command_line_parser::command_type::vmcall);
+
+        this->expect_true(clp.registers().r00 == VMCALL_HEAP);
+        this->expect_true(clp.registers().r01 == VMCALL_MAGIC_NUMBER);
+        this->expect_true(clp.registers().r02 == command.second);
+    }
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_locks_missing_command()
+{
+    auto &&args = {"vmcall"_s, "locks"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_mae);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_locks_unknown_command()
+{
+    auto &&args = {"vmcall"_s, "locks"_s, "unknown"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_uvlce);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_locks_success()
+{
+    auto &&commands = {
+        std::make_pair("collect"_s, VMCALL_LOCKS_COLLECT),
+        std::make_pair("reset"_s, VMCALL_LOCKS_RESET)
+    };
+
+    for (const auto &command : commands)
+    {
+        auto &&args = {"vmcall"_s, "locks"_s, command.first};
+        auto &&clp = command_line_parser{};
+
+        this->expect_no_exception([&] { clp.parse(args); });
+        this->expect_true(clp.cmd() == command_line_parser::command_type::vmcall);
+
+        this->expect_true(clp.registers().r00 == VMCALL_LOCKS);
+        this->expect_true(clp.registers().r01 == VMCALL_MAGIC_NUMBER);
+        this->expect_true(clp.registers().r02 == command.second);
+    }
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_dirty_missing_command()
+{
+    auto &&args = {"vmcall"_s, "dirty"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_mae);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_dirty_unknown_command()
+{
+    auto &&args = {"vmcall"_s, "dirty"_s, "unknown"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_uvdce);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_dirty_start_missing_size()
+{
+    auto &&args = {"vmcall"_s, "dirty"_s, "start"_s, "200000"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_mae);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_dirty_start_success()
+{
+    auto &&args = {"vmcall"_s, "dirty"_s, "start"_s, "200000"_s, "10000"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_no_exception([&] { clp.parse(args); });
+    this->expect_true(clp.cmd() == command_line_parser::command_type::vmcall);
+
+    this->expect_true(clp.registers().r00 == VMCALL_DIRTY_LOG);
+    this->expect_true(clp.registers().r01 == VMCALL_MAGIC_NUMBER);
+    this->expect_true(clp.registers().r02 == VMCALL_DIRTY_LOG_START);
+    this->expect_true(clp.registers().r03 == 0x200000);
+    this->expect_true(clp.registers().r04 == 0x10000);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_dirty_stop_success()
+{
+    auto &&args = {"vmcall"_s, "dirty"_s, "stop"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_no_exception([&] { clp.parse(args); });
+    this->expect_true(clp.cmd() == command_line_parser::command_type::vmcall);
+
+    this->expect_true(clp.registers().r00 == VMCALL_DIRTY_LOG);
+    this->expect_true(clp.registers().r02 == VMCALL_DIRTY_LOG_STOP);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_dirty_stream_missing_ofile()
+{
+    auto &&args = {"vmcall"_s, "dirty"_s, "stream"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_mae);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_dirty_stream_zero_passes()
+{
+    auto &&args = {"vmcall"_s, "dirty"_s, "stream"_s, "ofile"_s, "0"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_ut_ore);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_dirty_stream_success()
+{
+    {
+        auto &&args = {"vmcall"_s, "dirty"_s, "stream"_s, "ofile"_s};
+        auto &&clp = command_line_parser{};
+
+        this->expect_no_exception([&] { clp.parse(args); });
+        this->expect_true(clp.cmd() == command_line_parser::command_type::vmcall);
+        this->expect_true(clp.ofile() == "ofile");
+        this->expect_true(clp.iterations() == 1);
+        this->expect_true(clp.interval() == 0);
+
+        this->expect_true(clp.registers().r00 == VMCALL_DIRTY_LOG);
+        this->expect_true(clp.registers().r02 == VMCALL_DIRTY_LOG_HARVEST);
+    }
+
+    {
+        auto &&args = {"vmcall"_s, "dirty"_s, "stream"_s, "ofile"_s, "10"_s, "250"_s};
+        auto &&clp = command_line_parser{};
+
+        this->expect_no_exception([&] { clp.parse(args); });
+        this->expect_true(clp.iterations() == 10);
+        this->expect_true(clp.interval() == 250);
+    }
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_batch_missing_file()
+{
+    auto &&args = {"vmcall"_s, "batch"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_mae);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_batch_success()
+{
+    auto &&args = {"vmcall"_s, "batch"_s, "ifile"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_no_exception([&] { clp.parse(args); });
+    this->expect_true(clp.cmd() == command_line_parser::command_type::vmcall);
+    this->expect_true(clp.ifile() == "ifile");
+
+    this->expect_true(clp.registers().r00 == VMCALL_RING);
+    this->expect_true(clp.registers().r01 == VMCALL_MAGIC_NUMBER);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_string_msgpack_invalid_json()
+{
+    auto &&args = {"vmcall"_s, "string"_s, "msgpack"_s, "hello world"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_ut_iae);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_string_msgpack()
+{
+    auto &&args = {"vmcall"_s, "string"_s, "msgpack"_s, "{\"msg\":\"hello world\"}"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_no_exception([&] { clp.parse(args); });
+    this->expect_true(clp.cmd() == command_line_parser::command_type::vmcall);
+
+    this->expect_true(clp.registers().r00 == VMCALL_DATA);
+    this->expect_true(clp.registers().r01 == VMCALL_MAGIC_NUMBER);
+    this->expect_true(clp.registers().r04 == VMCALL_DATA_BINARY_MSGPACK);
+    this->expect_true(clp.registers().r05 != 0);
+    this->expect_true(clp.registers().r06 == 17);
+    this->expect_true(clp.iterations() == 0);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_bench_missing_iterations()
+{
+    auto &&args = {"vmcall"_s, "bench"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_mae);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_bench_zero_iterations()
+{
+    auto &&args = {"vmcall"_s, "bench"_s, "0"_s, "json"_s, "{}"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_exception([&] { clp.parse(args); }, ""_ut_ore);
+    this->expect_true(clp.cmd() == command_line_parser::command_type::help);
+}
+
+void
+bfm_ut::test_command_line_parser_vmcall_bench_success()
+{
+    auto &&args = {"vmcall"_s, "bench"_s, "1000"_s, "msgpack"_s, "{\"msg\":\"hello world\"}"_s};
+    auto &&clp = command_line_parser{};
+
+    this->expect_no_exception([&] { clp.parse(args); });
+    this->expect_true(clp.cmd() == command_line_parser::command_type::vmcall);
+    this->expect_true(clp.iterations() == 1000);
+
+    this->expect_true(clp.registers().r00 == VMCALL_DATA);
+    this->expect_true(clp.registers().r04 == VMCALL_DATA_BINARY_MSGPACK);
+}
@@ -21,6 +21,10 @@
 
 #include <test.h>
 
+#include <chrono>
+#include <fstream>
+#include <numeric>
+
 #include <file.h>
 #include <exception.h>
 
@@ -57,6 +61,10 @@ bfm_ut::test_file_write_with_bad_filename()
 
     this->expect_exception([&] { f.write_text(filename, text_data); }, ""_ife);
     this->expect_exception([&] { f.write_binary(filename, binary_data); }, ""_ife);
+
+    this->expect_exception([&] { f.append_binary("", binary_data); }, ""_ut_ffe);
+    this->expect_exception([&] { f.append_binary(filename, {}); }, ""_ut_ffe);
+    this->expect_exception([&] { f.append_binary(filename, binary_data); }, ""_ife);
 }
 
 void
@@ -74,6 +82,95 @@ bfm_ut::test_file_read_write_success()
     this->expect_no_exception([&] { f.write_binary(filename, binary_data); });
     this->expect_true(f.read_binary(filename) == file::binary_data(binary_data));
 
+    this->expect_no_exception([&] { f.append_binary(filename, binary_data); });
+    this->expect_true(f.read_binary(filename) == file::binary_data({'h', 'e', 'l', 'l', 'o', 'h', 'e', 'l', 'l', 'o'}));
+
     auto &&ret = std::remove(filename.c_str());
     (void) ret;
 }
+
+void
+bfm_ut::test_file_map_with_bad_filename()
+{
+    auto &&f = file{};
+
+    this->expect_exception([&] { f.map_binary(""); }, ""_ut_ffe);
+    this->expect_exception([&] { f.map_binary("/blah/bad_filename.txt"); }, ""_ife);
+    this->expect_exception([&] { f.map_binary("/tmp"); }, ""_ife);
+}
+
+void
+bfm_ut::test_file_map_success()
+{
+    auto &&f = file{};
+    auto &&filename = "/tmp/test_file.bin"_s;
+
+    auto &&binary_data = file::binary_data{'h', 'e', 'l', 'l', 'o'};
+
+    this->expect_no_exception([&] { f.write_binary(filename, binary_data); });
+
+    auto &&mapped = f.map_binary(filename);
+    this->expect_true(mapped.size() == binary_data.size());
+    this->expect_true(std::equal(binary_data.begin(), binary_data.end(), mapped.data()));
+
+    auto &&copy = file::mapped_data(mapped);
+    mapped = {};
+    this->expect_true(mapped.size() == 0);
+    this->expect_true(std::equal(binary_data.begin(), binary_data.end(), copy.data()));
+
+    std::fstream(filename, std::ios_base::out | std::ios_base::trunc);
+    this->expect_true(f.map_binary(filename).size() == 0);
+    this->expect_true(f.read_binary(filename).empty());
+
+    auto &&ret = std::remove(filename.c_str());
+    (void) ret;
+}
+
+void
+bfm_ut::benchmark_file_read_vs_map()
+{
+    constexpr const auto num_files = 8;
+    constexpr const auto file_size = 0x400000;
+
+    auto &&f = file{};
+    auto &&binary_data = file::binary_data(file_size);
+    std::iota(binary_data.begin(), binary_data.end(), 0);
+
+    for (auto i = 0; i < num_files; i++)
+        f.write_binary("/tmp/test_file_" + std::to_string(i) + ".bin", binary_data);
+
+    auto &&ns_read = 0LL;
+    auto &&ns_map = 0LL;
+
+    for (auto i = 0; i < num_files; i++)
+    {
+        auto &&filename = "/tmp/test_file_" + std::to_string(i) + ".bin";
+
+        auto &&start = std::chrono::steady_clock::now();
+        auto &&data = f.read_binary(filename);
+        auto &&sum = std::accumulate(data.begin(), data.end(), 0LL);
+        auto &&end = std::chrono::steady_clock::now();
+
+        ns_read += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        start = std::chrono::steady_clock::now();
+        auto &&mapped = f.map_binary(filename);
+        auto &&msum = std::accumulate(mapped.data(), mapped.data() + mapped.size(), 0LL);
+        end = std::chrono::steady_clock::now();
+
+        ns_map += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        this->expect_true(sum == msum);
+        this->expect_true(mapped.size() == file_size);
+    }
+
+    std::cout << "read " << num_files << " x " << file_size << " bytes: "
+              << ns_read / num_files << " ns per file (read), "
+              << ns_map / num_files << " ns per file (map)" << std::endl;
+
+    for (auto i = 0; i < num_files; i++)
+    {
+        auto &&ret = std::remove(("/tmp/test_file_" + std::to_string(i) + ".bin").c_str());
+        (void) ret;
+    }
+}
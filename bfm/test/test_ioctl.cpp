@@ -22,12 +22,17 @@
 #include <test.h>
 #include <ioctl.h>
 #include <debug_ring_interface.h>
+#include <driver_entry_interface.h>
+
+#include <linux/ioctl.h>
 
 int g_ioctl_open = 0;
 int g_send_ioctl = 0;
 int g_read_ioctl = 0;
 int g_write_ioctl = 0;
 
+module_list_t g_module_list = {};
+
 int64_t bf_ioctl_open()
 { return g_ioctl_open; }
 
@@ -38,7 +43,14 @@ int64_t bf_read_ioctl(int fd, unsigned long request, void *data)
 { (void) fd; (void) request; (void) data; return g_read_ioctl; }
 
 int64_t bf_write_ioctl(int fd, unsigned long request, const void *data)
-{ (void) fd; (void) request; (void) data; return g_write_ioctl; }
+{
+    (void) fd;
+
+    if (request == IOCTL_ADD_MODULES)
+        g_module_list = *static_cast<const module_list_t *>(data);
+
+    return g_write_ioctl;
+}
 
 static auto operator"" _die(const char *str, std::size_t len)
 { (void)str; (void)len; return std::make_shared<bfn::driver_inaccessible_error>(); }
@@ -76,6 +88,52 @@ bfm_ut::test_ioctl_add_module_failed()
     this->expect_exception([&] { ctl.call_ioctl_add_module(data); }, ""_ife);
 }
 
+void
+bfm_ut::test_ioctl_add_modules_with_invalid_length()
+{
+    auto &&ctl = ioctl{};
+    auto &&modules = ioctl::module_list{{"hello", 5}, {}};
+
+    this->expect_exception([&] { ctl.call_ioctl_add_modules(modules); }, ""_ut_ffe);
+}
+
+void
+bfm_ut::test_ioctl_add_modules_too_many()
+{
+    auto &&ctl = ioctl{};
+    auto &&modules = ioctl::module_list(MAX_NUM_MODULES + 1, {"hello", 5});
+
+    this->expect_exception([&] { ctl.call_ioctl_add_modules(modules); }, ""_ut_ffe);
+}
+
+void
+bfm_ut::test_ioctl_add_modules_failed()
+{
+    auto &&ctl = ioctl{};
+    auto &&modules = ioctl::module_list{{"hello", 5}};
+
+    g_write_ioctl = -1;
+    auto ___ = gsl::finally([&] { g_write_ioctl = 0; });
+
+    this->expect_exception([&] { ctl.call_ioctl_add_modules(modules); }, ""_ife);
+}
+
+void
+bfm_ut::test_ioctl_add_modules_success()
+{
+    auto &&ctl = ioctl{};
+    auto &&modules = ioctl::module_list{{"hello", 5}, {"world!", 6}};
+
+    g_module_list = {};
+    this->expect_no_exception([&] { ctl.call_ioctl_add_modules(modules); });
+
+    this->expect_true(g_module_list.num_modules == 2);
+    this->expect_true(g_module_list.modules[0].addr == reinterpret_cast<uint64_t>(modules[0].data()));
+    this->expect_true(g_module_list.modules[0].size == 5);
+    this->expect_true(g_module_list.modules[1].addr == reinterpret_cast<uint64_t>(modules[1].data()));
+    this->expect_true(g_module_list.modules[1].size == 6);
+}
+
 void
 bfm_ut::test_ioctl_load_vmm_failed()
 {
@@ -162,6 +220,17 @@ bfm_ut::test_ioctl_vmm_status_failed()
     this->expect_exception([&] { ctl.call_ioctl_vmm_status(&status); }, ""_ife);
 }
 
+void
+bfm_ut::test_ioctl_invalidate_cache_failed()
+{
+    auto &&ctl = ioctl{};
+
+    g_send_ioctl = -1;
+    auto ___ = gsl::finally([&] { g_send_ioctl = 0; });
+
+    this->expect_exception([&] { ctl.call_ioctl_invalidate_cache(); }, ""_ife);
+}
+
 void
 bfm_ut::test_ioctl_vmm_vmcall_with_invalid_registers()
 {
@@ -25,6 +25,9 @@
 #include <file.h>
 #include <ioctl.h>
 #include <ioctl_driver.h>
+#include <memory.h>
+#include <msgpack.h>
+#include <vmcall_interface.h>
 #include <driver_entry_interface.h>
 
 ioctl::status_type g_status = 0;
@@ -48,8 +51,10 @@ setup_file(MockRepository &mocks)
 
     mocks.OnCall(fil, file::read_text).Return(""_s);
     mocks.OnCall(fil, file::read_binary).Return(file::binary_data());
+    mocks.OnCall(fil, file::map_binary).Return(file::mapped_data());
     mocks.OnCall(fil, file::write_text);
     mocks.OnCall(fil, file::write_binary);
+    mocks.OnCall(fil, file::append_binary);
 
     return fil;
 }
@@ -63,6 +68,7 @@ setup_ioctl(MockRepository &mocks, ioctl::status_type status)
 
     mocks.OnCall(ctl, ioctl::open);
     mocks.OnCall(ctl, ioctl::call_ioctl_add_module);
+    mocks.OnCall(ctl, ioctl::call_ioctl_add_modules);
     mocks.OnCall(ctl, ioctl::call_ioctl_load_vmm);
     mocks.OnCall(ctl, ioctl::call_ioctl_unload_vmm);
     mocks.OnCall(ctl, ioctl::call_ioctl_start_vmm);
@@ -70,6 +76,7 @@ setup_ioctl(MockRepository &mocks, ioctl::status_type status)
     mocks.OnCall(ctl, ioctl::call_ioctl_dump_vmm);
     mocks.OnCall(ctl, ioctl::call_ioctl_vmm_status);
     mocks.OnCall(ctl, ioctl::call_ioctl_vmcall);
+    mocks.OnCall(ctl, ioctl::call_ioctl_invalidate_cache);
 
     mocks.OnCall(ctl, ioctl::call_ioctl_vmm_status).Do([&](gsl::not_null<ioctl::status_pointer> s)
     { *s = g_status; });
@@ -89,6 +96,8 @@ setup_command_line_parser(MockRepository &mocks, command_line_parser::command_ty
     mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type{});
     mocks.OnCall(clp, command_line_parser::ifile).Return(""_s);
     mocks.OnCall(clp, command_line_parser::ofile).Return(""_s);
+    mocks.OnCall(clp, command_line_parser::iterations).Return(0);
+    mocks.OnCall(clp, command_line_parser::interval).Return(0);
 
     return clp;
 }
@@ -263,14 +272,16 @@ bfm_ut::test_ioctl_driver_process_load_bad_module_filename()
     mocks.OnCall(fil, file::read_text).Do([](auto) -> auto
     { return "{\"modules\":[\"1\",\"2\",\"3\"]}"_s; });
 
-    mocks.OnCall(fil, file::read_binary).Do([](auto filename) -> auto
+    mocks.OnCall(fil, file::map_binary).Do([](auto filename) -> auto
     {
         if (filename == "2")
             throw std::runtime_error("error");
 
-        return file::binary_data{'g', 'o', 'o', 'd'};
+        return file::mapped_data("good", 4);
     });
 
+    mocks.NeverCall(ctl, ioctl::call_ioctl_add_modules);
+
     RUN_UNITTEST_WITH_MOCKS(mocks, [&]
     {
         auto &&driver = ioctl_driver(fil, ctl, clp);
@@ -292,20 +303,25 @@ bfm_ut::test_ioctl_driver_process_load_add_module_failed()
     mocks.OnCall(fil, file::read_text).Do([](auto) -> auto
     { return "{\"modules\":[\"1\",\"2\",\"3\"]}"_s; });
 
-    mocks.OnCall(fil, file::read_binary).Do([](auto filename) -> auto
+    mocks.OnCall(fil, file::map_binary).Do([](auto filename) -> auto
     {
         if (filename == "2")
-            return file::binary_data{'b', 'a', 'd'};
+            return file::mapped_data("bad", 3);
 
-        return file::binary_data{'g', 'o', 'o', 'd'};
+        return file::mapped_data("good", 4);
     });
 
-    mocks.OnCall(ctl, ioctl::call_ioctl_add_module).Do([](auto data)
+    mocks.OnCall(ctl, ioctl::call_ioctl_add_modules).Do([](const ioctl::module_list &modules)
     {
-        if (data == file::binary_data{'b', 'a', 'd'})
-            throw std::runtime_error("error");
+        for (const auto &module : modules)
+        {
+            if (std::string(module.data(), module.size()) == "bad")
+                throw std::runtime_error("error");
+        }
     });
 
+    mocks.NeverCall(ctl, ioctl::call_ioctl_load_vmm);
+
     RUN_UNITTEST_WITH_MOCKS(mocks, [&]
     {
         auto &&driver = ioctl_driver(fil, ctl, clp);
@@ -327,8 +343,8 @@ bfm_ut::test_ioctl_driver_process_load_load_failed()
     mocks.OnCall(fil, file::read_text).Do([](auto) -> auto
     { return "{\"modules\":[\"1\",\"2\",\"3\"]}"_s; });
 
-    mocks.OnCall(fil, file::read_binary).Do([](auto) -> auto
-    { return file::binary_data{'g', 'o', 'o', 'd'}; });
+    mocks.OnCall(fil, file::map_binary).Do([](auto) -> auto
+    { return file::mapped_data("good", 4); });
 
     mocks.OnCall(ctl, ioctl::call_ioctl_load_vmm).Throw(std::runtime_error("error"));
 
@@ -353,8 +369,17 @@ bfm_ut::test_ioctl_driver_process_load_success()
     mocks.OnCall(fil, file::read_text).Do([](auto) -> auto
     { return "{\"modules\":[\"1\",\"2\",\"3\"]}"_s; });
 
-    mocks.OnCall(fil, file::read_binary).Do([](auto) -> auto
-    { return file::binary_data{'g', 'o', 'o', 'd'}; });
+    mocks.OnCall(fil, file::map_binary).Do([](auto) -> auto
+    { return file::mapped_data("good", 4); });
+
+    mocks.NeverCall(ctl, ioctl::call_ioctl_add_module);
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_add_modules).Do([&](const ioctl::module_list &modules)
+    {
+        this->expect_true(modules.size() == 3);
+
+        for (const auto &module : modules)
+            this->expect_true(std::string(module.data(), module.size()) == "good");
+    });
 
     RUN_UNITTEST_WITH_MOCKS(mocks, [&]
     {
@@ -921,6 +946,42 @@ bfm_ut::test_ioctl_driver_process_vmm_status_unknown_status()
     });
 }
 
+void
+bfm_ut::test_ioctl_driver_process_invalidate_cache_success()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_UNLOADED);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::invalidate);
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_invalidate_cache);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_no_exception([&]{ driver.process(); });
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_invalidate_cache_corrupt()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_CORRUPT);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::invalidate);
+
+    mocks.NeverCall(ctl, ioctl::call_ioctl_invalidate_cache);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_exception([&]{ driver.process(); }, ""_cve);
+    });
+}
+
 void
 bfm_ut::test_ioctl_driver_process_vmcall_vmm_unloaded()
 {
@@ -1939,3 +2000,732 @@ bfm_ut::test_ioctl_driver_process_vmcall_data_binary_unformatted_success_unforma
         this->expect_no_exception([&]{ driver.process(); });
     });
 }
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_profile_start_success()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_PROFILE, 0,
+        VMCALL_PROFILE_START, 0x1000,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_no_exception([&]{ driver.process(); });
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_profile_collect_ioctl_return_failed()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_PROFILE, 0,
+        VMCALL_PROFILE_COLLECT,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        regs->r01 = 1;
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_exception([&]{ driver.process(); }, ""_ife);
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_profile_collect_out_of_range()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_PROFILE, 0,
+        VMCALL_PROFILE_COLLECT,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        regs->r03 = (regs->r09 / sizeof(vmcall_profile_sample_t)) + 1;
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_exception([&]{ driver.process(); }, ""_ut_ore);
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_profile_collect_success()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_PROFILE, 0,
+        VMCALL_PROFILE_COLLECT,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        auto samples = reinterpret_cast<vmcall_profile_sample_t *>(regs->r08);
+
+        samples[0] = {0x1000, 0x2000, 0};
+        samples[1] = {0x1000, 0x2000, 0};
+
+        regs->r03 = 2;
+        regs->r04 = 1;
+        regs->r05 = 0;
+    });
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        auto samples = reinterpret_cast<vmcall_profile_sample_t *>(regs->r08);
+
+        samples[0] = {0x3000, 0x4000, 3};
+
+        regs->r03 = 1;
+        regs->r04 = 0;
+        regs->r05 = 0;
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_no_exception([&]{ driver.process(); });
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_heap_start_success()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_HEAP, 0,
+        VMCALL_HEAP_START,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_no_exception([&]{ driver.process(); });
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_heap_collect_out_of_range()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_HEAP, 0,
+        VMCALL_HEAP_COLLECT,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        regs->r03 = (regs->r09 / sizeof(vmcall_heap_site_t)) + 1;
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_exception([&]{ driver.process(); }, ""_ut_ore);
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_heap_collect_success()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_HEAP, 0,
+        VMCALL_HEAP_COLLECT,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        auto sites = reinterpret_cast<vmcall_heap_site_t *>(regs->r08);
+
+        sites[0] = {0x1000, 2, 0x2000, 1};
+        sites[1] = {0x3000, 1, 0x40, 2};
+
+        regs->r03 = 2;
+        regs->r04 = 3;
+        regs->r05 = 0;
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_no_exception([&]{ driver.process(); });
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_heap_pools_out_of_range()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_HEAP, 0,
+        VMCALL_HEAP_POOLS,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        regs->r03 = (regs->r09 / sizeof(vmcall_heap_pool_t)) + 1;
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_exception([&]{ driver.process(); }, ""_ut_ore);
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_heap_pools_success()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_HEAP, 0,
+        VMCALL_HEAP_POOLS,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        auto pools = reinterpret_cast<vmcall_heap_pool_t *>(regs->r08);
+
+        pools[0] = {MEMORY_CHUNK_HEAP, 0x1000, 0x4000, 0x1000, 0x2000, 0x3000, 1, {100, 50, 1}};
+        pools[1] = {MEMORY_CHUNK_RESERVE, 0x10000, 0x200000, 0, 0, 0, 0, {}};
+
+        regs->r03 = 2;
+        regs->r04 = 3;
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_no_exception([&]{ driver.process(); });
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_locks_reset_success()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_LOCKS, 0,
+        VMCALL_LOCKS_RESET,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_no_exception([&]{ driver.process(); });
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_locks_collect_out_of_range()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_LOCKS, 0,
+        VMCALL_LOCKS_COLLECT,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        regs->r03 = (regs->r09 / sizeof(vmcall_lock_stats_t)) + 1;
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_exception([&]{ driver.process(); }, ""_ut_ore);
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_locks_collect_success()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_LOCKS, 0,
+        VMCALL_LOCKS_COLLECT,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        auto locks = reinterpret_cast<vmcall_lock_stats_t *>(regs->r08);
+
+        locks[0] = {"mm_arena", VMCALL_LOCK_SPINLOCK, 100, 2, 10, 0x1000};
+        locks[1] = {"vcpu_manager", VMCALL_LOCK_TICKET, 8, 0, 0, 0x200};
+
+        regs->r03 = 2;
+        regs->r04 = 3;
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_no_exception([&]{ driver.process(); });
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_dirty_start_success()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_DIRTY_LOG, 0,
+        VMCALL_DIRTY_LOG_START,
+        0x200000, 0x10000, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_no_exception([&]{ driver.process(); });
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_dirty_stream_out_of_range()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_DIRTY_LOG, 0,
+        VMCALL_DIRTY_LOG_HARVEST,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.OnCall(clp, command_line_parser::iterations).Return(1);
+    mocks.NeverCall(fil, file::write_binary);
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        regs->r09 = 0;
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_exception([&]{ driver.process(); }, ""_ut_ore);
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_dirty_stream_success()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    constexpr const auto max_words = VMCALL_OUT_BUFFER_SIZE / sizeof(uint64_t);
+    constexpr const auto pages = (max_words * 64) + 3;
+
+    auto &&firsts = std::vector<uint64_t>();
+    auto &&written = file::binary_data::size_type{0};
+    auto &&appended = file::binary_data::size_type{0};
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_DIRTY_LOG, 0,
+        VMCALL_DIRTY_LOG_HARVEST,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.OnCall(clp, command_line_parser::iterations).Return(2);
+    mocks.OnCall(fil, file::write_binary).Do([&](const file::filename_type &, const file::binary_data & data)
+    { written += data.size(); });
+    mocks.OnCall(fil, file::append_binary).Do([&](const file::filename_type &, const file::binary_data & data)
+    { appended += data.size(); });
+
+    // The range does not fit in a single window, so each pass takes two
+    // vmcalls, the second of which only returns the last word
+
+    mocks.OnCall(ctl, ioctl::call_ioctl_vmcall).Do([&](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        firsts.push_back(regs->r03);
+
+        regs->r03 = regs->r03 == 0 ? max_words * 64 : 3;
+        regs->r04 = 0x200000;
+        regs->r05 = pages;
+        regs->r09 = regs->r03 == 3 ? sizeof(uint64_t) : regs->r09;
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_no_exception([&]{ driver.process(); });
+
+        this->expect_true(firsts.size() == 4);
+        this->expect_true(firsts[0] == 0);
+        this->expect_true(firsts[1] == max_words * 64);
+        this->expect_true(written == (max_words + 1) * sizeof(uint64_t));
+        this->expect_true(appended == written);
+    });
+}
+
+static vmcall_ring_t *g_ring = nullptr;
+static uint64_t g_ring_completed = 0;
+
+static void
+fake_vmcall_ring(gsl::not_null<ioctl::registers_pointer> regs, ioctl::cpuid_type cpuid)
+{
+    (void) cpuid;
+
+    regs->r01 = 0;
+
+    if (regs->r02 == VMCALL_RING_REGISTER)
+        g_ring = reinterpret_cast<vmcall_ring_t *>(regs->r03);
+
+    if (regs->r02 != VMCALL_RING_DOORBELL)
+        return;
+
+    for (regs->r03 = 0; g_ring->sq_head != g_ring->sq_tail; regs->r03++)
+    {
+        auto &&cqe = g_ring->cq[g_ring->cq_tail++ % VMCALL_RING_NUM_ENTRIES];
+        cqe = g_ring->sq[g_ring->sq_head++ % VMCALL_RING_NUM_ENTRIES];
+
+        g_ring_completed++;
+    }
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_batch_invalid_request()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_RING,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.OnCall(fil, file::read_text).Return("4 1\n4 not_a_number\n"_s);
+    mocks.NeverCall(ctl, ioctl::call_ioctl_vmcall);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_exception([&]{ driver.process(); }, ""_ut_iae);
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_batch_too_many_registers()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_RING,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.OnCall(fil, file::read_text).Return("4 1 2 3 4 5 6 7 8 9 A B C D E F\n"_s);
+    mocks.NeverCall(ctl, ioctl::call_ioctl_vmcall);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_exception([&]{ driver.process(); }, ""_ut_ore);
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_batch_stalled()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_RING,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.OnCall(fil, file::read_text).Return("4 1\n"_s);
+    mocks.OnCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        regs->r01 = 0;
+        regs->r03 = 0;
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_exception([&]{ driver.process(); }, ""_ut_ree);
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_batch_success()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_RING,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    auto &&text = "# comment\n\n"_s;
+    for (auto i = 0; i < (VMCALL_RING_NUM_ENTRIES * 2) + 1; i++)
+        text += "4 " + std::to_string(i) + "\n";
+
+    mocks.OnCall(fil, file::read_text).Return(text);
+    mocks.OnCall(ctl, ioctl::call_ioctl_vmcall).Do(fake_vmcall_ring);
+    g_ring_completed = 0;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_no_exception([&]{ driver.process(); });
+        this->expect_true(g_ring_completed == (VMCALL_RING_NUM_ENTRIES * 2) + 1);
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_data_binary_msgpack_invalid_reply()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_DATA,
+        0, 0, 0,
+        VMCALL_DATA_BINARY_MSGPACK,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        *reinterpret_cast<char *>(regs->r08) = '\xC1';
+
+        regs->r07 = VMCALL_DATA_BINARY_MSGPACK;
+        regs->r09 = 1;
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_exception([&]{ driver.process(); }, ""_ut_iae);
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_data_binary_msgpack_success()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_DATA,
+        0, 0, 0,
+        VMCALL_DATA_BINARY_MSGPACK,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        auto &&output = bfn::msgpack::dump(json::parse("{\"msg\":\"hello world\"}"));
+        __builtin_memcpy(reinterpret_cast<char *>(regs->r08), output.data(), output.size());
+
+        regs->r07 = VMCALL_DATA_BINARY_MSGPACK;
+        regs->r09 = output.size();
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_no_exception([&]{ driver.process(); });
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_data_bench_failure()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::iterations).Return(10);
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_DATA,
+        0, 0, 0,
+        VMCALL_DATA_BINARY_MSGPACK,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    { regs->r01 = 1; });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_exception([&]{ driver.process(); }, ""_ife);
+    });
+}
+
+void
+bfm_ut::test_ioctl_driver_process_vmcall_data_bench_success()
+{
+    MockRepository mocks;
+
+    auto &&fil = setup_file(mocks);
+    auto &&ctl = setup_ioctl(mocks, VMM_RUNNING);
+    auto &&clp = setup_command_line_parser(mocks, command_line_parser::command_type::vmcall);
+
+    mocks.OnCall(clp, command_line_parser::iterations).Return(10);
+    mocks.OnCall(clp, command_line_parser::registers).Return(ioctl::registers_type
+    {
+        VMCALL_DATA,
+        0, 0, 0,
+        VMCALL_DATA_BINARY_MSGPACK,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    });
+
+    auto &&calls = 0;
+    mocks.OnCall(ctl, ioctl::call_ioctl_vmcall).Do([&](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        calls++;
+        this->expect_true(regs->r08 != 0);
+        this->expect_true(regs->r09 == VMCALL_OUT_BUFFER_SIZE);
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&driver = ioctl_driver(fil, ctl, clp);
+        this->expect_no_exception([&]{ driver.process(); });
+        this->expect_true(calls == 10);
+    });
+}
@@ -0,0 +1,204 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#include <test.h>
+
+#include <ioctl.h>
+#include <vmcall_ring.h>
+
+static auto operator"" _ife(const char *str, std::size_t len)
+{ (void)str; (void)len; return std::make_shared<bfn::ioctl_failed_error>(""); }
+
+static vmcall_ring_t *g_ring = nullptr;
+
+static void
+fake_vmcall_ring(gsl::not_null<ioctl::registers_pointer> regs, ioctl::cpuid_type cpuid)
+{
+    (void) cpuid;
+
+    regs->r01 = 0;
+
+    switch (regs->r02)
+    {
+        case VMCALL_RING_REGISTER:
+            g_ring = reinterpret_cast<vmcall_ring_t *>(regs->r03);
+            break;
+
+        case VMCALL_RING_DOORBELL:
+            regs->r03 = 0;
+
+            while (g_ring->sq_head != g_ring->sq_tail)
+            {
+                auto &&sqe = g_ring->sq[g_ring->sq_head++ % VMCALL_RING_NUM_ENTRIES];
+                auto &&cqe = g_ring->cq[g_ring->cq_tail++ % VMCALL_RING_NUM_ENTRIES];
+
+                cqe = sqe;
+                cqe.ret = sqe.regs.r00 == VMCALL_EVENT ? 0 : 1;
+
+                regs->r03++;
+            }
+            break;
+
+        case VMCALL_RING_UNREGISTER:
+            g_ring = nullptr;
+            break;
+
+        default:
+            regs->r01 = 1;
+            break;
+    }
+}
+
+static ioctl *
+setup_ioctl(MockRepository &mocks)
+{
+    auto ctl = mocks.Mock<ioctl>();
+    mocks.OnCall(ctl, ioctl::call_ioctl_vmcall).Do(fake_vmcall_ring);
+
+    return ctl;
+}
+
+static auto
+event(vmcall_ring::id_type index)
+{
+    auto &&regs = vmcall_ring::registers_type{};
+
+    regs.r00 = VMCALL_EVENT;
+    regs.r02 = index;
+
+    return regs;
+}
+
+void
+bfm_ut::test_vmcall_ring_register_failed()
+{
+    MockRepository mocks;
+    auto &&ctl = mocks.Mock<ioctl>();
+
+    mocks.ExpectCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+    {
+        regs->r01 = 1;
+    });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_exception([&]{ vmcall_ring(ctl, 0); }, ""_ife);
+    });
+}
+
+void
+bfm_ut::test_vmcall_ring_register_unregister()
+{
+    MockRepository mocks;
+    auto &&ctl = setup_ioctl(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        {
+            auto &&ring = vmcall_ring(ctl, 0);
+
+            this->expect_true(g_ring != nullptr);
+            this->expect_true((reinterpret_cast<uintptr_t>(g_ring) & 0xFFF) == 0);
+            this->expect_true(ring.pending() == 0);
+        }
+
+        this->expect_true(g_ring == nullptr);
+    });
+}
+
+void
+bfm_ut::test_vmcall_ring_submit_full()
+{
+    MockRepository mocks;
+    auto &&ctl = setup_ioctl(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ring = vmcall_ring(ctl, 0);
+
+        for (auto i = 0UL; i < VMCALL_RING_NUM_ENTRIES; i++)
+            this->expect_true(ring.submit(i, event(i)));
+
+        this->expect_false(ring.submit(VMCALL_RING_NUM_ENTRIES, event(0)));
+        this->expect_true(ring.pending() == VMCALL_RING_NUM_ENTRIES);
+
+        // Executing the requests does not free up space in the ring until
+        // the completions are reaped.
+
+        this->expect_true(ring.doorbell() == VMCALL_RING_NUM_ENTRIES);
+        this->expect_false(ring.submit(VMCALL_RING_NUM_ENTRIES, event(0)));
+        this->expect_true(ring.reap([](auto, auto, const auto &) {}) == VMCALL_RING_NUM_ENTRIES);
+        this->expect_true(ring.submit(VMCALL_RING_NUM_ENTRIES, event(0)));
+    });
+}
+
+void
+bfm_ut::test_vmcall_ring_doorbell_failed()
+{
+    MockRepository mocks;
+    auto &&ctl = setup_ioctl(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ring = vmcall_ring(ctl, 0);
+
+        mocks.OnCall(ctl, ioctl::call_ioctl_vmcall).Do([](gsl::not_null<ioctl::registers_pointer> regs, auto)
+        {
+            regs->r01 = 1;
+        });
+
+        this->expect_exception([&]{ ring.doorbell(); }, ""_ife);
+    });
+}
+
+void
+bfm_ut::test_vmcall_ring_doorbell_success()
+{
+    using result_type = std::pair<vmcall_ring::id_type, vmcall_ring::ret_type>;
+
+    MockRepository mocks;
+    auto &&ctl = setup_ioctl(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ring = vmcall_ring(ctl, 0);
+        auto &&results = std::vector<result_type>();
+
+        auto &&unknown = event(3);
+        unknown.r00 = 0xBEEF;
+
+        this->expect_true(ring.submit(1, event(1)));
+        this->expect_true(ring.submit(2, event(2)));
+        this->expect_true(ring.submit(3, unknown));
+
+        this->expect_true(ring.reap([&](auto id, auto ret, const auto &) { results.emplace_back(id, ret); }) == 0);
+        this->expect_true(ring.doorbell() == 3);
+        this->expect_true(ring.pending() == 3);
+        this->expect_true(ring.reap([&](auto id, auto ret, const auto &) { results.emplace_back(id, ret); }) == 3);
+        this->expect_true(ring.pending() == 0);
+
+        this->expect_true(results.size() == 3);
+        this->expect_true(results.at(0).first == 1 && results.at(0).second == 0);
+        this->expect_true(results.at(1).first == 2 && results.at(1).second == 0);
+        this->expect_true(results.at(2).first == 3 && results.at(2).second != 0);
+    });
+}
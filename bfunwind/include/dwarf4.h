@@ -382,6 +382,20 @@ public:
     /// @param state the current state of the registers
     ///
     static void unwind(const fd_entry &fde, register_state *state = nullptr);
+
+    /// CFI Cache Hits
+    ///
+    /// @return the number of frames that were unwound using a cached CFI
+    ///     row instead of interpreting the frame's DWARF instructions
+    ///
+    static uint64_t cfi_cache_hits();
+
+    /// CFI Cache Misses
+    ///
+    /// @return the number of frames whose CFI row had to be decoded from
+    ///     the frame's DWARF instructions (see CFI_CACHE_SIZE)
+    ///
+    static uint64_t cfi_cache_misses();
 };
 
 #endif
@@ -200,7 +200,9 @@ uint64_t decode_pointer(char **addr, uint64_t encoding);
 /// This is a pretty simple class. The entire .eh_frame ELF section exists
 /// to provide a list of FDEs that describe a specific call frame for
 /// unwinding. This class provides a means to lookup an FDE for any PC that
-/// the code might be executing from.
+/// the code might be executing from. The first lookup in a module builds a
+/// table of the module's FDEs sorted by PC, so that subsequent lookups are
+/// a binary search (see EH_FRAME_INDEX_SIZE).
 ///
 class eh_frame
 {
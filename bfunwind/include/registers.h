@@ -86,6 +86,13 @@ public:
     virtual register_state &set_ip(uint64_t value)
     { (void) value; return *this; }
 
+    /// Get Stack Pointer
+    ///
+    /// @return returns the stack pointer value
+    ///
+    virtual uint64_t get_sp() const
+    { return 0; }
+
     /// Get General Purpose Register
     ///
     /// @param index the general purpose register to get
@@ -113,6 +113,9 @@ public:
         return *this;
     }
 
+    uint64_t get_sp() const override
+    { return m_registers.rsp; }
+
     uint64_t get(uint64_t index) const override
     {
         if (index >= max_num_registers())
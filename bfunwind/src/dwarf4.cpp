@@ -1602,15 +1602,97 @@ private_parse_instructions(cfi_table_row *row,
                                   rememberIndex, rememberStack, &initialRow);
 }
 
+// -----------------------------------------------------------------------------
+// CFI Cache
+// -----------------------------------------------------------------------------
+
+// Decoding a frame's CFI re-executes the CIE's initial instructions, and the
+// FDE's instructions up to the PC, every time the frame is unwound. The
+// resulting row only depends on the PC (and its FDE), so decoded rows are
+// cached by PC. Each slot is guarded by a sequence number that is odd while
+// the slot is being written. Readers that see an odd sequence number, or one
+// that changed while the row was being copied, treat the lookup as a miss,
+// and writers that find a slot busy skip the insert, so neither side ever
+// waits. The row is stored as raw bytes so that the cache does not need a
+// constructor (an exception could be thrown before it would run).
+
+struct cfi_cache_entry
+{
+    uint64_t seq;
+    uint64_t pc;
+    char *fde;
+
+    alignas(cfi_table_row) char row[sizeof(cfi_table_row)];
+};
+
+cfi_cache_entry g_cfi_cache[CFI_CACHE_SIZE] = {};
+
+uint64_t g_cfi_cache_hits = 0;
+uint64_t g_cfi_cache_misses = 0;
+
+static cfi_cache_entry &
+cfi_cache_slot(uint64_t pc)
+{ return g_cfi_cache[((pc * 0x9E3779B97F4A7C15ULL) >> 32) % CFI_CACHE_SIZE]; }
+
+static bool
+cfi_cache_find(const fd_entry &fde, uint64_t pc, cfi_table_row *row)
+{
+    auto &entry = cfi_cache_slot(pc);
+    auto seq = __atomic_load_n(&entry.seq, __ATOMIC_ACQUIRE);
+
+    if ((seq & 1) == 0 &&
+        __atomic_load_n(&entry.pc, __ATOMIC_RELAXED) == pc &&
+        __atomic_load_n(&entry.fde, __ATOMIC_RELAXED) == fde.entry_start())
+    {
+        __builtin_memcpy(row, entry.row, sizeof(cfi_table_row));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&entry.seq, __ATOMIC_RELAXED) == seq)
+        {
+            __atomic_fetch_add(&g_cfi_cache_hits, 1, __ATOMIC_RELAXED);
+            return true;
+        }
+    }
+
+    __atomic_fetch_add(&g_cfi_cache_misses, 1, __ATOMIC_RELAXED);
+    return false;
+}
+
+static void
+cfi_cache_insert(const fd_entry &fde, uint64_t pc, const cfi_table_row &row)
+{
+    auto &entry = cfi_cache_slot(pc);
+    auto seq = __atomic_load_n(&entry.seq, __ATOMIC_RELAXED);
+
+    if ((seq & 1) != 0)
+        return;
+
+    if (!__atomic_compare_exchange_n(&entry.seq, &seq, seq + 1, false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return;
+
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    __atomic_store_n(&entry.pc, pc, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry.fde, fde.entry_start(), __ATOMIC_RELAXED);
+    __builtin_memcpy(entry.row, &row, sizeof(cfi_table_row));
+
+    __atomic_store_n(&entry.seq, seq + 2, __ATOMIC_RELEASE);
+}
+
 cfi_table_row
 private_decode_cfi(const fd_entry &fde, register_state *state)
 {
     auto row = cfi_table_row();
     const auto &cie = fde.cie();
 
+    if (cfi_cache_find(fde, state->get_ip(), &row))
+        return row;
+
     private_parse_instructions(&row, cie, fde, state, true);
     private_parse_instructions(&row, cie, fde, state, false);
 
+    cfi_cache_insert(fde, state->get_ip(), row);
     return row;
 }
 
@@ -1659,6 +1741,14 @@ dwarf4::decode_uleb128(char **addr)
     return result;
 }
 
+uint64_t
+dwarf4::cfi_cache_hits()
+{ return __atomic_load_n(&g_cfi_cache_hits, __ATOMIC_RELAXED); }
+
+uint64_t
+dwarf4::cfi_cache_misses()
+{ return __atomic_load_n(&g_cfi_cache_misses, __ATOMIC_RELAXED); }
+
 #ifndef __clang__
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
@@ -400,6 +400,188 @@ fd_entry::non_virtual_parse(char *addr)
     m_instructions = p;
 }
 
+// -----------------------------------------------------------------------------
+// FDE Index
+// -----------------------------------------------------------------------------
+
+// Walking each .eh_frame section to locate an FDE is linear in the size of
+// the VMM, and has to be done for every frame that is unwound. Instead, the
+// first lookup that touches a module builds a table of that module's FDEs
+// sorted by pc_begin (the same table that .eh_frame_hdr provides), and all
+// lookups after that are a binary search. The tables are carved out of a
+// static pool as the unwinder cannot rely on the heap. If another core is
+// building a module's table, or the pool is exhausted, the lookup falls back
+// to the linear walk.
+
+struct fde_index_entry
+{
+    uint64_t pc_begin;
+    uint32_t pc_range;
+    uint32_t offset;
+};
+
+enum fde_index_state
+{
+    fde_index_unbuilt = 0,
+    fde_index_building = 1,
+    fde_index_built = 2,
+    fde_index_unavailable = 3
+};
+
+struct fde_index
+{
+    int state;
+    eh_frame_t eh_frame;
+    fde_index_entry *entries;
+    uint64_t num;
+};
+
+fde_index g_fde_index[MAX_NUM_MODULES] = {};
+fde_index_entry g_fde_index_pool[EH_FRAME_INDEX_SIZE] = {};
+uint64_t g_fde_index_pool_num = 0;
+
+static void
+fde_index_sift_down(fde_index_entry *entries, uint64_t root, uint64_t num)
+{
+    while (root * 2 + 1 < num)
+    {
+        auto child = root * 2 + 1;
+
+        if (child + 1 < num && entries[child].pc_begin < entries[child + 1].pc_begin)
+            child++;
+
+        if (entries[root].pc_begin >= entries[child].pc_begin)
+            return;
+
+        auto tmp = entries[root];
+        entries[root] = entries[child];
+        entries[child] = tmp;
+
+        root = child;
+    }
+}
+
+static void
+fde_index_sort(fde_index_entry *entries, uint64_t num)
+{
+    for (auto i = num / 2; i > 0; i--)
+        fde_index_sift_down(entries, i - 1, num);
+
+    for (auto i = num; i > 1; i--)
+    {
+        auto tmp = entries[0];
+        entries[0] = entries[i - 1];
+        entries[i - 1] = tmp;
+
+        fde_index_sift_down(entries, 0, i - 1);
+    }
+}
+
+static bool
+fde_index_build(const eh_frame_t &eh_frame, fde_index &index)
+{
+    auto num = 0ULL;
+
+    for (auto fde = fd_entry(eh_frame); fde; ++fde)
+    {
+        if (fde.is_fde() && fde.pc_range() != 0)
+            num++;
+    }
+
+    auto start = __atomic_load_n(&g_fde_index_pool_num, __ATOMIC_RELAXED);
+
+    do
+    {
+        if (num > EH_FRAME_INDEX_SIZE - start)
+            return false;
+    }
+    while (!__atomic_compare_exchange_n(&g_fde_index_pool_num, &start, start + num,
+                                        true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    auto i = 0ULL;
+    auto entries = &g_fde_index_pool[start];
+
+    for (auto fde = fd_entry(eh_frame); fde && i < num; ++fde)
+    {
+        if (fde.is_cie() || fde.pc_range() == 0)
+            continue;
+
+        auto offset = static_cast<uint64_t>(fde.entry_start() - reinterpret_cast<char *>(eh_frame.addr));
+
+        if (fde.pc_range() > 0xFFFFFFFF || offset > 0xFFFFFFFF)
+            return false;
+
+        entries[i].pc_begin = fde.pc_begin();
+        entries[i].pc_range = static_cast<uint32_t>(fde.pc_range());
+        entries[i].offset = static_cast<uint32_t>(offset);
+
+        i++;
+    }
+
+    fde_index_sort(entries, i);
+
+    index.eh_frame = eh_frame;
+    index.entries = entries;
+    index.num = i;
+
+    return true;
+}
+
+static const fde_index *
+fde_index_get(uint64_t module, const eh_frame_t &eh_frame)
+{
+    auto &index = g_fde_index[module];
+    auto state = __atomic_load_n(&index.state, __ATOMIC_ACQUIRE);
+
+    if (state == fde_index_unbuilt)
+    {
+        if (__atomic_compare_exchange_n(&index.state, &state, fde_index_building,
+                                        false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+        {
+            state = fde_index_build(eh_frame, index) ? fde_index_built : fde_index_unavailable;
+            __atomic_store_n(&index.state, state, __ATOMIC_RELEASE);
+        }
+    }
+
+    if (state != fde_index_built)
+        return nullptr;
+
+    if (index.eh_frame.addr != eh_frame.addr || index.eh_frame.size != eh_frame.size)
+        return nullptr;
+
+    return &index;
+}
+
+static fd_entry
+fde_index_find(const fde_index &index, uint64_t pc)
+{
+    auto lo = 0ULL;
+    auto hi = index.num;
+
+    // Note that the range for the PC is not 0 indexed, so we are looking
+    // for the last FDE whose pc_begin is below the PC (see is_in_range)
+
+    while (lo < hi)
+    {
+        auto mid = lo + ((hi - lo) / 2);
+
+        if (index.entries[mid].pc_begin < pc)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == 0)
+        return fd_entry();
+
+    const auto &entry = index.entries[lo - 1];
+
+    if (pc > entry.pc_begin + entry.pc_range)
+        return fd_entry();
+
+    return fd_entry(index.eh_frame, reinterpret_cast<char *>(index.eh_frame.addr) + entry.offset);
+}
+
 // -----------------------------------------------------------------------------
 // Exception Handler Framework (eh_frame)
 // -----------------------------------------------------------------------------
@@ -407,16 +589,28 @@ fd_entry::non_virtual_parse(char *addr)
 fd_entry
 eh_frame::find_fde(register_state *state)
 {
+    auto pc = state->get_ip();
     auto eh_frame_list = get_eh_frame_list();
 
     for (auto m = 0U; m < MAX_NUM_MODULES; m++)
     {
+        if (eh_frame_list[m].addr == nullptr)
+            continue;
+
+        if (auto index = fde_index_get(m, eh_frame_list[m]))
+        {
+            if (auto fde = fde_index_find(*index, pc))
+                return fde;
+
+            continue;
+        }
+
         for (auto fde = fd_entry(eh_frame_list[m]); fde; ++fde)
         {
             if (fde.is_cie())
                 continue;
 
-            if (fde.is_in_range(state->get_ip()))
+            if (fde.is_in_range(pc))
                 return fde;
         }
     }
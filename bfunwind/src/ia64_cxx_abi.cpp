@@ -35,9 +35,16 @@ struct _Unwind_Context
     register_state *state;
     _Unwind_Exception *exception_object;
 
+    uint64_t pc_begin;
+    uint64_t lsda;
+    uint64_t personality_function;
+
     _Unwind_Context(register_state *s, _Unwind_Exception *eo) :
         state(s),
-        exception_object(eo)
+        exception_object(eo),
+        pc_begin(0),
+        lsda(0),
+        personality_function(0)
     {
     }
 };
@@ -49,7 +56,7 @@ struct _Unwind_Context
 static _Unwind_Reason_Code
 private_personality(_Unwind_Action action, _Unwind_Context *context)
 {
-    if (auto pl = context->fde.cie().personality_function())
+    if (auto pl = context->personality_function)
     {
         if (auto pr = *(reinterpret_cast<__personality_routine *>(pl)))
         {
@@ -62,6 +69,161 @@ private_personality(_Unwind_Action action, _Unwind_Context *context)
     return _URC_CONTINUE_UNWIND;
 }
 
+// -----------------------------------------------------------------------------
+// Scratch
+// -----------------------------------------------------------------------------
+
+// Phase 1 and phase 2 walk the same frames, from the throw to the handler.
+// While phase 1 searches for the handler, it records each frame's register
+// state, and the FDE information that the personality routine needs, in a
+// scratch buffer that is attached to the exception (private_2). Phase 2
+// then replays these frames instead of locating and decoding them a second
+// time. The scratch buffer also remembers the next frame that phase 2
+// expects, so that an _Unwind_Resume picks the replay back up once it has
+// unwound the frame that the cleanup code ran in. Scratch buffers come from
+// a static pool, as the unwinder cannot rely on the heap. If the pool is
+// empty, or there are more frames than a buffer can hold, the remaining
+// frames are simply unwound again.
+
+struct unwind_frame
+{
+    uint64_t ip;
+    uint64_t sp;
+
+    uint64_t pc_begin;
+    uint64_t lsda;
+    uint64_t personality_function;
+
+    eh_frame_t eh_frame;
+    char *fde;
+
+    uint64_t registers[MAX_NUM_REGISTERS];
+};
+
+struct unwind_scratch
+{
+    uint64_t num;
+    uint64_t next;
+
+    unwind_frame frames[UNWIND_SCRATCH_FRAMES];
+};
+
+static_assert(UNWIND_SCRATCH_POOL_SIZE <= 64, "UNWIND_SCRATCH_POOL_SIZE must be <= 64");
+
+unwind_scratch g_unwind_scratch_pool[UNWIND_SCRATCH_POOL_SIZE] = {};
+uint64_t g_unwind_scratch_pool_used = 0;
+
+static unwind_scratch *
+private_scratch(_Unwind_Exception *exception_object)
+{ return reinterpret_cast<unwind_scratch *>(exception_object->private_2); }
+
+static void
+private_scratch_alloc(_Unwind_Exception *exception_object)
+{
+    auto used = __atomic_load_n(&g_unwind_scratch_pool_used, __ATOMIC_RELAXED);
+
+    exception_object->private_2 = 0;
+
+    while (true)
+    {
+        auto available = ~used;
+
+        if (UNWIND_SCRATCH_POOL_SIZE < 64)
+            available &= (1ULL << UNWIND_SCRATCH_POOL_SIZE) - 1;
+
+        if (available == 0)
+            return;
+
+        auto index = static_cast<uint64_t>(__builtin_ctzll(available));
+
+        if (__atomic_compare_exchange_n(&g_unwind_scratch_pool_used, &used, used | (1ULL << index),
+                                        true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            g_unwind_scratch_pool[index].num = 0;
+            g_unwind_scratch_pool[index].next = 0;
+
+            exception_object->private_2 = reinterpret_cast<uint64_t>(&g_unwind_scratch_pool[index]);
+            return;
+        }
+    }
+}
+
+static void
+private_scratch_free(_Unwind_Exception *exception_object)
+{
+    auto scratch = private_scratch(exception_object);
+
+    if (scratch == nullptr)
+        return;
+
+    auto index = static_cast<uint64_t>(scratch - g_unwind_scratch_pool);
+    __atomic_fetch_and(&g_unwind_scratch_pool_used, ~(1ULL << index), __ATOMIC_RELEASE);
+
+    exception_object->private_2 = 0;
+}
+
+static void
+private_scratch_record(_Unwind_Context *context)
+{
+    auto scratch = private_scratch(context->exception_object);
+
+    if (scratch == nullptr || scratch->num >= UNWIND_SCRATCH_FRAMES)
+        return;
+
+    auto &frame = scratch->frames[scratch->num++];
+
+    frame.ip = context->state->get_ip();
+    frame.sp = context->state->get_sp();
+
+    frame.pc_begin = context->pc_begin;
+    frame.lsda = context->lsda;
+    frame.personality_function = context->personality_function;
+
+    frame.eh_frame = context->fde.eh_frame();
+    frame.fde = context->fde.entry_start();
+
+    for (auto i = 0U; i < context->state->max_num_registers(); i++)
+        frame.registers[i] = context->state->get(i);
+}
+
+static const unwind_frame *
+private_scratch_replay(_Unwind_Context *context)
+{
+    auto scratch = private_scratch(context->exception_object);
+
+    if (scratch == nullptr || scratch->next >= scratch->num)
+        return nullptr;
+
+    const auto &frame = scratch->frames[scratch->next];
+
+    if (frame.ip != context->state->get_ip() || frame.sp != context->state->get_sp())
+        return nullptr;
+
+    context->pc_begin = frame.pc_begin;
+    context->lsda = frame.lsda;
+    context->personality_function = frame.personality_function;
+
+    scratch->next++;
+    return &frame;
+}
+
+static bool
+private_scratch_replay_unwind(_Unwind_Context *context)
+{
+    auto scratch = private_scratch(context->exception_object);
+
+    if (scratch->next >= scratch->num)
+        return false;
+
+    const auto &frame = scratch->frames[scratch->next];
+
+    for (auto i = 0U; i < context->state->max_num_registers(); i++)
+        context->state->set(i, frame.registers[i]);
+
+    context->state->commit();
+    return true;
+}
+
 // -----------------------------------------------------------------------------
 // Implementation
 // -----------------------------------------------------------------------------
@@ -72,6 +234,10 @@ find_and_store_fde(_Unwind_Context *context)
     if (!(context->fde = eh_frame::find_fde(context->state)))
         return _URC_END_OF_STACK;
 
+    context->pc_begin = context->fde.pc_begin();
+    context->lsda = context->fde.lsda();
+    context->personality_function = context->fde.cie().personality_function();
+
     return _URC_CONTINUE_UNWIND;
 }
 
@@ -92,10 +258,12 @@ private_phase1(_Unwind_Context *context)
         if (result != _URC_CONTINUE_UNWIND)
             return result;
 
+        private_scratch_record(context);
+
         switch (private_personality(_UA_SEARCH_PHASE, context))
         {
             case _URC_HANDLER_FOUND:
-                context->exception_object->private_1 = context->fde.pc_begin();
+                context->exception_object->private_1 = context->pc_begin;
                 return _URC_NO_REASON;
 
             case _URC_CONTINUE_UNWIND:
@@ -123,17 +291,24 @@ private_phase2(_Unwind_Context *context)
     while (true)
     {
         auto action = _UA_CLEANUP_PHASE;
+        auto frame = private_scratch_replay(context);
 
-        result = find_and_store_fde(context);
-        if (result != _URC_CONTINUE_UNWIND)
-            return result;
+        if (frame == nullptr)
+        {
+            result = find_and_store_fde(context);
+            if (result != _URC_CONTINUE_UNWIND)
+                return result;
+        }
 
-        if (context->exception_object->private_1 == context->fde.pc_begin())
+        if (context->exception_object->private_1 == context->pc_begin)
             action |= _UA_HANDLER_FRAME;
 
         switch (private_personality(action, context))
         {
             case _URC_INSTALL_CONTEXT:
+                if ((action & _UA_HANDLER_FRAME) != 0)
+                    private_scratch_free(context->exception_object);
+
                 context->state->resume(); __builtin_unreachable();
 
             case _URC_CONTINUE_UNWIND:
@@ -143,6 +318,14 @@ private_phase2(_Unwind_Context *context)
                 ABORT("phase 2 personality routine failed");
         }
 
+        if (frame != nullptr)
+        {
+            if (private_scratch_replay_unwind(context))
+                continue;
+
+            context->fde = fd_entry(frame->eh_frame, frame->fde);
+        }
+
         dwarf4::unwind(context->fde, context->state);
     }
 }
@@ -156,19 +339,24 @@ _Unwind_RaiseException(_Unwind_Exception *exception_object)
     __store_registers_intel_x64(&registers);
 
     exception_object->private_1 = 0;
-    exception_object->private_2 = 0;
+    private_scratch_alloc(exception_object);
 
     auto state = register_state_intel_x64(registers);
     auto context = _Unwind_Context(&state, exception_object);
 
     ret = private_phase1(&context);
     if (ret != _URC_NO_REASON)
+    {
+        private_scratch_free(exception_object);
         return ret;
+    }
 
     state = register_state_intel_x64(registers);
     context = _Unwind_Context(&state, exception_object);
 
     ret = private_phase2(&context);
+    private_scratch_free(exception_object);
+
     if (ret != _URC_NO_REASON)
         return ret;
 
@@ -190,6 +378,8 @@ _Unwind_Resume(_Unwind_Exception *exception_object)
 extern "C" void
 _Unwind_DeleteException(_Unwind_Exception *exception_object)
 {
+    private_scratch_free(exception_object);
+
     if (exception_object->exception_cleanup != nullptr)
         (*exception_object->exception_cleanup)(_URC_FOREIGN_EXCEPTION_CAUGHT,
                                                exception_object);
@@ -224,13 +414,13 @@ _Unwind_SetIP(_Unwind_Context *context, uintptr_t value)
 extern "C" uintptr_t
 _Unwind_GetLanguageSpecificData(_Unwind_Context *context)
 {
-    return context->fde.lsda();
+    return context->lsda;
 }
 
 extern "C" uintptr_t
 _Unwind_GetRegionStart(_Unwind_Context *context)
 {
-    return context->fde.pc_begin();
+    return context->pc_begin;
 }
 
 extern "C" uintptr_t
@@ -137,6 +137,15 @@ bool bfunwind_ut::list()
     this->test_catch_nested_throw_uncaught();
     this->test_catch_nested_throw_rethrow();
     this->test_catch_throw_with_lots_of_register_mods();
+    this->test_catch_throw_by_call_depth();
+    this->test_catch_cfi_cache_hits();
+
+    return true;
+}
+
+bool bfunwind_ut::benchmark()
+{
+    this->benchmark_catch_latency_by_call_depth();
 
     return true;
 }
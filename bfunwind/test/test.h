@@ -37,6 +37,7 @@ protected:
     bool init() override;
     bool fini() override;
     bool list() override;
+    bool benchmark() override;
 
 private:
 
@@ -55,6 +56,10 @@ private:
     void test_catch_nested_throw_uncaught();
     void test_catch_nested_throw_rethrow();
     void test_catch_throw_with_lots_of_register_mods();
+    void test_catch_throw_by_call_depth();
+    void test_catch_cfi_cache_hits();
+
+    void benchmark_catch_latency_by_call_depth();
 
 private:
 
@@ -21,6 +21,9 @@
 
 #include <test.h>
 #include <string>
+#include <chrono>
+#include <iostream>
+#include <dwarf4.h>
 #include <exception.h>
 
 enum throw_type
@@ -68,6 +71,20 @@ void
 throw_custom_exception_func()
 { throw bfn::general_exception(); }
 
+void
+throw_at_depth(int depth)
+{
+    raii r;
+
+    if (depth < 0)
+        return;
+
+    if (depth == 0)
+        throw_exception_func();
+
+    throw_at_depth(depth - 1);
+}
+
 std::ostream &operator<<(std::ostream &os, const raii &unused)
 {
     (void) unused;
@@ -494,3 +511,95 @@ bfunwind_ut::test_catch_throw_with_lots_of_register_mods()
     this->expect_true(r16 == 6);
     this->expect_true(r17 == 7);
 }
+
+void
+bfunwind_ut::test_catch_throw_by_call_depth()
+{
+    constexpr const auto iterations = 100;
+
+    for (auto depth : {1, 8, 32, 128})
+    {
+        auto caught = 0;
+        g_raii_count = 0;
+
+        for (auto i = 0; i < iterations; i++)
+        {
+            try
+            {
+                throw_at_depth(depth);
+            }
+            catch (std::exception &e)
+            {
+                caught++;
+            }
+        }
+
+        this->expect_true(caught == iterations);
+        this->expect_true(g_raii_count == iterations * (depth + 1));
+    }
+}
+
+void
+bfunwind_ut::test_catch_cfi_cache_hits()
+{
+    auto caught = 0;
+
+    for (auto i = 0; i < 2; i++)
+    {
+        try
+        {
+            throw_at_depth(4);
+        }
+        catch (std::exception &e)
+        {
+            caught++;
+        }
+    }
+
+    auto hits = dwarf4::cfi_cache_hits();
+
+    try
+    {
+        throw_at_depth(4);
+    }
+    catch (std::exception &e)
+    {
+        caught++;
+    }
+
+    this->expect_true(caught == 3);
+    this->expect_true(dwarf4::cfi_cache_hits() > hits);
+}
+
+void
+bfunwind_ut::benchmark_catch_latency_by_call_depth()
+{
+    constexpr const auto iterations = 100;
+
+    for (auto depth : {1, 8, 32, 128})
+    {
+        auto caught = 0;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (auto i = 0; i < iterations; i++)
+        {
+            try
+            {
+                throw_at_depth(depth);
+            }
+            catch (std::exception &e)
+            {
+                caught++;
+            }
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        std::cout << "throw / catch at depth " << depth << ": "
+                  << ns / iterations << " ns" << std::endl;
+
+        this->expect_true(caught == iterations);
+    }
+}
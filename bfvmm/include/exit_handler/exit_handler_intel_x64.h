@@ -22,12 +22,15 @@
 #ifndef EXIT_HANDLER_INTEL_X64_H
 #define EXIT_HANDLER_INTEL_X64_H
 
+#include <map>
 #include <memory>
 
 #include <json.h>
 #include <vmcall_interface.h>
 #include <vmcs/vmcs_intel_x64.h>
 #include <memory_manager/map_ptr_x64.h>
+#include <exit_handler/guest_profiler_intel_x64.h>
+#include <exit_handler/pml_intel_x64.h>
 
 // -----------------------------------------------------------------------------
 // Exit Handler
@@ -104,6 +107,24 @@ public:
     ///
     virtual void complete_vmcall(ret_type ret, vmcall_registers_t &regs) noexcept;
 
+    /// Invalidate Address Space
+    ///
+    /// Releases any vmcall ring and registered data buffers that were
+    /// registered by the provided address space. While anything is
+    /// registered, CR3 loads are trapped, and this is called when a CR3 is
+    /// loaded that no longer maps the registered buffers to the pages that
+    /// were registered (i.e. the address space was torn down, and its page
+    /// tables reused). Extensions that can detect teardown sooner (e.g. on
+    /// process exit) can also call this directly. Registrations are also
+    /// validated against the guest's CR3 on use.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param cr3 the address space to invalidate
+    ///
+    virtual void invalidate_address_space(uintptr_t cr3) noexcept;
+
 protected:
 
     virtual void handle_exit(intel_x64::vmcs::value_type reason);
@@ -115,14 +136,57 @@ protected:
     void handle_rdmsr();
     void handle_wrmsr();
 
+    virtual void handle_preemption_timer();
+    virtual void handle_pml_full();
+    virtual void handle_control_register_access();
+
+    void handle_mov_to_cr3(uintptr_t cr3);
+    void update_cr3_load_exiting() noexcept;
+
     void advance_rip() noexcept;
     void unimplemented_handler() noexcept;
 
+    void dispatch_vmcall(vmcall_registers_t &regs);
+    std::size_t process_vmcall_ring();
+    void poll_vmcall_ring() noexcept;
+
+    void dispatch_vmcall_data(
+        vmcall_registers_t &regs,
+        const bfn::unique_map_ptr_x64<char> &imap,
+        const bfn::unique_map_ptr_x64<char> &omap);
+
     virtual void handle_vmcall_versions(vmcall_registers_t &regs);
     virtual void handle_vmcall_registers(vmcall_registers_t &regs);
     virtual void handle_vmcall_data(vmcall_registers_t &regs);
     virtual void handle_vmcall_event(vmcall_registers_t &regs);
+    virtual void handle_vmcall_profile(vmcall_registers_t &regs);
+    virtual void handle_vmcall_ring(vmcall_registers_t &regs);
+    virtual void handle_vmcall_data_register(vmcall_registers_t &regs);
+    virtual void handle_vmcall_data_unregister(vmcall_registers_t &regs);
+    virtual void handle_vmcall_heap(vmcall_registers_t &regs);
     virtual void handle_vmcall_unittest(vmcall_registers_t &regs);
+    virtual void handle_vmcall_locks(vmcall_registers_t &regs);
+    virtual void handle_vmcall_dirty_log(vmcall_registers_t &regs);
+
+    /// Handle VMCall Data (Span)
+    ///
+    /// Called for each VMCALL_DATA with the guest's mapped input and output
+    /// buffers. ibuf is exactly in_size bytes, and obuf is exactly out_size
+    /// bytes. The handler writes its reply into obuf in place, and then sets
+    /// regs.r07 to the output type, and regs.r09 to the number of bytes
+    /// written. Extensions that override this function avoid the heap
+    /// allocations and copies made by the string / json adapters below,
+    /// which the default implementation dispatches to based on regs.r04.
+    ///
+    /// @expects none
+    /// @ensures regs.r09 <= obuf.size()
+    ///
+    /// @param regs the vmcall's registers
+    /// @param ibuf the guest's input buffer
+    /// @param obuf the guest's output buffer
+    ///
+    virtual void handle_vmcall_data_span(
+        vmcall_registers_t &regs, gsl::span<const char> ibuf, gsl::span<char> obuf);
 
     virtual void handle_vmcall_data_string_unformatted(
         const std::string &istr, std::string &ostr);
@@ -130,17 +194,20 @@ protected:
     virtual void handle_vmcall_data_string_json(
         const json &ijson, json &ojson);
 
+    virtual void handle_vmcall_data_binary_msgpack(
+        const json &ijson, json &ojson);
+
     virtual void handle_vmcall_data_binary_unformatted(
-        const bfn::unique_map_ptr_x64<char> &imap,
-        const bfn::unique_map_ptr_x64<char> &omap);
+        gsl::span<const char> ibuf, gsl::span<char> obuf);
 
     void reply_with_string(
-        vmcall_registers_t &regs, const std::string &str,
-        const bfn::unique_map_ptr_x64<char> &omap);
+        vmcall_registers_t &regs, const std::string &str, gsl::span<char> obuf);
 
     void reply_with_json(
-        vmcall_registers_t &regs, const json &str,
-        const bfn::unique_map_ptr_x64<char> &omap);
+        vmcall_registers_t &regs, const json &obj, gsl::span<char> obuf);
+
+    void reply_with_msgpack(
+        vmcall_registers_t &regs, const json &obj, gsl::span<char> obuf);
 
 public:
 
@@ -150,6 +217,32 @@ public:
 
     vmcs_intel_x64 *m_vmcs;
     state_save_intel_x64 *m_state_save;
+    guest_profiler_intel_x64 m_profiler;
+    pml_intel_x64 m_pml;
+
+    bfn::unique_map_ptr_x64<vmcall_ring_t> m_ring;
+    uintptr_t m_ring_cr3;
+    uintptr_t m_ring_flags;
+    uintptr_t m_ring_virt;
+    uintptr_t m_ring_phys;
+
+    struct data_registration
+    {
+        uintptr_t uuid1;
+        uintptr_t uuid2;
+        uintptr_t cr3;
+
+        uintptr_t ivirt;
+        uintptr_t iphys;
+        uintptr_t ovirt;
+        uintptr_t ophys;
+
+        bfn::unique_map_ptr_x64<char> imap;
+        bfn::unique_map_ptr_x64<char> omap;
+    };
+
+    std::map<uintptr_t, data_registration> m_data_registrations;
+    uintptr_t m_next_data_handle;
 
     virtual void set_vmcs(gsl::not_null<vmcs_intel_x64 *> vmcs)
     { m_vmcs = vmcs; }
@@ -175,6 +268,13 @@ private:
     void unittest_1101_io_manipulators() const;
 #endif
 
+public:
+
+    exit_handler_intel_x64(exit_handler_intel_x64 &&) = default;
+    exit_handler_intel_x64 &operator=(exit_handler_intel_x64 &&) = default;
+
+    exit_handler_intel_x64(const exit_handler_intel_x64 &) = delete;
+    exit_handler_intel_x64 &operator=(const exit_handler_intel_x64 &) = delete;
 };
 
 #endif
@@ -0,0 +1,181 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef GUEST_PROFILER_INTEL_X64_H
+#define GUEST_PROFILER_INTEL_X64_H
+
+#include <memory>
+
+#include <gsl/gsl>
+
+#include <constants.h>
+#include <vmcall_interface.h>
+
+// -----------------------------------------------------------------------------
+// Guest Profiler
+// -----------------------------------------------------------------------------
+
+/// Guest Profiler
+///
+/// The guest profiler is a simple sampling profiler that uses the VMX
+/// preemption timer to periodically interrupt the guest. Each time the timer
+/// expires, the exit handler asks the profiler to record the guest's RIP,
+/// CR3 and CPL into a sample buffer that is owned by the vCPU. The samples
+/// can later be collected using the profile vmcall and symbolized outside
+/// of the VMM, which means the guest does not need any agent installed.
+///
+/// Note that the profiler must only be started / stopped while the vCPU's
+/// VMCS is loaded (i.e. from the exit handler), as it modifies the VMCS
+/// directly. Also note that the sample buffer is allocated when the profiler
+/// is started so that the preemption timer exit never touches the heap.
+///
+class guest_profiler_intel_x64
+{
+public:
+
+    using period_type = uint64_t;
+    using size_type = std::size_t;
+    using sample_type = vmcall_profile_sample_t;
+
+    /// Default Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    guest_profiler_intel_x64() noexcept;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    virtual ~guest_profiler_intel_x64() = default;
+
+    /// Start
+    ///
+    /// Arms the VMX preemption timer with the provided period and starts
+    /// recording samples. If the profiler is already running, the period is
+    /// updated, and existing samples are kept.
+    ///
+    /// @expects period != 0
+    /// @ensures is_running() == true
+    ///
+    /// @param period the number of preemption timer ticks between samples
+    ///
+    virtual void start(period_type period);
+
+    /// Stop
+    ///
+    /// Disarms the VMX preemption timer. Samples that have already been
+    /// recorded remain in the sample buffer until they are collected.
+    ///
+    /// @expects none
+    /// @ensures is_running() == false
+    ///
+    virtual void stop();
+
+    /// Sample
+    ///
+    /// Records a sample, and re-arms the VMX preemption timer. This should
+    /// be called by the exit handler when the VMX preemption timer expires.
+    /// If the sample buffer is full, the sample is dropped.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param rip the guest's instruction pointer
+    ///
+    virtual void sample(uint64_t rip);
+
+    /// Collect
+    ///
+    /// Removes up to samples.size() samples from the sample buffer (oldest
+    /// first), and copies them into the provided span.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param samples the span to copy the samples into
+    /// @return the number of samples that were copied
+    ///
+    virtual size_type collect(gsl::span<sample_type> samples) noexcept;
+
+    /// Is Running
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if the profiler is currently recording samples
+    ///
+    bool is_running() const noexcept
+    { return m_period != 0; }
+
+    /// Period
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the current sample period, 0 if the profiler is stopped
+    ///
+    period_type period() const noexcept
+    { return m_period; }
+
+    /// Number of Samples
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of samples waiting to be collected
+    ///
+    size_type num_samples() const noexcept
+    { return m_num; }
+
+    /// Number of Dropped Samples
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of samples that were dropped because the sample
+    ///     buffer was full
+    ///
+    size_type num_dropped() const noexcept
+    { return m_dropped; }
+
+private:
+
+    period_type m_period;
+
+    size_type m_head;
+    size_type m_num;
+    size_type m_dropped;
+
+    std::unique_ptr<sample_type[]> m_samples;
+
+public:
+
+    guest_profiler_intel_x64(guest_profiler_intel_x64 &&) = default;
+    guest_profiler_intel_x64 &operator=(guest_profiler_intel_x64 &&) = default;
+
+    guest_profiler_intel_x64(const guest_profiler_intel_x64 &) = delete;
+    guest_profiler_intel_x64 &operator=(const guest_profiler_intel_x64 &) = delete;
+};
+
+#endif
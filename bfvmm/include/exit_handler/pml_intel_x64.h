@@ -0,0 +1,165 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef PML_INTEL_X64_H
+#define PML_INTEL_X64_H
+
+#include <memory>
+
+#include <gsl/gsl>
+
+#include <memory_manager/dirty_log_intel_x64.h>
+
+// -----------------------------------------------------------------------------
+// Page Modification Log
+// -----------------------------------------------------------------------------
+
+/// Page Modification Log (PML)
+///
+/// With PML enabled (which requires EPT, with the EPT's accessed and dirty
+/// flags enabled), each time the CPU sets the dirty flag of an EPT entry,
+/// it also writes the guest physical address that was written to into a
+/// 512 entry buffer that is owned by the vCPU, so that writes can be
+/// tracked without write protecting pages. The CPU fills the buffer from
+/// the last entry down, decrementing the guest PML index as it goes, and
+/// once the buffer is full, the next logged write causes a "PML full" VM
+/// exit, after which the exit handler flushes the buffer into the dirty log
+/// (see dirty_log_intel_x64), and resets the index.
+///
+/// The dirty log is shared by all vCPUs. When its generation changes
+/// (i.e. EPT dirty flags were cleared by a harvest, or the log was started
+/// or stopped), sync() flushes the buffer and invalidates the EPT's cached
+/// translations, so that the CPU sets the cleared dirty flags (and logs the
+/// pages) again, and then tells the dirty log that it has synced. Until
+/// every vCPU that has PML enabled has synced, the pages that were cleared
+/// are reported again by each harvest (see dirty_log_intel_x64).
+///
+/// Note that PML must only be enabled / disabled while the vCPU's VMCS is
+/// loaded (i.e. from the exit handler), as it modifies the VMCS directly.
+///
+class pml_intel_x64
+{
+public:
+
+    using integer_pointer = uintptr_t;
+    using size_type = std::size_t;
+    using generation_type = dirty_log_intel_x64::generation_type;
+
+    /// Default Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    pml_intel_x64() noexcept;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    virtual ~pml_intel_x64() = default;
+
+    /// Enable
+    ///
+    /// Enables the EPT's accessed and dirty flags, and PML. The PML buffer
+    /// is allocated the first time PML is enabled. Does nothing if PML is
+    /// already enabled.
+    ///
+    /// @expects EPT is enabled, and the CPU supports PML and the EPT's
+    ///     accessed and dirty flags
+    /// @ensures is_enabled() == true
+    ///
+    virtual void enable();
+
+    /// Disable
+    ///
+    /// Flushes the PML buffer, and disables PML and the EPT's accessed and
+    /// dirty flags.
+    ///
+    /// @expects none
+    /// @ensures is_enabled() == false
+    ///
+    virtual void disable();
+
+    /// Flush
+    ///
+    /// Logs the entries in the PML buffer into the dirty log, and resets
+    /// the guest PML index. This should be called by the exit handler when
+    /// the PML buffer is full.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    virtual void flush();
+
+    /// Sync
+    ///
+    /// If the dirty log's generation has changed since the last sync,
+    /// flushes the PML buffer, and invalidates the EPT's cached
+    /// translations. If the dirty log was stopped, PML is disabled.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    virtual void sync();
+
+    /// Is Enabled
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if PML is enabled
+    ///
+    bool is_enabled() const noexcept
+    { return m_enabled; }
+
+    /// Number of Logged Entries
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of PML entries that have been logged into the
+    ///     dirty log
+    ///
+    size_type num_logged() const noexcept
+    { return m_logged; }
+
+private:
+
+    bool m_enabled;
+    size_type m_logged;
+    generation_type m_generation;
+
+    std::unique_ptr<integer_pointer[]> m_buffer;
+    integer_pointer m_buffer_phys;
+
+public:
+
+    friend class exit_handler_intel_x64_ut;
+
+    pml_intel_x64(pml_intel_x64 &&) = default;
+    pml_intel_x64 &operator=(pml_intel_x64 &&) = default;
+
+    pml_intel_x64(const pml_intel_x64 &) = delete;
+    pml_intel_x64 &operator=(const pml_intel_x64 &) = delete;
+};
+
+#endif
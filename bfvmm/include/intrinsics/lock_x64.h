@@ -0,0 +1,736 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef LOCK_X64_H
+#define LOCK_X64_H
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+// *INDENT-OFF*
+
+namespace x64
+{
+namespace lock
+{
+    using name_type = const char *;
+    using type_type = uint64_t;
+    using count_type = uint64_t;
+    using cycles_type = uint64_t;
+
+    constexpr const type_type spinlock = 1;
+    constexpr const type_type ticket = 2;
+    constexpr const type_type mcs = 3;
+    constexpr const type_type rw = 4;
+
+    /// Maximum number of pause instructions that the backoff of a
+    /// spinlock will execute between two attempts to take the lock
+    ///
+    constexpr const count_type max_backoff = 1024;
+
+    inline void pause() noexcept
+    { __builtin_ia32_pause(); }
+
+    inline cycles_type cycles() noexcept
+    { return __builtin_ia32_rdtsc(); }
+}
+}
+
+// *INDENT-ON*
+
+namespace x64
+{
+
+/// Lock Statistics
+///
+/// Each lock in this file has a lock_stats. If the lock is given a name,
+/// the lock_stats registers itself with the lock report (see lock_report)
+/// and records the number of times the lock was acquired, how many of
+/// those acquisitions had to wait, the total number of times the CPU
+/// spun while waiting, and the longest time (in TSC cycles) that the lock
+/// was held exclusively. Unnamed locks do not record anything, and can
+/// be constant initialized. A lock whose storage is still zero (i.e. a
+/// global whose constructor has not run yet) is an unlocked, unnamed lock,
+/// so the memory manager's locks can be named even though the heap is used
+/// before the memory manager's global constructors are run.
+///
+/// Note that the registry that backs the lock report does not allocate
+/// memory, so it is safe to name the locks that protect the heap.
+///
+class lock_stats
+{
+public:
+
+    using name_type = lock::name_type;
+    using type_type = lock::type_type;
+    using count_type = lock::count_type;
+    using cycles_type = lock::cycles_type;
+
+    /// Default Constructor
+    ///
+    /// Creates a lock_stats that does not record anything
+    ///
+    /// @expects none
+    /// @ensures enabled() == false
+    ///
+    constexpr lock_stats() noexcept = default;
+
+    /// Named Constructor
+    ///
+    /// Creates a lock_stats that records the statistics of its lock, and
+    /// adds it to the lock report. If name is a nullptr, this is the same
+    /// as the default constructor.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param name the name of the lock (must outlive the lock)
+    /// @param type the type of the lock (one of x64::lock::*)
+    ///
+    lock_stats(name_type name, type_type type) noexcept;
+
+    /// Destructor
+    ///
+    /// Removes the lock_stats from the lock report
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~lock_stats();
+
+    /// Enabled
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if this lock_stats records statistics
+    ///
+    bool enabled() const noexcept
+    { return m_name != nullptr; }
+
+    /// Acquired
+    ///
+    /// Records an acquisition of the lock. An acquisition with spins != 0
+    /// is counted as contended.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param spins the number of times the CPU spun while waiting
+    ///
+    void acquired(count_type spins) noexcept
+    {
+        if (!enabled())
+            return;
+
+        m_acquisitions.fetch_add(1, std::memory_order_relaxed);
+
+        if (spins == 0)
+            return;
+
+        m_contended.fetch_add(1, std::memory_order_relaxed);
+        m_spins.fetch_add(spins, std::memory_order_relaxed);
+    }
+
+    /// Hold
+    ///
+    /// Marks the start of an exclusive hold. Must be called with the lock
+    /// held exclusively.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void hold() noexcept
+    {
+        if (enabled())
+            m_hold_start = lock::cycles();
+    }
+
+    /// Release
+    ///
+    /// Marks the end of an exclusive hold, and records the time that the
+    /// lock was held if it is the longest hold seen so far. Must be called
+    /// before the lock is released.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void release() noexcept
+    {
+        if (!enabled())
+            return;
+
+        auto &&held = lock::cycles() - m_hold_start;
+
+        if (held > m_max_hold.load(std::memory_order_relaxed))
+            m_max_hold.store(held, std::memory_order_relaxed);
+    }
+
+    /// Reset
+    ///
+    /// Clears the recorded statistics.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void reset() noexcept
+    {
+        m_acquisitions.store(0, std::memory_order_relaxed);
+        m_contended.store(0, std::memory_order_relaxed);
+        m_spins.store(0, std::memory_order_relaxed);
+        m_max_hold.store(0, std::memory_order_relaxed);
+    }
+
+    name_type name() const noexcept
+    { return m_name; }
+
+    type_type type() const noexcept
+    { return m_type; }
+
+    count_type acquisitions() const noexcept
+    { return m_acquisitions.load(std::memory_order_relaxed); }
+
+    count_type contended() const noexcept
+    { return m_contended.load(std::memory_order_relaxed); }
+
+    count_type spins() const noexcept
+    { return m_spins.load(std::memory_order_relaxed); }
+
+    cycles_type max_hold() const noexcept
+    { return m_max_hold.load(std::memory_order_relaxed); }
+
+private:
+
+    name_type m_name{nullptr};
+    type_type m_type{0};
+
+    std::atomic<count_type> m_acquisitions{0};
+    std::atomic<count_type> m_contended{0};
+    std::atomic<count_type> m_spins{0};
+    std::atomic<cycles_type> m_max_hold{0};
+
+    cycles_type m_hold_start{0};
+
+    lock_stats *m_prev{nullptr};
+    lock_stats *m_next{nullptr};
+
+    friend class lock_registry;
+
+public:
+
+    lock_stats(lock_stats &&) noexcept = delete;
+    lock_stats &operator=(lock_stats &&) noexcept = delete;
+
+    lock_stats(const lock_stats &) = delete;
+    lock_stats &operator=(const lock_stats &) = delete;
+};
+
+/// Spinlock
+///
+/// A test-and-test-and-set lock. While the lock is held, waiters spin on
+/// a read of the lock (which stays in their cache) and back off
+/// exponentially (up to lock::max_backoff pause instructions) between
+/// attempts, which keeps the cache line from bouncing between CPUs. This
+/// lock is not fair. It is the cheapest lock when the lock is rarely
+/// contended.
+///
+/// Meets the BasicLockable and Lockable requirements, so it can be used
+/// with std::lock_guard and std::unique_lock.
+///
+class spinlock
+{
+public:
+
+    constexpr spinlock() noexcept = default;
+
+    /// Named Constructor
+    ///
+    /// @param name the name of the lock in the lock report
+    ///
+    explicit spinlock(lock::name_type name) noexcept :
+        m_stats(name, lock::spinlock)
+    { }
+
+    ~spinlock() = default;
+
+    void lock() noexcept
+    {
+        lock::count_type spins = 0;
+        lock::count_type backoff = 1;
+
+        while (m_locked.exchange(true, std::memory_order_acquire))
+        {
+            do
+            {
+                for (auto i = 0ULL; i < backoff; i++)
+                    lock::pause();
+
+                spins += backoff;
+                backoff = backoff < lock::max_backoff ? backoff << 1 : backoff;
+            }
+            while (m_locked.load(std::memory_order_relaxed));
+        }
+
+        m_stats.acquired(spins);
+        m_stats.hold();
+    }
+
+    bool try_lock() noexcept
+    {
+        if (m_locked.load(std::memory_order_relaxed))
+            return false;
+
+        if (m_locked.exchange(true, std::memory_order_acquire))
+            return false;
+
+        m_stats.acquired(0);
+        m_stats.hold();
+
+        return true;
+    }
+
+    void unlock() noexcept
+    {
+        m_stats.release();
+        m_locked.store(false, std::memory_order_release);
+    }
+
+    const lock_stats &stats() const noexcept
+    { return m_stats; }
+
+private:
+
+    std::atomic<bool> m_locked{false};
+    lock_stats m_stats;
+
+public:
+
+    spinlock(spinlock &&) noexcept = delete;
+    spinlock &operator=(spinlock &&) noexcept = delete;
+
+    spinlock(const spinlock &) = delete;
+    spinlock &operator=(const spinlock &) = delete;
+};
+
+/// Ticket Lock
+///
+/// A fair (FIFO) lock. Each CPU takes a ticket, and waits until the ticket
+/// is being served. Since a waiter knows how many CPUs are ahead of it, it
+/// pauses in proportion to its position in the queue. All waiters spin on
+/// the same cache line, so this lock does not scale as well as the
+/// mcs_lock under heavy contention, but it has no per-CPU state.
+///
+/// Meets the BasicLockable and Lockable requirements, so it can be used
+/// with std::lock_guard and std::unique_lock.
+///
+class ticket_lock
+{
+public:
+
+    constexpr ticket_lock() noexcept = default;
+
+    /// Named Constructor
+    ///
+    /// @param name the name of the lock in the lock report
+    ///
+    explicit ticket_lock(lock::name_type name) noexcept :
+        m_stats(name, lock::ticket)
+    { }
+
+    ~ticket_lock() = default;
+
+    void lock() noexcept
+    {
+        lock::count_type spins = 0;
+        auto &&ticket = m_next.fetch_add(1, std::memory_order_relaxed);
+
+        while (true)
+        {
+            auto &&owner = m_owner.load(std::memory_order_acquire);
+
+            if (owner == ticket)
+                break;
+
+            auto &&ahead = static_cast<uint32_t>(ticket - owner);
+
+            for (auto i = 0U; i < ahead; i++)
+                lock::pause();
+
+            spins += ahead;
+        }
+
+        m_stats.acquired(spins);
+        m_stats.hold();
+    }
+
+    bool try_lock() noexcept
+    {
+        auto &&owner = m_owner.load(std::memory_order_relaxed);
+        auto &&next = owner;
+
+        if (!m_next.compare_exchange_strong(next, owner + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            return false;
+
+        m_stats.acquired(0);
+        m_stats.hold();
+
+        return true;
+    }
+
+    void unlock() noexcept
+    {
+        m_stats.release();
+        m_owner.store(m_owner.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    const lock_stats &stats() const noexcept
+    { return m_stats; }
+
+private:
+
+    std::atomic<uint32_t> m_next{0};
+    std::atomic<uint32_t> m_owner{0};
+    lock_stats m_stats;
+
+public:
+
+    ticket_lock(ticket_lock &&) noexcept = delete;
+    ticket_lock &operator=(ticket_lock &&) noexcept = delete;
+
+    ticket_lock(const ticket_lock &) = delete;
+    ticket_lock &operator=(const ticket_lock &) = delete;
+};
+
+/// MCS Lock
+///
+/// A fair (FIFO) queue lock. Each waiter provides a node, and spins on a
+/// flag in its own node, so waiters do not share a cache line and a
+/// release only touches the cache line of the next waiter. This is the
+/// lock to use when many CPUs contend for the same lock.
+///
+/// Since each acquisition needs a node that lives until the lock is
+/// released, this lock does not meet the BasicLockable requirements.
+/// Instead, use mcs_lock::guard, which keeps the node on the stack:
+///
+/// @code
+/// mcs_lock::guard guard(g_lock);
+/// @endcode
+///
+class mcs_lock
+{
+public:
+
+    struct node
+    {
+        std::atomic<node *> next{nullptr};
+        std::atomic<bool> locked{false};
+    };
+
+    constexpr mcs_lock() noexcept = default;
+
+    /// Named Constructor
+    ///
+    /// @param name the name of the lock in the lock report
+    ///
+    explicit mcs_lock(lock::name_type name) noexcept :
+        m_stats(name, lock::mcs)
+    { }
+
+    ~mcs_lock() = default;
+
+    void lock(node &n) noexcept
+    {
+        lock::count_type spins = 0;
+
+        n.next.store(nullptr, std::memory_order_relaxed);
+        n.locked.store(true, std::memory_order_relaxed);
+
+        if (auto &&prev = m_tail.exchange(&n, std::memory_order_acq_rel))
+        {
+            prev->next.store(&n, std::memory_order_release);
+
+            do
+            {
+                lock::pause();
+                spins++;
+            }
+            while (n.locked.load(std::memory_order_acquire));
+        }
+
+        m_stats.acquired(spins);
+        m_stats.hold();
+    }
+
+    bool try_lock(node &n) noexcept
+    {
+        node *expected = nullptr;
+
+        n.next.store(nullptr, std::memory_order_relaxed);
+        n.locked.store(true, std::memory_order_relaxed);
+
+        if (!m_tail.compare_exchange_strong(expected, &n, std::memory_order_acq_rel, std::memory_order_relaxed))
+            return false;
+
+        m_stats.acquired(0);
+        m_stats.hold();
+
+        return true;
+    }
+
+    void unlock(node &n) noexcept
+    {
+        m_stats.release();
+
+        auto &&next = n.next.load(std::memory_order_acquire);
+
+        if (next == nullptr)
+        {
+            node *expected = &n;
+
+            if (m_tail.compare_exchange_strong(expected, nullptr, std::memory_order_release, std::memory_order_relaxed))
+                return;
+
+            while ((next = n.next.load(std::memory_order_acquire)) == nullptr)
+                lock::pause();
+        }
+
+        next->locked.store(false, std::memory_order_release);
+    }
+
+    const lock_stats &stats() const noexcept
+    { return m_stats; }
+
+    /// MCS Guard
+    ///
+    /// Acquires an mcs_lock for the lifetime of the guard.
+    ///
+    class guard
+    {
+    public:
+
+        explicit guard(mcs_lock &lock) noexcept :
+            m_lock(lock)
+        { m_lock.lock(m_node); }
+
+        ~guard()
+        { m_lock.unlock(m_node); }
+
+    private:
+
+        mcs_lock &m_lock;
+        node m_node;
+
+    public:
+
+        guard(guard &&) noexcept = delete;
+        guard &operator=(guard &&) noexcept = delete;
+
+        guard(const guard &) = delete;
+        guard &operator=(const guard &) = delete;
+    };
+
+private:
+
+    std::atomic<node *> m_tail{nullptr};
+    lock_stats m_stats;
+
+public:
+
+    mcs_lock(mcs_lock &&) noexcept = delete;
+    mcs_lock &operator=(mcs_lock &&) noexcept = delete;
+
+    mcs_lock(const mcs_lock &) = delete;
+    mcs_lock &operator=(const mcs_lock &) = delete;
+};
+
+/// Reader / Writer Spinlock
+///
+/// Allows any number of readers, or a single writer, to hold the lock. A
+/// waiting writer sets a pending bit that keeps new readers out, so that
+/// a steady stream of readers cannot starve a writer. Only exclusive holds
+/// are timed by the lock's statistics.
+///
+/// Meets the Lockable and SharedLockable requirements, so it can be used
+/// with std::lock_guard, std::unique_lock and std::shared_lock.
+///
+class rw_spinlock
+{
+public:
+
+    constexpr rw_spinlock() noexcept = default;
+
+    /// Named Constructor
+    ///
+    /// @param name the name of the lock in the lock report
+    ///
+    explicit rw_spinlock(lock::name_type name) noexcept :
+        m_stats(name, lock::rw)
+    { }
+
+    ~rw_spinlock() = default;
+
+    void lock() noexcept
+    {
+        lock::count_type spins = 0;
+
+        while (true)
+        {
+            auto state = m_state.load(std::memory_order_relaxed);
+
+            if ((state & ~pending) == 0)
+            {
+                if (m_state.compare_exchange_weak(state, writer, std::memory_order_acquire, std::memory_order_relaxed))
+                    break;
+
+                continue;
+            }
+
+            if ((state & pending) == 0)
+                m_state.fetch_or(pending, std::memory_order_relaxed);
+
+            lock::pause();
+            spins++;
+        }
+
+        m_stats.acquired(spins);
+        m_stats.hold();
+    }
+
+    bool try_lock() noexcept
+    {
+        auto state = m_state.load(std::memory_order_relaxed);
+
+        if ((state & ~pending) != 0)
+            return false;
+
+        if (!m_state.compare_exchange_strong(state, writer, std::memory_order_acquire, std::memory_order_relaxed))
+            return false;
+
+        m_stats.acquired(0);
+        m_stats.hold();
+
+        return true;
+    }
+
+    void unlock() noexcept
+    {
+        m_stats.release();
+        m_state.fetch_and(~writer, std::memory_order_release);
+    }
+
+    void lock_shared() noexcept
+    {
+        lock::count_type spins = 0;
+
+        while (true)
+        {
+            auto state = m_state.load(std::memory_order_relaxed);
+
+            if ((state & (writer | pending)) == 0)
+            {
+                if (m_state.compare_exchange_weak(state, state + reader, std::memory_order_acquire, std::memory_order_relaxed))
+                    break;
+
+                continue;
+            }
+
+            lock::pause();
+            spins++;
+        }
+
+        m_stats.acquired(spins);
+    }
+
+    bool try_lock_shared() noexcept
+    {
+        auto state = m_state.load(std::memory_order_relaxed);
+
+        if ((state & (writer | pending)) != 0)
+            return false;
+
+        if (!m_state.compare_exchange_strong(state, state + reader, std::memory_order_acquire, std::memory_order_relaxed))
+            return false;
+
+        m_stats.acquired(0);
+        return true;
+    }
+
+    void unlock_shared() noexcept
+    { m_state.fetch_sub(reader, std::memory_order_release); }
+
+    const lock_stats &stats() const noexcept
+    { return m_stats; }
+
+private:
+
+    static constexpr const uint32_t writer = 1U << 0;
+    static constexpr const uint32_t pending = 1U << 1;
+    static constexpr const uint32_t reader = 1U << 2;
+
+    std::atomic<uint32_t> m_state{0};
+    lock_stats m_stats;
+
+public:
+
+    rw_spinlock(rw_spinlock &&) noexcept = delete;
+    rw_spinlock &operator=(rw_spinlock &&) noexcept = delete;
+
+    rw_spinlock(const rw_spinlock &) = delete;
+    rw_spinlock &operator=(const rw_spinlock &) = delete;
+};
+
+/// Lock Report Entry
+///
+/// A snapshot of the statistics of a single named lock
+///
+struct lock_report_type
+{
+    lock::name_type name;
+    lock::type_type type;
+    lock::count_type acquisitions;
+    lock::count_type contended;
+    lock::count_type spins;
+    lock::cycles_type max_hold;
+};
+
+/// Lock Report
+///
+/// @expects none
+/// @ensures none
+///
+/// @return a snapshot of the statistics of each named lock, in the order
+///     in which the locks were created
+///
+std::vector<lock_report_type> lock_report();
+
+/// Lock Report Reset
+///
+/// Clears the statistics of each named lock
+///
+/// @expects none
+/// @ensures none
+///
+void lock_report_reset() noexcept;
+
+}
+
+#endif
@@ -0,0 +1,160 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef MEM_X64_H
+#define MEM_X64_H
+
+#include <cstddef>
+#include <cstdint>
+
+/// Memory Operations
+///
+/// Bulk copy, fill and compare routines for the VMM. Each routine has
+/// several implementations (variants), and the fastest variant that the
+/// CPU supports is selected once by init(), which the VMM calls when it
+/// is started. Until then (and on CPUs without any of the extensions
+/// below), the sse2 variant is used, as every x64 CPU supports it.
+///
+/// - sse2: 16 byte unaligned loads / stores
+/// - erms: rep movsb / rep stosb (Enhanced REP MOVSB / STOSB), with the
+///   sse2 variant for short buffers, where the startup cost of a rep string
+///   instruction dominates
+/// - avx2: 32 byte unaligned loads / stores. Only available when the CPU
+///   supports AVX2, and the OS has enabled the ymm state
+///
+/// Copies of at least non_temporal_threshold bytes (except with erms, where
+/// rep movsb already avoids polluting the cache for large copies), and fills
+/// of at least non_temporal_set_threshold bytes (a page, with every
+/// variant) use non-temporal stores, so that large copies and page fills
+/// (e.g. zeroing a freshly allocated page) do not evict the VMM's (and the
+/// guest's) working set.
+///
+/// Like memcpy, copy() does not support overlapping buffers.
+///
+// *INDENT-OFF*
+
+namespace x64
+{
+namespace mem
+{
+    using pointer = void *;
+    using const_pointer = const void *;
+    using size_type = std::size_t;
+    using variant_type = uint64_t;
+
+    constexpr const variant_type sse2 = 1;
+    constexpr const variant_type erms = 2;
+    constexpr const variant_type avx2 = 3;
+
+    constexpr const size_type erms_threshold = 0x100;
+    constexpr const size_type non_temporal_threshold = 0x40000;
+    constexpr const size_type non_temporal_set_threshold = 0x1000;
+
+    /// Init
+    ///
+    /// Selects the fastest variant that the CPU supports. Only the first
+    /// call does anything.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void init() noexcept;
+
+    /// Supported
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param variant the variant to check
+    /// @return true if the CPU (and the build) supports the variant
+    ///
+    bool supported(variant_type variant) noexcept;
+
+    /// Select
+    ///
+    /// Selects a specific variant (used by the unit tests and benchmarks).
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param variant the variant to use
+    /// @return true if the variant is supported, and was selected, false
+    ///     otherwise (in which case the selected variant is not changed)
+    ///
+    bool select(variant_type variant) noexcept;
+
+    /// Selected
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the variant that is currently being used
+    ///
+    variant_type selected() noexcept;
+
+    /// Copy
+    ///
+    /// Same as memcpy
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param dst the buffer to copy to
+    /// @param src the buffer to copy from (must not overlap dst)
+    /// @param num the number of bytes to copy
+    /// @return dst
+    ///
+    pointer copy(pointer dst, const_pointer src, size_type num) noexcept;
+
+    /// Set
+    ///
+    /// Same as memset
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param dst the buffer to fill
+    /// @param val the byte to fill the buffer with
+    /// @param num the number of bytes to fill
+    /// @return dst
+    ///
+    pointer set(pointer dst, int val, size_type num) noexcept;
+
+    /// Compare
+    ///
+    /// Same as memcmp
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param lhs the first buffer
+    /// @param rhs the second buffer
+    /// @param num the number of bytes to compare
+    /// @return 0 if the buffers are equal, otherwise the difference between
+    ///     the first pair of bytes (as unsigned char) that differ
+    ///
+    int compare(const_pointer lhs, const_pointer rhs, size_type num) noexcept;
+}
+}
+
+// *INDENT-ON*
+
+#endif
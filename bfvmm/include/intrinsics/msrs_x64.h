@@ -253,6 +253,247 @@ namespace msrs
         }
     }
 
+    namespace ia32_mtrrcap
+    {
+        constexpr const auto addr = 0x000000FEU;
+        constexpr const auto name = "ia32_mtrrcap";
+
+        inline auto get() noexcept
+        { return __read_msr(addr); }
+
+        namespace vcnt
+        {
+            constexpr const auto mask = 0x00000000000000FFUL;
+            constexpr const auto from = 0;
+            constexpr const auto name = "vcnt";
+
+            inline auto get() noexcept
+            { return get_bits(__read_msr(addr), mask) >> from; }
+
+            template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+            auto get(T val) noexcept
+            { return get_bits(val, mask) >> from; }
+        }
+
+        namespace fixed_range_support
+        {
+            constexpr const auto mask = 0x0000000000000100UL;
+            constexpr const auto from = 8;
+            constexpr const auto name = "fixed_range_support";
+
+            inline auto get() noexcept
+            { return get_bit(__read_msr(addr), from) != 0; }
+
+            template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+            auto get(T val) noexcept
+            { return get_bit(val, from) != 0; }
+        }
+
+        namespace wc_support
+        {
+            constexpr const auto mask = 0x0000000000000400UL;
+            constexpr const auto from = 10;
+            constexpr const auto name = "wc_support";
+
+            inline auto get() noexcept
+            { return get_bit(__read_msr(addr), from) != 0; }
+
+            template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+            auto get(T val) noexcept
+            { return get_bit(val, from) != 0; }
+        }
+
+        inline void dump() noexcept
+        {
+            bfdebug << "msrs::ia32_mtrrcap fields:" << bfendl;
+
+            bfdebug << "    - " << vcnt::name << " = "
+                    << view_as_pointer(vcnt::get()) << bfendl;
+            bfdebug << "    - " << fixed_range_support::name << " = "
+                    << (fixed_range_support::get() ? "true" : "false") << bfendl;
+            bfdebug << "    - " << wc_support::name << " = "
+                    << (wc_support::get() ? "true" : "false") << bfendl;
+        }
+    }
+
+    namespace ia32_mtrr_def_type
+    {
+        constexpr const auto addr = 0x000002FFU;
+        constexpr const auto name = "ia32_mtrr_def_type";
+
+        inline auto get() noexcept
+        { return __read_msr(addr); }
+
+        namespace type
+        {
+            constexpr const auto mask = 0x00000000000000FFUL;
+            constexpr const auto from = 0;
+            constexpr const auto name = "type";
+
+            inline auto get() noexcept
+            { return get_bits(__read_msr(addr), mask) >> from; }
+
+            template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+            auto get(T val) noexcept
+            { return get_bits(val, mask) >> from; }
+        }
+
+        namespace fixed_range_enable
+        {
+            constexpr const auto mask = 0x0000000000000400UL;
+            constexpr const auto from = 10;
+            constexpr const auto name = "fixed_range_enable";
+
+            inline auto get() noexcept
+            { return get_bit(__read_msr(addr), from) != 0; }
+
+            template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+            auto get(T val) noexcept
+            { return get_bit(val, from) != 0; }
+        }
+
+        namespace mtrr_enable
+        {
+            constexpr const auto mask = 0x0000000000000800UL;
+            constexpr const auto from = 11;
+            constexpr const auto name = "mtrr_enable";
+
+            inline auto get() noexcept
+            { return get_bit(__read_msr(addr), from) != 0; }
+
+            template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+            auto get(T val) noexcept
+            { return get_bit(val, from) != 0; }
+        }
+
+        inline void dump() noexcept
+        {
+            bfdebug << "msrs::ia32_mtrr_def_type fields:" << bfendl;
+
+            bfdebug << "    - " << type::name << " = "
+                    << view_as_pointer(type::get()) << bfendl;
+            bfdebug << "    - " << fixed_range_enable::name << " = "
+                    << (fixed_range_enable::get() ? "true" : "false") << bfendl;
+            bfdebug << "    - " << mtrr_enable::name << " = "
+                    << (mtrr_enable::get() ? "true" : "false") << bfendl;
+        }
+    }
+
+    namespace ia32_mtrr_physbase
+    {
+        constexpr const auto start_addr = 0x00000200U;
+        constexpr const auto name = "ia32_mtrr_physbase";
+
+        template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+        auto addr(T index) noexcept
+        { return start_addr + (gsl::narrow_cast<field_type>(index) * 2U); }
+
+        template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+        auto get(T index) noexcept
+        { return __read_msr(addr(index)); }
+
+        namespace type
+        {
+            constexpr const auto mask = 0x00000000000000FFUL;
+            constexpr const auto from = 0;
+            constexpr const auto name = "type";
+
+            template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+            auto get(T val) noexcept
+            { return get_bits(val, mask) >> from; }
+        }
+
+        namespace physbase
+        {
+            constexpr const auto mask = 0x000FFFFFFFFFF000UL;
+            constexpr const auto from = 0;
+            constexpr const auto name = "physbase";
+
+            template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+            auto get(T val) noexcept
+            { return get_bits(val, mask) >> from; }
+        }
+    }
+
+    namespace ia32_mtrr_physmask
+    {
+        constexpr const auto start_addr = 0x00000201U;
+        constexpr const auto name = "ia32_mtrr_physmask";
+
+        template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+        auto addr(T index) noexcept
+        { return start_addr + (gsl::narrow_cast<field_type>(index) * 2U); }
+
+        template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+        auto get(T index) noexcept
+        { return __read_msr(addr(index)); }
+
+        namespace valid
+        {
+            constexpr const auto mask = 0x0000000000000800UL;
+            constexpr const auto from = 11;
+            constexpr const auto name = "valid";
+
+            template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+            auto get(T val) noexcept
+            { return get_bit(val, from) != 0; }
+        }
+
+        namespace physmask
+        {
+            constexpr const auto mask = 0x000FFFFFFFFFF000UL;
+            constexpr const auto from = 0;
+            constexpr const auto name = "physmask";
+
+            template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+            auto get(T val) noexcept
+            { return get_bits(val, mask) >> from; }
+        }
+    }
+
+    namespace ia32_mtrr_fix64k_00000
+    {
+        constexpr const auto addr = 0x00000250U;
+        constexpr const auto name = "ia32_mtrr_fix64k_00000";
+
+        inline auto get() noexcept
+        { return __read_msr(addr); }
+    }
+
+    namespace ia32_mtrr_fix16k_80000
+    {
+        constexpr const auto addr = 0x00000258U;
+        constexpr const auto name = "ia32_mtrr_fix16k_80000";
+
+        inline auto get() noexcept
+        { return __read_msr(addr); }
+    }
+
+    namespace ia32_mtrr_fix16k_a0000
+    {
+        constexpr const auto addr = 0x00000259U;
+        constexpr const auto name = "ia32_mtrr_fix16k_a0000";
+
+        inline auto get() noexcept
+        { return __read_msr(addr); }
+    }
+
+    namespace ia32_mtrr_fix4k
+    {
+        constexpr const auto start_addr = 0x00000268U;
+        constexpr const auto name = "ia32_mtrr_fix4k";
+
+        // ia32_mtrr_fix4k_c0000 (index 0) to ia32_mtrr_fix4k_f8000 (index 7)
+
+        template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+        auto addr(T index) noexcept
+        { return start_addr + gsl::narrow_cast<field_type>(index); }
+
+        template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+        auto get(T index) noexcept
+        { return __read_msr(addr(index)); }
+    }
+
 }
 }
 
@@ -62,13 +62,13 @@ namespace vmx
     inline void invept_single_context(eptp_type eptp)
     {
         uint64_t descriptor[2] = { eptp, 0 };
-        __invept(0, static_cast<void *>(descriptor));
+        __invept(1, static_cast<void *>(descriptor));
     }
 
     inline void invept_global()
     {
         uint64_t descriptor[2] = { 0, 0 };
-        __invept(1, static_cast<void *>(descriptor));
+        __invept(2, static_cast<void *>(descriptor));
     }
 
     inline void invvipd_individual_address(vpid_type vpid, integer_pointer addr)
@@ -0,0 +1,317 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef DIRTY_LOG_INTEL_X64_H
+#define DIRTY_LOG_INTEL_X64_H
+
+#include <gsl/gsl>
+
+#include <atomic>
+#include <vector>
+
+#include <memory_manager/root_ept_intel_x64.h>
+
+#include <intrinsics/lock_x64.h>
+
+/// Dirty Log
+///
+/// Records which 4k pages of a range of guest physical memory have been
+/// written to since they were last harvested. The log is shared by all of
+/// the vCPUs that use the provided EPT. Each vCPU logs the guest physical
+/// addresses that the CPU records in its page modification log (PML), and
+/// harvest() hands the resulting bitmap to the caller.
+///
+/// The CPU only logs a page when it sets the page's EPT dirty flag, so
+/// harvest() also clears the dirty flag of each page that it reports. Since
+/// the CPU might still have cached translations with the dirty flag set,
+/// the pages that a vCPU writes are only guaranteed to be logged again once
+/// it has invalidated its EPT's cached translations. INVEPT only affects
+/// the CPU that executes it, and there is no way to make another vCPU
+/// invalidate before harvest() returns, so each vCPU invalidates when it
+/// sees a new generation() (on its next VM exit), and reports that it has
+/// done so using vcpu_synced(). Until every tracking vCPU has done so, the
+/// pages that were cleared are "stale" (another vCPU might have written to
+/// them without logging it), and are reported again by the next harvest.
+/// The vCPU that harvests must invalidate before it returns to the guest,
+/// and thus a single tracking vCPU never leaves stale pages behind.
+///
+/// Writes are only logged by vCPUs that have PML enabled, so harvest() is
+/// rejected unless every vCPU that uses the EPT (see add_vcpu()) is
+/// tracking writes (see add_tracking_vcpu()).
+///
+/// When the log is started, every page in the range is marked dirty, so
+/// that the first harvest reports (and clears the dirty flag of) every
+/// page, and the caller starts with a complete copy of the range.
+///
+class dirty_log_intel_x64
+{
+public:
+
+    using integer_pointer = uintptr_t;
+    using size_type = std::size_t;
+    using word_type = uint64_t;
+    using generation_type = uint64_t;
+
+    /// Default Constructor
+    ///
+    /// @expects ept != nullptr
+    /// @ensures none
+    ///
+    /// @param ept the EPT whose dirty flags are used to track writes
+    ///
+    dirty_log_intel_x64(gsl::not_null<root_ept_intel_x64 *> ept) noexcept;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    virtual ~dirty_log_intel_x64() = default;
+
+    /// Start
+    ///
+    /// Starts tracking writes to [gpa, gpa + size), which is split into 4k
+    /// pages in the EPT (and stays that way once the log is stopped).
+    ///
+    /// @expects gpa and size are 4k aligned, size != 0, and the log is
+    ///     not already running
+    /// @ensures is_running() == true
+    ///
+    /// @param gpa the start of the guest physical address range
+    /// @param size the size of the guest physical address range
+    ///
+    virtual void start(integer_pointer gpa, size_type size);
+
+    /// Stop
+    ///
+    /// Stops tracking writes, and releases the bitmap.
+    ///
+    /// @expects none
+    /// @ensures is_running() == false
+    ///
+    virtual void stop();
+
+    /// Log
+    ///
+    /// Marks the pages that contain the provided guest physical addresses
+    /// as dirty. Addresses outside of the tracked range are ignored.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param gpas the guest physical addresses that were written to
+    ///
+    virtual void log(gsl::span<const integer_pointer> gpas);
+
+    /// Harvest
+    ///
+    /// In a single pass over the bitmap, copies bitmap.size() words of the
+    /// bitmap (starting with the word that holds page "first") into the
+    /// provided span, clears them, and clears the EPT dirty flag of each
+    /// page that was dirty. Bit n of word i describes the page at
+    /// gpa() + ((first + (i * 64) + n) * 4k). Words past the end of the
+    /// range are not written.
+    ///
+    /// Pages that are stale (see above) are reported as well, but their
+    /// dirty flags are not cleared again.
+    ///
+    /// @expects is_running(), first is a multiple of 64, first < pages()
+    ///     and tracking_vcpus() == vcpus()
+    /// @ensures none
+    ///
+    /// @param first the first page to harvest
+    /// @param bitmap the span to copy the bitmap into
+    /// @return the number of dirty pages that were harvested
+    ///
+    virtual size_type harvest(size_type first, gsl::span<word_type> bitmap);
+
+    /// Add vCPU
+    ///
+    /// Registers a vCPU that uses the EPT (i.e. that has to track writes
+    /// before the log can be harvested).
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    virtual void add_vcpu() noexcept;
+
+    /// Remove vCPU
+    ///
+    /// Unregisters a vCPU that was registered using add_vcpu().
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    virtual void remove_vcpu() noexcept;
+
+    /// vCPUs
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of vCPUs that use the EPT
+    ///
+    virtual size_type vcpus() const noexcept;
+
+    /// Add Tracking vCPU
+    ///
+    /// Registers a vCPU that tracks writes (i.e. that has PML enabled).
+    /// This must be called before the vCPU invalidates its EPT's cached
+    /// translations, and once it has, the vCPU must call vcpu_synced()
+    /// with the returned generation.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the current generation
+    ///
+    virtual generation_type add_tracking_vcpu() noexcept;
+
+    /// Remove Tracking vCPU
+    ///
+    /// Unregisters a vCPU that was registered using add_tracking_vcpu().
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param generation the last generation that the vCPU synced with
+    ///
+    virtual void remove_tracking_vcpu(generation_type generation) noexcept;
+
+    /// vCPU Synced
+    ///
+    /// Reports that a tracking vCPU has invalidated its EPT's cached
+    /// translations after it saw the provided generation. Reports for a
+    /// generation that is no longer current are ignored.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param generation the generation that the vCPU saw before it
+    ///     invalidated its cached translations
+    ///
+    virtual void vcpu_synced(generation_type generation) noexcept;
+
+    /// Tracking vCPUs
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of vCPUs that are tracking writes
+    ///
+    virtual size_type tracking_vcpus() const noexcept;
+
+    /// Is Running
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if the log is tracking writes
+    ///
+    virtual bool is_running() const noexcept
+    { return m_pages != 0; }
+
+    /// GPA
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the start of the tracked range
+    ///
+    virtual integer_pointer gpa() const noexcept
+    { return m_gpa; }
+
+    /// Pages
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of 4k pages in the tracked range, 0 if the log
+    ///     is not running
+    ///
+    virtual size_type pages() const noexcept
+    { return m_pages; }
+
+    /// Generation
+    ///
+    /// Incremented each time the log is started or stopped, and each time
+    /// harvest() clears EPT dirty flags. A vCPU that sees a new generation
+    /// must invalidate its EPT's cached translations.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the current generation
+    ///
+    virtual generation_type generation() const noexcept
+    { return m_generation.load(std::memory_order_acquire); }
+
+private:
+
+    void next_generation() noexcept;
+
+private:
+
+    root_ept_intel_x64 *m_ept;
+
+    integer_pointer m_gpa;
+    size_type m_pages;
+    size_type m_vcpus;
+    size_type m_tracking_vcpus;
+    size_type m_synced_vcpus;
+    std::vector<word_type> m_bitmap;
+    std::vector<word_type> m_stale;
+
+    std::atomic<generation_type> m_generation;
+
+    mutable x64::spinlock m_lock{"dirty_log"};
+
+public:
+
+    friend class memory_manager_ut;
+
+    dirty_log_intel_x64(dirty_log_intel_x64 &&) = delete;
+    dirty_log_intel_x64 &operator=(dirty_log_intel_x64 &&) = delete;
+
+    dirty_log_intel_x64(const dirty_log_intel_x64 &) = delete;
+    dirty_log_intel_x64 &operator=(const dirty_log_intel_x64 &) = delete;
+};
+
+/// Dirty Log
+///
+/// Returns the dirty log of the host VM, which tracks writes using the
+/// root EPT (see root_ept()).
+///
+/// @expects
+/// @ensures ret != nullptr
+///
+dirty_log_intel_x64 *dirty_log() noexcept;
+
+/// Dirty Log Macro
+///
+/// The following macro can be used to quickly call the dirty log.
+///
+/// @expects
+/// @ensures ret != nullptr
+///
+#define g_dirty_log dirty_log()
+
+#endif
@@ -0,0 +1,345 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#ifndef EPT_ENTRY_INTEL_X64_H
+#define EPT_ENTRY_INTEL_X64_H
+
+#include <gsl/gsl>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+// *INDENT-OFF*
+
+namespace intel_x64
+{
+namespace ept
+{
+    using access_type = uint64_t;
+
+    constexpr const access_type none                   = 0x0UL;
+    constexpr const access_type read                   = 0x1UL;
+    constexpr const access_type write                  = 0x2UL;
+    constexpr const access_type execute                = 0x4UL;
+
+    constexpr const access_type read_write             = read | write;
+    constexpr const access_type read_execute           = read | execute;
+    constexpr const access_type read_write_execute     = read | write | execute;
+
+    constexpr const auto access_mask                   = 0x7UL;
+}
+}
+
+// *INDENT-ON*
+
+// -----------------------------------------------------------------------------
+// Definition
+// -----------------------------------------------------------------------------
+
+/// EPT Entry
+///
+/// Wraps a single entry of an extended page table (EPT). The layout of an
+/// EPT entry differs from a regular page table entry (there is no present
+/// bit, the access rights are the lower 3 bits, and leaf entries carry an
+/// EPT memory type instead of a PAT index), so it is not possible to reuse
+/// page_table_entry_x64.
+///
+class ept_entry_intel_x64
+{
+public:
+
+    using pointer = uintptr_t *;
+    using integer_pointer = uintptr_t;
+    using access_type = intel_x64::ept::access_type;
+    using memory_type_type = uint64_t;
+
+    /// EPTE Constructor
+    ///
+    /// @expects epte != nullptr
+    /// @ensures none
+    ///
+    /// @param epte the epte that this ept entry encapsulates.
+    ///
+    ept_entry_intel_x64(gsl::not_null<pointer> epte) noexcept;
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~ept_entry_intel_x64() = default;
+
+    /// Value
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the raw value of the EPTE
+    ///
+    integer_pointer value() const noexcept;
+
+    /// Set Value
+    ///
+    /// Replaces the EPTE with a single atomic store. Entries that are
+    /// present should be built in a local integer (using an
+    /// ept_entry_intel_x64 that wraps that integer), and then published
+    /// with this function, so that the CPU never walks a partially
+    /// filled-in entry.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param value the new value of the EPTE
+    ///
+    void set_value(integer_pointer value) noexcept;
+
+    /// Read Access
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if reads are allowed, false otherwise
+    ///
+    bool read_access() const noexcept;
+
+    /// Set Read Access
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if reads are allowed, false otherwise
+    ///
+    void set_read_access(bool enabled) noexcept;
+
+    /// Write Access
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if writes are allowed, false otherwise
+    ///
+    bool write_access() const noexcept;
+
+    /// Set Write Access
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if writes are allowed, false otherwise
+    ///
+    void set_write_access(bool enabled) noexcept;
+
+    /// Execute Access
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if instruction fetches are allowed, false otherwise
+    ///
+    bool execute_access() const noexcept;
+
+    /// Set Execute Access
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if instruction fetches are allowed, false
+    ///     otherwise
+    ///
+    void set_execute_access(bool enabled) noexcept;
+
+    /// Access
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the read / write / execute bits (intel_x64::ept::access_type)
+    ///
+    access_type access() const noexcept;
+
+    /// Set Access
+    ///
+    /// @expects (access & ~intel_x64::ept::access_mask) == 0
+    /// @ensures none
+    ///
+    /// @param access the read / write / execute bits to set
+    ///
+    void set_access(access_type access);
+
+    /// Memory Type
+    ///
+    /// Only valid for leaf entries.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the EPT memory type (x64::memory_type)
+    ///
+    memory_type_type memory_type() const noexcept;
+
+    /// Set Memory Type
+    ///
+    /// Only valid for leaf entries. Note that UC- is not a valid EPT memory
+    /// type.
+    ///
+    /// @expects type is uncacheable, write_combining, write_through,
+    ///     write_protected or write_back
+    /// @ensures none
+    ///
+    /// @param type the EPT memory type (x64::memory_type)
+    ///
+    void set_memory_type(memory_type_type type);
+
+    /// Ignore PAT
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if the guest's PAT is ignored, false otherwise
+    ///
+    bool ignore_pat() const noexcept;
+
+    /// Set Ignore PAT
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if the guest's PAT should be ignored, false
+    ///     otherwise
+    ///
+    void set_ignore_pat(bool enabled) noexcept;
+
+    /// Entry Type
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if this entry maps a 1g / 2m page, false if this
+    ///     entry points to another EPT table (or maps a 4k page)
+    ///
+    bool entry_type() const noexcept;
+
+    /// Set Entry Type
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if this entry maps a 1g / 2m page, false
+    ///     otherwise
+    ///
+    void set_entry_type(bool enabled) noexcept;
+
+    /// Accessed
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if this entry has been accessed, false otherwise
+    ///
+    bool accessed() const noexcept;
+
+    /// Set Accessed
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if this entry has been accessed, false otherwise
+    ///
+    void set_accessed(bool enabled) noexcept;
+
+    /// Dirty
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if this entry is dirty, false otherwise
+    ///
+    bool dirty() const noexcept;
+
+    /// Set Dirty
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if this entry is dirty, false otherwise
+    ///
+    void set_dirty(bool enabled) noexcept;
+
+    /// Physical Address
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the physical address of the entry
+    ///
+    integer_pointer phys_addr() const noexcept;
+
+    /// Set Physical Address
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param addr the physical address of the entry
+    ///
+    void set_phys_addr(integer_pointer addr) noexcept;
+
+    /// Suppress VE
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if EPT violations do not cause #VE, false otherwise
+    ///
+    bool suppress_ve() const noexcept;
+
+    /// Set Suppress VE
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param enabled true if EPT violations should not cause #VE, false
+    ///     otherwise
+    ///
+    void set_suppress_ve(bool enabled) noexcept;
+
+    /// Clear EPTE
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void clear() noexcept;
+
+private:
+
+    pointer m_epte;
+
+public:
+
+    ept_entry_intel_x64(ept_entry_intel_x64 &&) noexcept = default;
+    ept_entry_intel_x64 &operator=(ept_entry_intel_x64 &&) noexcept = default;
+
+    ept_entry_intel_x64(const ept_entry_intel_x64 &) = delete;
+    ept_entry_intel_x64 &operator=(const ept_entry_intel_x64 &) = delete;
+};
+
+#endif
@@ -0,0 +1,244 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#ifndef EPT_INTEL_X64_H
+#define EPT_INTEL_X64_H
+
+#include <gsl/gsl>
+
+#include <bitset>
+#include <vector>
+#include <memory>
+
+#include <memory_manager/page_table_entry_x64.h>
+#include <memory_manager/ept_entry_intel_x64.h>
+
+/// Extended Page Table
+///
+/// Same design as page_table_x64 (the 512 hardware entries, a bitmap of
+/// the entries in use, and a sparse, sorted index of the child tables),
+/// but for extended page tables, which translate guest physical addresses
+/// to host physical addresses. The EPT uses the same 4 level structure as
+/// the regular page tables, so the x64::page_table constants apply.
+///
+/// Unlike page_table_x64, adding a page inside of an existing 1g / 2m page
+/// splits the large page (the large page is replaced with a table of 512
+/// smaller pages that inherit its access rights, memory type and address),
+/// so that the attributes of part of a large page can be changed without
+/// having to remap the rest of it.
+///
+class ept_intel_x64
+{
+public:
+
+    using pointer = uintptr_t *;
+    using integer_pointer = uintptr_t;
+    using size_type = std::size_t;
+
+    /// Constructor
+    ///
+    /// Creates an extended page table, and points the parent entry at this
+    /// table (with full access, as the access rights of a page are the
+    /// intersection of the access rights of each level). If a leaf is
+    /// provided, the table is first filled in with 512 pages that map the
+    /// leaf (a large page that is being split). The parent entry is only
+    /// updated once the table is complete, with a single atomic store.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param epte the parent ept entry that points to this table
+    /// @param leaf the large page being split, or 0 for an empty table
+    /// @param bits the page size bits of the large page being split
+    ///
+    ept_intel_x64(gsl::not_null<pointer> epte, integer_pointer leaf = 0, integer_pointer bits = 0);
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~ept_intel_x64() = default;
+
+    /// Add Page (1g Granularity)
+    ///
+    /// Adds a page to the extended page table structure. Note that this is
+    /// the public function, and should only be used to add pages to the
+    /// PML4 table.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param gpa the guest physical address of the page to add
+    /// @return the resulting epte. Note that this epte is blank, and its
+    ///     properties (like access) should be set by the caller
+    ///
+    ept_entry_intel_x64 add_page_1g(integer_pointer gpa)
+    { return add_page(gpa, x64::page_table::pml4::from, x64::page_table::pdpt::from); }
+
+    /// Add Page (2m Granularity)
+    ///
+    /// Adds a page to the extended page table structure, splitting a 1g
+    /// page if the 2m page is part of one.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param gpa the guest physical address of the page to add
+    /// @return the resulting epte. If a large page was split, the epte
+    ///     inherits the large page's properties, otherwise it is blank
+    ///
+    ept_entry_intel_x64 add_page_2m(integer_pointer gpa)
+    { return add_page(gpa, x64::page_table::pml4::from, x64::page_table::pd::from); }
+
+    /// Add Page (4k Granularity)
+    ///
+    /// Adds a page to the extended page table structure, splitting a 1g / 2m
+    /// page if the 4k page is part of one.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param gpa the guest physical address of the page to add
+    /// @return the resulting epte. If a large page was split, the epte
+    ///     inherits the large page's properties, otherwise it is blank
+    ///
+    ept_entry_intel_x64 add_page_4k(integer_pointer gpa)
+    { return add_page(gpa, x64::page_table::pml4::from, x64::page_table::pt::from); }
+
+    /// Remove Page
+    ///
+    /// Removes the page that maps gpa (which could be a 1g, 2m or 4k page),
+    /// removing empty tables as it goes.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param gpa the guest physical address of the page to remove
+    ///
+    void remove_page(integer_pointer gpa)
+    { remove_page(gpa, x64::page_table::pml4::from); }
+
+    /// Guest Physical Address to EPT Entry
+    ///
+    /// Returns the EPTE that maps the provided guest physical address. If
+    /// no EPTE exists for the address provided, an exception is thrown.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param gpa the guest physical address of the epte to locate
+    /// @return the epte that maps gpa
+    ///
+    ept_entry_intel_x64 gpa_to_epte(integer_pointer gpa) const
+    { return gpa_to_epte(gpa, x64::page_table::pml4::from); }
+
+    /// Guest Physical Address to Page Size
+    ///
+    /// Returns the size of the page that maps the provided guest physical
+    /// address. If no page maps the address provided, an exception is
+    /// thrown.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param gpa the guest physical address to locate
+    /// @return the size of the page (in bytes) that maps gpa
+    ///
+    size_type gpa_to_page_size(integer_pointer gpa) const
+    { return gpa_to_page_size(gpa, x64::page_table::pml4::from); }
+
+    /// Global Pages
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param from the level of the pages to count (for example,
+    ///     x64::page_table::pdpt::from to count 1g pages)
+    /// @return the number of pages of the provided level
+    ///
+    size_type global_pages(integer_pointer from) const noexcept
+    { return global_pages(from, x64::page_table::pml4::from); }
+
+    /// Global Nodes
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of tables, including this table
+    ///
+    size_type global_nodes() const noexcept;
+
+    /// Global Bytes
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of bytes used by the tables, including this table
+    ///
+    size_type global_bytes() const noexcept;
+
+private:
+
+    ept_entry_intel_x64 add_page(integer_pointer gpa, integer_pointer bits, integer_pointer end);
+    void remove_page(integer_pointer gpa, integer_pointer bits);
+    ept_entry_intel_x64 gpa_to_epte(integer_pointer gpa, integer_pointer bits) const;
+    size_type gpa_to_page_size(integer_pointer gpa, integer_pointer bits) const;
+    size_type global_pages(integer_pointer from, integer_pointer bits) const noexcept;
+
+    ept_intel_x64 *find_ept(size_type index) const noexcept;
+    ept_intel_x64 *add_ept(size_type index, integer_pointer leaf = 0, integer_pointer bits = 0);
+    ept_intel_x64 *split_ept(size_type index, integer_pointer bits);
+    void remove_ept(size_type index) noexcept;
+
+    void set_used(size_type index) noexcept;
+    void clear_used(size_type index) noexcept;
+
+    bool empty() const noexcept
+    { return m_size == 0; }
+
+private:
+
+    friend class memory_manager_ut;
+
+    struct child_type
+    {
+        size_type index;
+        std::unique_ptr<ept_intel_x64> ept;
+    };
+
+    std::unique_ptr<integer_pointer[]> m_ept;
+    std::vector<child_type> m_epts;
+
+    std::bitset<x64::page_table::num_entries> m_used;
+    size_type m_size;
+
+public:
+
+    ept_intel_x64(ept_intel_x64 &&) noexcept = default;
+    ept_intel_x64 &operator=(ept_intel_x64 &&) noexcept = default;
+
+    ept_intel_x64(const ept_intel_x64 &) = delete;
+    ept_intel_x64 &operator=(const ept_intel_x64 &) = delete;
+};
+
+#endif
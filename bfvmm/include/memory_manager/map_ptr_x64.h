@@ -954,6 +954,15 @@ bool operator!=(std::nullptr_t dontcare, const unique_map_ptr_x64<T> &y) noexcep
 
 inline uintptr_t virt_to_phys_with_cr3(uintptr_t virt, uintptr_t cr3)
 {
+#ifdef MAP_PTR_TESTING
+
+    (void) cr3;
+
+    expects(virt != 0xDEADBEEF);
+    return virt;
+
+#else
+
     uintptr_t from;
 
     expects(cr3 != 0);
@@ -999,6 +1008,8 @@ inline uintptr_t virt_to_phys_with_cr3(uintptr_t virt, uintptr_t cr3)
     expects(pt_pte.phys_addr() != 0);
 
     return upper(pt_pte.phys_addr(), from) | lower(virt, from);
+
+#endif
 }
 
 }
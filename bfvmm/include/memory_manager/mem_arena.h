@@ -0,0 +1,634 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef MEM_ARENA_H
+#define MEM_ARENA_H
+
+#include <gsl/gsl>
+
+#include <new>
+#include <mutex>
+
+#include <constants.h>
+#include <intrinsics/mem_x64.h>
+#include <intrinsics/lock_x64.h>
+
+// -----------------------------------------------------------------------------
+// Testing Switch
+// -----------------------------------------------------------------------------
+
+#ifdef TESTING_MEM_POOL
+#define noexcept_testing
+#define static_construction_error() throw std::logic_error("static_construction_error")
+#else
+#define noexcept_testing noexcept
+#define static_construction_error() std::terminate()
+#endif
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+constexpr const auto mem_pool_used_index = 0xFFFFFFFFFFFFFFFEUL;
+constexpr const auto mem_pool_free_index = 0xFFFFFFFFFFFFFFFFUL;
+
+// -----------------------------------------------------------------------------
+// Definition
+// -----------------------------------------------------------------------------
+
+///
+/// *INDENT-OFF*
+///
+
+/// Memory Arena
+///
+/// A memory arena divides a contiguous range of memory, whose size is only
+/// known at runtime, into blocks of 1 << block_shift bytes, and hands these
+/// blocks out using the same "next fit" algorithm as the mem_pool (which is
+/// a memory arena whose size, and bookkeeping, are fixed at compile time).
+///
+/// The bookkeeping of an arena is one integer_pointer per block, and is
+/// provided by the creator of the arena. Memory that is given to the VMM
+/// at runtime (i.e. a chunk from the driver entry) can hold its own arena
+/// using create(), which places the arena and its bookkeeping at the start
+/// of the chunk, and hands out the rest.
+///
+/// @param block_shift block size in bit shifts (i.e. 8 bytes == 3 bits)
+///
+template<size_t block_shift>
+class mem_arena
+{
+    static_assert((MAX_PAGE_SHIFT >= block_shift) &&(block_shift > 0), "block shift must be larger than 0");
+
+public:
+
+    using size_type = size_t;
+    using shift_type = size_t;
+    using integer_pointer = uintptr_t;
+
+    /// Constructor
+    ///
+    /// Creates a memory arena that manages [addr, addr + size). Note that
+    /// the bookkeeping is not cleared by the constructor, as the storage
+    /// for it might not exist yet (see mem_pool). clear() must be called
+    /// before the arena is used.
+    ///
+    /// @expects addr != 0
+    /// @expects size != 0
+    /// @expects size is a multiple of the block size
+    /// @expects allocated != nullptr
+    /// @ensures none
+    ///
+    /// @param addr the starting address of the memory arena
+    /// @param size the size of the memory arena in bytes
+    /// @param allocated the arena's bookkeeping (size >> block_shift entries)
+    ///
+    mem_arena(integer_pointer addr, size_type size, integer_pointer *allocated) noexcept_testing :
+        m_next(0),
+        m_addr(addr),
+        m_size(size >> block_shift),
+        m_bytes(size),
+        m_used(0),
+        m_peak(0),
+        m_allocated(allocated)
+    {
+        if (addr == 0 || allocated == nullptr)
+            static_construction_error();
+
+        if (size == 0 || (size & ((1ULL << block_shift) - 1)) != 0)
+            static_construction_error();
+
+        integer_pointer end;
+        if (__builtin_uaddl_overflow(m_addr, m_bytes, &end))
+            static_construction_error();
+    }
+
+    /// Default Destructor
+    ///
+    ~mem_arena() = default;
+
+    /// Create Arena
+    ///
+    /// Creates a memory arena inside of the chunk of memory [addr,
+    /// addr + size). The arena, and its bookkeeping, are placed at the start
+    /// of the chunk, and the remaining memory (aligned to the block size)
+    /// is managed by the arena. The arena lives for as long as the chunk
+    /// does, and must not be deleted.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param addr the starting address of the chunk
+    /// @param size the size of the chunk in bytes
+    /// @return the arena, or nullptr if the chunk is invalid or too small
+    ///
+    static mem_arena *
+    create(integer_pointer addr, size_type size) noexcept
+    {
+        integer_pointer end;
+        if (addr == 0 || (addr % alignof(mem_arena)) != 0 || __builtin_uaddl_overflow(addr, size, &end))
+            return nullptr;
+
+        auto usable = usable_size(size);
+        if (usable == 0)
+            return nullptr;
+
+        auto allocated = reinterpret_cast<integer_pointer *>(addr + sizeof(mem_arena));
+        auto arena = new (reinterpret_cast<void *>(addr)) mem_arena(addr + header_size(size), usable, allocated);
+
+        arena->clear();
+        return arena;
+    }
+
+    /// Usable Size
+    ///
+    /// Returns the number of bytes that an arena created with create()
+    /// from a chunk of this size would manage.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param size the size of the chunk in bytes
+    /// @return the capacity of the arena, or 0 if the chunk is too small
+    ///
+    static size_type
+    usable_size(size_type size) noexcept
+    {
+        auto header = header_size(size);
+
+        if (header >= size)
+            return 0;
+
+        return (size - header) & ~((1ULL << block_shift) - 1);
+    }
+
+    /// Allocate Memory
+    ///
+    /// Allocates memory from the memory arena whose size is greater than or
+    /// equal to size. The memory allocated will always be a multiple of
+    /// 1 << block_shift. Memory allocated will always have an alignment
+    /// equal to block_shift plus the starting address provided when creating
+    /// the memory arena.
+    ///
+    /// @expects size > 0
+    /// @expects size <= capacity()
+    /// @ensures ret != nullptr
+    ///
+    /// @param size the number of bytes to allocate
+    /// @return the starting address of the allocated memory
+    ///
+    integer_pointer
+    alloc(size_type size)
+    {
+        // [[ensures ret: ret != 0]]
+        expects(size > 0);
+        expects(size <= m_bytes);
+
+        if (auto addr = try_alloc(size))
+            return addr;
+
+        throw std::bad_alloc();
+    }
+
+    /// Try Allocate Memory
+    ///
+    /// Same as alloc, but returns 0 instead of throwing when the memory
+    /// arena cannot satisfy the request. This is used by the memory manager
+    /// to search through several arenas without the cost of an exception
+    /// for each arena that is full.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param size the number of bytes to allocate
+    /// @return the starting address of the allocated memory, or 0 on failure
+    ///
+    integer_pointer
+    try_alloc(size_type size) noexcept
+    {
+        if (size == 0 || size > m_bytes)
+            return 0;
+
+        std::lock_guard<x64::spinlock> guard(m_lock);
+
+        integer_pointer start = 0;
+        integer_pointer total = total_blocks(size);
+
+        if ((start = next_search(m_next, total)) != mem_pool_used_index)
+        {
+            m_next = start + total;
+            m_allocated[start] = total;
+
+            m_used += total;
+            if (m_used > m_peak)
+                m_peak = m_used;
+
+            return m_addr + (start << block_shift);
+        }
+
+        return 0;
+    }
+
+    /// Free Memory
+    ///
+    /// Free's previously allocated memory.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param addr the address to free
+    ///
+    void
+    free(integer_pointer addr) noexcept
+    {
+        if (addr < m_addr)
+            return;
+
+        integer_pointer start = (addr - m_addr) >> block_shift;
+
+        if (start >= m_size)
+            return;
+
+        {
+            std::lock_guard<x64::spinlock> guard(m_lock);
+
+            auto &&blocks = m_allocated[start];
+            if (blocks != mem_pool_free_index)
+                m_used -= blocks;
+
+            blocks = mem_pool_free_index;
+        }
+    }
+
+    /// Resize Memory
+    ///
+    /// Attempts to change the size of previously allocated memory without
+    /// moving it. Shrinking always succeeds, and the blocks at the end of the
+    /// allocation are given back to the arena. Growing succeeds only if the
+    /// blocks that follow the allocation are free. Like free, this function
+    /// will not crash given invalid inputs, but will instead return false.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param addr the address of previously allocated memory
+    /// @param size the new size in bytes
+    /// @return true if the memory now holds at least size bytes, false
+    ///     otherwise, in which case the allocation is left unchanged
+    ///
+    bool
+    resize(integer_pointer addr, size_type size) noexcept
+    {
+        if (size == 0 || size > m_bytes || !contains(addr))
+            return false;
+
+        if (((addr - m_addr) & ((1ULL << block_shift) - 1)) != 0)
+            return false;
+
+        std::lock_guard<x64::spinlock> guard(m_lock);
+
+        integer_pointer start = (addr - m_addr) >> block_shift;
+        integer_pointer blocks = m_allocated[start];
+        integer_pointer total = total_blocks(size);
+
+        if (blocks == mem_pool_free_index)
+            return false;
+
+        if (total <= blocks)
+        {
+            m_allocated[start] = total;
+            m_used -= blocks - total;
+
+            return true;
+        }
+
+        if (start + total > m_size)
+            return false;
+
+        for (auto index = start + blocks; index < start + total; index++)
+        {
+            if (m_allocated[index] != mem_pool_free_index)
+                return false;
+        }
+
+        m_allocated[start] = total;
+
+        m_used += total - blocks;
+        if (m_used > m_peak)
+            m_peak = m_used;
+
+        if (m_next > start && m_next < start + total)
+            m_next = start + total;
+
+        return true;
+    }
+
+    /// Contains Address
+    ///
+    /// Returns true if this memory arena contains this address, returns
+    /// false otherwise.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param addr to lookup
+    ///
+    bool
+    contains(integer_pointer addr) const noexcept
+    { return (addr >= m_addr && addr < m_addr + m_bytes); }
+
+    /// Allocation Size
+    ///
+    /// Locates and returns the size of previously allocated memory from
+    /// this arena. Like free, this function will not crash but instead will
+    /// return 0 given invalid inputs.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param addr to lookup
+    ///
+    size_type
+    size(integer_pointer addr) const noexcept
+    {
+        std::lock_guard<x64::spinlock> guard(m_lock);
+
+        if (!contains(addr))
+            return 0;
+
+        auto size = m_allocated[(addr - m_addr) >> block_shift];
+
+        if (size == mem_pool_free_index)
+            return 0;
+
+        return size << block_shift;
+    }
+
+    /// Clear Memory Arena
+    ///
+    /// This is a very dangerous function, and will effectively run free() on
+    /// all memory previously allocated.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void
+    clear() noexcept
+    {
+        std::lock_guard<x64::spinlock> guard(m_lock);
+
+        m_next = 0;
+        m_used = 0;
+        x64::mem::set(m_allocated, 0xFF, m_size * sizeof(integer_pointer));
+    }
+
+    /// Address
+    ///
+    /// @return the starting address of the memory managed by this arena
+    ///
+    integer_pointer
+    addr() const noexcept
+    { return m_addr; }
+
+    /// Capacity
+    ///
+    /// @return the number of bytes managed by this arena
+    ///
+    size_type
+    capacity() const noexcept
+    { return m_bytes; }
+
+    /// Used
+    ///
+    /// @return the number of bytes that are currently allocated
+    ///
+    size_type
+    used() const noexcept
+    {
+        std::lock_guard<x64::spinlock> guard(m_lock);
+        return m_used << block_shift;
+    }
+
+    /// Peak
+    ///
+    /// @return the largest number of bytes that were allocated at once
+    ///
+    size_type
+    peak() const noexcept
+    {
+        std::lock_guard<x64::spinlock> guard(m_lock);
+        return m_peak << block_shift;
+    }
+
+    /// Largest Free
+    ///
+    /// @return the number of bytes in the largest run of free blocks, which
+    ///     is the largest allocation that this arena can currently satisfy
+    ///
+    size_type
+    largest_free() const noexcept
+    {
+        size_type largest = 0;
+        size_type ranges = 0;
+
+        free_stats(largest, ranges);
+        return largest << block_shift;
+    }
+
+    /// Free Ranges
+    ///
+    /// @return the number of runs of free blocks. The more runs there are
+    ///     for the same amount of free memory, the more fragmented the
+    ///     arena is
+    ///
+    size_type
+    free_ranges() const noexcept
+    {
+        size_type largest = 0;
+        size_type ranges = 0;
+
+        free_stats(largest, ranges);
+        return ranges;
+    }
+
+    /// Occupancy
+    ///
+    /// Divides the arena into map.size() parts of (nearly) equal size, and
+    /// stores the percentage (0 - 100) of each part that is allocated into
+    /// the corresponding entry of map.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param map where to store the occupancy of each part of the arena
+    ///
+    void
+    occupancy(gsl::span<uint8_t> map) const noexcept
+    {
+        std::lock_guard<x64::spinlock> guard(m_lock);
+
+        auto num = static_cast<integer_pointer>(map.size());
+
+        integer_pointer run_end = 0;
+        bool run_used = false;
+
+        for (auto part = 0ULL; part < num; part++)
+        {
+            auto begin = (part * m_size) / num;
+            auto end = ((part + 1) * m_size) / num;
+
+            integer_pointer used = 0;
+
+            for (auto index = begin; index < end; index++)
+            {
+                if (index >= run_end)
+                {
+                    run_used = m_allocated[index] != mem_pool_free_index;
+                    run_end = index + (run_used ? m_allocated[index] : 1);
+                }
+
+                if (run_used)
+                    used++;
+            }
+
+            map[static_cast<std::ptrdiff_t>(part)] =
+                static_cast<uint8_t>(end != begin ? (used * 100) / (end - begin) : 0);
+        }
+    }
+
+private:
+
+    void
+    free_stats(size_type &largest, size_type &ranges) const noexcept
+    {
+        std::lock_guard<x64::spinlock> guard(m_lock);
+
+        integer_pointer run = 0;
+        integer_pointer index = 0;
+
+        while (index < m_size)
+        {
+            if (m_allocated[index] != mem_pool_free_index)
+            {
+                run = 0;
+                index += m_allocated[index];
+
+                continue;
+            }
+
+            if (run++ == 0)
+                ranges++;
+
+            if (run > largest)
+                largest = run;
+
+            index++;
+        }
+    }
+
+    static size_type
+    header_size(size_type size) noexcept
+    {
+        constexpr const auto block_mask = (1ULL << block_shift) - 1;
+
+        auto header = sizeof(mem_arena) + ((size >> block_shift) * sizeof(integer_pointer));
+        return (header + block_mask) & ~block_mask;
+    }
+
+    integer_pointer
+    next_search(integer_pointer initial, integer_pointer total) const noexcept
+    {
+        integer_pointer check = 0;
+        integer_pointer count = 0;
+        integer_pointer start = 0;
+        integer_pointer index = initial;
+
+        while (true)
+        {
+            if (index >= m_size)
+            {
+                count = 0;
+                index = 0;
+            }
+
+            if (m_allocated[index] == mem_pool_free_index)
+            {
+                if (count == 0)
+                    start = index;
+
+                count++;
+                index++;
+                check++;
+            }
+            else
+            {
+                auto blocks = m_allocated[index];
+
+                count = 0;
+                index += blocks;
+                check += blocks;
+            }
+
+            if (count >= total)
+                return start;
+
+            if (check >= m_size)
+                return mem_pool_used_index;
+        }
+    }
+
+    integer_pointer
+    total_blocks(size_type size) const noexcept
+    {
+        integer_pointer total = size >> block_shift;
+
+        if ((size & ((1 << block_shift) - 1)) != 0)
+            total++;
+
+        return total;
+    }
+
+private:
+
+    integer_pointer m_next;
+    integer_pointer m_addr;
+    integer_pointer m_size;
+    integer_pointer m_bytes;
+
+    integer_pointer m_used;
+    integer_pointer m_peak;
+
+    mutable x64::spinlock m_lock;
+    integer_pointer *m_allocated;
+
+public:
+
+    mem_arena(const mem_arena &) = delete;
+    mem_arena &operator=(const mem_arena &) = delete;
+    mem_arena(mem_arena &&) noexcept = delete;
+    mem_arena &operator=(mem_arena &&) noexcept = delete;
+};
+
+///
+/// *INDENT-ON*
+///
+
+#endif
@@ -23,9 +23,13 @@
 #define MEMORY_MANAGER_X64_H
 
 #include <map>
+#include <array>
 #include <vector>
 
+#include <gsl/gsl>
+
 #include <memory.h>
+#include <vmcall_interface.h>
 
 /// The memory manager has a couple specific functions:
 /// - alloc / free memory
@@ -35,7 +39,8 @@
 /// To support alloc / free, the memory manager is given both heap memory
 /// and a page pool. If a alloc is requested whose size is a multiple of
 /// MAX_PAGE_SIZE, the page pool is used. All other requests come from the
-/// heap.
+/// heap. Both start out as static pools, and are extended with chunks of
+/// memory that are provided by the driver entry (see add_chunk).
 ///
 /// To support virt / phys mappings, the memory manager has an add_mdl
 /// function that is called by the driver entry. Each time the driver entry
@@ -73,8 +78,33 @@ public:
     using integer_pointer = uintptr_t;
     using size_type = std::size_t;
     using attr_type = decltype(memory_descriptor::type);
+    using chunk_type = decltype(memory_chunk::type);
+    using node_type = decltype(memory_chunk::node);
     using memory_descriptor_list = std::vector<memory_descriptor>;
 
+    /// Arena Statistics
+    ///
+    /// Describes one of the memory manager's heap, page or map arenas, or a
+    /// reserve chunk that has not been turned into an arena yet (in which
+    /// case addr and size describe the chunk, and the rest is 0). node is
+    /// the NUMA node of a page arena, or MEMORY_CHUNK_ANY_NODE. See
+    /// vmcall_heap_pool_t for a description of the other fields.
+    ///
+    struct arena_stats_type
+    {
+        chunk_type type;
+        node_type node;
+        integer_pointer addr;
+        size_type size;
+        size_type used;
+        size_type peak;
+        size_type largest_free;
+        size_type free_ranges;
+        std::array<uint8_t, VMCALL_HEAP_MAP_SIZE> map;
+    };
+
+    using arena_stats_list = std::vector<arena_stats_type>;
+
     /// Default Destructor
     ///
     /// @expects none
@@ -95,7 +125,10 @@ public:
     ///
     /// Allocates memory. If the requested size is a multiple of MAX_PAGE_SIZE
     /// the page pool is used to allocate the memory which likely has more
-    /// memory, and the resulting addresses are page aligned. All other
+    /// memory, and the resulting addresses are page aligned. Page
+    /// allocations prefer the page arenas of the current CPU's NUMA node,
+    /// so that per-vCPU structures (VMCS regions, exit handler stacks,
+    /// etc...) are local to the CPU that uses them. All other
     /// requests come from the heap.
     ///
     /// @expects none
@@ -108,6 +141,42 @@ public:
     ///
     virtual pointer alloc(size_type size) noexcept;
 
+    /// Allocate Memory (Caller)
+    ///
+    /// Same as alloc(size), except that the heap profiler records the
+    /// provided caller as the allocation's call site instead of the return
+    /// address of this function. This is used by the VMM's malloc() and
+    /// operator new entry points, so that the call site is the code that
+    /// called malloc() / new, and not the allocator itself.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param size the number of bytes to allocate
+    /// @param caller the call site that is recorded by the heap profiler
+    /// @return see alloc(size)
+    ///
+    virtual pointer alloc(size_type size, integer_pointer caller) noexcept;
+
+    /// Allocate Exception
+    ///
+    /// Allocates memory for an exception (i.e. on behalf of
+    /// __cxa_allocate_exception). Requests no larger than
+    /// EMERGENCY_POOL_BLOCK_SIZE are served from the current CPU's
+    /// emergency pool first, and the heap is only used once the pool is
+    /// exhausted, so that an exception (e.g. std::bad_alloc) can still be
+    /// thrown when the heap runs out. The emergency pools are never used
+    /// for any other allocation.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param size the number of bytes to allocate
+    /// @return a pointer to the starting address of the memory allocated,
+    ///     or 0 on error
+    ///
+    virtual pointer alloc_exception(size_type size) noexcept;
+
     /// Allocate Map
     ///
     /// Allocates virtual memory to be used for mapping. This memory has no
@@ -164,6 +233,169 @@ public:
     ///
     virtual size_type size(pointer ptr) const noexcept;
 
+    /// Reallocate Memory
+    ///
+    /// Changes the size of memory previously allocated using alloc. The
+    /// memory is resized in place when possible (i.e. when shrinking, or
+    /// when the blocks that follow the allocation are free), and is only
+    /// moved (alloc, copy, free) otherwise. If ptr == nullptr, this is the
+    /// same as alloc(size). If size == 0, this is the same as free(ptr).
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param ptr a pointer to memory previously allocated using alloc.
+    /// @param size the new size in bytes
+    /// @return a pointer to the resized memory, or nullptr on error, in
+    ///     which case ptr is left untouched
+    ///
+    virtual pointer realloc(pointer ptr, size_type size) noexcept;
+
+    /// Reallocate Memory (Caller)
+    ///
+    /// Same as realloc(ptr, size), except that the heap profiler records
+    /// the provided caller as the allocation's call site (see
+    /// alloc(size, caller)).
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param ptr a pointer to memory previously allocated using alloc.
+    /// @param size the new size in bytes
+    /// @param caller the call site that is recorded by the heap profiler
+    /// @return see realloc(ptr, size)
+    ///
+    virtual pointer realloc(pointer ptr, size_type size, integer_pointer caller) noexcept;
+
+    /// Emergency Allocations
+    ///
+    /// Returns the number of exception allocations that were served from
+    /// the emergency pools.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return number of emergency pool allocations
+    ///
+    virtual size_type emergency_allocs() const noexcept;
+
+    /// Emergency Pool Exhausted
+    ///
+    /// Returns the number of exception allocations that could not be
+    /// served by the current CPU's emergency pool (and thus fell back to
+    /// the heap).
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return number of failed emergency pool allocations
+    ///
+    virtual size_type emergency_exhausted() const noexcept;
+
+    /// Add Chunk
+    ///
+    /// Adds a chunk of memory, provided by the driver entry, to the memory
+    /// manager. Heap and page chunks are turned into a new heap or page
+    /// arena right away. Reserve chunks are kept until the heap or the page
+    /// arenas cannot satisfy an allocation, at which point a reserve chunk
+    /// is turned into a new arena of that kind. Each arena keeps its
+    /// bookkeeping at the start of its chunk.
+    ///
+    /// Page chunks that are local to a NUMA node are kept in a separate
+    /// set of page arenas for that node. Page allocations made on a CPU
+    /// of that node (see thread_context_node) are satisfied from these
+    /// arenas first.
+    ///
+    /// @expects virt != 0
+    /// @expects virt & (page_size - 1) == 0
+    /// @expects size != 0
+    /// @ensures none
+    ///
+    /// @param virt the starting virtual address of the chunk
+    /// @param size the size of the chunk in bytes
+    /// @param type MEMORY_CHUNK_HEAP, MEMORY_CHUNK_PAGE or
+    ///     MEMORY_CHUNK_RESERVE
+    /// @param node the NUMA node of the chunk, or MEMORY_CHUNK_ANY_NODE
+    ///
+    virtual void add_chunk(integer_pointer virt, size_type size, chunk_type type, node_type node);
+
+    /// Arena Statistics
+    ///
+    /// Returns the statistics of each heap arena, page arena, reserve
+    /// chunk, and of the map pool. The static heap and page pools are the
+    /// first heap and page arenas.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return arena statistics
+    ///
+    virtual arena_stats_list arena_stats() const;
+
+    /// Start Heap Profiler
+    ///
+    /// Forgets all previously tracked allocations, and starts recording the
+    /// call site, size and vcpuid of each allocation made using alloc or
+    /// realloc, until it is freed. While the profiler is stopped, alloc and
+    /// free only pay for a single (predicted) branch.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    virtual void heap_profiler_start() noexcept;
+
+    /// Stop Heap Profiler
+    ///
+    /// Stops recording allocations. The allocations that were live when the
+    /// profiler was stopped can still be collected.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    virtual void heap_profiler_stop() noexcept;
+
+    /// Heap Profiler Running
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if the heap profiler is recording allocations
+    ///
+    virtual bool heap_profiler_running() const noexcept;
+
+    /// Collect Heap Profile
+    ///
+    /// Groups the tracked allocations by call site, and writes the call
+    /// sites that hold the most bytes into sites. This function does not
+    /// allocate memory.
+    ///
+    /// @expects none
+    /// @ensures ret <= sites.size()
+    ///
+    /// @param sites where to write the call sites
+    /// @return the number of call sites written
+    ///
+    virtual size_type heap_profiler_collect(gsl::span<vmcall_heap_site_t> sites) const noexcept;
+
+    /// Heap Profiler Allocations
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of live allocations that are being tracked
+    ///
+    virtual size_type heap_profiler_allocs() const noexcept;
+
+    /// Heap Profiler Dropped
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return the number of allocations that were not tracked because
+    ///     the profiler's table was full
+    ///
+    virtual size_type heap_profiler_dropped() const noexcept;
+
     /// Size of Map
     ///
     /// Returns the size of previously allocated map memory. If the provided
@@ -314,6 +546,25 @@ public:
     ///
     virtual void add_md(integer_pointer virt, integer_pointer phys, attr_type attr);
 
+    /// Adds Large Memory Descriptor
+    ///
+    /// Adds a memory descriptor for a physically contiguous, large page
+    /// to the memory manager. The large page is stored as a single entry
+    /// so that it can later be mapped using a large page.
+    ///
+    /// @expects virt != 0
+    /// @expects phys != 0
+    /// @expects type != 0
+    /// @expects virt & (LARGE_PAGE_SIZE - 1) == 0
+    /// @expects phys & (LARGE_PAGE_SIZE - 1) == 0
+    /// @ensures none
+    ///
+    /// @param virt virtual address to add
+    /// @param phys physical address mapped to virt
+    /// @param attr how the memory was mapped
+    ///
+    virtual void add_md_2m(integer_pointer virt, integer_pointer phys, attr_type attr);
+
     /// Remove Memory Descriptor
     ///
     /// Removes a memory descriptor list to the memory manager.
@@ -345,6 +596,10 @@ private:
 
     integer_pointer lower(integer_pointer ptr) const noexcept;
     integer_pointer upper(integer_pointer ptr) const noexcept;
+    integer_pointer lower_2m(integer_pointer ptr) const noexcept;
+    integer_pointer upper_2m(integer_pointer ptr) const noexcept;
+
+    pointer resize(pointer ptr, size_type size) noexcept;
 
 private:
 
@@ -352,6 +607,10 @@ private:
     std::map<integer_pointer, integer_pointer> m_phys_to_virt_map;
     std::map<integer_pointer, attr_type> m_virt_to_attr_map;
 
+    std::map<integer_pointer, integer_pointer> m_virt_to_phys_map_2m;
+    std::map<integer_pointer, integer_pointer> m_phys_to_virt_map_2m;
+    std::map<integer_pointer, attr_type> m_virt_to_attr_map_2m;
+
 public:
 
     memory_manager_x64(const memory_manager_x64 &) = delete;
@@ -0,0 +1,144 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#ifndef MTRR_X64_H
+#define MTRR_X64_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+/// Memory Type Range Registers
+///
+/// Takes a snapshot of the MTRRs (the fixed range MTRRs, the variable range
+/// MTRRs and the default memory type), so that the memory type the CPU uses
+/// for a physical address can be looked up without reading the MSRs again.
+/// This is needed to build EPT identity maps that use the same memory
+/// types as the host: with EPT enabled, the MTRRs no longer apply to the
+/// guest, and instead, the memory type comes from the EPT entry (combined
+/// with the guest's PAT).
+///
+/// Note that variable range MTRRs are assumed to have contiguous masks
+/// (which is what the SDM recommends, and what firmware does in practice).
+///
+class mtrr_x64
+{
+public:
+
+    using integer_pointer = uintptr_t;
+    using size_type = std::size_t;
+    using memory_type_type = uint64_t;
+
+    /// Default Constructor
+    ///
+    /// Reads the MTRRs of the current CPU.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    mtrr_x64();
+
+    /// Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    ~mtrr_x64() = default;
+
+    /// Memory Type
+    ///
+    /// Returns the memory type the MTRRs define for a physical address,
+    /// applying the SDM's precedence rules when variable ranges overlap
+    /// (UC wins, WT wins over WB, and any other overlap is treated as UC).
+    /// If the MTRRs are disabled, UC is returned.
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @param addr the physical address to look up
+    /// @return the memory type (x64::memory_type) of addr
+    ///
+    memory_type_type mem_type(integer_pointer addr) const noexcept;
+
+    /// Uniform
+    ///
+    /// @expects size != 0
+    /// @ensures none
+    ///
+    /// @param addr the start of the physical address range
+    /// @param size the size of the physical address range
+    /// @return true if every byte in [addr, addr + size) has the same
+    ///     memory type, false otherwise
+    ///
+    bool uniform(integer_pointer addr, size_type size) const;
+
+    /// Enabled
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return true if the MTRRs are enabled, false otherwise
+    ///
+    bool enabled() const noexcept
+    { return m_enabled; }
+
+    /// Dump
+    ///
+    /// Outputs the variable ranges and the default memory type
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    void dump() const;
+
+private:
+
+    memory_type_type fixed_type(integer_pointer addr) const noexcept;
+
+private:
+
+    struct range_type
+    {
+        integer_pointer base;
+        integer_pointer mask;
+        integer_pointer size;
+        memory_type_type type;
+    };
+
+    bool m_enabled;
+    bool m_fixed_enabled;
+    memory_type_type m_default_type;
+
+    std::array<memory_type_type, 88> m_fixed;
+    std::vector<range_type> m_ranges;
+    std::vector<integer_pointer> m_boundaries;
+
+public:
+
+    mtrr_x64(mtrr_x64 &&) = default;
+    mtrr_x64 &operator=(mtrr_x64 &&) = default;
+
+    mtrr_x64(const mtrr_x64 &) = default;
+    mtrr_x64 &operator=(const mtrr_x64 &) = default;
+};
+
+#endif
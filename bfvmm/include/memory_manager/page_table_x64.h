@@ -24,12 +24,23 @@
 
 #include <gsl/gsl>
 
+#include <bitset>
 #include <vector>
 #include <memory>
 
 #include <memory.h>
 #include <memory_manager/page_table_entry_x64.h>
 
+/// Page Table
+///
+/// Each page table is made up of the 512 hardware entries that the CPU
+/// walks, a bitmap of the entries that are in use, and a sparse, sorted
+/// index of the child page tables. Only the children that actually exist
+/// are stored, so a page table costs a single page plus a few bytes per
+/// child (instead of a second page of child pointers). The number of
+/// entries in use is tracked as pages are added and removed, so
+/// detecting an empty page table does not require a scan.
+///
 class page_table_x64
 {
 public:
@@ -164,16 +175,35 @@ private:
     page_table_entry_x64 virt_to_pte(integer_pointer addr, integer_pointer bits) const;
     memory_descriptor_list pt_to_mdl(memory_descriptor_list &mdl) const;
 
-    bool empty() const noexcept;
+    page_table_x64 *find_pt(size_type index) const noexcept;
+    page_table_x64 *add_pt(size_type index);
+    void remove_pt(size_type index) noexcept;
+
+    void set_used(size_type index) noexcept;
+    void clear_used(size_type index) noexcept;
+
+    bool empty() const noexcept
+    { return m_size == 0; }
+
     size_type global_size() const noexcept;
-    size_type global_capacity() const noexcept;
+    size_type global_nodes() const noexcept;
+    size_type global_bytes() const noexcept;
 
 private:
 
     friend class memory_manager_ut;
 
+    struct child_type
+    {
+        size_type index;
+        std::unique_ptr<page_table_x64> pt;
+    };
+
     std::unique_ptr<integer_pointer[]> m_pt;
-    std::vector<std::unique_ptr<page_table_x64>> m_pts;
+    std::vector<child_type> m_pts;
+
+    std::bitset<x64::page_table::num_entries> m_used;
+    size_type m_size;
 
 public:
 
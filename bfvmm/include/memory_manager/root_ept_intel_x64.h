@@ -0,0 +1,316 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#ifndef ROOT_EPT_INTEL_X64_H
+#define ROOT_EPT_INTEL_X64_H
+
+#include <gsl/gsl>
+
+#include <mutex>
+#include <memory>
+
+#include <memory_manager/mtrr_x64.h>
+#include <memory_manager/ept_intel_x64.h>
+#include <memory_manager/ept_entry_intel_x64.h>
+
+#include <intrinsics/x64.h>
+#include <intrinsics/lock_x64.h>
+
+/// Root Extended Page Tables
+///
+/// Represents the extended page tables (EPT) of a guest, which translate
+/// the guest's physical addresses to host physical addresses. The host VM
+/// uses an identity map (see setup_identity_map), made up of the largest
+/// pages possible, so that the extra levels that the CPU has to walk on a
+/// TLB miss with EPT enabled are mostly cached by the paging-structure
+/// caches, and the overhead of EPT is kept to a minimum. Pages are only
+/// split (into 2m or 4k pages) where the memory type changes, or where the
+/// access rights of part of a page are changed using set_access.
+///
+/// Note that this class does not invalidate the EPT's cached translations
+/// when modifications are made. This needs to be done manually (using
+/// vmx::invept_single_context(eptp())) once the EPT is in use.
+///
+class root_ept_intel_x64
+{
+public:
+
+    using integer_pointer = uintptr_t;
+    using size_type = std::size_t;
+    using eptp_type = uint64_t;
+    using access_type = intel_x64::ept::access_type;
+    using memory_type_type = uint64_t;
+
+    /// Default Constructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    root_ept_intel_x64();
+
+    /// Default Destructor
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    virtual ~root_ept_intel_x64() = default;
+
+    /// EPTP
+    ///
+    /// @expects none
+    /// @ensures none
+    ///
+    /// @return returns the EPT pointer (suitable for the VMCS's EPT pointer
+    ///     field) associated with this EPT, using a 4 level page walk, and
+    ///     a write back memory type for the EPT tables themselves
+    ///
+    virtual eptp_type eptp();
+
+    /// Map (1 Gigabyte)
+    ///
+    /// Maps 1 gigabyte of guest physical memory.
+    ///
+    /// @expects
+    /// @ensures
+    ///
+    /// @param gpa the guest physical address to map
+    /// @param hpa the host physical address to map the gpa to
+    /// @param access the access rights (intel_x64::ept::access_type)
+    /// @param type the memory type (x64::memory_type)
+    ///
+    virtual void map_1g(integer_pointer gpa, integer_pointer hpa, access_type access, memory_type_type type)
+    { this->map_page(gpa, hpa, access, type, x64::page_table::pdpt::size_bytes); }
+
+    /// Map (2 Megabytes)
+    ///
+    /// Maps 2 megabytes of guest physical memory.
+    ///
+    /// @expects
+    /// @ensures
+    ///
+    /// @param gpa the guest physical address to map
+    /// @param hpa the host physical address to map the gpa to
+    /// @param access the access rights (intel_x64::ept::access_type)
+    /// @param type the memory type (x64::memory_type)
+    ///
+    virtual void map_2m(integer_pointer gpa, integer_pointer hpa, access_type access, memory_type_type type)
+    { this->map_page(gpa, hpa, access, type, x64::page_table::pd::size_bytes); }
+
+    /// Map (4 Kilobytes)
+    ///
+    /// Maps 4 kilobytes of guest physical memory.
+    ///
+    /// @expects
+    /// @ensures
+    ///
+    /// @param gpa the guest physical address to map
+    /// @param hpa the host physical address to map the gpa to
+    /// @param access the access rights (intel_x64::ept::access_type)
+    /// @param type the memory type (x64::memory_type)
+    ///
+    virtual void map_4k(integer_pointer gpa, integer_pointer hpa, access_type access, memory_type_type type)
+    { this->map_page(gpa, hpa, access, type, x64::page_table::pt::size_bytes); }
+
+    /// Unmap
+    ///
+    /// Unmaps the page that maps the provided guest physical address.
+    ///
+    /// @expects
+    /// @ensures
+    ///
+    /// @param gpa the guest physical address to unmap
+    ///
+    virtual void unmap(integer_pointer gpa) noexcept;
+
+    /// Setup Identity Map
+    ///
+    /// Identity maps [saddr, eaddr) with full access, using the memory
+    /// types defined by the provided MTRRs. 1g pages are used (when the
+    /// CPU supports them) wherever a 1g page has a single memory type,
+    /// otherwise 2m pages are used, and 4k pages are only used where the
+    /// memory type changes inside of a 2m page (typically, the first
+    /// megabyte of memory, and the edges of MMIO holes).
+    ///
+    /// @expects saddr and eaddr are 4k aligned, and saddr < eaddr
+    /// @ensures
+    ///
+    /// @param mtrrs the MTRRs that define the memory types
+    /// @param saddr the starting address for the identity map
+    /// @param eaddr the ending address for the identity map
+    ///
+    void setup_identity_map(const mtrr_x64 &mtrrs, integer_pointer saddr, integer_pointer eaddr);
+
+    /// Set Access
+    ///
+    /// Changes the access rights of [gpa, gpa + size), which must already
+    /// be mapped. Pages are only split when the range covers part of a
+    /// page, so changing the access rights of a whole 1g page does not
+    /// split it.
+    ///
+    /// @expects gpa and size are 4k aligned, and size != 0
+    /// @ensures
+    ///
+    /// @param gpa the start of the guest physical address range
+    /// @param size the size of the guest physical address range
+    /// @param access the access rights (intel_x64::ept::access_type)
+    ///
+    void set_access(integer_pointer gpa, size_type size, access_type access);
+
+    /// Split (4 Kilobytes)
+    ///
+    /// Splits the pages that map [gpa, gpa + size), which must already be
+    /// mapped, into 4k pages with the same attributes. This is needed
+    /// when the EPT's dirty flags are used to track writes to individual
+    /// 4k pages (e.g. page modification logging), as a large page only has
+    /// a single dirty flag.
+    ///
+    /// @expects gpa and size are 4k aligned, and size != 0
+    /// @ensures
+    ///
+    /// @param gpa the start of the guest physical address range
+    /// @param size the size of the guest physical address range
+    ///
+    void split_4k(integer_pointer gpa, size_type size);
+
+    /// Clear Dirty
+    ///
+    /// Clears the dirty flag of the page that maps the provided guest
+    /// physical address. Like the other modifications, the CPU might still
+    /// have a cached translation that was used to write to the page, and
+    /// thus the EPT's cached translations need to be invalidated before
+    /// the CPU is guaranteed to set the dirty flag again.
+    ///
+    /// @expects
+    /// @ensures
+    ///
+    /// @param gpa the guest physical address to clear the dirty flag for
+    /// @return true if the dirty flag was set, false otherwise
+    ///
+    bool clear_dirty(integer_pointer gpa);
+
+    /// Guest Physical Address To EPT Entry
+    ///
+    /// Locates the EPT entry that maps the provided guest physical address.
+    /// Unmapping (or splitting) the page invalidates the EPTE returned by
+    /// this function.
+    ///
+    /// @expects
+    /// @ensures
+    ///
+    /// @param gpa the guest physical address to lookup
+    /// @return the resulting EPTE
+    ///
+    ept_entry_intel_x64 gpa_to_epte(integer_pointer gpa) const;
+
+    /// Guest Physical Address To Page Size
+    ///
+    /// @expects
+    /// @ensures
+    ///
+    /// @param gpa the guest physical address to lookup
+    /// @return the size of the page (1g, 2m or 4k) that maps gpa
+    ///
+    size_type gpa_to_page_size(integer_pointer gpa) const;
+
+    /// Pages
+    ///
+    /// @expects size is a 1g, 2m or 4k page size
+    /// @ensures
+    ///
+    /// @param size the page size to count
+    /// @return the number of pages of the provided size
+    ///
+    size_type pages(size_type size) const;
+
+    /// Tables
+    ///
+    /// @expects
+    /// @ensures
+    ///
+    /// @return the number of EPT tables (including the PML4)
+    ///
+    size_type tables() const;
+
+    /// Table Bytes
+    ///
+    /// @expects
+    /// @ensures
+    ///
+    /// @return the number of bytes used by the EPT tables
+    ///
+    size_type table_bytes() const;
+
+    /// Dump
+    ///
+    /// Outputs the number of pages of each size, and the memory used
+    ///
+    /// @expects
+    /// @ensures
+    ///
+    void dump() const;
+
+private:
+
+    ept_entry_intel_x64 add_page(integer_pointer gpa, size_type size);
+
+    void map_page(integer_pointer gpa, integer_pointer hpa, access_type access, memory_type_type type, size_type size);
+    void unmap_page(integer_pointer gpa) noexcept;
+
+private:
+
+    integer_pointer m_eptp;
+    std::unique_ptr<ept_intel_x64> m_ept;
+
+    mutable x64::rw_spinlock m_lock{"root_ept"};
+
+public:
+
+    friend class memory_manager_ut;
+
+    root_ept_intel_x64(root_ept_intel_x64 &&) = default;
+    root_ept_intel_x64 &operator=(root_ept_intel_x64 &&) = default;
+
+    root_ept_intel_x64(const root_ept_intel_x64 &) = delete;
+    root_ept_intel_x64 &operator=(const root_ept_intel_x64 &) = delete;
+};
+
+/// Root EPT
+///
+/// Returns the host VM's EPT, which identity maps the CPU's entire physical
+/// address width (unless limited by MAX_EPT_IDENTITY_MAP) with the memory
+/// types defined by the MTRRs.
+///
+/// @expects
+/// @ensures ret != nullptr
+///
+root_ept_intel_x64 *root_ept() noexcept;
+
+/// Root EPT Macro
+///
+/// The following macro can be used to quickly call the root EPT.
+///
+/// @expects
+/// @ensures ret != nullptr
+///
+#define g_ept root_ept()
+
+#endif
@@ -33,6 +33,7 @@
 #include <memory_manager/page_table_x64.h>
 
 #include <intrinsics/x64.h>
+#include <intrinsics/lock_x64.h>
 
 /// Root Page Tables
 ///
@@ -258,7 +259,7 @@ private:
     integer_pointer m_cr3;
     std::unique_ptr<page_table_x64> m_pt;
 
-    mutable std::mutex m_mutex;
+    mutable x64::rw_spinlock m_lock{"root_page_table"};
 
 public:
 
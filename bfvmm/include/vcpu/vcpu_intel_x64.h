@@ -125,6 +125,7 @@ public:
 private:
 
     bool m_vmcs_launched;
+    bool m_ept_enabled;
 
     std::unique_ptr<vmxon_intel_x64> m_vmxon;
     std::unique_ptr<vmcs_intel_x64> m_vmcs;
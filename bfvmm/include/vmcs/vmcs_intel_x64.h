@@ -196,6 +196,8 @@ protected:
     state_save_intel_x64 *m_state_save;
     std::unique_ptr<char[]> m_exit_handler_stack;
 
+    uint64_t m_eptp;
+
 private:
 
     friend class vcpu_ut;
@@ -206,6 +208,9 @@ private:
 
     virtual void set_state_save(gsl::not_null<state_save_intel_x64 *> state_save)
     { m_state_save = state_save; }
+
+    virtual void set_eptp(uint64_t eptp)
+    { m_eptp = eptp; }
 };
 
 #endif
@@ -873,6 +873,31 @@ namespace guest_interrupt_status
     { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
 }
 
+namespace guest_pml_index
+{
+    constexpr const auto addr = 0x0000000000000812UL;
+    constexpr const auto name = "guest_pml_index";
+
+    inline bool exists() noexcept
+    {
+        return msrs::ia32_vmx_true_procbased_ctls::activate_secondary_controls::is_allowed1() &&
+               msrs::ia32_vmx_procbased_ctls2::enable_pml::is_allowed1();
+    }
+
+    inline auto get()
+    { return get_vmcs_field(addr, name, exists()); }
+
+    inline auto get_if_exists(bool verbose = false) noexcept
+    { return get_vmcs_field_if_exists(addr, name, verbose, exists()); }
+
+    template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+    void set(T val) { set_vmcs_field(val, addr, name, exists()); }
+
+    template<class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+    void set_if_exists(T val, bool verbose = false) noexcept
+    { set_vmcs_field_if_exists(val, addr, name, verbose, exists()); }
+}
+
 }
 }
 
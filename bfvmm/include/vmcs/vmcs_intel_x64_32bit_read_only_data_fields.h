@@ -253,6 +253,7 @@ namespace exit_reason
         constexpr const auto invpcid = 58U;
         constexpr const auto vmfunc = 59U;
         constexpr const auto rdseed = 61U;
+        constexpr const auto page_modification_log_full = 62U;
         constexpr const auto xsaves = 63U;
         constexpr const auto xrstors = 64U;
 
@@ -441,6 +442,9 @@ namespace exit_reason
                 case rdseed:
                     return "rdseed";
 
+                case page_modification_log_full:
+                    return "page_modification_log_full";
+
                 case xsaves:
                     return "xsaves";
 
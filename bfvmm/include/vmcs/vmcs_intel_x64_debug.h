@@ -156,6 +156,10 @@ namespace debug
         dump_vmcs_field(guest_interrupt_status::addr,
                         guest_interrupt_status::name,
                         guest_interrupt_status::exists());
+
+        dump_vmcs_field(guest_pml_index::addr,
+                        guest_pml_index::name,
+                        guest_pml_index::exists());
     }
 
     inline void dump_16bit_host_state_fields()
@@ -22,14 +22,17 @@
 #include <gsl/gsl>
 
 #include <map>
+#include <algorithm>
 #include <debug_ring/debug_ring.h>
 
 // -----------------------------------------------------------------------------
-// Mutex
+// Lock
 // -----------------------------------------------------------------------------
 
 #include <mutex>
-std::mutex g_debug_mutex;
+#include <intrinsics/mem_x64.h>
+#include <intrinsics/lock_x64.h>
+x64::spinlock g_debug_lock("debug_ring");
 
 // -----------------------------------------------------------------------------
 // Global
@@ -68,7 +71,7 @@ debug_ring::debug_ring(vcpuid::type vcpuid) noexcept
         m_drr->tag1 = 0xDB60DB60DB60DB60;
         m_drr->tag2 = 0x06BD06BD06BD06BD;
 
-        std::lock_guard<std::mutex> guard(g_debug_mutex);
+        std::lock_guard<x64::spinlock> guard(g_debug_lock);
         g_drrs[vcpuid] = m_drr.get();
     }
     catch (...)
@@ -80,12 +83,6 @@ debug_ring::write(const std::string &str) noexcept
 {
     try
     {
-        // TODO: A more interesting implementation would use an optimized
-        //       memcpy to implement this code. Doing so would increase it's
-        //       performance, but would require some better math, and an
-        //       optimized memcpy that used both rep string instructions and
-        //       SIMD instructions
-
         expects(m_drr);
         expects(str.length() > 0);
         expects(str.length() < DEBUG_RING_SIZE);
@@ -130,16 +127,18 @@ debug_ring::write(const std::string &str) noexcept
             }
         }
 
-        for (auto i = 0U; i < len; i++)
-        {
-            if (epos >= DEBUG_RING_SIZE)
-                epos = 0;
+        // The string (including the '\0') is copied in at most two pieces,
+        // the first up to the end of the ring, and the rest (if the string
+        // wraps) to the beginning of the ring.
 
-            gsl::at(m_drr->buf, epos) = str[i];
+        auto head = std::min(len, DEBUG_RING_SIZE - epos);
 
-            epos++;
-            m_drr->epos++;
-        }
+        x64::mem::copy(&gsl::at(m_drr->buf, epos), str.c_str(), head);
+
+        if (head < len)
+            x64::mem::copy(&gsl::at(m_drr->buf, 0), str.c_str() + head, len - head);
+
+        m_drr->epos += len;
     }
     catch (...) { }
 }
@@ -57,8 +57,10 @@ INCLUDE_PATHS+=%HYPER_ABS%/include/
 INCLUDE_PATHS+=%HYPER_ABS%/bfvmm/include/
 
 LIBS+=debug_ring
+LIBS+=intrinsics
 
 LIBRARY_PATHS+=%BUILD_REL%/../bin/native/
+LIBRARY_PATHS+=%BUILD_REL%/../../intrinsics/bin/native
 
 ################################################################################
 # Environment Specific
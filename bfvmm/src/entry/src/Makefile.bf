@@ -78,7 +78,7 @@ LIBRARY_PATHS+=
 # Environment Specific
 ################################################################################
 
-VMM_SOURCES+=
+VMM_SOURCES+=entry_vector.cpp
 VMM_INCLUDE_PATHS+=
 VMM_INCLUDE_PATHS+=
 
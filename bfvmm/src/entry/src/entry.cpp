@@ -25,12 +25,15 @@
 #include <entry/entry.h>
 #include <guard_exceptions.h>
 #include <vcpu/vcpu_manager.h>
+#include <intrinsics/mem_x64.h>
 
 extern "C" int64_t
 start_vmm(uint64_t arg) noexcept
 {
     return guard_exceptions(ENTRY_ERROR_VMM_START_FAILED, [&]()
     {
+        x64::mem::init();
+
         g_vcm->create_vcpu(arg);
 
         auto ___ = gsl::on_failure([&]
@@ -0,0 +1,52 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#include <crt.h>
+#include <entry.h>
+#include <memory.h>
+#include <entry/entry.h>
+#include <debug_ring/debug_ring.h>
+
+extern "C" int64_t add_md(struct memory_descriptor *md) noexcept;
+extern "C" int64_t add_mem_chunk(struct memory_chunk *chunk) noexcept;
+
+// -----------------------------------------------------------------------------
+// Entry Vector
+// -----------------------------------------------------------------------------
+
+// The driver entry looks this up once after the VMM is relocated, instead of
+// looking up each entry point by name. Function addresses are link-time
+// constants, so this is initialized statically (and relocated by the ELF
+// loader) rather than by a constructor, which has not run yet at that point.
+
+extern "C" struct vmm_entry_vector_t vmm_entry_vector;
+
+struct vmm_entry_vector_t vmm_entry_vector =
+{
+    reinterpret_cast<void *>(local_init),
+    reinterpret_cast<void *>(local_fini),
+    reinterpret_cast<void *>(add_md),
+    reinterpret_cast<void *>(add_mem_chunk),
+    reinterpret_cast<void *>(start_vmm),
+    reinterpret_cast<void *>(stop_vmm),
+    reinterpret_cast<void *>(get_drr)
+};
@@ -26,6 +26,14 @@
 #include <memory.h>
 #include <eh_frame_list.h>
 
+extern "C" void
+__cpuid(void *eax, void *ebx, void *ecx, void *edx) noexcept
+{ (void) eax; (void) ebx; (void) ecx; (void) edx; }
+
+extern "C" uint32_t
+__cpuid_ecx(uint32_t val) noexcept
+{ (void) val; return 0; }
+
 void
 entry_ut::test_start_vmm_success()
 {
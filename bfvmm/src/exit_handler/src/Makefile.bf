@@ -75,6 +75,8 @@ SOURCES+=exit_handler_intel_x64_support.asm
 SOURCES+=exit_handler_intel_x64_unittests.cpp
 SOURCES+=exit_handler_intel_x64_unittests_containers.cpp
 SOURCES+=exit_handler_intel_x64_unittests_io.cpp
+SOURCES+=guest_profiler_intel_x64.cpp
+SOURCES+=pml_intel_x64.cpp
 
 INCLUDE_PATHS+=./
 INCLUDE_PATHS+=%HYPER_ABS%/include/
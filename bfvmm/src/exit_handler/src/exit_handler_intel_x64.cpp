@@ -21,8 +21,14 @@
 
 #include <gsl/gsl>
 
+#include <array>
+#include <cstring>
+#include <algorithm>
+
 #include <debug.h>
 #include <constants.h>
+#include <exception.h>
+#include <msgpack.h>
 #include <error_codes.h>
 #include <guard_exceptions.h>
 #include <memory_manager/memory_manager_x64.h>
@@ -32,9 +38,12 @@
 
 #include <intrinsics/pm_x64.h>
 #include <intrinsics/cache_x64.h>
+#include <intrinsics/mem_x64.h>
 #include <intrinsics/cpuid_x64.h>
 #include <intrinsics/vmx_intel_x64.h>
+#include <intrinsics/lock_x64.h>
 
+#include <vmcs/vmcs_intel_x64_32bit_control_fields.h>
 #include <vmcs/vmcs_intel_x64_32bit_guest_state_fields.h>
 #include <vmcs/vmcs_intel_x64_32bit_read_only_data_fields.h>
 #include <vmcs/vmcs_intel_x64_natural_width_guest_state_fields.h>
@@ -46,12 +55,29 @@
 using namespace x64;
 using namespace intel_x64;
 
-#include <mutex>
-std::mutex g_unimplemented_handler_mutex;
+// Serializes the output of the CPUs that halt. The lock is locked and
+// unlocked explicitly, as pm::stop() does not return.
+
+x64::spinlock g_unimplemented_handler_lock("unimplemented_handler");
+
+// The general purpose registers in the order they are numbered in the exit
+// qualification of a control register access
+
+static const std::array<uint64_t state_save_intel_x64::*, 16> g_control_register_access_gprs = {{
+    &state_save_intel_x64::rax, &state_save_intel_x64::rcx, &state_save_intel_x64::rdx, &state_save_intel_x64::rbx,
+    &state_save_intel_x64::rsp, &state_save_intel_x64::rbp, &state_save_intel_x64::rsi, &state_save_intel_x64::rdi,
+    &state_save_intel_x64::r08, &state_save_intel_x64::r09, &state_save_intel_x64::r10, &state_save_intel_x64::r11,
+    &state_save_intel_x64::r12, &state_save_intel_x64::r13, &state_save_intel_x64::r14, &state_save_intel_x64::r15
+}};
 
 exit_handler_intel_x64::exit_handler_intel_x64() :
     m_vmcs(nullptr),
-    m_state_save(nullptr)
+    m_state_save(nullptr),
+    m_ring_cr3(0),
+    m_ring_flags(0),
+    m_ring_virt(0),
+    m_ring_phys(0),
+    m_next_data_handle(1)
 { }
 
 void
@@ -61,7 +87,7 @@ exit_handler_intel_x64::dispatch()
 void
 exit_handler_intel_x64::halt() noexcept
 {
-    std::lock_guard<std::mutex> guard(g_unimplemented_handler_mutex);
+    g_unimplemented_handler_lock.lock();
 
     bferror << bfendl;
     bferror << bfendl;
@@ -94,14 +120,42 @@ exit_handler_intel_x64::halt() noexcept
     bferror << bfendl;
     bferror << bfendl;
 
-    g_unimplemented_handler_mutex.unlock();
+    g_unimplemented_handler_lock.unlock();
 
     pm::stop();
 }
 
+void
+exit_handler_intel_x64::invalidate_address_space(uintptr_t cr3) noexcept
+{
+    if (m_ring && m_ring_cr3 == cr3)
+    {
+        m_ring_flags = 0;
+        m_ring_cr3 = 0;
+        m_ring_virt = 0;
+        m_ring_phys = 0;
+        m_ring = nullptr;
+    }
+
+    for (auto iter = m_data_registrations.begin(); iter != m_data_registrations.end();)
+    {
+        if (iter->second.cr3 == cr3)
+            iter = m_data_registrations.erase(iter);
+        else
+            ++iter;
+    }
+
+    update_cr3_load_exiting();
+}
+
 void
 exit_handler_intel_x64::handle_exit(vmcs::value_type reason)
 {
+    if ((m_ring_flags & VMCALL_RING_FLAG_POLL) != 0)
+        poll_vmcall_ring();
+
+    m_pml.sync();
+
     switch (reason)
     {
         case vmcs::exit_reason::basic_exit_reason::cpuid:
@@ -128,6 +182,18 @@ exit_handler_intel_x64::handle_exit(vmcs::value_type reason)
             handle_wrmsr();
             break;
 
+        case vmcs::exit_reason::basic_exit_reason::vmx_preemption_timer_expired:
+            handle_preemption_timer();
+            break;
+
+        case vmcs::exit_reason::basic_exit_reason::page_modification_log_full:
+            handle_pml_full();
+            break;
+
+        case vmcs::exit_reason::basic_exit_reason::control_register_accesses:
+            handle_control_register_access();
+            break;
+
         default:
             unimplemented_handler();
             break;
@@ -188,36 +254,134 @@ exit_handler_intel_x64::handle_vmcall()
     if (m_state_save->rdx != VMCALL_MAGIC_NUMBER)
         return complete_vmcall(BF_VMCALL_FAILURE, regs);
 
+    regs.r00 = m_state_save->rax;
+
     auto &&ret = guard_exceptions(BF_VMCALL_FAILURE, [&]
+    { dispatch_vmcall(regs); });
+
+    complete_vmcall(ret, regs);
+}
+
+void
+exit_handler_intel_x64::dispatch_vmcall(vmcall_registers_t &regs)
+{
+    switch (regs.r00)
     {
-        switch (m_state_save->rax)
+        case VMCALL_VERSIONS:
+            handle_vmcall_versions(regs);
+            break;
+
+        case VMCALL_REGISTERS:
+            handle_vmcall_registers(regs);
+            break;
+
+        case VMCALL_DATA:
+            handle_vmcall_data(regs);
+            break;
+
+        case VMCALL_EVENT:
+            handle_vmcall_event(regs);
+            break;
+
+        case VMCALL_PROFILE:
+            handle_vmcall_profile(regs);
+            break;
+
+        case VMCALL_RING:
+            handle_vmcall_ring(regs);
+            break;
+
+        case VMCALL_DATA_REGISTER:
+            handle_vmcall_data_register(regs);
+            break;
+
+        case VMCALL_DATA_UNREGISTER:
+            handle_vmcall_data_unregister(regs);
+            break;
+
+        case VMCALL_HEAP:
+            handle_vmcall_heap(regs);
+            break;
+
+        case VMCALL_UNITTEST:
+            handle_vmcall_unittest(regs);
+            break;
+
+        case VMCALL_LOCKS:
+            handle_vmcall_locks(regs);
+            break;
+
+        case VMCALL_DIRTY_LOG:
+            handle_vmcall_dirty_log(regs);
+            break;
+
+        default:
+            throw std::runtime_error("unknown vmcall opcode");
+    };
+}
+
+std::size_t
+exit_handler_intel_x64::process_vmcall_ring()
+{
+    auto &&ring = m_ring.get();
+
+    auto &&sq = gsl::make_span(ring->sq);
+    auto &&cq = gsl::make_span(ring->cq);
+
+    auto sq_head = __atomic_load_n(&ring->sq_head, __ATOMIC_RELAXED);
+    auto sq_tail = __atomic_load_n(&ring->sq_tail, __ATOMIC_ACQUIRE);
+    auto cq_head = __atomic_load_n(&ring->cq_head, __ATOMIC_ACQUIRE);
+    auto cq_tail = __atomic_load_n(&ring->cq_tail, __ATOMIC_RELAXED);
+
+    if (sq_tail - sq_head > VMCALL_RING_NUM_ENTRIES)
+        throw std::runtime_error("vmcall ring submission queue corrupt");
+
+    if (cq_tail - cq_head > VMCALL_RING_NUM_ENTRIES)
+        throw std::runtime_error("vmcall ring completion queue corrupt");
+
+    auto num = 0UL;
+
+    while (sq_head != sq_tail && cq_tail - cq_head < VMCALL_RING_NUM_ENTRIES)
+    {
+        // The ring lives in guest memory, so the request is copied before
+        // it is validated by the handlers. Otherwise the guest could change
+        // the registers after they have been checked.
+
+        auto &&sqe = sq[static_cast<std::ptrdiff_t>(sq_head % VMCALL_RING_NUM_ENTRIES)];
+        auto &&cqe = cq[static_cast<std::ptrdiff_t>(cq_tail % VMCALL_RING_NUM_ENTRIES)];
+
+        auto id = sqe.id;
+        auto regs = sqe.regs;
+
+        auto &&ret = guard_exceptions(BF_VMCALL_FAILURE, [&]
         {
-            case VMCALL_VERSIONS:
-                handle_vmcall_versions(regs);
-                break;
+            if (regs.r00 == VMCALL_RING)
+                throw std::runtime_error("vmcall ring cannot be used from a vmcall ring");
 
-            case VMCALL_REGISTERS:
-                handle_vmcall_registers(regs);
-                break;
+            dispatch_vmcall(regs);
+        });
 
-            case VMCALL_DATA:
-                handle_vmcall_data(regs);
-                break;
+        cqe.id = id;
+        cqe.ret = static_cast<decltype(cqe.ret)>(ret);
+        cqe.regs = regs;
 
-            case VMCALL_EVENT:
-                handle_vmcall_event(regs);
-                break;
+        __atomic_store_n(&ring->cq_tail, ++cq_tail, __ATOMIC_RELEASE);
+        __atomic_store_n(&ring->sq_head, ++sq_head, __ATOMIC_RELEASE);
 
-            case VMCALL_UNITTEST:
-                handle_vmcall_unittest(regs);
-                break;
+        num++;
+    }
 
-            default:
-                throw std::runtime_error("unknown vmcall opcode");
-        };
-    });
+    return num;
+}
 
-    complete_vmcall(ret, regs);
+void
+exit_handler_intel_x64::poll_vmcall_ring() noexcept
+{
+    guard_exceptions([&]
+    {
+        if (vmcs::guest_cr3::get() == m_ring_cr3)
+            process_vmcall_ring();
+    });
 }
 
 void
@@ -379,6 +543,95 @@ exit_handler_intel_x64::handle_wrmsr()
     advance_rip();
 }
 
+void
+exit_handler_intel_x64::handle_preemption_timer()
+{ m_profiler.sample(m_state_save->rip); }
+
+void
+exit_handler_intel_x64::handle_pml_full()
+{ m_pml.flush(); }
+
+void
+exit_handler_intel_x64::handle_control_register_access()
+{
+    namespace access = vmcs::exit_qualification::control_register_access;
+
+    auto &&qualification = access::get();
+
+    if (access::control_register_number::get(qualification) != 3 ||
+        access::access_type::get(qualification) != access::access_type::mov_to_cr)
+    {
+        unimplemented_handler();
+        return;
+    }
+
+    auto &&gpr = access::general_purpose_register::get(qualification);
+
+    handle_mov_to_cr3(m_state_save->*g_control_register_access_gprs.at(gpr));
+    advance_rip();
+}
+
+void
+exit_handler_intel_x64::handle_mov_to_cr3(uintptr_t cr3)
+{
+    // Bit 63 is the "do not flush" bit when PCIDs are enabled, and is not
+    // part of CR3. Without VPIDs, the guest's TLB is flushed on every VM
+    // entry, so the load itself needs no other emulation.
+
+    cr3 &= 0x7FFFFFFFFFFFFFFFUL;
+    vmcs::guest_cr3::set(cr3);
+
+    // Linux (and most other OSes) frees a process's page tables when it
+    // exits, which means a later process can be given the same CR3. Before
+    // the new address space can run, make sure the registered buffers are
+    // still mapped to the pages that were registered, otherwise the address
+    // space that registered them is gone.
+
+    auto &&still_mapped = [&](uintptr_t virt, uintptr_t phys)
+    {
+        try
+        {
+            return bfn::virt_to_phys_with_cr3(virt, cr3) == phys;
+        }
+        catch (...)
+        {
+            return false;
+        }
+    };
+
+    auto &&torn_down = m_ring && m_ring_cr3 == cr3 && !still_mapped(m_ring_virt, m_ring_phys);
+
+    for (const auto &iter : m_data_registrations)
+    {
+        if (torn_down)
+            break;
+
+        if (iter.second.cr3 == cr3)
+        {
+            torn_down = !still_mapped(iter.second.ivirt, iter.second.iphys) ||
+                        !still_mapped(iter.second.ovirt, iter.second.ophys);
+        }
+    }
+
+    if (torn_down)
+        invalidate_address_space(cr3);
+}
+
+void
+exit_handler_intel_x64::update_cr3_load_exiting() noexcept
+{
+    // CR3 loads are only trapped while a ring or data buffer is registered
+    // (see handle_mov_to_cr3), as they are one of the most common exits
+    // otherwise.
+
+    namespace controls = vmcs::primary_processor_based_vm_execution_controls;
+
+    if (m_ring || !m_data_registrations.empty())
+        controls::cr3_load_exiting::enable_if_allowed();
+    else
+        controls::cr3_load_exiting::disable_if_allowed();
+}
+
 void
 exit_handler_intel_x64::advance_rip() noexcept
 { m_state_save->rip += vmcs::vm_exit_instruction_length::get(); }
@@ -386,7 +639,7 @@ exit_handler_intel_x64::advance_rip() noexcept
 void
 exit_handler_intel_x64::unimplemented_handler() noexcept
 {
-    std::lock_guard<std::mutex> guard(g_unimplemented_handler_mutex);
+    g_unimplemented_handler_lock.lock();
 
     bferror << bfendl;
     bferror << bfendl;
@@ -422,7 +675,7 @@ exit_handler_intel_x64::unimplemented_handler() noexcept
         { vmcs::debug::dump(); });
     }
 
-    g_unimplemented_handler_mutex.unlock();
+    g_unimplemented_handler_lock.unlock();
 
     this->halt();
 }
@@ -475,40 +728,96 @@ exit_handler_intel_x64::handle_vmcall_registers(vmcall_registers_t &regs)
 void
 exit_handler_intel_x64::handle_vmcall_data(vmcall_registers_t &regs)
 {
-    expects(regs.r05 != 0);
-    expects(regs.r08 != 0);
     expects(regs.r06 != 0);
     expects(regs.r09 != 0);
     expects(regs.r09 >= regs.r06);
+
+    // The handle is only used when both buffer addresses are 0. Callers
+    // that pass buffer addresses never set r10, so whatever it holds is
+    // ignored.
+
+    if (regs.r05 == 0 && regs.r08 == 0)
+    {
+        auto &&iter = m_data_registrations.find(regs.r10);
+        if (iter == m_data_registrations.end())
+            throw std::runtime_error("vmcall data handle not registered");
+
+        auto &&reg = iter->second;
+
+        if (reg.uuid1 != regs.r02 || reg.uuid2 != regs.r03)
+            throw std::runtime_error("vmcall data handle uuid mismatch");
+
+        if (reg.cr3 != vmcs::guest_cr3::get())
+            throw std::runtime_error("vmcall data handle address space mismatch");
+
+        expects(regs.r06 <= reg.imap.size());
+        expects(regs.r09 <= reg.omap.size());
+
+        dispatch_vmcall_data(regs, reg.imap, reg.omap);
+        return;
+    }
+
+    expects(regs.r05 != 0);
+    expects(regs.r08 != 0);
     expects(regs.r06 <= VMCALL_IN_BUFFER_SIZE);
     expects(regs.r09 <= VMCALL_OUT_BUFFER_SIZE);
 
     auto &&imap = bfn::make_unique_map_x64<char>(regs.r05, vmcs::guest_cr3::get(), regs.r06, vmcs::guest_ia32_pat::get());
     auto &&omap = bfn::make_unique_map_x64<char>(regs.r08, vmcs::guest_cr3::get(), regs.r09, vmcs::guest_ia32_pat::get());
 
+    dispatch_vmcall_data(regs, imap, omap);
+}
+
+void
+exit_handler_intel_x64::dispatch_vmcall_data(
+    vmcall_registers_t &regs,
+    const bfn::unique_map_ptr_x64<char> &imap,
+    const bfn::unique_map_ptr_x64<char> &omap)
+{
+    auto &&ibuf = gsl::span<const char>(imap.get(), static_cast<std::ptrdiff_t>(regs.r06));
+    auto &&obuf = gsl::span<char>(omap.get(), static_cast<std::ptrdiff_t>(regs.r09));
+
+    handle_vmcall_data_span(regs, ibuf, obuf);
+
+    if (regs.r09 > static_cast<uintptr_t>(obuf.size()))
+        throw std::out_of_range("vmcall data reply larger than the output buffer");
+}
+
+void
+exit_handler_intel_x64::handle_vmcall_data_span(
+    vmcall_registers_t &regs, gsl::span<const char> ibuf, gsl::span<char> obuf)
+{
     switch (regs.r04)
     {
         case VMCALL_DATA_STRING_UNFORMATTED:
         {
             std::string ostr;
-            handle_vmcall_data_string_unformatted(std::string(imap.get(), regs.r06), ostr);
-            reply_with_string(regs, ostr, omap);
+            handle_vmcall_data_string_unformatted(std::string(ibuf.data(), static_cast<std::size_t>(ibuf.size())), ostr);
+            reply_with_string(regs, ostr, obuf);
             break;
         }
 
         case VMCALL_DATA_STRING_JSON:
         {
             json ojson;
-            handle_vmcall_data_string_json(json::parse(std::string(imap.get(), regs.r06)), ojson);
-            reply_with_json(regs, ojson, omap);
+            handle_vmcall_data_string_json(json::parse(ibuf.data(), ibuf.data() + ibuf.size()), ojson);
+            reply_with_json(regs, ojson, obuf);
+            break;
+        }
+
+        case VMCALL_DATA_BINARY_MSGPACK:
+        {
+            json ojson;
+            handle_vmcall_data_binary_msgpack(bfn::msgpack::parse(ibuf), ojson);
+            reply_with_msgpack(regs, ojson, obuf);
             break;
         }
 
         case VMCALL_DATA_BINARY_UNFORMATTED:
         {
-            handle_vmcall_data_binary_unformatted(imap, omap);
+            handle_vmcall_data_binary_unformatted(ibuf, obuf);
             regs.r07 = VMCALL_DATA_BINARY_UNFORMATTED;
-            regs.r09 = regs.r06;
+            regs.r09 = static_cast<uintptr_t>(ibuf.size());
             break;
         }
 
@@ -524,6 +833,336 @@ exit_handler_intel_x64::handle_vmcall_event(vmcall_registers_t &regs)
     bfdebug << "r02: " << view_as_pointer(regs.r02) << bfendl;
 }
 
+void
+exit_handler_intel_x64::handle_vmcall_profile(vmcall_registers_t &regs)
+{
+    switch (regs.r02)
+    {
+        case VMCALL_PROFILE_START:
+            m_profiler.start(regs.r03);
+            break;
+
+        case VMCALL_PROFILE_STOP:
+            m_profiler.stop();
+            break;
+
+        case VMCALL_PROFILE_COLLECT:
+        {
+            expects(regs.r08 != 0);
+            expects(regs.r09 >= sizeof(vmcall_profile_sample_t));
+            expects(regs.r09 <= VMCALL_OUT_BUFFER_SIZE);
+
+            auto &&omap = bfn::make_unique_map_x64<vmcall_profile_sample_t>(regs.r08, vmcs::guest_cr3::get(), regs.r09, vmcs::guest_ia32_pat::get());
+            auto &&size = static_cast<std::ptrdiff_t>(regs.r09 / sizeof(vmcall_profile_sample_t));
+            auto &&num = m_profiler.collect(gsl::make_span(omap.get(), size));
+
+            regs.r03 = num;
+            regs.r04 = m_profiler.num_samples();
+            regs.r05 = m_profiler.num_dropped();
+            regs.r09 = num * sizeof(vmcall_profile_sample_t);
+            break;
+        }
+
+        default:
+            throw unknown_vmcall_profile_command(std::to_string(regs.r02));
+    }
+}
+
+void
+exit_handler_intel_x64::handle_vmcall_heap(vmcall_registers_t &regs)
+{
+    switch (regs.r02)
+    {
+        case VMCALL_HEAP_START:
+            g_mm->heap_profiler_start();
+            break;
+
+        case VMCALL_HEAP_STOP:
+            g_mm->heap_profiler_stop();
+            break;
+
+        case VMCALL_HEAP_COLLECT:
+        {
+            expects(regs.r08 != 0);
+            expects(regs.r09 >= sizeof(vmcall_heap_site_t));
+            expects(regs.r09 <= VMCALL_OUT_BUFFER_SIZE);
+
+            auto &&omap = bfn::make_unique_map_x64<vmcall_heap_site_t>(regs.r08, vmcs::guest_cr3::get(), regs.r09, vmcs::guest_ia32_pat::get());
+            auto &&size = static_cast<std::ptrdiff_t>(regs.r09 / sizeof(vmcall_heap_site_t));
+            auto &&num = g_mm->heap_profiler_collect(gsl::make_span(omap.get(), size));
+
+            regs.r03 = num;
+            regs.r04 = g_mm->heap_profiler_allocs();
+            regs.r05 = g_mm->heap_profiler_dropped();
+            regs.r09 = num * sizeof(vmcall_heap_site_t);
+            break;
+        }
+
+        case VMCALL_HEAP_POOLS:
+        {
+            expects(regs.r08 != 0);
+            expects(regs.r09 >= sizeof(vmcall_heap_pool_t));
+            expects(regs.r09 <= VMCALL_OUT_BUFFER_SIZE);
+
+            auto &&stats = g_mm->arena_stats();
+
+            auto &&omap = bfn::make_unique_map_x64<vmcall_heap_pool_t>(regs.r08, vmcs::guest_cr3::get(), regs.r09, vmcs::guest_ia32_pat::get());
+            auto &&num = std::min(stats.size(), regs.r09 / sizeof(vmcall_heap_pool_t));
+
+            for (auto i = 0ULL; i < num; i++)
+            {
+                const auto &arena = stats[i];
+                auto &&pool = omap.get()[i];
+
+                pool.type = arena.type;
+                pool.addr = arena.addr;
+                pool.size = arena.size;
+                pool.used = arena.used;
+                pool.peak = arena.peak;
+                pool.largest_free = arena.largest_free;
+                pool.free_ranges = arena.free_ranges;
+
+                std::copy(arena.map.begin(), arena.map.end(), std::begin(pool.map));
+            }
+
+            regs.r03 = num;
+            regs.r04 = stats.size();
+            regs.r09 = num * sizeof(vmcall_heap_pool_t);
+            break;
+        }
+
+        default:
+            throw unknown_vmcall_heap_command(std::to_string(regs.r02));
+    }
+}
+
+static_assert(lock::spinlock == VMCALL_LOCK_SPINLOCK, "lock type mismatch");
+static_assert(lock::ticket == VMCALL_LOCK_TICKET, "lock type mismatch");
+static_assert(lock::mcs == VMCALL_LOCK_MCS, "lock type mismatch");
+static_assert(lock::rw == VMCALL_LOCK_RW, "lock type mismatch");
+
+void
+exit_handler_intel_x64::handle_vmcall_locks(vmcall_registers_t &regs)
+{
+    switch (regs.r02)
+    {
+        case VMCALL_LOCKS_COLLECT:
+        {
+            expects(regs.r08 != 0);
+            expects(regs.r09 >= sizeof(vmcall_lock_stats_t));
+            expects(regs.r09 <= VMCALL_OUT_BUFFER_SIZE);
+
+            auto &&report = lock_report();
+
+            auto &&omap = bfn::make_unique_map_x64<vmcall_lock_stats_t>(regs.r08, vmcs::guest_cr3::get(), regs.r09, vmcs::guest_ia32_pat::get());
+            auto &&num = std::min(report.size(), regs.r09 / sizeof(vmcall_lock_stats_t));
+
+            for (auto i = 0ULL; i < num; i++)
+            {
+                const auto &entry = report[i];
+                auto &&stats = omap.get()[i];
+
+                std::fill(std::begin(stats.name), std::end(stats.name), 0);
+                std::strncpy(stats.name, entry.name, VMCALL_LOCK_NAME_SIZE - 1);
+
+                stats.type = entry.type;
+                stats.acquisitions = entry.acquisitions;
+                stats.contended = entry.contended;
+                stats.spins = entry.spins;
+                stats.max_hold = entry.max_hold;
+            }
+
+            regs.r03 = num;
+            regs.r04 = report.size();
+            regs.r09 = num * sizeof(vmcall_lock_stats_t);
+            break;
+        }
+
+        case VMCALL_LOCKS_RESET:
+            lock_report_reset();
+            break;
+
+        default:
+            throw unknown_vmcall_locks_command(std::to_string(regs.r02));
+    }
+}
+
+void
+exit_handler_intel_x64::handle_vmcall_dirty_log(vmcall_registers_t &regs)
+{
+    switch (regs.r02)
+    {
+        case VMCALL_DIRTY_LOG_START:
+        {
+            auto &&started = false;
+
+            if (!g_dirty_log->is_running())
+            {
+                g_dirty_log->start(regs.r03, regs.r04);
+                started = true;
+            }
+
+            // Each vCPU has to enable PML itself, so the log is started by
+            // the first vCPU, and every other vCPU has to provide the same
+            // range to join it.
+
+            if (g_dirty_log->gpa() != regs.r03 || g_dirty_log->pages() != (regs.r04 >> x64::page_table::pt::from))
+                throw std::runtime_error("dirty log is already running with a different range");
+
+            auto ___ = gsl::on_failure([&]
+            {
+                if (started)
+                    g_dirty_log->stop();
+            });
+
+            m_pml.enable();
+            break;
+        }
+
+        case VMCALL_DIRTY_LOG_STOP:
+            m_pml.disable();
+            g_dirty_log->stop();
+            break;
+
+        case VMCALL_DIRTY_LOG_HARVEST:
+        {
+            expects(regs.r08 != 0);
+            expects(regs.r09 >= sizeof(uint64_t));
+            expects(regs.r09 <= VMCALL_OUT_BUFFER_SIZE);
+
+            // Writes are only logged by vCPUs that have PML enabled, so the
+            // dirty log rejects the harvest unless every vCPU is tracking
+            // writes (including this one).
+
+            if (!m_pml.is_enabled())
+                throw std::runtime_error("dirty log must be harvested from the vcpu that is tracking writes");
+
+            m_pml.flush();
+
+            auto &&omap = bfn::make_unique_map_x64<uint64_t>(regs.r08, vmcs::guest_cr3::get(), regs.r09, vmcs::guest_ia32_pat::get());
+            auto &&size = regs.r09 / sizeof(uint64_t);
+            auto &&first = regs.r03;
+            auto &&num = g_dirty_log->harvest(first, gsl::make_span(omap.get(), static_cast<std::ptrdiff_t>(size)));
+
+            // The harvest cleared EPT dirty flags, so this vCPU's cached
+            // translations have to be invalidated before returning to the
+            // guest. Every other vCPU does the same on its next VM exit, and
+            // until then, the cleared pages are reported again.
+
+            m_pml.sync();
+
+            auto &&pages = g_dirty_log->pages();
+            auto &&words = std::min(size, (pages - first + 63) / 64);
+
+            regs.r03 = num;
+            regs.r04 = g_dirty_log->gpa();
+            regs.r05 = pages;
+            regs.r09 = words * sizeof(uint64_t);
+            break;
+        }
+
+        default:
+            throw unknown_vmcall_dirty_command(std::to_string(regs.r02));
+    }
+}
+
+void
+exit_handler_intel_x64::handle_vmcall_ring(vmcall_registers_t &regs)
+{
+    switch (regs.r02)
+    {
+        case VMCALL_RING_REGISTER:
+            expects(regs.r03 != 0);
+            expects(regs.r04 == sizeof(vmcall_ring_t));
+            expects((regs.r05 & ~static_cast<uintptr_t>(VMCALL_RING_FLAG_POLL)) == 0);
+
+            m_ring = bfn::make_unique_map_x64<vmcall_ring_t>(regs.r03, vmcs::guest_cr3::get(), regs.r04, vmcs::guest_ia32_pat::get());
+            m_ring_cr3 = vmcs::guest_cr3::get();
+            m_ring_flags = regs.r05;
+            m_ring_virt = regs.r03;
+            m_ring_phys = bfn::virt_to_phys_with_cr3(m_ring_virt, m_ring_cr3);
+
+            update_cr3_load_exiting();
+            break;
+
+        case VMCALL_RING_DOORBELL:
+            if (!m_ring)
+                throw std::runtime_error("vmcall ring not registered");
+
+            // The ring is mapped using the registering process's CR3, so
+            // any other process ringing the doorbell could have the VMM
+            // process requests on that process's behalf
+
+            if (vmcs::guest_cr3::get() != m_ring_cr3)
+                throw std::runtime_error("vmcall ring doorbell from a different address space");
+
+            regs.r03 = process_vmcall_ring();
+            break;
+
+        case VMCALL_RING_UNREGISTER:
+            m_ring_flags = 0;
+            m_ring_cr3 = 0;
+            m_ring_virt = 0;
+            m_ring_phys = 0;
+            m_ring = nullptr;
+
+            update_cr3_load_exiting();
+            break;
+
+        default:
+            throw std::runtime_error("unknown vmcall ring command");
+    }
+}
+
+void
+exit_handler_intel_x64::handle_vmcall_data_register(vmcall_registers_t &regs)
+{
+    expects(regs.r05 != 0);
+    expects(regs.r08 != 0);
+    expects(regs.r06 != 0);
+    expects(regs.r09 != 0);
+    expects(regs.r09 >= regs.r06);
+    expects(regs.r06 <= VMCALL_IN_BUFFER_SIZE);
+    expects(regs.r09 <= VMCALL_OUT_BUFFER_SIZE);
+
+    if (m_data_registrations.size() >= MAX_VMCALL_DATA_REGISTRATIONS)
+        throw std::runtime_error("too many vmcall data registrations");
+
+    for (const auto &iter : m_data_registrations)
+    {
+        if (iter.second.uuid1 == regs.r02 && iter.second.uuid2 == regs.r03)
+            throw std::runtime_error("vmcall data uuid already registered");
+    }
+
+    auto &&cr3 = vmcs::guest_cr3::get();
+
+    auto &&imap = bfn::make_unique_map_x64<char>(regs.r05, cr3, regs.r06, vmcs::guest_ia32_pat::get());
+    auto &&omap = bfn::make_unique_map_x64<char>(regs.r08, cr3, regs.r09, vmcs::guest_ia32_pat::get());
+
+    auto &&iphys = bfn::virt_to_phys_with_cr3(regs.r05, cr3);
+    auto &&ophys = bfn::virt_to_phys_with_cr3(regs.r08, cr3);
+
+    auto &&handle = m_next_data_handle++;
+    m_data_registrations[handle] = {regs.r02, regs.r03, cr3, regs.r05, iphys, regs.r08, ophys, std::move(imap), std::move(omap)};
+
+    regs.r04 = handle;
+    update_cr3_load_exiting();
+}
+
+void
+exit_handler_intel_x64::handle_vmcall_data_unregister(vmcall_registers_t &regs)
+{
+    auto &&iter = m_data_registrations.find(regs.r04);
+    if (iter == m_data_registrations.end())
+        throw std::runtime_error("vmcall data handle not registered");
+
+    if (iter->second.uuid1 != regs.r02 || iter->second.uuid2 != regs.r03)
+        throw std::runtime_error("vmcall data handle uuid mismatch");
+
+    m_data_registrations.erase(iter);
+    update_cr3_load_exiting();
+}
+
 void
 exit_handler_intel_x64::handle_vmcall_data_string_unformatted(
     const std::string &istr, std::string &ostr)
@@ -540,22 +1179,31 @@ exit_handler_intel_x64::handle_vmcall_data_string_json(
     ojson = ijson;
 }
 
+void
+exit_handler_intel_x64::handle_vmcall_data_binary_msgpack(
+    const json &ijson, json &ojson)
+{ handle_vmcall_data_string_json(ijson, ojson); }
+
 void
 exit_handler_intel_x64::handle_vmcall_data_binary_unformatted(
-    const bfn::unique_map_ptr_x64<char> &imap,
-    const bfn::unique_map_ptr_x64<char> &omap)
+    gsl::span<const char> ibuf, gsl::span<char> obuf)
 {
+    expects(obuf.size() >= ibuf.size());
+
     bfdebug << "received binary data" << bfendl;
-    __builtin_memcpy(omap.get(), imap.get(), imap.size());
+    x64::mem::copy(obuf.data(), ibuf.data(), static_cast<std::size_t>(ibuf.size()));
 }
 
-void exit_handler_intel_x64::reply_with_string(
-    vmcall_registers_t &regs, const std::string &str,
-    const bfn::unique_map_ptr_x64<char> &omap)
+void
+exit_handler_intel_x64::reply_with_string(
+    vmcall_registers_t &regs, const std::string &str, gsl::span<char> obuf)
 {
     auto &&len = str.length();
 
-    __builtin_memcpy(omap.get(), str.data(), len);
+    if (len > static_cast<std::size_t>(obuf.size()))
+        throw std::out_of_range("vmcall data reply larger than the output buffer");
+
+    x64::mem::copy(obuf.data(), str.data(), len);
 
     regs.r07 = VMCALL_DATA_STRING_UNFORMATTED;
     regs.r09 = len;
@@ -563,14 +1211,26 @@ void exit_handler_intel_x64::reply_with_string(
 
 void
 exit_handler_intel_x64::reply_with_json(
-    vmcall_registers_t &regs, const json &str,
-    const bfn::unique_map_ptr_x64<char> &omap)
+    vmcall_registers_t &regs, const json &obj, gsl::span<char> obuf)
 {
-    auto &&dmp = str.dump();
+    auto &&dmp = obj.dump();
     auto &&len = dmp.length();
 
-    __builtin_memcpy(omap.get(), dmp.data(), len);
+    if (len > static_cast<std::size_t>(obuf.size()))
+        throw std::out_of_range("vmcall data reply larger than the output buffer");
+
+    x64::mem::copy(obuf.data(), dmp.data(), len);
 
     regs.r07 = VMCALL_DATA_STRING_JSON;
     regs.r09 = len;
 }
+
+void
+exit_handler_intel_x64::reply_with_msgpack(
+    vmcall_registers_t &regs, const json &obj, gsl::span<char> obuf)
+{
+    auto &&len = bfn::msgpack::dump(obj, obuf);
+
+    regs.r07 = VMCALL_DATA_BINARY_MSGPACK;
+    regs.r09 = len;
+}
@@ -0,0 +1,123 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#include <gsl/gsl>
+
+#include <exit_handler/guest_profiler_intel_x64.h>
+
+#include <vmcs/vmcs_intel_x64_32bit_control_fields.h>
+#include <vmcs/vmcs_intel_x64_32bit_guest_state_fields.h>
+#include <vmcs/vmcs_intel_x64_natural_width_guest_state_fields.h>
+
+using namespace intel_x64;
+
+guest_profiler_intel_x64::guest_profiler_intel_x64() noexcept :
+    m_period(0),
+    m_head(0),
+    m_num(0),
+    m_dropped(0)
+{ }
+
+void
+guest_profiler_intel_x64::start(period_type period)
+{
+    expects(period != 0);
+
+    if (!m_samples)
+        m_samples = std::make_unique<sample_type[]>(PROFILE_SAMPLE_BUFFER_SIZE);
+
+    vmcs::vmx_preemption_timer_value::set(period);
+    vmcs::pin_based_vm_execution_controls::activate_vmx_preemption_timer::enable();
+
+    // Saving the timer value on exit ensures that unrelated VM exits do not
+    // restart the countdown, which would otherwise bias the samples away
+    // from code that causes frequent exits.
+
+    vmcs::vm_exit_controls::save_vmx_preemption_timer_value::enable_if_allowed();
+
+    m_period = period;
+}
+
+void
+guest_profiler_intel_x64::stop()
+{
+    if (m_period == 0)
+        return;
+
+    vmcs::vm_exit_controls::save_vmx_preemption_timer_value::disable_if_allowed();
+    vmcs::pin_based_vm_execution_controls::activate_vmx_preemption_timer::disable();
+
+    m_period = 0;
+}
+
+void
+guest_profiler_intel_x64::sample(uint64_t rip)
+{
+    if (m_period == 0)
+        return;
+
+    if (m_num < PROFILE_SAMPLE_BUFFER_SIZE)
+    {
+        auto &&samples = gsl::make_span(m_samples.get(), PROFILE_SAMPLE_BUFFER_SIZE);
+        auto &&index = (m_head + m_num) % PROFILE_SAMPLE_BUFFER_SIZE;
+
+        samples[static_cast<std::ptrdiff_t>(index)] = sample_type
+        {
+            rip,
+            vmcs::guest_cr3::get(),
+            vmcs::guest_ss_access_rights::dpl::get()
+        };
+
+        m_num++;
+    }
+    else
+    {
+        m_dropped++;
+    }
+
+    vmcs::vmx_preemption_timer_value::set(m_period);
+}
+
+guest_profiler_intel_x64::size_type
+guest_profiler_intel_x64::collect(gsl::span<sample_type> samples) noexcept
+{
+    size_type num = 0;
+
+    if (!m_samples)
+        return 0;
+
+    auto &&buffer = gsl::make_span(m_samples.get(), PROFILE_SAMPLE_BUFFER_SIZE);
+
+    for (auto &sample : samples)
+    {
+        if (m_num == 0)
+            break;
+
+        sample = buffer[static_cast<std::ptrdiff_t>(m_head)];
+
+        m_head = (m_head + 1) % PROFILE_SAMPLE_BUFFER_SIZE;
+        m_num--;
+        num++;
+    }
+
+    return num;
+}
@@ -0,0 +1,148 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <gsl/gsl>
+
+#include <exit_handler/pml_intel_x64.h>
+#include <memory_manager/memory_manager_x64.h>
+
+#include <intrinsics/vmx_intel_x64.h>
+#include <intrinsics/msrs_intel_x64.h>
+
+#include <vmcs/vmcs_intel_x64_16bit_guest_state_fields.h>
+#include <vmcs/vmcs_intel_x64_32bit_control_fields.h>
+#include <vmcs/vmcs_intel_x64_64bit_control_fields.h>
+
+using namespace intel_x64;
+
+// The PML buffer is a single 4k page of 512 guest physical addresses, and
+// the CPU logs the first write into the last entry.
+
+constexpr const auto pml_num_entries = 512UL;
+
+pml_intel_x64::pml_intel_x64() noexcept :
+    m_enabled(false),
+    m_logged(0),
+    m_generation(0),
+    m_buffer_phys(0)
+{ }
+
+void
+pml_intel_x64::enable()
+{
+    if (m_enabled)
+        return;
+
+    if (!msrs::ia32_vmx_procbased_ctls2::enable_pml::is_allowed1())
+        throw std::logic_error("hardware does not support pml");
+
+    if (!msrs::ia32_vmx_ept_vpid_cap::accessed_dirty_support::get())
+        throw std::logic_error("hardware does not support dirty / accessed flags for ept");
+
+    if (!vmcs::secondary_processor_based_vm_execution_controls::enable_ept::is_enabled())
+        throw std::logic_error("ept must be enabled if pml is enabled");
+
+    if (!m_buffer)
+    {
+        m_buffer = std::make_unique<integer_pointer[]>(pml_num_entries);
+        m_buffer_phys = g_mm->virtptr_to_physint(m_buffer.get());
+    }
+
+    vmcs::pml_address::set(m_buffer_phys);
+    vmcs::guest_pml_index::set(pml_num_entries - 1);
+
+    vmcs::ept_pointer::accessed_and_dirty_flags::enable();
+    vmcs::secondary_processor_based_vm_execution_controls::enable_pml::enable();
+
+    // Translations that were cached before the accessed and dirty flags
+    // were enabled would not set the dirty flags. The vCPU is registered
+    // first, so that the pages that a harvest on another vCPU clears before
+    // this invalidation are reported again (see dirty_log_intel_x64).
+
+    m_generation = g_dirty_log->add_tracking_vcpu();
+    vmx::invept_single_context(vmcs::ept_pointer::get());
+    g_dirty_log->vcpu_synced(m_generation);
+
+    m_enabled = true;
+}
+
+void
+pml_intel_x64::disable()
+{
+    if (!m_enabled)
+        return;
+
+    this->flush();
+
+    vmcs::secondary_processor_based_vm_execution_controls::enable_pml::disable();
+    vmcs::ept_pointer::accessed_and_dirty_flags::disable();
+
+    vmx::invept_single_context(vmcs::ept_pointer::get());
+    g_dirty_log->remove_tracking_vcpu(m_generation);
+
+    m_enabled = false;
+}
+
+void
+pml_intel_x64::flush()
+{
+    if (!m_enabled)
+        return;
+
+    // The index is decremented after each entry is written, so the entries
+    // that have been written are index + 1 to the end of the buffer. When
+    // the buffer is full, the index wraps to 0xFFFF.
+
+    auto &&index = vmcs::guest_pml_index::get();
+    auto &&first = index < pml_num_entries ? index + 1 : 0;
+
+    if (first < pml_num_entries)
+    {
+        auto &&buffer = gsl::make_span(m_buffer.get(), pml_num_entries);
+        auto &&entries = buffer.subspan(static_cast<std::ptrdiff_t>(first));
+
+        g_dirty_log->log(entries);
+        m_logged += pml_num_entries - first;
+    }
+
+    vmcs::guest_pml_index::set(pml_num_entries - 1);
+}
+
+void
+pml_intel_x64::sync()
+{
+    if (!m_enabled)
+        return;
+
+    auto &&generation = g_dirty_log->generation();
+
+    if (generation == m_generation)
+        return;
+
+    if (!g_dirty_log->is_running())
+        return this->disable();
+
+    this->flush();
+    vmx::invept_single_context(vmcs::ept_pointer::get());
+
+    m_generation = generation;
+    g_dirty_log->vcpu_synced(generation);
+}
@@ -86,6 +86,68 @@ exit_handler_intel_x64_ut::list()
     this->test_vm_exit_reason_vmcall_data_data_unformatted_output_size_too_big();
     this->test_vm_exit_reason_vmcall_data_data_unformatted_map_fails();
     this->test_vm_exit_reason_vmcall_data_data_unformatted_success();
+    this->test_vm_exit_reason_vmcall_data_binary_msgpack_invalid();
+    this->test_vm_exit_reason_vmcall_data_binary_msgpack_output_too_small();
+    this->test_vm_exit_reason_vmcall_data_binary_msgpack_success();
+    this->test_vm_exit_reason_vmcall_profile_start();
+    this->test_vm_exit_reason_vmcall_profile_start_period_0();
+    this->test_vm_exit_reason_vmcall_profile_stop();
+    this->test_vm_exit_reason_vmcall_profile_collect_output_nullptr();
+    this->test_vm_exit_reason_vmcall_profile_collect_output_size_too_small();
+    this->test_vm_exit_reason_vmcall_profile_collect_output_size_too_big();
+    this->test_vm_exit_reason_vmcall_profile_collect_success();
+    this->test_vm_exit_reason_vmcall_profile_unknown();
+    this->test_vm_exit_reason_vmcall_heap_start();
+    this->test_vm_exit_reason_vmcall_heap_stop();
+    this->test_vm_exit_reason_vmcall_heap_collect_output_nullptr();
+    this->test_vm_exit_reason_vmcall_heap_collect_success();
+    this->test_vm_exit_reason_vmcall_heap_pools_success();
+    this->test_vm_exit_reason_vmcall_heap_unknown();
+    this->test_vm_exit_reason_vmcall_locks_collect_success();
+    this->test_vm_exit_reason_vmcall_locks_reset();
+    this->test_vm_exit_reason_vmcall_locks_unknown();
+    this->test_vm_exit_reason_preemption_timer();
+    this->test_vm_exit_reason_pml_full();
+    this->test_vm_exit_reason_pml_sync();
+    this->test_vm_exit_reason_vmcall_dirty_log_start_success();
+    this->test_vm_exit_reason_vmcall_dirty_log_start_range_mismatch();
+    this->test_vm_exit_reason_vmcall_dirty_log_start_pml_unsupported();
+    this->test_vm_exit_reason_vmcall_dirty_log_stop();
+    this->test_vm_exit_reason_vmcall_dirty_log_harvest_output_nullptr();
+    this->test_vm_exit_reason_vmcall_dirty_log_harvest_output_size_too_small();
+    this->test_vm_exit_reason_vmcall_dirty_log_harvest_not_tracking();
+    this->test_vm_exit_reason_vmcall_dirty_log_harvest_success();
+    this->test_vm_exit_reason_vmcall_dirty_log_unknown();
+    this->test_vm_exit_reason_vmcall_ring_register_invalid_size();
+    this->test_vm_exit_reason_vmcall_ring_register_invalid_flags();
+    this->test_vm_exit_reason_vmcall_ring_register_success();
+    this->test_vm_exit_reason_vmcall_ring_doorbell_not_registered();
+    this->test_vm_exit_reason_vmcall_ring_doorbell_wrong_cr3();
+    this->test_vm_exit_reason_vmcall_ring_doorbell_corrupt();
+    this->test_vm_exit_reason_vmcall_ring_doorbell_completion_full();
+    this->test_vm_exit_reason_vmcall_ring_doorbell_success();
+    this->test_vm_exit_reason_vmcall_ring_unregister();
+    this->test_vm_exit_reason_vmcall_ring_poll();
+    this->test_vm_exit_reason_vmcall_data_register_success();
+    this->test_vm_exit_reason_vmcall_data_register_input_nullptr();
+    this->test_vm_exit_reason_vmcall_data_register_duplicate_uuid();
+    this->test_vm_exit_reason_vmcall_data_register_too_many();
+    this->test_vm_exit_reason_vmcall_data_unregistered_ignores_r10();
+    this->test_vm_exit_reason_vmcall_data_registered_not_registered();
+    this->test_vm_exit_reason_vmcall_data_registered_uuid_mismatch();
+    this->test_vm_exit_reason_vmcall_data_registered_cr3_mismatch();
+    this->test_vm_exit_reason_vmcall_data_registered_size_too_big();
+    this->test_vm_exit_reason_vmcall_data_registered_success();
+    this->test_vm_exit_reason_vmcall_data_unregister_not_registered();
+    this->test_vm_exit_reason_vmcall_data_unregister_success();
+    this->test_vm_exit_reason_vmcall_data_span_success();
+    this->test_vm_exit_reason_vmcall_data_span_reply_too_large();
+    this->test_invalidate_address_space();
+    this->test_vm_exit_reason_mov_to_cr3();
+    this->test_vm_exit_reason_mov_to_cr3_torn_down();
+    this->test_vm_exit_reason_mov_to_cr3_ring_unmapped();
+    this->test_vm_exit_reason_mov_from_cr3();
+    this->test_cr3_load_exiting_follows_registrations();
     this->test_vm_exit_reason_vmxoff();
     this->test_vm_exit_reason_rdmsr_debug_ctl();
     this->test_vm_exit_reason_rdmsr_pat();
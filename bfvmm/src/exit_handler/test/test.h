@@ -85,6 +85,68 @@ private:
     void test_vm_exit_reason_vmcall_data_data_unformatted_output_size_too_big();
     void test_vm_exit_reason_vmcall_data_data_unformatted_map_fails();
     void test_vm_exit_reason_vmcall_data_data_unformatted_success();
+    void test_vm_exit_reason_vmcall_data_binary_msgpack_invalid();
+    void test_vm_exit_reason_vmcall_data_binary_msgpack_output_too_small();
+    void test_vm_exit_reason_vmcall_data_binary_msgpack_success();
+    void test_vm_exit_reason_vmcall_profile_start();
+    void test_vm_exit_reason_vmcall_profile_start_period_0();
+    void test_vm_exit_reason_vmcall_profile_stop();
+    void test_vm_exit_reason_vmcall_profile_collect_output_nullptr();
+    void test_vm_exit_reason_vmcall_profile_collect_output_size_too_small();
+    void test_vm_exit_reason_vmcall_profile_collect_output_size_too_big();
+    void test_vm_exit_reason_vmcall_profile_collect_success();
+    void test_vm_exit_reason_vmcall_profile_unknown();
+    void test_vm_exit_reason_vmcall_heap_start();
+    void test_vm_exit_reason_vmcall_heap_stop();
+    void test_vm_exit_reason_vmcall_heap_collect_output_nullptr();
+    void test_vm_exit_reason_vmcall_heap_collect_success();
+    void test_vm_exit_reason_vmcall_heap_pools_success();
+    void test_vm_exit_reason_vmcall_heap_unknown();
+    void test_vm_exit_reason_vmcall_locks_collect_success();
+    void test_vm_exit_reason_vmcall_locks_reset();
+    void test_vm_exit_reason_vmcall_locks_unknown();
+    void test_vm_exit_reason_preemption_timer();
+    void test_vm_exit_reason_pml_full();
+    void test_vm_exit_reason_pml_sync();
+    void test_vm_exit_reason_vmcall_dirty_log_start_success();
+    void test_vm_exit_reason_vmcall_dirty_log_start_range_mismatch();
+    void test_vm_exit_reason_vmcall_dirty_log_start_pml_unsupported();
+    void test_vm_exit_reason_vmcall_dirty_log_stop();
+    void test_vm_exit_reason_vmcall_dirty_log_harvest_output_nullptr();
+    void test_vm_exit_reason_vmcall_dirty_log_harvest_output_size_too_small();
+    void test_vm_exit_reason_vmcall_dirty_log_harvest_not_tracking();
+    void test_vm_exit_reason_vmcall_dirty_log_harvest_success();
+    void test_vm_exit_reason_vmcall_dirty_log_unknown();
+    void test_vm_exit_reason_vmcall_ring_register_invalid_size();
+    void test_vm_exit_reason_vmcall_ring_register_invalid_flags();
+    void test_vm_exit_reason_vmcall_ring_register_success();
+    void test_vm_exit_reason_vmcall_ring_doorbell_not_registered();
+    void test_vm_exit_reason_vmcall_ring_doorbell_wrong_cr3();
+    void test_vm_exit_reason_vmcall_ring_doorbell_corrupt();
+    void test_vm_exit_reason_vmcall_ring_doorbell_completion_full();
+    void test_vm_exit_reason_vmcall_ring_doorbell_success();
+    void test_vm_exit_reason_vmcall_ring_unregister();
+    void test_vm_exit_reason_vmcall_ring_poll();
+    void test_vm_exit_reason_vmcall_data_register_success();
+    void test_vm_exit_reason_vmcall_data_register_input_nullptr();
+    void test_vm_exit_reason_vmcall_data_register_duplicate_uuid();
+    void test_vm_exit_reason_vmcall_data_register_too_many();
+    void test_vm_exit_reason_vmcall_data_unregistered_ignores_r10();
+    void test_vm_exit_reason_vmcall_data_registered_not_registered();
+    void test_vm_exit_reason_vmcall_data_registered_uuid_mismatch();
+    void test_vm_exit_reason_vmcall_data_registered_cr3_mismatch();
+    void test_vm_exit_reason_vmcall_data_registered_size_too_big();
+    void test_vm_exit_reason_vmcall_data_registered_success();
+    void test_vm_exit_reason_vmcall_data_unregister_not_registered();
+    void test_vm_exit_reason_vmcall_data_unregister_success();
+    void test_vm_exit_reason_vmcall_data_span_success();
+    void test_vm_exit_reason_vmcall_data_span_reply_too_large();
+    void test_invalidate_address_space();
+    void test_vm_exit_reason_mov_to_cr3();
+    void test_vm_exit_reason_mov_to_cr3_torn_down();
+    void test_vm_exit_reason_mov_to_cr3_ring_unmapped();
+    void test_vm_exit_reason_mov_from_cr3();
+    void test_cr3_load_exiting_follows_registrations();
     void test_vm_exit_reason_vmxoff();
     void test_vm_exit_reason_rdmsr_debug_ctl();
     void test_vm_exit_reason_rdmsr_pat();
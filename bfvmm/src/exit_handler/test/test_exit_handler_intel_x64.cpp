@@ -23,6 +23,8 @@
 
 #include <vmcs/vmcs_intel_x64.h>
 #include <vmcs/vmcs_intel_x64_check.h>
+#include <vmcs/vmcs_intel_x64_16bit_guest_state_fields.h>
+#include <vmcs/vmcs_intel_x64_32bit_control_fields.h>
 #include <vmcs/vmcs_intel_x64_32bit_guest_state_fields.h>
 #include <vmcs/vmcs_intel_x64_64bit_guest_state_fields.h>
 #include <vmcs/vmcs_intel_x64_32bit_read_only_data_fields.h>
@@ -35,20 +37,51 @@
 
 #include <memory_manager/memory_manager_x64.h>
 #include <memory_manager/root_page_table_x64.h>
+#include <memory_manager/dirty_log_intel_x64.h>
 
 #include <intrinsics/msrs_x64.h>
+#include <intrinsics/lock_x64.h>
 #include <intrinsics/msrs_intel_x64.h>
 
+#include <msgpack.h>
+
 using namespace x64;
 using namespace intel_x64;
 using namespace vmcs;
 
+static auto operator"" _uvpce(const char *str, std::size_t len)
+{ (void)str; (void)len; return std::make_shared<bfn::unknown_vmcall_profile_command_error>(""); }
+
+static auto operator"" _uvhce(const char *str, std::size_t len)
+{ (void)str; (void)len; return std::make_shared<bfn::unknown_vmcall_heap_command_error>(""); }
+
+static auto operator"" _uvlce(const char *str, std::size_t len)
+{ (void)str; (void)len; return std::make_shared<bfn::unknown_vmcall_locks_command_error>(""); }
+
+static auto operator"" _uvdce(const char *str, std::size_t len)
+{ (void)str; (void)len; return std::make_shared<bfn::unknown_vmcall_dirty_command_error>(""); }
+
+class exit_handler_vmcall_ut : public exit_handler_intel_x64
+{
+public:
+    using exit_handler_intel_x64::handle_vmcall_profile;
+    using exit_handler_intel_x64::handle_vmcall_dirty_log;
+    using exit_handler_intel_x64::handle_vmcall_locks;
+    using exit_handler_intel_x64::handle_vmcall_heap;
+};
+
 vmcs::field_type g_field = 0;
 vmcs::value_type g_value = 0;
 vmcs::value_type g_exit_reason = 0;
 vmcs::value_type g_exit_qualification = 0;
 vmcs::value_type g_exit_instruction_length = 8;
 vmcs::value_type g_exit_instruction_information = 0;
+vmcs::value_type g_primary_controls = 0;
+vmcs::value_type g_secondary_controls = 0;
+vmcs::value_type g_guest_cr3 = 0;
+vmcs::value_type g_pml_index = 0;
+
+uint64_t g_invept = 0;
 
 static std::map<intel_x64::msrs::field_type, intel_x64::msrs::value_type> g_msrs;
 
@@ -80,6 +113,15 @@ __vmread(uint64_t field, uint64_t *val) noexcept
         case vmcs::guest_physical_address::addr:
             *val = 0x0;
             break;
+        case vmcs::primary_processor_based_vm_execution_controls::addr:
+            *val = g_primary_controls;
+            break;
+        case vmcs::secondary_processor_based_vm_execution_controls::addr:
+            *val = g_secondary_controls;
+            break;
+        case vmcs::guest_pml_index::addr:
+            *val = g_pml_index;
+            break;
         default:
             g_field = field;
             *val = g_value;
@@ -92,6 +134,24 @@ __vmread(uint64_t field, uint64_t *val) noexcept
 extern "C"  bool
 __vmwrite(uint64_t field, uint64_t val) noexcept
 {
+    switch (field)
+    {
+        case vmcs::primary_processor_based_vm_execution_controls::addr:
+            g_primary_controls = val;
+            return true;
+        case vmcs::secondary_processor_based_vm_execution_controls::addr:
+            g_secondary_controls = val;
+            return true;
+        case vmcs::guest_cr3::addr:
+            g_guest_cr3 = val;
+            return true;
+        case vmcs::guest_pml_index::addr:
+            g_pml_index = val;
+            return true;
+        default:
+            break;
+    }
+
     g_field = field;
     g_value = val;
 
@@ -110,6 +170,10 @@ extern "C" void
 __stop(void) noexcept
 { }
 
+extern "C" void
+__invept(uint64_t type, void *ptr) noexcept
+{ (void) type; (void) ptr; g_invept++; }
+
 extern "C" void
 __wbinvd(void) noexcept
 { }
@@ -693,6 +757,7 @@ exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_string_unformatted_su
     ehlr.m_state_save->r09 = g_msg.size();                       // r06
     ehlr.m_state_save->r11 = 0x1234U;                            // r08
     ehlr.m_state_save->r12 = g_msg.size();                       // r09
+    ehlr.m_state_save->r13 = 0;                                  // r10
 
     __builtin_memcpy(g_map.get(), g_msg.data(), g_msg.size());
 
@@ -948,6 +1013,7 @@ exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_string_json_success()
     ehlr.m_state_save->r09 = g_msg.size();                       // r06
     ehlr.m_state_save->r11 = 0x1234U;                            // r08
     ehlr.m_state_save->r12 = g_msg.size();                       // r09
+    ehlr.m_state_save->r13 = 0;                                  // r10
 
     __builtin_memcpy(g_map.get(), g_msg.data(), g_msg.size());
 
@@ -1175,6 +1241,7 @@ exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_data_unformatted_succ
     ehlr.m_state_save->r09 = g_msg.size();                       // r06
     ehlr.m_state_save->r11 = 0x1234U;                            // r08
     ehlr.m_state_save->r12 = g_msg.size();                       // r09
+    ehlr.m_state_save->r13 = 0;                                  // r10
 
     __builtin_memcpy(g_map.get(), g_msg.data(), g_msg.size());
 
@@ -1186,6 +1253,2043 @@ exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_data_unformatted_succ
     });
 }
 
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_binary_msgpack_invalid()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    auto &&msg = "\xC1"_s;
+
+    ehlr.m_state_save->rax = VMCALL_DATA;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rsi = VMCALL_DATA_BINARY_MSGPACK;         // r04
+    ehlr.m_state_save->r08 = 0x1234U;                            // r05
+    ehlr.m_state_save->r09 = msg.size();                         // r06
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = 100;                                // r09
+    ehlr.m_state_save->r13 = 0;                                  // r10
+
+    __builtin_memcpy(g_map.get(), msg.data(), msg.size());
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_binary_msgpack_output_too_small()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    auto &&msg = bfn::msgpack::dump(json::parse(g_msg));
+
+    ehlr.m_state_save->rax = VMCALL_DATA;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rsi = VMCALL_DATA_BINARY_MSGPACK;         // r04
+    ehlr.m_state_save->r08 = 0x1234U;                            // r05
+    ehlr.m_state_save->r09 = msg.size();                         // r06
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = msg.size();                         // r09
+    ehlr.m_state_save->r13 = 0;                                  // r10
+
+    __builtin_memcpy(g_map.get(), msg.data(), msg.size());
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        ehlr.m_state_save->r12 = msg.size() - 1;
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_binary_msgpack_success()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    auto &&msg = bfn::msgpack::dump(json::parse(g_msg));
+
+    ehlr.m_state_save->rax = VMCALL_DATA;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rsi = VMCALL_DATA_BINARY_MSGPACK;         // r04
+    ehlr.m_state_save->r08 = 0x1234U;                            // r05
+    ehlr.m_state_save->r09 = msg.size();                         // r06
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = 100;                                // r09
+    ehlr.m_state_save->r13 = 0;                                  // r10
+
+    __builtin_memcpy(g_map.get(), msg.data(), msg.size());
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_state_save->r10 == VMCALL_DATA_BINARY_MSGPACK);
+        this->expect_true(ehlr.m_state_save->r12 == msg.size());
+        this->expect_true(__builtin_memcmp(g_map.get(), msg.data(), msg.size()) == 0);
+    });
+}
+
+static void
+setup_profiler_ctls()
+{
+    g_msrs[intel_x64::msrs::ia32_vmx_true_pinbased_ctls::addr] = 0xFFFFFFFF00000000UL;
+    g_msrs[intel_x64::msrs::ia32_vmx_true_exit_ctls::addr] = 0xFFFFFFFF00000000UL;
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_profile_start()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_profiler_ctls();
+
+    ehlr.m_state_save->rax = VMCALL_PROFILE;                     // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_PROFILE_START;               // r02
+    ehlr.m_state_save->rbx = 0x1000U;                            // r03
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_profiler.is_running());
+        this->expect_true(ehlr.m_profiler.period() == 0x1000U);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_profile_start_period_0()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_profiler_ctls();
+
+    ehlr.m_state_save->rax = VMCALL_PROFILE;                     // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_PROFILE_START;               // r02
+    ehlr.m_state_save->rbx = 0;                                  // r03
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+        this->expect_false(ehlr.m_profiler.is_running());
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_profile_stop()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_profiler_ctls();
+
+    ehlr.m_state_save->rax = VMCALL_PROFILE;                     // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_PROFILE_STOP;                // r02
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.m_profiler.start(0x1000U); });
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_false(ehlr.m_profiler.is_running());
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_profile_collect_output_nullptr()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_PROFILE;                     // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_PROFILE_COLLECT;             // r02
+    ehlr.m_state_save->r11 = 0;                                  // r08
+    ehlr.m_state_save->r12 = sizeof(vmcall_profile_sample_t);    // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_profile_collect_output_size_too_small()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_PROFILE;                     // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_PROFILE_COLLECT;             // r02
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = sizeof(vmcall_profile_sample_t) - 1; // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_profile_collect_output_size_too_big()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_PROFILE;                     // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_PROFILE_COLLECT;             // r02
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = VMCALL_OUT_BUFFER_SIZE + 1;         // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_profile_collect_success()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+    setup_profiler_ctls();
+
+    ehlr.m_state_save->rax = VMCALL_PROFILE;                     // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_PROFILE_COLLECT;             // r02
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = sizeof(vmcall_profile_sample_t) * 2; // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.m_profiler.start(0x1000U); });
+        this->expect_no_exception([&]{ ehlr.m_profiler.sample(0x10U); });
+        this->expect_no_exception([&]{ ehlr.m_profiler.sample(0x20U); });
+        this->expect_no_exception([&]{ ehlr.m_profiler.sample(0x30U); });
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_state_save->rbx == 2);
+        this->expect_true(ehlr.m_state_save->rsi == 1);
+        this->expect_true(ehlr.m_state_save->r08 == 0);
+        this->expect_true(ehlr.m_state_save->r12 == sizeof(vmcall_profile_sample_t) * 2);
+
+        auto &&samples = reinterpret_cast<vmcall_profile_sample_t *>(g_map.get());
+        this->expect_true(samples[0].rip == 0x10U);
+        this->expect_true(samples[1].rip == 0x20U);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_profile_unknown()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_PROFILE;                     // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x0000BEEF;                         // r02
+
+    auto &&vmcall_ehlr = exit_handler_vmcall_ut{};
+    auto &&regs = vmcall_registers_t{};
+    regs.r02 = 0x0000BEEF;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+
+        this->expect_exception([&]{ vmcall_ehlr.handle_vmcall_profile(regs); }, ""_uvpce);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_heap_start()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    auto &&mm = setup_mm(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_HEAP;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_HEAP_START;                  // r02
+
+    auto called = false;
+    mocks.OnCall(mm, memory_manager_x64::heap_profiler_start).Do([&] { called = true; });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(called);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_heap_stop()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    auto &&mm = setup_mm(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_HEAP;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_HEAP_STOP;                   // r02
+
+    auto called = false;
+    mocks.OnCall(mm, memory_manager_x64::heap_profiler_stop).Do([&] { called = true; });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(called);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_heap_collect_output_nullptr()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_HEAP;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_HEAP_COLLECT;                // r02
+    ehlr.m_state_save->r11 = 0;                                  // r08
+    ehlr.m_state_save->r12 = sizeof(vmcall_heap_site_t);         // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_heap_collect_success()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    auto &&mm = setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_HEAP;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_HEAP_COLLECT;                // r02
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = sizeof(vmcall_heap_site_t) * 2;     // r09
+
+    mocks.OnCall(mm, memory_manager_x64::heap_profiler_collect).Do([](gsl::span<vmcall_heap_site_t> sites)
+    {
+        sites[0] = {0x10U, 2, 0x80U, 1};
+        return 1UL;
+    });
+
+    mocks.OnCall(mm, memory_manager_x64::heap_profiler_allocs).Return(2);
+    mocks.OnCall(mm, memory_manager_x64::heap_profiler_dropped).Return(3);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_state_save->rbx == 1);
+        this->expect_true(ehlr.m_state_save->rsi == 2);
+        this->expect_true(ehlr.m_state_save->r08 == 3);
+        this->expect_true(ehlr.m_state_save->r12 == sizeof(vmcall_heap_site_t));
+
+        auto &&sites = reinterpret_cast<vmcall_heap_site_t *>(g_map.get());
+        this->expect_true(sites[0].caller == 0x10U);
+        this->expect_true(sites[0].bytes == 0x80U);
+    });
+}
+
+auto g_heap_pools = std::make_unique<vmcall_heap_pool_t[]>(2);
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_heap_pools_success()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_pt(mocks);
+
+    auto mm = mocks.Mock<memory_manager_x64>();
+    mocks.OnCallFunc(memory_manager_x64::instance).Return(mm);
+
+    mocks.OnCall(mm, memory_manager_x64::alloc_map).Return(g_heap_pools.get());
+    mocks.OnCall(mm, memory_manager_x64::free_map);
+
+    memory_manager_x64::arena_stats_type heap = {};
+    heap.type = MEMORY_CHUNK_HEAP;
+    heap.size = 0x1000U;
+    heap.used = 0x400U;
+    heap.map[0] = 100;
+
+    memory_manager_x64::arena_stats_type map = {};
+    map.type = MEMORY_CHUNK_MAP;
+
+    mocks.OnCall(mm, memory_manager_x64::arena_stats).Return(memory_manager_x64::arena_stats_list{heap, map});
+
+    ehlr.m_state_save->rax = VMCALL_HEAP;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_HEAP_POOLS;                  // r02
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = sizeof(vmcall_heap_pool_t);         // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_state_save->rbx == 1);
+        this->expect_true(ehlr.m_state_save->rsi == 2);
+        this->expect_true(ehlr.m_state_save->r12 == sizeof(vmcall_heap_pool_t));
+
+        this->expect_true(g_heap_pools[0].type == MEMORY_CHUNK_HEAP);
+        this->expect_true(g_heap_pools[0].size == 0x1000U);
+        this->expect_true(g_heap_pools[0].used == 0x400U);
+        this->expect_true(g_heap_pools[0].map[0] == 100);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_heap_unknown()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_HEAP;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x0000BEEF;                         // r02
+
+    auto &&vmcall_ehlr = exit_handler_vmcall_ut{};
+    auto &&regs = vmcall_registers_t{};
+    regs.r02 = 0x0000BEEF;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+
+        this->expect_exception([&]{ vmcall_ehlr.handle_vmcall_heap(regs); }, ""_uvhce);
+    });
+}
+
+constexpr const auto g_num_lock_stats = 32ULL;
+auto g_lock_stats = std::make_unique<vmcall_lock_stats_t[]>(g_num_lock_stats);
+
+static const vmcall_lock_stats_t *
+find_lock_stats(const char *name, uint64_t num)
+{
+    for (auto i = 0ULL; i < num; i++)
+    {
+        if (std::string(g_lock_stats[i].name) == name)
+            return &g_lock_stats[i];
+    }
+
+    return nullptr;
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_locks_collect_success()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_pt(mocks);
+
+    auto mm = mocks.Mock<memory_manager_x64>();
+    mocks.OnCallFunc(memory_manager_x64::instance).Return(mm);
+
+    mocks.OnCall(mm, memory_manager_x64::alloc_map).Return(g_lock_stats.get());
+    mocks.OnCall(mm, memory_manager_x64::free_map);
+
+    x64::ticket_lock lock("test_locks_collect");
+    lock.lock();
+    lock.unlock();
+
+    ehlr.m_state_save->rax = VMCALL_LOCKS;                       // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_LOCKS_COLLECT;               // r02
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = sizeof(vmcall_lock_stats_t) * g_num_lock_stats;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_state_save->rbx == ehlr.m_state_save->rsi);
+        this->expect_true(ehlr.m_state_save->r12 == sizeof(vmcall_lock_stats_t) * ehlr.m_state_save->rbx);
+
+        auto &&stats = find_lock_stats("test_locks_collect", ehlr.m_state_save->rbx);
+        this->expect_true(stats != nullptr);
+
+        if (stats != nullptr)
+        {
+            this->expect_true(stats->type == VMCALL_LOCK_TICKET);
+            this->expect_true(stats->acquisitions == 1);
+            this->expect_true(stats->contended == 0);
+        }
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_locks_reset()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+
+    x64::spinlock lock("test_locks_reset");
+    lock.lock();
+    lock.unlock();
+
+    ehlr.m_state_save->rax = VMCALL_LOCKS;                       // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_LOCKS_RESET;                 // r02
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(lock.stats().acquisitions() == 0);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_locks_unknown()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_LOCKS;                       // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x0000BEEF;                         // r02
+
+    auto &&vmcall_ehlr = exit_handler_vmcall_ut{};
+    auto &&regs = vmcall_registers_t{};
+    regs.r02 = 0x0000BEEF;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+
+        this->expect_exception([&]{ vmcall_ehlr.handle_vmcall_locks(regs); }, ""_uvlce);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_preemption_timer()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmx_preemption_timer_expired);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_profiler_ctls();
+
+    ehlr.m_state_save->rip = 0x1234U;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.m_profiler.start(0x1000U); });
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == 0x1234U);
+        this->expect_true(ehlr.m_profiler.num_samples() == 1);
+        this->expect_true(g_field == vmcs::vmx_preemption_timer_value::addr);
+        this->expect_true(g_value == 0x1000U);
+    });
+}
+
+static auto
+setup_dirty_log(MockRepository &mocks)
+{
+    auto log = mocks.Mock<dirty_log_intel_x64>();
+    mocks.OnCallFunc(dirty_log).Return(log);
+
+    mocks.OnCall(log, dirty_log_intel_x64::add_tracking_vcpu).Do([log] { return log->generation(); });
+    mocks.OnCall(log, dirty_log_intel_x64::remove_tracking_vcpu);
+    mocks.OnCall(log, dirty_log_intel_x64::vcpu_synced);
+
+    return log;
+}
+
+static void
+setup_pml_ctls()
+{
+    g_msrs[intel_x64::msrs::ia32_vmx_true_procbased_ctls::addr] = 0xFFFFFFFF00000000UL;
+    g_msrs[intel_x64::msrs::ia32_vmx_procbased_ctls2::addr] = 0xFFFFFFFF00000000UL;
+    g_msrs[intel_x64::msrs::ia32_vmx_ept_vpid_cap::addr] = intel_x64::msrs::ia32_vmx_ept_vpid_cap::accessed_dirty_support::mask;
+
+    g_secondary_controls = vmcs::secondary_processor_based_vm_execution_controls::enable_ept::mask;
+    g_pml_index = 0;
+    g_invept = 0;
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_pml_full()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::page_modification_log_full);
+    auto &&ehlr = setup_ehlr(vmcs);
+    auto &&mm = setup_mm(mocks);
+    auto &&log = setup_dirty_log(mocks);
+    setup_pml_ctls();
+
+    auto &&logged = std::vector<uintptr_t>();
+
+    mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Return(0x1000U);
+    mocks.OnCall(log, dirty_log_intel_x64::generation).Return(1U);
+    mocks.OnCall(log, dirty_log_intel_x64::log).Do([&](gsl::span<const uintptr_t> gpas)
+    { logged.insert(logged.end(), gpas.begin(), gpas.end()); });
+
+    ehlr.m_state_save->rip = 0x1234U;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.m_pml.enable(); });
+        this->expect_true(ehlr.m_pml.is_enabled());
+        this->expect_true(vmcs::secondary_processor_based_vm_execution_controls::enable_pml::is_enabled());
+        this->expect_true(g_pml_index == 511);
+        this->expect_true(g_invept == 1);
+
+        // The CPU fills the buffer from the last entry down, and the index
+        // wraps once the buffer is full
+
+        for (auto i = 0UL; i < 512; i++)
+            ehlr.m_pml.m_buffer[i] = (511 - i) << 12;
+
+        g_pml_index = 0xFFFF;
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == 0x1234U);
+        this->expect_true(ehlr.m_pml.num_logged() == 512);
+        this->expect_true(logged.size() == 512);
+        this->expect_true(logged.front() == 511U << 12);
+        this->expect_true(logged.back() == 0U);
+        this->expect_true(g_pml_index == 511);
+        this->expect_true(g_invept == 1);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_pml_sync()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::cpuid);
+    auto &&ehlr = setup_ehlr(vmcs);
+    auto &&mm = setup_mm(mocks);
+    auto &&log = setup_dirty_log(mocks);
+    setup_pml_ctls();
+
+    auto &&generation = 1UL;
+    auto &&running = true;
+    auto &&logged = std::vector<uintptr_t>();
+    auto &&synced = std::vector<uint64_t>();
+
+    mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Return(0x1000U);
+    mocks.OnCall(log, dirty_log_intel_x64::generation).Do([&] { return generation; });
+    mocks.OnCall(log, dirty_log_intel_x64::is_running).Do([&] { return running; });
+    mocks.OnCall(log, dirty_log_intel_x64::vcpu_synced).Do([&](uint64_t gen) { synced.push_back(gen); });
+    mocks.OnCall(log, dirty_log_intel_x64::log).Do([&](gsl::span<const uintptr_t> gpas)
+    { logged.insert(logged.end(), gpas.begin(), gpas.end()); });
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.m_pml.enable(); });
+        this->expect_true(synced.size() == 1 && synced.back() == 1);
+
+        ehlr.m_pml.m_buffer[510] = 0x2000U;
+        ehlr.m_pml.m_buffer[511] = 0x1000U;
+
+        // Nothing is flushed until the dirty log's generation changes
+
+        g_pml_index = 509;
+
+        this->expect_no_exception([&]{ ehlr.m_pml.sync(); });
+        this->expect_true(logged.empty());
+        this->expect_true(g_invept == 1);
+
+        // Each VM exit syncs the vCPU with the dirty log
+
+        generation = 2;
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(logged.size() == 2);
+        this->expect_true(logged[0] == 0x2000U);
+        this->expect_true(logged[1] == 0x1000U);
+        this->expect_true(g_pml_index == 511);
+        this->expect_true(g_invept == 2);
+        this->expect_true(synced.size() == 2 && synced.back() == 2);
+
+        // Once the log is stopped, PML is disabled
+
+        generation = 3;
+        running = false;
+
+        this->expect_no_exception([&]{ ehlr.m_pml.sync(); });
+        this->expect_false(ehlr.m_pml.is_enabled());
+        this->expect_false(vmcs::secondary_processor_based_vm_execution_controls::enable_pml::is_enabled());
+        this->expect_true(g_invept == 3);
+        this->expect_true(synced.size() == 2);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_dirty_log_start_success()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    auto &&mm = setup_mm(mocks);
+    auto &&log = setup_dirty_log(mocks);
+    setup_pml_ctls();
+
+    auto &&running = false;
+
+    mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Return(0x1000U);
+    mocks.OnCall(log, dirty_log_intel_x64::generation).Return(1U);
+    mocks.OnCall(log, dirty_log_intel_x64::is_running).Do([&] { return running; });
+    mocks.OnCall(log, dirty_log_intel_x64::gpa).Return(0x200000U);
+    mocks.OnCall(log, dirty_log_intel_x64::pages).Return(0x10U);
+    mocks.OnCall(log, dirty_log_intel_x64::start).Do([&](uintptr_t gpa, std::size_t size)
+    { running = gpa == 0x200000U && size == 0x10000U; });
+
+    ehlr.m_state_save->rax = VMCALL_DIRTY_LOG;                   // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_DIRTY_LOG_START;             // r02
+    ehlr.m_state_save->rbx = 0x200000U;                          // r03
+    ehlr.m_state_save->rsi = 0x10000U;                           // r04
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_pml.is_enabled());
+        this->expect_true(running);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_dirty_log_start_range_mismatch()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    auto &&log = setup_dirty_log(mocks);
+    setup_pml_ctls();
+
+    mocks.OnCall(log, dirty_log_intel_x64::is_running).Return(true);
+    mocks.OnCall(log, dirty_log_intel_x64::gpa).Return(0x200000U);
+    mocks.OnCall(log, dirty_log_intel_x64::pages).Return(0x20U);
+    mocks.NeverCall(log, dirty_log_intel_x64::start);
+    mocks.NeverCall(log, dirty_log_intel_x64::stop);
+
+    ehlr.m_state_save->rax = VMCALL_DIRTY_LOG;                   // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_DIRTY_LOG_START;             // r02
+    ehlr.m_state_save->rbx = 0x200000U;                          // r03
+    ehlr.m_state_save->rsi = 0x10000U;                           // r04
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+        this->expect_false(ehlr.m_pml.is_enabled());
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_dirty_log_start_pml_unsupported()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    auto &&log = setup_dirty_log(mocks);
+    setup_pml_ctls();
+
+    g_msrs[intel_x64::msrs::ia32_vmx_ept_vpid_cap::addr] = 0;
+
+    auto &&running = false;
+
+    mocks.OnCall(log, dirty_log_intel_x64::is_running).Do([&] { return running; });
+    mocks.OnCall(log, dirty_log_intel_x64::gpa).Return(0x200000U);
+    mocks.OnCall(log, dirty_log_intel_x64::pages).Return(0x10U);
+    mocks.OnCall(log, dirty_log_intel_x64::start).Do([&](uintptr_t, std::size_t) { running = true; });
+    mocks.OnCall(log, dirty_log_intel_x64::stop).Do([&] { running = false; });
+
+    ehlr.m_state_save->rax = VMCALL_DIRTY_LOG;                   // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_DIRTY_LOG_START;             // r02
+    ehlr.m_state_save->rbx = 0x200000U;                          // r03
+    ehlr.m_state_save->rsi = 0x10000U;                           // r04
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+        this->expect_false(ehlr.m_pml.is_enabled());
+        this->expect_false(running);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_dirty_log_stop()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    auto &&mm = setup_mm(mocks);
+    auto &&log = setup_dirty_log(mocks);
+    setup_pml_ctls();
+
+    auto &&logged = 0UL;
+    auto &&stopped = false;
+
+    mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Return(0x1000U);
+    mocks.OnCall(log, dirty_log_intel_x64::generation).Return(1U);
+    mocks.OnCall(log, dirty_log_intel_x64::log).Do([&](gsl::span<const uintptr_t> gpas)
+    { logged += static_cast<std::size_t>(gpas.size()); });
+    mocks.OnCall(log, dirty_log_intel_x64::stop).Do([&] { stopped = true; });
+
+    ehlr.m_state_save->rax = VMCALL_DIRTY_LOG;                   // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_DIRTY_LOG_STOP;              // r02
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.m_pml.enable(); });
+
+        g_pml_index = 507;
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_false(ehlr.m_pml.is_enabled());
+        this->expect_true(logged == 4);
+        this->expect_true(stopped);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_dirty_log_harvest_output_nullptr()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    auto &&log = setup_dirty_log(mocks);
+
+    mocks.NeverCall(log, dirty_log_intel_x64::harvest);
+
+    ehlr.m_state_save->rax = VMCALL_DIRTY_LOG;                   // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_DIRTY_LOG_HARVEST;           // r02
+    ehlr.m_state_save->r11 = 0;                                  // r08
+    ehlr.m_state_save->r12 = sizeof(uint64_t);                   // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_dirty_log_harvest_output_size_too_small()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    auto &&log = setup_dirty_log(mocks);
+
+    mocks.NeverCall(log, dirty_log_intel_x64::harvest);
+
+    ehlr.m_state_save->rax = VMCALL_DIRTY_LOG;                   // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_DIRTY_LOG_HARVEST;           // r02
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = sizeof(uint64_t) - 1;               // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_dirty_log_harvest_not_tracking()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    auto &&log = setup_dirty_log(mocks);
+
+    mocks.NeverCall(log, dirty_log_intel_x64::harvest);
+
+    ehlr.m_state_save->rax = VMCALL_DIRTY_LOG;                   // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_DIRTY_LOG_HARVEST;           // r02
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = sizeof(uint64_t);                   // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_dirty_log_harvest_success()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    auto &&mm = setup_mm(mocks);
+    auto &&log = setup_dirty_log(mocks);
+    setup_pt(mocks);
+    setup_pml_ctls();
+
+    auto &&generation = 1UL;
+
+    mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Return(0x1000U);
+    mocks.OnCall(log, dirty_log_intel_x64::generation).Do([&] { return generation; });
+    mocks.OnCall(log, dirty_log_intel_x64::is_running).Return(true);
+    mocks.OnCall(log, dirty_log_intel_x64::log);
+    mocks.OnCall(log, dirty_log_intel_x64::gpa).Return(0x200000U);
+    mocks.OnCall(log, dirty_log_intel_x64::pages).Return(100U);
+    mocks.OnCall(log, dirty_log_intel_x64::harvest).Do([&](std::size_t first, gsl::span<uint64_t> bitmap) -> std::size_t
+    {
+        if (first != 64 || bitmap.size() != 4)
+            return 0;
+
+        bitmap[0] = 0x11;
+        generation++;
+
+        return 2;
+    });
+
+    // Only the words that cover the range are written, even though the
+    // buffer holds more
+
+    ehlr.m_state_save->rax = VMCALL_DIRTY_LOG;                   // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_DIRTY_LOG_HARVEST;           // r02
+    ehlr.m_state_save->rbx = 64U;                                // r03
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = sizeof(uint64_t) * 4;               // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.m_pml.enable(); });
+        this->expect_true(g_invept == 1);
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_state_save->rbx == 2);
+        this->expect_true(ehlr.m_state_save->rsi == 0x200000U);
+        this->expect_true(ehlr.m_state_save->r08 == 100);
+        this->expect_true(ehlr.m_state_save->r12 == sizeof(uint64_t));
+        this->expect_true(reinterpret_cast<uint64_t *>(g_map.get())[0] == 0x11);
+
+        // The harvest cleared dirty flags, so this vCPU's cached
+        // translations were invalidated before returning to the guest
+
+        this->expect_true(g_invept == 2);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_dirty_log_unknown()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_DIRTY_LOG;                   // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x0000BEEF;                         // r02
+
+    auto &&vmcall_ehlr = exit_handler_vmcall_ut{};
+    auto &&regs = vmcall_registers_t{};
+    regs.r02 = 0x0000BEEF;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+
+        this->expect_exception([&]{ vmcall_ehlr.handle_vmcall_dirty_log(regs); }, ""_uvdce);
+    });
+}
+
+auto g_ring = std::make_unique<vmcall_ring_t>();
+
+static auto
+setup_ring(MockRepository &mocks)
+{
+    auto mm = mocks.Mock<memory_manager_x64>();
+    mocks.OnCallFunc(memory_manager_x64::instance).Return(mm);
+
+    mocks.OnCall(mm, memory_manager_x64::alloc_map).Return(g_ring.get());
+    mocks.OnCall(mm, memory_manager_x64::free_map);
+
+    __builtin_memset(g_ring.get(), 0, sizeof(vmcall_ring_t));
+    return mm;
+}
+
+static void
+submit_ring(vmcall_ring_t *ring, uint64_t id, uintptr_t opcode, uintptr_t r02)
+{
+    auto &&sqe = ring->sq[ring->sq_tail % VMCALL_RING_NUM_ENTRIES];
+
+    sqe.id = id;
+    sqe.regs = vmcall_registers_t{};
+    sqe.regs.r00 = opcode;
+    sqe.regs.r02 = r02;
+
+    ring->sq_tail++;
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_ring_register_invalid_size()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_ring(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_RING;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_RING_REGISTER;               // r02
+    ehlr.m_state_save->rbx = 0x1234U;                            // r03
+    ehlr.m_state_save->rsi = sizeof(vmcall_ring_t) - 1;          // r04
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+        this->expect_false(ehlr.m_ring);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_ring_register_invalid_flags()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_ring(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_RING;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_RING_REGISTER;               // r02
+    ehlr.m_state_save->rbx = 0x1234U;                            // r03
+    ehlr.m_state_save->rsi = sizeof(vmcall_ring_t);              // r04
+    ehlr.m_state_save->r08 = 0x0000BEEF;                         // r05
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+        this->expect_false(ehlr.m_ring);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_ring_register_success()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_ring(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_RING;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_RING_REGISTER;               // r02
+    ehlr.m_state_save->rbx = 0x1234U;                            // r03
+    ehlr.m_state_save->rsi = sizeof(vmcall_ring_t);              // r04
+    ehlr.m_state_save->r08 = VMCALL_RING_FLAG_POLL;              // r05
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_ring.get() == g_ring.get());
+        this->expect_true(ehlr.m_ring_flags == VMCALL_RING_FLAG_POLL);
+
+        ehlr.m_ring.release();
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_ring_doorbell_not_registered()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_RING;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_RING_DOORBELL;               // r02
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_ring_doorbell_wrong_cr3()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_ring(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_RING;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_RING_DOORBELL;               // r02
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        ehlr.m_ring = bfn::unique_map_ptr_x64<vmcall_ring_t>(reinterpret_cast<uintptr_t>(g_ring.get()), sizeof(vmcall_ring_t));
+        ehlr.m_ring_cr3 = g_value + 0x1000U;
+        submit_ring(g_ring.get(), 1, VMCALL_EVENT, 0);
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+        this->expect_true(g_ring->sq_head == 0);
+        this->expect_true(g_ring->cq_tail == 0);
+
+        ehlr.m_ring.release();
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_ring_doorbell_corrupt()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_ring(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_RING;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_RING_DOORBELL;               // r02
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        ehlr.m_ring = bfn::unique_map_ptr_x64<vmcall_ring_t>(reinterpret_cast<uintptr_t>(g_ring.get()), sizeof(vmcall_ring_t));
+        ehlr.m_ring_cr3 = g_value;
+        g_ring->sq_tail = VMCALL_RING_NUM_ENTRIES + 1;
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+        this->expect_true(g_ring->sq_head == 0);
+        this->expect_true(g_ring->cq_tail == 0);
+
+        ehlr.m_ring.release();
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_ring_doorbell_completion_full()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_ring(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_RING;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_RING_DOORBELL;               // r02
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        ehlr.m_ring = bfn::unique_map_ptr_x64<vmcall_ring_t>(reinterpret_cast<uintptr_t>(g_ring.get()), sizeof(vmcall_ring_t));
+        ehlr.m_ring_cr3 = g_value;
+        g_ring->cq_tail = VMCALL_RING_NUM_ENTRIES;
+        submit_ring(g_ring.get(), 1, VMCALL_EVENT, 0);
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_state_save->rbx == 0);
+        this->expect_true(g_ring->sq_head == 0);
+
+        ehlr.m_ring.release();
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_ring_doorbell_success()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_ring(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_RING;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_RING_DOORBELL;               // r02
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        ehlr.m_ring = bfn::unique_map_ptr_x64<vmcall_ring_t>(reinterpret_cast<uintptr_t>(g_ring.get()), sizeof(vmcall_ring_t));
+        ehlr.m_ring_cr3 = g_value;
+
+        submit_ring(g_ring.get(), 1, VMCALL_VERSIONS, VMCALL_VERSION_PROTOCOL);
+        submit_ring(g_ring.get(), 2, VMCALL_EVENT, 0);
+        submit_ring(g_ring.get(), 3, 0x0000BEEF, 0);
+        submit_ring(g_ring.get(), 4, VMCALL_RING, VMCALL_RING_DOORBELL);
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_state_save->rbx == 4);
+
+        this->expect_true(g_ring->sq_head == 4);
+        this->expect_true(g_ring->cq_tail == 4);
+
+        this->expect_true(g_ring->cq[0].id == 1);
+        this->expect_true(ec_sign(g_ring->cq[0].ret) == BF_VMCALL_SUCCESS);
+        this->expect_true(g_ring->cq[0].regs.r03 == VMCALL_VERSION);
+        this->expect_true(g_ring->cq[1].id == 2);
+        this->expect_true(ec_sign(g_ring->cq[1].ret) == BF_VMCALL_SUCCESS);
+        this->expect_true(g_ring->cq[2].id == 3);
+        this->expect_true(ec_sign(g_ring->cq[2].ret) == BF_VMCALL_FAILURE);
+        this->expect_true(g_ring->cq[3].id == 4);
+        this->expect_true(ec_sign(g_ring->cq[3].ret) == BF_VMCALL_FAILURE);
+
+        ehlr.m_ring.release();
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_ring_unregister()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_ring(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_RING;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = VMCALL_RING_UNREGISTER;             // r02
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        ehlr.m_ring = bfn::unique_map_ptr_x64<vmcall_ring_t>(reinterpret_cast<uintptr_t>(g_ring.get()), sizeof(vmcall_ring_t));
+        ehlr.m_ring_flags = VMCALL_RING_FLAG_POLL;
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_false(ehlr.m_ring);
+        this->expect_true(ehlr.m_ring_flags == 0);
+
+        ehlr.m_ring.release();
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_ring_poll()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::cpuid);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_ring(mocks);
+    setup_pt(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        ehlr.m_ring = bfn::unique_map_ptr_x64<vmcall_ring_t>(reinterpret_cast<uintptr_t>(g_ring.get()), sizeof(vmcall_ring_t));
+        ehlr.m_ring_cr3 = g_value;
+        ehlr.m_ring_flags = VMCALL_RING_FLAG_POLL;
+
+        submit_ring(g_ring.get(), 1, VMCALL_EVENT, 0);
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(g_ring->sq_head == 1);
+        this->expect_true(g_ring->cq_tail == 1);
+        this->expect_true(g_ring->cq[0].id == 1);
+
+        ehlr.m_ring.release();
+    });
+}
+
+static void
+add_data_registration(exit_handler_intel_x64 &ehlr, uintptr_t handle, uintptr_t uuid, uintptr_t cr3)
+{
+    auto &&reg = ehlr.m_data_registrations[handle];
+
+    reg.uuid1 = uuid;
+    reg.uuid2 = uuid;
+    reg.cr3 = cr3;
+    reg.imap = bfn::unique_map_ptr_x64<char>(reinterpret_cast<uintptr_t>(g_map.get()), g_msg.size());
+    reg.omap = bfn::unique_map_ptr_x64<char>(reinterpret_cast<uintptr_t>(g_map.get()), g_msg.size());
+}
+
+static void
+release_data_registrations(exit_handler_intel_x64 &ehlr)
+{
+    for (auto &&iter : ehlr.m_data_registrations)
+    {
+        iter.second.imap.release();
+        iter.second.omap.release();
+    }
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_register_success()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_DATA_REGISTER;               // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x1U;                               // r02
+    ehlr.m_state_save->rbx = 0x2U;                               // r03
+    ehlr.m_state_save->r08 = 0x1234U;                            // r05
+    ehlr.m_state_save->r09 = g_msg.size();                       // r06
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = g_msg.size();                       // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_data_registrations.size() == 1);
+
+        auto &&iter = ehlr.m_data_registrations.find(ehlr.m_state_save->rsi);
+        this->expect_true(iter != ehlr.m_data_registrations.end());
+        this->expect_true(iter->second.uuid1 == 0x1U);
+        this->expect_true(iter->second.uuid2 == 0x2U);
+        this->expect_true(iter->second.cr3 == g_value);
+        this->expect_true(iter->second.imap.get() == g_map.get());
+        this->expect_true(iter->second.omap.get() == g_map.get());
+
+        release_data_registrations(ehlr);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_register_input_nullptr()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_DATA_REGISTER;               // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->r08 = 0;                                  // r05
+    ehlr.m_state_save->r09 = g_msg.size();                       // r06
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = g_msg.size();                       // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+        this->expect_true(ehlr.m_data_registrations.empty());
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_register_duplicate_uuid()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_DATA_REGISTER;               // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x1U;                               // r02
+    ehlr.m_state_save->rbx = 0x1U;                               // r03
+    ehlr.m_state_save->r08 = 0x1234U;                            // r05
+    ehlr.m_state_save->r09 = g_msg.size();                       // r06
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = g_msg.size();                       // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        add_data_registration(ehlr, 1, 0x1U, g_value);
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+        this->expect_true(ehlr.m_data_registrations.size() == 1);
+
+        release_data_registrations(ehlr);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_register_too_many()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_DATA_REGISTER;               // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x1000U;                            // r02
+    ehlr.m_state_save->rbx = 0x1000U;                            // r03
+    ehlr.m_state_save->r08 = 0x1234U;                            // r05
+    ehlr.m_state_save->r09 = g_msg.size();                       // r06
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = g_msg.size();                       // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        for (auto i = 1U; i <= MAX_VMCALL_DATA_REGISTRATIONS; i++)
+            add_data_registration(ehlr, i, i, g_value);
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+        this->expect_true(ehlr.m_data_registrations.size() == MAX_VMCALL_DATA_REGISTRATIONS);
+
+        release_data_registrations(ehlr);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_unregistered_ignores_r10()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_DATA;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rsi = VMCALL_DATA_STRING_UNFORMATTED;     // r04
+    ehlr.m_state_save->r08 = 0x1234U;                            // r05
+    ehlr.m_state_save->r09 = g_msg.size();                       // r06
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = g_msg.size();                       // r09
+    ehlr.m_state_save->r13 = 0xDEADBEEF;                         // r10
+
+    __builtin_memcpy(g_map.get(), g_msg.data(), g_msg.size());
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_registered_not_registered()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_DATA;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x1U;                               // r02
+    ehlr.m_state_save->rbx = 0x1U;                               // r03
+    ehlr.m_state_save->rsi = VMCALL_DATA_STRING_UNFORMATTED;     // r04
+    ehlr.m_state_save->r08 = 0;                                  // r05
+    ehlr.m_state_save->r09 = g_msg.size();                       // r06
+    ehlr.m_state_save->r11 = 0;                                  // r08
+    ehlr.m_state_save->r12 = g_msg.size();                       // r09
+    ehlr.m_state_save->r13 = 1;                                  // r10
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_registered_uuid_mismatch()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_DATA;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x2U;                               // r02
+    ehlr.m_state_save->rbx = 0x2U;                               // r03
+    ehlr.m_state_save->rsi = VMCALL_DATA_STRING_UNFORMATTED;     // r04
+    ehlr.m_state_save->r08 = 0;                                  // r05
+    ehlr.m_state_save->r09 = g_msg.size();                       // r06
+    ehlr.m_state_save->r11 = 0;                                  // r08
+    ehlr.m_state_save->r12 = g_msg.size();                       // r09
+    ehlr.m_state_save->r13 = 1;                                  // r10
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        add_data_registration(ehlr, 1, 0x1U, g_value);
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+
+        release_data_registrations(ehlr);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_registered_cr3_mismatch()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_DATA;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x1U;                               // r02
+    ehlr.m_state_save->rbx = 0x1U;                               // r03
+    ehlr.m_state_save->rsi = VMCALL_DATA_STRING_UNFORMATTED;     // r04
+    ehlr.m_state_save->r08 = 0;                                  // r05
+    ehlr.m_state_save->r09 = g_msg.size();                       // r06
+    ehlr.m_state_save->r11 = 0;                                  // r08
+    ehlr.m_state_save->r12 = g_msg.size();                       // r09
+    ehlr.m_state_save->r13 = 1;                                  // r10
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        add_data_registration(ehlr, 1, 0x1U, g_value + 0x1000U);
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+
+        release_data_registrations(ehlr);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_registered_size_too_big()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_DATA;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x1U;                               // r02
+    ehlr.m_state_save->rbx = 0x1U;                               // r03
+    ehlr.m_state_save->rsi = VMCALL_DATA_STRING_UNFORMATTED;     // r04
+    ehlr.m_state_save->r09 = g_msg.size() + 1;                   // r06
+    ehlr.m_state_save->r12 = g_msg.size() + 1;                   // r09
+    ehlr.m_state_save->r13 = 1;                                  // r10
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        add_data_registration(ehlr, 1, 0x1U, g_value);
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+
+        release_data_registrations(ehlr);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_registered_success()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_DATA;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x1U;                               // r02
+    ehlr.m_state_save->rbx = 0x1U;                               // r03
+    ehlr.m_state_save->rsi = VMCALL_DATA_STRING_UNFORMATTED;     // r04
+    ehlr.m_state_save->r08 = 0;                                  // r05
+    ehlr.m_state_save->r09 = g_msg.size();                       // r06
+    ehlr.m_state_save->r11 = 0;                                  // r08
+    ehlr.m_state_save->r12 = g_msg.size();                       // r09
+    ehlr.m_state_save->r13 = 1;                                  // r10
+
+    __builtin_memcpy(g_map.get(), g_msg.data(), g_msg.size());
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        add_data_registration(ehlr, 1, 0x1U, g_value);
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_state_save->r10 == VMCALL_DATA_STRING_UNFORMATTED);
+        this->expect_true(ehlr.m_state_save->r12 == g_msg.size());
+        this->expect_true(ehlr.m_data_registrations.size() == 1);
+
+        release_data_registrations(ehlr);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_unregister_not_registered()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+
+    ehlr.m_state_save->rax = VMCALL_DATA_UNREGISTER;             // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x1U;                               // r02
+    ehlr.m_state_save->rbx = 0x1U;                               // r03
+    ehlr.m_state_save->rsi = 1;                                  // r04
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_unregister_success()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    ehlr.m_state_save->rax = VMCALL_DATA_UNREGISTER;             // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x1U;                               // r02
+    ehlr.m_state_save->rbx = 0x1U;                               // r03
+    ehlr.m_state_save->rsi = 1;                                  // r04
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        add_data_registration(ehlr, 1, 0x1U, g_value);
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_data_registrations.empty());
+    });
+}
+
+class span_exit_handler_intel_x64 : public exit_handler_intel_x64
+{
+public:
+
+    const char *m_ibuf{nullptr};
+    const char *m_obuf{nullptr};
+    std::ptrdiff_t m_isize{0};
+    std::ptrdiff_t m_osize{0};
+    uintptr_t m_reply_size{0};
+
+protected:
+
+    void handle_vmcall_data_span(
+        vmcall_registers_t &regs, gsl::span<const char> ibuf, gsl::span<char> obuf) override
+    {
+        m_ibuf = ibuf.data();
+        m_obuf = obuf.data();
+        m_isize = ibuf.size();
+        m_osize = obuf.size();
+
+        obuf[0] = 'x';
+
+        regs.r07 = VMCALL_DATA_BINARY_UNFORMATTED;
+        regs.r09 = m_reply_size;
+    }
+};
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_span_success()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+
+    span_exit_handler_intel_x64 ehlr{};
+    ehlr.set_vmcs(vmcs);
+    ehlr.set_state_save(&g_state_save);
+    ehlr.m_reply_size = 1;
+
+    ehlr.m_state_save->rax = VMCALL_DATA;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x1U;                               // r02
+    ehlr.m_state_save->rbx = 0x1U;                               // r03
+    ehlr.m_state_save->rsi = 0x8000000000000000UL;               // r04
+    ehlr.m_state_save->r09 = 2;                                  // r06
+    ehlr.m_state_save->r12 = 3;                                  // r09
+    ehlr.m_state_save->r13 = 1;                                  // r10
+
+    g_rip = ehlr.m_state_save->rip + g_exit_instruction_length;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        add_data_registration(ehlr, 1, 0x1U, g_value);
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_SUCCESS);
+        this->expect_true(ehlr.m_ibuf == g_map.get());
+        this->expect_true(ehlr.m_obuf == g_map.get());
+        this->expect_true(ehlr.m_isize == 2);
+        this->expect_true(ehlr.m_osize == 3);
+        this->expect_true(g_map[0] == 'x');
+        this->expect_true(ehlr.m_state_save->r10 == VMCALL_DATA_BINARY_UNFORMATTED);
+        this->expect_true(ehlr.m_state_save->r12 == 1);
+
+        release_data_registrations(ehlr);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_vmcall_data_span_reply_too_large()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+
+    span_exit_handler_intel_x64 ehlr{};
+    ehlr.set_vmcs(vmcs);
+    ehlr.set_state_save(&g_state_save);
+    ehlr.m_reply_size = 4;
+
+    ehlr.m_state_save->rax = VMCALL_DATA;                        // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x1U;                               // r02
+    ehlr.m_state_save->rbx = 0x1U;                               // r03
+    ehlr.m_state_save->rsi = 0x8000000000000000UL;               // r04
+    ehlr.m_state_save->r09 = 2;                                  // r06
+    ehlr.m_state_save->r12 = 3;                                  // r09
+    ehlr.m_state_save->r13 = 1;                                  // r10
+
+    g_rip = ehlr.m_state_save->rip + g_exit_instruction_length;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        add_data_registration(ehlr, 1, 0x1U, g_value);
+
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(ec_sign(ehlr.m_state_save->rdx) == BF_VMCALL_FAILURE);
+
+        release_data_registrations(ehlr);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_invalidate_address_space()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        exit_handler_intel_x64 ehlr{};
+
+        ehlr.m_ring = bfn::unique_map_ptr_x64<vmcall_ring_t>(reinterpret_cast<uintptr_t>(g_ring.get()), sizeof(vmcall_ring_t));
+        ehlr.m_ring_cr3 = 0x1000U;
+        ehlr.m_ring_flags = VMCALL_RING_FLAG_POLL;
+
+        add_data_registration(ehlr, 1, 0x1U, 0x1000U);
+        add_data_registration(ehlr, 2, 0x2U, 0x2000U);
+        add_data_registration(ehlr, 3, 0x3U, 0x1000U);
+
+        ehlr.invalidate_address_space(0x1000U);
+
+        this->expect_false(ehlr.m_ring);
+        this->expect_true(ehlr.m_ring_flags == 0);
+        this->expect_true(ehlr.m_data_registrations.size() == 1);
+        this->expect_true(ehlr.m_data_registrations.count(2) == 1);
+
+        release_data_registrations(ehlr);
+    });
+}
+
+static void
+setup_mov_to_cr3(exit_handler_intel_x64 &ehlr, uintptr_t cr3)
+{
+    namespace access = vmcs::exit_qualification::control_register_access;
+
+    g_exit_qualification = 3U;
+    g_exit_qualification |= access::access_type::mov_to_cr << access::access_type::from;
+    g_exit_qualification |= access::general_purpose_register::r13 << access::general_purpose_register::from;
+
+    ehlr.m_state_save->r13 = cr3;
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_mov_to_cr3()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    setup_mov_to_cr3(ehlr, 0x8000000000001000UL);
+
+    ehlr.m_ring = bfn::unique_map_ptr_x64<vmcall_ring_t>(reinterpret_cast<uintptr_t>(g_ring.get()), sizeof(vmcall_ring_t));
+    ehlr.m_ring_cr3 = 0x1000U;
+    ehlr.m_ring_virt = 0x4000U;
+    ehlr.m_ring_phys = 0x4000U;
+
+    add_data_registration(ehlr, 1, 0x1U, 0x1000U);
+    ehlr.m_data_registrations[1].ivirt = 0x5000U;
+    ehlr.m_data_registrations[1].iphys = 0x5000U;
+    ehlr.m_data_registrations[1].ovirt = 0x6000U;
+    ehlr.m_data_registrations[1].ophys = 0x6000U;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(g_guest_cr3 == 0x1000U);
+
+        this->expect_true(ehlr.m_ring);
+        this->expect_true(ehlr.m_data_registrations.size() == 1);
+
+        ehlr.m_ring.release();
+        release_data_registrations(ehlr);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_mov_to_cr3_torn_down()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    setup_mov_to_cr3(ehlr, 0x1000U);
+
+    ehlr.m_ring = bfn::unique_map_ptr_x64<vmcall_ring_t>(reinterpret_cast<uintptr_t>(g_ring.get()), sizeof(vmcall_ring_t));
+    ehlr.m_ring_cr3 = 0x1000U;
+    ehlr.m_ring_virt = 0x4000U;
+    ehlr.m_ring_phys = 0x4000U;
+
+    add_data_registration(ehlr, 1, 0x1U, 0x1000U);
+    ehlr.m_data_registrations[1].ivirt = 0x5000U;
+    ehlr.m_data_registrations[1].iphys = 0x9000U;
+    ehlr.m_data_registrations[1].ovirt = 0x6000U;
+    ehlr.m_data_registrations[1].ophys = 0x6000U;
+
+    add_data_registration(ehlr, 2, 0x2U, 0x2000U);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_true(g_guest_cr3 == 0x1000U);
+
+        this->expect_false(ehlr.m_ring);
+        this->expect_true(ehlr.m_data_registrations.size() == 1);
+        this->expect_true(ehlr.m_data_registrations.count(2) == 1);
+
+        release_data_registrations(ehlr);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_mov_to_cr3_ring_unmapped()
+{
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    setup_mov_to_cr3(ehlr, 0x1000U);
+
+    ehlr.m_ring = bfn::unique_map_ptr_x64<vmcall_ring_t>(reinterpret_cast<uintptr_t>(g_ring.get()), sizeof(vmcall_ring_t));
+    ehlr.m_ring_cr3 = 0x1000U;
+    ehlr.m_ring_virt = 0xDEADBEEF;
+    ehlr.m_ring_phys = 0x4000U;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_state_save->rip == g_rip);
+        this->expect_false(ehlr.m_ring);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_vm_exit_reason_mov_from_cr3()
+{
+    namespace access = vmcs::exit_qualification::control_register_access;
+
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_unhandled(mocks, exit_reason::basic_exit_reason::control_register_accesses);
+    auto &&ehlr = setup_ehlr(vmcs);
+
+    g_guest_cr3 = 0;
+    g_exit_qualification = 3U | (access::access_type::mov_from_cr << access::access_type::from);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(g_guest_cr3 == 0);
+    });
+}
+
+void
+exit_handler_intel_x64_ut::test_cr3_load_exiting_follows_registrations()
+{
+    using namespace vmcs::primary_processor_based_vm_execution_controls;
+
+    MockRepository mocks;
+    auto &&vmcs = setup_vmcs_handled(mocks, exit_reason::basic_exit_reason::vmcall);
+    auto &&ehlr = setup_ehlr(vmcs);
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    g_primary_controls = 0;
+    g_msrs[intel_x64::msrs::ia32_vmx_true_procbased_ctls::addr] = 0xFFFFFFFF00000000UL;
+
+    ehlr.m_state_save->rax = VMCALL_DATA_REGISTER;               // r00
+    ehlr.m_state_save->rdx = VMCALL_MAGIC_NUMBER;                // r01
+    ehlr.m_state_save->rcx = 0x1U;                               // r02
+    ehlr.m_state_save->rbx = 0x2U;                               // r03
+    ehlr.m_state_save->r08 = 0x1234U;                            // r05
+    ehlr.m_state_save->r09 = g_msg.size();                       // r06
+    ehlr.m_state_save->r11 = 0x1234U;                            // r08
+    ehlr.m_state_save->r12 = g_msg.size();                       // r09
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&]{ ehlr.dispatch(); });
+        this->expect_true(ehlr.m_data_registrations.size() == 1);
+        this->expect_true(cr3_load_exiting::is_enabled());
+
+        auto &&iter = ehlr.m_data_registrations.begin();
+        this->expect_true(iter->second.ivirt == 0x1234U);
+        this->expect_true(iter->second.iphys == 0x1234U);
+
+        release_data_registrations(ehlr);
+        ehlr.invalidate_address_space(iter->second.cr3);
+
+        this->expect_true(ehlr.m_data_registrations.empty());
+        this->expect_true(cr3_load_exiting::is_disabled());
+    });
+}
+
 void
 exit_handler_intel_x64_ut::test_vm_exit_reason_vmxoff()
 {
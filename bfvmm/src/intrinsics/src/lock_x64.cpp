@@ -0,0 +1,161 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <mutex>
+#include <intrinsics/lock_x64.h>
+
+// -----------------------------------------------------------------------------
+// Registry
+// -----------------------------------------------------------------------------
+
+// The registry is an intrusive list of the named locks. Named locks are
+// created by global constructors in several modules (including the memory
+// manager), so the registry cannot allocate, and its own lock is unnamed
+// so that it can be constant initialized.
+
+namespace x64
+{
+
+class lock_registry
+{
+public:
+
+    static void add(lock_stats *stats) noexcept
+    {
+        std::lock_guard<spinlock> guard(s_lock);
+
+        stats->m_prev = s_tail;
+        stats->m_next = nullptr;
+
+        if (s_tail != nullptr)
+            s_tail->m_next = stats;
+        else
+            s_head = stats;
+
+        s_tail = stats;
+    }
+
+    static void remove(lock_stats *stats) noexcept
+    {
+        std::lock_guard<spinlock> guard(s_lock);
+
+        if (stats->m_prev != nullptr)
+            stats->m_prev->m_next = stats->m_next;
+        else
+            s_head = stats->m_next;
+
+        if (stats->m_next != nullptr)
+            stats->m_next->m_prev = stats->m_prev;
+        else
+            s_tail = stats->m_prev;
+
+        stats->m_prev = nullptr;
+        stats->m_next = nullptr;
+    }
+
+    static std::size_t size() noexcept
+    {
+        std::size_t num = 0;
+        std::lock_guard<spinlock> guard(s_lock);
+
+        for (auto stats = s_head; stats != nullptr; stats = stats->m_next)
+            num++;
+
+        return num;
+    }
+
+    static void collect(std::vector<lock_report_type> &report) noexcept
+    {
+        std::lock_guard<spinlock> guard(s_lock);
+
+        for (auto stats = s_head; stats != nullptr; stats = stats->m_next)
+        {
+            if (report.size() == report.capacity())
+                break;
+
+            report.push_back({
+                stats->name(),
+                stats->type(),
+                stats->acquisitions(),
+                stats->contended(),
+                stats->spins(),
+                stats->max_hold()
+            });
+        }
+    }
+
+    static void reset() noexcept
+    {
+        std::lock_guard<spinlock> guard(s_lock);
+
+        for (auto stats = s_head; stats != nullptr; stats = stats->m_next)
+            stats->reset();
+    }
+
+private:
+
+    static spinlock s_lock;
+    static lock_stats *s_head;
+    static lock_stats *s_tail;
+};
+
+spinlock lock_registry::s_lock;
+lock_stats *lock_registry::s_head = nullptr;
+lock_stats *lock_registry::s_tail = nullptr;
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+lock_stats::lock_stats(name_type name, type_type type) noexcept :
+    m_name(name),
+    m_type(type)
+{
+    if (enabled())
+        lock_registry::add(this);
+}
+
+lock_stats::~lock_stats()
+{
+    if (enabled())
+        lock_registry::remove(this);
+}
+
+std::vector<lock_report_type>
+lock_report()
+{
+    std::vector<lock_report_type> report;
+
+    // The report is reserved before the registry is locked, so that the
+    // registry is never locked while the heap's locks are taken. If locks
+    // are added in between, the report is truncated.
+
+    report.reserve(lock_registry::size());
+    lock_registry::collect(report);
+
+    return report;
+}
+
+void
+lock_report_reset() noexcept
+{ lock_registry::reset(); }
+
+}
@@ -0,0 +1,606 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <atomic>
+#include <immintrin.h>
+
+#include <intrinsics/x64.h>
+#include <intrinsics/mem_x64.h>
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+// The routines below are used to implement memcpy / memset, so they cannot
+// call either. The only library calls are fixed size __builtin_memcpy's,
+// which the compiler turns into a single load / store. Buffers that are not
+// a multiple of the vector size are finished with one overlapping (unaligned)
+// vector at the end of the buffer, instead of a byte loop.
+
+using namespace x64::mem;
+
+using byte_pointer = uint8_t *;
+using const_byte_pointer = const uint8_t *;
+
+namespace
+{
+
+template<class T>
+inline T
+load(const_byte_pointer src) noexcept
+{
+    T val;
+    __builtin_memcpy(&val, src, sizeof(T));
+    return val;
+}
+
+template<class T>
+inline void
+store(byte_pointer dst, T val) noexcept
+{ __builtin_memcpy(dst, &val, sizeof(T)); }
+
+inline void
+copy_small(byte_pointer dst, const_byte_pointer src, size_type num) noexcept
+{
+    if (num >= 16)
+    {
+        auto head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        auto tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + num - 16));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), head);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + num - 16), tail);
+    }
+    else if (num >= 8)
+    {
+        auto head = load<uint64_t>(src);
+        auto tail = load<uint64_t>(src + num - 8);
+
+        store(dst, head);
+        store(dst + num - 8, tail);
+    }
+    else if (num >= 4)
+    {
+        auto head = load<uint32_t>(src);
+        auto tail = load<uint32_t>(src + num - 4);
+
+        store(dst, head);
+        store(dst + num - 4, tail);
+    }
+    else if (num > 0)
+    {
+        dst[0] = src[0];
+        dst[num >> 1] = src[num >> 1];
+        dst[num - 1] = src[num - 1];
+    }
+}
+
+inline void
+set_small(byte_pointer dst, uint8_t val, size_type num) noexcept
+{
+    if (num >= 16)
+    {
+        auto vec = _mm_set1_epi8(static_cast<char>(val));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), vec);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + num - 16), vec);
+    }
+    else if (num >= 8)
+    {
+        auto pattern = 0x0101010101010101ULL * val;
+
+        store(dst, pattern);
+        store(dst + num - 8, pattern);
+    }
+    else if (num >= 4)
+    {
+        auto pattern = 0x01010101U * val;
+
+        store(dst, pattern);
+        store(dst + num - 4, pattern);
+    }
+    else if (num > 0)
+    {
+        dst[0] = val;
+        dst[num >> 1] = val;
+        dst[num - 1] = val;
+    }
+}
+
+inline int
+compare_small(const_byte_pointer lhs, const_byte_pointer rhs, size_type num) noexcept
+{
+    for (auto i = 0ULL; i < num; i++)
+    {
+        if (lhs[i] != rhs[i])
+            return lhs[i] - rhs[i];
+    }
+
+    return 0;
+}
+
+inline int
+compare_mask(const_byte_pointer lhs, const_byte_pointer rhs, uint32_t mask) noexcept
+{
+    auto i = __builtin_ctz(mask);
+    return lhs[i] - rhs[i];
+}
+
+// -----------------------------------------------------------------------------
+// SSE2
+// -----------------------------------------------------------------------------
+
+void
+copy_sse2(byte_pointer dst, const_byte_pointer src, size_type num) noexcept
+{
+    if (num <= 32)
+        return copy_small(dst, src, num);
+
+    auto tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + num - 16));
+    auto i = 0ULL;
+
+    if (num >= non_temporal_threshold)
+    {
+        auto head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), head);
+
+        i = 16 - (reinterpret_cast<uintptr_t>(dst) & 15);
+
+        for (; i + 64 <= num; i += 64)
+        {
+            auto v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 0));
+            auto v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 16));
+            auto v2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 32));
+            auto v3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 48));
+
+            _mm_stream_si128(reinterpret_cast<__m128i *>(dst + i + 0), v0);
+            _mm_stream_si128(reinterpret_cast<__m128i *>(dst + i + 16), v1);
+            _mm_stream_si128(reinterpret_cast<__m128i *>(dst + i + 32), v2);
+            _mm_stream_si128(reinterpret_cast<__m128i *>(dst + i + 48), v3);
+        }
+
+        _mm_sfence();
+    }
+    else
+    {
+        for (; i + 64 <= num; i += 64)
+        {
+            auto v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 0));
+            auto v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 16));
+            auto v2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 32));
+            auto v3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 48));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 0), v0);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 16), v1);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 32), v2);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 48), v3);
+        }
+    }
+
+    for (; i + 16 <= num; i += 16)
+    {
+        auto v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v0);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + num - 16), tail);
+}
+
+void
+set_sse2(byte_pointer dst, uint8_t val, size_type num) noexcept
+{
+    if (num <= 32)
+        return set_small(dst, val, num);
+
+    auto vec = _mm_set1_epi8(static_cast<char>(val));
+    auto i = 0ULL;
+
+    if (num >= non_temporal_set_threshold)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), vec);
+
+        i = 16 - (reinterpret_cast<uintptr_t>(dst) & 15);
+
+        for (; i + 64 <= num; i += 64)
+        {
+            _mm_stream_si128(reinterpret_cast<__m128i *>(dst + i + 0), vec);
+            _mm_stream_si128(reinterpret_cast<__m128i *>(dst + i + 16), vec);
+            _mm_stream_si128(reinterpret_cast<__m128i *>(dst + i + 32), vec);
+            _mm_stream_si128(reinterpret_cast<__m128i *>(dst + i + 48), vec);
+        }
+
+        _mm_sfence();
+    }
+    else
+    {
+        for (; i + 64 <= num; i += 64)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 0), vec);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 16), vec);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 32), vec);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 48), vec);
+        }
+    }
+
+    for (; i + 16 <= num; i += 16)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), vec);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + num - 16), vec);
+}
+
+int
+compare_sse2(const_byte_pointer lhs, const_byte_pointer rhs, size_type num) noexcept
+{
+    if (num < 16)
+        return compare_small(lhs, rhs, num);
+
+    auto i = 0ULL;
+
+    for (; i + 16 <= num; i += 16)
+    {
+        auto v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i));
+        auto v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v0, v1))) ^ 0xFFFFU;
+
+        if (mask != 0)
+            return compare_mask(lhs + i, rhs + i, mask);
+    }
+
+    if (i == num)
+        return 0;
+
+    // The bytes that the last (overlapping) vector shares with the previous
+    // one are known to be equal, so the first difference is still the
+    // first difference in the buffer.
+
+    i = num - 16;
+
+    auto v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i));
+    auto v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i));
+    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v0, v1))) ^ 0xFFFFU;
+
+    return mask != 0 ? compare_mask(lhs + i, rhs + i, mask) : 0;
+}
+
+// -----------------------------------------------------------------------------
+// ERMS
+// -----------------------------------------------------------------------------
+
+// rep movsb / stosb have a startup cost that is larger than an SSE2 copy of
+// a few hundred bytes, so short buffers use SSE2. rep stosb does not bypass
+// the cache for a page sized fill, so fills of a page or more use the SSE2
+// non-temporal path instead. There is no fast string compare, so memcmp
+// uses SSE2.
+
+void
+copy_erms(byte_pointer dst, const_byte_pointer src, size_type num) noexcept
+{
+    if (num < erms_threshold)
+        return copy_sse2(dst, src, num);
+
+    asm volatile("rep movsb" : "+D"(dst), "+S"(src), "+c"(num) : : "memory");
+}
+
+void
+set_erms(byte_pointer dst, uint8_t val, size_type num) noexcept
+{
+    if (num < erms_threshold || num >= non_temporal_set_threshold)
+        return set_sse2(dst, val, num);
+
+    asm volatile("rep stosb" : "+D"(dst), "+c"(num) : "a"(val) : "memory");
+}
+
+// -----------------------------------------------------------------------------
+// AVX2
+// -----------------------------------------------------------------------------
+
+// The AVX2 variant is always compiled (the target attribute enables the
+// instructions for these functions only), and is only selected when cpuid
+// reports AVX2, and the OS has enabled the ymm state.
+
+__attribute__((target("avx2"))) void
+copy_avx2(byte_pointer dst, const_byte_pointer src, size_type num) noexcept
+{
+    if (num <= 32)
+        return copy_small(dst, src, num);
+
+    if (num <= 64)
+    {
+        auto head = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+        auto tail = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + num - 32));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), head);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + num - 32), tail);
+
+        return;
+    }
+
+    auto tail = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + num - 32));
+    auto i = 0ULL;
+
+    if (num >= non_temporal_threshold)
+    {
+        auto head = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), head);
+
+        i = 32 - (reinterpret_cast<uintptr_t>(dst) & 31);
+
+        for (; i + 128 <= num; i += 128)
+        {
+            auto v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 0));
+            auto v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 32));
+            auto v2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 64));
+            auto v3 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 96));
+
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(dst + i + 0), v0);
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(dst + i + 32), v1);
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(dst + i + 64), v2);
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(dst + i + 96), v3);
+        }
+
+        _mm_sfence();
+    }
+    else
+    {
+        for (; i + 128 <= num; i += 128)
+        {
+            auto v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 0));
+            auto v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 32));
+            auto v2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 64));
+            auto v3 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 96));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 0), v0);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 32), v1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 64), v2);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 96), v3);
+        }
+    }
+
+    for (; i + 32 <= num; i += 32)
+    {
+        auto v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), v0);
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + num - 32), tail);
+}
+
+__attribute__((target("avx2"))) void
+set_avx2(byte_pointer dst, uint8_t val, size_type num) noexcept
+{
+    if (num <= 32)
+        return set_small(dst, val, num);
+
+    auto vec = _mm256_set1_epi8(static_cast<char>(val));
+    auto i = 0ULL;
+
+    if (num >= non_temporal_set_threshold)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), vec);
+
+        i = 32 - (reinterpret_cast<uintptr_t>(dst) & 31);
+
+        for (; i + 128 <= num; i += 128)
+        {
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(dst + i + 0), vec);
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(dst + i + 32), vec);
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(dst + i + 64), vec);
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(dst + i + 96), vec);
+        }
+
+        _mm_sfence();
+    }
+    else
+    {
+        for (; i + 128 <= num; i += 128)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 0), vec);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 32), vec);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 64), vec);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 96), vec);
+        }
+    }
+
+    for (; i + 32 <= num; i += 32)
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), vec);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + num - 32), vec);
+}
+
+__attribute__((target("avx2"))) int
+compare_avx2(const_byte_pointer lhs, const_byte_pointer rhs, size_type num) noexcept
+{
+    if (num < 32)
+        return compare_sse2(lhs, rhs, num);
+
+    auto i = 0ULL;
+
+    for (; i + 32 <= num; i += 32)
+    {
+        auto v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i));
+        auto v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+        auto mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v0, v1)));
+
+        if (mask != 0)
+            return compare_mask(lhs + i, rhs + i, mask);
+    }
+
+    if (i == num)
+        return 0;
+
+    i = num - 32;
+
+    auto v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i));
+    auto v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+    auto mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v0, v1)));
+
+    return mask != 0 ? compare_mask(lhs + i, rhs + i, mask) : 0;
+}
+
+inline uint64_t
+xgetbv(uint32_t index) noexcept
+{
+    uint32_t eax;
+    uint32_t edx;
+
+    asm volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+}
+
+// -----------------------------------------------------------------------------
+// Dispatch
+// -----------------------------------------------------------------------------
+
+struct ops_type
+{
+    variant_type variant;
+
+    void (*copy)(byte_pointer dst, const_byte_pointer src, size_type num) noexcept;
+    void (*set)(byte_pointer dst, uint8_t val, size_type num) noexcept;
+    int (*compare)(const_byte_pointer lhs, const_byte_pointer rhs, size_type num) noexcept;
+};
+
+constexpr const ops_type g_sse2_ops = { sse2, copy_sse2, set_sse2, compare_sse2 };
+constexpr const ops_type g_erms_ops = { erms, copy_erms, set_erms, compare_sse2 };
+constexpr const ops_type g_avx2_ops = { avx2, copy_avx2, set_avx2, compare_avx2 };
+
+// Both are constant initialized, so memcpy / memset work before (and while)
+// the global constructors run.
+
+std::atomic<const ops_type *> g_ops{&g_sse2_ops};
+std::atomic<bool> g_initialized{false};
+
+const ops_type *
+ops(variant_type variant) noexcept
+{
+    switch (variant)
+    {
+        case sse2:
+            return &g_sse2_ops;
+
+        case erms:
+            return &g_erms_ops;
+
+        case avx2:
+            return &g_avx2_ops;
+
+        default:
+            return nullptr;
+    }
+}
+
+}
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+namespace x64
+{
+namespace mem
+{
+
+void
+init() noexcept
+{
+    if (g_initialized.exchange(true))
+        return;
+
+    // ERMS is preferred over AVX2, as rep movsb / stosb are the fastest
+    // option for the copies this is tuned for (at least a few hundred
+    // bytes), and short copies and page fills use SSE2 either way.
+
+    if (select(erms))
+        return;
+
+    if (select(avx2))
+        return;
+
+    select(sse2);
+}
+
+bool
+supported(variant_type variant) noexcept
+{
+    namespace ebx_0 = cpuid::extended_feature_flags::subleaf0::ebx;
+
+    switch (variant)
+    {
+        case sse2:
+            return true;
+
+        case erms:
+            return ebx_0::enhanced_rep::get();
+
+        case avx2:
+            if (!cpuid::feature_information::ecx::osxsave::get())
+                return false;
+
+            if (!ebx_0::avx2::get())
+                return false;
+
+            return (xgetbv(0) & 0x6) == 0x6;
+
+        default:
+            return false;
+    }
+}
+
+bool
+select(variant_type variant) noexcept
+{
+    if (!supported(variant))
+        return false;
+
+    g_ops.store(ops(variant));
+    return true;
+}
+
+variant_type
+selected() noexcept
+{ return g_ops.load(std::memory_order_relaxed)->variant; }
+
+pointer
+copy(pointer dst, const_pointer src, size_type num) noexcept
+{
+    g_ops.load(std::memory_order_relaxed)->copy(
+        static_cast<byte_pointer>(dst), static_cast<const_byte_pointer>(src), num);
+
+    return dst;
+}
+
+pointer
+set(pointer dst, int val, size_type num) noexcept
+{
+    g_ops.load(std::memory_order_relaxed)->set(
+        static_cast<byte_pointer>(dst), static_cast<uint8_t>(val), num);
+
+    return dst;
+}
+
+int
+compare(const_pointer lhs, const_pointer rhs, size_type num) noexcept
+{
+    return g_ops.load(std::memory_order_relaxed)->compare(
+               static_cast<const_byte_pointer>(lhs), static_cast<const_byte_pointer>(rhs), num);
+}
+
+}
+}
@@ -67,3 +67,21 @@ thread_context_tlsptr:
 
     mov rax, [rax]
     ret
+
+global thread_context_node:function
+thread_context_node:
+
+    mov rdx, 0x8000
+    sub rdx, 0x1
+
+    mov rax, rsp
+    mov rcx, rdx
+    not rcx
+    and rax, rcx
+
+    add rax, rdx
+
+    sub rax, 16
+
+    mov rax, [rax]
+    ret
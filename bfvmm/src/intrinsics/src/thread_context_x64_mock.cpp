@@ -28,3 +28,7 @@ __attribute__((weak)) thread_context_cpuid(void)
 extern "C" uint64_t
 __attribute__((weak)) thread_context_tlsptr(void)
 { return 0; }
+
+extern "C" uint64_t
+__attribute__((weak)) thread_context_node(void)
+{ return 0; }
@@ -65,6 +65,8 @@ SOURCES+=test_srs_x64.cpp
 SOURCES+=test_portio_x64.cpp
 SOURCES+=test_tlb_x64.cpp
 SOURCES+=test_vmx_intel_x64.cpp
+SOURCES+=test_lock_x64.cpp
+SOURCES+=test_mem_x64.cpp
 
 INCLUDE_PATHS+=./
 INCLUDE_PATHS+=%HYPER_ABS%/include/
@@ -118,6 +118,11 @@ intrinsics_ut::list()
     this->test_ia32_pat_pa6();
     this->test_ia32_pat_pa7();
     this->test_ia32_pat_pa();
+    this->test_ia32_mtrrcap();
+    this->test_ia32_mtrr_def_type();
+    this->test_ia32_mtrr_physbase();
+    this->test_ia32_mtrr_physmask();
+    this->test_ia32_mtrr_fixed();
     this->test_ia32_perf_global_ctrl();
     this->test_ia32_perf_global_ctrl_pmc0();
     this->test_ia32_perf_global_ctrl_pmc1();
@@ -440,6 +445,22 @@ intrinsics_ut::list()
 
     this->test_tlb_x64_invlpg();
 
+    this->test_lock_x64_stats_unnamed();
+    this->test_lock_x64_stats_acquired();
+    this->test_lock_x64_spinlock();
+    this->test_lock_x64_ticket_lock();
+    this->test_lock_x64_mcs_lock();
+    this->test_lock_x64_rw_spinlock_shared();
+    this->test_lock_x64_rw_spinlock_exclusive();
+    this->test_lock_x64_report();
+    this->test_lock_x64_report_reset();
+
+    this->test_mem_x64_init();
+    this->test_mem_x64_select();
+    this->test_mem_x64_copy();
+    this->test_mem_x64_set();
+    this->test_mem_x64_compare();
+
     this->test_debug_x64_dr7();
 
     this->test_pdpte_x64_reserved_mask();
@@ -448,6 +469,14 @@ intrinsics_ut::list()
     return true;
 }
 
+bool
+intrinsics_ut::benchmark()
+{
+    this->benchmark_mem_x64();
+
+    return true;
+}
+
 int
 main(int argc, char *argv[])
 {
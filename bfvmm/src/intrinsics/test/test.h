@@ -36,6 +36,7 @@ protected:
     bool init() override;
     bool fini() override;
     bool list() override;
+    bool benchmark() override;
 
 private:
 
@@ -117,6 +118,11 @@ private:
     void test_ia32_pat_pa6();
     void test_ia32_pat_pa7();
     void test_ia32_pat_pa();
+    void test_ia32_mtrrcap();
+    void test_ia32_mtrr_def_type();
+    void test_ia32_mtrr_physbase();
+    void test_ia32_mtrr_physmask();
+    void test_ia32_mtrr_fixed();
     void test_ia32_perf_global_ctrl();
     void test_ia32_perf_global_ctrl_pmc0();
     void test_ia32_perf_global_ctrl_pmc1();
@@ -439,10 +445,28 @@ private:
 
     void test_tlb_x64_invlpg();
 
+    void test_lock_x64_stats_unnamed();
+    void test_lock_x64_stats_acquired();
+    void test_lock_x64_spinlock();
+    void test_lock_x64_ticket_lock();
+    void test_lock_x64_mcs_lock();
+    void test_lock_x64_rw_spinlock_shared();
+    void test_lock_x64_rw_spinlock_exclusive();
+    void test_lock_x64_report();
+    void test_lock_x64_report_reset();
+
+    void test_mem_x64_init();
+    void test_mem_x64_select();
+    void test_mem_x64_copy();
+    void test_mem_x64_set();
+    void test_mem_x64_compare();
+
     void test_debug_x64_dr7();
 
     void test_pdpte_x64_reserved_mask();
     void test_pdpte_x64_page_directory_addr_mask();
+
+    void benchmark_mem_x64();
 };
 
 #endif
@@ -0,0 +1,214 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <test.h>
+
+#include <mutex>
+#include <string>
+#include <shared_mutex>
+
+#include <intrinsics/lock_x64.h>
+
+using namespace x64;
+
+static const lock_report_type *
+find_report(const std::vector<lock_report_type> &report, const char *name)
+{
+    for (const auto &entry : report)
+    {
+        if (entry.name != nullptr && std::string(entry.name) == name)
+            return &entry;
+    }
+
+    return nullptr;
+}
+
+void
+intrinsics_ut::test_lock_x64_stats_unnamed()
+{
+    spinlock lock;
+
+    lock.lock();
+    lock.unlock();
+
+    this->expect_false(lock.stats().enabled());
+    this->expect_true(lock.stats().acquisitions() == 0);
+}
+
+void
+intrinsics_ut::test_lock_x64_stats_acquired()
+{
+    lock_stats stats("test_stats_acquired", lock::spinlock);
+
+    stats.acquired(0);
+    stats.acquired(5);
+
+    this->expect_true(stats.enabled());
+    this->expect_true(stats.acquisitions() == 2);
+    this->expect_true(stats.contended() == 1);
+    this->expect_true(stats.spins() == 5);
+
+    stats.reset();
+
+    this->expect_true(stats.acquisitions() == 0);
+    this->expect_true(stats.contended() == 0);
+    this->expect_true(stats.spins() == 0);
+}
+
+void
+intrinsics_ut::test_lock_x64_spinlock()
+{
+    spinlock lock("test_spinlock");
+
+    {
+        std::lock_guard<spinlock> guard(lock);
+        this->expect_false(lock.try_lock());
+    }
+
+    this->expect_true(lock.try_lock());
+    lock.unlock();
+
+    this->expect_true(lock.stats().acquisitions() == 2);
+    this->expect_true(lock.stats().contended() == 0);
+}
+
+void
+intrinsics_ut::test_lock_x64_ticket_lock()
+{
+    ticket_lock lock("test_ticket_lock");
+
+    {
+        std::lock_guard<ticket_lock> guard(lock);
+        this->expect_false(lock.try_lock());
+    }
+
+    this->expect_true(lock.try_lock());
+    lock.unlock();
+
+    {
+        std::lock_guard<ticket_lock> guard(lock);
+        this->expect_false(lock.try_lock());
+    }
+
+    this->expect_true(lock.stats().acquisitions() == 3);
+    this->expect_true(lock.stats().contended() == 0);
+}
+
+void
+intrinsics_ut::test_lock_x64_mcs_lock()
+{
+    mcs_lock lock("test_mcs_lock");
+    mcs_lock::node node;
+
+    {
+        mcs_lock::guard guard(lock);
+        this->expect_false(lock.try_lock(node));
+    }
+
+    this->expect_true(lock.try_lock(node));
+    lock.unlock(node);
+
+    this->expect_true(lock.stats().acquisitions() == 2);
+    this->expect_true(lock.stats().contended() == 0);
+}
+
+void
+intrinsics_ut::test_lock_x64_rw_spinlock_shared()
+{
+    rw_spinlock lock("test_rw_spinlock_shared");
+
+    {
+        std::shared_lock<rw_spinlock> guard1(lock);
+        std::shared_lock<rw_spinlock> guard2(lock);
+
+        this->expect_true(lock.try_lock_shared());
+        this->expect_false(lock.try_lock());
+
+        lock.unlock_shared();
+    }
+
+    this->expect_true(lock.try_lock());
+    lock.unlock();
+
+    this->expect_true(lock.stats().acquisitions() == 4);
+}
+
+void
+intrinsics_ut::test_lock_x64_rw_spinlock_exclusive()
+{
+    rw_spinlock lock("test_rw_spinlock_exclusive");
+
+    {
+        std::lock_guard<rw_spinlock> guard(lock);
+
+        this->expect_false(lock.try_lock());
+        this->expect_false(lock.try_lock_shared());
+    }
+
+    this->expect_true(lock.try_lock_shared());
+    lock.unlock_shared();
+
+    this->expect_true(lock.stats().acquisitions() == 2);
+}
+
+void
+intrinsics_ut::test_lock_x64_report()
+{
+    spinlock unnamed;
+
+    {
+        ticket_lock lock("test_report");
+
+        lock.lock();
+        lock.unlock();
+
+        auto &&report = lock_report();
+        auto &&entry = find_report(report, "test_report");
+
+        this->expect_true(entry != nullptr);
+
+        if (entry != nullptr)
+        {
+            this->expect_true(entry->type == lock::ticket);
+            this->expect_true(entry->acquisitions == 1);
+            this->expect_true(entry->contended == 0);
+        }
+
+        for (const auto &e : report)
+            this->expect_true(e.name != nullptr);
+    }
+
+    this->expect_true(find_report(lock_report(), "test_report") == nullptr);
+}
+
+void
+intrinsics_ut::test_lock_x64_report_reset()
+{
+    spinlock lock("test_report_reset");
+
+    lock.lock();
+    lock.unlock();
+
+    lock_report_reset();
+
+    this->expect_true(lock.stats().acquisitions() == 0);
+    this->expect_true(lock.stats().max_hold() == 0);
+}
@@ -0,0 +1,352 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <test.h>
+
+#include <map>
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+
+#include <intrinsics/mem_x64.h>
+#include <intrinsics/x64.h>
+
+using namespace x64;
+
+// The cpuid registers are mocked in test_cpuid_x64.cpp
+
+struct cpuid_regs
+{
+    cpuid::value_type eax;
+    cpuid::value_type ebx;
+    cpuid::value_type ecx;
+    cpuid::value_type edx;
+};
+
+extern struct cpuid_regs g_regs;
+extern std::map<cpuid::field_type, cpuid::value_type> g_ecx_cpuid;
+
+static const std::vector<mem::size_type> g_sizes = {
+    0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128,
+    129, 255, 256, 257, 1000, mem::non_temporal_set_threshold - 1,
+    mem::non_temporal_set_threshold, mem::non_temporal_set_threshold + 1,
+    mem::non_temporal_threshold - 1,
+    mem::non_temporal_threshold, mem::non_temporal_threshold + 33
+};
+
+static const mem::size_type g_guard = 64;
+
+static bool
+host_supports(mem::variant_type variant)
+{
+    switch (variant)
+    {
+        case mem::avx2:
+            return __builtin_cpu_supports("avx2");
+
+        default:
+            return true;
+    }
+}
+
+static bool
+select_variant(mem::variant_type variant)
+{
+    g_regs.ebx = 0;
+    g_ecx_cpuid[cpuid::feature_information::addr] = 0;
+
+    if (!host_supports(variant))
+        return false;
+
+    switch (variant)
+    {
+        case mem::erms:
+            g_regs.ebx = cpuid::extended_feature_flags::subleaf0::ebx::enhanced_rep::mask;
+            break;
+
+        case mem::avx2:
+            g_regs.ebx = cpuid::extended_feature_flags::subleaf0::ebx::avx2::mask;
+            g_ecx_cpuid[cpuid::feature_information::addr] = cpuid::feature_information::ecx::osxsave::mask;
+            break;
+
+        default:
+            break;
+    }
+
+    return mem::select(variant);
+}
+
+static std::vector<mem::variant_type>
+variants()
+{
+    std::vector<mem::variant_type> list;
+
+    for (auto variant : {mem::sse2, mem::erms, mem::avx2})
+    {
+        if (select_variant(variant))
+            list.push_back(variant);
+    }
+
+    select_variant(mem::sse2);
+    return list;
+}
+
+static const char *
+variant_name(mem::variant_type variant)
+{
+    switch (variant)
+    {
+        case mem::sse2:
+            return "sse2";
+
+        case mem::erms:
+            return "erms";
+
+        case mem::avx2:
+            return "avx2";
+
+        default:
+            return "unknown";
+    }
+}
+
+void
+intrinsics_ut::test_mem_x64_init()
+{
+    g_regs.ebx = cpuid::extended_feature_flags::subleaf0::ebx::enhanced_rep::mask;
+    g_ecx_cpuid[cpuid::feature_information::addr] = 0;
+
+    mem::init();
+    this->expect_true(mem::selected() == mem::erms);
+
+    g_regs.ebx = 0;
+
+    mem::init();
+    this->expect_true(mem::selected() == mem::erms);
+
+    select_variant(mem::sse2);
+}
+
+void
+intrinsics_ut::test_mem_x64_select()
+{
+    this->expect_true(select_variant(mem::sse2));
+    this->expect_true(mem::selected() == mem::sse2);
+
+    g_regs.ebx = 0;
+    g_ecx_cpuid[cpuid::feature_information::addr] = 0;
+
+    this->expect_false(mem::supported(mem::erms));
+    this->expect_false(mem::supported(mem::avx2));
+    this->expect_false(mem::supported(0));
+
+    this->expect_false(mem::select(mem::erms));
+    this->expect_false(mem::select(mem::avx2));
+    this->expect_false(mem::select(0));
+    this->expect_true(mem::selected() == mem::sse2);
+
+    g_regs.ebx = cpuid::extended_feature_flags::subleaf0::ebx::avx2::mask;
+    this->expect_false(mem::supported(mem::avx2));
+
+    if (select_variant(mem::erms))
+        this->expect_true(mem::selected() == mem::erms);
+
+    if (select_variant(mem::avx2))
+        this->expect_true(mem::selected() == mem::avx2);
+
+    select_variant(mem::sse2);
+}
+
+void
+intrinsics_ut::test_mem_x64_copy()
+{
+    for (auto variant : variants())
+    {
+        select_variant(variant);
+
+        for (auto size : g_sizes)
+        {
+            for (auto offset : {0ULL, 1ULL, 7ULL, 13ULL})
+            {
+                auto src = std::vector<uint8_t>(size + g_guard * 2);
+                auto dst = std::vector<uint8_t>(size + g_guard * 2, 0xA5);
+
+                for (auto i = 0ULL; i < src.size(); i++)
+                    src[i] = static_cast<uint8_t>(i * 7 + 3);
+
+                auto ret = mem::copy(&dst[g_guard + offset], &src[g_guard - offset], size);
+                this->expect_true(ret == &dst[g_guard + offset]);
+
+                auto good = true;
+                for (auto i = 0ULL; i < dst.size(); i++)
+                {
+                    if (i >= g_guard + offset && i < g_guard + offset + size)
+                        good &= dst[i] == src[i - offset * 2];
+                    else
+                        good &= dst[i] == 0xA5;
+                }
+
+                this->expect_true(good);
+            }
+        }
+    }
+
+    select_variant(mem::sse2);
+}
+
+void
+intrinsics_ut::test_mem_x64_set()
+{
+    for (auto variant : variants())
+    {
+        select_variant(variant);
+
+        for (auto size : g_sizes)
+        {
+            for (auto offset : {0ULL, 1ULL, 7ULL, 13ULL})
+            {
+                auto dst = std::vector<uint8_t>(size + g_guard * 2, 0xA5);
+
+                auto ret = mem::set(&dst[g_guard + offset], 0x15A, size);
+                this->expect_true(ret == &dst[g_guard + offset]);
+
+                auto good = true;
+                for (auto i = 0ULL; i < dst.size(); i++)
+                {
+                    if (i >= g_guard + offset && i < g_guard + offset + size)
+                        good &= dst[i] == 0x5A;
+                    else
+                        good &= dst[i] == 0xA5;
+                }
+
+                this->expect_true(good);
+            }
+        }
+    }
+
+    select_variant(mem::sse2);
+}
+
+void
+intrinsics_ut::test_mem_x64_compare()
+{
+    for (auto variant : variants())
+    {
+        select_variant(variant);
+
+        for (auto size : g_sizes)
+        {
+            auto lhs = std::vector<uint8_t>(size + 1, 0x42);
+            auto rhs = std::vector<uint8_t>(size + 1, 0x42);
+
+            lhs[size] = 1;
+            rhs[size] = 2;
+
+            this->expect_true(mem::compare(&lhs[0], &rhs[0], size) == 0);
+
+            for (auto diff : {mem::size_type{0}, size / 2, size - 1})
+            {
+                if (diff >= size)
+                    continue;
+
+                rhs[diff] = 0x43;
+                this->expect_true(mem::compare(&lhs[0], &rhs[0], size) == -1);
+                this->expect_true(mem::compare(&rhs[0], &lhs[0], size) == 1);
+
+                rhs[diff] = 0x42;
+            }
+
+            if (size > 2)
+            {
+                rhs[size - 1] = 0x00;
+                rhs[size / 2] = 0xFF;
+                this->expect_true(mem::compare(&lhs[0], &rhs[0], size) == 0x42 - 0xFF);
+            }
+        }
+    }
+
+    select_variant(mem::sse2);
+}
+
+void
+intrinsics_ut::benchmark_mem_x64()
+{
+    // Reports the time per call for a size sweep from 16 bytes to 4 MB, with
+    // each variant, and the compiler's / C library's memcpy / memset as a
+    // baseline. The number of iterations is scaled so that each size moves
+    // the same number of bytes.
+
+    using clock = std::chrono::steady_clock;
+
+    constexpr const auto total = 0x4000000ULL;
+    constexpr const auto max_size = 0x400000ULL;
+
+    auto src = std::vector<uint8_t>(max_size, 0x42);
+    auto dst = std::vector<uint8_t>(max_size, 0x00);
+
+    auto time = [&](auto func, mem::size_type size)
+    {
+        auto iterations = std::max(total / size, 16ULL);
+        auto start = clock::now();
+
+        for (auto i = 0ULL; i < iterations; i++)
+        {
+            func(dst.data(), src.data(), size);
+            asm volatile("" : : "r"(dst.data()) : "memory");
+        }
+
+        auto elapsed = clock::now() - start;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+        return static_cast<double>(ns) / static_cast<double>(iterations);
+    };
+
+    auto report = [&](const char *name, const char *op, mem::size_type size, double ns)
+    {
+        std::cout << std::setw(8) << name << " " << op << " "
+                  << std::setw(8) << size << " bytes: "
+                  << std::fixed << std::setprecision(1) << std::setw(10) << ns << " ns per call, "
+                  << std::setw(6) << static_cast<double>(size) / ns << " GB/s" << std::endl;
+    };
+
+    for (auto size = 16ULL; size <= max_size; size <<= 2)
+    {
+        report("libc", "copy", size, time([](auto d, auto s, auto n) { memcpy(d, s, n); }, size));
+
+        for (auto variant : variants())
+        {
+            select_variant(variant);
+            report(variant_name(variant), "copy", size, time([](auto d, auto s, auto n) { mem::copy(d, s, n); }, size));
+        }
+
+        report("libc", "set ", size, time([](auto d, auto, auto n) { memset(d, 0, n); }, size));
+
+        for (auto variant : variants())
+        {
+            select_variant(variant);
+            report(variant_name(variant), "set ", size, time([](auto d, auto, auto n) { mem::set(d, 0, n); }, size));
+        }
+    }
+
+    select_variant(mem::sse2);
+}
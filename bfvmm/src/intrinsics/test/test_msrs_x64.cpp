@@ -175,3 +175,79 @@ intrinsics_ut::test_ia32_pat_pa()
     this->expect_exception([&] { msrs::ia32_pat::pa(10UL); }, ""_ut_ree);
     this->expect_exception([&] { msrs::ia32_pat::pa(0x0000000000000000UL, 10UL); }, ""_ut_ree);
 }
+
+void
+intrinsics_ut::test_ia32_mtrrcap()
+{
+    g_msrs[msrs::ia32_mtrrcap::addr] = 0x0000000000000508UL;
+
+    this->expect_true(msrs::ia32_mtrrcap::get() == 0x0000000000000508UL);
+    this->expect_true(msrs::ia32_mtrrcap::vcnt::get() == 8UL);
+    this->expect_true(msrs::ia32_mtrrcap::vcnt::get(0x000000000000050AUL) == 10UL);
+    this->expect_true(msrs::ia32_mtrrcap::fixed_range_support::get());
+    this->expect_false(msrs::ia32_mtrrcap::fixed_range_support::get(0x0UL));
+    this->expect_true(msrs::ia32_mtrrcap::wc_support::get());
+    this->expect_false(msrs::ia32_mtrrcap::wc_support::get(0x0UL));
+
+    msrs::ia32_mtrrcap::dump();
+}
+
+void
+intrinsics_ut::test_ia32_mtrr_def_type()
+{
+    g_msrs[msrs::ia32_mtrr_def_type::addr] = 0x0000000000000C06UL;
+
+    this->expect_true(msrs::ia32_mtrr_def_type::get() == 0x0000000000000C06UL);
+    this->expect_true(msrs::ia32_mtrr_def_type::type::get() == 6UL);
+    this->expect_true(msrs::ia32_mtrr_def_type::type::get(0x0000000000000800UL) == 0UL);
+    this->expect_true(msrs::ia32_mtrr_def_type::fixed_range_enable::get());
+    this->expect_false(msrs::ia32_mtrr_def_type::fixed_range_enable::get(0x0000000000000800UL));
+    this->expect_true(msrs::ia32_mtrr_def_type::mtrr_enable::get());
+    this->expect_false(msrs::ia32_mtrr_def_type::mtrr_enable::get(0x0000000000000400UL));
+
+    msrs::ia32_mtrr_def_type::dump();
+}
+
+void
+intrinsics_ut::test_ia32_mtrr_physbase()
+{
+    this->expect_true(msrs::ia32_mtrr_physbase::addr(0) == 0x200U);
+    this->expect_true(msrs::ia32_mtrr_physbase::addr(9) == 0x212U);
+
+    g_msrs[0x202U] = 0x00000000C0000000UL;
+    this->expect_true(msrs::ia32_mtrr_physbase::get(1) == 0x00000000C0000000UL);
+
+    this->expect_true(msrs::ia32_mtrr_physbase::type::get(0x00000000C0000006UL) == 6UL);
+    this->expect_true(msrs::ia32_mtrr_physbase::physbase::get(0x00000000C0000006UL) == 0x00000000C0000000UL);
+}
+
+void
+intrinsics_ut::test_ia32_mtrr_physmask()
+{
+    this->expect_true(msrs::ia32_mtrr_physmask::addr(0) == 0x201U);
+    this->expect_true(msrs::ia32_mtrr_physmask::addr(9) == 0x213U);
+
+    g_msrs[0x203U] = 0x0000007FC0000800UL;
+    this->expect_true(msrs::ia32_mtrr_physmask::get(1) == 0x0000007FC0000800UL);
+
+    this->expect_true(msrs::ia32_mtrr_physmask::valid::get(0x0000007FC0000800UL));
+    this->expect_false(msrs::ia32_mtrr_physmask::valid::get(0x0000007FC0000000UL));
+    this->expect_true(msrs::ia32_mtrr_physmask::physmask::get(0x0000007FC0000800UL) == 0x0000007FC0000000UL);
+}
+
+void
+intrinsics_ut::test_ia32_mtrr_fixed()
+{
+    g_msrs[0x250U] = 0x0606060606060606UL;
+    g_msrs[0x258U] = 0x0000000000000006UL;
+    g_msrs[0x259U] = 0x0000000000000001UL;
+    g_msrs[0x26FU] = 0x0500000000000000UL;
+
+    this->expect_true(msrs::ia32_mtrr_fix64k_00000::get() == 0x0606060606060606UL);
+    this->expect_true(msrs::ia32_mtrr_fix16k_80000::get() == 0x0000000000000006UL);
+    this->expect_true(msrs::ia32_mtrr_fix16k_a0000::get() == 0x0000000000000001UL);
+
+    this->expect_true(msrs::ia32_mtrr_fix4k::addr(0) == 0x268U);
+    this->expect_true(msrs::ia32_mtrr_fix4k::addr(7) == 0x26FU);
+    this->expect_true(msrs::ia32_mtrr_fix4k::get(7) == 0x0500000000000000UL);
+}
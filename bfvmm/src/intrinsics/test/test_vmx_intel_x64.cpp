@@ -86,9 +86,15 @@ extern "C" bool
 __vmlaunch_demote(void) noexcept
 { return !g_vmlaunch_fails; }
 
+uint64_t g_invept_type = 0;
+uint64_t g_invept_eptp = 0;
+
 extern "C" void
 __invept(uint64_t type, void *ptr) noexcept
-{ (void) type; (void) ptr; }
+{
+    g_invept_type = type;
+    g_invept_eptp = static_cast<uint64_t *>(ptr)[0];
+}
 
 extern "C" void
 __invvipd(uint64_t type, void *ptr) noexcept
@@ -267,8 +273,13 @@ intrinsics_ut::test_vmx_intel_x64_vmlaunch_success()
 void
 intrinsics_ut::test_vmx_intel_x64_invept()
 {
-    this->expect_no_exception([&] { vmx::invept_single_context(0); });
+    this->expect_no_exception([&] { vmx::invept_single_context(0x1234000000001EUL); });
+    this->expect_true(g_invept_type == 1);
+    this->expect_true(g_invept_eptp == 0x1234000000001EUL);
+
     this->expect_no_exception([&] { vmx::invept_global(); });
+    this->expect_true(g_invept_type == 2);
+    this->expect_true(g_invept_eptp == 0);
 }
 
 void
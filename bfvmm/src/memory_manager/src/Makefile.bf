@@ -68,6 +68,11 @@ SOURCES+=memory_manager_x64.cpp
 SOURCES+=page_table_x64.cpp
 SOURCES+=page_table_entry_x64.cpp
 SOURCES+=root_page_table_x64.cpp
+SOURCES+=mtrr_x64.cpp
+SOURCES+=ept_intel_x64.cpp
+SOURCES+=ept_entry_intel_x64.cpp
+SOURCES+=root_ept_intel_x64.cpp
+SOURCES+=dirty_log_intel_x64.cpp
 HEADERS=
 
 INCLUDE_PATHS+=./
@@ -0,0 +1,243 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <mutex>
+#include <algorithm>
+
+#include <memory_manager/dirty_log_intel_x64.h>
+
+#include <intrinsics/x64.h>
+
+using namespace x64;
+
+constexpr const auto bits_per_word = 64UL;
+
+dirty_log_intel_x64::dirty_log_intel_x64(gsl::not_null<root_ept_intel_x64 *> ept) noexcept :
+    m_ept(ept),
+    m_gpa(0),
+    m_pages(0),
+    m_vcpus(0),
+    m_tracking_vcpus(0),
+    m_synced_vcpus(0),
+    m_generation(0)
+{ }
+
+void
+dirty_log_intel_x64::start(integer_pointer gpa, size_type size)
+{
+    expects((gpa & (page_table::pt::size_bytes - 1)) == 0);
+    expects((size & (page_table::pt::size_bytes - 1)) == 0);
+    expects(size != 0);
+
+    std::lock_guard<x64::spinlock> guard(m_lock);
+
+    expects(m_pages == 0);
+
+    auto &&pages = size >> page_table::pt::from;
+    auto &&bitmap = std::vector<word_type>((pages + bits_per_word - 1) / bits_per_word, ~0ULL);
+
+    if ((pages % bits_per_word) != 0)
+        bitmap.back() = (1ULL << (pages % bits_per_word)) - 1;
+
+    auto &&stale = std::vector<word_type>(bitmap.size(), 0);
+
+    // Other vCPUs keep running while the range is split, which is safe as
+    // each large page is replaced by a table that maps the same memory.
+    // Their cached large page translations would not set the dirty flags
+    // of the new 4k pages though, so no vCPU counts as synced until it has
+    // invalidated after this generation.
+
+    m_ept->split_4k(gpa, size);
+
+    m_gpa = gpa;
+    m_pages = pages;
+    m_bitmap = std::move(bitmap);
+    m_stale = std::move(stale);
+
+    this->next_generation();
+}
+
+void
+dirty_log_intel_x64::stop()
+{
+    std::lock_guard<x64::spinlock> guard(m_lock);
+
+    if (m_pages == 0)
+        return;
+
+    m_gpa = 0;
+    m_pages = 0;
+    m_bitmap = std::vector<word_type>();
+    m_stale = std::vector<word_type>();
+
+    this->next_generation();
+}
+
+void
+dirty_log_intel_x64::log(gsl::span<const integer_pointer> gpas)
+{
+    std::lock_guard<x64::spinlock> guard(m_lock);
+
+    for (auto gpa : gpas)
+    {
+        if (gpa < m_gpa)
+            continue;
+
+        auto &&page = (gpa - m_gpa) >> page_table::pt::from;
+
+        if (page >= m_pages)
+            continue;
+
+        m_bitmap[page / bits_per_word] |= 1ULL << (page % bits_per_word);
+    }
+}
+
+dirty_log_intel_x64::size_type
+dirty_log_intel_x64::harvest(size_type first, gsl::span<word_type> bitmap)
+{
+    std::lock_guard<x64::spinlock> guard(m_lock);
+
+    expects(m_pages != 0);
+    expects((first % bits_per_word) == 0);
+    expects(first < m_pages);
+
+    if (m_tracking_vcpus != m_vcpus)
+        throw std::runtime_error("dirty log cannot be harvested until every vcpu is tracking writes");
+
+    // Stale pages are reported until every tracking vCPU has invalidated
+    // its cached translations, as any of them could have written to a stale
+    // page without logging it. Only the dirty pages are cleared though, as
+    // the dirty flag of a stale page is already clear. The harvesting vCPU
+    // invalidates before it returns to the guest, so a single tracking vCPU
+    // never leaves stale pages behind.
+
+    auto &&synced = m_synced_vcpus == m_tracking_vcpus;
+    auto &&leaves_stale = m_tracking_vcpus > 1;
+
+    auto &&index = first / bits_per_word;
+    auto &&words = std::min(static_cast<size_type>(bitmap.size()), m_bitmap.size() - index);
+
+    auto num = 0UL;
+    auto cleared = false;
+
+    for (auto i = 0UL; i < words; i++)
+    {
+        auto dirty = m_bitmap[index + i];
+        auto stale = synced ? 0ULL : m_stale[index + i];
+        auto word = dirty | m_stale[index + i];
+
+        bitmap[static_cast<std::ptrdiff_t>(i)] = word;
+
+        m_bitmap[index + i] = 0;
+        m_stale[index + i] = stale | (leaves_stale ? dirty : 0ULL);
+
+        for (auto bits = dirty; bits != 0; bits &= bits - 1)
+        {
+            auto &&page = first + (i * bits_per_word) + static_cast<size_type>(__builtin_ctzll(bits));
+            m_ept->clear_dirty(m_gpa + (page << page_table::pt::from));
+
+            cleared = true;
+        }
+
+        num += static_cast<size_type>(__builtin_popcountll(word));
+    }
+
+    if (cleared)
+        this->next_generation();
+
+    return num;
+}
+
+void
+dirty_log_intel_x64::add_vcpu() noexcept
+{
+    std::lock_guard<x64::spinlock> guard(m_lock);
+    m_vcpus++;
+}
+
+void
+dirty_log_intel_x64::remove_vcpu() noexcept
+{
+    std::lock_guard<x64::spinlock> guard(m_lock);
+
+    if (m_vcpus != 0)
+        m_vcpus--;
+}
+
+dirty_log_intel_x64::size_type
+dirty_log_intel_x64::vcpus() const noexcept
+{
+    std::lock_guard<x64::spinlock> guard(m_lock);
+    return m_vcpus;
+}
+
+dirty_log_intel_x64::generation_type
+dirty_log_intel_x64::add_tracking_vcpu() noexcept
+{
+    std::lock_guard<x64::spinlock> guard(m_lock);
+
+    m_tracking_vcpus++;
+    return this->generation();
+}
+
+void
+dirty_log_intel_x64::remove_tracking_vcpu(generation_type generation) noexcept
+{
+    std::lock_guard<x64::spinlock> guard(m_lock);
+
+    if (m_tracking_vcpus == 0)
+        return;
+
+    m_tracking_vcpus--;
+
+    if (generation == this->generation() && m_synced_vcpus != 0)
+        m_synced_vcpus--;
+}
+
+void
+dirty_log_intel_x64::vcpu_synced(generation_type generation) noexcept
+{
+    std::lock_guard<x64::spinlock> guard(m_lock);
+
+    if (generation == this->generation() && m_synced_vcpus < m_tracking_vcpus)
+        m_synced_vcpus++;
+}
+
+dirty_log_intel_x64::size_type
+dirty_log_intel_x64::tracking_vcpus() const noexcept
+{
+    std::lock_guard<x64::spinlock> guard(m_lock);
+    return m_tracking_vcpus;
+}
+
+void
+dirty_log_intel_x64::next_generation() noexcept
+{
+    m_synced_vcpus = 0;
+    m_generation.fetch_add(1, std::memory_order_release);
+}
+
+dirty_log_intel_x64 *
+dirty_log() noexcept
+{
+    static dirty_log_intel_x64 log(g_ept);
+    return &log;
+}
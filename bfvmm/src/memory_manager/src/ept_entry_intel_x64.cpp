@@ -0,0 +1,162 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#include <bitmanip.h>
+#include <memory_manager/ept_entry_intel_x64.h>
+
+#include <intrinsics/x64.h>
+using namespace x64;
+
+// The CPU sets the accessed and dirty flags of a live entry with locked
+// operations, and other CPUs might be walking the entry while it changes,
+// so each modification is a single atomic read-modify-write. This never
+// exposes a partially modified entry, and never loses a flag that the CPU
+// sets at the same time.
+
+template<class F> static void
+update(ept_entry_intel_x64::pointer epte, F func) noexcept
+{
+    auto old = __atomic_load_n(epte, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(epte, &old, func(old), true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+ept_entry_intel_x64::ept_entry_intel_x64(gsl::not_null<pointer> epte) noexcept :
+    m_epte(epte.get())
+{ }
+
+ept_entry_intel_x64::integer_pointer
+ept_entry_intel_x64::value() const noexcept
+{ return __atomic_load_n(m_epte, __ATOMIC_RELAXED); }
+
+void
+ept_entry_intel_x64::set_value(integer_pointer value) noexcept
+{ __atomic_store_n(m_epte, value, __ATOMIC_RELEASE); }
+
+bool
+ept_entry_intel_x64::read_access() const noexcept
+{ return is_bit_set(*m_epte, 0); }
+
+void
+ept_entry_intel_x64::set_read_access(bool enabled) noexcept
+{ update(m_epte, [&](auto epte) { return enabled ? set_bit(epte, 0) : clear_bit(epte, 0); }); }
+
+bool
+ept_entry_intel_x64::write_access() const noexcept
+{ return is_bit_set(*m_epte, 1); }
+
+void
+ept_entry_intel_x64::set_write_access(bool enabled) noexcept
+{ update(m_epte, [&](auto epte) { return enabled ? set_bit(epte, 1) : clear_bit(epte, 1); }); }
+
+bool
+ept_entry_intel_x64::execute_access() const noexcept
+{ return is_bit_set(*m_epte, 2); }
+
+void
+ept_entry_intel_x64::set_execute_access(bool enabled) noexcept
+{ update(m_epte, [&](auto epte) { return enabled ? set_bit(epte, 2) : clear_bit(epte, 2); }); }
+
+ept_entry_intel_x64::access_type
+ept_entry_intel_x64::access() const noexcept
+{ return get_bits(*m_epte, intel_x64::ept::access_mask); }
+
+void
+ept_entry_intel_x64::set_access(access_type access)
+{
+    expects((access & ~intel_x64::ept::access_mask) == 0);
+    update(m_epte, [&](auto epte) { return set_bits(epte, intel_x64::ept::access_mask, access); });
+}
+
+ept_entry_intel_x64::memory_type_type
+ept_entry_intel_x64::memory_type() const noexcept
+{ return get_bits(*m_epte, 0x0000000000000038UL) >> 3; }
+
+void
+ept_entry_intel_x64::set_memory_type(memory_type_type type)
+{
+    switch (type)
+    {
+        case memory_type::uncacheable:
+        case memory_type::write_combining:
+        case memory_type::write_through:
+        case memory_type::write_protected:
+        case memory_type::write_back:
+            break;
+
+        default:
+            throw std::logic_error("invalid ept memory type");
+    }
+
+    update(m_epte, [&](auto epte) { return set_bits(epte, 0x0000000000000038UL, type << 3); });
+}
+
+bool
+ept_entry_intel_x64::ignore_pat() const noexcept
+{ return is_bit_set(*m_epte, 6); }
+
+void
+ept_entry_intel_x64::set_ignore_pat(bool enabled) noexcept
+{ update(m_epte, [&](auto epte) { return enabled ? set_bit(epte, 6) : clear_bit(epte, 6); }); }
+
+bool
+ept_entry_intel_x64::entry_type() const noexcept
+{ return is_bit_set(*m_epte, 7); }
+
+void
+ept_entry_intel_x64::set_entry_type(bool enabled) noexcept
+{ update(m_epte, [&](auto epte) { return enabled ? set_bit(epte, 7) : clear_bit(epte, 7); }); }
+
+bool
+ept_entry_intel_x64::accessed() const noexcept
+{ return is_bit_set(*m_epte, 8); }
+
+void
+ept_entry_intel_x64::set_accessed(bool enabled) noexcept
+{ update(m_epte, [&](auto epte) { return enabled ? set_bit(epte, 8) : clear_bit(epte, 8); }); }
+
+bool
+ept_entry_intel_x64::dirty() const noexcept
+{ return is_bit_set(*m_epte, 9); }
+
+void
+ept_entry_intel_x64::set_dirty(bool enabled) noexcept
+{ update(m_epte, [&](auto epte) { return enabled ? set_bit(epte, 9) : clear_bit(epte, 9); }); }
+
+ept_entry_intel_x64::integer_pointer
+ept_entry_intel_x64::phys_addr() const noexcept
+{ return get_bits(*m_epte, 0x0000FFFFFFFFF000UL); }
+
+void
+ept_entry_intel_x64::set_phys_addr(integer_pointer addr) noexcept
+{ update(m_epte, [&](auto epte) { return set_bits(epte, 0x0000FFFFFFFFF000UL, addr); }); }
+
+bool
+ept_entry_intel_x64::suppress_ve() const noexcept
+{ return is_bit_set(*m_epte, 63); }
+
+void
+ept_entry_intel_x64::set_suppress_ve(bool enabled) noexcept
+{ update(m_epte, [&](auto epte) { return enabled ? set_bit(epte, 63) : clear_bit(epte, 63); }); }
+
+void
+ept_entry_intel_x64::clear() noexcept
+{ set_value(0); }
@@ -0,0 +1,261 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#include <algorithm>
+
+#include <bitmanip.h>
+#include <memory_manager/ept_intel_x64.h>
+#include <memory_manager/memory_manager_x64.h>
+
+#include <intrinsics/x64.h>
+#include <intrinsics/mem_x64.h>
+using namespace x64;
+
+template<class T, class I> static auto
+find_child(T &epts, I index)
+{
+    return std::lower_bound(epts.begin(), epts.end(), index,
+    [](const auto &child, auto idx) { return child.index < idx; });
+}
+
+ept_intel_x64::ept_intel_x64(gsl::not_null<pointer> epte, integer_pointer leaf, integer_pointer bits) :
+    m_size(0)
+{
+    m_ept = std::unique_ptr<integer_pointer[]>(new integer_pointer[page_table::num_entries]);
+    mem::set(m_ept.get(), 0, page_table::num_bytes);
+
+    // When a large page is split, the replacement table maps 1/512 of the
+    // large page per entry with the same access rights and memory type.
+    // Pages in a PT do not have a page size bit (bit 7 is ignored), so it
+    // is cleared when a 2m page is split into 4k pages.
+
+    if (leaf != 0)
+    {
+        auto &&child_bits = bits - page_table::pt::size;
+        auto &&child_size = 1UL << child_bits;
+        auto &&leaf_addr = get_bits(leaf, 0x0000FFFFFFFFF000UL);
+
+        for (auto i = 0UL; i < page_table::num_entries; i++)
+        {
+            auto entry = set_bits(leaf, 0x0000FFFFFFFFF000UL, leaf_addr + (i * child_size));
+
+            if (child_bits == page_table::pt::from)
+                entry = clear_bit(entry, 7);
+
+            m_ept[i] = entry;
+        }
+
+        m_used.set();
+        m_size = page_table::num_entries;
+    }
+
+    // The parent entry might be live (it is a large page that is being
+    // split), so the table is only published once it has been filled in,
+    // using a single atomic store.
+
+    auto &&value = 0UL;
+    auto &&entry = ept_entry_intel_x64(&value);
+    entry.set_phys_addr(g_mm->virtptr_to_physint(m_ept.get()));
+    entry.set_access(intel_x64::ept::read_write_execute);
+
+    ept_entry_intel_x64(epte).set_value(value);
+}
+
+// Note:
+//
+// Like page_table_x64, page_table::index() masks the address with 0x1FF, so
+// the functions below index m_ept directly.
+//
+
+ept_entry_intel_x64
+ept_intel_x64::add_page(integer_pointer gpa, integer_pointer bits, integer_pointer end)
+{
+    auto &&index = page_table::index(gpa, bits);
+
+    if (bits > end)
+    {
+        auto &&ept = find_ept(index);
+        if (ept == nullptr)
+            ept = m_used[index] ? split_ept(index, bits) : add_ept(index);
+
+        return ept->add_page(gpa, bits - page_table::pt::size, end);
+    }
+
+    remove_ept(index);
+    set_used(index);
+
+    return ept_entry_intel_x64(&m_ept[index]);
+}
+
+void
+ept_intel_x64::remove_page(integer_pointer gpa, integer_pointer bits)
+{
+    auto &&index = page_table::index(gpa, bits);
+
+    if (auto ept = find_ept(index))
+    {
+        ept->remove_page(gpa, bits - page_table::pt::size);
+        if (ept->empty())
+        {
+            remove_ept(index);
+            clear_used(index);
+        }
+
+        return;
+    }
+
+    clear_used(index);
+}
+
+ept_entry_intel_x64
+ept_intel_x64::gpa_to_epte(integer_pointer gpa, integer_pointer bits) const
+{
+    auto &&index = page_table::index(gpa, bits);
+
+    if (auto ept = find_ept(index))
+        return ept->gpa_to_epte(gpa, bits - page_table::pt::size);
+
+    if (!m_used[index])
+        throw std::runtime_error("unable to locate epte. invalid address");
+
+    return ept_entry_intel_x64(&m_ept[index]);
+}
+
+ept_intel_x64::size_type
+ept_intel_x64::gpa_to_page_size(integer_pointer gpa, integer_pointer bits) const
+{
+    auto &&index = page_table::index(gpa, bits);
+
+    if (auto ept = find_ept(index))
+        return ept->gpa_to_page_size(gpa, bits - page_table::pt::size);
+
+    if (!m_used[index])
+        throw std::runtime_error("unable to locate epte. invalid address");
+
+    return 1UL << bits;
+}
+
+ept_intel_x64::size_type
+ept_intel_x64::global_pages(integer_pointer from, integer_pointer bits) const noexcept
+{
+    if (bits == from)
+        return m_size - m_epts.size();
+
+    auto size = 0UL;
+
+    for (const auto &child : m_epts)
+        size += child.ept->global_pages(from, bits - page_table::pt::size);
+
+    return size;
+}
+
+ept_intel_x64::size_type
+ept_intel_x64::global_nodes() const noexcept
+{
+    auto size = 1UL;
+
+    for (const auto &child : m_epts)
+        size += child.ept->global_nodes();
+
+    return size;
+}
+
+ept_intel_x64::size_type
+ept_intel_x64::global_bytes() const noexcept
+{
+    auto size = sizeof(*this) + page_table::num_bytes + (m_epts.capacity() * sizeof(child_type));
+
+    for (const auto &child : m_epts)
+        size += child.ept->global_bytes();
+
+    return size;
+}
+
+ept_intel_x64 *
+ept_intel_x64::find_ept(size_type index) const noexcept
+{
+    auto &&iter = find_child(m_epts, index);
+
+    if (iter == m_epts.end() || iter->index != index)
+        return nullptr;
+
+    return iter->ept.get();
+}
+
+ept_intel_x64 *
+ept_intel_x64::add_ept(size_type index, integer_pointer leaf, integer_pointer bits)
+{
+    auto &&iter = find_child(m_epts, index);
+
+    auto &&ept = std::make_unique<ept_intel_x64>(&m_ept[index], leaf, bits);
+    iter = m_epts.insert(iter, {index, std::move(ept)});
+
+    set_used(index);
+    return iter->ept.get();
+}
+
+ept_intel_x64 *
+ept_intel_x64::split_ept(size_type index, integer_pointer bits)
+{ return add_ept(index, m_ept[index], bits); }
+
+void
+ept_intel_x64::remove_ept(size_type index) noexcept
+{
+    if (m_epts.empty())
+        return;
+
+    auto &&iter = find_child(m_epts, index);
+
+    if (iter == m_epts.end() || iter->index != index)
+        return;
+
+    // The CPU must not be able to reach the table once it is freed, so the
+    // parent entry is cleared first
+
+    ept_entry_intel_x64(&m_ept[index]).clear();
+    m_epts.erase(iter);
+
+    if (m_epts.empty())
+        m_epts.shrink_to_fit();
+}
+
+void
+ept_intel_x64::set_used(size_type index) noexcept
+{
+    if (m_used[index])
+        return;
+
+    m_used[index] = true;
+    m_size++;
+}
+
+void
+ept_intel_x64::clear_used(size_type index) noexcept
+{
+    ept_entry_intel_x64(&m_ept[index]).clear();
+
+    if (!m_used[index])
+        return;
+
+    m_used[index] = false;
+    m_size--;
+}
@@ -21,14 +21,22 @@
 
 #include <gsl/gsl>
 
+#include <mutex>
+#include <algorithm>
+#include <shared_mutex>
+
 #include <constants.h>
+#include <thread_context.h>
 #include <guard_exceptions.h>
 #include <memory_manager/mem_pool.h>
+#include <memory_manager/mem_arena.h>
 #include <memory_manager/map_ptr_x64.h>
 #include <memory_manager/page_table_x64.h>
 #include <memory_manager/memory_manager_x64.h>
 
 #include <intrinsics/x64.h>
+#include <intrinsics/mem_x64.h>
+#include <intrinsics/lock_x64.h>
 using namespace x64;
 
 // -----------------------------------------------------------------------------
@@ -48,11 +56,394 @@ mem_pool<MAX_MEM_MAP_POOL, page_shift> g_mem_map_pool(MEM_MAP_POOL_START);
 /// \endcond
 
 // -----------------------------------------------------------------------------
-// Mutexes
+// Arenas
 // -----------------------------------------------------------------------------
 
-#include <mutex>
-std::mutex g_add_md_mutex;
+/// \cond
+
+// The static heap and page pools are the first heap and page arenas. More
+// arenas are added by add_chunk(). Arenas are only ever appended, and the
+// number of arenas is published with release semantics once the new arena
+// is ready, so alloc / free / size walk the arenas without a lock.
+
+template<class T>
+struct arena_list
+{
+    T *arenas[MAX_MEM_ARENAS];
+    uint64_t num;
+    uint64_t hint;
+};
+
+using heap_arena_type = mem_arena<cache_line_shift>;
+using page_arena_type = mem_arena<page_shift>;
+
+arena_list<heap_arena_type> g_heap_arenas = {{&g_heap_pool}, 1, 0};
+arena_list<page_arena_type> g_page_arenas = {{&g_page_pool}, 1, 0};
+
+// Page chunks that are local to a NUMA node get their own list of arenas,
+// which is tried first by the CPUs of that node. The shared page arenas are
+// used once the local arenas are full.
+
+arena_list<page_arena_type> g_node_page_arenas[MAX_NUMA_NODES] = {};
+
+memory_chunk g_reserve_chunks[MAX_MEM_ARENAS] = {};
+uint64_t g_num_reserve_chunks = 0;
+
+spinlock g_arena_lock("mm_arena");
+
+template<class T> static uintptr_t
+arena_alloc(arena_list<T> &list, uint64_t num, size_t size) noexcept
+{
+    auto hint = __atomic_load_n(&list.hint, __ATOMIC_RELAXED);
+
+    for (auto i = 0ULL; i < num; i++)
+    {
+        auto index = (hint + i) % num;
+
+        if (auto addr = list.arenas[index]->try_alloc(size))
+        {
+            if (index != hint)
+                __atomic_store_n(&list.hint, index, __ATOMIC_RELAXED);
+
+            return addr;
+        }
+    }
+
+    return 0;
+}
+
+template<class T> static T *
+arena_find(const arena_list<T> &list, uintptr_t ptr) noexcept
+{
+    auto num = __atomic_load_n(&list.num, __ATOMIC_ACQUIRE);
+
+    for (auto i = 0ULL; i < num; i++)
+    {
+        if (list.arenas[i]->contains(ptr))
+            return list.arenas[i];
+    }
+
+    return nullptr;
+}
+
+template<class T> static bool
+arena_add(arena_list<T> &list, uintptr_t virt, size_t size) noexcept
+{
+    if (list.num >= MAX_MEM_ARENAS)
+        return false;
+
+    auto arena = T::create(virt, size);
+    if (arena == nullptr)
+        return false;
+
+    list.arenas[list.num] = arena;
+    __atomic_store_n(&list.num, list.num + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+template<class T> static bool
+arena_grow(arena_list<T> &list, uint64_t num, size_t size) noexcept
+{
+    std::lock_guard<spinlock> guard(g_arena_lock);
+
+    if (list.num != num)
+        return true;
+
+    if (g_num_reserve_chunks == 0)
+        return false;
+
+    const auto &chunk = g_reserve_chunks[g_num_reserve_chunks - 1];
+
+    if (T::usable_size(chunk.size) < size)
+        return false;
+
+    if (!arena_add(list, chunk.virt, chunk.size))
+        return false;
+
+    g_num_reserve_chunks--;
+    return true;
+}
+
+template<class T> static uintptr_t
+arena_list_alloc(arena_list<T> &list, size_t size) noexcept
+{
+    while (true)
+    {
+        auto num = __atomic_load_n(&list.num, __ATOMIC_ACQUIRE);
+
+        if (auto addr = arena_alloc(list, num, size))
+            return addr;
+
+        if (!arena_grow(list, num, size))
+            return 0;
+    }
+}
+
+static page_arena_type *
+page_arena_find(uintptr_t ptr) noexcept
+{
+    if (auto arena = arena_find(g_page_arenas, ptr))
+        return arena;
+
+    for (const auto &list : g_node_page_arenas)
+    {
+        if (auto arena = arena_find(list, ptr))
+            return arena;
+    }
+
+    return nullptr;
+}
+
+static uintptr_t
+page_arena_alloc(size_t size) noexcept
+{
+    auto node = thread_context_node();
+
+    if (node < MAX_NUMA_NODES)
+    {
+        auto &list = g_node_page_arenas[node];
+        auto num = __atomic_load_n(&list.num, __ATOMIC_ACQUIRE);
+
+        if (auto addr = arena_alloc(list, num, size))
+            return addr;
+    }
+
+    return arena_list_alloc(g_page_arenas, size);
+}
+
+template<class T> static memory_manager_x64::arena_stats_type
+arena_stats_of(const T *arena, uint64_t type, uint64_t node = MEMORY_CHUNK_ANY_NODE)
+{
+    memory_manager_x64::arena_stats_type stats = {};
+
+    stats.type = type;
+    stats.node = node;
+    stats.addr = arena->addr();
+    stats.size = arena->capacity();
+    stats.used = arena->used();
+    stats.peak = arena->peak();
+    stats.largest_free = arena->largest_free();
+    stats.free_ranges = arena->free_ranges();
+    arena->occupancy(stats.map);
+
+    return stats;
+}
+
+template<class T> static void
+arena_list_stats(const arena_list<T> &list, uint64_t type, uint64_t node, memory_manager_x64::arena_stats_list &stats)
+{
+    auto num = __atomic_load_n(&list.num, __ATOMIC_ACQUIRE);
+
+    for (auto i = 0ULL; i < num; i++)
+        stats.push_back(arena_stats_of(list.arenas[i], type, node));
+}
+
+/// \endcond
+
+// -----------------------------------------------------------------------------
+// Emergency Pools
+// -----------------------------------------------------------------------------
+
+/// \cond
+
+static_assert(EMERGENCY_POOL_BLOCKS <= 64, "EMERGENCY_POOL_BLOCKS must fit in a 64bit bitmap");
+
+struct emergency_pool_bitmap
+{
+    uint64_t used;
+} __attribute__((aligned(cache_line_size)));
+
+uint8_t g_emergency_pool_owner[MAX_EMERGENCY_POOLS][EMERGENCY_POOL_BLOCKS][EMERGENCY_POOL_BLOCK_SIZE] __attribute__((aligned(cache_line_size))) = {};
+emergency_pool_bitmap g_emergency_pool_bitmaps[MAX_EMERGENCY_POOLS] = {};
+
+uint64_t g_emergency_pool_allocs = 0;
+uint64_t g_emergency_pool_exhausted = 0;
+
+constexpr const auto g_emergency_pool_full = ~0ULL >> (64 - EMERGENCY_POOL_BLOCKS);
+
+static bool
+emergency_pool_contains(uintptr_t ptr) noexcept
+{
+    auto base = reinterpret_cast<uintptr_t>(g_emergency_pool_owner);
+    return ptr >= base && ptr < base + sizeof(g_emergency_pool_owner);
+}
+
+static void *
+emergency_pool_alloc(size_t size) noexcept
+{
+    if (size > EMERGENCY_POOL_BLOCK_SIZE)
+        return nullptr;
+
+    auto cpu = thread_context_cpuid() % MAX_EMERGENCY_POOLS;
+    auto &&bitmap = g_emergency_pool_bitmaps[cpu].used;
+    auto used = __atomic_load_n(&bitmap, __ATOMIC_RELAXED);
+
+    while (used != g_emergency_pool_full)
+    {
+        auto block = static_cast<uint64_t>(__builtin_ctzll(~used));
+
+        if (__atomic_compare_exchange_n(&bitmap, &used, used | (1ULL << block), true,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            __atomic_add_fetch(&g_emergency_pool_allocs, 1, __ATOMIC_RELAXED);
+            return g_emergency_pool_owner[cpu][block];
+        }
+    }
+
+    __atomic_add_fetch(&g_emergency_pool_exhausted, 1, __ATOMIC_RELAXED);
+    return nullptr;
+}
+
+static void
+emergency_pool_free(uintptr_t ptr) noexcept
+{
+    auto offset = ptr - reinterpret_cast<uintptr_t>(g_emergency_pool_owner);
+
+    if ((offset % EMERGENCY_POOL_BLOCK_SIZE) != 0)
+        return;
+
+    auto index = offset / EMERGENCY_POOL_BLOCK_SIZE;
+    auto &&bitmap = g_emergency_pool_bitmaps[index / EMERGENCY_POOL_BLOCKS].used;
+
+    __atomic_and_fetch(&bitmap, ~(1ULL << (index % EMERGENCY_POOL_BLOCKS)), __ATOMIC_RELEASE);
+}
+
+/// \endcond
+
+// -----------------------------------------------------------------------------
+// Heap Profiler
+// -----------------------------------------------------------------------------
+
+/// \cond
+
+// The heap profiler tracks live allocations in an open addressing hash
+// table, keyed by address, that is statically allocated so that tracking
+// an allocation never allocates memory itself. Entries are removed using
+// backward shift deletion, so no tombstones are needed.
+
+static_assert((HEAP_PROFILER_ENTRIES & (HEAP_PROFILER_ENTRIES - 1)) == 0, "HEAP_PROFILER_ENTRIES must be a power of 2");
+static_assert((HEAP_PROFILER_SITES & (HEAP_PROFILER_SITES - 1)) == 0, "HEAP_PROFILER_SITES must be a power of 2");
+
+struct heap_profiler_entry
+{
+    uintptr_t ptr;
+    uintptr_t caller;
+    uint64_t size;
+    uint64_t cpuid;
+};
+
+heap_profiler_entry g_heap_profiler_entries[HEAP_PROFILER_ENTRIES] = {};
+vmcall_heap_site_t g_heap_profiler_sites[HEAP_PROFILER_SITES] = {};
+
+bool g_heap_profiler_running = false;
+uint64_t g_heap_profiler_num = 0;
+uint64_t g_heap_profiler_dropped = 0;
+
+spinlock g_heap_profiler_lock("mm_heap_profiler");
+
+static uint64_t
+heap_profiler_hash(uintptr_t key, uint64_t num) noexcept
+{ return ((key >> 4) * 0x9E3779B97F4A7C15ULL >> 32) & (num - 1); }
+
+static bool
+heap_profiler_enabled() noexcept
+{ return __builtin_expect(__atomic_load_n(&g_heap_profiler_running, __ATOMIC_RELAXED), false); }
+
+static void
+heap_profiler_track(uintptr_t ptr, uint64_t size, uintptr_t caller) noexcept
+{
+    std::lock_guard<spinlock> guard(g_heap_profiler_lock);
+
+    auto index = heap_profiler_hash(ptr, HEAP_PROFILER_ENTRIES);
+
+    while (g_heap_profiler_entries[index].ptr != 0 && g_heap_profiler_entries[index].ptr != ptr)
+        index = (index + 1) & (HEAP_PROFILER_ENTRIES - 1);
+
+    auto &&entry = g_heap_profiler_entries[index];
+
+    if (entry.ptr == 0)
+    {
+        if (g_heap_profiler_num >= (HEAP_PROFILER_ENTRIES / 4) * 3)
+        {
+            g_heap_profiler_dropped++;
+            return;
+        }
+
+        g_heap_profiler_num++;
+    }
+
+    entry = {ptr, caller, size, thread_context_cpuid()};
+}
+
+static void
+heap_profiler_untrack(uintptr_t ptr) noexcept
+{
+    std::lock_guard<spinlock> guard(g_heap_profiler_lock);
+
+    constexpr const auto mask = HEAP_PROFILER_ENTRIES - 1;
+    auto index = heap_profiler_hash(ptr, HEAP_PROFILER_ENTRIES);
+
+    while (g_heap_profiler_entries[index].ptr != ptr)
+    {
+        if (g_heap_profiler_entries[index].ptr == 0)
+            return;
+
+        index = (index + 1) & mask;
+    }
+
+    g_heap_profiler_num--;
+
+    // Shift back each of the entries that follow, that would otherwise no
+    // longer be reachable from their home slot
+
+    for (auto next = (index + 1) & mask; g_heap_profiler_entries[next].ptr != 0; next = (next + 1) & mask)
+    {
+        auto home = heap_profiler_hash(g_heap_profiler_entries[next].ptr, HEAP_PROFILER_ENTRIES);
+
+        if (((next - home) & mask) >= ((next - index) & mask))
+        {
+            g_heap_profiler_entries[index] = g_heap_profiler_entries[next];
+            index = next;
+        }
+    }
+
+    g_heap_profiler_entries[index] = {};
+}
+
+static vmcall_heap_site_t &
+heap_profiler_site(uintptr_t caller, uint64_t &num_sites) noexcept
+{
+    constexpr const auto mask = HEAP_PROFILER_SITES - 1;
+    auto index = heap_profiler_hash(caller, HEAP_PROFILER_SITES);
+
+    while (g_heap_profiler_sites[index].count != 0 && g_heap_profiler_sites[index].caller != caller)
+        index = (index + 1) & mask;
+
+    auto &&site = g_heap_profiler_sites[index];
+
+    if (site.count != 0)
+        return site;
+
+    // One entry is always left free, so that once the table is full, the
+    // remaining call sites can be reported together, as a call site of 0
+
+    if (caller != 0 && num_sites == HEAP_PROFILER_SITES - 1)
+        return heap_profiler_site(0, num_sites);
+
+    num_sites++;
+
+    site.caller = caller;
+    return site;
+}
+
+/// \endcond
+
+// -----------------------------------------------------------------------------
+// Locks
+// -----------------------------------------------------------------------------
+
+rw_spinlock g_add_md_lock("mm_add_md");
 
 // -----------------------------------------------------------------------------
 // Implementation
@@ -69,21 +460,31 @@ memory_manager_x64::instance() noexcept
 
 memory_manager_x64::pointer
 memory_manager_x64::alloc(size_type size) noexcept
+{ return this->alloc(size, reinterpret_cast<integer_pointer>(__builtin_return_address(0))); }
+
+memory_manager_x64::pointer
+memory_manager_x64::alloc(size_type size, integer_pointer caller) noexcept
 {
     if (size == 0)
         return nullptr;
 
-    try
-    {
-        if (lower(size) == 0)
-            return reinterpret_cast<pointer>(g_page_pool.alloc(size));
+    auto &&addr = lower(size) == 0 ?
+                  page_arena_alloc(size) :
+                  arena_list_alloc(g_heap_arenas, size);
 
-        return reinterpret_cast<pointer>(g_heap_pool.alloc(size));
-    }
-    catch (...)
-    { }
+    if (heap_profiler_enabled() && addr != 0)
+        heap_profiler_track(addr, size, caller);
 
-    return nullptr;
+    return reinterpret_cast<pointer>(addr);
+}
+
+memory_manager_x64::pointer
+memory_manager_x64::alloc_exception(size_type size) noexcept
+{
+    if (auto ptr = emergency_pool_alloc(size))
+        return ptr;
+
+    return this->alloc(size, reinterpret_cast<integer_pointer>(__builtin_return_address(0)));
 }
 
 memory_manager_x64::pointer
@@ -107,11 +508,17 @@ memory_manager_x64::free(pointer ptr) noexcept
 {
     auto uintptr = reinterpret_cast<integer_pointer>(ptr);
 
-    if (g_heap_pool.contains(uintptr))
-        return g_heap_pool.free(uintptr);
+    if (heap_profiler_enabled() && uintptr != 0)
+        heap_profiler_untrack(uintptr);
+
+    if (auto arena = arena_find(g_heap_arenas, uintptr))
+        return arena->free(uintptr);
+
+    if (auto arena = page_arena_find(uintptr))
+        return arena->free(uintptr);
 
-    if (g_page_pool.contains(uintptr))
-        return g_page_pool.free(uintptr);
+    if (emergency_pool_contains(uintptr))
+        return emergency_pool_free(uintptr);
 }
 
 void
@@ -128,15 +535,239 @@ memory_manager_x64::size(pointer ptr) const noexcept
 {
     auto uintptr = reinterpret_cast<integer_pointer>(ptr);
 
-    if (g_heap_pool.contains(uintptr))
-        return g_heap_pool.size(uintptr);
+    if (auto arena = arena_find(g_heap_arenas, uintptr))
+        return arena->size(uintptr);
 
-    if (g_page_pool.contains(uintptr))
-        return g_page_pool.size(uintptr);
+    if (auto arena = page_arena_find(uintptr))
+        return arena->size(uintptr);
+
+    if (emergency_pool_contains(uintptr))
+        return EMERGENCY_POOL_BLOCK_SIZE;
 
     return 0;
 }
 
+memory_manager_x64::pointer
+memory_manager_x64::realloc(pointer ptr, size_type size) noexcept
+{ return this->realloc(ptr, size, reinterpret_cast<integer_pointer>(__builtin_return_address(0))); }
+
+memory_manager_x64::pointer
+memory_manager_x64::realloc(pointer ptr, size_type size, integer_pointer caller) noexcept
+{
+    auto &&new_ptr = this->resize(ptr, size);
+
+    // The allocation was either resized in place, or made by alloc() on
+    // behalf of the caller, so in both cases, record the caller instead
+
+    if (heap_profiler_enabled() && new_ptr != nullptr)
+        heap_profiler_track(reinterpret_cast<integer_pointer>(new_ptr), size, caller);
+
+    return new_ptr;
+}
+
+memory_manager_x64::pointer
+memory_manager_x64::resize(pointer ptr, size_type size) noexcept
+{
+    if (ptr == nullptr)
+        return this->alloc(size);
+
+    if (size == 0)
+    {
+        this->free(ptr);
+        return nullptr;
+    }
+
+    auto uintptr = reinterpret_cast<integer_pointer>(ptr);
+
+    if (auto heap_arena = arena_find(g_heap_arenas, uintptr))
+    {
+        if (heap_arena->resize(uintptr, size))
+            return ptr;
+    }
+    else if (auto page_arena = page_arena_find(uintptr))
+    {
+        if (page_arena->resize(uintptr, size))
+            return ptr;
+    }
+    else if (emergency_pool_contains(uintptr))
+    {
+        if (size <= EMERGENCY_POOL_BLOCK_SIZE)
+            return ptr;
+    }
+    else
+    {
+        return nullptr;
+    }
+
+    auto old_size = this->size(ptr);
+    if (old_size == 0)
+        return nullptr;
+
+    auto new_ptr = this->alloc(size);
+    if (new_ptr == nullptr)
+        return nullptr;
+
+    x64::mem::copy(new_ptr, ptr, size > old_size ? old_size : size);
+    this->free(ptr);
+
+    return new_ptr;
+}
+
+memory_manager_x64::size_type
+memory_manager_x64::emergency_allocs() const noexcept
+{ return __atomic_load_n(&g_emergency_pool_allocs, __ATOMIC_RELAXED); }
+
+memory_manager_x64::size_type
+memory_manager_x64::emergency_exhausted() const noexcept
+{ return __atomic_load_n(&g_emergency_pool_exhausted, __ATOMIC_RELAXED); }
+
+void
+memory_manager_x64::add_chunk(integer_pointer virt, size_type size, chunk_type type, node_type node)
+{
+    expects(virt != 0);
+    expects(lower(virt) == 0);
+    expects(size != 0);
+
+    std::lock_guard<spinlock> guard(g_arena_lock);
+
+    switch (type)
+    {
+        case MEMORY_CHUNK_HEAP:
+            if (!arena_add(g_heap_arenas, virt, size))
+                throw std::runtime_error("unable to add heap arena");
+            break;
+
+        case MEMORY_CHUNK_PAGE:
+            if (!arena_add(node < MAX_NUMA_NODES ? g_node_page_arenas[node] : g_page_arenas, virt, size))
+                throw std::runtime_error("unable to add page arena");
+            break;
+
+        case MEMORY_CHUNK_RESERVE:
+            if (g_num_reserve_chunks >= MAX_MEM_ARENAS)
+                throw std::runtime_error("too many reserve chunks");
+
+            if (heap_arena_type::usable_size(size) == 0 || page_arena_type::usable_size(size) == 0)
+                throw std::runtime_error("reserve chunk is too small");
+
+            g_reserve_chunks[g_num_reserve_chunks++] = {virt, size, type, node};
+            break;
+
+        default:
+            throw std::logic_error("unsupported memory chunk type");
+    }
+}
+
+memory_manager_x64::arena_stats_list
+memory_manager_x64::arena_stats() const
+{
+    arena_stats_list stats;
+
+    arena_list_stats(g_heap_arenas, MEMORY_CHUNK_HEAP, MEMORY_CHUNK_ANY_NODE, stats);
+    arena_list_stats(g_page_arenas, MEMORY_CHUNK_PAGE, MEMORY_CHUNK_ANY_NODE, stats);
+
+    for (auto node = 0ULL; node < MAX_NUMA_NODES; node++)
+        arena_list_stats(g_node_page_arenas[node], MEMORY_CHUNK_PAGE, node, stats);
+
+    // Growing the list allocates, and an allocation might need to turn a
+    // reserve chunk into a new arena (which takes g_arena_lock), so the
+    // reserve chunks are copied while holding the lock, and the list is
+    // only grown once the lock has been released
+
+    memory_chunk chunks[MAX_MEM_ARENAS];
+    auto num_chunks = 0ULL;
+
+    {
+        std::lock_guard<spinlock> guard(g_arena_lock);
+
+        for (; num_chunks < g_num_reserve_chunks; num_chunks++)
+            chunks[num_chunks] = g_reserve_chunks[num_chunks];
+    }
+
+    for (auto i = 0ULL; i < num_chunks; i++)
+    {
+        arena_stats_type reserve = {};
+
+        reserve.type = MEMORY_CHUNK_RESERVE;
+        reserve.node = MEMORY_CHUNK_ANY_NODE;
+        reserve.addr = chunks[i].virt;
+        reserve.size = chunks[i].size;
+
+        stats.push_back(reserve);
+    }
+
+    stats.push_back(arena_stats_of(&g_mem_map_pool, MEMORY_CHUNK_MAP));
+    return stats;
+}
+
+void
+memory_manager_x64::heap_profiler_start() noexcept
+{
+    std::lock_guard<spinlock> guard(g_heap_profiler_lock);
+
+    __builtin_memset(g_heap_profiler_entries, 0, sizeof(g_heap_profiler_entries));
+
+    g_heap_profiler_num = 0;
+    g_heap_profiler_dropped = 0;
+
+    __atomic_store_n(&g_heap_profiler_running, true, __ATOMIC_RELAXED);
+}
+
+void
+memory_manager_x64::heap_profiler_stop() noexcept
+{ __atomic_store_n(&g_heap_profiler_running, false, __ATOMIC_RELAXED); }
+
+bool
+memory_manager_x64::heap_profiler_running() const noexcept
+{ return __atomic_load_n(&g_heap_profiler_running, __ATOMIC_RELAXED); }
+
+memory_manager_x64::size_type
+memory_manager_x64::heap_profiler_collect(gsl::span<vmcall_heap_site_t> sites) const noexcept
+{
+    std::lock_guard<spinlock> guard(g_heap_profiler_lock);
+
+    __builtin_memset(g_heap_profiler_sites, 0, sizeof(g_heap_profiler_sites));
+
+    uint64_t num_sites = 0;
+
+    for (const auto &entry : g_heap_profiler_entries)
+    {
+        if (entry.ptr == 0)
+            continue;
+
+        auto &&site = heap_profiler_site(entry.caller, num_sites);
+
+        site.count++;
+        site.bytes += entry.size;
+        site.cpus |= 1ULL << (entry.cpuid % 64);
+    }
+
+    auto &&begin = std::begin(g_heap_profiler_sites);
+    auto &&end = std::remove_if(begin, std::end(g_heap_profiler_sites), [](const auto & site)
+    { return site.count == 0; });
+
+    std::sort(begin, end, [](const auto & a, const auto & b)
+    { return a.bytes > b.bytes; });
+
+    auto num = std::min(static_cast<size_type>(end - begin), static_cast<size_type>(sites.size()));
+    std::copy(begin, begin + num, sites.begin());
+
+    return num;
+}
+
+memory_manager_x64::size_type
+memory_manager_x64::heap_profiler_allocs() const noexcept
+{
+    std::lock_guard<spinlock> guard(g_heap_profiler_lock);
+    return g_heap_profiler_num;
+}
+
+memory_manager_x64::size_type
+memory_manager_x64::heap_profiler_dropped() const noexcept
+{
+    std::lock_guard<spinlock> guard(g_heap_profiler_lock);
+    return g_heap_profiler_dropped;
+}
+
 memory_manager_x64::size_type
 memory_manager_x64::size_map(pointer ptr) const noexcept
 {
@@ -154,8 +785,13 @@ memory_manager_x64::virtint_to_physint(integer_pointer virt) const
     // [[ensures ret: ret != 0]]
     expects(virt != 0);
 
-    std::lock_guard<std::mutex> guard(g_add_md_mutex);
-    return upper(m_virt_to_phys_map.at(upper(virt))) | lower(virt);
+    std::shared_lock<rw_spinlock> guard(g_add_md_lock);
+
+    auto &&iter = m_virt_to_phys_map.find(upper(virt));
+    if (iter != m_virt_to_phys_map.end())
+        return upper(iter->second) | lower(virt);
+
+    return m_virt_to_phys_map_2m.at(upper_2m(virt)) | lower_2m(virt);
 }
 
 memory_manager_x64::integer_pointer
@@ -176,8 +812,13 @@ memory_manager_x64::physint_to_virtint(integer_pointer phys) const
     // [[ensures ret: ret != 0]]
     expects(phys != 0);
 
-    std::lock_guard<std::mutex> guard(g_add_md_mutex);
-    return upper(m_phys_to_virt_map.at(upper(phys))) | lower(phys);
+    std::shared_lock<rw_spinlock> guard(g_add_md_lock);
+
+    auto &&iter = m_phys_to_virt_map.find(upper(phys));
+    if (iter != m_phys_to_virt_map.end())
+        return upper(iter->second) | lower(phys);
+
+    return m_phys_to_virt_map_2m.at(upper_2m(phys)) | lower_2m(phys);
 }
 
 memory_manager_x64::integer_pointer
@@ -197,8 +838,13 @@ memory_manager_x64::virtint_to_attrint(integer_pointer virt) const
 {
     expects(virt != 0);
 
-    std::lock_guard<std::mutex> guard(g_add_md_mutex);
-    return m_virt_to_attr_map.at(upper(virt));
+    std::shared_lock<rw_spinlock> guard(g_add_md_lock);
+
+    auto &&iter = m_virt_to_attr_map.find(upper(virt));
+    if (iter != m_virt_to_attr_map.end())
+        return iter->second;
+
+    return m_virt_to_attr_map_2m.at(upper_2m(virt));
 }
 
 memory_manager_x64::attr_type
@@ -210,7 +856,7 @@ memory_manager_x64::add_md(integer_pointer virt, integer_pointer phys, attr_type
 {
     auto ___ = gsl::on_failure([&]
     {
-        std::lock_guard<std::mutex> guard(g_add_md_mutex);
+        std::lock_guard<rw_spinlock> guard(g_add_md_lock);
 
         m_virt_to_phys_map.erase(virt);
         m_phys_to_virt_map.erase(phys);
@@ -222,7 +868,7 @@ memory_manager_x64::add_md(integer_pointer virt, integer_pointer phys, attr_type
     expects(lower(phys) == 0);
 
     {
-        std::lock_guard<std::mutex> guard(g_add_md_mutex);
+        std::lock_guard<rw_spinlock> guard(g_add_md_lock);
 
         m_virt_to_phys_map[virt] = phys;
         m_phys_to_virt_map[phys] = virt;
@@ -231,10 +877,33 @@ memory_manager_x64::add_md(integer_pointer virt, integer_pointer phys, attr_type
 }
 
 void
-memory_manager_x64::remove_md(integer_pointer virt) noexcept
+memory_manager_x64::add_md_2m(integer_pointer virt, integer_pointer phys, attr_type attr)
 {
-    integer_pointer phys;
+    auto ___ = gsl::on_failure([&]
+    {
+        std::lock_guard<rw_spinlock> guard(g_add_md_lock);
+
+        m_virt_to_phys_map_2m.erase(virt);
+        m_phys_to_virt_map_2m.erase(phys);
+        m_virt_to_attr_map_2m.erase(virt);
+    });
+
+    expects(attr != 0);
+    expects(lower_2m(virt) == 0);
+    expects(lower_2m(phys) == 0);
 
+    {
+        std::lock_guard<rw_spinlock> guard(g_add_md_lock);
+
+        m_virt_to_phys_map_2m[virt] = phys;
+        m_phys_to_virt_map_2m[phys] = virt;
+        m_virt_to_attr_map_2m[virt] = attr;
+    }
+}
+
+void
+memory_manager_x64::remove_md(integer_pointer virt) noexcept
+{
     if (virt == 0)
     {
         bferror << "remove_md: virt == 0" << bfendl;
@@ -249,12 +918,23 @@ memory_manager_x64::remove_md(integer_pointer virt) noexcept
 
     guard_exceptions([&]
     {
-        phys = virtint_to_physint(virt);
-        std::lock_guard<std::mutex> guard(g_add_md_mutex);
+        std::lock_guard<rw_spinlock> guard(g_add_md_lock);
 
-        m_virt_to_phys_map.erase(virt);
-        m_phys_to_virt_map.erase(phys);
-        m_virt_to_attr_map.erase(virt);
+        auto &&iter = m_virt_to_phys_map.find(virt);
+        if (iter != m_virt_to_phys_map.end())
+        {
+            m_phys_to_virt_map.erase(iter->second);
+            m_virt_to_attr_map.erase(virt);
+            m_virt_to_phys_map.erase(iter);
+
+            return;
+        }
+
+        auto &&phys = m_virt_to_phys_map_2m.at(virt);
+
+        m_phys_to_virt_map_2m.erase(phys);
+        m_virt_to_attr_map_2m.erase(virt);
+        m_virt_to_phys_map_2m.erase(virt);
     });
 }
 
@@ -262,7 +942,7 @@ memory_manager_x64::memory_descriptor_list
 memory_manager_x64::descriptors() const
 {
     memory_descriptor_list list;
-    std::lock_guard<std::mutex> guard(g_add_md_mutex);
+    std::shared_lock<rw_spinlock> guard(g_add_md_lock);
 
     for (const auto &p : m_virt_to_phys_map)
     {
@@ -270,7 +950,16 @@ memory_manager_x64::descriptors() const
         auto phys = p.second;
         auto attr = m_virt_to_attr_map.at(virt);
 
-        list.push_back({phys, virt, attr});
+        list.push_back({phys, virt, attr, page_size});
+    }
+
+    for (const auto &p : m_virt_to_phys_map_2m)
+    {
+        auto virt = p.first;
+        auto phys = p.second;
+        auto attr = m_virt_to_attr_map_2m.at(virt);
+
+        list.push_back({phys, virt, attr, LARGE_PAGE_SIZE});
     }
 
     return list;
@@ -284,6 +973,14 @@ memory_manager_x64::integer_pointer
 memory_manager_x64::upper(integer_pointer ptr) const noexcept
 { return ptr & ~(page_size - 1); }
 
+memory_manager_x64::integer_pointer
+memory_manager_x64::lower_2m(integer_pointer ptr) const noexcept
+{ return ptr & (LARGE_PAGE_SIZE - 1); }
+
+memory_manager_x64::integer_pointer
+memory_manager_x64::upper_2m(integer_pointer ptr) const noexcept
+{ return ptr & ~(LARGE_PAGE_SIZE - 1); }
+
 extern "C" int64_t
 add_md(struct memory_descriptor *md) noexcept
 {
@@ -295,15 +992,119 @@ add_md(struct memory_descriptor *md) noexcept
         auto &&phys = reinterpret_cast<memory_manager_x64::integer_pointer>(md->phys);
         auto &&type = reinterpret_cast<memory_manager_x64::attr_type>(md->type);
 
-        g_mm->add_md(virt, phys, type);
+        switch (md->size)
+        {
+            case MAX_PAGE_SIZE:
+                g_mm->add_md(virt, phys, type);
+                break;
+
+            case LARGE_PAGE_SIZE:
+                g_mm->add_md_2m(virt, phys, type);
+                break;
+
+            default:
+                throw std::logic_error("unsupported memory descriptor size");
+        }
+    });
+}
+
+extern "C" int64_t
+add_mem_chunk(struct memory_chunk *chunk) noexcept
+{
+    return guard_exceptions(MEMORY_MANAGER_FAILURE, [&]
+    {
+        expects(chunk);
+        g_mm->add_chunk(chunk->virt, chunk->size, chunk->type, chunk->node);
     });
 }
 
 #ifdef CROSS_COMPILED
 
+// libc++abi allocates exceptions using malloc(), so the VMM's modules are
+// linked with --wrap=__cxa_allocate_exception, and while the wrapper is
+// running on a CPU, that CPU's allocations are exception allocations (see
+// memory_manager_x64::alloc_exception). Exceptions are freed using free(),
+// which already knows about the emergency pools.
+//
+// Each CPU has its own counter, which only that CPU modifies, so the
+// counters do not have to be atomic. CPUs past MAX_EMERGENCY_POOLS do not
+// have a counter (they would share one with another CPU), and allocate
+// their exceptions from the heap.
+
+struct cxa_allocating_exception_counter
+{
+    uint64_t count;
+} __attribute__((aligned(cache_line_size)));
+
+cxa_allocating_exception_counter g_cxa_allocating_exception[MAX_EMERGENCY_POOLS] = {};
+
+static uint64_t *
+cxa_allocating_exception() noexcept
+{
+    auto &&cpuid = thread_context_cpuid();
+
+    if (cpuid >= MAX_EMERGENCY_POOLS)
+        return nullptr;
+
+    return &g_cxa_allocating_exception[cpuid].count;
+}
+
+extern "C" void *__real___cxa_allocate_exception(size_t size) noexcept;
+
+extern "C" void *
+__wrap___cxa_allocate_exception(size_t size) noexcept
+{
+    auto &&allocating = cxa_allocating_exception();
+
+    if (allocating == nullptr)
+        return __real___cxa_allocate_exception(size);
+
+    (*allocating)++;
+    auto &&ptr = __real___cxa_allocate_exception(size);
+    (*allocating)--;
+
+    return ptr;
+}
+
+// The heap profiler records the return address of the entry point into
+// the allocator as the call site. newlib's malloc(), calloc() and realloc()
+// tail call the functions below, so their return address is the code that
+// called malloc(). libc++'s operator new calls malloc() itself, so the
+// VMM's modules are also linked with --wrap=_Znwm and --wrap=_Znam, and the
+// wrappers below record the code that called new instead. If the heap is
+// exhausted, libc++'s operator new is used, which throws std::bad_alloc.
+
+extern "C" void *__real__Znwm(size_t size);
+extern "C" void *__real__Znam(size_t size);
+
+extern "C" void *
+__wrap__Znwm(size_t size)
+{
+    if (auto ptr = g_mm->alloc(size, reinterpret_cast<uintptr_t>(__builtin_return_address(0))))
+        return ptr;
+
+    return __real__Znwm(size);
+}
+
+extern "C" void *
+__wrap__Znam(size_t size)
+{
+    if (auto ptr = g_mm->alloc(size, reinterpret_cast<uintptr_t>(__builtin_return_address(0))))
+        return ptr;
+
+    return __real__Znam(size);
+}
+
 extern "C" void *
 _malloc_r(struct _reent *, size_t size)
-{ return g_mm->alloc(size); }
+{
+    auto &&allocating = cxa_allocating_exception();
+
+    if (allocating != nullptr && *allocating != 0)
+        return g_mm->alloc_exception(size);
+
+    return g_mm->alloc(size, reinterpret_cast<uintptr_t>(__builtin_return_address(0)));
+}
 
 extern "C" void
 _free_r(struct _reent *, void *ptr)
@@ -312,28 +1113,14 @@ _free_r(struct _reent *, void *ptr)
 extern "C" void *
 _calloc_r(struct _reent *, size_t nmemb, size_t size)
 {
-    if (auto ptr = g_mm->alloc(nmemb * size))
-        return __builtin_memset(ptr, 0, nmemb * size);
+    if (auto ptr = g_mm->alloc(nmemb * size, reinterpret_cast<uintptr_t>(__builtin_return_address(0))))
+        return x64::mem::set(ptr, 0, nmemb * size);
 
     return nullptr;
 }
 
 extern "C" void *
 _realloc_r(struct _reent *, void *ptr, size_t size)
-{
-    auto old_sze = g_mm->size(ptr);
-    auto new_ptr = g_mm->alloc(size);
-
-    if (!new_ptr || old_sze == 0)
-        return nullptr;
-
-    if (ptr)
-    {
-        __builtin_memcpy(new_ptr, ptr, size > old_sze ? old_sze : size);
-        g_mm->free(ptr);
-    }
-
-    return new_ptr;
-}
+{ return g_mm->realloc(ptr, size, reinterpret_cast<uintptr_t>(__builtin_return_address(0))); }
 
 #endif
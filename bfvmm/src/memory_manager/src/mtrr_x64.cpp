@@ -0,0 +1,211 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#include <algorithm>
+
+#include <debug.h>
+#include <memory_manager/mtrr_x64.h>
+
+#include <intrinsics/x64.h>
+#include <intrinsics/msrs_x64.h>
+
+using namespace x64;
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+// The fixed range MTRRs cover the first megabyte of physical memory using
+// 88 ranges, each MSR describing 8 of them (one byte per range):
+//
+// - 8 x 64k ranges from 0x00000 to 0x7FFFF (ia32_mtrr_fix64k_00000)
+// - 16 x 16k ranges from 0x80000 to 0xBFFFF (ia32_mtrr_fix16k_80000/a0000)
+// - 64 x 4k ranges from 0xC0000 to 0xFFFFF (ia32_mtrr_fix4k_c0000-f8000)
+//
+
+constexpr const auto fixed_16k_start = 0x80000UL;
+constexpr const auto fixed_4k_start = 0xC0000UL;
+constexpr const auto fixed_end = 0x100000UL;
+
+constexpr const auto fixed_16k_index = 8UL;
+constexpr const auto fixed_4k_index = 24UL;
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+mtrr_x64::mtrr_x64() :
+    m_enabled(false),
+    m_fixed_enabled(false),
+    m_default_type(memory_type::uncacheable),
+    m_fixed{}
+{
+    auto &&cap = msrs::ia32_mtrrcap::get();
+    auto &&def = msrs::ia32_mtrr_def_type::get();
+
+    m_enabled = msrs::ia32_mtrr_def_type::mtrr_enable::get(def);
+    m_default_type = msrs::ia32_mtrr_def_type::type::get(def);
+
+    if (!m_enabled)
+        return;
+
+    auto &&phys_bits = cpuid::addr_size::phys::get();
+    auto &&phys_mask = (1ULL << phys_bits) - 1;
+
+    for (auto i = 0UL; i < msrs::ia32_mtrrcap::vcnt::get(cap); i++)
+    {
+        auto &&base = msrs::ia32_mtrr_physbase::get(i);
+        auto &&mask = msrs::ia32_mtrr_physmask::get(i);
+
+        if (!msrs::ia32_mtrr_physmask::valid::get(mask))
+            continue;
+
+        range_type range;
+        range.mask = msrs::ia32_mtrr_physmask::physmask::get(mask);
+        range.base = msrs::ia32_mtrr_physbase::physbase::get(base) & range.mask;
+        range.size = (~range.mask & phys_mask) + 1;
+        range.type = msrs::ia32_mtrr_physbase::type::get(base);
+
+        m_ranges.push_back(range);
+
+        m_boundaries.push_back(range.base);
+        m_boundaries.push_back(range.base + range.size);
+    }
+
+    if (msrs::ia32_mtrrcap::fixed_range_support::get(cap) &&
+        msrs::ia32_mtrr_def_type::fixed_range_enable::get(def))
+    {
+        m_fixed_enabled = true;
+
+        auto &&fill = [&](auto index, auto val)
+        {
+            for (auto i = 0UL; i < 8; i++)
+                m_fixed.at(index + i) = (val >> (i * 8)) & 0xFFUL;
+        };
+
+        fill(0UL, msrs::ia32_mtrr_fix64k_00000::get());
+        fill(fixed_16k_index, msrs::ia32_mtrr_fix16k_80000::get());
+        fill(fixed_16k_index + 8, msrs::ia32_mtrr_fix16k_a0000::get());
+
+        for (auto i = 0UL; i < 8; i++)
+            fill(fixed_4k_index + (i * 8), msrs::ia32_mtrr_fix4k::get(i));
+
+        for (auto addr = 0UL; addr < fixed_end; addr += x64::page_size)
+            m_boundaries.push_back(addr);
+
+        m_boundaries.push_back(fixed_end);
+    }
+
+    std::sort(m_boundaries.begin(), m_boundaries.end());
+    m_boundaries.erase(std::unique(m_boundaries.begin(), m_boundaries.end()), m_boundaries.end());
+}
+
+mtrr_x64::memory_type_type
+mtrr_x64::mem_type(integer_pointer addr) const noexcept
+{
+    if (!m_enabled)
+        return memory_type::uncacheable;
+
+    if (m_fixed_enabled && addr < fixed_end)
+        return fixed_type(addr);
+
+    auto found = false;
+    auto type = m_default_type;
+
+    for (const auto &range : m_ranges)
+    {
+        if ((addr & range.mask) != range.base)
+            continue;
+
+        if (range.type == memory_type::uncacheable)
+            return memory_type::uncacheable;
+
+        if (!found || type == range.type)
+        {
+            type = range.type;
+            found = true;
+
+            continue;
+        }
+
+        if ((type == memory_type::write_through && range.type == memory_type::write_back) ||
+            (type == memory_type::write_back && range.type == memory_type::write_through))
+        {
+            type = memory_type::write_through;
+            continue;
+        }
+
+        return memory_type::uncacheable;
+    }
+
+    return type;
+}
+
+bool
+mtrr_x64::uniform(integer_pointer addr, size_type size) const
+{
+    expects(size != 0);
+
+    // The memory type can only change at a boundary (the start or end of a
+    // variable range, or a fixed range), so a range is uniform if the
+    // memory type at each boundary inside the range matches the memory
+    // type at the start of the range.
+
+    auto &&type = mem_type(addr);
+    auto &&iter = std::upper_bound(m_boundaries.begin(), m_boundaries.end(), addr);
+
+    for (; iter != m_boundaries.end() && *iter - addr < size; ++iter)
+    {
+        if (mem_type(*iter) != type)
+            return false;
+    }
+
+    return true;
+}
+
+void
+mtrr_x64::dump() const
+{
+    bfdebug << "mtrrs:" << bfendl;
+    bfdebug << "    - enabled: " << (m_enabled ? "true" : "false") << bfendl;
+    bfdebug << "    - fixed enabled: " << (m_fixed_enabled ? "true" : "false") << bfendl;
+    bfdebug << "    - default type: " << view_as_pointer(m_default_type) << bfendl;
+
+    for (const auto &range : m_ranges)
+    {
+        bfdebug << "    - range: " << view_as_pointer(range.base)
+                << " - " << view_as_pointer(range.base + range.size)
+                << ", type: " << view_as_pointer(range.type) << bfendl;
+    }
+}
+
+mtrr_x64::memory_type_type
+mtrr_x64::fixed_type(integer_pointer addr) const noexcept
+{
+    if (addr < fixed_16k_start)
+        return m_fixed[addr >> 16];
+
+    if (addr < fixed_4k_start)
+        return m_fixed[fixed_16k_index + ((addr - fixed_16k_start) >> 14)];
+
+    return m_fixed[fixed_4k_index + ((addr - fixed_4k_start) >> 12)];
+}
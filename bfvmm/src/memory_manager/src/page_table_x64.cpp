@@ -19,16 +19,28 @@
 // License along with this library; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
 
+#include <algorithm>
+
 #include <memory_manager/pat_x64.h>
 #include <memory_manager/page_table_x64.h>
 #include <memory_manager/memory_manager_x64.h>
 
 #include <intrinsics/x64.h>
+#include <intrinsics/mem_x64.h>
 using namespace x64;
 
-page_table_x64::page_table_x64(gsl::not_null<pointer> pte)
+template<class T, class I> static auto
+find_child(T &pts, I index)
+{
+    return std::lower_bound(pts.begin(), pts.end(), index,
+    [](const auto &child, auto idx) { return child.index < idx; });
+}
+
+page_table_x64::page_table_x64(gsl::not_null<pointer> pte) :
+    m_size(0)
 {
-    m_pt = std::make_unique<integer_pointer[]>(page_table::num_entries);
+    m_pt = std::unique_ptr<integer_pointer[]>(new integer_pointer[page_table::num_entries]);
+    mem::set(m_pt.get(), 0, page_table::num_bytes);
 
     auto &&entry = page_table_entry_x64(pte);
     entry.clear();
@@ -38,6 +50,14 @@ page_table_x64::page_table_x64(gsl::not_null<pointer> pte)
     entry.set_pat_index_4k(pat::write_back_index);
 }
 
+// Note:
+//
+// page_table::index() masks the address with 0x1FF, so the index is always
+// smaller than page_table::num_entries. For this reason, the functions below
+// index m_pt directly instead of using a bounds checked view, as these
+// functions are executed on every map / unmap.
+//
+
 page_table_entry_x64
 page_table_x64::add_page(integer_pointer addr, integer_pointer bits, integer_pointer end)
 {
@@ -45,27 +65,17 @@ page_table_x64::add_page(integer_pointer addr, integer_pointer bits, integer_poi
 
     if (bits > end)
     {
-        if (m_pts.empty())
-            m_pts = std::vector<std::unique_ptr<page_table_x64>>(page_table::num_entries);
+        auto &&pt = find_pt(index);
+        if (pt == nullptr)
+            pt = add_pt(index);
 
-        auto &&iter = bfn::find(m_pts, index);
-        if (!(*iter))
-        {
-            auto &&view = gsl::make_span(m_pt, page_table::num_entries);
-            (*iter) = std::make_unique<page_table_x64>(&view.at(index));
-        }
-
-        return (*iter)->add_page(addr, bits - page_table::pt::size, end);
+        return pt->add_page(addr, bits - page_table::pt::size, end);
     }
 
-    if (!m_pts.empty())
-    {
-        m_pts.clear();
-        m_pts.shrink_to_fit();
-    }
+    remove_pt(index);
+    set_used(index);
 
-    auto &&view = gsl::make_span(m_pt, page_table::num_entries);
-    return page_table_entry_x64(&view.at(index));
+    return page_table_entry_x64(&m_pt[index]);
 }
 
 void
@@ -73,28 +83,19 @@ page_table_x64::remove_page(integer_pointer addr, integer_pointer bits)
 {
     auto &&index = page_table::index(addr, bits);
 
-    if (!m_pts.empty())
+    if (auto pt = find_pt(index))
     {
-        auto &&iter = bfn::find(m_pts, index);
-        if (auto pt = (*iter).get())
+        pt->remove_page(addr, bits - page_table::pt::size);
+        if (pt->empty())
         {
-            pt->remove_page(addr, bits - page_table::pt::size);
-            if (pt->empty())
-            {
-                (*iter) = nullptr;
-
-                auto &&view = gsl::make_span(m_pt, page_table::num_entries);
-                view.at(index) = 0;
-            }
+            remove_pt(index);
+            clear_used(index);
         }
-    }
-    else
-    {
-        auto &&view = gsl::make_span(m_pt, page_table::num_entries);
-        view.at(index) = 0;
 
         return;
     }
+
+    clear_used(index);
 }
 
 page_table_entry_x64
@@ -102,17 +103,13 @@ page_table_x64::virt_to_pte(integer_pointer addr, integer_pointer bits) const
 {
     auto &&index = page_table::index(addr, bits);
 
-    if (!m_pts.empty())
-    {
-        auto &&iter = bfn::cfind(m_pts, index);
-        if (auto pt = (*iter).get())
-            return pt->virt_to_pte(addr, bits - page_table::pt::size);
+    if (auto pt = find_pt(index))
+        return pt->virt_to_pte(addr, bits - page_table::pt::size);
 
+    if (!m_used[index])
         throw std::runtime_error("unable to locate pte. invalid address");
-    }
 
-    auto &&view = gsl::make_span(m_pt, page_table::num_entries);
-    return page_table_entry_x64(&view.at(index));
+    return page_table_entry_x64(&m_pt[index]);
 }
 
 page_table_x64::memory_descriptor_list
@@ -122,24 +119,74 @@ page_table_x64::pt_to_mdl(memory_descriptor_list &mdl) const
     auto &&phys = g_mm->virtint_to_physint(virt);
     auto &&type = MEMORY_TYPE_R | MEMORY_TYPE_W;
 
-    mdl.push_back({phys, virt, type});
+    mdl.push_back({phys, virt, type, x64::page_size});
 
-    for (const auto &pt : m_pts)
-        if (pt != nullptr) pt->pt_to_mdl(mdl);
+    for (const auto &child : m_pts)
+        child.pt->pt_to_mdl(mdl);
 
     return mdl;
 }
 
-bool
-page_table_x64::empty() const noexcept
+page_table_x64 *
+page_table_x64::find_pt(size_type index) const noexcept
 {
-    auto size = 0UL;
+    auto &&iter = find_child(m_pts, index);
+
+    if (iter == m_pts.end() || iter->index != index)
+        return nullptr;
+
+    return iter->pt.get();
+}
+
+page_table_x64 *
+page_table_x64::add_pt(size_type index)
+{
+    auto &&iter = find_child(m_pts, index);
 
-    auto &&view = gsl::make_span(m_pt, x64::page_table::num_entries);
-    for (auto element : view)
-        size += element != 0 ? 1U : 0U;
+    auto &&pt = std::make_unique<page_table_x64>(&m_pt[index]);
+    iter = m_pts.insert(iter, {index, std::move(pt)});
 
-    return size == 0;
+    set_used(index);
+    return iter->pt.get();
+}
+
+void
+page_table_x64::remove_pt(size_type index) noexcept
+{
+    if (m_pts.empty())
+        return;
+
+    auto &&iter = find_child(m_pts, index);
+
+    if (iter == m_pts.end() || iter->index != index)
+        return;
+
+    m_pts.erase(iter);
+
+    if (m_pts.empty())
+        m_pts.shrink_to_fit();
+}
+
+void
+page_table_x64::set_used(size_type index) noexcept
+{
+    if (m_used[index])
+        return;
+
+    m_used[index] = true;
+    m_size++;
+}
+
+void
+page_table_x64::clear_used(size_type index) noexcept
+{
+    m_pt[index] = 0;
+
+    if (!m_used[index])
+        return;
+
+    m_used[index] = false;
+    m_size--;
 }
 
 page_table_x64::size_type
@@ -147,23 +194,33 @@ page_table_x64::global_size() const noexcept
 {
     auto size = 0UL;
 
-    auto &&view = gsl::make_span(m_pt, x64::page_table::num_entries);
-    for (auto element : view)
-        size += element != 0 ? 1U : 0U;
+    for (auto i = 0UL; i < page_table::num_entries; i++)
+        size += m_pt[i] != 0 ? 1U : 0U;
+
+    for (const auto &child : m_pts)
+        size += child.pt->global_size();
+
+    return size;
+}
+
+page_table_x64::size_type
+page_table_x64::global_nodes() const noexcept
+{
+    auto size = 1UL;
 
-    for (const auto &pt : m_pts)
-        if (pt != nullptr) size += pt->global_size();
+    for (const auto &child : m_pts)
+        size += child.pt->global_nodes();
 
     return size;
 }
 
 page_table_x64::size_type
-page_table_x64::global_capacity() const noexcept
+page_table_x64::global_bytes() const noexcept
 {
-    auto size = m_pts.capacity();
+    auto size = sizeof(*this) + page_table::num_bytes + (m_pts.capacity() * sizeof(child_type));
 
-    for (const auto &pt : m_pts)
-        if (pt != nullptr) size += pt->global_capacity();
+    for (const auto &child : m_pts)
+        size += child.pt->global_bytes();
 
     return size;
 }
@@ -0,0 +1,358 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#include <algorithm>
+#include <shared_mutex>
+
+#include <debug.h>
+#include <constants.h>
+#include <guard_exceptions.h>
+#include <memory_manager/root_ept_intel_x64.h>
+
+#include <intrinsics/msrs_intel_x64.h>
+
+using namespace x64;
+using namespace intel_x64;
+
+// -----------------------------------------------------------------------------
+// Testing Seem
+// -----------------------------------------------------------------------------
+
+#ifdef CROSS_COMPILED
+
+void root_ept_terminate()
+{ std::terminate(); }
+
+#else
+
+auto g_ept_terminate_called = false;
+
+void root_ept_terminate()
+{ g_ept_terminate_called = true; }
+
+#endif
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+// EPTP: write back memory type (bits 2:0) and a page walk length of 4
+// (bits 5:3 hold the page walk length minus one)
+
+constexpr const auto eptp_memory_type_write_back = 0x6UL;
+constexpr const auto eptp_page_walk_length_of_4 = 0x18UL;
+
+// -----------------------------------------------------------------------------
+// Implementation
+// -----------------------------------------------------------------------------
+
+static auto
+mtrr_to_ept_type(mtrr_x64::memory_type_type type) noexcept
+{
+    // The MTRRs only define UC, WC, WT, WP and WB, all of which are valid
+    // EPT memory types. Anything else is reserved, and mapped as UC.
+
+    switch (type)
+    {
+        case memory_type::write_combining:
+        case memory_type::write_through:
+        case memory_type::write_protected:
+        case memory_type::write_back:
+            return type;
+
+        default:
+            return memory_type::uncacheable;
+    }
+}
+
+root_ept_intel_x64::root_ept_intel_x64() :
+    m_eptp(0),
+    m_ept{std::make_unique<ept_intel_x64>(&m_eptp)}
+{ }
+
+root_ept_intel_x64::eptp_type
+root_ept_intel_x64::eptp()
+{
+    auto &&entry = ept_entry_intel_x64(&m_eptp);
+    return entry.phys_addr() | eptp_page_walk_length_of_4 | eptp_memory_type_write_back;
+}
+
+void
+root_ept_intel_x64::unmap(integer_pointer gpa) noexcept
+{
+    std::lock_guard<x64::rw_spinlock> guard(m_lock);
+    unmap_page(gpa);
+}
+
+void
+root_ept_intel_x64::setup_identity_map(
+    const mtrr_x64 &mtrrs, integer_pointer saddr, integer_pointer eaddr)
+{
+    expects((saddr & (page_table::pt::size_bytes - 1)) == 0);
+    expects((eaddr & (page_table::pt::size_bytes - 1)) == 0);
+    expects(saddr < eaddr);
+
+    auto &&sizes = {
+        page_table::pdpt::size_bytes,
+        page_table::pd::size_bytes,
+        page_table::pt::size_bytes
+    };
+
+    auto &&large_1g = msrs::ia32_vmx_ept_vpid_cap::pdpte_1gb_support::get();
+
+    for (auto addr = saddr; addr < eaddr;)
+    {
+        for (auto size : sizes)
+        {
+            if (size == page_table::pdpt::size_bytes && !large_1g)
+                continue;
+
+            if ((addr & (size - 1)) != 0 || eaddr - addr < size)
+                continue;
+
+            if (size != page_table::pt::size_bytes && !mtrrs.uniform(addr, size))
+                continue;
+
+            auto &&type = mtrr_to_ept_type(mtrrs.mem_type(addr));
+            this->map_page(addr, addr, ept::read_write_execute, type, size);
+
+            addr += size;
+            break;
+        }
+    }
+}
+
+void
+root_ept_intel_x64::set_access(integer_pointer gpa, size_type size, access_type access)
+{
+    expects((gpa & (page_table::pt::size_bytes - 1)) == 0);
+    expects((size & (page_table::pt::size_bytes - 1)) == 0);
+    expects(size != 0);
+
+    std::lock_guard<x64::rw_spinlock> guard(m_lock);
+
+    auto &&eaddr = gpa + size;
+
+    for (auto addr = gpa; addr < eaddr;)
+    {
+        auto &&page_size = m_ept->gpa_to_page_size(addr);
+
+        if ((addr & (page_size - 1)) == 0 && eaddr - addr >= page_size)
+        {
+            m_ept->gpa_to_epte(addr).set_access(access);
+            addr += page_size;
+
+            continue;
+        }
+
+        // The range only covers part of this page, so the page is split
+        // into 512 smaller pages (with the same attributes), and the loop
+        // is repeated with the smaller page.
+
+        if (page_size == page_table::pdpt::size_bytes)
+            m_ept->add_page_2m(addr);
+        else
+            m_ept->add_page_4k(addr);
+    }
+}
+
+void
+root_ept_intel_x64::split_4k(integer_pointer gpa, size_type size)
+{
+    expects((gpa & (page_table::pt::size_bytes - 1)) == 0);
+    expects((size & (page_table::pt::size_bytes - 1)) == 0);
+    expects(size != 0);
+
+    std::lock_guard<x64::rw_spinlock> guard(m_lock);
+
+    auto &&eaddr = gpa + size;
+
+    for (auto addr = gpa; addr < eaddr;)
+    {
+        if (m_ept->gpa_to_page_size(addr) == page_table::pt::size_bytes)
+        {
+            addr += page_table::pt::size_bytes;
+            continue;
+        }
+
+        m_ept->add_page_4k(addr);
+    }
+}
+
+bool
+root_ept_intel_x64::clear_dirty(integer_pointer gpa)
+{
+    // Only the entry's dirty flag is modified (which the CPU also sets
+    // without holding any lock), so the tables themselves do not change,
+    // and a shared lock is enough.
+
+    std::shared_lock<x64::rw_spinlock> guard(m_lock);
+
+    auto &&entry = m_ept->gpa_to_epte(gpa);
+
+    if (!entry.dirty())
+        return false;
+
+    entry.set_dirty(false);
+    return true;
+}
+
+ept_entry_intel_x64
+root_ept_intel_x64::gpa_to_epte(integer_pointer gpa) const
+{
+    std::shared_lock<x64::rw_spinlock> guard(m_lock);
+    return m_ept->gpa_to_epte(gpa);
+}
+
+root_ept_intel_x64::size_type
+root_ept_intel_x64::gpa_to_page_size(integer_pointer gpa) const
+{
+    std::shared_lock<x64::rw_spinlock> guard(m_lock);
+    return m_ept->gpa_to_page_size(gpa);
+}
+
+root_ept_intel_x64::size_type
+root_ept_intel_x64::pages(size_type size) const
+{
+    std::shared_lock<x64::rw_spinlock> guard(m_lock);
+
+    switch (size)
+    {
+        case page_table::pdpt::size_bytes:
+            return m_ept->global_pages(page_table::pdpt::from);
+
+        case page_table::pd::size_bytes:
+            return m_ept->global_pages(page_table::pd::from);
+
+        case page_table::pt::size_bytes:
+            return m_ept->global_pages(page_table::pt::from);
+
+        default:
+            throw std::logic_error("invalid ept page size");
+    }
+}
+
+root_ept_intel_x64::size_type
+root_ept_intel_x64::tables() const
+{
+    std::shared_lock<x64::rw_spinlock> guard(m_lock);
+    return m_ept->global_nodes();
+}
+
+root_ept_intel_x64::size_type
+root_ept_intel_x64::table_bytes() const
+{
+    std::shared_lock<x64::rw_spinlock> guard(m_lock);
+    return m_ept->global_bytes();
+}
+
+void
+root_ept_intel_x64::dump() const
+{
+    bfdebug << "ept:" << bfendl;
+    bfdebug << "    - 1g pages: " << pages(page_table::pdpt::size_bytes) << bfendl;
+    bfdebug << "    - 2m pages: " << pages(page_table::pd::size_bytes) << bfendl;
+    bfdebug << "    - 4k pages: " << pages(page_table::pt::size_bytes) << bfendl;
+    bfdebug << "    - tables: " << tables() << bfendl;
+    bfdebug << "    - bytes: " << table_bytes() << bfendl;
+}
+
+ept_entry_intel_x64
+root_ept_intel_x64::add_page(integer_pointer gpa, size_type size)
+{
+    switch (size)
+    {
+        case page_table::pdpt::size_bytes:
+            return m_ept->add_page_1g(gpa);
+
+        case page_table::pd::size_bytes:
+            return m_ept->add_page_2m(gpa);
+
+        case page_table::pt::size_bytes:
+            return m_ept->add_page_4k(gpa);
+
+        default:
+            throw std::logic_error("invalid ept size");
+    }
+}
+
+void
+root_ept_intel_x64::map_page(
+    integer_pointer gpa, integer_pointer hpa, access_type access, memory_type_type type, size_type size)
+{
+    std::lock_guard<x64::rw_spinlock> guard(m_lock);
+
+    auto &&entry = add_page(gpa, size);
+
+    auto ___ = gsl::on_failure([&]
+    { this->unmap_page(gpa); });
+
+    // The entry is built locally and then published with a single store, so
+    // that the CPU never walks a partially filled-in entry
+
+    auto &&value = 0UL;
+    auto &&page = ept_entry_intel_x64(&value);
+
+    page.set_phys_addr(hpa & ~(size - 1));
+    page.set_access(access);
+    page.set_memory_type(type);
+
+    if (size != page_table::pt::size_bytes)
+        page.set_entry_type(true);
+
+    entry.set_value(value);
+}
+
+void
+root_ept_intel_x64::unmap_page(integer_pointer gpa) noexcept
+{
+    guard_exceptions([&]
+    { m_ept->remove_page(gpa); });
+}
+
+root_ept_intel_x64 *
+root_ept() noexcept
+{
+    static std::unique_ptr<root_ept_intel_x64> ept;
+
+    if (!ept)
+    {
+        ept = std::make_unique<root_ept_intel_x64>();
+
+        try
+        {
+            auto &&phys_bits = cpuid::addr_size::phys::get();
+            auto &&eaddr = std::min(1ULL << phys_bits, MAX_EPT_IDENTITY_MAP);
+
+            ept->setup_identity_map(mtrr_x64(), 0, eaddr);
+        }
+        catch (std::exception &e)
+        {
+            ept.reset();
+
+            bferror << "failed to construct root ept: " << e.what() << bfendl;
+            root_ept_terminate();
+        }
+    }
+
+    return ept.get();
+}
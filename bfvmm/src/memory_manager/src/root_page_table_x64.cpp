@@ -19,6 +19,8 @@
 // License along with this library; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
 
+#include <shared_mutex>
+
 #include <debug.h>
 #include <guard_exceptions.h>
 #include <memory_manager/memory_manager_x64.h>
@@ -60,7 +62,7 @@ root_page_table_x64::cr3()
 void
 root_page_table_x64::unmap(integer_pointer virt) noexcept
 {
-    std::lock_guard<std::mutex> guard(m_mutex);
+    std::lock_guard<x64::rw_spinlock> guard(m_lock);
     unmap_page(virt);
 }
 
@@ -133,14 +135,14 @@ root_page_table_x64::unmap_identity_map_4k(
 page_table_entry_x64
 root_page_table_x64::virt_to_pte(integer_pointer virt) const
 {
-    std::lock_guard<std::mutex> guard(m_mutex);
+    std::shared_lock<x64::rw_spinlock> guard(m_lock);
     return m_pt->virt_to_pte(virt);
 }
 
 root_page_table_x64::memory_descriptor_list
 root_page_table_x64::pt_to_mdl() const
 {
-    std::lock_guard<std::mutex> guard(m_mutex);
+    std::shared_lock<x64::rw_spinlock> guard(m_lock);
     return m_pt->pt_to_mdl();
 }
 
@@ -166,7 +168,7 @@ root_page_table_x64::add_page(integer_pointer virt, size_type size)
 void
 root_page_table_x64::map_page(integer_pointer virt, integer_pointer phys, attr_type attr, size_type size)
 {
-    std::lock_guard<std::mutex> guard(m_mutex);
+    std::lock_guard<x64::rw_spinlock> guard(m_lock);
 
     auto &&entry = add_page(virt, size);
 
@@ -236,7 +238,12 @@ root_page_table_x64::map_page(integer_pointer virt, integer_pointer phys, attr_t
     }
 
     if (m_is_vmm)
-        g_mm->add_md(virt, phys, attr);
+    {
+        if (size == page_table::pd::size_bytes)
+            g_mm->add_md_2m(virt, phys, attr);
+        else
+            g_mm->add_md(virt, phys, attr);
+    }
 }
 
 void
@@ -272,7 +279,10 @@ root_pt() noexcept
                 if (md.type == (MEMORY_TYPE_R | MEMORY_TYPE_E))
                     attr = memory_attr::re_wb;
 
-                rpt->map_4k(md.virt, md.phys, attr);
+                if (md.size == LARGE_PAGE_SIZE)
+                    rpt->map_2m(md.virt, md.phys, attr);
+                else
+                    rpt->map_4k(md.virt, md.phys, attr);
             }
         }
         catch (std::exception &e)
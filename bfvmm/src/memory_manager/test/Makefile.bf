@@ -58,6 +58,10 @@ SOURCES+=test_map_ptr_x64.cpp
 SOURCES+=test_root_page_table_x64.cpp
 SOURCES+=test_pat_x64.cpp
 SOURCES+=test_mem_attr_x64.cpp
+SOURCES+=test_ept_entry_intel_x64.cpp
+SOURCES+=test_mtrr_x64.cpp
+SOURCES+=test_root_ept_intel_x64.cpp
+SOURCES+=test_dirty_log_intel_x64.cpp
 HEADERS=
 
 INCLUDE_PATHS+=./
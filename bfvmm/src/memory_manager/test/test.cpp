@@ -59,13 +59,30 @@ memory_manager_ut::list()
     this->test_mem_pool_size();
     this->test_mem_pool_contains_out_of_bounds();
     this->test_mem_pool_contains();
+    this->test_mem_pool_used_and_peak();
+    this->test_mem_pool_resize_invalid();
+    this->test_mem_pool_resize_grow();
+    this->test_mem_pool_resize_shrink();
+    this->test_mem_pool_fragmentation();
+    this->test_mem_arena_create_invalid();
+    this->test_mem_arena_create_success();
 
     this->test_memory_manager_x64_size_out_of_bounds();
     this->test_memory_manager_x64_malloc_out_of_memory();
     this->test_memory_manager_x64_malloc_heap();
     this->test_memory_manager_x64_malloc_page();
     this->test_memory_manager_x64_malloc_map();
+    this->test_memory_manager_x64_malloc_emergency();
+    this->test_memory_manager_x64_realloc_null_and_zero();
+    this->test_memory_manager_x64_realloc_in_place();
+    this->test_memory_manager_x64_realloc_move();
+    this->test_memory_manager_x64_heap_profiler();
+    this->test_memory_manager_x64_heap_profiler_dropped();
+    this->test_memory_manager_x64_arena_stats_map_pool();
     this->test_memory_manager_x64_add_md();
+    this->test_memory_manager_x64_add_md_invalid_size();
+    this->test_memory_manager_x64_add_md_2m();
+    this->test_memory_manager_x64_add_md_2m_unaligned();
     this->test_memory_manager_x64_add_md_invalid_type();
     this->test_memory_manager_x64_add_md_unaligned_physical();
     this->test_memory_manager_x64_add_md_unaligned_virtual();
@@ -79,6 +96,10 @@ memory_manager_ut::list()
     this->test_memory_manager_x64_physint_to_virtint_nullptr();
     this->test_memory_manager_x64_virtint_to_attrint_random_address();
     this->test_memory_manager_x64_virtint_to_attrint_nullptr();
+    this->test_memory_manager_x64_add_chunk_invalid();
+    this->test_memory_manager_x64_add_chunk_heap();
+    this->test_memory_manager_x64_add_chunk_node();
+    this->test_memory_manager_x64_add_chunk_reserve();
 
     this->test_page_table_x64_add_remove_page_success_without_setting();
     this->test_page_table_x64_add_remove_page_1g_success();
@@ -91,6 +112,9 @@ memory_manager_ut::list()
     this->test_page_table_x64_virt_to_pte_invalid();
     this->test_page_table_x64_virt_to_pte_success();
     this->test_page_table_x64_pt_to_mdl_success();
+    this->test_page_table_x64_add_page_twice_counted_once();
+    this->test_page_table_x64_memory_usage();
+    this->test_page_table_x64_map_unmap_many();
 
     this->test_page_table_entry_x64_present();
     this->test_page_table_entry_x64_rw();
@@ -155,12 +179,57 @@ memory_manager_ut::list()
     this->test_root_page_table_x64_setup_identity_map_4k_valid();
     this->test_root_page_table_x64_pt_to_mdl();
 
+    this->test_ept_entry_intel_x64_access();
+    this->test_ept_entry_intel_x64_memory_type();
+    this->test_ept_entry_intel_x64_ignore_pat();
+    this->test_ept_entry_intel_x64_entry_type();
+    this->test_ept_entry_intel_x64_accessed_dirty();
+    this->test_ept_entry_intel_x64_phys_addr();
+    this->test_ept_entry_intel_x64_suppress_ve();
+    this->test_ept_entry_intel_x64_clear();
+    this->test_ept_entry_intel_x64_value();
+
+    this->test_mtrr_x64_disabled();
+    this->test_mtrr_x64_fixed();
+    this->test_mtrr_x64_variable();
+    this->test_mtrr_x64_uniform();
+
+    this->test_ept_intel_x64_add_remove_page();
+    this->test_ept_intel_x64_split_1g();
+    this->test_ept_intel_x64_memory_usage();
+    this->test_root_ept_intel_x64_init_failure();
+    this->test_root_ept_intel_x64_init_success();
+    this->test_root_ept_intel_x64_eptp();
+    this->test_root_ept_intel_x64_map();
+    this->test_root_ept_intel_x64_setup_identity_map_invalid();
+    this->test_root_ept_intel_x64_setup_identity_map_1g();
+    this->test_root_ept_intel_x64_setup_identity_map_2m();
+    this->test_root_ept_intel_x64_set_access();
+    this->test_root_ept_intel_x64_split_4k();
+    this->test_root_ept_intel_x64_clear_dirty();
+    this->test_root_ept_intel_x64_walk_1g_vs_4k();
+    this->test_dirty_log_intel_x64_start_invalid();
+    this->test_dirty_log_intel_x64_start_stop();
+    this->test_dirty_log_intel_x64_harvest();
+    this->test_dirty_log_intel_x64_harvest_partial();
+    this->test_dirty_log_intel_x64_harvest_multiple_vcpus();
+
     this->test_pat_x64_mem_attr_to_pat_index();
     this->test_mem_attr_x64_mem_type_to_attr();
 
     return true;
 }
 
+bool
+memory_manager_ut::benchmark()
+{
+    this->benchmark_memory_manager_x64_realloc();
+    this->benchmark_page_table_x64_map_unmap();
+    this->benchmark_root_ept_intel_x64_walk();
+
+    return true;
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -36,6 +36,7 @@ protected:
     bool init() override;
     bool fini() override;
     bool list() override;
+    bool benchmark() override;
 
 private:
 
@@ -55,13 +56,30 @@ private:
     void test_mem_pool_size();
     void test_mem_pool_contains_out_of_bounds();
     void test_mem_pool_contains();
+    void test_mem_pool_used_and_peak();
+    void test_mem_pool_resize_invalid();
+    void test_mem_pool_resize_grow();
+    void test_mem_pool_resize_shrink();
+    void test_mem_pool_fragmentation();
+    void test_mem_arena_create_invalid();
+    void test_mem_arena_create_success();
 
     void test_memory_manager_x64_size_out_of_bounds();
     void test_memory_manager_x64_malloc_out_of_memory();
     void test_memory_manager_x64_malloc_heap();
     void test_memory_manager_x64_malloc_page();
     void test_memory_manager_x64_malloc_map();
+    void test_memory_manager_x64_malloc_emergency();
+    void test_memory_manager_x64_realloc_null_and_zero();
+    void test_memory_manager_x64_realloc_in_place();
+    void test_memory_manager_x64_realloc_move();
+    void test_memory_manager_x64_heap_profiler();
+    void test_memory_manager_x64_heap_profiler_dropped();
+    void test_memory_manager_x64_arena_stats_map_pool();
     void test_memory_manager_x64_add_md();
+    void test_memory_manager_x64_add_md_invalid_size();
+    void test_memory_manager_x64_add_md_2m();
+    void test_memory_manager_x64_add_md_2m_unaligned();
     void test_memory_manager_x64_add_md_invalid_type();
     void test_memory_manager_x64_add_md_unaligned_physical();
     void test_memory_manager_x64_add_md_unaligned_virtual();
@@ -75,6 +93,10 @@ private:
     void test_memory_manager_x64_physint_to_virtint_nullptr();
     void test_memory_manager_x64_virtint_to_attrint_random_address();
     void test_memory_manager_x64_virtint_to_attrint_nullptr();
+    void test_memory_manager_x64_add_chunk_invalid();
+    void test_memory_manager_x64_add_chunk_heap();
+    void test_memory_manager_x64_add_chunk_node();
+    void test_memory_manager_x64_add_chunk_reserve();
 
     void test_page_table_x64_add_remove_page_success_without_setting();
     void test_page_table_x64_add_remove_page_1g_success();
@@ -87,6 +109,9 @@ private:
     void test_page_table_x64_virt_to_pte_invalid();
     void test_page_table_x64_virt_to_pte_success();
     void test_page_table_x64_pt_to_mdl_success();
+    void test_page_table_x64_add_page_twice_counted_once();
+    void test_page_table_x64_memory_usage();
+    void test_page_table_x64_map_unmap_many();
 
     void test_page_table_entry_x64_present();
     void test_page_table_entry_x64_rw();
@@ -151,8 +176,47 @@ private:
     void test_root_page_table_x64_setup_identity_map_4k_valid();
     void test_root_page_table_x64_pt_to_mdl();
 
+    void test_ept_entry_intel_x64_access();
+    void test_ept_entry_intel_x64_memory_type();
+    void test_ept_entry_intel_x64_ignore_pat();
+    void test_ept_entry_intel_x64_entry_type();
+    void test_ept_entry_intel_x64_accessed_dirty();
+    void test_ept_entry_intel_x64_phys_addr();
+    void test_ept_entry_intel_x64_suppress_ve();
+    void test_ept_entry_intel_x64_clear();
+    void test_ept_entry_intel_x64_value();
+
+    void test_mtrr_x64_disabled();
+    void test_mtrr_x64_fixed();
+    void test_mtrr_x64_variable();
+    void test_mtrr_x64_uniform();
+
+    void test_ept_intel_x64_add_remove_page();
+    void test_ept_intel_x64_split_1g();
+    void test_ept_intel_x64_memory_usage();
+    void test_root_ept_intel_x64_init_failure();
+    void test_root_ept_intel_x64_init_success();
+    void test_root_ept_intel_x64_eptp();
+    void test_root_ept_intel_x64_map();
+    void test_root_ept_intel_x64_setup_identity_map_invalid();
+    void test_root_ept_intel_x64_setup_identity_map_1g();
+    void test_root_ept_intel_x64_setup_identity_map_2m();
+    void test_root_ept_intel_x64_set_access();
+    void test_root_ept_intel_x64_split_4k();
+    void test_root_ept_intel_x64_clear_dirty();
+    void test_root_ept_intel_x64_walk_1g_vs_4k();
+    void test_dirty_log_intel_x64_start_invalid();
+    void test_dirty_log_intel_x64_start_stop();
+    void test_dirty_log_intel_x64_harvest();
+    void test_dirty_log_intel_x64_harvest_partial();
+    void test_dirty_log_intel_x64_harvest_multiple_vcpus();
+
     void test_pat_x64_mem_attr_to_pat_index();
     void test_mem_attr_x64_mem_type_to_attr();
+
+    void benchmark_memory_manager_x64_realloc();
+    void benchmark_page_table_x64_map_unmap();
+    void benchmark_root_ept_intel_x64_walk();
 };
 
 #endif
@@ -0,0 +1,286 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#include <gsl/gsl>
+
+#include <array>
+#include <vector>
+
+#include <test.h>
+#include <memory_manager/dirty_log_intel_x64.h>
+#include <memory_manager/root_ept_intel_x64.h>
+#include <memory_manager/memory_manager_x64.h>
+
+using namespace x64;
+using namespace intel_x64;
+
+constexpr const auto size_2m = page_table::pd::size_bytes;
+constexpr const auto size_4k = page_table::pt::size_bytes;
+
+static auto
+setup_mm(MockRepository &mocks)
+{
+    auto mm = mocks.Mock<memory_manager_x64>();
+    mocks.OnCallFunc(memory_manager_x64::instance).Return(mm);
+    mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Return(0x0000000ABCDEF0000);
+
+    return mm;
+}
+
+static void
+setup_ept(root_ept_intel_x64 &ept)
+{
+    ept.map_2m(0x200000, 0x200000, ept::read_write_execute, memory_type::write_back);
+    ept.map_2m(0x400000, 0x400000, ept::read_write_execute, memory_type::write_back);
+}
+
+static void
+set_dirty(root_ept_intel_x64 &ept, uintptr_t gpa)
+{
+    ept.gpa_to_epte(gpa).set_accessed(true);
+    ept.gpa_to_epte(gpa).set_dirty(true);
+}
+
+void
+memory_manager_ut::test_dirty_log_intel_x64_start_invalid()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ept = root_ept_intel_x64{};
+        auto &&log = dirty_log_intel_x64{&ept};
+
+        setup_ept(ept);
+
+        this->expect_exception([&] { log.start(0x200010, size_4k); }, ""_ut_ffe);
+        this->expect_exception([&] { log.start(0x200000, 0x10); }, ""_ut_ffe);
+        this->expect_exception([&] { log.start(0x200000, 0x0); }, ""_ut_ffe);
+        this->expect_exception([&] { log.start(0x600000, size_4k); }, ""_ut_ree);
+        this->expect_false(log.is_running());
+
+        this->expect_no_exception([&] { log.start(0x200000, size_4k); });
+        this->expect_exception([&] { log.start(0x200000, size_4k); }, ""_ut_ffe);
+    });
+}
+
+void
+memory_manager_ut::test_dirty_log_intel_x64_start_stop()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ept = root_ept_intel_x64{};
+        auto &&log = dirty_log_intel_x64{&ept};
+
+        setup_ept(ept);
+
+        auto &&generation = log.generation();
+
+        this->expect_no_exception([&] { log.start(0x3FF000, size_4k * 2); });
+        this->expect_true(log.is_running());
+        this->expect_true(log.gpa() == 0x3FF000);
+        this->expect_true(log.pages() == 2);
+        this->expect_true(log.generation() == generation + 1);
+
+        // Only the 2m pages that the range touches are split
+
+        this->expect_true(ept.pages(size_2m) == 0);
+        this->expect_true(ept.pages(size_4k) == 1024);
+
+        this->expect_no_exception([&] { log.stop(); });
+        this->expect_false(log.is_running());
+        this->expect_true(log.pages() == 0);
+        this->expect_true(log.generation() == generation + 2);
+
+        this->expect_no_exception([&] { log.stop(); });
+        this->expect_true(log.generation() == generation + 2);
+        this->expect_exception([&] { log.harvest(0, {}); }, ""_ut_ffe);
+    });
+}
+
+void
+memory_manager_ut::test_dirty_log_intel_x64_harvest()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    auto &&bitmap = std::array<uint64_t, 4>{};
+    auto &&gpas = std::vector<uintptr_t> {
+        0x200000, 0x201FFF, 0x241000, 0x1FF000, 0x264000, 0x400000
+    };
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ept = root_ept_intel_x64{};
+        auto &&log = dirty_log_intel_x64{&ept};
+
+        setup_ept(ept);
+        log.start(0x200000, size_4k * 100);
+
+        // Every page starts dirty, and harvesting clears the EPT dirty flag
+        // of each page that is reported
+
+        set_dirty(ept, 0x200000);
+
+        this->expect_true(log.harvest(0, bitmap) == 100);
+        this->expect_true(bitmap[0] == 0xFFFFFFFFFFFFFFFF);
+        this->expect_true(bitmap[1] == 0x0000000FFFFFFFFF);
+        this->expect_true(bitmap[2] == 0);
+        this->expect_false(ept.gpa_to_epte(0x200000).dirty());
+
+        auto &&generation = log.generation();
+
+        this->expect_true(log.harvest(0, bitmap) == 0);
+        this->expect_true(bitmap[0] == 0);
+        this->expect_true(bitmap[1] == 0);
+        this->expect_true(log.generation() == generation);
+
+        // Addresses outside of the range are ignored
+
+        set_dirty(ept, 0x201000);
+        set_dirty(ept, 0x241000);
+
+        log.log(gpas);
+
+        this->expect_true(log.harvest(0, bitmap) == 3);
+        this->expect_true(bitmap[0] == 0x0000000000000003);
+        this->expect_true(bitmap[1] == 0x0000000000000002);
+        this->expect_true(log.generation() == generation + 1);
+
+        this->expect_false(ept.gpa_to_epte(0x201000).dirty());
+        this->expect_false(ept.gpa_to_epte(0x241000).dirty());
+    });
+}
+
+void
+memory_manager_ut::test_dirty_log_intel_x64_harvest_partial()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    auto &&bitmap = std::array<uint64_t, 1>{};
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ept = root_ept_intel_x64{};
+        auto &&log = dirty_log_intel_x64{&ept};
+
+        setup_ept(ept);
+        log.start(0x200000, size_4k * 130);
+
+        // The bitmap can be harvested one window at a time, and only the
+        // window that is harvested is cleared
+
+        this->expect_true(log.harvest(64, bitmap) == 64);
+        this->expect_true(bitmap[0] == 0xFFFFFFFFFFFFFFFF);
+
+        this->expect_true(log.harvest(128, bitmap) == 2);
+        this->expect_true(bitmap[0] == 0x0000000000000003);
+
+        this->expect_true(log.harvest(0, bitmap) == 64);
+        this->expect_true(log.harvest(64, bitmap) == 0);
+
+        this->expect_exception([&] { log.harvest(1, bitmap); }, ""_ut_ffe);
+        this->expect_exception([&] { log.harvest(192, bitmap); }, ""_ut_ffe);
+    });
+}
+
+void
+memory_manager_ut::test_dirty_log_intel_x64_harvest_multiple_vcpus()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    auto &&bitmap = std::array<uint64_t, 1>{};
+    auto &&gpas = std::vector<uintptr_t> { 0x200000 };
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ept = root_ept_intel_x64{};
+        auto &&log = dirty_log_intel_x64{&ept};
+
+        setup_ept(ept);
+        log.start(0x200000, size_4k * 64);
+
+        // Writes are only logged by vCPUs that are tracking writes, so
+        // harvests are rejected until every vCPU is
+
+        log.add_vcpu();
+        log.add_vcpu();
+        this->expect_true(log.vcpus() == 2);
+
+        log.vcpu_synced(log.add_tracking_vcpu());
+        this->expect_true(log.tracking_vcpus() == 1);
+        this->expect_exception([&] { log.harvest(0, bitmap); }, ""_ut_ree);
+
+        log.vcpu_synced(log.add_tracking_vcpu());
+        this->expect_true(log.tracking_vcpus() == 2);
+
+        // The other vCPU might write to the pages that were cleared before
+        // it invalidates, so they are reported again until it has
+
+        this->expect_true(log.harvest(0, bitmap) == 64);
+        this->expect_true(bitmap[0] == 0xFFFFFFFFFFFFFFFF);
+
+        log.vcpu_synced(log.generation());
+
+        set_dirty(ept, 0x200000);
+        log.log(gpas);
+
+        this->expect_true(log.harvest(0, bitmap) == 64);
+        this->expect_true(bitmap[0] == 0xFFFFFFFFFFFFFFFF);
+        this->expect_false(ept.gpa_to_epte(0x200000).dirty());
+
+        // Once both vCPUs have synced, the stale pages are reported one
+        // last time (without clearing anything, so the generation stays)
+
+        auto &&generation = log.generation();
+
+        log.vcpu_synced(generation);
+        log.vcpu_synced(generation - 1);
+        this->expect_true(log.harvest(0, bitmap) == 64);
+
+        log.vcpu_synced(generation);
+        this->expect_true(log.harvest(0, bitmap) == 64);
+        this->expect_true(log.generation() == generation);
+        this->expect_true(log.harvest(0, bitmap) == 0);
+
+        // A vCPU that stops tracking writes has to leave the EPT as well
+
+        log.remove_tracking_vcpu(generation);
+        this->expect_true(log.tracking_vcpus() == 1);
+        this->expect_exception([&] { log.harvest(0, bitmap); }, ""_ut_ree);
+
+        log.remove_vcpu();
+        this->expect_true(log.harvest(0, bitmap) == 0);
+
+        log.remove_tracking_vcpu(generation);
+        log.remove_tracking_vcpu(generation);
+        log.remove_vcpu();
+        log.remove_vcpu();
+        this->expect_true(log.tracking_vcpus() == 0);
+        this->expect_true(log.vcpus() == 0);
+    });
+}
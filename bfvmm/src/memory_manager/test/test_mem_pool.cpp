@@ -23,6 +23,7 @@
 
 #include <gsl/gsl>
 
+#include <array>
 #include <vector>
 
 #include <test.h>
@@ -210,3 +211,147 @@ memory_manager_ut::test_mem_pool_contains()
     this->expect_true(pool.contains(100));
     this->expect_true(pool.contains(227));
 }
+
+void
+memory_manager_ut::test_mem_pool_used_and_peak()
+{
+    mem_pool<128, 3> pool{100};
+
+    auto &&addr1 = pool.alloc(8);
+    auto &&addr2 = pool.alloc(20);
+    this->expect_true(pool.used() == 32);
+    this->expect_true(pool.peak() == 32);
+
+    pool.free(addr1);
+    pool.free(addr1);
+    this->expect_true(pool.used() == 24);
+
+    pool.free(addr2);
+    this->expect_true(pool.used() == 0);
+    this->expect_true(pool.peak() == 32);
+}
+
+void
+memory_manager_ut::test_mem_pool_resize_invalid()
+{
+    mem_pool<128, 3> pool{100};
+
+    auto &&addr = pool.alloc(8);
+
+    this->expect_false(pool.resize(0, 8));
+    this->expect_false(pool.resize(addr, 0));
+    this->expect_false(pool.resize(addr, 136));
+    this->expect_false(pool.resize(addr + 1, 16));
+    this->expect_false(pool.resize(addr + 8, 16));
+    this->expect_true(pool.size(addr) == 8);
+}
+
+void
+memory_manager_ut::test_mem_pool_resize_grow()
+{
+    mem_pool<128, 3> pool{100};
+
+    auto &&addr1 = pool.alloc(8);
+    this->expect_true(pool.resize(addr1, 20));
+    this->expect_true(pool.size(addr1) == 24);
+    this->expect_true(pool.used() == 24);
+    this->expect_true(pool.peak() == 24);
+
+    auto &&addr2 = pool.alloc(8);
+    this->expect_true(addr2 == addr1 + 24);
+    this->expect_false(pool.resize(addr1, 32));
+    this->expect_true(pool.size(addr1) == 24);
+
+    this->expect_true(pool.resize(addr2, 104));
+    this->expect_false(pool.resize(addr2, 112));
+    this->expect_true(pool.used() == 128);
+    this->expect_true(pool.try_alloc(8) == 0);
+}
+
+void
+memory_manager_ut::test_mem_pool_resize_shrink()
+{
+    mem_pool<128, 3> pool{100};
+
+    auto &&addr1 = pool.alloc(32);
+    auto &&addr2 = pool.alloc(8);
+
+    this->expect_true(pool.resize(addr1, 8));
+    this->expect_true(pool.size(addr1) == 8);
+    this->expect_true(pool.used() == 16);
+    this->expect_true(pool.peak() == 40);
+
+    this->expect_true(pool.resize(addr1, 32));
+    this->expect_true(pool.size(addr1) == 32);
+    this->expect_true(pool.size(addr2) == 8);
+
+    pool.free(addr1);
+    pool.free(addr2);
+    this->expect_true(pool.used() == 0);
+}
+
+void
+memory_manager_ut::test_mem_pool_fragmentation()
+{
+    mem_pool<128, 3> pool{100};
+
+    this->expect_true(pool.largest_free() == 128);
+    this->expect_true(pool.free_ranges() == 1);
+
+    auto &&addr1 = pool.alloc(8);
+    auto &&addr2 = pool.alloc(8);
+    auto &&addr3 = pool.alloc(8);
+
+    pool.free(addr2);
+    this->expect_true(pool.largest_free() == 104);
+    this->expect_true(pool.free_ranges() == 2);
+
+    std::array<uint8_t, 2> map;
+    pool.occupancy(map);
+    this->expect_true(map[0] == 25);
+    this->expect_true(map[1] == 0);
+
+    pool.free(addr1);
+    pool.free(addr3);
+    this->expect_true(pool.largest_free() == 128);
+    this->expect_true(pool.free_ranges() == 1);
+}
+
+void
+memory_manager_ut::test_mem_arena_create_invalid()
+{
+    alignas(0x1000) static uint8_t chunk[0x1000];
+    auto &&addr = reinterpret_cast<uintptr_t>(chunk);
+
+    this->expect_true(mem_arena<3>::create(0, sizeof(chunk)) == nullptr);
+    this->expect_true(mem_arena<3>::create(addr + 1, sizeof(chunk) - 8) == nullptr);
+    this->expect_true(mem_arena<3>::create(addr, 0) == nullptr);
+    this->expect_true(mem_arena<3>::create(addr, sizeof(mem_arena<3>)) == nullptr);
+    this->expect_true(mem_arena<12>::create(addr, sizeof(chunk)) == nullptr);
+    this->expect_true(mem_arena<3>::create(0xFFFFFFFFFFFFF000, sizeof(chunk)) == nullptr);
+}
+
+void
+memory_manager_ut::test_mem_arena_create_success()
+{
+    alignas(0x1000) static uint8_t chunk[0x4000];
+    auto &&addr = reinterpret_cast<uintptr_t>(chunk);
+
+    auto &&arena = mem_arena<12>::create(addr, sizeof(chunk));
+    this->expect_true(arena != nullptr);
+    this->expect_true(arena->addr() == addr + 0x1000);
+    this->expect_true(arena->capacity() == 0x3000);
+    this->expect_true(arena->capacity() == mem_arena<12>::usable_size(sizeof(chunk)));
+
+    auto &&page1 = arena->try_alloc(0x1000);
+    auto &&page2 = arena->try_alloc(0x2000);
+    this->expect_true(page1 == addr + 0x1000);
+    this->expect_true(page2 == addr + 0x2000);
+    this->expect_true(arena->try_alloc(0x1000) == 0);
+    this->expect_true(arena->try_alloc(0x4000) == 0);
+    this->expect_true(arena->size(page2) == 0x2000);
+    this->expect_true(arena->used() == 0x3000);
+
+    arena->free(page1);
+    this->expect_true(arena->try_alloc(0x1000) == page1);
+}
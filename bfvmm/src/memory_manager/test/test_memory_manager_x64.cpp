@@ -21,10 +21,15 @@
 
 #include <gsl/gsl>
 
+#include <array>
+#include <chrono>
 #include <vector>
+#include <iostream>
+#include <algorithm>
 
 #include <test.h>
 #include <memory.h>
+#include <thread_context.h>
 #include <memory_manager/map_ptr_x64.h>
 #include <memory_manager/memory_manager_x64.h>
 
@@ -34,6 +39,9 @@ using namespace x64;
 extern "C" int64_t
 add_md(struct memory_descriptor *md) noexcept;
 
+extern "C" int64_t
+add_mem_chunk(struct memory_chunk *chunk) noexcept;
+
 void
 memory_manager_ut::test_memory_manager_x64_size_out_of_bounds()
 {
@@ -86,15 +94,322 @@ memory_manager_ut::test_memory_manager_x64_malloc_map()
     g_mm->free_map(ptr);
 }
 
+void
+memory_manager_ut::test_memory_manager_x64_malloc_emergency()
+{
+    std::vector<memory_manager_x64::pointer> heap;
+    std::vector<memory_manager_x64::pointer> emergency;
+
+    auto allocs = g_mm->emergency_allocs();
+    auto exhausted = g_mm->emergency_exhausted();
+
+    // Exceptions come from the emergency pool first, even though the heap
+    // has plenty of room, and only fall back to the heap once the pool is
+    // exhausted (or the exception does not fit in a block)
+
+    for (auto i = 0ULL; i < EMERGENCY_POOL_BLOCKS; i++)
+        emergency.push_back(g_mm->alloc_exception(cache_line_size));
+
+    this->expect_true(g_mm->emergency_allocs() == allocs + EMERGENCY_POOL_BLOCKS);
+    this->expect_true(g_mm->size(emergency.front()) == EMERGENCY_POOL_BLOCK_SIZE);
+
+    auto &&large = g_mm->alloc_exception(EMERGENCY_POOL_BLOCK_SIZE + 1);
+    this->expect_true(large != nullptr);
+    this->expect_true(g_mm->emergency_exhausted() == exhausted);
+
+    auto &&fallback = g_mm->alloc_exception(cache_line_size);
+    this->expect_true(fallback != nullptr);
+    this->expect_true(g_mm->size(fallback) == cache_line_size);
+    this->expect_true(g_mm->emergency_exhausted() == exhausted + 1);
+
+    g_mm->free(large);
+    g_mm->free(fallback);
+    g_mm->free(emergency.back());
+    emergency.pop_back();
+
+    // Other allocations never use the emergency pools, even once the heap
+    // is exhausted, so that they cannot take the blocks that are needed to
+    // throw std::bad_alloc
+
+    for (auto shift = 0ULL; (MAX_HEAP_POOL >> shift) > cache_line_size; shift++)
+    {
+        auto size = (MAX_HEAP_POOL >> shift) - cache_line_size;
+
+        while (auto ptr = g_mm->alloc(size))
+            heap.push_back(ptr);
+    }
+
+    this->expect_true(g_mm->alloc(cache_line_size) == nullptr);
+    this->expect_true(g_mm->emergency_allocs() == allocs + EMERGENCY_POOL_BLOCKS);
+
+    auto &&last = g_mm->alloc_exception(cache_line_size);
+    this->expect_true(last != nullptr);
+    this->expect_true(g_mm->emergency_allocs() == allocs + EMERGENCY_POOL_BLOCKS + 1);
+    this->expect_true(g_mm->alloc_exception(cache_line_size) == nullptr);
+
+    g_mm->free(last);
+
+    for (auto ptr : emergency)
+        g_mm->free(ptr);
+
+    for (auto ptr : heap)
+        g_mm->free(ptr);
+}
+
+void
+memory_manager_ut::test_memory_manager_x64_realloc_null_and_zero()
+{
+    auto &&ptr = g_mm->realloc(nullptr, cache_line_size);
+
+    this->expect_true(ptr != nullptr);
+    this->expect_true(g_mm->size(ptr) == cache_line_size);
+
+    this->expect_true(g_mm->realloc(ptr, 0) == nullptr);
+    this->expect_true(g_mm->size(ptr) == 0);
+
+    this->expect_true(g_mm->realloc(make_ptr(0xFFFFFFFFFFFFFF00), cache_line_size) == nullptr);
+}
+
+void
+memory_manager_ut::test_memory_manager_x64_realloc_in_place()
+{
+    auto &&ptr = g_mm->alloc(cache_line_size * 4);
+    this->expect_true(ptr != nullptr);
+
+    this->expect_true(g_mm->realloc(ptr, cache_line_size) == ptr);
+    this->expect_true(g_mm->size(ptr) == cache_line_size);
+
+    this->expect_true(g_mm->realloc(ptr, cache_line_size * 4) == ptr);
+    this->expect_true(g_mm->size(ptr) == cache_line_size * 4);
+
+    g_mm->free(ptr);
+}
+
+void
+memory_manager_ut::test_memory_manager_x64_realloc_move()
+{
+    auto &&ptr1 = static_cast<char *>(g_mm->alloc(cache_line_size));
+    __builtin_memset(ptr1, 0x42, cache_line_size);
+
+    // The blocks that follow ptr1 are now used (either by ptr2, or by
+    // whatever stopped ptr2 from being placed there)
+
+    auto &&ptr2 = g_mm->alloc(cache_line_size);
+    auto &&ptr3 = static_cast<char *>(g_mm->realloc(ptr1, cache_line_size * 2));
+
+    this->expect_true(ptr3 != nullptr);
+    this->expect_true(ptr3 != ptr1);
+    this->expect_true(g_mm->size(ptr1) == 0);
+    this->expect_true(g_mm->size(ptr3) == cache_line_size * 2);
+    this->expect_true(std::all_of(ptr3, ptr3 + cache_line_size, [](auto c) { return c == 0x42; }));
+
+    g_mm->free(ptr2);
+    g_mm->free(ptr3);
+}
+
+void
+memory_manager_ut::benchmark_memory_manager_x64_realloc()
+{
+    constexpr const auto max_size = 0x4000UL;
+    constexpr const auto num_loops = 0x40UL;
+
+    auto &&grow_by_copy = [](void *ptr, size_t size) -> void *
+    {
+        auto &&old_size = g_mm->size(ptr);
+        auto &&new_ptr = g_mm->alloc(size);
+
+        __builtin_memcpy(new_ptr, ptr, old_size);
+        g_mm->free(ptr);
+
+        return new_ptr;
+    };
+
+    auto &&grow_by_realloc = [](void *ptr, size_t size) -> void *
+    { return g_mm->realloc(ptr, size); };
+
+    auto &&run = [&](auto grow)
+    {
+        auto &&start = std::chrono::steady_clock::now();
+        for (auto i = 0UL; i < num_loops; i++)
+        {
+            auto ptr = g_mm->alloc(cache_line_size);
+
+            for (auto size = cache_line_size * 2; size <= max_size; size += cache_line_size)
+                ptr = grow(ptr, size);
+
+            g_mm->free(ptr);
+        }
+        auto &&end = std::chrono::steady_clock::now();
+
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    };
+
+    constexpr const auto num_grows = num_loops * ((max_size / cache_line_size) - 1);
+
+    auto &&ns_copy = run(grow_by_copy);
+    auto &&ns_realloc = run(grow_by_realloc);
+
+    std::cout << "realloc: " << num_grows << " x " << cache_line_size << " byte grows: "
+              << ns_copy / static_cast<long long>(num_grows) << " ns per grow (copy), "
+              << ns_realloc / static_cast<long long>(num_grows) << " ns per grow (in place)" << std::endl;
+}
+
+void
+memory_manager_ut::test_memory_manager_x64_heap_profiler()
+{
+    std::array<vmcall_heap_site_t, 4> sites;
+
+    g_mm->heap_profiler_start();
+    this->expect_true(g_mm->heap_profiler_running());
+    this->expect_true(g_mm->heap_profiler_allocs() == 0);
+
+    std::vector<memory_manager_x64::pointer> ptrs;
+    for (auto i = 0; i < 3; i++)
+        ptrs.push_back(g_mm->alloc(cache_line_size));
+
+    auto &&big = g_mm->alloc(cache_line_size * 8);
+    this->expect_true(g_mm->heap_profiler_allocs() == 4);
+
+    auto &&num = g_mm->heap_profiler_collect(sites);
+    this->expect_true(num == 2);
+    this->expect_true(sites[0].count == 1);
+    this->expect_true(sites[0].bytes == cache_line_size * 8);
+    this->expect_true(sites[1].count == 3);
+    this->expect_true(sites[1].bytes == cache_line_size * 3);
+    this->expect_true(sites[0].caller != sites[1].caller);
+    this->expect_true(sites[0].cpus != 0);
+
+    // Only the top call site fits
+
+    this->expect_true(g_mm->heap_profiler_collect(gsl::make_span(sites.data(), 1)) == 1);
+    this->expect_true(sites[0].bytes == cache_line_size * 8);
+
+    // A realloc that moves the allocation still tracks it once
+
+    big = g_mm->realloc(big, cache_line_size * 16);
+    this->expect_true(g_mm->heap_profiler_allocs() == 4);
+    this->expect_true(g_mm->heap_profiler_collect(sites) == 2);
+    this->expect_true(sites[0].bytes == cache_line_size * 16);
+
+    for (auto ptr : ptrs)
+        g_mm->free(ptr);
+
+    this->expect_true(g_mm->heap_profiler_allocs() == 1);
+
+    g_mm->heap_profiler_stop();
+    this->expect_false(g_mm->heap_profiler_running());
+
+    auto &&untracked = g_mm->alloc(cache_line_size);
+    this->expect_true(g_mm->heap_profiler_allocs() == 1);
+
+    g_mm->free(untracked);
+    g_mm->free(big);
+    this->expect_true(g_mm->heap_profiler_allocs() == 1);
+
+    // The malloc() and operator new entry points provide their own caller,
+    // which is recorded instead of the allocator's return address
+
+    g_mm->heap_profiler_start();
+    this->expect_true(g_mm->heap_profiler_allocs() == 0);
+
+    auto &&ptr = g_mm->alloc(cache_line_size, 0x1234);
+    this->expect_true(g_mm->heap_profiler_collect(sites) == 1);
+    this->expect_true(sites[0].caller == 0x1234);
+
+    ptr = g_mm->realloc(ptr, cache_line_size * 32, 0x5678);
+    this->expect_true(g_mm->heap_profiler_collect(sites) == 1);
+    this->expect_true(sites[0].caller == 0x5678);
+    this->expect_true(sites[0].bytes == cache_line_size * 32);
+
+    g_mm->free(ptr);
+    g_mm->heap_profiler_stop();
+}
+
+void
+memory_manager_ut::test_memory_manager_x64_heap_profiler_dropped()
+{
+    constexpr const auto max_tracked = (HEAP_PROFILER_ENTRIES / 4) * 3;
+    std::vector<memory_manager_x64::pointer> ptrs;
+
+    g_mm->heap_profiler_start();
+
+    for (auto i = 0ULL; i < max_tracked + 1; i++)
+        ptrs.push_back(g_mm->alloc(cache_line_size));
+
+    this->expect_true(g_mm->heap_profiler_allocs() == max_tracked);
+    this->expect_true(g_mm->heap_profiler_dropped() == 1);
+
+    for (auto ptr : ptrs)
+        g_mm->free(ptr);
+
+    this->expect_true(g_mm->heap_profiler_allocs() == 0);
+    g_mm->heap_profiler_stop();
+}
+
+void
+memory_manager_ut::test_memory_manager_x64_arena_stats_map_pool()
+{
+    auto &&stats = g_mm->arena_stats();
+    auto &&map_pool = std::find_if(stats.begin(), stats.end(), [](const auto & s)
+    { return s.type == MEMORY_CHUNK_MAP; });
+
+    this->expect_true(map_pool != stats.end());
+    this->expect_true(map_pool->size == MAX_MEM_MAP_POOL);
+    this->expect_true(map_pool->largest_free <= map_pool->size - map_pool->used);
+    this->expect_true(map_pool->free_ranges >= 1);
+}
+
 void
 memory_manager_ut::test_memory_manager_x64_add_md()
 {
-    memory_descriptor md = {0, 0, 0};
+    memory_descriptor md = {0, 0, 0, 0};
 
     this->expect_true(add_md(nullptr) == MEMORY_MANAGER_FAILURE);
     this->expect_true(add_md(&md) == MEMORY_MANAGER_FAILURE);
 }
 
+void
+memory_manager_ut::test_memory_manager_x64_add_md_invalid_size()
+{
+    memory_descriptor md = {0x54321000, 0x12345000, MEMORY_TYPE_R | MEMORY_TYPE_W, 0x3000};
+
+    this->expect_true(add_md(&md) == MEMORY_MANAGER_FAILURE);
+    this->expect_true(g_mm->descriptors().empty());
+}
+
+void
+memory_manager_ut::test_memory_manager_x64_add_md_2m()
+{
+    memory_descriptor md = {0x54400000, 0x12400000, MEMORY_TYPE_R | MEMORY_TYPE_W, LARGE_PAGE_SIZE};
+
+    this->expect_true(add_md(&md) == MEMORY_MANAGER_SUCCESS);
+
+    auto &&list = g_mm->descriptors();
+    this->expect_true(list.size() == 1);
+    this->expect_true(list.at(0).virt == 0x12400000);
+    this->expect_true(list.at(0).phys == 0x54400000);
+    this->expect_true(list.at(0).size == LARGE_PAGE_SIZE);
+
+    this->expect_true(g_mm->virtint_to_physint(0x12400000) == 0x54400000);
+    this->expect_true(g_mm->virtint_to_physint(0x12523ABC) == 0x54523ABC);
+    this->expect_true(g_mm->physint_to_virtint(0x545FFFFF) == 0x125FFFFF);
+    this->expect_true(g_mm->virtint_to_attrint(0x12456000) == (MEMORY_TYPE_R | MEMORY_TYPE_W));
+    this->expect_exception([&] { g_mm->virtint_to_physint(0x12600000); }, ""_ut_ore);
+
+    this->expect_no_exception([&] { g_mm->remove_md(0x12400000); });
+    this->expect_true(g_mm->descriptors().empty());
+}
+
+void
+memory_manager_ut::test_memory_manager_x64_add_md_2m_unaligned()
+{
+    memory_manager_x64::attr_type attr = MEMORY_TYPE_R | MEMORY_TYPE_W;
+
+    this->expect_exception([&] { g_mm->add_md_2m(0x12401000, 0x54400000, attr); }, ""_ut_ffe);
+    this->expect_exception([&] { g_mm->add_md_2m(0x12400000, 0x54401000, attr); }, ""_ut_ffe);
+    this->expect_true(g_mm->descriptors().empty());
+}
+
 void
 memory_manager_ut::test_memory_manager_x64_add_md_invalid_type()
 {
@@ -232,3 +547,215 @@ memory_manager_ut::test_memory_manager_x64_virtint_to_attrint_nullptr()
     this->expect_exception([&] { g_mm->virtint_to_attrint(0); }, ""_ut_ffe);
     this->expect_exception([&] { g_mm->virtptr_to_attrint(nullptr); }, ""_ut_ffe);
 }
+
+void
+memory_manager_ut::test_memory_manager_x64_add_chunk_invalid()
+{
+    alignas(0x1000) static uint8_t chunk[0x1000];
+    auto &&virt = reinterpret_cast<uint64_t>(chunk);
+
+    memory_chunk chunk_zero = {0, sizeof(chunk), MEMORY_CHUNK_HEAP, MEMORY_CHUNK_ANY_NODE};
+    memory_chunk chunk_unaligned = {virt + 1, sizeof(chunk) - 1, MEMORY_CHUNK_HEAP, MEMORY_CHUNK_ANY_NODE};
+    memory_chunk chunk_empty = {virt, 0, MEMORY_CHUNK_HEAP, MEMORY_CHUNK_ANY_NODE};
+    memory_chunk chunk_type = {virt, sizeof(chunk), 0, MEMORY_CHUNK_ANY_NODE};
+    memory_chunk chunk_small_page = {virt, sizeof(chunk), MEMORY_CHUNK_PAGE, MEMORY_CHUNK_ANY_NODE};
+    memory_chunk chunk_small_reserve = {virt, sizeof(chunk), MEMORY_CHUNK_RESERVE, MEMORY_CHUNK_ANY_NODE};
+
+    auto &&num = g_mm->arena_stats().size();
+
+    this->expect_true(add_mem_chunk(nullptr) == MEMORY_MANAGER_FAILURE);
+    this->expect_true(add_mem_chunk(&chunk_zero) == MEMORY_MANAGER_FAILURE);
+    this->expect_true(add_mem_chunk(&chunk_unaligned) == MEMORY_MANAGER_FAILURE);
+    this->expect_true(add_mem_chunk(&chunk_empty) == MEMORY_MANAGER_FAILURE);
+    this->expect_true(add_mem_chunk(&chunk_type) == MEMORY_MANAGER_FAILURE);
+    this->expect_true(add_mem_chunk(&chunk_small_page) == MEMORY_MANAGER_FAILURE);
+    this->expect_true(add_mem_chunk(&chunk_small_reserve) == MEMORY_MANAGER_FAILURE);
+
+    this->expect_true(g_mm->arena_stats().size() == num);
+}
+
+void
+memory_manager_ut::test_memory_manager_x64_add_chunk_heap()
+{
+    constexpr const auto chunk_size = MAX_HEAP_POOL * 2;
+    alignas(0x1000) static uint8_t chunk[chunk_size];
+
+    auto &&virt = reinterpret_cast<uint64_t>(chunk);
+    memory_chunk heap_chunk = {virt, chunk_size, MEMORY_CHUNK_HEAP, MEMORY_CHUNK_ANY_NODE};
+
+    this->expect_true(add_mem_chunk(&heap_chunk) == MEMORY_MANAGER_SUCCESS);
+
+    auto &&stats = g_mm->arena_stats();
+    auto &&arena = std::find_if(stats.begin(), stats.end(), [&](const auto & s)
+    { return s.addr > virt && s.addr < virt + chunk_size; });
+
+    this->expect_true(arena != stats.end());
+    this->expect_true(arena->type == MEMORY_CHUNK_HEAP);
+
+    // Larger than the static heap pool, so only the new arena can hold it
+
+    auto &&size = MAX_HEAP_POOL + cache_line_size;
+    auto &&ptr = g_mm->alloc(size);
+    auto &&uintptr = reinterpret_cast<uint64_t>(ptr);
+
+    this->expect_true(uintptr >= arena->addr && uintptr < arena->addr + arena->size);
+    this->expect_true(g_mm->size(ptr) == size);
+
+    for (const auto &s : g_mm->arena_stats())
+    {
+        if (s.addr == arena->addr)
+            this->expect_true(s.used == size && s.peak == size);
+    }
+
+    g_mm->free(ptr);
+
+    for (const auto &s : g_mm->arena_stats())
+    {
+        if (s.addr == arena->addr)
+            this->expect_true(s.used == 0 && s.peak == size);
+    }
+}
+
+void
+memory_manager_ut::test_memory_manager_x64_add_chunk_node()
+{
+    constexpr const auto chunk_size = 0x40000ULL;
+    alignas(0x1000) static uint8_t chunk1[chunk_size];
+    alignas(0x1000) static uint8_t chunk2[chunk_size];
+
+    auto &&virt1 = reinterpret_cast<uint64_t>(chunk1);
+    auto &&virt2 = reinterpret_cast<uint64_t>(chunk2);
+
+    memory_chunk node1_chunk = {virt1, chunk_size, MEMORY_CHUNK_PAGE, 1};
+    memory_chunk node2_chunk = {virt2, chunk_size, MEMORY_CHUNK_PAGE, 2};
+
+    this->expect_true(add_mem_chunk(&node1_chunk) == MEMORY_MANAGER_SUCCESS);
+    this->expect_true(add_mem_chunk(&node2_chunk) == MEMORY_MANAGER_SUCCESS);
+
+    auto &&stats = g_mm->arena_stats();
+    auto &&node1 = std::find_if(stats.begin(), stats.end(), [&](const auto & s)
+    { return s.type == MEMORY_CHUNK_PAGE && s.node == 1; });
+
+    this->expect_true(node1 != stats.end());
+    this->expect_true(node1->addr > virt1 && node1->addr < virt1 + chunk_size);
+
+    auto &&in_chunk = [&](auto ptr, auto virt)
+    {
+        auto &&uintptr = reinterpret_cast<uint64_t>(ptr);
+        return uintptr >= virt && uintptr < virt + chunk_size;
+    };
+
+    // Simulate a CPU on each node
+
+    {
+        MockRepository mocks;
+        mocks.OnCallFunc(thread_context_node).Return(1);
+
+        RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+        {
+            auto &&ptr = g_mm->alloc(0x1000);
+            this->expect_true(in_chunk(ptr, virt1));
+            this->expect_true(g_mm->size(ptr) == 0x1000);
+            g_mm->free(ptr);
+
+            // Larger than the node's arena, so the shared page pool is used
+
+            auto &&large = g_mm->alloc(node1->size + 0x1000);
+            this->expect_true(large != nullptr);
+            this->expect_false(in_chunk(large, virt1));
+            g_mm->free(large);
+
+            // Heap allocations are not node local
+
+            auto &&heap = g_mm->alloc(0x10);
+            this->expect_false(in_chunk(heap, virt1));
+            g_mm->free(heap);
+        });
+    }
+
+    {
+        MockRepository mocks;
+        mocks.OnCallFunc(thread_context_node).Return(2);
+
+        RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+        {
+            auto &&ptr = g_mm->alloc(0x1000);
+            this->expect_true(in_chunk(ptr, virt2));
+            g_mm->free(ptr);
+        });
+    }
+
+    {
+        MockRepository mocks;
+        mocks.OnCallFunc(thread_context_node).Return(3);
+
+        RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+        {
+            auto &&ptr = g_mm->alloc(0x1000);
+            this->expect_true(ptr != nullptr);
+            this->expect_false(in_chunk(ptr, virt1));
+            this->expect_false(in_chunk(ptr, virt2));
+            g_mm->free(ptr);
+        });
+    }
+
+    // Frees and resizes do not depend on the node of the CPU
+
+    auto &&ptr = g_mm->alloc(0x1000);
+
+    {
+        MockRepository mocks;
+        mocks.OnCallFunc(thread_context_node).Return(1);
+
+        RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+        {
+            auto &&local = g_mm->alloc(0x1000);
+            this->expect_true(in_chunk(local, virt1));
+
+            g_mm->free(ptr);
+            this->expect_true(g_mm->realloc(local, 0x2000) == local);
+            this->expect_true(g_mm->size(local) == 0x2000);
+            g_mm->free(local);
+        });
+    }
+
+    this->expect_true(g_mm->size(ptr) == 0);
+}
+
+void
+memory_manager_ut::test_memory_manager_x64_add_chunk_reserve()
+{
+    constexpr const auto chunk_size = MAX_PAGE_POOL * 4;
+    alignas(0x1000) static uint8_t chunk[chunk_size];
+
+    auto &&virt = reinterpret_cast<uint64_t>(chunk);
+    memory_chunk reserve_chunk = {virt, chunk_size, MEMORY_CHUNK_RESERVE, MEMORY_CHUNK_ANY_NODE};
+
+    auto &&reserved = [&]
+    {
+        auto &&stats = g_mm->arena_stats();
+        return std::count_if(stats.begin(), stats.end(), [&](const auto & s)
+        { return s.type == MEMORY_CHUNK_RESERVE; });
+    };
+
+    auto &&num = reserved();
+    this->expect_true(add_mem_chunk(&reserve_chunk) == MEMORY_MANAGER_SUCCESS);
+    this->expect_true(reserved() == num + 1);
+
+    // Larger than any page arena, so the reserve chunk has to be used
+
+    auto &&size = MAX_PAGE_POOL * 2;
+    auto &&ptr = g_mm->alloc(size);
+    auto &&uintptr = reinterpret_cast<uint64_t>(ptr);
+
+    this->expect_true(uintptr > virt && uintptr < virt + chunk_size);
+    this->expect_true(g_mm->size(ptr) == size);
+    this->expect_true(reserved() == num);
+
+    g_mm->free(ptr);
+    this->expect_true(g_mm->size(ptr) == 0);
+
+    // Nothing left in the reserve that is this large
+
+    this->expect_true(g_mm->alloc(chunk_size) == nullptr);
+}
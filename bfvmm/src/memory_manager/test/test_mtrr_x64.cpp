@@ -0,0 +1,176 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#include <map>
+
+#include <test.h>
+#include <memory_manager/mtrr_x64.h>
+
+#include <intrinsics/x64.h>
+#include <intrinsics/msrs_x64.h>
+
+using namespace x64;
+
+std::map<uint32_t, uint64_t> g_mm_msrs;
+uint32_t g_mm_phys_bits = 39;
+
+extern "C" uint64_t
+__read_msr(uint32_t addr) noexcept
+{ return g_mm_msrs[addr]; }
+
+extern "C" uint32_t
+__cpuid_eax(uint32_t val) noexcept
+{ (void) val; return g_mm_phys_bits; }
+
+static void
+set_variable_range(uint64_t index, uint64_t base, uint64_t size, uint64_t type)
+{
+    auto &&mask = ~(size - 1) & ((1ULL << g_mm_phys_bits) - 1);
+
+    g_mm_msrs[msrs::ia32_mtrr_physbase::addr(index)] = base | type;
+    g_mm_msrs[msrs::ia32_mtrr_physmask::addr(index)] = mask | msrs::ia32_mtrr_physmask::valid::mask;
+}
+
+void
+setup_mtrrs()
+{
+    // - 0x00000 - 0x9FFFF: WB (fixed)
+    // - 0xA0000 - 0xBFFFF: UC (fixed)
+    // - 0xC0000 - 0xC7FFF: UC (fixed)
+    // - 0xC8000 - 0xFFFFF: WP (fixed)
+    // - 0xC0000000 - 0xFFFFFFFF: UC
+    // - 0x200000000 - 0x2001FFFFF: WT + WB = WT
+    // - 0x300000000 - 0x300000FFF: WC + WP = UC
+    // - 0x300001000 - 0x33FFFFFFF: WC
+    // - everything else: WB (default)
+
+    g_mm_msrs.clear();
+    g_mm_phys_bits = 39;
+
+    g_mm_msrs[msrs::ia32_mtrrcap::addr] = 0x508;
+    g_mm_msrs[msrs::ia32_mtrr_def_type::addr] = 0xC06;
+
+    g_mm_msrs[msrs::ia32_mtrr_fix64k_00000::addr] = 0x0606060606060606;
+    g_mm_msrs[msrs::ia32_mtrr_fix16k_80000::addr] = 0x0606060606060606;
+    g_mm_msrs[msrs::ia32_mtrr_fix16k_a0000::addr] = 0x0000000000000000;
+
+    for (auto i = 0U; i < 8; i++)
+        g_mm_msrs[msrs::ia32_mtrr_fix4k::addr(i)] = 0x0505050505050505;
+
+    g_mm_msrs[msrs::ia32_mtrr_fix4k::addr(0)] = 0x0000000000000000;
+
+    set_variable_range(0, 0xC0000000, 0x40000000, memory_type::uncacheable);
+    set_variable_range(1, 0x200000000, 0x40000000, memory_type::write_back);
+    set_variable_range(2, 0x200000000, 0x200000, memory_type::write_through);
+    set_variable_range(3, 0x300000000, 0x40000000, memory_type::write_combining);
+    set_variable_range(4, 0x300000000, 0x1000, memory_type::write_protected);
+
+    // Disabled range (valid bit not set)
+
+    g_mm_msrs[msrs::ia32_mtrr_physbase::addr(5)] = 0x400000000;
+    g_mm_msrs[msrs::ia32_mtrr_physmask::addr(5)] = 0x7FC0000000;
+}
+
+void
+memory_manager_ut::test_mtrr_x64_disabled()
+{
+    setup_mtrrs();
+    g_mm_msrs[msrs::ia32_mtrr_def_type::addr] = 0x406;
+
+    auto &&mtrrs = mtrr_x64{};
+
+    this->expect_false(mtrrs.enabled());
+    this->expect_true(mtrrs.mem_type(0x0) == memory_type::uncacheable);
+    this->expect_true(mtrrs.mem_type(0x100000000) == memory_type::uncacheable);
+    this->expect_true(mtrrs.uniform(0x0, 0x8000000000));
+}
+
+void
+memory_manager_ut::test_mtrr_x64_fixed()
+{
+    setup_mtrrs();
+    auto &&mtrrs = mtrr_x64{};
+
+    this->expect_true(mtrrs.enabled());
+    this->expect_true(mtrrs.mem_type(0x00000) == memory_type::write_back);
+    this->expect_true(mtrrs.mem_type(0x9FFFF) == memory_type::write_back);
+    this->expect_true(mtrrs.mem_type(0xA0000) == memory_type::uncacheable);
+    this->expect_true(mtrrs.mem_type(0xBFFFF) == memory_type::uncacheable);
+    this->expect_true(mtrrs.mem_type(0xC7FFF) == memory_type::uncacheable);
+    this->expect_true(mtrrs.mem_type(0xC8000) == memory_type::write_protected);
+    this->expect_true(mtrrs.mem_type(0xFFFFF) == memory_type::write_protected);
+    this->expect_true(mtrrs.mem_type(0x100000) == memory_type::write_back);
+
+    g_mm_msrs[msrs::ia32_mtrr_def_type::addr] = 0x806;
+    auto &&no_fixed = mtrr_x64{};
+
+    this->expect_true(no_fixed.mem_type(0xA0000) == memory_type::write_back);
+    this->expect_true(no_fixed.uniform(0x0, 0x40000000));
+}
+
+void
+memory_manager_ut::test_mtrr_x64_variable()
+{
+    setup_mtrrs();
+    auto &&mtrrs = mtrr_x64{};
+
+    this->expect_true(mtrrs.mem_type(0xBFFFFFFF) == memory_type::write_back);
+    this->expect_true(mtrrs.mem_type(0xC0000000) == memory_type::uncacheable);
+    this->expect_true(mtrrs.mem_type(0xFFFFFFFF) == memory_type::uncacheable);
+    this->expect_true(mtrrs.mem_type(0x100000000) == memory_type::write_back);
+    this->expect_true(mtrrs.mem_type(0x200000000) == memory_type::write_through);
+    this->expect_true(mtrrs.mem_type(0x2001FFFFF) == memory_type::write_through);
+    this->expect_true(mtrrs.mem_type(0x200200000) == memory_type::write_back);
+    this->expect_true(mtrrs.mem_type(0x300000000) == memory_type::uncacheable);
+    this->expect_true(mtrrs.mem_type(0x300001000) == memory_type::write_combining);
+    this->expect_true(mtrrs.mem_type(0x33FFFFFFF) == memory_type::write_combining);
+    this->expect_true(mtrrs.mem_type(0x340000000) == memory_type::write_back);
+    this->expect_true(mtrrs.mem_type(0x400000000) == memory_type::write_back);
+
+    this->expect_no_exception([&] { mtrrs.dump(); });
+}
+
+void
+memory_manager_ut::test_mtrr_x64_uniform()
+{
+    setup_mtrrs();
+    auto &&mtrrs = mtrr_x64{};
+
+    this->expect_false(mtrrs.uniform(0x0, 0x40000000));
+    this->expect_false(mtrrs.uniform(0x0, 0x200000));
+    this->expect_true(mtrrs.uniform(0x0, 0xA0000));
+    this->expect_true(mtrrs.uniform(0x100000, 0x100000));
+    this->expect_true(mtrrs.uniform(0x200000, 0x200000));
+    this->expect_true(mtrrs.uniform(0x40000000, 0x40000000));
+    this->expect_true(mtrrs.uniform(0x80000000, 0x40000000));
+    this->expect_false(mtrrs.uniform(0x80000000, 0x80000000));
+    this->expect_true(mtrrs.uniform(0xC0000000, 0x40000000));
+    this->expect_true(mtrrs.uniform(0x100000000, 0x100000000));
+    this->expect_false(mtrrs.uniform(0x200000000, 0x40000000));
+    this->expect_true(mtrrs.uniform(0x200000000, 0x200000));
+    this->expect_true(mtrrs.uniform(0x200200000, 0x3FE00000));
+    this->expect_false(mtrrs.uniform(0x300000000, 0x200000));
+    this->expect_true(mtrrs.uniform(0x300001000, 0x1000));
+    this->expect_true(mtrrs.uniform(0x400000000, 0x7C00000000));
+
+    this->expect_exception([&] { mtrrs.uniform(0x0, 0x0); }, ""_ut_ffe);
+}
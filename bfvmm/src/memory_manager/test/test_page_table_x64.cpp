@@ -21,6 +21,9 @@
 
 #include <gsl/gsl>
 
+#include <chrono>
+#include <iostream>
+
 #include <test.h>
 #include <memory_manager/page_table_x64.h>
 #include <memory_manager/memory_manager_x64.h>
@@ -52,27 +55,27 @@ memory_manager_ut::test_page_table_x64_add_remove_page_success_without_setting()
 
         pml4->add_page_4k(virt);
         this->expect_true(pml4->global_size() == 3);
-        this->expect_true(pml4->global_capacity() == 512 * 3);
+        this->expect_true(pml4->global_nodes() == 4);
 
         pml4->add_page_4k(virt + 0x1000);
         this->expect_true(pml4->global_size() == 3);
-        this->expect_true(pml4->global_capacity() == 512 * 3);
+        this->expect_true(pml4->global_nodes() == 4);
 
         pml4->add_page_4k(virt + 0x10000);
         this->expect_true(pml4->global_size() == 3);
-        this->expect_true(pml4->global_capacity() == 512 * 3);
+        this->expect_true(pml4->global_nodes() == 4);
 
         pml4->remove_page(virt);
-        this->expect_true(pml4->global_size() == 0);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_size() == 3);
+        this->expect_true(pml4->global_nodes() == 4);
 
         pml4->remove_page(virt + 0x1000);
-        this->expect_true(pml4->global_size() == 0);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_size() == 3);
+        this->expect_true(pml4->global_nodes() == 4);
 
         pml4->remove_page(virt + 0x10000);
         this->expect_true(pml4->global_size() == 0);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_nodes() == 1);
     });
 }
 
@@ -90,34 +93,34 @@ memory_manager_ut::test_page_table_x64_add_remove_page_1g_success()
         auto &&entry1 = pml4->add_page_1g(virt);
         entry1.set_present(true);
         this->expect_true(pml4->global_size() == 2);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_nodes() == 2);
 
         auto &&entry2 = pml4->add_page_1g(virt + 0x100);
         entry2.set_present(true);
         this->expect_true(pml4->global_size() == 2);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_nodes() == 2);
 
         auto &&entry3 = pml4->add_page_1g(virt + 0x40000000);
         entry3.set_present(true);
         this->expect_true(pml4->global_size() == 3);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_nodes() == 2);
 
         auto &&entry4 = pml4->add_page_1g(virt + 0x400000000);
         entry4.set_present(true);
         this->expect_true(pml4->global_size() == 4);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_nodes() == 2);
 
         pml4->remove_page(virt);
         this->expect_true(pml4->global_size() == 3);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_nodes() == 2);
 
         pml4->remove_page(virt + 0x40000000);
         this->expect_true(pml4->global_size() == 2);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_nodes() == 2);
 
         pml4->remove_page(virt + 0x400000000);
         this->expect_true(pml4->global_size() == 0);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_nodes() == 1);
     });
 }
 
@@ -135,34 +138,34 @@ memory_manager_ut::test_page_table_x64_add_remove_page_2m_success()
         auto &&entry1 = pml4->add_page_2m(virt);
         entry1.set_present(true);
         this->expect_true(pml4->global_size() == 3);
-        this->expect_true(pml4->global_capacity() == 512 * 2);
+        this->expect_true(pml4->global_nodes() == 3);
 
         auto &&entry2 = pml4->add_page_2m(virt + 0x100);
         entry2.set_present(true);
         this->expect_true(pml4->global_size() == 3);
-        this->expect_true(pml4->global_capacity() == 512 * 2);
+        this->expect_true(pml4->global_nodes() == 3);
 
         auto &&entry3 = pml4->add_page_2m(virt + 0x200000);
         entry3.set_present(true);
         this->expect_true(pml4->global_size() == 4);
-        this->expect_true(pml4->global_capacity() == 512 * 2);
+        this->expect_true(pml4->global_nodes() == 3);
 
         auto &&entry4 = pml4->add_page_2m(virt + 0x2000000);
         entry4.set_present(true);
         this->expect_true(pml4->global_size() == 5);
-        this->expect_true(pml4->global_capacity() == 512 * 2);
+        this->expect_true(pml4->global_nodes() == 3);
 
         pml4->remove_page(virt);
         this->expect_true(pml4->global_size() == 4);
-        this->expect_true(pml4->global_capacity() == 512 * 2);
+        this->expect_true(pml4->global_nodes() == 3);
 
         pml4->remove_page(virt + 0x200000);
         this->expect_true(pml4->global_size() == 3);
-        this->expect_true(pml4->global_capacity() == 512 * 2);
+        this->expect_true(pml4->global_nodes() == 3);
 
         pml4->remove_page(virt + 0x2000000);
         this->expect_true(pml4->global_size() == 0);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_nodes() == 1);
     });
 }
 
@@ -180,34 +183,34 @@ memory_manager_ut::test_page_table_x64_add_remove_page_4k_success()
         auto &&entry1 = pml4->add_page_4k(virt);
         entry1.set_present(true);
         this->expect_true(pml4->global_size() == 4);
-        this->expect_true(pml4->global_capacity() == 512 * 3);
+        this->expect_true(pml4->global_nodes() == 4);
 
         auto &&entry2 = pml4->add_page_4k(virt + 0x100);
         entry2.set_present(true);
         this->expect_true(pml4->global_size() == 4);
-        this->expect_true(pml4->global_capacity() == 512 * 3);
+        this->expect_true(pml4->global_nodes() == 4);
 
         auto &&entry3 = pml4->add_page_4k(virt + 0x1000);
         entry3.set_present(true);
         this->expect_true(pml4->global_size() == 5);
-        this->expect_true(pml4->global_capacity() == 512 * 3);
+        this->expect_true(pml4->global_nodes() == 4);
 
         auto &&entry4 = pml4->add_page_4k(virt + 0x10000);
         entry4.set_present(true);
         this->expect_true(pml4->global_size() == 6);
-        this->expect_true(pml4->global_capacity() == 512 * 3);
+        this->expect_true(pml4->global_nodes() == 4);
 
         pml4->remove_page(virt);
         this->expect_true(pml4->global_size() == 5);
-        this->expect_true(pml4->global_capacity() == 512 * 3);
+        this->expect_true(pml4->global_nodes() == 4);
 
         pml4->remove_page(virt + 0x1000);
         this->expect_true(pml4->global_size() == 4);
-        this->expect_true(pml4->global_capacity() == 512 * 3);
+        this->expect_true(pml4->global_nodes() == 4);
 
         pml4->remove_page(virt + 0x10000);
         this->expect_true(pml4->global_size() == 0);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_nodes() == 1);
     });
 }
 
@@ -225,39 +228,39 @@ memory_manager_ut::test_page_table_x64_add_remove_page_swap_success()
         auto &&entry1 = pml4->add_page_4k(virt);
         entry1.set_present(true);
         this->expect_true(pml4->global_size() == 4);
-        this->expect_true(pml4->global_capacity() == 512 * 3);
+        this->expect_true(pml4->global_nodes() == 4);
 
         pml4->remove_page(virt);
         this->expect_true(pml4->global_size() == 0);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_nodes() == 1);
 
         auto &&entry2 = pml4->add_page_2m(virt);
         entry2.set_present(true);
         this->expect_true(pml4->global_size() == 3);
-        this->expect_true(pml4->global_capacity() == 512 * 2);
+        this->expect_true(pml4->global_nodes() == 3);
 
         pml4->remove_page(virt);
         this->expect_true(pml4->global_size() == 0);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_nodes() == 1);
 
         auto &&entry3 = pml4->add_page_4k(virt);
         entry3.set_present(true);
         this->expect_true(pml4->global_size() == 4);
-        this->expect_true(pml4->global_capacity() == 512 * 3);
+        this->expect_true(pml4->global_nodes() == 4);
 
         auto &&entry4 = pml4->add_page_2m(virt);
         entry4.set_present(true);
         this->expect_true(pml4->global_size() == 3);
-        this->expect_true(pml4->global_capacity() == 512 * 2);
+        this->expect_true(pml4->global_nodes() == 3);
 
         auto &&entry5 = pml4->add_page_4k(virt);
         entry5.set_present(true);
         this->expect_true(pml4->global_size() == 4);
-        this->expect_true(pml4->global_capacity() == 512 * 3);
+        this->expect_true(pml4->global_nodes() == 4);
 
         pml4->remove_page(virt);
         this->expect_true(pml4->global_size() == 0);
-        this->expect_true(pml4->global_capacity() == 512 * 1);
+        this->expect_true(pml4->global_nodes() == 1);
     });
 }
 
@@ -375,3 +378,113 @@ memory_manager_ut::test_page_table_x64_pt_to_mdl_success()
         this->expect_true(pml4->global_size() == 0);
     });
 }
+
+void
+memory_manager_ut::test_page_table_x64_add_page_twice_counted_once()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&scr3 = 0x0UL;
+        auto &&pml4 = std::make_unique<page_table_x64>(&scr3);
+
+        pml4->add_page_4k(virt).set_present(true);
+        pml4->add_page_4k(virt).set_present(true);
+        this->expect_true(pml4->global_nodes() == 4);
+
+        pml4->remove_page(virt);
+        this->expect_true(pml4->global_size() == 0);
+        this->expect_true(pml4->global_nodes() == 1);
+        this->expect_true(pml4->empty());
+    });
+}
+
+void
+memory_manager_ut::test_page_table_x64_memory_usage()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&scr3 = 0x0UL;
+        auto &&pml4 = std::make_unique<page_table_x64>(&scr3);
+
+        for (auto i = 0UL; i < x64::page_table::num_entries; i++)
+            pml4->add_page_4k(virt + (i * x64::page_table::pt::size_bytes)).set_present(true);
+
+        this->expect_true(pml4->global_nodes() == 4);
+        this->expect_true(pml4->global_bytes() < pml4->global_nodes() * (x64::page_table::num_bytes + 0x100));
+
+        for (auto i = 0UL; i < x64::page_table::num_entries; i++)
+            pml4->remove_page(virt + (i * x64::page_table::pt::size_bytes));
+
+        this->expect_true(pml4->global_nodes() == 1);
+        this->expect_true(pml4->empty());
+    });
+}
+
+void
+memory_manager_ut::test_page_table_x64_map_unmap_many()
+{
+    constexpr const auto num_pages = 0x10000UL;
+
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&scr3 = 0x0UL;
+        auto &&pml4 = std::make_unique<page_table_x64>(&scr3);
+
+        for (auto i = 0UL; i < num_pages; i++)
+            pml4->add_page_4k(virt + (i * x64::page_table::pt::size_bytes)).set_present(true);
+
+        this->expect_true(pml4->global_nodes() > num_pages / x64::page_table::num_entries);
+
+        for (auto i = 0UL; i < num_pages; i++)
+            pml4->remove_page(virt + (i * x64::page_table::pt::size_bytes));
+
+        this->expect_true(pml4->global_nodes() == 1);
+        this->expect_true(pml4->empty());
+    });
+}
+
+void
+memory_manager_ut::benchmark_page_table_x64_map_unmap()
+{
+    constexpr const auto num_pages = 0x10000UL;
+
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&scr3 = 0x0UL;
+        auto &&pml4 = std::make_unique<page_table_x64>(&scr3);
+
+        auto &&start = std::chrono::steady_clock::now();
+        for (auto i = 0UL; i < num_pages; i++)
+            pml4->add_page_4k(virt + (i * x64::page_table::pt::size_bytes)).set_present(true);
+        auto &&end = std::chrono::steady_clock::now();
+
+        auto &&ns_map = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        auto &&nodes = pml4->global_nodes();
+        auto &&bytes = pml4->global_bytes();
+
+        start = std::chrono::steady_clock::now();
+        for (auto i = 0UL; i < num_pages; i++)
+            pml4->remove_page(virt + (i * x64::page_table::pt::size_bytes));
+        end = std::chrono::steady_clock::now();
+
+        auto &&ns_unmap = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        std::cout << "page table: " << num_pages << " x 4k pages: "
+                  << ns_map / static_cast<long long>(num_pages) << " ns per map, "
+                  << ns_unmap / static_cast<long long>(num_pages) << " ns per unmap, "
+                  << nodes << " tables using " << bytes << " bytes" << std::endl;
+    });
+}
@@ -0,0 +1,589 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#include <gsl/gsl>
+
+#include <map>
+#include <chrono>
+#include <iostream>
+
+#include <test.h>
+#include <memory_manager/ept_intel_x64.h>
+#include <memory_manager/root_ept_intel_x64.h>
+#include <memory_manager/memory_manager_x64.h>
+
+#include <intrinsics/msrs_intel_x64.h>
+
+using namespace x64;
+using namespace intel_x64;
+
+extern bool g_ept_terminate_called;
+extern std::map<uint32_t, uint64_t> g_mm_msrs;
+extern uint32_t g_mm_phys_bits;
+
+void setup_mtrrs();
+
+constexpr const auto size_1g = page_table::pdpt::size_bytes;
+constexpr const auto size_2m = page_table::pd::size_bytes;
+constexpr const auto size_4k = page_table::pt::size_bytes;
+
+static auto
+setup_mm(MockRepository &mocks)
+{
+    auto mm = mocks.Mock<memory_manager_x64>();
+    mocks.OnCallFunc(memory_manager_x64::instance).Return(mm);
+    mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Return(0x0000000ABCDEF0000);
+
+    return mm;
+}
+
+static void
+setup_ept_cap(bool large_1g)
+{
+    setup_mtrrs();
+
+    if (large_1g)
+        g_mm_msrs[msrs::ia32_vmx_ept_vpid_cap::addr] = msrs::ia32_vmx_ept_vpid_cap::pdpte_1gb_support::mask;
+}
+
+void
+memory_manager_ut::test_ept_intel_x64_add_remove_page()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&eptp = 0x0UL;
+        auto &&pml4 = std::make_unique<ept_intel_x64>(&eptp);
+
+        this->expect_true(eptp == 0x0000000ABCDEF0007);
+
+        pml4->add_page_1g(0x40000000).set_access(ept::read_write_execute);
+        pml4->add_page_2m(0x80000000).set_access(ept::read_write_execute);
+        pml4->add_page_4k(0xC0000000).set_access(ept::read_write_execute);
+
+        this->expect_true(pml4->gpa_to_page_size(0x40001000) == size_1g);
+        this->expect_true(pml4->gpa_to_page_size(0x80001000) == size_2m);
+        this->expect_true(pml4->gpa_to_page_size(0xC0000000) == size_4k);
+
+        this->expect_true(pml4->global_pages(page_table::pdpt::from) == 1);
+        this->expect_true(pml4->global_pages(page_table::pd::from) == 1);
+        this->expect_true(pml4->global_pages(page_table::pt::from) == 1);
+        this->expect_true(pml4->global_nodes() == 5);
+
+        this->expect_exception([&] { pml4->gpa_to_epte(0xC0001000); }, ""_ut_ree);
+        this->expect_exception([&] { pml4->gpa_to_page_size(0x100000000); }, ""_ut_ree);
+
+        pml4->remove_page(0x40000000);
+        pml4->remove_page(0x80000000);
+        pml4->remove_page(0xC0000000);
+
+        this->expect_true(pml4->global_nodes() == 1);
+        this->expect_true(pml4->empty());
+    });
+}
+
+void
+memory_manager_ut::test_ept_intel_x64_split_1g()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&eptp = 0x0UL;
+        auto &&pml4 = std::make_unique<ept_intel_x64>(&eptp);
+
+        {
+            auto &&entry = pml4->add_page_1g(0x40000000);
+            entry.set_phys_addr(0x140000000);
+            entry.set_access(ept::read_execute);
+            entry.set_memory_type(memory_type::write_back);
+            entry.set_entry_type(true);
+        }
+
+        // Splitting a 1g page into 2m pages, and one of them into 4k pages
+        // keeps the translation, access rights and memory type of the rest of
+        // the 1g page.
+
+        pml4->add_page_4k(0x40201000).set_access(ept::read);
+
+        this->expect_true(pml4->global_pages(page_table::pdpt::from) == 0);
+        this->expect_true(pml4->global_pages(page_table::pd::from) == 511);
+        this->expect_true(pml4->global_pages(page_table::pt::from) == 512);
+
+        auto &&large = pml4->gpa_to_epte(0x7FE00000);
+        this->expect_true(pml4->gpa_to_page_size(0x7FE00000) == size_2m);
+        this->expect_true(large.phys_addr() == 0x17FE00000);
+        this->expect_true(large.access() == ept::read_execute);
+        this->expect_true(large.memory_type() == memory_type::write_back);
+        this->expect_true(large.entry_type());
+
+        auto &&small = pml4->gpa_to_epte(0x40200000);
+        this->expect_true(pml4->gpa_to_page_size(0x40200000) == size_4k);
+        this->expect_true(small.phys_addr() == 0x140200000);
+        this->expect_true(small.access() == ept::read_execute);
+        this->expect_true(small.memory_type() == memory_type::write_back);
+        this->expect_false(small.entry_type());
+
+        auto &&split = pml4->gpa_to_epte(0x40201000);
+        this->expect_true(split.phys_addr() == 0x140201000);
+        this->expect_true(split.access() == ept::read);
+
+        // Adding a 1g page over the split page replaces the tables
+
+        pml4->add_page_1g(0x40000000).clear();
+        this->expect_true(pml4->gpa_to_page_size(0x40201000) == size_1g);
+        this->expect_true(pml4->global_nodes() == 2);
+
+        pml4->remove_page(0x40000000);
+        this->expect_true(pml4->empty());
+    });
+}
+
+void
+memory_manager_ut::test_ept_intel_x64_memory_usage()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&eptp = 0x0UL;
+        auto &&pml4 = std::make_unique<ept_intel_x64>(&eptp);
+
+        for (auto i = 0UL; i < page_table::num_entries; i++)
+            pml4->add_page_1g(i * size_1g).set_access(ept::read_write_execute);
+
+        this->expect_true(pml4->global_nodes() == 2);
+        this->expect_true(pml4->global_bytes() < pml4->global_nodes() * (page_table::num_bytes + 0x100));
+
+        for (auto i = 0UL; i < page_table::num_entries; i++)
+            pml4->remove_page(i * size_1g);
+
+        this->expect_true(pml4->global_nodes() == 1);
+        this->expect_true(pml4->empty());
+    });
+}
+
+void
+memory_manager_ut::test_root_ept_intel_x64_init_failure()
+{
+    MockRepository mocks;
+    auto &&mm = setup_mm(mocks);
+
+    auto &&calls = 0;
+    mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Do([&](void *) -> uintptr_t
+    {
+        if (++calls > 2)
+            throw std::runtime_error("error");
+
+        return 0x0000000ABCDEF0000;
+    });
+
+    setup_ept_cap(true);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&] { root_ept(); });
+        this->expect_true(g_ept_terminate_called);
+    });
+}
+
+void
+memory_manager_ut::test_root_ept_intel_x64_init_success()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+    setup_ept_cap(true);
+
+    // The identity map covers the entire physical address width, which is
+    // more than a single PML4 entry (512GB) can map
+
+    g_mm_phys_bits = 40;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        this->expect_no_exception([&] { root_ept(); });
+        this->expect_true(g_ept->eptp() == 0x0000000ABCDEF001E);
+        this->expect_true(g_ept->gpa_to_page_size(0x40000000) == size_1g);
+        this->expect_true(g_ept->gpa_to_page_size(0x7FC0000000) == size_1g);
+        this->expect_true(g_ept->gpa_to_page_size(0x8000000000) == size_1g);
+        this->expect_true(g_ept->gpa_to_page_size(0xFFC0000000) == size_1g);
+        this->expect_true(g_ept->gpa_to_page_size(0xA0000) == size_4k);
+        this->expect_exception([&] { g_ept->gpa_to_page_size(0x10000000000); }, ""_ut_ree);
+    });
+}
+
+void
+memory_manager_ut::test_root_ept_intel_x64_eptp()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+    auto &&ept = root_ept_intel_x64{};
+
+    this->expect_true(ept.eptp() == 0x0000000ABCDEF001E);
+}
+
+void
+memory_manager_ut::test_root_ept_intel_x64_map()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ept = root_ept_intel_x64{};
+
+        ept.map_1g(0x40001000, 0x80001000, ept::read_write_execute, memory_type::write_back);
+        ept.map_2m(0x200000, 0x400000, ept::read_execute, memory_type::uncacheable);
+        ept.map_4k(0x1000, 0x2000, ept::read, memory_type::write_combining);
+
+        {
+            auto &&entry = ept.gpa_to_epte(0x40000000);
+            this->expect_true(entry.phys_addr() == 0x80000000);
+            this->expect_true(entry.access() == ept::read_write_execute);
+            this->expect_true(entry.memory_type() == memory_type::write_back);
+            this->expect_true(entry.entry_type());
+            this->expect_false(entry.ignore_pat());
+        }
+
+        {
+            auto &&entry = ept.gpa_to_epte(0x200000);
+            this->expect_true(entry.phys_addr() == 0x400000);
+            this->expect_true(entry.access() == ept::read_execute);
+            this->expect_true(entry.memory_type() == memory_type::uncacheable);
+            this->expect_true(entry.entry_type());
+        }
+
+        {
+            auto &&entry = ept.gpa_to_epte(0x1000);
+            this->expect_true(entry.phys_addr() == 0x2000);
+            this->expect_true(entry.access() == ept::read);
+            this->expect_true(entry.memory_type() == memory_type::write_combining);
+            this->expect_false(entry.entry_type());
+        }
+
+        this->expect_true(ept.pages(size_1g) == 1);
+        this->expect_true(ept.pages(size_2m) == 1);
+        this->expect_true(ept.pages(size_4k) == 1);
+        this->expect_true(ept.tables() == 4);
+        this->expect_exception([&] { ept.pages(0x1234); }, ""_ut_lee);
+        this->expect_no_exception([&] { ept.dump(); });
+
+        this->expect_exception([&] { ept.map_4k(0x3000, 0x3000, ept::read, memory_type::uncacheable_minus); }, ""_ut_lee);
+        this->expect_exception([&] { ept.gpa_to_epte(0x3000); }, ""_ut_ree);
+
+        ept.unmap(0x40000000);
+        ept.unmap(0x200000);
+        ept.unmap(0x1000);
+        ept.unmap(0x1000);
+
+        this->expect_true(ept.tables() == 1);
+    });
+}
+
+void
+memory_manager_ut::test_root_ept_intel_x64_setup_identity_map_invalid()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+    setup_ept_cap(true);
+
+    auto &&ept = root_ept_intel_x64{};
+    auto &&mtrrs = mtrr_x64{};
+
+    this->expect_exception([&] { ept.setup_identity_map(mtrrs, 0x10, 0x40000000); }, ""_ut_ffe);
+    this->expect_exception([&] { ept.setup_identity_map(mtrrs, 0x0, 0x40000010); }, ""_ut_ffe);
+    this->expect_exception([&] { ept.setup_identity_map(mtrrs, 0x40000000, 0x40000000); }, ""_ut_ffe);
+}
+
+void
+memory_manager_ut::test_root_ept_intel_x64_setup_identity_map_1g()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+    setup_ept_cap(true);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ept = root_ept_intel_x64{};
+        ept.setup_identity_map(mtrr_x64{}, 0x0, 0x400000000);
+
+        // See setup_mtrrs(). 1g pages are used, except for the 1g pages at
+        // 0x0 (fixed ranges), 0x200000000 (WT) and 0x300000000 (UC / WC),
+        // which are split into 2m pages, and their first 2m page (except
+        // at 0x200000000, which is WT) is split into 4k pages.
+
+        this->expect_true(ept.pages(size_1g) == 13);
+        this->expect_true(ept.pages(size_2m) == 511 + 512 + 511);
+        this->expect_true(ept.pages(size_4k) == 512 + 512);
+
+        auto &&check = [&](auto gpa, auto size, auto type)
+        {
+            auto &&entry = ept.gpa_to_epte(gpa);
+
+            this->expect_true(ept.gpa_to_page_size(gpa) == size);
+            this->expect_true(entry.phys_addr() == (gpa & ~(size - 1)));
+            this->expect_true(entry.access() == ept::read_write_execute);
+            this->expect_true(entry.memory_type() == type);
+        };
+
+        check(0x00000UL, size_4k, memory_type::write_back);
+        check(0xA0000UL, size_4k, memory_type::uncacheable);
+        check(0xC8000UL, size_4k, memory_type::write_protected);
+        check(0x100000UL, size_4k, memory_type::write_back);
+        check(0x200000UL, size_2m, memory_type::write_back);
+        check(0x40000000UL, size_1g, memory_type::write_back);
+        check(0xC0000000UL, size_1g, memory_type::uncacheable);
+        check(0x100000000UL, size_1g, memory_type::write_back);
+        check(0x200000000UL, size_2m, memory_type::write_through);
+        check(0x200200000UL, size_2m, memory_type::write_back);
+        check(0x300000000UL, size_4k, memory_type::uncacheable);
+        check(0x300001000UL, size_4k, memory_type::write_combining);
+        check(0x300200000UL, size_2m, memory_type::write_combining);
+        check(0x3C0000000UL, size_1g, memory_type::write_back);
+
+        this->expect_exception([&] { ept.gpa_to_epte(0x400000000); }, ""_ut_ree);
+    });
+}
+
+void
+memory_manager_ut::test_root_ept_intel_x64_setup_identity_map_2m()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+    setup_ept_cap(false);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ept = root_ept_intel_x64{};
+        ept.setup_identity_map(mtrr_x64{}, 0x0, 0x100000000);
+
+        this->expect_true(ept.pages(size_1g) == 0);
+        this->expect_true(ept.pages(size_2m) == 2047);
+        this->expect_true(ept.pages(size_4k) == 512);
+
+        this->expect_true(ept.gpa_to_page_size(0x40000000) == size_2m);
+        this->expect_true(ept.gpa_to_epte(0xC0000000).memory_type() == memory_type::uncacheable);
+    });
+}
+
+void
+memory_manager_ut::test_root_ept_intel_x64_set_access()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+    setup_ept_cap(true);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ept = root_ept_intel_x64{};
+        ept.setup_identity_map(mtrr_x64{}, 0x40000000, 0x100000000);
+
+        this->expect_true(ept.pages(size_1g) == 3);
+
+        // Whole pages are not split
+
+        ept.set_access(0x40000000, size_1g, ept::read_execute);
+        this->expect_true(ept.pages(size_1g) == 3);
+        this->expect_true(ept.gpa_to_epte(0x40000000).access() == ept::read_execute);
+
+        // Part of a page is split down to the largest pages that fit
+
+        ept.set_access(0x80201000, size_4k, ept::read);
+        this->expect_true(ept.pages(size_1g) == 2);
+        this->expect_true(ept.pages(size_2m) == 511);
+        this->expect_true(ept.pages(size_4k) == 512);
+
+        this->expect_true(ept.gpa_to_epte(0x80201000).access() == ept::read);
+        this->expect_true(ept.gpa_to_epte(0x80200000).access() == ept::read_write_execute);
+        this->expect_true(ept.gpa_to_epte(0x80200000).phys_addr() == 0x80200000);
+        this->expect_true(ept.gpa_to_epte(0x80000000).access() == ept::read_write_execute);
+        this->expect_true(ept.gpa_to_epte(0x80000000).memory_type() == memory_type::write_back);
+
+        ept.set_access(0x80400000, size_2m * 2, ept::none);
+        this->expect_true(ept.pages(size_2m) == 511);
+        this->expect_true(ept.gpa_to_epte(0x80600000).access() == ept::none);
+
+        this->expect_exception([&] { ept.set_access(0x80000010, size_4k, ept::read); }, ""_ut_ffe);
+        this->expect_exception([&] { ept.set_access(0x80000000, 0x10, ept::read); }, ""_ut_ffe);
+        this->expect_exception([&] { ept.set_access(0x80000000, 0x0, ept::read); }, ""_ut_ffe);
+        this->expect_exception([&] { ept.set_access(0x0, size_4k, ept::read); }, ""_ut_ree);
+    });
+}
+
+void
+memory_manager_ut::test_root_ept_intel_x64_split_4k()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+    setup_ept_cap(true);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ept = root_ept_intel_x64{};
+        ept.setup_identity_map(mtrr_x64{}, 0x40000000, 0x80000000);
+
+        this->expect_true(ept.pages(size_1g) == 1);
+
+        ept.split_4k(0x40200000, size_2m + size_4k);
+        this->expect_true(ept.pages(size_1g) == 0);
+        this->expect_true(ept.pages(size_2m) == 510);
+        this->expect_true(ept.pages(size_4k) == 1024);
+
+        this->expect_true(ept.gpa_to_page_size(0x40400000) == size_4k);
+        this->expect_true(ept.gpa_to_epte(0x40400000).phys_addr() == 0x40400000);
+        this->expect_true(ept.gpa_to_epte(0x40400000).access() == ept::read_write_execute);
+        this->expect_true(ept.gpa_to_epte(0x40400000).memory_type() == memory_type::write_back);
+
+        // Pages that are already 4k are left alone
+
+        ept.split_4k(0x40200000, size_4k);
+        this->expect_true(ept.pages(size_4k) == 1024);
+
+        this->expect_exception([&] { ept.split_4k(0x40000010, size_4k); }, ""_ut_ffe);
+        this->expect_exception([&] { ept.split_4k(0x40000000, 0x10); }, ""_ut_ffe);
+        this->expect_exception([&] { ept.split_4k(0x40000000, 0x0); }, ""_ut_ffe);
+        this->expect_exception([&] { ept.split_4k(0x0, size_4k); }, ""_ut_ree);
+    });
+}
+
+void
+memory_manager_ut::test_root_ept_intel_x64_clear_dirty()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ept = root_ept_intel_x64{};
+        ept.map_4k(0x1000, 0x1000, ept::read_write_execute, memory_type::write_back);
+
+        this->expect_false(ept.clear_dirty(0x1000));
+
+        ept.gpa_to_epte(0x1000).set_accessed(true);
+        ept.gpa_to_epte(0x1000).set_dirty(true);
+
+        this->expect_true(ept.clear_dirty(0x1000));
+        this->expect_false(ept.gpa_to_epte(0x1000).dirty());
+        this->expect_true(ept.gpa_to_epte(0x1000).accessed());
+        this->expect_false(ept.clear_dirty(0x1000));
+
+        this->expect_exception([&] { ept.clear_dirty(0x2000); }, ""_ut_ree);
+    });
+}
+
+void
+memory_manager_ut::test_root_ept_intel_x64_walk_1g_vs_4k()
+{
+    // An identity map of 1g of guest physical memory made of a single 1g
+    // page needs 2 tables, while the same map made of 4k pages needs 515
+    // (and on hardware, a TLB entry per 4k page). Both must translate every
+    // guest physical address the same way.
+
+    constexpr const auto num_walks = 0x1000UL;
+
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ept_1g = root_ept_intel_x64{};
+        auto &&ept_4k = root_ept_intel_x64{};
+
+        ept_1g.map_1g(0x0, 0x0, ept::read_write_execute, memory_type::write_back);
+
+        for (auto gpa = 0UL; gpa < size_1g; gpa += size_4k)
+            ept_4k.map_4k(gpa, gpa, ept::read_write_execute, memory_type::write_back);
+
+        auto gpa = 0UL;
+        auto good = true;
+
+        for (auto i = 0UL; i < num_walks; i++)
+        {
+            gpa = ((gpa * 6364136223846793005UL) + 1442695040888963407UL);
+
+            auto &&addr = gpa & (size_1g - 1);
+            good &= ept_1g.gpa_to_epte(addr).phys_addr() == 0;
+            good &= ept_4k.gpa_to_epte(addr).phys_addr() == (addr & ~(size_4k - 1));
+        }
+
+        this->expect_true(good);
+        this->expect_true(ept_1g.tables() == 2);
+        this->expect_true(ept_4k.tables() == 515);
+    });
+}
+
+void
+memory_manager_ut::benchmark_root_ept_intel_x64_walk()
+{
+    // Compares the cost of a (software) walk of an identity map of 1g of
+    // guest physical memory, made of a single 1g page, with the same identity
+    // map made of 4k pages, along with the number of tables / memory each
+    // requires. On hardware, the 1g map also only needs a single TLB entry
+    // (and 2 levels of the EPT walk) for the whole gigabyte.
+
+    constexpr const auto num_walks = 0x100000UL;
+
+    MockRepository mocks;
+    setup_mm(mocks);
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto &&ept_1g = root_ept_intel_x64{};
+        auto &&ept_4k = root_ept_intel_x64{};
+
+        ept_1g.map_1g(0x0, 0x0, ept::read_write_execute, memory_type::write_back);
+
+        for (auto gpa = 0UL; gpa < size_1g; gpa += size_4k)
+            ept_4k.map_4k(gpa, gpa, ept::read_write_execute, memory_type::write_back);
+
+        auto &&walk = [&](const auto & ept)
+        {
+            auto gpa = 0UL;
+            auto sum = 0UL;
+
+            auto &&start = std::chrono::steady_clock::now();
+            for (auto i = 0UL; i < num_walks; i++)
+            {
+                gpa = ((gpa * 6364136223846793005UL) + 1442695040888963407UL);
+                sum += ept.gpa_to_epte(gpa & (size_1g - 1)).phys_addr();
+            }
+            auto &&end = std::chrono::steady_clock::now();
+
+            asm volatile("" : : "r"(sum));
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        };
+
+        auto &&ns_1g = walk(ept_1g);
+        auto &&ns_4k = walk(ept_4k);
+
+        std::cout << "ept walk: 1g pages: "
+                  << ns_1g / static_cast<long long>(num_walks) << " ns per walk, "
+                  << ept_1g.tables() << " tables using " << ept_1g.table_bytes() << " bytes" << std::endl;
+        std::cout << "ept walk: 4k pages: "
+                  << ns_4k / static_cast<long long>(num_walks) << " ns per walk, "
+                  << ept_4k.tables() << " tables using " << ept_4k.table_bytes() << " bytes" << std::endl;
+    });
+}
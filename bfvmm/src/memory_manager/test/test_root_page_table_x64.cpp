@@ -31,8 +31,9 @@ setup_mm(MockRepository &mocks)
 {
     auto descriptor_list =
     {
-        memory_descriptor{0x12345000, 0x54321000, MEMORY_TYPE_R | MEMORY_TYPE_W},
-        memory_descriptor{0x12346000, 0x54322000, MEMORY_TYPE_R | MEMORY_TYPE_E},
+        memory_descriptor{0x12345000, 0x54321000, MEMORY_TYPE_R | MEMORY_TYPE_W, MAX_PAGE_SIZE},
+        memory_descriptor{0x12346000, 0x54322000, MEMORY_TYPE_R | MEMORY_TYPE_E, MAX_PAGE_SIZE},
+        memory_descriptor{0x12400000, 0x54400000, MEMORY_TYPE_R | MEMORY_TYPE_W, LARGE_PAGE_SIZE},
     };
 
     auto mm = mocks.Mock<memory_manager_x64>();
@@ -42,6 +43,7 @@ setup_mm(MockRepository &mocks)
     mocks.OnCall(mm, memory_manager_x64::virtptr_to_physint).Return(0x0000000ABCDEF0000);
     mocks.OnCall(mm, memory_manager_x64::virtint_to_physint).Return(0x0000000ABCDEF0000);
     mocks.OnCall(mm, memory_manager_x64::add_md);
+    mocks.OnCall(mm, memory_manager_x64::add_md_2m);
     mocks.OnCall(mm, memory_manager_x64::remove_md);
 
     return mm;
@@ -71,6 +73,9 @@ memory_manager_ut::test_root_page_table_x64_init_success()
     RUN_UNITTEST_WITH_MOCKS(mocks, [&]
     {
         this->expect_no_exception([&] { root_pt(); });
+        this->expect_true(root_pt()->virt_to_pte(0x54400000).ps());
+        this->expect_true(root_pt()->virt_to_pte(0x54421000).phys_addr() == 0x12400000);
+        this->expect_false(root_pt()->virt_to_pte(0x54321000).ps());
     });
 }
 
@@ -72,11 +72,9 @@ __stack_chk_fail(void) noexcept
 extern "C" void *
 memset(void *block, int c, size_t size)
 {
-    auto dstp = static_cast<unsigned char *>(block);
-
-    for (auto i = 0UL; i < size; i++)
-        dstp[i] = static_cast<unsigned char>(c);
+    auto dstp = block;
 
+    asm volatile("rep stosb" : "+D"(dstp), "+c"(size) : "a"(c) : "memory");
     return block;
 }
 
@@ -57,6 +57,7 @@ SOURCES+=test_guard_exceptions.cpp
 SOURCES+=test_bitmanip.cpp
 SOURCES+=test_exceptions.cpp
 SOURCES+=test_upper_lower.cpp
+SOURCES+=test_msgpack.cpp
 
 INCLUDE_PATHS+=./
 INCLUDE_PATHS+=%HYPER_ABS%/include/
@@ -68,6 +68,12 @@ misc_ut::list()
     this->test_upper();
     this->test_lower();
 
+    this->test_msgpack_scalars();
+    this->test_msgpack_strings();
+    this->test_msgpack_containers();
+    this->test_msgpack_invalid();
+    this->test_msgpack_dump_buffer();
+
     return true;
 }
 
@@ -66,6 +66,12 @@ private:
 
     void test_upper();
     void test_lower();
+
+    void test_msgpack_scalars();
+    void test_msgpack_strings();
+    void test_msgpack_containers();
+    void test_msgpack_invalid();
+    void test_msgpack_dump_buffer();
 };
 
 #endif
@@ -58,6 +58,7 @@ misc_ut::test_error_codes_valid()
     this->expect_true(ec_to_str(BF_ERROR_OUT_OF_MEMORY) == "BF_ERROR_OUT_OF_MEMORY"_s);
     this->expect_true(ec_to_str(BF_ERROR_VMM_CORRUPTED) == "BF_ERROR_VMM_CORRUPTED"_s);
     this->expect_true(ec_to_str(BF_ERROR_UNKNOWN) == "BF_ERROR_UNKNOWN"_s);
+    this->expect_true(ec_to_str(BF_ERROR_STATIC_PIE_NOT_ALONE) == "BF_ERROR_STATIC_PIE_NOT_ALONE"_s);
     this->expect_true(ec_to_str(BF_BAD_ALLOC) == "BF_BAD_ALLOC"_s);
     this->expect_true(ec_to_str(BF_IOCTL_FAILURE) == "BF_IOCTL_FAILURE"_s);
 }
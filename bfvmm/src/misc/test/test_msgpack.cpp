@@ -0,0 +1,120 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+
+#include <test.h>
+#include <msgpack.h>
+
+static auto
+encode(const json &val)
+{ return bfn::msgpack::dump(val); }
+
+static auto
+decode(const std::string &str)
+{ return bfn::msgpack::parse(gsl::make_span(str.data(), static_cast<std::ptrdiff_t>(str.size()))); }
+
+void
+misc_ut::test_msgpack_scalars()
+{
+    this->expect_true(encode(json(nullptr)) == std::string("\xC0", 1));
+    this->expect_true(encode(json(false)) == std::string("\xC2", 1));
+    this->expect_true(encode(json(true)) == std::string("\xC3", 1));
+
+    this->expect_true(encode(json(0x7FU)) == std::string("\x7F", 1));
+    this->expect_true(encode(json(0x80U)) == std::string("\xCC\x80", 2));
+    this->expect_true(encode(json(0x1234U)) == std::string("\xCD\x12\x34", 3));
+    this->expect_true(encode(json(0x12345678U)) == std::string("\xCE\x12\x34\x56\x78", 5));
+    this->expect_true(encode(json(0x123456789ABCDEF0UL)) == std::string("\xCF\x12\x34\x56\x78\x9A\xBC\xDE\xF0", 9));
+
+    this->expect_true(encode(json(1)) == std::string("\x01", 1));
+    this->expect_true(encode(json(-1)) == std::string("\xFF", 1));
+    this->expect_true(encode(json(-33)) == std::string("\xD0\xDF", 2));
+    this->expect_true(encode(json(-129)) == std::string("\xD1\xFF\x7F", 3));
+    this->expect_true(encode(json(-32769)) == std::string("\xD2\xFF\xFF\x7F\xFF", 5));
+    this->expect_true(encode(json(-2147483649L)) == std::string("\xD3\xFF\xFF\xFF\xFF\x7F\xFF\xFF\xFF", 9));
+
+    for (auto val : {json(nullptr), json(true), json(false), json(0U), json(0xFFFFFFFFFFFFFFFFUL), json(-1), json(-2147483649L)})
+        this->expect_true(decode(encode(val)) == val);
+}
+
+void
+misc_ut::test_msgpack_strings()
+{
+    auto &&str8 = std::string(32, 'a');
+    auto &&str16 = std::string(256, 'b');
+
+    this->expect_true(encode(json("")) == std::string("\xA0", 1));
+    this->expect_true(encode(json("hi")) == std::string("\xA2hi", 3));
+    this->expect_true(encode(json(str8)) == std::string("\xD9\x20", 2) + str8);
+    this->expect_true(encode(json(str16)) == std::string("\xDA\x01\x00", 3) + str16);
+
+    this->expect_true(decode(encode(json(str8))) == json(str8));
+    this->expect_true(decode(encode(json(str16))) == json(str16));
+    this->expect_true(decode(std::string("\xC4\x02hi", 4)) == json("hi"));
+}
+
+void
+misc_ut::test_msgpack_containers()
+{
+    auto &&obj = json::parse("{\"cmd\":\"start\",\"args\":[1,-2,true,null,{\"nested\":\"yes\"}],\"id\":4096}");
+
+    this->expect_true(encode(json::array()) == std::string("\x90", 1));
+    this->expect_true(encode(json::object()) == std::string("\x80", 1));
+    this->expect_true(encode(json::parse("[1,2]")) == std::string("\x92\x01\x02", 3));
+    this->expect_true(encode(json::parse("{\"a\":1}")) == std::string("\x81\xA1" "a\x01", 4));
+
+    this->expect_true(decode(encode(obj)) == obj);
+    this->expect_true(encode(obj).size() < obj.dump().size());
+    this->expect_true(bfn::msgpack::size(obj) == encode(obj).size());
+
+    auto &&big = json::array();
+    for (auto i = 0; i < 16; i++)
+        big.push_back(i);
+
+    this->expect_true(encode(big).substr(0, 3) == std::string("\xDC\x00\x10", 3));
+    this->expect_true(decode(encode(big)) == big);
+    this->expect_true(decode(std::string("\xDE\x00\x01\xA1" "a\x01", 6)) == json::parse("{\"a\":1}"));
+}
+
+void
+misc_ut::test_msgpack_invalid()
+{
+    this->expect_exception([&] { decode(""); }, ""_ut_ore);
+    this->expect_exception([&] { decode(std::string("\xA2h", 2)); }, ""_ut_ore);
+    this->expect_exception([&] { decode(std::string("\xCD\x12", 2)); }, ""_ut_ore);
+    this->expect_exception([&] { decode(std::string("\xDD\xFF\xFF\xFF\xFF", 5)); }, ""_ut_ore);
+    this->expect_exception([&] { decode(std::string("\xC1", 1)); }, ""_ut_iae);
+    this->expect_exception([&] { decode(std::string("\xCB\x00\x00\x00\x00\x00\x00\x00\x00", 9)); }, ""_ut_iae);
+    this->expect_exception([&] { decode(std::string("\x01\x02", 2)); }, ""_ut_iae);
+    this->expect_exception([&] { decode(std::string("\x81\x01\x02", 3)); }, ""_ut_iae);
+    this->expect_exception([&] { decode(std::string(bfn::msgpack::max_depth + 1, '\x91') + '\x01'); }, ""_ut_iae);
+}
+
+void
+misc_ut::test_msgpack_dump_buffer()
+{
+    auto &&obj = json::parse("{\"msg\":\"hello world\"}");
+    auto &&buf = std::string(bfn::msgpack::size(obj), '\0');
+
+    this->expect_true(bfn::msgpack::dump(obj, gsl::make_span(&buf[0], static_cast<std::ptrdiff_t>(buf.size()))) == buf.size());
+    this->expect_true(buf == encode(obj));
+    this->expect_exception([&] { bfn::msgpack::dump(obj, gsl::make_span(&buf[0], static_cast<std::ptrdiff_t>(buf.size() - 1))); }, ""_ut_ore);
+}
@@ -21,6 +21,30 @@
 
 #include <gsl/gsl>
 #include <vcpu/vcpu_intel_x64.h>
+#include <memory_manager/root_ept_intel_x64.h>
+#include <memory_manager/dirty_log_intel_x64.h>
+
+#include <intrinsics/msrs_intel_x64.h>
+#include <vmcs/vmcs_intel_x64_64bit_control_fields.h>
+
+static bool
+host_vm_ept_supported()
+{
+    // The host VM's EPT uses a 4 level page walk, write back EPT tables,
+    // and is flushed with a single context INVEPT before it is launched.
+    // The identity map covers the whole physical address space, which only
+    // fits in the VMM's page pool when it is made of 1g pages, so without
+    // them the host VM runs without EPT.
+
+    using namespace intel_x64::msrs::ia32_vmx_ept_vpid_cap;
+
+    return intel_x64::vmcs::ept_pointer::exists() &&
+           page_walk_length_of_4::get() &&
+           pdpte_1gb_support::get() &&
+           memory_type_write_back_supported::get() &&
+           invept_support::get() &&
+           invept_single_context_support::get();
+}
 
 vcpu_intel_x64::vcpu_intel_x64(vcpuid::type id,
                                std::unique_ptr<debug_ring> debug_ring,
@@ -31,6 +55,7 @@ vcpu_intel_x64::vcpu_intel_x64(vcpuid::type id,
                                std::unique_ptr<vmcs_intel_x64_state> guest_state) :
     vcpu(id, std::move(debug_ring)),
     m_vmcs_launched(false),
+    m_ept_enabled(false),
     m_vmxon(std::move(vmxon)),
     m_vmcs(std::move(vmcs)),
     m_exit_handler(std::move(exit_handler)),
@@ -70,6 +95,17 @@ vcpu_intel_x64::init(user_data *data)
 
     m_vmcs->set_state_save(m_state_save.get());
 
+    // The dirty log can only be harvested once every vCPU that uses the
+    // host VM's EPT is tracking writes, so it has to know about them
+
+    if (!m_ept_enabled && this->is_host_vm_vcpu() && host_vm_ept_supported())
+    {
+        m_vmcs->set_eptp(g_ept->eptp());
+        g_dirty_log->add_vcpu();
+
+        m_ept_enabled = true;
+    }
+
     m_exit_handler->set_vmcs(m_vmcs.get());
     m_exit_handler->set_state_save(m_state_save.get());
 
@@ -78,7 +114,15 @@ vcpu_intel_x64::init(user_data *data)
 
 void
 vcpu_intel_x64::fini(user_data *data)
-{ vcpu::fini(data); }
+{
+    vcpu::fini(data);
+
+    if (m_ept_enabled)
+    {
+        g_dirty_log->remove_vcpu();
+        m_ept_enabled = false;
+    }
+}
 
 void
 vcpu_intel_x64::run(user_data *data)
@@ -23,11 +23,12 @@
 #include <vcpu/vcpu_manager.h>
 
 // -----------------------------------------------------------------------------
-// Mutex
+// Lock
 // -----------------------------------------------------------------------------
 
 #include <mutex>
-std::mutex g_vcpu_manager_mutex;
+#include <intrinsics/lock_x64.h>
+x64::ticket_lock g_vcpu_manager_lock("vcpu_manager");
 
 // -----------------------------------------------------------------------------
 // Implementation
@@ -45,7 +46,7 @@ vcpu_manager::create_vcpu(vcpuid::type vcpuid, user_data *data)
 {
     auto ___ = gsl::on_failure([&]
     {
-        std::lock_guard<std::mutex> guard(g_vcpu_manager_mutex);
+        std::lock_guard<x64::ticket_lock> guard(g_vcpu_manager_lock);
         m_vcpus.erase(vcpuid);
     });
 
@@ -58,7 +59,7 @@ vcpu_manager::delete_vcpu(vcpuid::type vcpuid, user_data *data)
 {
     auto ___ = gsl::finally([&]
     {
-        std::lock_guard<std::mutex> guard(g_vcpu_manager_mutex);
+        std::lock_guard<x64::ticket_lock> guard(g_vcpu_manager_lock);
         m_vcpus.erase(vcpuid);
     });
 
@@ -102,7 +103,7 @@ vcpu_manager::add_vcpu(vcpuid::type vcpuid, user_data *data)
 
     if (auto && vcpu = m_vcpu_factory->make_vcpu(vcpuid, data))
     {
-        std::lock_guard<std::mutex> guard(g_vcpu_manager_mutex);
+        std::lock_guard<x64::ticket_lock> guard(g_vcpu_manager_lock);
         return m_vcpus[vcpuid] = std::move(vcpu);
     }
 
@@ -112,6 +113,6 @@ vcpu_manager::add_vcpu(vcpuid::type vcpuid, user_data *data)
 std::unique_ptr<vcpu> &
 vcpu_manager::get_vcpu(vcpuid::type vcpuid)
 {
-    std::lock_guard<std::mutex> guard(g_vcpu_manager_mutex);
+    std::lock_guard<x64::ticket_lock> guard(g_vcpu_manager_lock);
     return m_vcpus[vcpuid];
 }
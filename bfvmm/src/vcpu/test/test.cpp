@@ -110,6 +110,8 @@ vcpu_ut::list()
     this->test_vcpu_intel_x64_init_null_params();
     this->test_vcpu_intel_x64_init_valid_params();
     this->test_vcpu_intel_x64_init_valid();
+    this->test_vcpu_intel_x64_init_ept();
+    this->test_vcpu_intel_x64_init_ept_no_1g_pages();
     this->test_vcpu_intel_x64_init_vmcs_throws();
     this->test_vcpu_intel_x64_fini_null_params();
     this->test_vcpu_intel_x64_fini_valid_params();
@@ -77,6 +77,8 @@ private:
     void test_vcpu_intel_x64_init_null_params();
     void test_vcpu_intel_x64_init_valid_params();
     void test_vcpu_intel_x64_init_valid();
+    void test_vcpu_intel_x64_init_ept();
+    void test_vcpu_intel_x64_init_ept_no_1g_pages();
     void test_vcpu_intel_x64_init_vmcs_throws();
     void test_vcpu_intel_x64_fini_null_params();
     void test_vcpu_intel_x64_fini_valid_params();
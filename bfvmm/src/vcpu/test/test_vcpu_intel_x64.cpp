@@ -25,14 +25,21 @@
 #include <debug_ring/debug_ring.h>
 #include <memory_manager/memory_manager_x64.h>
 #include <memory_manager/root_page_table_x64.h>
+#include <memory_manager/root_ept_intel_x64.h>
+#include <memory_manager/dirty_log_intel_x64.h>
 
 #include <intrinsics/cpuid_x64.h>
+#include <intrinsics/msrs_intel_x64.h>
+
+#include <map>
 
 using namespace x64;
 
+std::map<uint32_t, uint64_t> g_msrs;
+
 extern "C" uint64_t
 __read_msr(uint32_t addr) noexcept
-{ (void) addr; return 0; }
+{ return g_msrs[addr]; }
 
 extern "C" uint64_t
 __read_cr0(void) noexcept
@@ -220,6 +227,95 @@ vcpu_ut::test_vcpu_intel_x64_init_valid()
     });
 }
 
+void
+vcpu_ut::test_vcpu_intel_x64_init_ept()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    auto &&dr = bfn::mock_unique<debug_ring>(mocks);
+    auto &&on = bfn::mock_unique<vmxon_intel_x64>(mocks);
+    auto &&cs = bfn::mock_unique<vmcs_intel_x64>(mocks);
+    auto &&eh = bfn::mock_unique<exit_handler_intel_x64>(mocks);
+    auto &&vs = bfn::mock_unique<vmcs_intel_x64_vmm_state>(mocks);
+    auto &&gs = bfn::mock_unique<vmcs_intel_x64_host_vm_state>(mocks);
+
+    auto &&ept = mocks.Mock<root_ept_intel_x64>();
+    mocks.OnCallFunc(root_ept).Return(ept);
+    mocks.OnCall(ept, root_ept_intel_x64::eptp).Return(0x1234U);
+
+    auto &&vcpus = 0UL;
+    auto &&log = mocks.Mock<dirty_log_intel_x64>();
+    mocks.OnCallFunc(dirty_log).Return(log);
+    mocks.OnCall(log, dirty_log_intel_x64::add_vcpu).Do([&] { vcpus++; });
+    mocks.OnCall(log, dirty_log_intel_x64::remove_vcpu).Do([&] { vcpus--; });
+
+    mocks.OnCall(cs.get(), vmcs_intel_x64::set_state_save);
+    mocks.ExpectCall(cs.get(), vmcs_intel_x64::set_eptp).With(0x1234U);
+
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+
+    g_msrs[intel_x64::msrs::ia32_vmx_true_procbased_ctls::addr] = 0xFFFFFFFF00000000UL;
+    g_msrs[intel_x64::msrs::ia32_vmx_procbased_ctls2::addr] = 0xFFFFFFFF00000000UL;
+    g_msrs[intel_x64::msrs::ia32_vmx_ept_vpid_cap::addr] = 0xFFFFFFFFFFFFFFFFUL;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto vc = std::make_unique<vcpu_intel_x64>(
+            0, std::move(dr), std::move(on), std::move(cs), std::move(eh), std::move(vs), std::move(gs));
+
+        // The dirty log has to know about every vCPU that uses the EPT
+
+        this->expect_no_exception([&]{ vc->init(); });
+        this->expect_true(vcpus == 1);
+
+        this->expect_no_exception([&]{ vc->fini(); });
+        this->expect_true(vcpus == 0);
+    });
+
+    g_msrs.clear();
+}
+
+void
+vcpu_ut::test_vcpu_intel_x64_init_ept_no_1g_pages()
+{
+    MockRepository mocks;
+    setup_mm(mocks);
+    setup_pt(mocks);
+
+    auto &&dr = bfn::mock_unique<debug_ring>(mocks);
+    auto &&on = bfn::mock_unique<vmxon_intel_x64>(mocks);
+    auto &&cs = bfn::mock_unique<vmcs_intel_x64>(mocks);
+    auto &&eh = bfn::mock_unique<exit_handler_intel_x64>(mocks);
+    auto &&vs = bfn::mock_unique<vmcs_intel_x64_vmm_state>(mocks);
+    auto &&gs = bfn::mock_unique<vmcs_intel_x64_host_vm_state>(mocks);
+
+    mocks.OnCall(cs.get(), vmcs_intel_x64::set_state_save);
+    mocks.NeverCall(cs.get(), vmcs_intel_x64::set_eptp);
+
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_vmcs);
+    mocks.OnCall(eh.get(), exit_handler_intel_x64::set_state_save);
+
+    // Everything the host VM's EPT needs, except for 1g pages
+
+    g_msrs[intel_x64::msrs::ia32_vmx_true_procbased_ctls::addr] = 0xFFFFFFFF00000000UL;
+    g_msrs[intel_x64::msrs::ia32_vmx_procbased_ctls2::addr] = 0xFFFFFFFF00000000UL;
+    g_msrs[intel_x64::msrs::ia32_vmx_ept_vpid_cap::addr] =
+        ~intel_x64::msrs::ia32_vmx_ept_vpid_cap::pdpte_1gb_support::mask;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        auto vc = std::make_unique<vcpu_intel_x64>(
+            0, std::move(dr), std::move(on), std::move(cs), std::move(eh), std::move(vs), std::move(gs));
+
+        this->expect_no_exception([&]{ vc->init(); });
+    });
+
+    g_msrs.clear();
+}
+
 void
 vcpu_ut::test_vcpu_intel_x64_init_vmcs_throws()
 {
@@ -41,13 +41,16 @@
 #include <vmcs/vmcs_intel_x64_natural_width_guest_state_fields.h>
 #include <vmcs/vmcs_intel_x64_natural_width_host_state_fields.h>
 
+#include <intrinsics/vmx_intel_x64.h>
+
 using namespace x64;
 using namespace intel_x64;
 using namespace vmcs;
 
 vmcs_intel_x64::vmcs_intel_x64() :
     m_vmcs_region_phys(0),
-    m_state_save(nullptr)
+    m_state_save(nullptr),
+    m_eptp(0)
 { }
 
 void
@@ -68,6 +71,9 @@ vmcs_intel_x64::launch(gsl::not_null<vmcs_intel_x64_state *> host_state,
     this->load();
     this->write_fields(host_state, guest_state);
 
+    if (m_eptp != 0)
+        vmx::invept_single_context(m_eptp);
+
     auto ___ = gsl::on_failure([&]
     { vmcs::debug::dump(); });
 
@@ -171,6 +177,9 @@ vmcs_intel_x64::write_64bit_control_state(gsl::not_null<vmcs_intel_x64_state *>
 {
     (void) state;
 
+    if (m_eptp != 0)
+        vmcs::ept_pointer::set(m_eptp);
+
     // unused: VMCS_ADDRESS_OF_IO_BITMAP_A
     // unused: VMCS_ADDRESS_OF_IO_BITMAP_B
     // unused: VMCS_ADDRESS_OF_MSR_BITMAPS
@@ -183,7 +192,6 @@ vmcs_intel_x64::write_64bit_control_state(gsl::not_null<vmcs_intel_x64_state *>
     // unused: VMCS_APIC_ACCESS_ADDRESS
     // unused: VMCS_POSTED_INTERRUPT_DESCRIPTOR_ADDRESS
     // unused: VMCS_VM_FUNCTION_CONTROLS
-    // unused: VMCS_EPT_POINTER
     // unused: VMCS_EOI_EXIT_BITMAP_0
     // unused: VMCS_EOI_EXIT_BITMAP_1
     // unused: VMCS_EOI_EXIT_BITMAP_2
@@ -387,6 +395,7 @@ vmcs_intel_x64::write_natural_host_state(gsl::not_null<vmcs_intel_x64_state *> s
     auto tc = reinterpret_cast<thread_context_t *>(stack_top - sizeof(thread_context_t));
     tc->cpuid = thread_context_cpuid();
     tc->tlsptr = thread_context_tlsptr();
+    tc->node = thread_context_node();
 
     vmcs::host_cr0::set(state->cr0());
     vmcs::host_cr3::set(state->cr3());
@@ -448,7 +457,6 @@ vmcs_intel_x64::secondary_processor_based_vm_execution_controls()
     bool verbose = SECONDARY_ENABLE_IF_VERBOSE;
 
     // secondary_processor_based_vm_execution_controls::virtualize_apic_accesses::enable_if_allowed(verbose);
-    // secondary_processor_based_vm_execution_controls::enable_ept::enable_if_allowed(verbose);
     // secondary_processor_based_vm_execution_controls::descriptor_table_exiting::enable_if_allowed(verbose);
     secondary_processor_based_vm_execution_controls::enable_rdtscp::enable_if_allowed(verbose);
     // secondary_processor_based_vm_execution_controls::virtualize_x2apic_mode::enable_if_allowed(verbose);
@@ -465,6 +473,9 @@ vmcs_intel_x64::secondary_processor_based_vm_execution_controls()
     // secondary_processor_based_vm_execution_controls::rdseed_exiting::enable_if_allowed(verbose);
     // secondary_processor_based_vm_execution_controls::ept_violation_ve::enable_if_allowed(verbose);
     secondary_processor_based_vm_execution_controls::enable_xsaves_xrstors::enable_if_allowed(verbose);
+
+    if (m_eptp != 0)
+        secondary_processor_based_vm_execution_controls::enable_ept::enable();
 }
 
 void
@@ -30,6 +30,8 @@ using namespace intel_x64;
 
 std::map<uint32_t, uint64_t> g_msrs;
 std::map<uint64_t, uint64_t> g_vmcs_fields;
+uint64_t g_invept_type = 0;
+uint64_t g_invept_eptp = 0;
 std::map<uint32_t, uint32_t> g_eax_cpuid;
 
 struct cpuid_regs g_cpuid_regs;
@@ -166,6 +168,13 @@ extern "C" bool
 __vmlaunch_demote(void) noexcept
 { return !g_vmlaunch_fails; }
 
+extern "C" void
+__invept(uint64_t type, void *ptr) noexcept
+{
+    g_invept_type = type;
+    g_invept_eptp = static_cast<uint64_t *>(ptr)[0];
+}
+
 uintptr_t
 virtptr_to_physint(void *ptr)
 {
@@ -214,6 +223,7 @@ vmcs_ut::list_vmcs_intel_x64_cpp()
     this->test_launch_create_exit_handler_stack_failure();
     this->test_launch_clear_failure();
     this->test_launch_load_failure();
+    this->test_launch_with_ept();
     this->test_promote_failure();
     this->test_resume_failure();
 }
@@ -275,6 +285,7 @@ vmcs_ut::list_16bit_guest_state_fields()
     this->test_vmcs_guest_tr_selector_ti();
     this->test_vmcs_guest_tr_selector_index();
     this->test_vmcs_guest_interrupt_status();
+    this->test_vmcs_guest_pml_index();
 }
 
 void
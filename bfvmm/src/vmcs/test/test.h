@@ -162,6 +162,7 @@ private:
     void test_launch_create_exit_handler_stack_failure();
     void test_launch_clear_failure();
     void test_launch_load_failure();
+    void test_launch_with_ept();
     void test_promote_failure();
     void test_resume_failure();
     void test_get_vmcs_field();
@@ -210,6 +211,7 @@ private:
     void test_vmcs_guest_tr_selector_ti();
     void test_vmcs_guest_tr_selector_index();
     void test_vmcs_guest_interrupt_status();
+    void test_vmcs_guest_pml_index();
     void test_vmcs_host_es_selector();
     void test_vmcs_host_es_selector_rpl();
     void test_vmcs_host_es_selector_ti();
@@ -57,6 +57,8 @@ extern bool g_vmwrite_fails;
 extern bool g_vmclear_fails;
 extern bool g_vmload_fails;
 extern size_t g_new_throws_bad_alloc;
+extern uint64_t g_invept_type;
+extern uint64_t g_invept_eptp;
 
 extern void setup_check_control_vmx_controls_all_paths(std::vector<struct control_flow_path> &cfg);
 extern void setup_check_host_state_all_paths(std::vector<struct control_flow_path> &cfg);
@@ -172,6 +174,7 @@ static std::map<uint64_t, std::string> exit_reasons
         {vmcs::exit_reason::basic_exit_reason::invpcid, "invpcid"_s},
         {vmcs::exit_reason::basic_exit_reason::vmfunc, "vmfunc"_s},
         {vmcs::exit_reason::basic_exit_reason::rdseed, "rdseed"_s},
+        {vmcs::exit_reason::basic_exit_reason::page_modification_log_full, "page_modification_log_full"_s},
         {vmcs::exit_reason::basic_exit_reason::xsaves, "xsaves"_s},
         {vmcs::exit_reason::basic_exit_reason::xrstors, "xrstors"_s},
         {0x0000BEEF, "unknown"_s}
@@ -492,6 +495,36 @@ vmcs_ut::test_launch_load_failure()
     });
 }
 
+void
+vmcs_ut::test_launch_with_ept()
+{
+    MockRepository mocks;
+    auto mm = mocks.Mock<memory_manager_x64>();
+    auto host_state = mocks.Mock<vmcs_intel_x64_state>();
+    auto guest_state = mocks.Mock<vmcs_intel_x64_state>();
+
+    setup_vmcs_intrinsics(mocks, mm);
+    setup_vmcs_x64_state_intrinsics(mocks, host_state);
+    setup_vmcs_x64_state_intrinsics(mocks, guest_state);
+    setup_launch_success_msrs();
+
+    g_invept_type = 0;
+    g_invept_eptp = 0;
+
+    RUN_UNITTEST_WITH_MOCKS(mocks, [&]
+    {
+        vmcs_intel_x64 vmcs{};
+        vmcs.set_eptp(0x0000000ABCDEF001EUL);
+
+        this->expect_no_exception([&] { vmcs.launch(host_state, guest_state); });
+
+        this->expect_true(vmcs::ept_pointer::get() == 0x0000000ABCDEF001EUL);
+        this->expect_true(secondary_processor_based_vm_execution_controls::enable_ept::is_enabled());
+        this->expect_true(g_invept_type == 1);
+        this->expect_true(g_invept_eptp == 0x0000000ABCDEF001EUL);
+    });
+}
+
 void
 vmcs_ut::test_promote_failure()
 {
@@ -1289,6 +1322,31 @@ vmcs_ut::test_vmcs_guest_interrupt_status()
     this->expect_true(vmcs::guest_interrupt_status::get() == 200UL);
 }
 
+void
+vmcs_ut::test_vmcs_guest_pml_index()
+{
+    g_msrs[msrs::ia32_vmx_true_procbased_ctls::addr] = msrs::ia32_vmx_true_procbased_ctls::activate_secondary_controls::mask << 32;
+    g_msrs[msrs::ia32_vmx_procbased_ctls2::addr] = msrs::ia32_vmx_procbased_ctls2::enable_pml::mask << 32;
+
+    this->expect_true(vmcs::guest_pml_index::exists());
+
+    vmcs::guest_pml_index::set(100UL);
+    this->expect_true(vmcs::guest_pml_index::get() == 100UL);
+
+    vmcs::guest_pml_index::set_if_exists(200UL);
+    this->expect_true(vmcs::guest_pml_index::get_if_exists() == 200UL);
+
+    g_msrs[msrs::ia32_vmx_procbased_ctls2::addr] = 0x0;
+    this->expect_false(vmcs::guest_pml_index::exists());
+    this->expect_exception([&] { vmcs::guest_pml_index::set(1UL); }, ""_ut_lee);
+    this->expect_exception([&] { vmcs::guest_pml_index::get(); }, ""_ut_lee);
+    this->expect_no_exception([&] { vmcs::guest_pml_index::set_if_exists(1UL); });
+    this->expect_no_exception([&] { vmcs::guest_pml_index::get_if_exists(); });
+
+    g_msrs[msrs::ia32_vmx_procbased_ctls2::addr] = msrs::ia32_vmx_procbased_ctls2::enable_pml::mask << 32;
+    this->expect_true(vmcs::guest_pml_index::get() == 200UL);
+}
+
 void
 vmcs_ut::test_vmcs_host_es_selector()
 {
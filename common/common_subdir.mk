@@ -87,6 +87,7 @@ Makefile: $(HYPER_REL)/Makefile.bf
 .PHONY: build_src
 .PHONY: build_tests
 .PHONY: run_tests
+.PHONY: run_benchmarks
 
 .DEFAULT_GOAL := all
 
@@ -149,6 +150,24 @@ run_tests: force
 	done
 endif
 
+ifeq ($(shell uname -s), Linux)
+run_benchmarks: force
+	@for dir in $(RUN_DIRS); do \
+		dir=`basename $$dir`; \
+		echo -e $(CI)"-->" $(CS)$(CURRENT_DIR)/$$dir$(CE); \
+		if [[ ! -d $(CURRENT_DIR)/$$dir ]]; then \
+			mkdir $(CURRENT_DIR)/$$dir; \
+		fi; \
+		if [[ ! -f $(CURRENT_DIR)/$$dir/Makefile ]]; then \
+			pushd $(CURRENT_DIR)/$$dir; \
+			BUILD_ABS=$(BUILD_ABS) BUILD_REL=$(BUILD_REL)/$$dir HYPER_REL=$(HYPER_REL)/$$dir $(HYPER_ABS)/configure -r --this-is-make; \
+			popd; \
+		fi; \
+		$(MAKE) --no-print-directory -C $$dir run_benchmarks || exit 1; \
+		echo -e $(CO)"<--" $(CS)$(CURRENT_DIR)/$$dir$(CE); \
+	done
+endif
+
 clean:
 	@for dir in $(CLEAN_DIRS); do \
 		dir=`basename $$dir`; \
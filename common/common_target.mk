@@ -151,6 +151,12 @@ ifeq ($(COVERALLS), true)
 	NATIVE_CCFLAGS+=-fprofile-arcs -ftest-coverage
 endif
 
+ifeq ($(LTO), true)
+	ifneq ($(findstring clang,$(COMPILER)),clang)
+		CROSS_CCFLAGS+=-flto -ffat-lto-objects
+	endif
+endif
+
 ifneq ($(IGNORE_WARNINGS),yes)
 	NATIVE_CCFLAGS+=-Werror
 	CROSS_CCFLAGS+=-Werror
@@ -222,6 +228,12 @@ ifeq ($(COVERALLS), true)
 	NATIVE_CXXFLAGS+=-fprofile-arcs -ftest-coverage
 endif
 
+ifeq ($(LTO), true)
+	ifneq ($(findstring clang,$(COMPILER)),clang)
+		CROSS_CXXFLAGS+=-flto -ffat-lto-objects
+	endif
+endif
+
 ifneq ($(IGNORE_WARNINGS),yes)
 	NATIVE_CXXFLAGS+=-Werror
 	CROSS_CXXFLAGS+=-Werror
@@ -278,6 +290,21 @@ ifeq ($(DYNAMIC_ANALYSIS_ENABLED), true)
 	NATIVE_LDFLAGS+=-Wl,--no-as-needed
 endif
 
+# The VMM's memory manager wraps operator new / new[] and the C++ runtime's
+# exception allocator (see memory_manager_x64.cpp), so every module that is
+# built against the VMM's headers is linked with the same wraps (the VMM
+# image is linked with them too, see build_vmm_image.sh). Other cross
+# compiled targets (e.g. the test modules) do not link against the memory
+# manager, and thus are not wrapped.
+
+ifeq ($(TARGET_CROSS_COMPILED), true)
+	ifneq ($(findstring /bfvmm/include, $(INCLUDE_PATHS)),)
+		CROSS_LDFLAGS+=-Wl,--wrap=__cxa_allocate_exception
+		CROSS_LDFLAGS+=-Wl,--wrap=_Znwm
+		CROSS_LDFLAGS+=-Wl,--wrap=_Znam
+	endif
+endif
+
 ################################################################################
 # Target Naming
 ################################################################################
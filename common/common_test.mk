@@ -43,6 +43,7 @@ Makefile: $(HYPER_REL)/Makefile.bf
 	@ BUILD_ABS=$(BUILD_ABS) BUILD_REL=$(BUILD_REL) HYPER_REL=$(HYPER_REL) $(HYPER_ABS)/configure -r --this-is-make
 
 .PHONY: run_tests
+.PHONY: run_benchmarks
 
 .DEFAULT_GOAL := run_tests
 
@@ -53,4 +54,9 @@ run_tests: force
 	@rm output.txt
 	@echo -e $(CS)"--------------------------------------------------------------------------------"$(CE)
 
+run_benchmarks: force
+	@echo -e $(CS)"--------------------------------------------------------------------------------"$(CE)
+	@LD_LIBRARY_PATH=$(LIBRARY_PATH) ./test --benchmark
+	@echo -e $(CS)"--------------------------------------------------------------------------------"$(CE)
+
 force: ;
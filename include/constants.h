@@ -116,30 +116,54 @@
 #define MAX_PAGE_SIZE (1ULL << MAX_PAGE_SHIFT)
 #endif
 
+/*
+ * Large Page Shift
+ *
+ * Defines the shift of a large page. Memory that is physically contiguous
+ * and aligned to a large page can be given to the VMM with a single memory
+ * descriptor, which the VMM then maps using large pages.
+ */
+#ifndef LARGE_PAGE_SHIFT
+#define LARGE_PAGE_SHIFT (21ULL)
+#endif
+
+/*
+ * Large Page Size
+ *
+ * Note: defined in bytes
+ */
+#ifndef LARGE_PAGE_SIZE
+#define LARGE_PAGE_SIZE (1ULL << LARGE_PAGE_SHIFT)
+#endif
+
 /*
  * Max Heap Pool
  *
  * This defines the internal memory that the hypervisor allocates to use
  * during setup by new/delete. Note that things like the debug_ring and
  * anything that uses a std::container uses this heap so it does need to
- * have some size to it. Pages do not come from this pool.
+ * have some size to it. Pages do not come from this pool. Once the VMM is
+ * loaded, the heap is extended with the memory chunks that are provided by
+ * the driver entry (see VMM_HEAP_CHUNKS), so this pool only needs to be
+ * large enough to initialize the VMM.
  *
- * Note: defined in bytes (defaults to 8MB)
+ * Note: defined in bytes (defaults to 2MB)
  */
 #ifndef MAX_HEAP_POOL
-#define MAX_HEAP_POOL (256ULL * MAX_PAGE_SIZE * sizeof(uintptr_t))
+#define MAX_HEAP_POOL (64ULL * MAX_PAGE_SIZE * sizeof(uintptr_t))
 #endif
 
 /*
  * Max Page Pool
  *
  * This defines the internal memory that the hypervisor allocates to use
- * for allocating pages.
+ * for allocating pages. Like the heap pool, this pool is extended with
+ * memory chunks provided by the driver entry (see VMM_PAGE_CHUNKS).
  *
- * Note: defined in bytes (defaults to 32MB)
+ * Note: defined in bytes (defaults to 4MB)
  */
 #ifndef MAX_PAGE_POOL
-#define MAX_PAGE_POOL (32 * 256ULL * MAX_PAGE_SIZE)
+#define MAX_PAGE_POOL (4 * 256ULL * MAX_PAGE_SIZE)
 #endif
 
 /*
@@ -166,6 +190,175 @@
 #define MEM_MAP_POOL_START 0x200000ULL
 #endif
 
+/*
+ * Max EPT Identity Map
+ *
+ * This defines the largest guest physical address that the host VM's EPT
+ * identity map covers. The identity map covers physical memory up to the
+ * CPU's physical address width, or this value, whichever is smaller, so by
+ * default (the architectural limit of 52 bits) all of the host's physical
+ * address space is mapped, and the host VM never takes an EPT violation.
+ * The map uses 1g pages where the MTRRs allow it, so even a 46 bit address
+ * width only needs 128 page directory pointer tables (2^46 / 2^39). The
+ * host VM only uses EPT when the CPU supports 1g EPT pages, as a map made
+ * of 2m pages would not fit in the VMM's page pool.
+ *
+ * Note: defined in bytes (defaults to 4PB)
+ */
+#ifndef MAX_EPT_IDENTITY_MAP
+#define MAX_EPT_IDENTITY_MAP (0x10000000000000ULL)
+#endif
+
+/*
+ * Max Emergency Pools
+ *
+ * This defines the number of per-CPU emergency pools. Exceptions are
+ * allocated from the emergency pool of the CPU that throws them (before the
+ * heap is tried), so that exceptions (most notably std::bad_alloc) can
+ * still be allocated and thrown when the heap is exhausted. The pools are
+ * not used for any other allocation. CPUs beyond this number share pools.
+ *
+ * Note: defined in number of CPUs
+ */
+#ifndef MAX_EMERGENCY_POOLS
+#define MAX_EMERGENCY_POOLS (64ULL)
+#endif
+
+/*
+ * Emergency Pool Blocks
+ *
+ * This defines the number of blocks in each emergency pool, which is the
+ * number of exceptions (and their payloads) that a single CPU can have
+ * allocated from its emergency pool at the same time. Must not be larger
+ * than 64.
+ *
+ * Note: defined in number of blocks
+ */
+#ifndef EMERGENCY_POOL_BLOCKS
+#define EMERGENCY_POOL_BLOCKS (8ULL)
+#endif
+
+/*
+ * Emergency Pool Block Size
+ *
+ * This defines the size of each emergency pool block. Allocations larger
+ * than this are never served from the emergency pools. The default is large
+ * enough to hold libc++abi's exception header and a typical exception.
+ *
+ * Note: defined in bytes (defaults to 256 bytes)
+ */
+#ifndef EMERGENCY_POOL_BLOCK_SIZE
+#define EMERGENCY_POOL_BLOCK_SIZE (0x100ULL)
+#endif
+
+/*
+ * Memory Chunk Size
+ *
+ * Once the VMM is loaded, the driver entry allocates memory chunks of this
+ * size, and gives them to the VMM's memory manager, which turns each chunk
+ * into an additional heap or page arena. Each arena keeps its bookkeeping
+ * at the start of its chunk, so a single allocation cannot be larger than
+ * a chunk (minus its bookkeeping) unless it comes from the static pools.
+ *
+ * Note: defined in bytes (defaults to 2MB)
+ */
+#ifndef MEM_CHUNK_SIZE
+#define MEM_CHUNK_SIZE (0x200000ULL)
+#endif
+
+/*
+ * VMM Heap Chunks
+ *
+ * This defines the number of memory chunks that the driver entry adds to
+ * the VMM's heap when the VMM is loaded.
+ *
+ * Note: defined in number of chunks (defaults to 4MB)
+ */
+#ifndef VMM_HEAP_CHUNKS
+#define VMM_HEAP_CHUNKS (2ULL)
+#endif
+
+/*
+ * VMM Page Chunks
+ *
+ * This defines the number of memory chunks that the driver entry adds to
+ * the VMM's page pool when the VMM is loaded. On NUMA systems, the chunks
+ * are spread evenly across the nodes, and each chunk is allocated from the
+ * node that it is given to.
+ *
+ * Note: defined in number of chunks (defaults to 12MB)
+ */
+#ifndef VMM_PAGE_CHUNKS
+#define VMM_PAGE_CHUNKS (6ULL)
+#endif
+
+/*
+ * VMM Reserve Chunks
+ *
+ * This defines the number of memory chunks that the driver entry registers
+ * with the VMM as a reserve. The VMM cannot ask the host for memory while
+ * it is running, so instead, reserve chunks are handed over when the VMM is
+ * loaded, and are turned into a heap or page arena (whichever runs out
+ * first) only when they are needed.
+ *
+ * Note: defined in number of chunks (defaults to 8MB)
+ */
+#ifndef VMM_RESERVE_CHUNKS
+#define VMM_RESERVE_CHUNKS (4ULL)
+#endif
+
+/*
+ * Max Memory Arenas
+ *
+ * This defines the maximum number of heap arenas, and the maximum number of
+ * page arenas, that the VMM's memory manager supports (including the static
+ * heap and page pools). This is also the maximum number of reserve chunks.
+ *
+ * Note: defined in number of arenas
+ */
+#ifndef MAX_MEM_ARENAS
+#define MAX_MEM_ARENAS (32ULL)
+#endif
+
+/*
+ * Max NUMA Nodes
+ *
+ * This defines the maximum number of NUMA nodes that the VMM's memory
+ * manager keeps a page pool for. Page chunks from a node beyond this limit
+ * are added to the shared page pool instead.
+ *
+ * Note: defined in number of nodes
+ */
+#ifndef MAX_NUMA_NODES
+#define MAX_NUMA_NODES (8ULL)
+#endif
+
+/*
+ * Heap Profiler Entries
+ *
+ * This defines the number of live allocations that the heap profiler can
+ * track at once. Allocations that are made once 3/4 of the entries are in
+ * use are not tracked, and are counted as dropped. Each entry is 32 bytes.
+ *
+ * Note: defined in number of allocations (must be a power of 2)
+ */
+#ifndef HEAP_PROFILER_ENTRIES
+#define HEAP_PROFILER_ENTRIES (0x2000ULL)
+#endif
+
+/*
+ * Heap Profiler Sites
+ *
+ * This defines the number of distinct call sites that the heap profiler
+ * can report. Allocations from call sites beyond this number are reported
+ * together, as a call site of 0.
+ *
+ * Note: defined in number of call sites (must be a power of 2)
+ */
+#ifndef HEAP_PROFILER_SITES
+#define HEAP_PROFILER_SITES (0x400ULL)
+#endif
+
 /*
  * Max Supported Modules
  *
@@ -177,6 +370,112 @@
 #define MAX_NUM_MODULES (25LL)
 #endif
 
+/*
+ * Max Module Cache Size
+ *
+ * When the VMM is unloaded, the driver entry keeps the relocated images of
+ * its modules (and a snapshot of their writable segments) so that loading
+ * the same modules again only has to verify each module's hash, instead of
+ * copying and relocating the modules a second time. This defines the total
+ * amount of memory the cache is allowed to hold onto. If the modules do not
+ * fit, they are not cached. Set to 0 to disable the cache.
+ *
+ * Note: defined in bytes (defaults to 64MB)
+ */
+#ifndef MAX_MODULE_CACHE_SIZE
+#define MAX_MODULE_CACHE_SIZE (0x4000000ULL)
+#endif
+
+/*
+ * Lazy Binding
+ *
+ * If enabled, the driver entry does not resolve the VMM's PLT entries
+ * (R_X86_64_JUMP_SLOT relocations) when the VMM is loaded. Instead, each
+ * one is resolved the first time it is called, which skips the symbol
+ * lookups for the (many) libc / libc++ functions that the VMM never calls.
+ * The resolver lives in the driver entry, which is not mapped once a CPU
+ * enters VMX root mode, so before the VMM is started, every symbol in
+ * LAZY_BINDING_PRELOAD is bound. LAZY_BINDING_PRELOAD is a comma separated
+ * list of symbol names, where "*" binds everything that is still unbound.
+ *
+ * This is disabled by default. There is no list of the functions the VMM
+ * calls from VMX root mode (exit handlers, the debug ring, the memory
+ * manager and whatever libc / libc++ they pull in), and a slot that is
+ * missed faults in VMX root mode with no way to recover. With the only safe
+ * preload ("*"), every slot is still bound before the VMM starts, so the
+ * lookups are deferred, not skipped, and the only saving is for modules that
+ * are loaded but never started. Only enable this with a narrowed preload
+ * list if you know every function the VMM calls from VMX root mode.
+ *
+ * Note: 0 == disabled, 1 == enabled
+ */
+#ifndef LAZY_BINDING
+#define LAZY_BINDING (0)
+#endif
+
+#ifndef LAZY_BINDING_PRELOAD
+#define LAZY_BINDING_PRELOAD "*"
+#endif
+
+/**
+ * EH Frame Index Size
+ *
+ * Defines the total number of FDEs that the unwinder can index across all
+ * of the modules that are loaded. The unwinder builds a sorted table of
+ * each module's FDEs so that locating a stack frame is a binary search
+ * instead of a walk of every .eh_frame section. Modules that do not fit
+ * fall back to the linear walk. Each entry is 16 bytes, and the table is
+ * statically allocated by the unwinder.
+ *
+ * Note: defined in number of FDEs
+ */
+#ifndef EH_FRAME_INDEX_SIZE
+#define EH_FRAME_INDEX_SIZE (0x8000ULL)
+#endif
+
+/**
+ * CFI Cache Size
+ *
+ * Defines the number of decoded call frame information (CFI) rows that the
+ * unwinder caches, keyed by PC. Unwinding a frame whose row is cached skips
+ * interpreting the frame's DWARF instructions. Each entry is roughly 800
+ * bytes, and the cache is statically allocated by the unwinder.
+ *
+ * Note: defined in number of rows
+ */
+#ifndef CFI_CACHE_SIZE
+#define CFI_CACHE_SIZE (0x100ULL)
+#endif
+
+/**
+ * Unwind Scratch Frames
+ *
+ * Defines the number of stack frames that the unwinder records while
+ * searching for a handler (phase 1), so that they can be replayed instead of
+ * unwound again while cleaning up (phase 2). Frames beyond this limit are
+ * unwound twice. Each frame is roughly 300 bytes.
+ *
+ * Note: defined in number of frames
+ */
+#ifndef UNWIND_SCRATCH_FRAMES
+#define UNWIND_SCRATCH_FRAMES (32ULL)
+#endif
+
+/**
+ * Unwind Scratch Pool Size
+ *
+ * Defines the number of exceptions that can be in flight at the same time
+ * (across all cores, including nested exceptions) while still having their
+ * frames recorded (see UNWIND_SCRATCH_FRAMES). Exceptions thrown while the
+ * pool is empty are unwound without a record. The pool is statically
+ * allocated by the unwinder, and must not be larger than 64.
+ *
+ * Note: defined in number of exceptions
+ */
+#ifndef UNWIND_SCRATCH_POOL_SIZE
+#define UNWIND_SCRATCH_POOL_SIZE (8ULL)
+#endif
+
 /**
  * Debug Ring Shift
  *
@@ -272,6 +571,34 @@
 #define VMCALL_OUT_BUFFER_SIZE (32 * MAX_PAGE_SIZE)
 #endif
 
+/**
+ * Profile Sample Buffer Size
+ *
+ * Defines the number of samples that the guest sampling profiler can hold
+ * per vCPU before samples are dropped. Samples are removed from this buffer
+ * as they are collected. Note that each vCPU that is profiled allocates one
+ * of these from the heap when the profiler is started.
+ *
+ * Note: defined in number of samples
+ */
+#ifndef PROFILE_SAMPLE_BUFFER_SIZE
+#define PROFILE_SAMPLE_BUFFER_SIZE (0x1000ULL)
+#endif
+
+/**
+ * Max VMCall Data Registrations
+ *
+ * Defines the max number of in / out buffer pairs that can be registered
+ * per vCPU using VMCALL_DATA_REGISTER. Each registration keeps both buffers
+ * mapped into the VMM, so this limits the amount of virtual address space
+ * a guest can consume.
+ *
+ * Note: defined in number of registrations
+ */
+#ifndef MAX_VMCALL_DATA_REGISTRATIONS
+#define MAX_VMCALL_DATA_REGISTRATIONS (16)
+#endif
+
 /**
  * Default Serial COM Port
  *
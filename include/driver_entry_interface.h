@@ -24,6 +24,7 @@
 #define DRIVER_ENTRY_INTERFACE_H
 
 #include <types.h>
+#include <constants.h>
 #include <debug_ring_interface.h>
 
 #ifdef __cplusplus
@@ -73,6 +74,32 @@ extern "C" {
 #define IOCTL_SET_CPUID_CMD 0x809
 #define IOCTL_SET_VCPUID_CMD 0x80A
 #define IOCTL_VMCALL_CMD 0x80B
+#define IOCTL_INVALIDATE_CACHE_CMD 0x80C
+#define IOCTL_ADD_MODULES_CMD 0x80D
+
+/**
+ * Module List
+ *
+ * Describes the modules that are added by IOCTL_ADD_MODULES. Each entry
+ * points to a module's ELF file in the caller's address space (for example,
+ * a file that was mapped into memory), so that all of the modules can be
+ * handed to the driver entry with a single IOCTL.
+ *
+ * @var module_list_t::num_modules
+ *     the number of valid entries in modules
+ * @var module_list_t::modules
+ *     the address and size (in bytes) of each module
+ */
+struct module_list_t
+{
+    uint64_t num_modules;
+
+    struct
+    {
+        uint64_t addr;
+        uint64_t size;
+    } modules[MAX_NUM_MODULES];
+};
 
 /* -------------------------------------------------------------------------- */
 /* Linux Interfaces                                                           */
@@ -187,6 +214,29 @@ extern "C" {
  */
 #define IOCTL_VMCALL _IOW(BAREFLANK_MAJOR, IOCTL_VMCALL_CMD, struct vmcall_registers_t *)
 
+/**
+ * Invalidate Cache
+ *
+ * This IOCTL tells the driver entry to release the relocated modules that it
+ * keeps after the VMM is unloaded. Loading the same modules again skips
+ * relocation while they are cached, so this only needs to be used to give
+ * the memory back, or to force the next load to relocate the modules.
+ */
+#define IOCTL_INVALIDATE_CACHE _IO(BAREFLANK_MAJOR, IOCTL_INVALIDATE_CACHE_CMD)
+
+/**
+ * Add Modules
+ *
+ * This IOCTL instructs the driver entry point to add every module in the
+ * provided list, in order, replacing a pair of IOCTL_ADD_MODULE_LENGTH /
+ * IOCTL_ADD_MODULE calls per module. The driver entry reads each module
+ * directly from the caller's memory. Note that this cannot be called while
+ * the vmm is running.
+ *
+ * @param arg the module list
+ */
+#define IOCTL_ADD_MODULES _IOW(BAREFLANK_MAJOR, IOCTL_ADD_MODULES_CMD, struct module_list_t *)
+
 #endif
 
 /* -------------------------------------------------------------------------- */
@@ -297,6 +347,16 @@ DEFINE_GUID(GUID_DEVINTERFACE_bareflank,
  */
 #define IOCTL_VMCALL CTL_CODE(BAREFLANK_DEVICETYPE, IOCTL_VMCALL_CMD, METHOD_IN_DIRECT, FILE_WRITE_DATA)
 
+/**
+ * Invalidate Cache
+ *
+ * This IOCTL tells the driver entry to release the relocated modules that it
+ * keeps after the VMM is unloaded. Loading the same modules again skips
+ * relocation while they are cached, so this only needs to be used to give
+ * the memory back, or to force the next load to relocate the modules.
+ */
+#define IOCTL_INVALIDATE_CACHE CTL_CODE(BAREFLANK_DEVICETYPE, IOCTL_INVALIDATE_CACHE_CMD, METHOD_BUFFERED, 0)
+
 #endif
 
 /* -------------------------------------------------------------------------- */
@@ -321,6 +381,7 @@ typedef struct bf_ioctl
 #define IOCTL_DUMP_VMM IOCTL_DUMP_VMM_CMD
 #define IOCTL_VMM_STATUS IOCTL_VMM_STATUS_CMD
 #define IOCTL_SET_VCPUID IOCTL_SET_VCPUID_CMD
+#define IOCTL_INVALIDATE_CACHE IOCTL_INVALIDATE_CACHE_CMD
 
 #endif
 
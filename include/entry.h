@@ -54,6 +54,44 @@ extern "C" {
  */
 typedef int64_t(*execute_entry_t)(uint64_t stack, void *func, uint64_t arg1, uint64_t arg2);
 
+/**
+ * VMM Entry Vector
+ *
+ * The entry points that the driver entry calls in the VMM using
+ * execute_entry. The driver entry resolves each of these once, after the VMM
+ * has been relocated, and calls them through the resulting function pointers
+ * from then on. A VMM can export an instance of this structure named
+ * "vmm_entry_vector", in which case all of the entry points are taken from
+ * it using a single symbol lookup. Any entry point that the VMM leaves as 0
+ * (or all of them if the VMM does not export the structure) is looked up by
+ * name instead.
+ *
+ * @var vmm_entry_vector_t::local_init
+ *     initializes a module
+ * @var vmm_entry_vector_t::local_fini
+ *     finalizes a module
+ * @var vmm_entry_vector_t::add_md
+ *     adds a memory descriptor to the memory manager
+ * @var vmm_entry_vector_t::add_mem_chunk
+ *     adds a memory chunk to the memory manager
+ * @var vmm_entry_vector_t::start_vmm
+ *     starts the VMM on a CPU
+ * @var vmm_entry_vector_t::stop_vmm
+ *     stops the VMM on a CPU
+ * @var vmm_entry_vector_t::get_drr
+ *     gets the debug ring resources of a vcpu
+ */
+struct vmm_entry_vector_t
+{
+    void *local_init;
+    void *local_fini;
+    void *add_md;
+    void *add_mem_chunk;
+    void *start_vmm;
+    void *stop_vmm;
+    void *get_drr;
+};
+
 
 #ifdef __cplusplus
 }
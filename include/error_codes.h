@@ -114,6 +114,7 @@
 #define BF_ERROR_OUT_OF_MEMORY ec_sign(0x8000000080000000)
 #define BF_ERROR_VMM_CORRUPTED ec_sign(0x8000000090000000)
 #define BF_ERROR_UNKNOWN ec_sign(0x80000000A0000000)
+#define BF_ERROR_STATIC_PIE_NOT_ALONE ec_sign(0x80000000B0000000)
 
 /* -------------------------------------------------------------------------- */
 /* IOCTL Error Codes                                                          */
@@ -180,6 +181,7 @@ ec_to_str(int64_t value)
             EC_CASE(BF_ERROR_OUT_OF_MEMORY);
             EC_CASE(BF_ERROR_VMM_CORRUPTED);
             EC_CASE(BF_ERROR_UNKNOWN);
+            EC_CASE(BF_ERROR_STATIC_PIE_NOT_ALONE);
             EC_CASE(BF_BAD_ALLOC);
             EC_CASE(BF_IOCTL_FAILURE);
 
@@ -189,6 +189,86 @@ private:
 
 #define unknown_vmcall_data_type(a) bfn::unknown_vmcall_data_type_error(a)
 
+// -----------------------------------------------------------------------------
+// Unknown VMCall Profile Command Error
+// -----------------------------------------------------------------------------
+
+class unknown_vmcall_profile_command_error : public bfn::general_exception
+{
+public:
+    unknown_vmcall_profile_command_error(std::string mesg) :
+        m_mesg(std::move(mesg))
+    {}
+
+    std::ostream &print(std::ostream &os) const override
+    { return os << "unknown profile command: `" << m_mesg << "`"; }
+
+private:
+    std::string m_mesg;
+};
+
+#define unknown_vmcall_profile_command(a) bfn::unknown_vmcall_profile_command_error(a)
+
+// -----------------------------------------------------------------------------
+// Unknown VMCall Heap Command Error
+// -----------------------------------------------------------------------------
+
+class unknown_vmcall_heap_command_error : public bfn::general_exception
+{
+public:
+    unknown_vmcall_heap_command_error(std::string mesg) :
+        m_mesg(std::move(mesg))
+    {}
+
+    std::ostream &print(std::ostream &os) const override
+    { return os << "unknown heap command: `" << m_mesg << "`"; }
+
+private:
+    std::string m_mesg;
+};
+
+#define unknown_vmcall_heap_command(a) bfn::unknown_vmcall_heap_command_error(a)
+
+// -----------------------------------------------------------------------------
+// Unknown VMCall Locks Command Error
+// -----------------------------------------------------------------------------
+
+class unknown_vmcall_locks_command_error : public bfn::general_exception
+{
+public:
+    unknown_vmcall_locks_command_error(std::string mesg) :
+        m_mesg(std::move(mesg))
+    {}
+
+    std::ostream &print(std::ostream &os) const override
+    { return os << "unknown locks command: `" << m_mesg << "`"; }
+
+private:
+    std::string m_mesg;
+};
+
+#define unknown_vmcall_locks_command(a) bfn::unknown_vmcall_locks_command_error(a)
+
+// -----------------------------------------------------------------------------
+// Unknown VMCall Dirty Command Error
+// -----------------------------------------------------------------------------
+
+class unknown_vmcall_dirty_command_error : public bfn::general_exception
+{
+public:
+    unknown_vmcall_dirty_command_error(std::string mesg) :
+        m_mesg(std::move(mesg))
+    {}
+
+    std::ostream &print(std::ostream &os) const override
+    { return os << "unknown dirty command: `" << m_mesg << "`"; }
+
+private:
+    std::string m_mesg;
+};
+
+#define unknown_vmcall_dirty_command(a) bfn::unknown_vmcall_dirty_command_error(a)
+
 // -----------------------------------------------------------------------------
 // Missing Argument Error
 // -----------------------------------------------------------------------------
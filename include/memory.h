@@ -45,8 +45,10 @@ extern "C" {
  *
  * A memory descriptor provides information about a block of memory.
  * Typically, each page of memory that the VMM uses will have a memory
- * descriptor associated with it. The VMM will use this information to create
- * its resources, as well as generate page tables as needed.
+ * descriptor associated with it, while memory that is physically
+ * contiguous can be described one large page at a time. The VMM will use
+ * this information to create its resources, as well as generate page tables
+ * as needed.
  *
  * @var memory_descriptor::phys
  *     the starting physical address of the block of memory
@@ -55,12 +57,17 @@ extern "C" {
  * @var memory_descriptor::type
  *     the type of memory block. This is likely architecture specific as
  *     this holds information about access rights, etc...
+ * @var memory_descriptor::size
+ *     the size of the block of memory. This is either MAX_PAGE_SIZE, or
+ *     LARGE_PAGE_SIZE if the block is physically contiguous, and both
+ *     addresses are aligned to a large page
  */
 struct memory_descriptor
 {
     uint64_t phys;
     uint64_t virt;
     uint64_t type;
+    uint64_t size;
 };
 
 /**
@@ -75,6 +82,68 @@ struct memory_descriptor
  */
 typedef int64_t (*add_md_t)(struct memory_descriptor *md);
 
+/**
+ * Memory Chunk Types
+ */
+#define MEMORY_CHUNK_HEAP 0x1U
+#define MEMORY_CHUNK_PAGE 0x2U
+#define MEMORY_CHUNK_RESERVE 0x3U
+
+/**
+ * Memory Map Pool
+ *
+ * Not a chunk type that can be added. This is the type that the memory
+ * manager's arena statistics use to describe the pool of virtual memory
+ * that is reserved for mapping.
+ */
+#define MEMORY_CHUNK_MAP 0x4U
+
+/**
+ * Any Node
+ *
+ * The node of a memory chunk that is not local to a specific NUMA node.
+ */
+#define MEMORY_CHUNK_ANY_NODE (~0ULL)
+
+/**
+ * Memory Chunk
+ *
+ * A memory chunk is a block of memory that the driver entry gives to the
+ * VMM's memory manager, which the memory manager uses to extend its heap,
+ * or its page pool. The driver entry must add a memory descriptor for each
+ * page of the chunk before the chunk is added, and must not free the chunk
+ * until the VMM is unloaded.
+ *
+ * @var memory_chunk::virt
+ *     the starting virtual address of the chunk (must be page aligned)
+ * @var memory_chunk::size
+ *     the size of the chunk in bytes
+ * @var memory_chunk::type
+ *     MEMORY_CHUNK_HEAP or MEMORY_CHUNK_PAGE to extend the heap or page
+ *     pool now, or MEMORY_CHUNK_RESERVE to extend whichever runs out first
+ * @var memory_chunk::node
+ *     the NUMA node that the chunk was allocated from, or
+ *     MEMORY_CHUNK_ANY_NODE. Page chunks from a node are used for the page
+ *     allocations made by the CPUs of that node
+ */
+struct memory_chunk
+{
+    uint64_t virt;
+    uint64_t size;
+    uint64_t type;
+    uint64_t node;
+};
+
+/**
+ * Add Memory Chunk
+ *
+ * @expects chunk != nullptr
+ * @ensures none
+ *
+ * This is used by the driver entry to add a memory chunk to the VMM.
+ */
+typedef int64_t (*add_mem_chunk_t)(struct memory_chunk *chunk);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,458 @@
+//
+// Bareflank Hypervisor
+//
+// Copyright (C) 2015 Assured Information Security, Inc.
+// Author: Rian Quinn        <quinnr@ainfosec.com>
+// Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+#ifndef BFN_MSGPACK_H
+#define BFN_MSGPACK_H
+
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+
+#include <gsl/gsl>
+#include <json.h>
+
+// MessagePack
+//
+// A compact binary alternative to JSON text for VMCALL_DATA. Values are
+// decoded into, and encoded from, the same json value model that is used
+// for VMCALL_DATA_STRING_JSON, so a handler does not need to care which
+// encoding was used. Decoding reads directly from the provided buffer
+// (e.g. a mapped guest page), and encoding writes directly into the
+// provided buffer, so neither requires an intermediate copy of the message.
+//
+// Since the json value model used by Bareflank does not support floating
+// point numbers, the float32 / float64 types are not supported. The ext
+// types are not supported either. bin types are decoded as strings, and
+// map keys must be strings.
+//
+
+namespace bfn
+{
+namespace msgpack
+{
+
+/// Max Depth
+///
+/// Defines the max number of nested arrays / maps that will be decoded.
+/// This bounds the amount of stack that decoding a message can use.
+///
+constexpr const auto max_depth = 32;
+
+namespace detail
+{
+
+class reader
+{
+public:
+
+    reader(gsl::span<const char> buf) noexcept :
+        m_buf(buf),
+        m_index(0)
+    { }
+
+    gsl::span<const char> take(uint64_t num)
+    {
+        if (num > remaining())
+            throw std::out_of_range("msgpack: buffer truncated");
+
+        auto &&ret = m_buf.subspan(m_index, static_cast<std::ptrdiff_t>(num));
+        m_index += static_cast<std::ptrdiff_t>(num);
+
+        return ret;
+    }
+
+    template<class T>
+    T read()
+    {
+        auto &&val = 0ULL;
+
+        for (auto c : take(sizeof(T)))
+            val = (val << 8) | static_cast<uint8_t>(c);
+
+        return static_cast<T>(val);
+    }
+
+    uint64_t remaining() const noexcept
+    { return static_cast<uint64_t>(m_buf.size() - m_index); }
+
+private:
+
+    gsl::span<const char> m_buf;
+    std::ptrdiff_t m_index;
+};
+
+class writer
+{
+public:
+
+    writer(char *buf, uint64_t size) noexcept :
+        m_buf(buf),
+        m_size(size),
+        m_index(0)
+    { }
+
+    void put(const char *data, uint64_t num)
+    {
+        if (m_buf != nullptr)
+        {
+            if (num > m_size - m_index)
+                throw std::out_of_range("msgpack: output buffer too small");
+
+            __builtin_memcpy(&m_buf[m_index], data, num);
+        }
+
+        m_index += num;
+    }
+
+    template<class T>
+    void write(uint8_t type, T val)
+    {
+        char data[sizeof(T) + 1];
+
+        data[0] = static_cast<char>(type);
+        for (auto i = 0U; i < sizeof(T); i++)
+            data[sizeof(T) - i] = static_cast<char>(static_cast<uint64_t>(val) >> (i * 8));
+
+        put(static_cast<const char *>(data), sizeof(data));
+    }
+
+    void write(uint8_t type)
+    {
+        auto &&c = static_cast<char>(type);
+        put(&c, 1);
+    }
+
+    uint64_t size() const noexcept
+    { return m_index; }
+
+private:
+
+    char *m_buf;
+    uint64_t m_size;
+    uint64_t m_index;
+};
+
+inline json decode(reader &r, int depth);
+
+inline json
+decode_string(reader &r, uint64_t len)
+{
+    auto &&str = r.take(len);
+    return json(std::string(str.data(), static_cast<std::size_t>(str.size())));
+}
+
+inline json
+decode_array(reader &r, uint64_t len, int depth)
+{
+    if (depth >= max_depth)
+        throw std::invalid_argument("msgpack: max depth exceeded");
+
+    if (len > r.remaining())
+        throw std::out_of_range("msgpack: buffer truncated");
+
+    auto &&ret = json::array();
+
+    for (auto i = 0ULL; i < len; i++)
+        ret.push_back(decode(r, depth + 1));
+
+    return ret;
+}
+
+inline json
+decode_map(reader &r, uint64_t len, int depth)
+{
+    if (depth >= max_depth)
+        throw std::invalid_argument("msgpack: max depth exceeded");
+
+    if (len > r.remaining() / 2)
+        throw std::out_of_range("msgpack: buffer truncated");
+
+    auto &&ret = json::object();
+
+    for (auto i = 0ULL; i < len; i++)
+    {
+        auto &&key = decode(r, depth + 1);
+
+        if (!key.is_string())
+            throw std::invalid_argument("msgpack: map keys must be strings");
+
+        ret[key.get<std::string>()] = decode(r, depth + 1);
+    }
+
+    return ret;
+}
+
+inline json
+decode(reader &r, int depth)
+{
+    auto &&type = r.read<uint8_t>();
+
+    if (type <= 0x7F)
+        return json(static_cast<json::number_unsigned_t>(type));
+
+    if (type >= 0xE0)
+        return json(static_cast<json::number_integer_t>(static_cast<int8_t>(type)));
+
+    if ((type & 0xE0) == 0xA0)
+        return decode_string(r, type & 0x1F);
+
+    if ((type & 0xF0) == 0x90)
+        return decode_array(r, type & 0x0F, depth);
+
+    if ((type & 0xF0) == 0x80)
+        return decode_map(r, type & 0x0F, depth);
+
+    switch (type)
+    {
+        case 0xC0: return json(nullptr);
+        case 0xC2: return json(false);
+        case 0xC3: return json(true);
+
+        case 0xC4: return decode_string(r, r.read<uint8_t>());
+        case 0xC5: return decode_string(r, r.read<uint16_t>());
+        case 0xC6: return decode_string(r, r.read<uint32_t>());
+
+        case 0xCC: return json(static_cast<json::number_unsigned_t>(r.read<uint8_t>()));
+        case 0xCD: return json(static_cast<json::number_unsigned_t>(r.read<uint16_t>()));
+        case 0xCE: return json(static_cast<json::number_unsigned_t>(r.read<uint32_t>()));
+        case 0xCF: return json(static_cast<json::number_unsigned_t>(r.read<uint64_t>()));
+
+        case 0xD0: return json(static_cast<json::number_integer_t>(static_cast<int8_t>(r.read<uint8_t>())));
+        case 0xD1: return json(static_cast<json::number_integer_t>(static_cast<int16_t>(r.read<uint16_t>())));
+        case 0xD2: return json(static_cast<json::number_integer_t>(static_cast<int32_t>(r.read<uint32_t>())));
+        case 0xD3: return json(static_cast<json::number_integer_t>(static_cast<int64_t>(r.read<uint64_t>())));
+
+        case 0xD9: return decode_string(r, r.read<uint8_t>());
+        case 0xDA: return decode_string(r, r.read<uint16_t>());
+        case 0xDB: return decode_string(r, r.read<uint32_t>());
+
+        case 0xDC: return decode_array(r, r.read<uint16_t>(), depth);
+        case 0xDD: return decode_array(r, r.read<uint32_t>(), depth);
+
+        case 0xDE: return decode_map(r, r.read<uint16_t>(), depth);
+        case 0xDF: return decode_map(r, r.read<uint32_t>(), depth);
+
+        default:
+            throw std::invalid_argument("msgpack: unsupported type");
+    }
+}
+
+inline void
+encode_unsigned(writer &w, uint64_t val)
+{
+    if (val <= 0x7F)
+        return w.write(static_cast<uint8_t>(val));
+
+    if (val <= 0xFF)
+        return w.write(0xCC, static_cast<uint8_t>(val));
+
+    if (val <= 0xFFFF)
+        return w.write(0xCD, static_cast<uint16_t>(val));
+
+    if (val <= 0xFFFFFFFF)
+        return w.write(0xCE, static_cast<uint32_t>(val));
+
+    w.write(0xCF, val);
+}
+
+inline void
+encode_signed(writer &w, int64_t val)
+{
+    if (val >= 0)
+        return encode_unsigned(w, static_cast<uint64_t>(val));
+
+    if (val >= -32)
+        return w.write(static_cast<uint8_t>(val));
+
+    if (val >= INT8_MIN)
+        return w.write(0xD0, static_cast<uint8_t>(val));
+
+    if (val >= INT16_MIN)
+        return w.write(0xD1, static_cast<uint16_t>(val));
+
+    if (val >= INT32_MIN)
+        return w.write(0xD2, static_cast<uint32_t>(val));
+
+    w.write(0xD3, static_cast<uint64_t>(val));
+}
+
+inline void
+encode_length(writer &w, uint64_t len, uint8_t fix, uint64_t fix_max, uint8_t type8, uint8_t type16)
+{
+    if (len <= fix_max)
+        return w.write(static_cast<uint8_t>(fix | len));
+
+    if (type8 != 0 && len <= 0xFF)
+        return w.write(type8, static_cast<uint8_t>(len));
+
+    if (len <= 0xFFFF)
+        return w.write(type16, static_cast<uint16_t>(len));
+
+    if (len <= 0xFFFFFFFF)
+        return w.write(static_cast<uint8_t>(type16 + 1), static_cast<uint32_t>(len));
+
+    throw std::out_of_range("msgpack: length too large");
+}
+
+inline void
+encode(writer &w, const json &val)
+{
+    switch (val.type())
+    {
+        case json::value_t::null:
+            return w.write(0xC0);
+
+        case json::value_t::boolean:
+            return w.write(static_cast<uint8_t>(val.get<bool>() ? 0xC3 : 0xC2));
+
+        case json::value_t::number_unsigned:
+            return encode_unsigned(w, val.get<json::number_unsigned_t>());
+
+        case json::value_t::number_integer:
+            return encode_signed(w, val.get<json::number_integer_t>());
+
+        case json::value_t::string:
+        {
+            auto &&str = val.get_ref<const json::string_t &>();
+
+            encode_length(w, str.length(), 0xA0, 0x1F, 0xD9, 0xDA);
+            return w.put(str.data(), str.length());
+        }
+
+        case json::value_t::array:
+        {
+            encode_length(w, val.size(), 0x90, 0x0F, 0, 0xDC);
+
+            for (const auto &elem : val)
+                encode(w, elem);
+
+            return;
+        }
+
+        case json::value_t::object:
+        {
+            encode_length(w, val.size(), 0x80, 0x0F, 0, 0xDE);
+
+            for (auto iter = val.begin(); iter != val.end(); ++iter)
+            {
+                encode_length(w, iter.key().length(), 0xA0, 0x1F, 0xD9, 0xDA);
+                w.put(iter.key().data(), iter.key().length());
+
+                encode(w, iter.value());
+            }
+
+            return;
+        }
+
+        default:
+            throw std::invalid_argument("msgpack: unsupported json type");
+    }
+}
+
+}
+
+/// Parse
+///
+/// Decodes a MessagePack encoded buffer into a json value. The entire
+/// buffer must contain exactly one encoded value.
+///
+/// @expects none
+/// @ensures none
+///
+/// @param buf the buffer to decode
+/// @return the decoded json value
+///
+/// @throws std::out_of_range if the buffer is truncated
+/// @throws std::invalid_argument if the buffer is not valid MessagePack,
+///     or contains trailing bytes
+///
+inline json
+parse(gsl::span<const char> buf)
+{
+    auto &&r = detail::reader(buf);
+    auto &&ret = detail::decode(r, 0);
+
+    if (r.remaining() != 0)
+        throw std::invalid_argument("msgpack: trailing bytes");
+
+    return ret;
+}
+
+/// Size
+///
+/// @expects none
+/// @ensures none
+///
+/// @param val the json value to encode
+/// @return the number of bytes needed to encode val
+///
+inline uint64_t
+size(const json &val)
+{
+    auto &&w = detail::writer(nullptr, 0);
+    detail::encode(w, val);
+
+    return w.size();
+}
+
+/// Dump
+///
+/// Encodes a json value directly into the provided buffer.
+///
+/// @expects none
+/// @ensures none
+///
+/// @param val the json value to encode
+/// @param buf the buffer to encode into
+/// @return the number of bytes written to buf
+///
+/// @throws std::out_of_range if buf is too small
+///
+inline uint64_t
+dump(const json &val, gsl::span<char> buf)
+{
+    auto &&w = detail::writer(buf.data(), static_cast<uint64_t>(buf.size()));
+    detail::encode(w, val);
+
+    return w.size();
+}
+
+/// Dump
+///
+/// @expects none
+/// @ensures none
+///
+/// @param val the json value to encode
+/// @return a string containing the MessagePack encoding of val
+///
+inline std::string
+dump(const json &val)
+{
+    auto &&ret = std::string(size(val), '\0');
+    dump(val, gsl::make_span(&ret[0], static_cast<std::ptrdiff_t>(ret.size())));
+
+    return ret;
+}
+
+}
+}
+
+#endif
@@ -45,6 +45,13 @@ uint64_t thread_context_cpuid(void);
  */
 uint64_t thread_context_tlsptr(void);
 
+/**
+ * Get Thread Context NUMA Node
+ *
+ * @return returns the NUMA node of the cpu from the current thread context
+ */
+uint64_t thread_context_node(void);
+
 /**
  * Thread Context
  *
@@ -62,7 +69,7 @@ struct thread_context_t
 {
     uint64_t cpuid;
     uint64_t tlsptr;
-    uint64_t reserved1;
+    uint64_t node;
     uint64_t reserved2;
 };
 
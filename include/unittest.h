@@ -243,7 +243,10 @@ auto make_uintptr(const T ptr)
 ///
 /// @endcode
 ///
-#define RUN_ALL_TESTS(ut) [&]() -> decltype(auto) { (void) argc; (void) argv; ut _ut; return _ut.run(); }()
+/// If the unit test is started with --benchmark (i.e. make benchmark),
+/// the benchmarks are run instead of the unit tests.
+///
+#define RUN_ALL_TESTS(ut) [&]() -> decltype(auto) { ut _ut; return _ut.run(argc, argv); }()
 
 /// No Delete
 ///
@@ -382,6 +385,30 @@ protected:
     virtual bool
     list() { return true; };
 
+    /// List Benchmarks
+    ///
+    /// Override this function to call each of your benchmarks. Benchmarks
+    /// time the code being tested and print their measurements, so they are
+    /// not run with the unit tests. Instead, they are run when the unit test
+    /// is started with --benchmark (i.e. make benchmark).
+    ///
+    /// @code
+    ///
+    /// bool benchmark() override
+    /// {
+    ///     this->benchmark1()
+    ///     this->benchmark2()
+    ///
+    ///     return true;
+    /// }
+    ///
+    /// @endcode
+    ///
+    /// @return true if the benchmarks passed, false otherwise
+    ///
+    virtual bool
+    benchmark() { return true; };
+
     /// Init Tests
     ///
     /// Override this function to initalize your tests. It's better to use
@@ -769,8 +796,14 @@ public:
     virtual ~unittest() {}
 
     decltype(auto)
-    run()
+    run(int argc = 0, const char *const argv[] = nullptr)
     {
+        auto benchmark = false;
+        auto args = gsl::make_span(argv, argc);
+
+        for (auto arg : args)
+            benchmark |= std::string(arg) == "--benchmark";
+
         if (this->internal_init() == false)
             return EXIT_FAILURE;
 
@@ -782,7 +815,7 @@ public:
 
         try
         {
-            if (this->list() == false)
+            if ((benchmark ? this->benchmark() : this->list()) == false)
             {
                 std::cout << "\033[1;31mFAILED\033[0m: list" << '\n';
                 return EXIT_FAILURE;
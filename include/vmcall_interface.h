@@ -148,17 +148,28 @@ enum vmcall_opcode
      * the output buffer going in is likely the "max" sized buffer, while the
      * actual contents being written back are likely smaller.
      *
+     * If in_addr and out_addr are both 0, the buffers that were registered
+     * using VMCALL_DATA_REGISTER (identified by the handle in r10) are used
+     * instead, which removes the need for the VMM to map / unmap the buffers
+     * on each call. In this case, the uuid must match the uuid that was
+     * registered, and in_size / out_size cannot be larger than the
+     * registered sizes. A handle of 0 is never registered. If in_addr and
+     * out_addr are provided, r10 is ignored, so callers that do not use
+     * registered buffers do not need to initialize it.
+     *
      * In:
      * r0 = VMCALL_DATA
      * r1 = VMCALL_MAGIC_NUMBER
      * r2 = uuid1 (bits 0 -> 63)
      * r3 = uuid2 (bits 64 -> 127)
      * r4 = in_type (vmcall_data_type)
-     * r5 = in_addr (addr of virtually contiguous buffer)
+     * r5 = in_addr (addr of virtually contiguous buffer, or 0 to use handle)
      * r6 = in_size (size of virtually contiguous buffer)
      * r7 = out_type (vmcall_data_type)
-     * r8 = out_addr (addr of virtually contiguous buffer)
+     * r8 = out_addr (addr of virtually contiguous buffer, or 0 to use handle)
      * r9 = out_size (size of virtually contiguous buffer)
+     * r10 = handle (returned by VMCALL_DATA_REGISTER, only read if
+     *       in_addr and out_addr are 0)
      *
      * Out:
      * r1 = 0 == success, error code otherwise
@@ -184,6 +195,189 @@ enum vmcall_opcode
      */
     VMCALL_EVENT = 4,
 
+    /*
+     * Profile
+     *
+     * Controls the guest sampling profiler. When started, the VMM arms the
+     * VMX preemption timer on the vCPU that made the vmcall with the
+     * provided period (in preemption timer ticks, which is the TSC shifted
+     * by IA32_VMX_MISC[4:0]). Each time the timer expires, the guest's RIP,
+     * CR3 and CPL are recorded into a per-vCPU sample buffer. Samples are
+     * removed from the buffer as they are collected. Note that the profiler
+     * is per-vCPU, and thus this vmcall must be made on each CPU that should
+     * be profiled.
+     *
+     * In (command == VMCALL_PROFILE_START):
+     * r0 = VMCALL_PROFILE
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = VMCALL_PROFILE_START
+     * r3 = period
+     *
+     * In (command == VMCALL_PROFILE_STOP):
+     * r0 = VMCALL_PROFILE
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = VMCALL_PROFILE_STOP
+     *
+     * In (command == VMCALL_PROFILE_COLLECT):
+     * r0 = VMCALL_PROFILE
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = VMCALL_PROFILE_COLLECT
+     * r8 = out_addr (addr of virtually contiguous buffer)
+     * r9 = out_size (size of virtually contiguous buffer)
+     *
+     * Out:
+     * r1 = 0 == success, error code otherwise
+     *
+     * Out (command == VMCALL_PROFILE_COLLECT):
+     * r1 = 0 == success, error code otherwise
+     * r3 = number of vmcall_profile_sample_t written to the out buffer
+     * r4 = number of samples still remaining in the sample buffer
+     * r5 = number of samples dropped because the sample buffer was full
+     * r9 = number of bytes written to the out buffer
+     */
+    VMCALL_PROFILE = 5,
+
+    /*
+     * Ring
+     *
+     * Provides a means to batch vmcalls. The client registers a
+     * vmcall_ring_t in its own memory, which the VMM maps once, and keeps
+     * mapped until the ring is unregistered. The client then enqueues
+     * requests into the submission queue, and rings the doorbell with a
+     * single vmcall. The VMM executes each request as if it was provided
+     * using the vmcall's registers (with r1 ignored), and places the results
+     * in the completion queue. If VMCALL_RING_FLAG_POLL is provided, the VMM
+     * will also drain the submission queue on other VM exits, so long as
+     * the guest is executing in the address space that registered the ring,
+     * which means a doorbell may not be needed at all.
+     *
+     * Note that the ring is per-vCPU, and thus the register, doorbell and
+     * unregister vmcalls must all be made on the same CPU. Also note that
+     * the ring's memory must remain resident until it is unregistered.
+     *
+     * In (command == VMCALL_RING_REGISTER):
+     * r0 = VMCALL_RING
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = VMCALL_RING_REGISTER
+     * r3 = ring_addr (addr of virtually contiguous vmcall_ring_t)
+     * r4 = ring_size (must be sizeof(vmcall_ring_t))
+     * r5 = flags (vmcall_ring_flags)
+     *
+     * In (command == VMCALL_RING_DOORBELL):
+     * r0 = VMCALL_RING
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = VMCALL_RING_DOORBELL
+     *
+     * In (command == VMCALL_RING_UNREGISTER):
+     * r0 = VMCALL_RING
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = VMCALL_RING_UNREGISTER
+     *
+     * Out:
+     * r1 = 0 == success, error code otherwise
+     *
+     * Out (command == VMCALL_RING_DOORBELL):
+     * r1 = 0 == success, error code otherwise
+     * r3 = number of requests that were completed
+     */
+    VMCALL_RING = 6,
+
+    /*
+     * Data Register
+     *
+     * Registers an in and out buffer pair for use with VMCALL_DATA. The VMM
+     * maps both buffers once, and keeps them mapped until they are
+     * unregistered, or until the address space that registered them is
+     * torn down. The registration is keyed by the uuid, and thus each uuid
+     * can only be registered once. The returned handle (never 0) is then
+     * provided to VMCALL_DATA (in r10), with in_addr and out_addr set to 0.
+     *
+     * Note that registrations are per-vCPU, and thus the register, data and
+     * unregister vmcalls must all be made on the same CPU. Also note that
+     * the buffers must remain resident until they are unregistered.
+     *
+     * In:
+     * r0 = VMCALL_DATA_REGISTER
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = uuid1 (bits 0 -> 63)
+     * r3 = uuid2 (bits 64 -> 127)
+     * r5 = in_addr (addr of virtually contiguous buffer)
+     * r6 = in_size (size of virtually contiguous buffer)
+     * r8 = out_addr (addr of virtually contiguous buffer)
+     * r9 = out_size (size of virtually contiguous buffer)
+     *
+     * Out:
+     * r1 = 0 == success, error code otherwise
+     * r4 = handle
+     */
+    VMCALL_DATA_REGISTER = 7,
+
+    /*
+     * Data Unregister
+     *
+     * Unregisters an in and out buffer pair that was previously registered
+     * using VMCALL_DATA_REGISTER.
+     *
+     * In:
+     * r0 = VMCALL_DATA_UNREGISTER
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = uuid1 (bits 0 -> 63)
+     * r3 = uuid2 (bits 64 -> 127)
+     * r4 = handle
+     *
+     * Out:
+     * r1 = 0 == success, error code otherwise
+     */
+    VMCALL_DATA_UNREGISTER = 8,
+
+    /*
+     * Heap
+     *
+     * Controls the VMM's heap profiler, and reports the state of the VMM's
+     * memory pools. When started, the memory manager records the call site,
+     * size and vCPU of each allocation until it is freed, or until the
+     * profiler is stopped (the allocations that are live when the profiler
+     * is stopped can still be collected). Collect reports the live
+     * allocations grouped by call site, sorted by the number of bytes that
+     * each call site is holding. Pools reports the size, usage, peak usage,
+     * fragmentation and an occupancy map of each heap, page and map pool.
+     * Unlike the guest profiler, the heap profiler is shared by all vCPUs.
+     *
+     * In (command == VMCALL_HEAP_START):
+     * r0 = VMCALL_HEAP
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = VMCALL_HEAP_START
+     *
+     * In (command == VMCALL_HEAP_STOP):
+     * r0 = VMCALL_HEAP
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = VMCALL_HEAP_STOP
+     *
+     * In (command == VMCALL_HEAP_COLLECT or VMCALL_HEAP_POOLS):
+     * r0 = VMCALL_HEAP
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = VMCALL_HEAP_COLLECT or VMCALL_HEAP_POOLS
+     * r8 = out_addr (addr of virtually contiguous buffer)
+     * r9 = out_size (size of virtually contiguous buffer)
+     *
+     * Out:
+     * r1 = 0 == success, error code otherwise
+     *
+     * Out (command == VMCALL_HEAP_COLLECT):
+     * r1 = 0 == success, error code otherwise
+     * r3 = number of vmcall_heap_site_t written to the out buffer
+     * r4 = number of live allocations that are being tracked
+     * r5 = number of allocations that were not tracked (table full)
+     * r9 = number of bytes written to the out buffer
+     *
+     * Out (command == VMCALL_HEAP_POOLS):
+     * r1 = 0 == success, error code otherwise
+     * r3 = number of vmcall_heap_pool_t written to the out buffer
+     * r4 = number of pools
+     * r9 = number of bytes written to the out buffer
+     */
+    VMCALL_HEAP = 9,
+
     /*
      * Unit Test
      *
@@ -205,6 +399,91 @@ enum vmcall_opcode
      * r1 = 0 == success, error code otherwise
      */
     VMCALL_UNITTEST = 10,
+
+    /*
+     * Locks
+     *
+     * Reports the contention statistics of the VMM's named locks. For each
+     * lock, the VMM records the number of acquisitions, the number of
+     * acquisitions that had to wait for the lock, the total number of
+     * times a CPU spun while waiting, and the longest time (in TSC cycles)
+     * that the lock was held exclusively. Reset clears these statistics.
+     * Like the heap profiler, the statistics are shared by all vCPUs.
+     *
+     * In (command == VMCALL_LOCKS_COLLECT):
+     * r0 = VMCALL_LOCKS
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = VMCALL_LOCKS_COLLECT
+     * r8 = out_addr (addr of virtually contiguous buffer)
+     * r9 = out_size (size of virtually contiguous buffer)
+     *
+     * In (command == VMCALL_LOCKS_RESET):
+     * r0 = VMCALL_LOCKS
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = VMCALL_LOCKS_RESET
+     *
+     * Out:
+     * r1 = 0 == success, error code otherwise
+     *
+     * Out (command == VMCALL_LOCKS_COLLECT):
+     * r1 = 0 == success, error code otherwise
+     * r3 = number of vmcall_lock_stats_t written to the out buffer
+     * r4 = number of named locks
+     * r9 = number of bytes written to the out buffer
+     */
+    VMCALL_LOCKS = 11,
+
+    /*
+     * Dirty Log
+     *
+     * Tracks which 4k pages of a range of the host VM's physical memory
+     * are written to, using the CPU's page modification log (PML) and the
+     * EPT's dirty flags. Start marks every page in the range as dirty, and
+     * enables PML on the vCPU that made the vmcall. The log itself is shared
+     * by all vCPUs, but PML is per-vCPU, and thus start must be made on each
+     * CPU that should be tracked (with the same range). Harvest returns a
+     * window of the dirty bitmap (bit n of word i is page first + i * 64 + n),
+     * and clears the pages that it reports, so that only the pages that are
+     * written to afterwards are reported by the next harvest. Writes are
+     * only logged on CPUs that have made start, so harvest fails (with the
+     * log left untouched) until start has been made on every CPU, and must
+     * be made on one of them. A CPU can only invalidate its own cached
+     * translations, which the other CPUs do on their next VM exit, so until
+     * they all have, the pages that a harvest clears are reported again by
+     * the next harvest (i.e. a page might be reported dirty more than once,
+     * but a write is never missed).
+     *
+     * In (command == VMCALL_DIRTY_LOG_START):
+     * r0 = VMCALL_DIRTY_LOG
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = VMCALL_DIRTY_LOG_START
+     * r3 = gpa (4k aligned)
+     * r4 = size (4k aligned)
+     *
+     * In (command == VMCALL_DIRTY_LOG_STOP):
+     * r0 = VMCALL_DIRTY_LOG
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = VMCALL_DIRTY_LOG_STOP
+     *
+     * In (command == VMCALL_DIRTY_LOG_HARVEST):
+     * r0 = VMCALL_DIRTY_LOG
+     * r1 = VMCALL_MAGIC_NUMBER
+     * r2 = VMCALL_DIRTY_LOG_HARVEST
+     * r3 = first page (multiple of 64)
+     * r8 = out_addr (addr of virtually contiguous buffer)
+     * r9 = out_size (size of virtually contiguous buffer)
+     *
+     * Out:
+     * r1 = 0 == success, error code otherwise
+     *
+     * Out (command == VMCALL_DIRTY_LOG_HARVEST):
+     * r1 = 0 == success, error code otherwise
+     * r3 = number of dirty pages in the harvested window
+     * r4 = gpa of the tracked range
+     * r5 = number of pages in the tracked range
+     * r9 = number of bytes written to the out buffer
+     */
+    VMCALL_DIRTY_LOG = 12,
 };
 
 /*
@@ -239,6 +518,187 @@ enum vmcall_data_type
     VMCALL_DATA_STRING_UNFORMATTED = 1,
     VMCALL_DATA_STRING_JSON = 2,
     VMCALL_DATA_BINARY_UNFORMATTED = 10,
+    VMCALL_DATA_BINARY_MSGPACK = 11,
+};
+
+/*
+ * VMCall Profile Commands
+ *
+ * Defines the different commands that are supported by the profile vmcall.
+ */
+enum vmcall_profile_command
+{
+    VMCALL_PROFILE_START = 1,
+    VMCALL_PROFILE_STOP = 2,
+    VMCALL_PROFILE_COLLECT = 3,
+};
+
+/*
+ * VMCall Heap Commands
+ *
+ * Defines the different commands that are supported by the heap vmcall.
+ */
+enum vmcall_heap_command
+{
+    VMCALL_HEAP_START = 1,
+    VMCALL_HEAP_STOP = 2,
+    VMCALL_HEAP_COLLECT = 3,
+    VMCALL_HEAP_POOLS = 4,
+};
+
+/*
+ * VMCall Locks Commands
+ *
+ * Defines the different commands that are supported by the locks vmcall.
+ */
+enum vmcall_locks_command
+{
+    VMCALL_LOCKS_COLLECT = 1,
+    VMCALL_LOCKS_RESET = 2,
+};
+
+/*
+ * VMCall Dirty Log Commands
+ *
+ * Defines the different commands that are supported by the dirty log vmcall.
+ */
+enum vmcall_dirty_log_command
+{
+    VMCALL_DIRTY_LOG_START = 1,
+    VMCALL_DIRTY_LOG_STOP = 2,
+    VMCALL_DIRTY_LOG_HARVEST = 3,
+};
+
+/*
+ * VMCall Lock Types
+ *
+ * Defines the different types of locks that are reported by the locks
+ * vmcall.
+ */
+enum vmcall_lock_type
+{
+    VMCALL_LOCK_SPINLOCK = 1,
+    VMCALL_LOCK_TICKET = 2,
+    VMCALL_LOCK_MCS = 3,
+    VMCALL_LOCK_RW = 4,
+};
+
+/*
+ * VMCall Ring Commands
+ *
+ * Defines the different commands that are supported by the ring vmcall.
+ */
+enum vmcall_ring_command
+{
+    VMCALL_RING_REGISTER = 1,
+    VMCALL_RING_DOORBELL = 2,
+    VMCALL_RING_UNREGISTER = 3,
+};
+
+/*
+ * VMCall Ring Flags
+ *
+ * Defines the flags that can be provided when a ring is registered.
+ */
+enum vmcall_ring_flags
+{
+    VMCALL_RING_FLAG_NONE = 0,
+    VMCALL_RING_FLAG_POLL = 1,
+};
+
+/*
+ * VMCall Profile Sample
+ *
+ * Defines a single sample recorded by the guest sampling profiler. The
+ * rip is the guest's instruction pointer at the time the VMX preemption
+ * timer expired, the cr3 identifies the address space that rip belongs to,
+ * and the cpl is the guest's current privilege level (0 == kernel,
+ * 3 == user)
+ */
+struct vmcall_profile_sample_t
+{
+    uint64_t rip;
+    uint64_t cr3;
+    uint64_t cpl;
+};
+
+/*
+ * VMCall Heap Site
+ *
+ * Defines the live allocations of a single call site, as recorded by the
+ * heap profiler. The caller is the return address of the call into the
+ * VMM's allocator (i.e. the code that called operator new or malloc),
+ * count and bytes are the number and total requested size of the call
+ * site's live allocations, and cpus has bit (vcpuid % 64) set for each
+ * vCPU that made one of these allocations.
+ */
+struct vmcall_heap_site_t
+{
+    uint64_t caller;
+    uint64_t count;
+    uint64_t bytes;
+    uint64_t cpus;
+};
+
+/*
+ * VMCall Heap Map Size
+ *
+ * Defines the number of entries in the occupancy map of a heap pool.
+ */
+#ifndef VMCALL_HEAP_MAP_SIZE
+#define VMCALL_HEAP_MAP_SIZE 64
+#endif
+
+/*
+ * VMCall Heap Pool
+ *
+ * Defines the state of a single memory pool. The type is one of the
+ * MEMORY_CHUNK_* types (a reserve chunk has not been turned into a pool
+ * yet, and only reports its addr and size). largest_free is the largest
+ * run of free memory, and free_ranges is the number of runs of free memory,
+ * which together describe the pool's fragmentation. Each entry of the map
+ * is the percentage (0 - 100) of 1 / VMCALL_HEAP_MAP_SIZE of the pool
+ * that is in use.
+ */
+struct vmcall_heap_pool_t
+{
+    uint64_t type;
+    uint64_t addr;
+    uint64_t size;
+    uint64_t used;
+    uint64_t peak;
+    uint64_t largest_free;
+    uint64_t free_ranges;
+    uint8_t map[VMCALL_HEAP_MAP_SIZE];
+};
+
+/*
+ * VMCall Lock Name Size
+ *
+ * Defines the size of the name of a lock, including the null terminator.
+ * Longer names are truncated.
+ */
+#ifndef VMCALL_LOCK_NAME_SIZE
+#define VMCALL_LOCK_NAME_SIZE 32
+#endif
+
+/*
+ * VMCall Lock Stats
+ *
+ * Defines the statistics of a single named lock. The type is one of the
+ * VMCALL_LOCK_* types. contended is the number of acquisitions that had
+ * to wait for the lock, spins is the total number of times a CPU spun
+ * while waiting, and max_hold is the longest time (in TSC cycles) that the
+ * lock was held exclusively.
+ */
+struct vmcall_lock_stats_t
+{
+    char name[VMCALL_LOCK_NAME_SIZE];
+    uint64_t type;
+    uint64_t acquisitions;
+    uint64_t contended;
+    uint64_t spins;
+    uint64_t max_hold;
 };
 
 /*
@@ -288,6 +748,56 @@ struct vmcall_registers_t
     uintptr_t r15;
 };
 
+/*
+ * VMCall Ring Entries
+ *
+ * Defines the number of entries in both the submission and the completion
+ * queue of a vmcall ring.
+ */
+#ifndef VMCALL_RING_NUM_ENTRIES
+#define VMCALL_RING_NUM_ENTRIES 64
+#endif
+
+/*
+ * VMCall Ring Entry
+ *
+ * Defines a single request (submission queue) or response (completion
+ * queue). The id is provided by the client, and is copied as is into the
+ * completion so that the client can match responses to requests. ret is
+ * only used by the completion queue, and is 0 on success, error code
+ * otherwise.
+ */
+struct vmcall_ring_entry_t
+{
+    uint64_t id;
+    uint64_t ret;
+    struct vmcall_registers_t regs;
+};
+
+/*
+ * VMCall Ring
+ *
+ * Defines the memory shared between the client and the VMM for the ring
+ * vmcall. The head / tail fields are free running counters (i.e. they are
+ * never wrapped), and the entry that they refer to is the counter modulo
+ * VMCALL_RING_NUM_ENTRIES. A queue is empty when head == tail, and full
+ * when tail - head == VMCALL_RING_NUM_ENTRIES.
+ *
+ * sq_tail and cq_head are written by the client, while sq_head and cq_tail
+ * are written by the VMM. Entries must be written before the tail that
+ * publishes them.
+ */
+struct vmcall_ring_t
+{
+    uint64_t sq_head;
+    uint64_t sq_tail;
+    uint64_t cq_head;
+    uint64_t cq_tail;
+
+    struct vmcall_ring_entry_t sq[VMCALL_RING_NUM_ENTRIES];
+    struct vmcall_ring_entry_t cq[VMCALL_RING_NUM_ENTRIES];
+};
+
 #ifdef __cplusplus
 }
 #endif
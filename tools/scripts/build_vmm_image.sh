@@ -0,0 +1,118 @@
+#!/bin/bash -e
+#
+# Bareflank Hypervisor
+#
+# Copyright (C) 2015 Assured Information Security, Inc.
+# Author: Rian Quinn        <quinnr@ainfosec.com>
+# Author: Brendan Kerrigan  <kerriganb@ainfosec.com>
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+
+%ENV_SOURCE%
+
+# ------------------------------------------------------------------------------
+# Description
+# ------------------------------------------------------------------------------
+
+# Links all of the modules in a (filtered) module file into a single,
+# self-relocating static-PIE VMM image. Instead of linking the shared
+# libraries, the static archive of each module is linked (the system libraries
+# come from the sysroot), with link time optimization, so that calls between
+# modules are direct, and the only relocations left are R_X86_64_RELATIVE.
+# A module file that contains only the image is generated next to it, which
+# can be given to "bfm load" like any other module file. The image is linked
+# with the same --wrap flags that common_target.mk gives each VMM module, as
+# the memory manager's wrappers call the __real_ functions.
+#
+# $1: the filtered module file
+# $2: the output directory
+#
+
+if [[ -z "$1" ]] || [[ -z "$2" ]]; then
+    echo "usage: build_vmm_image.sh <module_file> <output_dir>"
+    exit 1
+fi
+
+# ------------------------------------------------------------------------------
+# Compiler
+# ------------------------------------------------------------------------------
+
+if [[ $compiler == *"clang"* ]]; then
+    echo "build_vmm_image.sh: LTO images are only supported with gcc"
+    exit 1
+fi
+
+if [[ -d "$HOME/compilers/$compiler" ]]; then
+    LINKER="$HOME/compilers/$compiler/bin/x86_64-elf-g++"
+else
+    LINKER="/tmp/compilers/$compiler/bin/x86_64-elf-g++"
+fi
+
+# ------------------------------------------------------------------------------
+# Archives
+# ------------------------------------------------------------------------------
+
+SYSROOT_LIB="$BUILD_ABS/sysroot/x86_64-elf/lib"
+
+for module in `grep -o '"[^"]*\.so[^"]*"' $1 | tr -d '"'`
+do
+    name=`basename $module`
+    name=${name%%.so*}
+
+    if [[ `dirname $module` == "$SYSROOT_LIB" ]]; then
+        SYSTEM_ARCHIVES="$SYSTEM_ARCHIVES $SYSROOT_LIB/$name.a"
+    else
+        MODULE_ARCHIVES="$MODULE_ARCHIVES `dirname $module`/${name}_static.a"
+    fi
+done
+
+for archive in $SYSTEM_ARCHIVES $MODULE_ARCHIVES
+do
+    if [[ ! -f $archive ]]; then
+        echo "build_vmm_image.sh: missing archive: $archive"
+        exit 1
+    fi
+done
+
+# ------------------------------------------------------------------------------
+# Link
+# ------------------------------------------------------------------------------
+
+mkdir -p $2
+
+$BUILD_ABS/build_scripts/x86_64-bareflank-docker $LINKER \
+    -O2 -flto -fpie -nostdlib -pie \
+    -Wl,--no-dynamic-linker \
+    -Wl,--export-dynamic \
+    -Wl,--hash-style=both \
+    -Wl,-z,max-page-size=4096 \
+    -Wl,-z,relro \
+    -Wl,-z,now \
+    -Wl,-e,local_init \
+    -Wl,--wrap=__cxa_allocate_exception \
+    -Wl,--wrap=_Znwm \
+    -Wl,--wrap=_Znam \
+    -Wl,--whole-archive $MODULE_ARCHIVES -Wl,--no-whole-archive \
+    -Wl,--start-group $SYSTEM_ARCHIVES -Wl,--end-group \
+    -o $2/vmm.so
+
+rm -Rf $2/vmm.modules
+
+echo "{" >> $2/vmm.modules
+echo "    \"modules\" :" >> $2/vmm.modules
+echo "    [" >> $2/vmm.modules
+echo "        \"$2/vmm.so\"" >> $2/vmm.modules
+echo "    ]" >> $2/vmm.modules
+echo "}" >> $2/vmm.modules